@@ -70,6 +70,21 @@ Derived fields and statistics:
     - calculate_field_stats(data): Compute min, max, avg, sum for a field
     - compute_velocity_magnitude(u, v, nx, ny): Compute sqrt(u^2 + v^2)
     - compute_flow_statistics(u, v, p, nx, ny): Statistics for all flow components
+    - field_statistics(data, bins=0, range=None, percentiles=None): Single-pass
+      moments, norms, NaN counts, histogram and approximate percentiles
+    - compute_derived_fields(u, v, nx, ny, ...): Vorticity, divergence, strain rate,
+      Q-criterion and pressure gradients in one fused sweep
+    - sample_lines(data, nx, ny, lines, ...): Batched bilinear sampling along
+      polylines and constant-x/constant-y grid lines
+    - compare_fields(a, b, nx=0): L1/L2/Linf absolute and relative errors, ULP
+      distances and max-error location in one parallel pass
+    - compare_flow_fields(a, b): compare_fields() on u, v, p of two flow states
+    - resample_fields(data, nx, ny, factor=1, roi=None, ...): Block-average or
+      injection restriction and region-of-interest extraction
+    - energy_spectrum(u, v, nx, ny, ...): Shell-binned and 1D kinetic energy
+      spectra of periodic fields via an in-tree FFT
+    - advect_particles(x, y, u, v, nx, ny, dt, ...): RK2/RK4 tracer advection
+      in place through a frozen velocity field
 
 Solver backend availability (v0.1.6):
     Backends:
@@ -106,8 +121,73 @@ GPU device management (v0.2.0):
 
 Logging (v0.2.0):
     - set_log_callback(callable): Set log callback
+
+Native objects:
+    - Grid(nx, ny, xmin, xmax, ymin, ymax, ...): Grid with zero-copy coordinate views
+    - FieldSnapshot(u, v, p, nx, ny, time, step): u/v/p fields at one time step
+    Both pickle with out-of-band buffers under protocol 5.
+
+Simulation state:
+    - Simulation(nx, ny, ...): Persistent state with step(), clone(), snapshot()
+    - Simulation.set_divergence_guard(...): Roll back and retry with smaller dt on divergence
+    - Simulation.start_averaging(every=1): Running means, second moments and
+      min/max envelopes of u, v, p, read through Simulation.averages
+    - Simulation.set_probes(points, every=1, max_samples=0): Record interpolated
+      u, v, p at fixed points every step; read back with probe_data()
+    - Simulation.set_diagnostics(every=1, max_samples=0): Kinetic energy, enstrophy,
+      edge mass fluxes and max divergence per step; read back with diagnostic_data()
+    - run_ensemble(simulations, steps, ...): Advance members in parallel, stopping
+      each early once a threshold or convergence predicate fires
+    - reinit_after_fork(num_threads=0, reset_library=False): Reset per-process
+      state in a forked child (registered automatically with os.register_at_fork);
+      reset_library=True also re-initializes the CFD library
+
+VTK XML output:
+    - write_vtr(filename, data, nx, ny, grid=None, ...): Rectilinear .vtr with the
+      actual coordinates and appended raw or zlib-compressed data
+    - append_pvd(filename, dataset, time): Add one entry to a .pvd time index
+    - Simulation.write_vtr(filename, ..., collection=None): Same for the live state
+
+Background output:
+    - AsyncWriter(buffers=2): Copy snapshots into pooled buffers and write VTK,
+      VTR or CSV files on a writer thread; write(), flush(), close()
+    - CsvWriter(filename, append=False, buffer_size=1048576, flush_every=0):
+      Buffered CSV timeseries log with row statistics computed natively
+
+Snapshot store:
+    - SnapshotWriter(filename, nx, ny, append=False, compress=False,
+      max_error=0.0, relative=False): Append u, v and p of each step to one file
+      as 64-byte aligned raw float64 records, or lossless or error-bounded
+      compressed ones
+    - SnapshotStore(filename): Memory-mapped reader; store[step] is a FieldSnapshot
+      of read-only zero-copy views (POSIX only)
+
+Field compression:
+    - compress_field(data, max_error=0.0, relative=False): XOR-delta, byte
+      shuffle and LZ coding of a float64 field in parallel chunks; a positive
+      max_error selects error-bounded lossy coding
+    - decompress_field(data, out=None): Inverse, exact for lossless streams
+
+NumPy files:
+    - save_npy(filename, data, shape=None): Write a field straight to .npy
+    - save_npz(filename, arrays, shape=None): Uncompressed .npz of a Simulation's
+      or FieldSnapshot's u, v and p, or of a dict of fields
+    - load_npy(filename, writable=False): Memory-mapped .npy as a zero-copy
+      memoryview accepted by every function taking float64 buffers
+
+Scheduled output:
+    - Simulation.add_output(type, pattern, every=1): Write an OUTPUT_* file
+      from inside the step loop; pattern takes one %d step conversion
+    - run_simulation*(..., outputs=[(type, pattern, every), ...]): Same for runs
+
+Shared-memory results (POSIX only):
+    - run_simulation_with_params(..., shm_name=name): Write result fields to shared memory
+    - attach_shared_result(name, unlink=False): Zero-copy views of a result segment
+    - unlink_shared_result(name): Remove a result segment
 """
 
+import os as _os
+
 from ._exceptions import (
     CFDDivergedError,
     CFDError,
@@ -131,6 +211,16 @@ _CORE_EXPORTS = [
     "run_simulation_with_params",
     "create_grid",
     "get_default_solver_params",
+    # Native objects
+    "Grid",
+    "FieldSnapshot",
+    "Simulation",
+    "AsyncWriter",
+    "CsvWriter",
+    "SnapshotWriter",
+    "SnapshotStore",
+    "reinit_after_fork",
+    "run_ensemble",
     # Solver functions
     "list_solvers",
     "has_solver",
@@ -140,6 +230,13 @@ _CORE_EXPORTS = [
     "write_vtk_scalar",
     "write_vtk_vector",
     "write_csv_timeseries",
+    "write_vtr",
+    "append_pvd",
+    "compress_field",
+    "decompress_field",
+    "save_npy",
+    "save_npz",
+    "load_npy",
     # Output type constants
     "OUTPUT_VELOCITY",
     "OUTPUT_VELOCITY_MAGNITUDE",
@@ -195,6 +292,14 @@ _CORE_EXPORTS = [
     "calculate_field_stats",
     "compute_velocity_magnitude",
     "compute_flow_statistics",
+    "compute_derived_fields",
+    "field_statistics",
+    "sample_lines",
+    "compare_fields",
+    "compare_flow_fields",
+    "resample_fields",
+    "energy_spectrum",
+    "advect_particles",
     # Solver backend constants (v0.1.6)
     "BACKEND_SCALAR",
     "BACKEND_SIMD",
@@ -287,6 +392,9 @@ _CORE_EXPORTS = [
     "CFD_LOG_LEVEL_INFO",
     "CFD_LOG_LEVEL_WARNING",
     "CFD_LOG_LEVEL_ERROR",
+    # Shared-memory result transport
+    "attach_shared_result",
+    "unlink_shared_result",
 ]
 
 # Load C extension and populate module namespace
@@ -302,6 +410,10 @@ try:
     # Build __all__ with core exports + dynamic solver constants
     __all__ = _CORE_EXPORTS + list(_solver_constants.keys())
 
+    # Reset library state in children created by os.fork()
+    if hasattr(_os, "register_at_fork"):
+        _os.register_at_fork(after_in_child=_exports["reinit_after_fork"])
+
 except ExtensionNotBuiltError:
     # Development mode - extension not built (this is expected)
     __all__ = _CORE_EXPORTS
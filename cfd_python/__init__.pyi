@@ -1,5 +1,6 @@
 """Type stubs for cfd_python C extension module."""
 
+from collections.abc import Iterable, Sequence
 from typing import Any, Callable
 
 __version__: str
@@ -120,6 +121,8 @@ def run_simulation(
     ymax: float = 1.0,
     solver_type: str | None = None,
     output_file: str | None = None,
+    binary: bool = False,
+    outputs: Sequence[tuple[Any, ...]] | None = None,
 ) -> list[float]:
     """Run a complete simulation with default parameters.
 
@@ -133,6 +136,8 @@ def run_simulation(
         ymax: Maximum y coordinate (default: 1.0)
         solver_type: Solver name string (optional, uses library default)
         output_file: VTK output file path (optional)
+        outputs: (type, pattern[, every[, binary[, precision]]]) tuples written
+            inside the step loop; see Simulation.add_output() (optional)
 
     Returns:
         List of velocity magnitude values (size nx*ny)
@@ -151,6 +156,10 @@ def run_simulation_with_params(
     cfl: float = 0.2,
     solver_type: str | None = None,
     output_file: str | None = None,
+    shm_name: str | None = None,
+    snapshot: bool = False,
+    binary: bool = False,
+    outputs: Sequence[tuple[Any, ...]] | None = None,
 ) -> dict[str, Any]:
     """Run simulation with custom parameters and solver selection.
 
@@ -166,10 +175,19 @@ def run_simulation_with_params(
         cfl: CFL number (default: 0.2)
         solver_type: Solver name string (optional, uses library default)
         output_file: VTK output file path (optional)
+        shm_name: Write velocity_magnitude, u, v and p into a new POSIX
+            shared-memory segment of this name (optional)
+        snapshot: Return native FieldSnapshot/Grid objects instead of the
+            velocity_magnitude list (default: False)
+        outputs: (type, pattern[, every[, binary[, precision]]]) tuples written
+            inside the step loop; see Simulation.add_output() (optional)
 
     Returns:
         Dictionary with keys:
-        - velocity_magnitude: list[float]
+        - velocity_magnitude: list[float] (omitted with shm_name or snapshot)
+        - shm: dict[str, Any] (only with shm_name; name, size, nx, ny, fields)
+        - snapshot: FieldSnapshot (only with snapshot=True)
+        - grid: Grid (only with snapshot=True)
         - nx: int
         - ny: int
         - steps: int
@@ -179,6 +197,485 @@ def run_simulation_with_params(
     """
     ...
 
+class Grid:
+    """Computational grid with coordinates held in native memory.
+
+    Uniform by default; pass beta (> 0) for the stretched distribution of
+    create_grid_stretched(). Pickles coordinates out-of-band with protocol 5.
+    """
+
+    nx: int
+    ny: int
+    nz: int
+    xmin: float
+    xmax: float
+    ymin: float
+    ymax: float
+    zmin: float
+    zmax: float
+    def __init__(
+        self,
+        nx: int,
+        ny: int,
+        xmin: float,
+        xmax: float,
+        ymin: float,
+        ymax: float,
+        nz: int = 1,
+        zmin: float = 0.0,
+        zmax: float = 0.0,
+        beta: float | None = None,
+    ) -> None: ...
+    @property
+    def x(self) -> memoryview:
+        """x coordinates (read-only, nx doubles)."""
+        ...
+    @property
+    def y(self) -> memoryview:
+        """y coordinates (read-only, ny doubles)."""
+        ...
+    @property
+    def z(self) -> memoryview:
+        """z coordinates (empty for 2D grids)."""
+        ...
+    def to_dict(self) -> dict[str, Any]:
+        """Return the grid in the create_grid() dict format."""
+        ...
+
+class FieldSnapshot:
+    """u, v and p fields at one time step, held in native memory.
+
+    Fields are flat row-major memoryviews of nx*ny doubles. Pickles fields
+    out-of-band with protocol 5 and adopts received buffers without copying.
+    """
+
+    nx: int
+    ny: int
+    step: int
+    time: float
+    def __init__(
+        self,
+        u: Any,
+        v: Any,
+        p: Any,
+        nx: int,
+        ny: int,
+        time: float = 0.0,
+        step: int = 0,
+    ) -> None: ...
+    @property
+    def u(self) -> memoryview: ...
+    @property
+    def v(self) -> memoryview: ...
+    @property
+    def p(self) -> memoryview: ...
+
+class Simulation:
+    """Persistent simulation state that can be advanced, inspected and cloned.
+
+    u, v and p are live zero-copy views of the solver fields.
+    """
+
+    nx: int
+    ny: int
+    step_count: int
+    time: float
+    dt: float
+    cfl: float
+    def __init__(
+        self,
+        nx: int,
+        ny: int,
+        xmin: float = 0.0,
+        xmax: float = 1.0,
+        ymin: float = 0.0,
+        ymax: float = 1.0,
+        solver_type: str | None = None,
+        dt: float = 0.001,
+        cfl: float = 0.2,
+    ) -> None: ...
+    @property
+    def u(self) -> memoryview: ...
+    @property
+    def v(self) -> memoryview: ...
+    @property
+    def p(self) -> memoryview: ...
+    @property
+    def grid(self) -> Grid: ...
+    @property
+    def stats(self) -> dict[str, Any] | None: ...
+    @property
+    def solver_name(self) -> str | None: ...
+    @property
+    def divergence_info(self) -> dict[str, Any]: ...
+    @property
+    def averages(self) -> dict[str, Any] | None: ...
+    @property
+    def particles(self) -> dict[str, Any] | None: ...
+    @property
+    def outputs(self) -> list[dict[str, Any]]: ...
+    def step(self, steps: int = 1) -> int:
+        """Advance the simulation (GIL released); raises CFDError subclasses on failure."""
+        ...
+    def clone(self) -> Simulation:
+        """Return an independent copy of the current state (parallel memcpy)."""
+        ...
+    def set_fields(self, u: Any = None, v: Any = None, p: Any = None) -> None:
+        """Overwrite u, v and/or p from lists, NumPy arrays or float64 buffers."""
+        ...
+    def snapshot(self) -> FieldSnapshot:
+        """Return a FieldSnapshot copy of the current u, v and p."""
+        ...
+    def derived_fields(
+        self, fields: Iterable[str] | None = None, out: dict[str, Any] | None = None
+    ) -> dict[str, Any]:
+        """compute_derived_fields() on the live u, v, p and simulation grid."""
+        ...
+    def sample_lines(self, lines: Sequence[Any], num_points: int = 100) -> list[dict[str, Any]]:
+        """sample_lines() on the live u, v, p and simulation grid."""
+        ...
+    def resample(
+        self,
+        factor: int | tuple[int, int] = 1,
+        roi: tuple[int, int, int, int] | None = None,
+        mode: str = "average",
+    ) -> dict[str, Any]:
+        """resample_fields() on the live u, v, p and simulation grid."""
+        ...
+    def write_vtk(
+        self,
+        filename: str,
+        factor: int | tuple[int, int] = 1,
+        roi: tuple[int, int, int, int] | None = None,
+        binary: bool = False,
+        precision: int = 0,
+    ) -> None:
+        """Write u, v, p as VTK, decimated by injection and/or cropped natively.
+
+        ASCII values use the shortest round-trip digits, or `precision` significant digits.
+        """
+        ...
+    def write_vtr(
+        self,
+        filename: str,
+        factor: int | tuple[int, int] = 1,
+        roi: tuple[int, int, int, int] | None = None,
+        compress: int = 0,
+        collection: str | None = None,
+    ) -> None:
+        """Write velocity and pressure as VTK XML .vtr with the real grid coordinates.
+
+        With collection, the file is also appended to that .pvd at the current time.
+        """
+        ...
+    def write_csv(
+        self,
+        filename: str,
+        factor: int | tuple[int, int] = 1,
+        roi: tuple[int, int, int, int] | None = None,
+        create_new: bool = False,
+    ) -> None:
+        """Append a CSV timeseries row computed on the decimated and/or cropped fields."""
+        ...
+    def energy_spectrum(self, skip_endpoint: bool = False) -> dict[str, Any]:
+        """energy_spectrum() on the live u, v and simulation grid, without copying."""
+        ...
+    def set_particles(self, x: Any, y: Any = None, method: str = "rk4", every: int = 1) -> None:
+        """Seed tracers advected by every*dt inside the step loop (x=None removes them)."""
+        ...
+    def advect_particles(self, dt: float | None = None, steps: int = 1) -> int:
+        """Advect the tracers through the current field; returns the active count."""
+        ...
+    def add_output(
+        self,
+        type: int,
+        pattern: str,
+        every: int = 1,
+        binary: bool = False,
+        precision: int = 0,
+    ) -> None:
+        """Write an OUTPUT_* file every `every` steps inside the step loop.
+
+        `pattern` may hold one %d-style step conversion ("flow_%06d.vtk");
+        without one, CSV types append rows to a single file and VTK types
+        overwrite it. A failed write stops step() with CFDIOError.
+        """
+        ...
+    def clear_outputs(self) -> None:
+        """Remove all scheduled outputs."""
+        ...
+    def set_divergence_guard(
+        self,
+        check_every: int = 10,
+        max_velocity: float = 0.0,
+        max_retries: int = 3,
+        dt_factor: float = 0.5,
+        history: int = 2,
+    ) -> None:
+        """Enable NaN/Inf and velocity blow-up checks with rollback and dt retry.
+
+        Args:
+            check_every: Check interval in steps (0 disables the guard)
+            max_velocity: Velocity magnitude limit (<= 0 checks NaN/Inf only)
+            max_retries: Rollbacks allowed per divergence before CFDDivergedError
+            dt_factor: dt multiplier applied on each retry, in (0, 1)
+            history: Number of verified states kept for rollback
+        """
+        ...
+    def start_averaging(self, every: int = 1) -> None:
+        """Start (or restart) running mean, second-moment and min/max accumulators.
+
+        Args:
+            every: Sampling interval in steps
+        """
+        ...
+    def stop_averaging(self) -> None:
+        """Detach the accumulators; earlier views keep their final values."""
+        ...
+    def set_probes(
+        self,
+        points: Sequence[tuple[float, float]] | None,
+        every: int = 1,
+        max_samples: int = 0,
+    ) -> None:
+        """Record bilinearly interpolated u, v, p at fixed points inside the step loop.
+
+        Args:
+            points: (x, y) pairs inside the grid, or None to remove the probes
+            every: Sampling interval in steps
+            max_samples: Ring-buffer size (0 grows without limit)
+        """
+        ...
+    def probe_data(self, clear: bool = False) -> dict[str, Any] | None:
+        """Recorded samples: time/step views and one packed (u, v, p) view per probe."""
+        ...
+    def set_diagnostics(self, every: int = 1, max_samples: int = 0) -> None:
+        """Record kinetic energy, enstrophy, edge fluxes and max divergence in the step loop.
+
+        Args:
+            every: Sampling interval in steps (0 disables)
+            max_samples: Ring-buffer size (0 grows without limit)
+        """
+        ...
+    def diagnostic_data(self, clear: bool = False) -> dict[str, Any] | None:
+        """Recorded diagnostics: one float64 view per column plus 'samples'/'dropped'."""
+        ...
+
+class AsyncWriter:
+    """Background snapshot writer with a pool of reusable field buffers."""
+
+    pending: int
+    closed: bool
+    stats: dict[str, int]
+
+    def __init__(self, buffers: int = 2) -> None: ...
+    def write(
+        self,
+        simulation: Simulation,
+        filename: str,
+        format: str = "vtk",
+        factor: int | tuple[int, int] = 1,
+        roi: tuple[int, int, int, int] | None = None,
+        binary: bool = False,
+        compress: int = 0,
+        collection: str | None = None,
+        create_new: bool = False,
+        precision: int = 0,
+    ) -> None:
+        """Copy the live state into a free buffer and write it on the writer thread.
+
+        Waits for a buffer when all are queued. Raises OSError for earlier failed writes.
+        """
+        ...
+    def flush(self) -> None:
+        """Wait for all queued snapshots; raise OSError for the first failure."""
+        ...
+    def close(self) -> None:
+        """Flush and stop the writer thread."""
+        ...
+    def __enter__(self) -> AsyncWriter: ...
+    def __exit__(self, *args: object) -> bool: ...
+
+class CsvWriter:
+    """CSV timeseries log that keeps its file open behind a large buffer.
+
+    Columns: step, time, dt, max_u, max_v, max_p (largest magnitudes),
+    avg_u, avg_v, avg_p, iterations.
+    """
+
+    def __init__(
+        self,
+        filename: str,
+        append: bool = False,
+        buffer_size: int = 1048576,
+        flush_every: int = 0,
+        precision: int = 0,
+    ) -> None: ...
+    @property
+    def rows(self) -> int: ...
+    @property
+    def closed(self) -> bool: ...
+    @property
+    def filename(self) -> str: ...
+    def write(
+        self,
+        source: Simulation | FieldSnapshot | dict[str, Any],
+        step: int | None = None,
+        time: float | None = None,
+        dt: float | None = None,
+        iterations: int | None = None,
+    ) -> None:
+        """Append one row computed natively from the source's u, v and p (no copy).
+
+        step and time default to the Simulation's or FieldSnapshot's own values
+        and are required for dict sources.
+        """
+        ...
+    def flush(self) -> None:
+        """Write buffered rows to the file."""
+        ...
+    def close(self) -> None:
+        """Flush and close the file."""
+        ...
+    def __enter__(self) -> CsvWriter: ...
+    def __exit__(self, *args: object) -> bool: ...
+
+class SnapshotWriter:
+    """Append-only writer of a snapshot store read back with SnapshotStore.
+
+    Each write() adds one record: step, time, then u, v and p as raw float64
+    arrays on 64-byte boundaries, compressed with compress=True, or lossy
+    within max_error (a fraction of each field's range with relative=True).
+    Steps must be strictly increasing.
+    """
+
+    def __init__(
+        self,
+        filename: str,
+        nx: int,
+        ny: int,
+        append: bool = False,
+        compress: bool = False,
+        max_error: float = 0.0,
+        relative: bool = False,
+    ) -> None: ...
+    @property
+    def closed(self) -> bool: ...
+    @property
+    def compression_ratio(self) -> float: ...
+    @property
+    def nbytes(self) -> int: ...
+    @property
+    def filename(self) -> str: ...
+    @property
+    def nx(self) -> int: ...
+    @property
+    def ny(self) -> int: ...
+    def __len__(self) -> int: ...
+    def write(
+        self,
+        source: Simulation | FieldSnapshot | dict[str, Any],
+        step: int | None = None,
+        time: float | None = None,
+    ) -> None:
+        """Append the source's u, v and p as one record (no intermediate copy).
+
+        step and time default to the Simulation's or FieldSnapshot's own values
+        and are required for dict sources.
+        """
+        ...
+    def flush(self) -> None:
+        """Write buffered data to the file so readers can map it."""
+        ...
+    def close(self) -> None:
+        """Flush and close the file."""
+        ...
+    def __enter__(self) -> SnapshotWriter: ...
+    def __exit__(self, *args: object) -> bool: ...
+
+class SnapshotStore:
+    """Read-only memory-mapped view of a file written by SnapshotWriter (POSIX only).
+
+    store[step] returns a FieldSnapshot of read-only zero-copy views (decoded
+    copies for compressed records) and raises KeyError for steps that were not
+    stored.
+    """
+
+    def __init__(self, filename: str) -> None: ...
+    @property
+    def steps(self) -> list[int]: ...
+    @property
+    def times(self) -> list[float]: ...
+    @property
+    def filename(self) -> str: ...
+    @property
+    def nx(self) -> int: ...
+    @property
+    def ny(self) -> int: ...
+    def __len__(self) -> int: ...
+    def __contains__(self, step: object) -> bool: ...
+    def __getitem__(self, step: int) -> FieldSnapshot: ...
+    def at(self, position: int) -> FieldSnapshot:
+        """Snapshot at a position in step order (negative counts from the end)."""
+        ...
+
+def reinit_after_fork(num_threads: int = 0, reset_library: bool = False) -> None:
+    """Reset library state in a forked child process.
+
+    Registered automatically with os.register_at_fork(after_in_child=...),
+    where it only clears the error state so inherited Simulations stay valid.
+
+    Args:
+        num_threads: OpenMP threads for later parallel regions (0 leaves the
+            setting unchanged); the OpenMP runtime is not reinitialized
+        reset_library: Recreate the solver registry and re-initialize the CFD
+            library; inherited Simulations must then be recreated
+    """
+    ...
+
+def run_ensemble(
+    simulations: Sequence[Simulation],
+    steps: int,
+    check_every: int = 10,
+    max_velocity: float = 0.0,
+    max_pressure: float = 0.0,
+    max_residual: float = 0.0,
+    max_divergence: float = 0.0,
+    converge_tol: float = 0.0,
+    num_threads: int = 0,
+) -> list[dict[str, Any]]:
+    """Advance several simulations in parallel with early-exit predicates.
+
+    Predicates are evaluated in C every check_every steps; thresholds <= 0
+    are disabled. NaN/Inf fields always stop a member.
+
+    Returns:
+        One dict per member with 'status' ('completed', 'converged',
+        'max_velocity', 'max_pressure', 'max_residual', 'max_divergence',
+        'diverged' or 'error'), 'steps', 'step_count', 'time', the sampled
+        'max_velocity', 'max_pressure', 'residual', 'max_divergence' and
+        'error_code'
+    """
+    ...
+
+def attach_shared_result(name: str | dict[str, Any], unlink: bool = False) -> dict[str, Any]:
+    """Attach to a shared-memory result segment without copying.
+
+    Args:
+        name: Segment name, or the 'shm' descriptor returned by
+            run_simulation_with_params
+        unlink: Remove the segment name after attaching (default: False)
+
+    Returns:
+        Dictionary with 'name', 'nx', 'ny' and one flat memoryview of
+        doubles per field (velocity_magnitude, u, v, p)
+    """
+    ...
+
+def unlink_shared_result(name: str) -> None:
+    """Remove a shared-memory result segment name."""
+    ...
+
 def create_grid(
     nx: int,
     ny: int,
@@ -297,6 +794,8 @@ def write_vtk_scalar(
     nz: int = 1,
     zmin: float = 0.0,
     zmax: float = 0.0,
+    binary: bool = False,
+    precision: int = 0,
 ) -> None:
     """Write scalar field to VTK file."""
     ...
@@ -316,6 +815,8 @@ def write_vtk_vector(
     nz: int = 1,
     zmin: float = 0.0,
     zmax: float = 0.0,
+    binary: bool = False,
+    precision: int = 0,
 ) -> None:
     """Write vector field to VTK file."""
     ...
@@ -336,6 +837,81 @@ def write_csv_timeseries(
     """Write simulation timeseries data to CSV file."""
     ...
 
+def write_vtr(
+    filename: str,
+    data: Any,
+    nx: int,
+    ny: int,
+    grid: Grid | dict[str, Any] | None = None,
+    vectors: dict[str, Sequence[Any]] | None = None,
+    compress: int = 0,
+) -> None:
+    """Write fields as a VTK XML rectilinear grid with appended raw float64 data.
+
+    Args:
+        data: One field buffer, or a dict of scalar field name -> buffer
+        nx, ny: Grid dimensions
+        grid: Grid or create_grid*() result whose coordinates are written; None
+            is the unit square
+        vectors: Vector field name -> (u, v) or (u, v, w) buffers
+        compress: zlib level 1-9 for block compression, 0 for raw data
+
+    Raises:
+        NotImplementedError: If compress is set and the build has no zlib
+    """
+    ...
+
+def append_pvd(
+    filename: str,
+    dataset: str,
+    time: float,
+    part: int = 0,
+    create_new: bool = False,
+) -> None:
+    """Append one dataset entry to a .pvd collection without rewriting it."""
+    ...
+
+def compress_field(
+    data: Sequence[float] | Any, max_error: float = 0.0, relative: bool = False
+) -> bytearray:
+    """Compress a float64 field losslessly (XOR-delta, byte shuffle, LZ).
+
+    A positive max_error selects lossy coding where every value is decoded
+    within max_error (times the field's range with relative=True). Chunks of
+    16384 values are encoded in parallel with the GIL released.
+    """
+    ...
+
+def decompress_field(data: bytes | bytearray | Any, out: Any = None) -> memoryview | Any:
+    """Decode the output of compress_field(), into out when given."""
+    ...
+
+def save_npy(
+    filename: str, data: Sequence[float] | Any, shape: int | Sequence[int] | None = None
+) -> None:
+    """Write a float64 field straight to a NumPy .npy file (flat unless shape is given)."""
+    ...
+
+def save_npz(
+    filename: str,
+    arrays: Simulation | FieldSnapshot | dict[str, Any],
+    shape: int | Sequence[int] | None = None,
+) -> None:
+    """Write fields as one uncompressed .npz archive.
+
+    A Simulation or FieldSnapshot gives u, v and p with shape (ny, nx); a dict
+    gives one member per entry.
+    """
+    ...
+
+def load_npy(filename: str, writable: bool = False) -> memoryview:
+    """Map a float64 .npy file and return a zero-copy view with its shape.
+
+    Empty arrays come back flat (length 0), since memoryview cannot hold a
+    shape containing 0. With writable=True the mapping is copy-on-write; the file is never changed.
+    """
+    ...
+
 # Error handling functions
 def get_last_error() -> str | None:
     """Get the last CFD error message, or None if no error."""
@@ -371,16 +947,18 @@ def bc_backend_available(backend: int) -> bool:
     ...
 
 # Boundary condition application functions
-def bc_apply_scalar(field: list[float], nx: int, ny: int, bc_type: int) -> None:
+def bc_apply_scalar(field: list[float] | Any, nx: int, ny: int, bc_type: int) -> None:
     """Apply boundary conditions to a scalar field (modifies in place)."""
     ...
 
-def bc_apply_velocity(u: list[float], v: list[float], nx: int, ny: int, bc_type: int) -> None:
+def bc_apply_velocity(
+    u: list[float] | Any, v: list[float] | Any, nx: int, ny: int, bc_type: int
+) -> None:
     """Apply boundary conditions to velocity fields (modifies in place)."""
     ...
 
 def bc_apply_dirichlet(
-    field: list[float],
+    field: list[float] | Any,
     nx: int,
     ny: int,
     left: float,
@@ -391,13 +969,13 @@ def bc_apply_dirichlet(
     """Apply Dirichlet boundary conditions with per-edge values (modifies in place)."""
     ...
 
-def bc_apply_noslip(u: list[float], v: list[float], nx: int, ny: int) -> None:
+def bc_apply_noslip(u: list[float] | Any, v: list[float] | Any, nx: int, ny: int) -> None:
     """Apply no-slip wall boundary conditions (modifies in place)."""
     ...
 
 def bc_apply_inlet_uniform(
-    u: list[float],
-    v: list[float],
+    u: list[float] | Any,
+    v: list[float] | Any,
     nx: int,
     ny: int,
     u_inlet: float,
@@ -408,8 +986,8 @@ def bc_apply_inlet_uniform(
     ...
 
 def bc_apply_inlet_parabolic(
-    u: list[float],
-    v: list[float],
+    u: list[float] | Any,
+    v: list[float] | Any,
     nx: int,
     ny: int,
     max_velocity: float,
@@ -418,12 +996,12 @@ def bc_apply_inlet_parabolic(
     """Apply parabolic inlet boundary conditions (modifies in place)."""
     ...
 
-def bc_apply_outlet_scalar(field: list[float], nx: int, ny: int, edge: int = ...) -> None:
+def bc_apply_outlet_scalar(field: list[float] | Any, nx: int, ny: int, edge: int = ...) -> None:
     """Apply zero-gradient outlet BC to scalar field (modifies in place)."""
     ...
 
 def bc_apply_outlet_velocity(
-    u: list[float], v: list[float], nx: int, ny: int, edge: int = ...
+    u: list[float] | Any, v: list[float] | Any, nx: int, ny: int, edge: int = ...
 ) -> None:
     """Apply zero-gradient outlet BC to velocity fields (modifies in place)."""
     ...
@@ -452,6 +1030,174 @@ def compute_flow_statistics(
     """
     ...
 
+def field_statistics(
+    data: Any,
+    bins: int = 0,
+    range: tuple[float, float] | None = None,
+    percentiles: Iterable[float] | None = None,
+) -> dict[str, Any]:
+    """Compute field statistics in one OpenMP-parallel pass.
+
+    NaN and Inf values are counted and excluded from every other statistic.
+
+    Args:
+        data: List, NumPy float64 array or float64 buffer (e.g. Simulation.u)
+        bins: Histogram bins (0 for no histogram)
+        range: Histogram (lo, hi); defaults to (min, max) with a second pass
+        percentiles: Percentiles in [0, 100], approximated from a 4096-bin histogram
+
+    Returns:
+        'count', 'nan_count', 'inf_count', 'min', 'max', 'sum', 'avg',
+        'variance' (population), 'std', 'rms', 'l1', 'l2', 'linf', plus
+        'histogram' ('counts', 'edges', 'below', 'above') and 'percentiles'
+        ({q: value}) when requested
+    """
+    ...
+
+def compute_derived_fields(
+    u: Any,
+    v: Any,
+    nx: int,
+    ny: int,
+    grid: Grid | dict[str, Any] | None = None,
+    p: Any = None,
+    fields: Iterable[str] | None = None,
+    out: dict[str, Any] | None = None,
+) -> dict[str, Any]:
+    """Compute velocity-gradient quantities in one fused, OpenMP-parallel sweep.
+
+    Args:
+        u, v: Velocity components (lists, NumPy float64 arrays or float64 buffers)
+        nx, ny: Grid dimensions (at least 3 each)
+        grid: Grid, create_grid() dict, or None for the unit square
+        p: Pressure, required for 'dpdx'/'dpdy'
+        fields: Subset of 'vorticity', 'divergence', 'strain_rate',
+            'q_criterion', 'dpdx', 'dpdy' (default: all available)
+        out: Writable float64 buffers filled in place, keyed by field name;
+            they must not overlap an input or each other
+
+    Returns:
+        Field name -> buffer; `out` buffers are returned as given, others are
+        new flat memoryviews of doubles
+    """
+    ...
+
+def sample_lines(
+    data: Any,
+    nx: int,
+    ny: int,
+    lines: Sequence[Any],
+    grid: Grid | dict[str, Any] | None = None,
+    num_points: int = 100,
+) -> list[dict[str, Any]]:
+    """Sample fields along many lines in one batched, OpenMP-parallel pass.
+
+    Args:
+        data: One field buffer, or a dict of field name -> buffer
+        nx, ny: Grid dimensions
+        lines: {'x': x0} / {'y': y0} grid lines, or polylines of (x, y) pairs
+        grid: Grid, create_grid() dict, or None for the unit square
+        num_points: Samples per polyline, evenly spaced by arc length
+
+    Returns:
+        One dict per line with 'x', 'y', 'distance' and one view per field
+        ('values' for a single buffer); polyline samples outside the grid are NaN
+    """
+    ...
+
+def compare_fields(a: Any, b: Any, nx: int = 0) -> dict[str, Any]:
+    """Compare a field against the reference b in one OpenMP-parallel pass.
+
+    Args:
+        a: Field to check (list, NumPy float64 array or float64 buffer)
+        b: Reference field of the same size
+        nx: Row length; adds 'max_location' = (i, j) when > 0
+
+    Returns:
+        'count', 'nan_mismatch', 'exact', 'l1', 'l2', 'linf', 'rel_l1',
+        'rel_l2', 'rel_linf', 'max_ulp', 'mean_ulp' and 'max_index'
+    """
+    ...
+
+def compare_flow_fields(a: Any, b: Any) -> dict[str, dict[str, Any]]:
+    """compare_fields() on u, v and p of two Simulations, FieldSnapshots or dicts."""
+    ...
+
+def resample_fields(
+    data: Any,
+    nx: int,
+    ny: int,
+    factor: int | tuple[int, int] = 1,
+    roi: tuple[int, int, int, int] | None = None,
+    mode: str = "average",
+    grid: Grid | dict[str, Any] | None = None,
+) -> dict[str, Any]:
+    """Restrict fields by integer factors and/or extract an index-space region.
+
+    Args:
+        data: One field buffer, or a dict of field name -> buffer
+        nx, ny: Grid dimensions
+        factor: Reduction factor, or (fx, fy) per axis
+        roi: Index window (i0, i1, j0, j1), ends exclusive; None for the whole grid
+        mode: 'average' (block means) or 'inject' (every factor-th node)
+        grid: Grid, create_grid() dict, or None for the unit square
+
+    Returns:
+        'nx', 'ny', 'x' and 'y' coordinate views, and one view per field
+        ('values' for a single buffer)
+    """
+    ...
+
+def energy_spectrum(
+    u: Any,
+    v: Any,
+    nx: int,
+    ny: int,
+    grid: Grid | dict[str, Any] | None = None,
+    skip_endpoint: bool = False,
+) -> dict[str, Any]:
+    """Kinetic energy spectra of periodic u, v fields on a uniform grid.
+
+    Args:
+        u, v: Velocity fields (lists, NumPy float64 arrays or float64 buffers)
+        nx, ny: Grid dimensions
+        grid: Uniform Grid, create_grid() dict, or None for the unit square
+        skip_endpoint: Drop the last column and row when they repeat the first
+
+    Returns:
+        'k'/'E' shell spectrum, 'kx'/'E_x' and 'ky'/'E_y' 1D spectra, 'dk'
+        (shell width) and 'energy' (1/2 <u^2 + v^2>); each spectrum sums to 'energy'
+    """
+    ...
+
+def advect_particles(
+    x: Any,
+    y: Any,
+    u: Any,
+    v: Any,
+    nx: int,
+    ny: int,
+    dt: float,
+    steps: int = 1,
+    grid: Grid | dict[str, Any] | None = None,
+    method: str = "rk4",
+) -> int:
+    """Advect massless particles in place through a frozen velocity field.
+
+    Args:
+        x, y: Writable float64 position buffers (e.g. NumPy arrays), updated in place
+        u, v: Velocity fields of nx*ny elements
+        nx, ny: Grid dimensions
+        dt: Step size
+        steps: Number of steps
+        grid: Grid, create_grid() dict, or None for the unit square
+        method: 'rk2' (midpoint) or 'rk4'
+
+    Returns:
+        Particles still inside the grid; particles that leave become NaN
+    """
+    ...
+
 # Solver backend availability functions
 def backend_is_available(backend: int) -> bool:
     """Check if a solver backend is available at runtime."""
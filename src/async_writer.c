@@ -0,0 +1,258 @@
+/*
+ * Background writer thread over a fixed pool of job slots
+ */
+
+#include "async_writer.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <process.h>
+#include <windows.h>
+
+typedef CRITICAL_SECTION aw_mutex;
+typedef CONDITION_VARIABLE aw_cond;
+typedef HANDLE aw_thread;
+
+static void aw_mutex_init(aw_mutex* m) { InitializeCriticalSection(m); }
+static void aw_mutex_destroy(aw_mutex* m) { DeleteCriticalSection(m); }
+static void aw_lock(aw_mutex* m) { EnterCriticalSection(m); }
+static void aw_unlock(aw_mutex* m) { LeaveCriticalSection(m); }
+static void aw_cond_init(aw_cond* c) { InitializeConditionVariable(c); }
+static void aw_cond_destroy(aw_cond* c) { (void)c; }
+static void aw_wait(aw_cond* c, aw_mutex* m) { SleepConditionVariableCS(c, m, INFINITE); }
+static void aw_broadcast(aw_cond* c) { WakeAllConditionVariable(c); }
+#else
+#include <pthread.h>
+
+typedef pthread_mutex_t aw_mutex;
+typedef pthread_cond_t aw_cond;
+typedef pthread_t aw_thread;
+
+static void aw_mutex_init(aw_mutex* m) { pthread_mutex_init(m, NULL); }
+static void aw_mutex_destroy(aw_mutex* m) { pthread_mutex_destroy(m); }
+static void aw_lock(aw_mutex* m) { pthread_mutex_lock(m); }
+static void aw_unlock(aw_mutex* m) { pthread_mutex_unlock(m); }
+static void aw_cond_init(aw_cond* c) { pthread_cond_init(c, NULL); }
+static void aw_cond_destroy(aw_cond* c) { pthread_cond_destroy(c); }
+static void aw_wait(aw_cond* c, aw_mutex* m) { pthread_cond_wait(c, m); }
+static void aw_broadcast(aw_cond* c) { pthread_cond_broadcast(c); }
+#endif
+
+#define AW_PATH_MAX 1024
+
+struct async_writer {
+    async_write_fn write;
+    void* context;
+    size_t num_slots;
+
+    // Submitted slots, oldest first (ring buffer), and free slots (stack)
+    size_t* queue;
+    size_t head;
+    size_t queued;
+    size_t* free_slots;
+    size_t num_free;
+    int writing;  // The thread is running a job
+    int stop;
+
+    int error;
+    char error_path[AW_PATH_MAX];
+    async_writer_stats stats;
+
+    aw_mutex lock;
+    aw_cond work;  // Signalled on submit and stop
+    aw_cond done;  // Signalled when a slot returns to the pool
+    aw_thread thread;
+};
+
+static void writer_loop(async_writer* w) {
+    aw_lock(&w->lock);
+    for (;;) {
+        while (w->queued == 0 && !w->stop) {
+            aw_wait(&w->work, &w->lock);
+        }
+        if (w->queued == 0) {
+            break;
+        }
+        size_t slot = w->queue[w->head];
+        w->head = (w->head + 1) % w->num_slots;
+        w->queued--;
+        w->writing = 1;
+        aw_unlock(&w->lock);
+
+        const char* path = NULL;
+        int rc = w->write(w->context, slot, &path);
+
+        aw_lock(&w->lock);
+        w->writing = 0;
+        w->stats.completed++;
+        if (rc != 0) {
+            w->stats.failed++;
+            if (w->error == 0) {
+                w->error = rc;
+                w->error_path[0] = '\0';
+                if (path != NULL) {
+                    strncat(w->error_path, path, AW_PATH_MAX - 1);
+                }
+            }
+        }
+        w->free_slots[w->num_free++] = slot;
+        aw_broadcast(&w->done);
+    }
+    aw_unlock(&w->lock);
+}
+
+#ifdef _WIN32
+static unsigned __stdcall thread_main(void* arg) {
+    writer_loop((async_writer*)arg);
+    return 0;
+}
+#else
+static void* thread_main(void* arg) {
+    writer_loop((async_writer*)arg);
+    return NULL;
+}
+#endif
+
+async_writer* async_writer_create(size_t num_slots, async_write_fn write, void* context) {
+    if (num_slots == 0 || write == NULL) {
+        errno = EINVAL;
+        return NULL;
+    }
+    async_writer* w = (async_writer*)calloc(1, sizeof(async_writer));
+    if (w == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    w->queue = (size_t*)malloc(num_slots * sizeof(size_t));
+    w->free_slots = (size_t*)malloc(num_slots * sizeof(size_t));
+    if (w->queue == NULL || w->free_slots == NULL) {
+        free(w->queue);
+        free(w->free_slots);
+        free(w);
+        errno = ENOMEM;
+        return NULL;
+    }
+    w->write = write;
+    w->context = context;
+    w->num_slots = num_slots;
+    // Hand out slot 0 first
+    for (size_t s = 0; s < num_slots; s++) {
+        w->free_slots[s] = num_slots - 1 - s;
+    }
+    w->num_free = num_slots;
+    aw_mutex_init(&w->lock);
+    aw_cond_init(&w->work);
+    aw_cond_init(&w->done);
+
+#ifdef _WIN32
+    w->thread = (HANDLE)_beginthreadex(NULL, 0, thread_main, w, 0, NULL);
+    int failed = w->thread == 0;
+#else
+    int rc = pthread_create(&w->thread, NULL, thread_main, w);
+    int failed = rc != 0;
+    if (failed) {
+        errno = rc;
+    }
+#endif
+    if (failed) {
+        int saved = errno;
+        aw_cond_destroy(&w->done);
+        aw_cond_destroy(&w->work);
+        aw_mutex_destroy(&w->lock);
+        free(w->queue);
+        free(w->free_slots);
+        free(w);
+        errno = saved;
+        return NULL;
+    }
+    return w;
+}
+
+void async_writer_destroy(async_writer* w) {
+    if (w == NULL) {
+        return;
+    }
+    aw_lock(&w->lock);
+    w->stop = 1;
+    aw_broadcast(&w->work);
+    aw_unlock(&w->lock);
+#ifdef _WIN32
+    WaitForSingleObject(w->thread, INFINITE);
+    CloseHandle(w->thread);
+#else
+    pthread_join(w->thread, NULL);
+#endif
+    aw_cond_destroy(&w->done);
+    aw_cond_destroy(&w->work);
+    aw_mutex_destroy(&w->lock);
+    free(w->queue);
+    free(w->free_slots);
+    free(w);
+}
+
+size_t async_writer_acquire(async_writer* w) {
+    aw_lock(&w->lock);
+    if (w->num_free == 0) {
+        w->stats.stalls++;
+        while (w->num_free == 0) {
+            aw_wait(&w->done, &w->lock);
+        }
+    }
+    size_t slot = w->free_slots[--w->num_free];
+    aw_unlock(&w->lock);
+    return slot;
+}
+
+void async_writer_submit(async_writer* w, size_t slot) {
+    aw_lock(&w->lock);
+    w->queue[(w->head + w->queued) % w->num_slots] = slot;
+    w->queued++;
+    w->stats.submitted++;
+    aw_broadcast(&w->work);
+    aw_unlock(&w->lock);
+}
+
+void async_writer_release(async_writer* w, size_t slot) {
+    aw_lock(&w->lock);
+    w->free_slots[w->num_free++] = slot;
+    aw_broadcast(&w->done);
+    aw_unlock(&w->lock);
+}
+
+int async_writer_flush(async_writer* w, char* path, size_t path_size) {
+    aw_lock(&w->lock);
+    while (w->queued > 0 || w->writing) {
+        aw_wait(&w->done, &w->lock);
+    }
+    int error = w->error;
+    if (error != 0 && path != NULL && path_size > 0) {
+        path[0] = '\0';
+        strncat(path, w->error_path, path_size - 1);
+    }
+    w->error = 0;
+    aw_unlock(&w->lock);
+    return error;
+}
+
+int async_writer_error(async_writer* w) {
+    aw_lock(&w->lock);
+    int error = w->error;
+    aw_unlock(&w->lock);
+    return error;
+}
+
+size_t async_writer_pending(async_writer* w) {
+    aw_lock(&w->lock);
+    size_t pending = w->queued + (size_t)w->writing;
+    aw_unlock(&w->lock);
+    return pending;
+}
+
+void async_writer_get_stats(async_writer* w, async_writer_stats* stats) {
+    aw_lock(&w->lock);
+    *stats = w->stats;
+    aw_unlock(&w->lock);
+}
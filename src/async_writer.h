@@ -0,0 +1,64 @@
+/*
+ * Background writer thread over a fixed pool of job slots
+ *
+ * The caller owns the job payloads; this module only moves slot indices.
+ * A producer acquires a free slot (blocking while every slot is queued or
+ * being written, which is the back-pressure), fills it and submits it. One
+ * writer thread runs the write callback on submitted slots in order and
+ * returns them to the free pool. flush() waits until every submitted job
+ * has finished and reports the first failure since the previous flush.
+ */
+
+#ifndef CFD_PYTHON_ASYNC_WRITER_H
+#define CFD_PYTHON_ASYNC_WRITER_H
+
+#include <stddef.h>
+
+/*
+ * Write the job in `slot`. Runs on the writer thread and must not touch
+ * Python. Returns 0, or an errno value with *path set to the file that
+ * failed (valid until the callback returns).
+ */
+typedef int (*async_write_fn)(void* context, size_t slot, const char** path);
+
+typedef struct {
+    size_t submitted;
+    size_t completed;  // Including failed jobs
+    size_t failed;
+    size_t stalls;     // Acquires that had to wait for a free slot
+} async_writer_stats;
+
+typedef struct async_writer async_writer;
+
+// Start the writer thread. Returns NULL with errno set on failure.
+async_writer* async_writer_create(size_t num_slots, async_write_fn write, void* context);
+
+// Finish queued jobs, stop the thread and free the writer
+void async_writer_destroy(async_writer* writer);
+
+// Index of a free slot, waiting for one if necessary
+size_t async_writer_acquire(async_writer* writer);
+
+// Queue a filled slot, or hand an acquired slot back unused
+void async_writer_submit(async_writer* writer, size_t slot);
+void async_writer_release(async_writer* writer, size_t slot);
+
+/*
+ * Wait for all submitted jobs. Returns 0, or the errno of the first failure
+ * since the last call with its path copied into `path` (if not NULL), and
+ * clears it.
+ */
+int async_writer_flush(async_writer* writer, char* path, size_t path_size);
+
+/*
+ * First failure since the last flush without waiting, or 0; the error stays
+ * pending for flush()
+ */
+int async_writer_error(async_writer* writer);
+
+// Jobs queued or being written
+size_t async_writer_pending(async_writer* writer);
+
+void async_writer_get_stats(async_writer* writer, async_writer_stats* stats);
+
+#endif  // CFD_PYTHON_ASYNC_WRITER_H
@@ -6,8 +6,13 @@
 
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
+#include <structmember.h>
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // Include CFD library headers (v0.2.0 API)
 #include "cfd/core/grid.h"
@@ -25,6 +30,36 @@
 #include "cfd/core/gpu_device.h"
 #include "cfd/core/logging.h"
 
+// Binding-side helpers
+#include "async_writer.h"
+#include "csv_stream.h"
+#include "derived_kernels.h"
+#include "divergence_guard.h"
+#include "double_format.h"
+#include "energy_spectrum.h"
+#include "ensemble.h"
+#include "field_accumulator.h"
+#include "field_codec.h"
+#include "field_compare.h"
+#include "field_resample.h"
+#include "field_state.h"
+#include "field_stats.h"
+#include "flow_diagnostics.h"
+#include "interpolation.h"
+#include "npy_file.h"
+#include "output_schedule.h"
+#include "particle_tracer.h"
+#include "probes.h"
+#include "shm_transport.h"
+#include "snapshot_store.h"
+#include "vtk_ascii.h"
+#include "vtk_binary.h"
+#include "vtk_xml.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // Module-level solver registry (context-bound)
 static ns_solver_registry_t* g_registry = NULL;
 
@@ -45,275 +80,4031 @@ static PyObject* raise_cfd_error(cfd_status_t status, const char* context) {
     return NULL;
 }
 
-/*
- * List available solvers
- */
-static PyObject* list_solvers(PyObject* self, PyObject* args) {
-    (void)self;
-    (void)args;
-
-    if (g_registry == NULL) {
-        PyErr_SetString(PyExc_RuntimeError, "Solver registry not initialized");
-        return NULL;
-    }
+// ============================================================================
+// Zero-Copy Buffer Views
+// ============================================================================
 
-    const char* names[32];
-    int count = cfd_registry_list(g_registry, names, 32);
+// ctypes module, imported on first use
+static PyObject* g_ctypes = NULL;
 
-    PyObject* solver_list = PyList_New(0);
-    if (solver_list == NULL) {
-        return NULL;
-    }
-    for (int i = 0; i < count; i++) {
-        PyObject* name = PyUnicode_FromString(names[i]);
-        if (name == NULL || PyList_Append(solver_list, name) < 0) {
-            Py_XDECREF(name);
-            Py_DECREF(solver_list);
-            return NULL;
-        }
-        Py_DECREF(name);
+static PyObject* get_ctypes(void) {
+    if (g_ctypes == NULL) {
+        g_ctypes = PyImport_ImportModule("ctypes");
     }
-
-    return solver_list;
+    return g_ctypes;
 }
 
-/*
- * Check if a solver type is available
- */
-static PyObject* has_solver(PyObject* self, PyObject* args) {
-    (void)self;
-    const char* solver_type;
-
-    if (!PyArg_ParseTuple(args, "s", &solver_type)) {
+// Build the ctypes array type `<elem> * count` (ctypes caches these types)
+static PyObject* ctypes_array_type(PyObject* ctypes, const char* elem, Py_ssize_t count) {
+    PyObject* elem_type = PyObject_GetAttrString(ctypes, elem);
+    if (elem_type == NULL) {
         return NULL;
     }
-
-    if (g_registry == NULL) {
-        PyErr_SetString(PyExc_RuntimeError, "Solver registry not initialized");
+    PyObject* py_count = PyLong_FromSsize_t(count);
+    if (py_count == NULL) {
+        Py_DECREF(elem_type);
         return NULL;
     }
-
-    int available = cfd_registry_has(g_registry, solver_type);
-    return PyBool_FromLong(available);
+    PyObject* array_type = PyNumber_Multiply(elem_type, py_count);
+    Py_DECREF(elem_type);
+    Py_DECREF(py_count);
+    return array_type;
 }
 
 /*
- * Get solver information
+ * Wrap externally owned memory as a flat memoryview of doubles without copying.
+ *
+ * The limited API has no buffer-exporting slots, so the memory is exposed
+ * through a ctypes array created with from_address(). The array keeps a
+ * reference to `owner` (as its `_owner` attribute), which must keep `data`
+ * alive for as long as any view exists.
  */
-static PyObject* get_solver_info(PyObject* self, PyObject* args) {
-    (void)self;
-    const char* solver_type;
+static PyObject* make_double_view(PyObject* owner, double* data, Py_ssize_t count, int readonly) {
+    PyObject* raw = NULL;
+    PyObject* view = NULL;
 
-    if (!PyArg_ParseTuple(args, "s", &solver_type)) {
-        return NULL;
+    if (count == 0 || data == NULL) {
+        PyObject* empty = PyByteArray_FromStringAndSize(NULL, 0);
+        if (empty == NULL) {
+            return NULL;
+        }
+        raw = PyMemoryView_FromObject(empty);
+        Py_DECREF(empty);
+    } else {
+        PyObject* ctypes = get_ctypes();
+        if (ctypes == NULL) {
+            return NULL;
+        }
+        PyObject* array_type = ctypes_array_type(ctypes, "c_double", count);
+        if (array_type == NULL) {
+            return NULL;
+        }
+        PyObject* array = PyObject_CallMethod(array_type, "from_address", "n", (Py_ssize_t)(uintptr_t)data);
+        Py_DECREF(array_type);
+        if (array == NULL) {
+            return NULL;
+        }
+        if (PyObject_SetAttrString(array, "_owner", owner) < 0) {
+            Py_DECREF(array);
+            return NULL;
+        }
+        raw = PyMemoryView_FromObject(array);
+        Py_DECREF(array);
     }
-
-    if (g_registry == NULL) {
-        PyErr_SetString(PyExc_RuntimeError, "Solver registry not initialized");
+    if (raw == NULL) {
         return NULL;
     }
 
-    // Create a temporary solver to get its info
-    ns_solver_t* solver = cfd_solver_create(g_registry, solver_type);
-    if (solver == NULL) {
-        PyErr_Format(PyExc_ValueError, "Unknown solver type: %s", solver_type);
+    // ctypes exports '<d'; go through bytes to get a plain 'd' view
+    PyObject* bytes_view = PyObject_CallMethod(raw, "cast", "s", "B");
+    Py_DECREF(raw);
+    if (bytes_view == NULL) {
         return NULL;
     }
-
-    PyObject* info = PyDict_New();
-    if (info == NULL) {
-        solver_destroy(solver);
+    view = PyObject_CallMethod(bytes_view, "cast", "s", "d");
+    Py_DECREF(bytes_view);
+    if (view == NULL) {
         return NULL;
     }
 
-    // Helper macro to add string to dict with proper refcount
-    #define ADD_STRING_TO_DICT(dict, key, value) do { \
-        PyObject* tmp = PyUnicode_FromString(value); \
-        if (tmp == NULL) { Py_DECREF(dict); solver_destroy(solver); return NULL; } \
-        PyDict_SetItemString(dict, key, tmp); \
-        Py_DECREF(tmp); \
-    } while(0)
-
-    ADD_STRING_TO_DICT(info, "name", solver->name);
-    ADD_STRING_TO_DICT(info, "description", solver->description);
-    ADD_STRING_TO_DICT(info, "version", solver->version);
+    if (readonly) {
+        PyObject* ro = PyObject_CallMethod(view, "toreadonly", NULL);
+        Py_DECREF(view);
+        return ro;
+    }
+    return view;
+}
 
-    #undef ADD_STRING_TO_DICT
+/*
+ * Contiguous doubles borrowed from a Python object.
+ *
+ * `owner` is a strong reference that keeps `data` valid. When the input had
+ * to be converted (lists, tuples, read-only or misaligned buffers) `copied`
+ * is set and `owner` is a private bytearray holding the converted values.
+ */
+typedef struct {
+    PyObject* owner;
+    double* data;
+    Py_ssize_t count;
+    int readonly;
+    int copied;
+} double_buffer;
+
+static void release_double_buffer(double_buffer* buf) {
+    Py_CLEAR(buf->owner);
+    buf->data = NULL;
+    buf->count = 0;
+}
 
-    // Build capabilities list
-    PyObject* caps = PyList_New(0);
-    if (caps == NULL) {
-        Py_DECREF(info);
-        solver_destroy(solver);
-        return NULL;
+// True if the `na` doubles at `a` share memory with the `nb` doubles at `b`
+static int double_ranges_overlap(const double* a, size_t na, const double* b, size_t nb) {
+    if (a == NULL || b == NULL || na == 0 || nb == 0) {
+        return 0;
     }
+    uintptr_t a0 = (uintptr_t)a;
+    uintptr_t b0 = (uintptr_t)b;
+    return a0 < b0 + nb * sizeof(double) && b0 < a0 + na * sizeof(double);
+}
 
-    // Helper macro to append capability string
-    #define APPEND_CAP(list, cap_flag, cap_name) do { \
-        if (solver->capabilities & cap_flag) { \
-            PyObject* s = PyUnicode_FromString(cap_name); \
-            if (s == NULL || PyList_Append(list, s) < 0) { \
-                Py_XDECREF(s); Py_DECREF(list); Py_DECREF(info); \
-                solver_destroy(solver); return NULL; \
-            } \
-            Py_DECREF(s); \
-        } \
-    } while(0)
-
-    APPEND_CAP(caps, NS_SOLVER_CAP_INCOMPRESSIBLE, "incompressible");
-    APPEND_CAP(caps, NS_SOLVER_CAP_COMPRESSIBLE, "compressible");
-    APPEND_CAP(caps, NS_SOLVER_CAP_STEADY_STATE, "steady_state");
-    APPEND_CAP(caps, NS_SOLVER_CAP_TRANSIENT, "transient");
-    APPEND_CAP(caps, NS_SOLVER_CAP_SIMD, "simd");
-    APPEND_CAP(caps, NS_SOLVER_CAP_PARALLEL, "parallel");
-    APPEND_CAP(caps, NS_SOLVER_CAP_GPU, "gpu");
+static int is_little_endian(void) {
+    const uint16_t probe = 1;
+    return *(const uint8_t*)&probe == 1;
+}
 
-    #undef APPEND_CAP
+// Take ownership of `owner` and point `buf` at `nbytes` bytes of doubles at `ptr`
+static int adopt_double_buffer(double_buffer* buf, PyObject* owner, void* ptr,
+                               Py_ssize_t nbytes, int readonly, int copied) {
+    if (nbytes % (Py_ssize_t)sizeof(double) != 0) {
+        Py_DECREF(owner);
+        PyErr_SetString(PyExc_ValueError, "buffer size is not a multiple of 8 bytes");
+        return -1;
+    }
+    buf->owner = owner;
+    buf->data = (double*)ptr;
+    buf->count = nbytes / (Py_ssize_t)sizeof(double);
+    buf->readonly = readonly;
+    buf->copied = copied;
+    return 0;
+}
 
-    PyDict_SetItemString(info, "capabilities", caps);
-    Py_DECREF(caps);
+// Copy any buffer-like object into a private bytearray
+static int copy_to_double_buffer(PyObject* obj, double_buffer* buf) {
+    PyObject* copy = PyByteArray_FromObject(obj);
+    if (copy == NULL) {
+        return -1;
+    }
+    return adopt_double_buffer(buf, copy, PyByteArray_AsString(copy),
+                               PyByteArray_Size(copy), 0, 1);
+}
 
-    solver_destroy(solver);
-    return info;
+static int sequence_to_double_buffer(PyObject* seq, double_buffer* buf) {
+    Py_ssize_t n = PySequence_Size(seq);
+    if (n < 0) {
+        return -1;
+    }
+    PyObject* storage = PyByteArray_FromStringAndSize(NULL, n * (Py_ssize_t)sizeof(double));
+    if (storage == NULL) {
+        return -1;
+    }
+    double* data = (double*)PyByteArray_AsString(storage);
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject* item = PySequence_GetItem(seq, i);
+        if (item == NULL) {
+            Py_DECREF(storage);
+            return -1;
+        }
+        data[i] = PyFloat_AsDouble(item);
+        Py_DECREF(item);
+        if (data[i] == -1.0 && PyErr_Occurred()) {
+            Py_DECREF(storage);
+            return -1;
+        }
+    }
+    return adopt_double_buffer(buf, storage, data, n * (Py_ssize_t)sizeof(double), 0, 1);
 }
 
 /*
- * Simple high-level run_simulation function
+ * Resolve an object exposing __array_interface__ (NumPy arrays and friends).
+ * Returns 1 if handled, 0 if the object has no array interface, -1 on error.
  */
-static PyObject* run_simulation(PyObject* self, PyObject* args, PyObject* kwds) {
-    (void)self;
-    static char* kwlist[] = {"nx", "ny", "steps", "xmin", "xmax", "ymin", "ymax",
-                             "solver_type", "output_file", NULL};
-    size_t nx, ny, steps = 100;
-    double xmin = 0.0, xmax = 1.0, ymin = 0.0, ymax = 1.0;
-    const char* solver_type = NULL;
-    const char* output_file = NULL;
-
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "nn|nddddss", kwlist,
-                                     &nx, &ny, &steps, &xmin, &xmax, &ymin, &ymax,
-                                     &solver_type, &output_file)) {
-        return NULL;
+static int array_interface_to_double_buffer(PyObject* obj, double_buffer* buf) {
+    PyObject* iface = PyObject_GetAttrString(obj, "__array_interface__");
+    if (iface == NULL) {
+        PyErr_Clear();
+        return 0;
+    }
+    if (!PyDict_Check(iface)) {
+        Py_DECREF(iface);
+        return 0;
+    }
+
+    PyObject* typestr = PyDict_GetItemString(iface, "typestr");
+    PyObject* data = PyDict_GetItemString(iface, "data");
+    PyObject* shape = PyDict_GetItemString(iface, "shape");
+    PyObject* strides = PyDict_GetItemString(iface, "strides");
+    const char* expected = is_little_endian() ? "<f8" : ">f8";
+
+    if (typestr == NULL || !PyUnicode_Check(typestr) ||
+        PyUnicode_CompareWithASCIIString(typestr, expected) != 0) {
+        Py_DECREF(iface);
+        PyErr_SetString(PyExc_TypeError, "array must have dtype float64");
+        return -1;
+    }
+    if (data == NULL || !PyTuple_Check(data) || PyTuple_Size(data) != 2 ||
+        shape == NULL || !PyTuple_Check(shape)) {
+        Py_DECREF(iface);
+        return 0;
+    }
+
+    Py_ssize_t count = 1;
+    for (Py_ssize_t i = 0; i < PyTuple_Size(shape); i++) {
+        count *= PyLong_AsSsize_t(PyTuple_GetItem(shape, i));
+    }
+    if (PyErr_Occurred()) {
+        Py_DECREF(iface);
+        return -1;
+    }
+
+    // Non-contiguous arrays are copied in logical order via the buffer protocol
+    if (strides != NULL && strides != Py_None) {
+        Py_ssize_t expected_stride = (Py_ssize_t)sizeof(double);
+        int contiguous = 1;
+        for (Py_ssize_t i = PyTuple_Size(strides) - 1; i >= 0 && contiguous; i--) {
+            contiguous = PyLong_AsSsize_t(PyTuple_GetItem(strides, i)) == expected_stride;
+            expected_stride *= PyLong_AsSsize_t(PyTuple_GetItem(shape, i));
+        }
+        if (!contiguous) {
+            Py_DECREF(iface);
+            PyObject* view = PyMemoryView_FromObject(obj);
+            if (view == NULL) {
+                return -1;
+            }
+            PyObject* bytes = PyObject_CallMethod(view, "tobytes", NULL);
+            Py_DECREF(view);
+            if (bytes == NULL) {
+                return -1;
+            }
+            int rc = copy_to_double_buffer(bytes, buf);
+            Py_DECREF(bytes);
+            return rc < 0 ? -1 : 1;
+        }
     }
 
-    simulation_data* sim_data;
-    if (solver_type) {
-        sim_data = init_simulation_with_solver(nx, ny, 1, xmin, xmax, ymin, ymax, 0.0, 0.0, solver_type);
-    } else {
-        sim_data = init_simulation(nx, ny, 1, xmin, xmax, ymin, ymax, 0.0, 0.0);
+    void* ptr = PyLong_AsVoidPtr(PyTuple_GetItem(data, 0));
+    int readonly = PyObject_IsTrue(PyTuple_GetItem(data, 1));
+    Py_DECREF(iface);
+    if (PyErr_Occurred()) {
+        return -1;
+    }
+    if ((uintptr_t)ptr % sizeof(double) != 0) {
+        return copy_to_double_buffer(obj, buf) < 0 ? -1 : 1;
     }
+    Py_INCREF(obj);
+    return adopt_double_buffer(buf, obj, ptr, count * (Py_ssize_t)sizeof(double),
+                               readonly, 0) < 0 ? -1 : 1;
+}
 
-    if (sim_data == NULL) {
-        if (solver_type) {
-            PyErr_Format(PyExc_RuntimeError, "Failed to initialize simulation with solver '%s'", solver_type);
-        } else {
-            PyErr_SetString(PyExc_RuntimeError, "Failed to initialize simulation");
+/*
+ * Borrow the float64 contents of `obj` without copying where possible.
+ *
+ * Accepted inputs, in order:
+ *   - bytearray / bytes (raw native doubles)
+ *   - list / tuple of numbers (copied)
+ *   - objects with __array_interface__ of dtype float64 (e.g. NumPy arrays)
+ *   - any other C-contiguous buffer of format 'd' or raw bytes, such as
+ *     memoryview, array.array('d') and pickle.PickleBuffer
+ *
+ * Writable buffers are always borrowed in place. Read-only buffers are
+ * borrowed when they are bytes-backed and copied otherwise. If `writable`
+ * is set, read-only inputs are rejected with TypeError.
+ */
+static int acquire_double_buffer(PyObject* obj, int writable, double_buffer* buf) {
+    memset(buf, 0, sizeof(*buf));
+
+    if (PyByteArray_Check(obj)) {
+        Py_INCREF(obj);
+        return adopt_double_buffer(buf, obj, PyByteArray_AsString(obj),
+                                   PyByteArray_Size(obj), 0, 0);
+    }
+    if (PyBytes_Check(obj)) {
+        if (writable) {
+            PyErr_SetString(PyExc_TypeError, "buffer is read-only");
+            return -1;
         }
-        return NULL;
+        Py_INCREF(obj);
+        return adopt_double_buffer(buf, obj, PyBytes_AsString(obj), PyBytes_Size(obj), 1, 0);
+    }
+    if (PyList_Check(obj) || PyTuple_Check(obj)) {
+        return sequence_to_double_buffer(obj, buf);
     }
 
-    // Run simulation steps
-    for (size_t i = 0; i < steps; i++) {
-        run_simulation_step(sim_data);
+    int handled = array_interface_to_double_buffer(obj, buf);
+    if (handled != 0) {
+        if (handled > 0 && writable && buf->readonly) {
+            release_double_buffer(buf);
+            PyErr_SetString(PyExc_TypeError, "array is read-only");
+            return -1;
+        }
+        return handled < 0 ? -1 : 0;
+    }
+
+    PyObject* view = PyMemoryView_FromObject(obj);
+    if (view == NULL) {
+        PyErr_Clear();
+        PyErr_Format(PyExc_TypeError,
+                     "expected a float64 buffer, list or tuple, got %R",
+                     (PyObject*)Py_TYPE(obj));
+        return -1;
+    }
+
+    // Validate element format: native doubles or raw bytes
+    PyObject* fmt = PyObject_GetAttrString(view, "format");
+    PyObject* ro = PyObject_GetAttrString(view, "readonly");
+    PyObject* contig = PyObject_GetAttrString(view, "c_contiguous");
+    PyObject* nbytes_obj = PyObject_GetAttrString(view, "nbytes");
+    if (fmt == NULL || ro == NULL || contig == NULL || nbytes_obj == NULL) {
+        Py_XDECREF(fmt); Py_XDECREF(ro); Py_XDECREF(contig); Py_XDECREF(nbytes_obj);
+        Py_DECREF(view);
+        return -1;
+    }
+    int fmt_ok = PyUnicode_CompareWithASCIIString(fmt, "d") == 0 ||
+                 PyUnicode_CompareWithASCIIString(fmt, "@d") == 0 ||
+                 PyUnicode_CompareWithASCIIString(fmt, "=d") == 0 ||
+                 PyUnicode_CompareWithASCIIString(fmt, is_little_endian() ? "<d" : ">d") == 0 ||
+                 PyUnicode_CompareWithASCIIString(fmt, "B") == 0 ||
+                 PyUnicode_CompareWithASCIIString(fmt, "b") == 0 ||
+                 PyUnicode_CompareWithASCIIString(fmt, "c") == 0;
+    int readonly = PyObject_IsTrue(ro);
+    int contiguous = PyObject_IsTrue(contig);
+    Py_ssize_t nbytes = PyLong_AsSsize_t(nbytes_obj);
+    Py_DECREF(fmt); Py_DECREF(ro); Py_DECREF(contig); Py_DECREF(nbytes_obj);
+
+    if (!fmt_ok) {
+        Py_DECREF(view);
+        PyErr_SetString(PyExc_TypeError, "buffer must contain float64 values");
+        return -1;
+    }
+    if (readonly && writable) {
+        Py_DECREF(view);
+        PyErr_SetString(PyExc_TypeError, "buffer is read-only");
+        return -1;
+    }
+
+    if (!readonly && contiguous) {
+        // ctypes.from_buffer() pins the export and exposes its address
+        PyObject* ctypes = get_ctypes();
+        PyObject* array_type = ctypes ? ctypes_array_type(ctypes, "c_char", nbytes) : NULL;
+        PyObject* pinned = array_type ? PyObject_CallMethod(array_type, "from_buffer", "O", view) : NULL;
+        Py_XDECREF(array_type);
+        PyObject* address = pinned ? PyObject_CallMethod(ctypes, "addressof", "O", pinned) : NULL;
+        Py_DECREF(view);
+        if (address == NULL) {
+            Py_XDECREF(pinned);
+            return -1;
+        }
+        void* ptr = PyLong_AsVoidPtr(address);
+        Py_DECREF(address);
+        if ((uintptr_t)ptr % sizeof(double) != 0) {
+            int rc = copy_to_double_buffer(pinned, buf);
+            Py_DECREF(pinned);
+            return rc;
+        }
+        return adopt_double_buffer(buf, pinned, ptr, nbytes, 0, 0);
     }
 
-    // Write output if requested
-    if (output_file) {
-        write_vtk_flow_field(output_file, sim_data->field,
-                            sim_data->grid->nx, sim_data->grid->ny, sim_data->grid->nz,
-                            sim_data->grid->xmin, sim_data->grid->xmax,
-                            sim_data->grid->ymin, sim_data->grid->ymax,
-                            sim_data->grid->zmin, sim_data->grid->zmax);
+    // Read-only: borrow whole bytes objects and whole ctypes arrays (the
+    // read-only views of mapped stores and .npy files), copy anything else
+    if (readonly && contiguous) {
+        PyObject* base = PyObject_GetAttrString(view, "obj");
+        if (base != NULL && PyBytes_Check(base) && PyBytes_Size(base) == nbytes &&
+            (uintptr_t)PyBytes_AsString(base) % sizeof(double) == 0) {
+            Py_DECREF(view);
+            return adopt_double_buffer(buf, base, PyBytes_AsString(base), nbytes, 1, 0);
+        }
+        PyObject* ctypes = base != NULL && nbytes > 0 ? get_ctypes() : NULL;
+        PyObject* size = ctypes ? PyObject_CallMethod(ctypes, "sizeof", "O", base) : NULL;
+        PyObject* address = size ? PyObject_CallMethod(ctypes, "addressof", "O", base) : NULL;
+        if (address != NULL && PyLong_AsSsize_t(size) == nbytes) {
+            void* ptr = PyLong_AsVoidPtr(address);
+            if (ptr != NULL && (uintptr_t)ptr % sizeof(double) == 0) {
+                Py_DECREF(size);
+                Py_DECREF(address);
+                Py_DECREF(view);
+                return adopt_double_buffer(buf, base, ptr, nbytes, 1, 0);
+            }
+        }
+        Py_XDECREF(size);
+        Py_XDECREF(address);
+        Py_XDECREF(base);
+        PyErr_Clear();
+    }
+    int rc = copy_to_double_buffer(view, buf);
+    Py_DECREF(view);
+    return rc;
+}
+
+// ============================================================================
+// Shared-Memory Result Transport
+// ============================================================================
+
+// Fields written by run_simulation_with_params(shm_name=...)
+static const char* const k_shm_result_fields[] = {"velocity_magnitude", "u", "v", "p"};
+#define SHM_RESULT_FIELD_COUNT 4
+
+static PyObject* raise_shm_error(const char* name) {
+    if (errno == ENOSYS) {
+        PyErr_SetString(PyExc_NotImplementedError,
+                        "Named shared memory is not supported on this platform");
+    } else if (errno == EINVAL) {
+        PyErr_Format(PyExc_ValueError, "Invalid shared-memory segment '%s'", name);
+    } else {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, name);
     }
+    return NULL;
+}
 
-    // Compute velocity magnitude using derived_fields
-    flow_field* field = sim_data->field;
-    derived_fields* derived = derived_fields_create(field->nx, field->ny, field->nz);
-    if (derived == NULL) {
-        free_simulation(sim_data);
-        PyErr_SetString(PyExc_MemoryError, "Failed to create derived fields");
+/*
+ * Build the small picklable descriptor returned in place of field lists
+ */
+static PyObject* shm_descriptor(const char* name, const cfd_shm_segment* seg) {
+    const cfd_shm_header* header = cfd_shm_get_header(seg);
+    PyObject* fields = PyList_New(0);
+    if (fields == NULL) {
         return NULL;
     }
+    for (uint32_t i = 0; i < header->num_fields; i++) {
+        PyObject* field_name = PyUnicode_FromString(header->fields[i].name);
+        if (field_name == NULL || PyList_Append(fields, field_name) < 0) {
+            Py_XDECREF(field_name);
+            Py_DECREF(fields);
+            return NULL;
+        }
+        Py_DECREF(field_name);
+    }
+    return Py_BuildValue("{s:s,s:n,s:n,s:n,s:N}",
+                         "name", name[0] == '/' ? name + 1 : name,
+                         "size", (Py_ssize_t)seg->size,
+                         "nx", (Py_ssize_t)header->nx,
+                         "ny", (Py_ssize_t)header->ny,
+                         "fields", fields);
+}
 
-    derived_fields_compute_velocity_magnitude(derived, field);
+/*
+ * Write velocity magnitude, u, v and p of a flow field into a new segment
+ */
+static PyObject* write_results_to_shm(const char* name, const flow_field* field) {
+    cfd_shm_segment seg;
+    if (cfd_shm_create(name, field->nx, field->ny, k_shm_result_fields,
+                       SHM_RESULT_FIELD_COUNT, &seg) < 0) {
+        return raise_shm_error(name);
+    }
 
-    PyObject* result = PyList_New(0);
-    if (result == NULL) {
-        derived_fields_destroy(derived);
-        free_simulation(sim_data);
-        return NULL;
+    size_t size = field->nx * field->ny;
+    double* vel_mag = cfd_shm_field_data(&seg, 0);
+    const double* u = field->u;
+    const double* v = field->v;
+    for (size_t i = 0; i < size; i++) {
+        vel_mag[i] = sqrt(u[i] * u[i] + v[i] * v[i]);
     }
+    memcpy(cfd_shm_field_data(&seg, 1), field->u, size * sizeof(double));
+    memcpy(cfd_shm_field_data(&seg, 2), field->v, size * sizeof(double));
+    memcpy(cfd_shm_field_data(&seg, 3), field->p, size * sizeof(double));
 
-    if (derived->velocity_magnitude != NULL) {
-        size_t size = field->nx * field->ny;
-        for (size_t i = 0; i < size; i++) {
-            PyObject* val = PyFloat_FromDouble(derived->velocity_magnitude[i]);
-            if (val == NULL || PyList_Append(result, val) < 0) {
-                Py_XDECREF(val);
-                Py_DECREF(result);
-                derived_fields_destroy(derived);
-                free_simulation(sim_data);
-                return NULL;
-            }
-            Py_DECREF(val);
-        }
+    PyObject* descriptor = shm_descriptor(name, &seg);
+    cfd_shm_detach(&seg);
+    if (descriptor == NULL) {
+        cfd_shm_unlink(name);
     }
+    return descriptor;
+}
 
-    derived_fields_destroy(derived);
-    free_simulation(sim_data);
-    return result;
+static void shm_capsule_destructor(PyObject* capsule) {
+    cfd_shm_segment* seg = (cfd_shm_segment*)PyCapsule_GetPointer(capsule, "cfd_python.shm_segment");
+    if (seg != NULL) {
+        cfd_shm_detach(seg);
+        free(seg);
+    }
 }
 
 /*
- * Create a simple grid function
+ * Attach to a result segment and return zero-copy views of its fields
  */
-static PyObject* create_grid(PyObject* self, PyObject* args, PyObject* kwds) {
+static PyObject* attach_shared_result_py(PyObject* self, PyObject* args, PyObject* kwds) {
     (void)self;
-    static const char* const kwlist[] = {"nx", "ny", "xmin", "xmax", "ymin", "ymax",
-                                         "nz", "zmin", "zmax", NULL};
-    Py_ssize_t nx_signed, ny_signed;
-    Py_ssize_t nz_signed = 1;
-    double xmin, xmax, ymin, ymax;
-    double zmin = 0.0, zmax = 0.0;
+    static char* kwlist[] = {"name", "unlink", NULL};
+    PyObject* name_obj;
+    int unlink_after = 0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "nndddd|ndd", (char**)kwlist,
-                                     &nx_signed, &ny_signed, &xmin, &xmax, &ymin, &ymax,
-                                     &nz_signed, &zmin, &zmax)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|p", kwlist, &name_obj, &unlink_after)) {
         return NULL;
     }
 
-    // Validate dimensions before calling C library
-    if (nx_signed < 2) {
-        PyErr_SetString(PyExc_ValueError, "nx must be at least 2");
-        return NULL;
+    // Accept either the segment name or the descriptor dict itself
+    PyObject* name_str = name_obj;
+    if (PyDict_Check(name_obj)) {
+        name_str = PyDict_GetItemString(name_obj, "name");
+        if (name_str == NULL) {
+            PyErr_SetString(PyExc_KeyError, "Descriptor has no 'name' entry");
+            return NULL;
+        }
     }
-    if (ny_signed < 2) {
-        PyErr_SetString(PyExc_ValueError, "ny must be at least 2");
+    if (!PyUnicode_Check(name_str)) {
+        PyErr_SetString(PyExc_TypeError, "name must be a string or a shared-memory descriptor dict");
         return NULL;
     }
-    if (nz_signed < 1) {
-        PyErr_SetString(PyExc_ValueError, "nz must be at least 1");
+    PyObject* name_bytes = PyUnicode_AsUTF8String(name_str);
+    if (name_bytes == NULL) {
         return NULL;
     }
-    if (xmax <= xmin) {
-        PyErr_SetString(PyExc_ValueError, "xmax must be greater than xmin");
-        return NULL;
+    const char* name = PyBytes_AsString(name_bytes);
+
+    cfd_shm_segment* seg = (cfd_shm_segment*)malloc(sizeof(cfd_shm_segment));
+    if (seg == NULL) {
+        Py_DECREF(name_bytes);
+        return PyErr_NoMemory();
     }
-    if (ymax <= ymin) {
-        PyErr_SetString(PyExc_ValueError, "ymax must be greater than ymin");
+    if (cfd_shm_attach(name, seg) < 0) {
+        free(seg);
+        raise_shm_error(name);
+        Py_DECREF(name_bytes);
         return NULL;
     }
-    if (nz_signed > 1 && zmax <= zmin) {
-        PyErr_SetString(PyExc_ValueError, "zmax must be greater than zmin when nz > 1");
+    if (unlink_after && cfd_shm_unlink(name) < 0) {
+        cfd_shm_detach(seg);
+        free(seg);
+        raise_shm_error(name);
+        Py_DECREF(name_bytes);
         return NULL;
     }
 
-    size_t nx = (size_t)nx_signed;
-    size_t ny = (size_t)ny_signed;
-    size_t nz = (size_t)nz_signed;
-
-    grid* g = grid_create(nx, ny, nz, xmin, xmax, ymin, ymax, zmin, zmax);
-    if (g == NULL) {
-        PyErr_SetString(PyExc_RuntimeError, "Failed to create grid");
+    // The capsule owns the mapping; every view keeps it alive
+    PyObject* owner = PyCapsule_New(seg, "cfd_python.shm_segment", shm_capsule_destructor);
+    if (owner == NULL) {
+        cfd_shm_detach(seg);
+        free(seg);
+        Py_DECREF(name_bytes);
+        return NULL;
+    }
+
+    const cfd_shm_header* header = cfd_shm_get_header(seg);
+    PyObject* result = Py_BuildValue("{s:s,s:n,s:n}",
+                                     "name", name[0] == '/' ? name + 1 : name,
+                                     "nx", (Py_ssize_t)header->nx,
+                                     "ny", (Py_ssize_t)header->ny);
+    Py_DECREF(name_bytes);
+    if (result == NULL) {
+        Py_DECREF(owner);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < header->num_fields; i++) {
+        PyObject* view = make_double_view(owner, cfd_shm_field_data(seg, (int)i),
+                                          (Py_ssize_t)header->fields[i].count, 0);
+        if (view == NULL || PyDict_SetItemString(result, header->fields[i].name, view) < 0) {
+            Py_XDECREF(view);
+            Py_DECREF(result);
+            Py_DECREF(owner);
+            return NULL;
+        }
+        Py_DECREF(view);
+    }
+
+    Py_DECREF(owner);
+    return result;
+}
+
+/*
+ * Remove a result segment name
+ */
+static PyObject* unlink_shared_result_py(PyObject* self, PyObject* args) {
+    (void)self;
+    const char* name;
+
+    if (!PyArg_ParseTuple(args, "s", &name)) {
+        return NULL;
+    }
+    if (cfd_shm_unlink(name) < 0) {
+        return raise_shm_error(name);
+    }
+    Py_RETURN_NONE;
+}
+
+// ============================================================================
+// Grid and FieldSnapshot Types
+// ============================================================================
+
+static PyObject* g_grid_type = NULL;
+static PyObject* g_field_snapshot_type = NULL;
+
+// pickle.PickleBuffer, imported on first use
+static PyObject* g_pickle_buffer_type = NULL;
+
+// Allocate a private writable array of `count` doubles, copied from `src` if given
+static int alloc_double_buffer(double_buffer* buf, Py_ssize_t count, const double* src) {
+    memset(buf, 0, sizeof(*buf));
+    PyObject* storage = PyByteArray_FromStringAndSize((const char*)src,
+                                                      count * (Py_ssize_t)sizeof(double));
+    if (storage == NULL) {
+        return -1;
+    }
+    return adopt_double_buffer(buf, storage, PyByteArray_AsString(storage),
+                               count * (Py_ssize_t)sizeof(double), 0, 1);
+}
+
+/*
+ * Pickle payload for one array of an object.
+ *
+ * Protocol 5+ wraps a zero-copy view in pickle.PickleBuffer so the data can
+ * travel out-of-band; older protocols fall back to an in-band bytearray.
+ */
+static PyObject* pickle_double_buffer(PyObject* self, const double_buffer* buf, int protocol) {
+    if (protocol < 5) {
+        return PyByteArray_FromStringAndSize((const char*)buf->data,
+                                             buf->count * (Py_ssize_t)sizeof(double));
+    }
+    if (g_pickle_buffer_type == NULL) {
+        PyObject* pickle = PyImport_ImportModule("pickle");
+        if (pickle == NULL) {
+            return NULL;
+        }
+        g_pickle_buffer_type = PyObject_GetAttrString(pickle, "PickleBuffer");
+        Py_DECREF(pickle);
+        if (g_pickle_buffer_type == NULL) {
+            return NULL;
+        }
+    }
+    PyObject* view = make_double_view(self, buf->data, buf->count, buf->readonly);
+    if (view == NULL) {
+        return NULL;
+    }
+    PyObject* pickle_buffer = PyObject_CallFunctionObjArgs(g_pickle_buffer_type, view, NULL);
+    Py_DECREF(view);
+    return pickle_buffer;
+}
+
+static PyObject* alloc_instance(PyObject* type) {
+    allocfunc alloc = (allocfunc)PyType_GetSlot((PyTypeObject*)type, Py_tp_alloc);
+    return alloc((PyTypeObject*)type, 0);
+}
+
+static void dealloc_instance(PyObject* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    freefunc tp_free = (freefunc)PyType_GetSlot(type, Py_tp_free);
+    tp_free(self);
+    Py_DECREF(type);
+}
+
+// ----------------------------------------------------------------------------
+// Grid
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    PyObject_HEAD
+    Py_ssize_t nx, ny, nz;
+    double xmin, xmax, ymin, ymax, zmin, zmax;
+    double_buffer x, y, z;
+} GridObject;
+
+static void Grid_dealloc(PyObject* self) {
+    GridObject* g = (GridObject*)self;
+    release_double_buffer(&g->x);
+    release_double_buffer(&g->y);
+    release_double_buffer(&g->z);
+    dealloc_instance(self);
+}
+
+// Copy bounds and coordinates of a C grid into a Grid object
+static int grid_object_fill(GridObject* self, const grid* g) {
+    self->nx = (Py_ssize_t)g->nx;
+    self->ny = (Py_ssize_t)g->ny;
+    self->nz = (Py_ssize_t)g->nz;
+    self->xmin = g->xmin;
+    self->xmax = g->xmax;
+    self->ymin = g->ymin;
+    self->ymax = g->ymax;
+    self->zmin = g->zmin;
+    self->zmax = g->zmax;
+
+    int has_z = g->nz > 1 && g->z != NULL;
+    if (alloc_double_buffer(&self->x, self->nx, g->x) < 0 ||
+        alloc_double_buffer(&self->y, self->ny, g->y) < 0 ||
+        alloc_double_buffer(&self->z, has_z ? self->nz : 0, has_z ? g->z : NULL) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Create a Grid object from a C grid (coordinates are copied)
+ */
+static PyObject* grid_object_from_grid(const grid* g) {
+    PyObject* self = alloc_instance(g_grid_type);
+    if (self == NULL) {
+        return NULL;
+    }
+    if (grid_object_fill((GridObject*)self, g) < 0) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    return self;
+}
+
+static PyObject* Grid_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static const char* const kwlist[] = {"nx", "ny", "xmin", "xmax", "ymin", "ymax",
+                                         "nz", "zmin", "zmax", "beta", NULL};
+    Py_ssize_t nx, ny, nz = 1;
+    double xmin, xmax, ymin, ymax;
+    double zmin = 0.0, zmax = 0.0;
+    PyObject* beta_obj = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "nndddd|nddO", (char**)kwlist,
+                                     &nx, &ny, &xmin, &xmax, &ymin, &ymax,
+                                     &nz, &zmin, &zmax, &beta_obj)) {
+        return NULL;
+    }
+
+    if (nx < 2) {
+        PyErr_SetString(PyExc_ValueError, "nx must be at least 2");
+        return NULL;
+    }
+    if (ny < 2) {
+        PyErr_SetString(PyExc_ValueError, "ny must be at least 2");
+        return NULL;
+    }
+    if (nz < 1) {
+        PyErr_SetString(PyExc_ValueError, "nz must be at least 1");
+        return NULL;
+    }
+    if (xmax <= xmin) {
+        PyErr_SetString(PyExc_ValueError, "xmax must be greater than xmin");
+        return NULL;
+    }
+    if (ymax <= ymin) {
+        PyErr_SetString(PyExc_ValueError, "ymax must be greater than ymin");
+        return NULL;
+    }
+    if (nz > 1 && zmax <= zmin) {
+        PyErr_SetString(PyExc_ValueError, "zmax must be greater than zmin when nz > 1");
+        return NULL;
+    }
+
+    double beta = 0.0;
+    if (beta_obj != Py_None) {
+        beta = PyFloat_AsDouble(beta_obj);
+        if (beta == -1.0 && PyErr_Occurred()) {
+            return NULL;
+        }
+        if (beta <= 0.0) {
+            PyErr_SetString(PyExc_ValueError, "beta must be positive");
+            return NULL;
+        }
+    }
+
+    grid* g = grid_create((size_t)nx, (size_t)ny, (size_t)nz, xmin, xmax, ymin, ymax, zmin, zmax);
+    if (g == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to create grid");
+        return NULL;
+    }
+    if (beta_obj != Py_None) {
+        grid_initialize_stretched(g, beta);
+    } else {
+        grid_initialize_uniform(g);
+    }
+
+    PyObject* self = alloc_instance((PyObject*)type);
+    if (self == NULL || grid_object_fill((GridObject*)self, g) < 0) {
+        Py_XDECREF(self);
+        grid_destroy(g);
+        return NULL;
+    }
+    grid_destroy(g);
+    return self;
+}
+
+static PyObject* Grid_from_buffers(PyObject* cls, PyObject* args) {
+    Py_ssize_t nx, ny, nz;
+    PyObject* bounds;
+    PyObject* x_obj;
+    PyObject* y_obj;
+    PyObject* z_obj;
+
+    if (!PyArg_ParseTuple(args, "nnnOOOO", &nx, &ny, &nz, &bounds, &x_obj, &y_obj, &z_obj)) {
+        return NULL;
+    }
+
+    PyObject* self = alloc_instance(cls);
+    if (self == NULL) {
+        return NULL;
+    }
+    GridObject* g = (GridObject*)self;
+    g->nx = nx;
+    g->ny = ny;
+    g->nz = nz;
+    if (!PyArg_ParseTuple(bounds, "dddddd", &g->xmin, &g->xmax, &g->ymin, &g->ymax,
+                          &g->zmin, &g->zmax) ||
+        acquire_double_buffer(x_obj, 0, &g->x) < 0 ||
+        acquire_double_buffer(y_obj, 0, &g->y) < 0 ||
+        acquire_double_buffer(z_obj, 0, &g->z) < 0) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    if (g->x.count != nx || g->y.count != ny || (g->z.count != 0 && g->z.count != nz)) {
+        Py_DECREF(self);
+        PyErr_SetString(PyExc_ValueError, "Coordinate buffer sizes do not match grid dimensions");
+        return NULL;
+    }
+    return self;
+}
+
+static PyObject* Grid_reduce_ex(PyObject* self, PyObject* args) {
+    GridObject* g = (GridObject*)self;
+    int protocol;
+
+    if (!PyArg_ParseTuple(args, "i", &protocol)) {
+        return NULL;
+    }
+
+    PyObject* x = pickle_double_buffer(self, &g->x, protocol);
+    PyObject* y = x ? pickle_double_buffer(self, &g->y, protocol) : NULL;
+    PyObject* z = y ? pickle_double_buffer(self, &g->z, protocol) : NULL;
+    PyObject* ctor = z ? PyObject_GetAttrString((PyObject*)Py_TYPE(self), "_from_buffers") : NULL;
+    if (ctor == NULL) {
+        Py_XDECREF(x);
+        Py_XDECREF(y);
+        Py_XDECREF(z);
+        return NULL;
+    }
+    return Py_BuildValue("(N(nnn(dddddd)NNN))", ctor, g->nx, g->ny, g->nz,
+                         g->xmin, g->xmax, g->ymin, g->ymax, g->zmin, g->zmax, x, y, z);
+}
+
+static PyObject* Grid_to_dict(PyObject* self, PyObject* args) {
+    (void)args;
+    GridObject* g = (GridObject*)self;
+
+    PyObject* x_list = PyList_New(g->x.count);
+    PyObject* y_list = PyList_New(g->y.count);
+    PyObject* z_list = g->z.count > 0 ? PyList_New(g->z.count) : NULL;
+    if (x_list == NULL || y_list == NULL || (g->z.count > 0 && z_list == NULL)) {
+        Py_XDECREF(x_list);
+        Py_XDECREF(y_list);
+        Py_XDECREF(z_list);
+        return NULL;
+    }
+    for (Py_ssize_t i = 0; i < g->x.count; i++) {
+        PyList_SetItem(x_list, i, PyFloat_FromDouble(g->x.data[i]));
+    }
+    for (Py_ssize_t i = 0; i < g->y.count; i++) {
+        PyList_SetItem(y_list, i, PyFloat_FromDouble(g->y.data[i]));
+    }
+    for (Py_ssize_t i = 0; i < g->z.count; i++) {
+        PyList_SetItem(z_list, i, PyFloat_FromDouble(g->z.data[i]));
+    }
+
+    PyObject* result = Py_BuildValue("{s:n,s:n,s:n,s:d,s:d,s:d,s:d,s:d,s:d,s:N,s:N}",
+                                     "nx", g->nx, "ny", g->ny, "nz", g->nz,
+                                     "xmin", g->xmin, "xmax", g->xmax,
+                                     "ymin", g->ymin, "ymax", g->ymax,
+                                     "zmin", g->zmin, "zmax", g->zmax,
+                                     "x_coords", x_list, "y_coords", y_list);
+    if (result != NULL && z_list != NULL) {
+        PyDict_SetItemString(result, "z_coords", z_list);
+    }
+    Py_XDECREF(z_list);
+    return result;
+}
+
+static PyObject* Grid_get_x(PyObject* self, void* closure) {
+    (void)closure;
+    GridObject* g = (GridObject*)self;
+    return make_double_view(self, g->x.data, g->x.count, 1);
+}
+
+static PyObject* Grid_get_y(PyObject* self, void* closure) {
+    (void)closure;
+    GridObject* g = (GridObject*)self;
+    return make_double_view(self, g->y.data, g->y.count, 1);
+}
+
+static PyObject* Grid_get_z(PyObject* self, void* closure) {
+    (void)closure;
+    GridObject* g = (GridObject*)self;
+    return make_double_view(self, g->z.data, g->z.count, 1);
+}
+
+static PyObject* Grid_repr(PyObject* self) {
+    GridObject* g = (GridObject*)self;
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "Grid(nx=%zd, ny=%zd, x=[%g, %g], y=[%g, %g])",
+             g->nx, g->ny, g->xmin, g->xmax, g->ymin, g->ymax);
+    return PyUnicode_FromString(buffer);
+}
+
+static PyMemberDef Grid_members[] = {
+    {"nx", T_PYSSIZET, offsetof(GridObject, nx), READONLY, "Grid points in x direction"},
+    {"ny", T_PYSSIZET, offsetof(GridObject, ny), READONLY, "Grid points in y direction"},
+    {"nz", T_PYSSIZET, offsetof(GridObject, nz), READONLY, "Grid points in z direction"},
+    {"xmin", T_DOUBLE, offsetof(GridObject, xmin), READONLY, "Minimum x coordinate"},
+    {"xmax", T_DOUBLE, offsetof(GridObject, xmax), READONLY, "Maximum x coordinate"},
+    {"ymin", T_DOUBLE, offsetof(GridObject, ymin), READONLY, "Minimum y coordinate"},
+    {"ymax", T_DOUBLE, offsetof(GridObject, ymax), READONLY, "Maximum y coordinate"},
+    {"zmin", T_DOUBLE, offsetof(GridObject, zmin), READONLY, "Minimum z coordinate"},
+    {"zmax", T_DOUBLE, offsetof(GridObject, zmax), READONLY, "Maximum z coordinate"},
+    {NULL, 0, 0, 0, NULL}
+};
+
+static PyGetSetDef Grid_getset[] = {
+    {"x", Grid_get_x, NULL, "x coordinates (read-only memoryview of nx doubles)", NULL},
+    {"y", Grid_get_y, NULL, "y coordinates (read-only memoryview of ny doubles)", NULL},
+    {"z", Grid_get_z, NULL, "z coordinates (empty for 2D grids)", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyMethodDef Grid_methods[] = {
+    {"__reduce_ex__", Grid_reduce_ex, METH_VARARGS,
+     "Pickle support; protocol 5 sends coordinates as out-of-band PickleBuffers."},
+    {"_from_buffers", Grid_from_buffers, METH_VARARGS | METH_CLASS,
+     "Rebuild a Grid from coordinate buffers without copying (used by pickle)."},
+    {"to_dict", Grid_to_dict, METH_NOARGS,
+     "Return the grid as a dict in the create_grid() format."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot Grid_slots[] = {
+    {Py_tp_doc, (void*)
+     "Grid(nx, ny, xmin, xmax, ymin, ymax, nz=1, zmin=0.0, zmax=0.0, beta=None)\n\n"
+     "Computational grid with coordinates held in native memory.\n\n"
+     "Uniform by default; pass beta (> 0) for the stretched distribution of\n"
+     "create_grid_stretched(). Coordinates are exposed as read-only memoryviews\n"
+     "and pickled out-of-band with protocol 5."},
+    {Py_tp_new, (void*)Grid_new},
+    {Py_tp_dealloc, (void*)Grid_dealloc},
+    {Py_tp_repr, (void*)Grid_repr},
+    {Py_tp_members, Grid_members},
+    {Py_tp_getset, Grid_getset},
+    {Py_tp_methods, Grid_methods},
+    {0, NULL}
+};
+
+static PyType_Spec Grid_spec = {
+    "cfd_python.Grid",
+    sizeof(GridObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    Grid_slots
+};
+
+// ----------------------------------------------------------------------------
+// FieldSnapshot
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    PyObject_HEAD
+    Py_ssize_t nx, ny;
+    Py_ssize_t step;
+    double time;
+    double_buffer u, v, p;
+} FieldSnapshotObject;
+
+static void FieldSnapshot_dealloc(PyObject* self) {
+    FieldSnapshotObject* snap = (FieldSnapshotObject*)self;
+    release_double_buffer(&snap->u);
+    release_double_buffer(&snap->v);
+    release_double_buffer(&snap->p);
+    dealloc_instance(self);
+}
+
+/*
+ * Create a FieldSnapshot holding copies of u, v and p
+ */
+static PyObject* field_snapshot_from_arrays(size_t nx, size_t ny, double time, size_t step,
+                                            const double* u, const double* v, const double* p) {
+    PyObject* self = alloc_instance(g_field_snapshot_type);
+    if (self == NULL) {
+        return NULL;
+    }
+    FieldSnapshotObject* snap = (FieldSnapshotObject*)self;
+    Py_ssize_t count = (Py_ssize_t)(nx * ny);
+    snap->nx = (Py_ssize_t)nx;
+    snap->ny = (Py_ssize_t)ny;
+    snap->time = time;
+    snap->step = (Py_ssize_t)step;
+    if (alloc_double_buffer(&snap->u, count, u) < 0 ||
+        alloc_double_buffer(&snap->v, count, v) < 0 ||
+        alloc_double_buffer(&snap->p, count, p) < 0) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    return self;
+}
+
+// Check snapshot array sizes against its dimensions
+static int field_snapshot_check(FieldSnapshotObject* snap) {
+    Py_ssize_t count = snap->nx * snap->ny;
+    if (snap->nx < 1 || snap->ny < 1) {
+        PyErr_SetString(PyExc_ValueError, "nx and ny must be positive");
+        return -1;
+    }
+    if (snap->u.count != count || snap->v.count != count || snap->p.count != count) {
+        PyErr_Format(PyExc_ValueError, "u, v and p must each have nx*ny = %zd elements", count);
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject* FieldSnapshot_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static const char* const kwlist[] = {"u", "v", "p", "nx", "ny", "time", "step", NULL};
+    PyObject* u_obj;
+    PyObject* v_obj;
+    PyObject* p_obj;
+    Py_ssize_t nx, ny, step = 0;
+    double time = 0.0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOOnn|dn", (char**)kwlist,
+                                     &u_obj, &v_obj, &p_obj, &nx, &ny, &time, &step)) {
+        return NULL;
+    }
+
+    PyObject* self = alloc_instance((PyObject*)type);
+    if (self == NULL) {
+        return NULL;
+    }
+    FieldSnapshotObject* snap = (FieldSnapshotObject*)self;
+    snap->nx = nx;
+    snap->ny = ny;
+    snap->time = time;
+    snap->step = step;
+
+    // A snapshot owns its data: borrowed buffers are copied once
+    PyObject* inputs[3] = {u_obj, v_obj, p_obj};
+    double_buffer* outputs[3] = {&snap->u, &snap->v, &snap->p};
+    for (int i = 0; i < 3; i++) {
+        double_buffer borrowed;
+        if (acquire_double_buffer(inputs[i], 0, &borrowed) < 0) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        if (borrowed.copied) {
+            *outputs[i] = borrowed;
+        } else {
+            int rc = alloc_double_buffer(outputs[i], borrowed.count, borrowed.data);
+            release_double_buffer(&borrowed);
+            if (rc < 0) {
+                Py_DECREF(self);
+                return NULL;
+            }
+        }
+    }
+    if (field_snapshot_check(snap) < 0) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    return self;
+}
+
+static PyObject* FieldSnapshot_from_buffers(PyObject* cls, PyObject* args) {
+    Py_ssize_t nx, ny, step;
+    double time;
+    PyObject* u_obj;
+    PyObject* v_obj;
+    PyObject* p_obj;
+
+    if (!PyArg_ParseTuple(args, "nndnOOO", &nx, &ny, &time, &step, &u_obj, &v_obj, &p_obj)) {
+        return NULL;
+    }
+
+    PyObject* self = alloc_instance(cls);
+    if (self == NULL) {
+        return NULL;
+    }
+    FieldSnapshotObject* snap = (FieldSnapshotObject*)self;
+    snap->nx = nx;
+    snap->ny = ny;
+    snap->time = time;
+    snap->step = step;
+    if (acquire_double_buffer(u_obj, 0, &snap->u) < 0 ||
+        acquire_double_buffer(v_obj, 0, &snap->v) < 0 ||
+        acquire_double_buffer(p_obj, 0, &snap->p) < 0 ||
+        field_snapshot_check(snap) < 0) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    return self;
+}
+
+static PyObject* FieldSnapshot_reduce_ex(PyObject* self, PyObject* args) {
+    FieldSnapshotObject* snap = (FieldSnapshotObject*)self;
+    int protocol;
+
+    if (!PyArg_ParseTuple(args, "i", &protocol)) {
+        return NULL;
+    }
+
+    PyObject* u = pickle_double_buffer(self, &snap->u, protocol);
+    PyObject* v = u ? pickle_double_buffer(self, &snap->v, protocol) : NULL;
+    PyObject* p = v ? pickle_double_buffer(self, &snap->p, protocol) : NULL;
+    PyObject* ctor = p ? PyObject_GetAttrString((PyObject*)Py_TYPE(self), "_from_buffers") : NULL;
+    if (ctor == NULL) {
+        Py_XDECREF(u);
+        Py_XDECREF(v);
+        Py_XDECREF(p);
+        return NULL;
+    }
+    return Py_BuildValue("(N(nndnNNN))", ctor, snap->nx, snap->ny, snap->time, snap->step,
+                         u, v, p);
+}
+
+static PyObject* FieldSnapshot_get_u(PyObject* self, void* closure) {
+    (void)closure;
+    FieldSnapshotObject* snap = (FieldSnapshotObject*)self;
+    return make_double_view(self, snap->u.data, snap->u.count, snap->u.readonly);
+}
+
+static PyObject* FieldSnapshot_get_v(PyObject* self, void* closure) {
+    (void)closure;
+    FieldSnapshotObject* snap = (FieldSnapshotObject*)self;
+    return make_double_view(self, snap->v.data, snap->v.count, snap->v.readonly);
+}
+
+static PyObject* FieldSnapshot_get_p(PyObject* self, void* closure) {
+    (void)closure;
+    FieldSnapshotObject* snap = (FieldSnapshotObject*)self;
+    return make_double_view(self, snap->p.data, snap->p.count, snap->p.readonly);
+}
+
+static PyObject* FieldSnapshot_repr(PyObject* self) {
+    FieldSnapshotObject* snap = (FieldSnapshotObject*)self;
+    char buffer[160];
+    snprintf(buffer, sizeof(buffer), "FieldSnapshot(nx=%zd, ny=%zd, step=%zd, time=%g)",
+             snap->nx, snap->ny, snap->step, snap->time);
+    return PyUnicode_FromString(buffer);
+}
+
+static PyMemberDef FieldSnapshot_members[] = {
+    {"nx", T_PYSSIZET, offsetof(FieldSnapshotObject, nx), READONLY, "Grid points in x direction"},
+    {"ny", T_PYSSIZET, offsetof(FieldSnapshotObject, ny), READONLY, "Grid points in y direction"},
+    {"step", T_PYSSIZET, offsetof(FieldSnapshotObject, step), READONLY, "Time step index"},
+    {"time", T_DOUBLE, offsetof(FieldSnapshotObject, time), READONLY, "Simulation time"},
+    {NULL, 0, 0, 0, NULL}
+};
+
+static PyGetSetDef FieldSnapshot_getset[] = {
+    {"u", FieldSnapshot_get_u, NULL, "x-velocity (memoryview of nx*ny doubles)", NULL},
+    {"v", FieldSnapshot_get_v, NULL, "y-velocity (memoryview of nx*ny doubles)", NULL},
+    {"p", FieldSnapshot_get_p, NULL, "Pressure (memoryview of nx*ny doubles)", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyMethodDef FieldSnapshot_methods[] = {
+    {"__reduce_ex__", FieldSnapshot_reduce_ex, METH_VARARGS,
+     "Pickle support; protocol 5 sends fields as out-of-band PickleBuffers."},
+    {"_from_buffers", FieldSnapshot_from_buffers, METH_VARARGS | METH_CLASS,
+     "Rebuild a FieldSnapshot from field buffers without copying (used by pickle)."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot FieldSnapshot_slots[] = {
+    {Py_tp_doc, (void*)
+     "FieldSnapshot(u, v, p, nx, ny, time=0.0, step=0)\n\n"
+     "Copy of the u, v and p fields at one time step, held in native memory.\n\n"
+     "Fields accept lists, NumPy float64 arrays or any float64 buffer and are\n"
+     "exposed as flat memoryviews (row-major, nx*ny). Pickling with protocol 5\n"
+     "sends the fields as out-of-band PickleBuffers, and unpickling adopts the\n"
+     "received buffers without copying."},
+    {Py_tp_new, (void*)FieldSnapshot_new},
+    {Py_tp_dealloc, (void*)FieldSnapshot_dealloc},
+    {Py_tp_repr, (void*)FieldSnapshot_repr},
+    {Py_tp_members, FieldSnapshot_members},
+    {Py_tp_getset, FieldSnapshot_getset},
+    {Py_tp_methods, FieldSnapshot_methods},
+    {0, NULL}
+};
+
+static PyType_Spec FieldSnapshot_spec = {
+    "cfd_python.FieldSnapshot",
+    sizeof(FieldSnapshotObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    FieldSnapshot_slots
+};
+
+// ============================================================================
+// Simulation Type
+// ============================================================================
+
+/*
+ * Raise the typed exception for a status code (CFDDivergedError, ...)
+ * via cfd_python._exceptions.raise_for_status
+ */
+static PyObject* raise_cfd_status(cfd_status_t status, const char* context) {
+    PyObject* exceptions = PyImport_ImportModule("cfd_python._exceptions");
+    if (exceptions == NULL) {
+        cfd_clear_error();
+        return raise_cfd_error(status, context);
+    }
+    PyObject* result = PyObject_CallMethod(exceptions, "raise_for_status", "is", (int)status, context);
+    Py_DECREF(exceptions);
+    Py_XDECREF(result);
+    cfd_clear_error();
+    if (!PyErr_Occurred()) {
+        PyErr_Format(PyExc_RuntimeError, "%s: status %d", context, (int)status);
+    }
+    return NULL;
+}
+
+// Raise CFDIOError for a scheduled output that could not be written
+static PyObject* raise_output_error(const char* path, size_t step, int err) {
+    char context[1280];
+    snprintf(context, sizeof(context), "Scheduled output '%s' at step %zu: %s", path, step,
+             strerror(err));
+    return raise_cfd_status(CFD_ERROR_IO, context);
+}
+
+// Significant digits for the text writers; 0 selects shortest round-trip
+static int check_precision(int precision) {
+    if (precision < 0 || precision > DOUBLE_FORMAT_DIGITS) {
+        PyErr_Format(PyExc_ValueError, "precision must be between 0 and %d",
+                     DOUBLE_FORMAT_DIGITS);
+        return -1;
+    }
+    return 0;
+}
+
+// Validate one scheduled output and append it
+static int schedule_output(output_schedule* schedule, int type, const char* pattern,
+                           Py_ssize_t every, int binary, int precision) {
+    if (type < (int)OUTPUT_VELOCITY_MAGNITUDE || type > (int)OUTPUT_CSV_STATISTICS) {
+        PyErr_Format(PyExc_ValueError, "Unknown output type %d (use an OUTPUT_* constant)", type);
+        return -1;
+    }
+    if (every < 1) {
+        PyErr_SetString(PyExc_ValueError, "every must be at least 1");
+        return -1;
+    }
+    if (check_precision(precision) < 0) {
+        return -1;
+    }
+    if (output_schedule_add(schedule, (output_field_type)type, (size_t)every, pattern,
+                            binary, precision) < 0) {
+        if (errno == ENOMEM) {
+            PyErr_NoMemory();
+        } else {
+            PyErr_Format(PyExc_ValueError,
+                         "Invalid filename pattern '%s': allowed are one %%d-style step "
+                         "conversion (e.g. %%06d) and %%%%",
+                         pattern);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Fill a schedule from the outputs= argument of the run functions: a
+ * sequence of (type, pattern[, every[, binary[, precision]]]) tuples. None
+ * leaves it empty. On failure the schedule is freed.
+ */
+static int parse_output_list(PyObject* obj, output_schedule* schedule) {
+    memset(schedule, 0, sizeof(*schedule));
+    if (obj == NULL || obj == Py_None) {
+        return 0;
+    }
+    PyObject* items = PySequence_Tuple(obj);
+    if (items == NULL) {
+        return -1;
+    }
+    for (Py_ssize_t k = 0; k < PyTuple_Size(items); k++) {
+        PyObject* spec = PySequence_Tuple(PyTuple_GetItem(items, k));
+        int type, binary = 0, precision = 0;
+        const char* pattern;
+        Py_ssize_t every = 1;
+        int rc = -1;
+        if (spec != NULL && PyArg_ParseTuple(spec, "is|npi:outputs", &type, &pattern, &every,
+                                             &binary, &precision)) {
+            rc = schedule_output(schedule, type, pattern, every, binary, precision);
+        }
+        Py_XDECREF(spec);
+        if (rc < 0) {
+            Py_DECREF(items);
+            output_schedule_free(schedule);
+            return -1;
+        }
+    }
+    Py_DECREF(items);
+    return 0;
+}
+
+// Write the outputs due after `step` of a run_simulation*() loop
+static int run_scheduled_outputs(output_schedule* schedule, const simulation_data* sim,
+                                 size_t step) {
+    char failed[1024];
+    if (schedule->count == 0 ||
+        output_schedule_run(schedule, sim, step, (double)step * sim->params.dt, failed,
+                            sizeof(failed)) == 0) {
+        return 0;
+    }
+    raise_output_error(failed, step, errno);
+    return -1;
+}
+
+typedef struct {
+    PyObject_HEAD
+    simulation_data* sim;
+    // Construction arguments, kept so clone() can build an identical instance
+    size_t nx, ny;
+    double xmin, xmax, ymin, ymax;
+    char solver_type[64];
+    // Progress
+    size_t step_count;
+    double time;
+    cfd_status_t last_status;
+    int busy;  // Set while the step loop runs without the GIL
+    // Divergence checks and rollback ring (disabled while check_interval is 0)
+    divergence_guard guard;
+    // Running averages (NULL while disabled); the capsule owns the memory so
+    // views handed out stay valid after stop_averaging() or dealloc
+    field_accumulator* averages;
+    PyObject* averages_owner;
+    // Probe points and their sample store (disabled while num_points is 0)
+    probe_set probes;
+    // Integral diagnostics time series (disabled while interval is 0)
+    flow_diagnostics diagnostics;
+    // Tracer particles (NULL while unset), owned by a capsule like the averages
+    particle_set* particles;
+    PyObject* particles_owner;
+    // Outputs written by the step loop, and the file of the last failed write
+    output_schedule outputs;
+    char output_failed[1024];
+    int output_errno;
+} SimulationObject;
+
+static PyObject* g_simulation_type = NULL;
+
+static simulation_data* simulation_create(const SimulationObject* cfg) {
+    if (cfg->solver_type[0] != '\0') {
+        return init_simulation_with_solver(cfg->nx, cfg->ny, 1, cfg->xmin, cfg->xmax,
+                                           cfg->ymin, cfg->ymax, 0.0, 0.0, cfg->solver_type);
+    }
+    return init_simulation(cfg->nx, cfg->ny, 1, cfg->xmin, cfg->xmax,
+                           cfg->ymin, cfg->ymax, 0.0, 0.0);
+}
+
+static void Simulation_dealloc(PyObject* self) {
+    SimulationObject* s = (SimulationObject*)self;
+    if (s->sim != NULL) {
+        free_simulation(s->sim);
+        s->sim = NULL;
+    }
+    divergence_guard_free(&s->guard);
+    Py_CLEAR(s->averages_owner);
+    probe_set_free(&s->probes);
+    flow_diagnostics_free(&s->diagnostics);
+    Py_CLEAR(s->particles_owner);
+    output_schedule_free(&s->outputs);
+    dealloc_instance(self);
+}
+
+// Advect the tracers through the current (frozen) velocity field
+static size_t simulation_advect_particles(SimulationObject* self, double dt, size_t steps) {
+    particle_set* particles = self->particles;
+    const grid* g = self->sim->grid;
+    tracer_field field = {self->sim->field->u, self->sim->field->v, g->x, g->y,
+                          self->nx, self->ny};
+    size_t active = tracer_advect(particles->x, particles->y, particles->count, &field, dt,
+                                  steps, particles->method);
+    particles->steps += steps;
+    return active;
+}
+
+static int simulation_check_idle(SimulationObject* self) {
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "Simulation is running in another thread");
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Roll back after a detected divergence. Retry r restores the r-th most
+ * recent saved state, so repeated failures reach further back, and scales
+ * dt by the policy factor. Returns 0 if the caller should keep stepping.
+ * Once the retries are spent the newest saved state is restored with dt
+ * unchanged, so the object is left usable, and -1 is returned.
+ */
+static int simulation_rollback(SimulationObject* self) {
+    divergence_guard* guard = &self->guard;
+    if (guard->retries == 0) {
+        guard->episode_step = self->step_count;
+    }
+    int retry = guard->retries < guard->policy.max_retries;
+    const saved_state* entry = divergence_guard_restore(guard, self->sim->field,
+                                                        retry ? (size_t)guard->retries + 1 : 1);
+    if (entry == NULL) {
+        return -1;
+    }
+    self->step_count = entry->step;
+    self->time = entry->time;
+    if (self->averages != NULL) {
+        field_accumulator_revert(self->averages);
+    }
+    sample_store_truncate(&self->probes.samples, self->step_count);
+    sample_store_truncate(&self->diagnostics.samples, self->step_count);
+    if (!retry) {
+        return -1;
+    }
+    guard->retries++;
+    self->sim->params.dt *= guard->policy.dt_factor;
+    guard->rollbacks++;
+    return 0;
+}
+
+/*
+ * Advance `steps` time steps. Called without the GIL; stops at the first
+ * failing step and reports the number of completed steps in `done`.
+ *
+ * With a divergence guard the fields are checked every check_interval steps
+ * (and whenever the solver reports CFD_ERROR_DIVERGED). Verified states go
+ * into the ring buffer; a failed check rolls back and retries with a smaller
+ * dt until the policy's retry budget for that episode is spent.
+ *
+ * Running averages, probes and diagnostics are sampled, tracers advected
+ * and scheduled outputs written at their own intervals. Running averages
+ * are committed with each verified state and reverted on rollback, and
+ * probe and diagnostic rows newer than a rolled-back state are discarded;
+ * tracer positions are not restored and output files are not removed. A
+ * failed output write stops the loop with CFD_ERROR_IO and its errno in
+ * output_errno.
+ */
+static cfd_status_t simulation_advance(SimulationObject* self, size_t steps, size_t* done) {
+    divergence_guard* guard = &self->guard;
+    size_t interval = guard->policy.check_interval;
+    size_t start = self->step_count;
+    size_t target = start + steps;
+    cfd_status_t status = CFD_SUCCESS;
+
+    self->output_errno = 0;
+    if (interval > 0 && guard->count == 0) {
+        divergence_guard_save(guard, self->sim->field, self->step_count, self->time);
+        if (self->averages != NULL && field_accumulator_commit(self->averages) < 0) {
+            *done = 0;
+            return CFD_ERROR_NOMEM;
+        }
+    }
+
+    while (self->step_count < target) {
+        status = run_simulation_step(self->sim);
+        if (status == CFD_SUCCESS) {
+            self->step_count++;
+            self->time += self->sim->params.dt;
+            if (self->averages != NULL && self->step_count % self->averages->interval == 0) {
+                field_accumulator_update(self->averages, self->sim->field, self->step_count);
+            }
+            if (self->probes.num_points > 0 && self->step_count % self->probes.interval == 0) {
+                status = probe_set_record(&self->probes, self->sim->field,
+                                          self->step_count, self->time);
+                if (status != CFD_SUCCESS) {
+                    break;
+                }
+            }
+            if (self->diagnostics.interval > 0 &&
+                self->step_count % self->diagnostics.interval == 0) {
+                status = flow_diagnostics_record(&self->diagnostics, self->sim->field,
+                                                 self->step_count, self->time);
+                if (status != CFD_SUCCESS) {
+                    break;
+                }
+            }
+            particle_set* particles = self->particles;
+            if (particles != NULL && particles->interval > 0 &&
+                self->step_count % particles->interval == 0) {
+                simulation_advect_particles(self, self->sim->params.dt * (double)particles->interval,
+                                            1);
+            }
+            if (self->outputs.count > 0 &&
+                output_schedule_run(&self->outputs, self->sim, self->step_count, self->time,
+                                    self->output_failed, sizeof(self->output_failed)) < 0) {
+                self->output_errno = errno;
+                status = CFD_ERROR_IO;
+                break;
+            }
+        } else if (interval == 0 || status != CFD_ERROR_DIVERGED) {
+            break;
+        }
+        if (interval == 0 || (status == CFD_SUCCESS && self->step_count % interval != 0)) {
+            continue;
+        }
+
+        if (status == CFD_SUCCESS &&
+            !flow_field_diverged(self->sim->field, guard->policy.max_velocity,
+                                 &guard->last_max_velocity)) {
+            divergence_guard_save(guard, self->sim->field, self->step_count, self->time);
+            if (self->averages != NULL && field_accumulator_commit(self->averages) < 0) {
+                status = CFD_ERROR_NOMEM;
+                break;
+            }
+            if (self->step_count > guard->episode_step) {
+                guard->retries = 0;
+            }
+            continue;
+        }
+        if (simulation_rollback(self) < 0) {
+            status = CFD_ERROR_DIVERGED;
+            break;
+        }
+        status = CFD_SUCCESS;
+        cfd_clear_error();
+    }
+
+    *done = self->step_count > start ? self->step_count - start : 0;
+    return status;
+}
+
+static PyObject* Simulation_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static const char* const kwlist[] = {"nx", "ny", "xmin", "xmax", "ymin", "ymax",
+                                         "solver_type", "dt", "cfl", NULL};
+    Py_ssize_t nx, ny;
+    double xmin = 0.0, xmax = 1.0, ymin = 0.0, ymax = 1.0;
+    const char* solver_type = NULL;
+    double dt = 0.001, cfl = 0.2;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "nn|ddddzdd", (char**)kwlist,
+                                     &nx, &ny, &xmin, &xmax, &ymin, &ymax,
+                                     &solver_type, &dt, &cfl)) {
+        return NULL;
+    }
+    if (nx < 2 || ny < 2) {
+        PyErr_SetString(PyExc_ValueError, "nx and ny must be at least 2");
+        return NULL;
+    }
+    if (xmax <= xmin || ymax <= ymin) {
+        PyErr_SetString(PyExc_ValueError, "Domain bounds must satisfy xmin < xmax and ymin < ymax");
+        return NULL;
+    }
+    if (dt <= 0.0) {
+        PyErr_SetString(PyExc_ValueError, "dt must be positive");
+        return NULL;
+    }
+    if (solver_type != NULL && strlen(solver_type) >= 64) {
+        PyErr_SetString(PyExc_ValueError, "solver_type name is too long");
+        return NULL;
+    }
+
+    PyObject* obj = alloc_instance((PyObject*)type);
+    if (obj == NULL) {
+        return NULL;
+    }
+    SimulationObject* self = (SimulationObject*)obj;
+    self->nx = (size_t)nx;
+    self->ny = (size_t)ny;
+    self->xmin = xmin;
+    self->xmax = xmax;
+    self->ymin = ymin;
+    self->ymax = ymax;
+    if (solver_type != NULL) {
+        strcpy(self->solver_type, solver_type);
+    }
+
+    self->sim = simulation_create(self);
+    if (self->sim == NULL) {
+        Py_DECREF(obj);
+        if (solver_type) {
+            PyErr_Format(PyExc_RuntimeError, "Failed to initialize simulation with solver '%s'", solver_type);
+        } else {
+            PyErr_SetString(PyExc_RuntimeError, "Failed to initialize simulation");
+        }
+        return NULL;
+    }
+    self->sim->params.dt = dt;
+    self->sim->params.cfl = cfl;
+    return obj;
+}
+
+static PyObject* Simulation_step(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"steps", NULL};
+    Py_ssize_t steps = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|n", (char**)kwlist, &steps)) {
+        return NULL;
+    }
+    if (steps < 0) {
+        PyErr_SetString(PyExc_ValueError, "steps must be non-negative");
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+
+    size_t done = 0;
+    cfd_status_t status;
+    self->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    status = simulation_advance(self, (size_t)steps, &done);
+    Py_END_ALLOW_THREADS
+    self->busy = 0;
+    self->last_status = status;
+
+    if (status != CFD_SUCCESS && self->output_errno != 0) {
+        int err = self->output_errno;
+        self->output_errno = 0;
+        return raise_output_error(self->output_failed, self->step_count, err);
+    }
+    if (status != CFD_SUCCESS) {
+        char context[160];
+        if (status == CFD_ERROR_DIVERGED && self->guard.policy.check_interval > 0) {
+            snprintf(context, sizeof(context),
+                     "Simulation diverged; rolled back to step %zu (dt=%g, %d retries exhausted)",
+                     self->step_count, self->sim->params.dt, self->guard.retries);
+        } else {
+            snprintf(context, sizeof(context), "Simulation step %zu", self->step_count + 1);
+        }
+        return raise_cfd_status(status, context);
+    }
+    return PyLong_FromSize_t(done);
+}
+
+static PyObject* Simulation_clone(PyObject* obj, PyObject* args) {
+    (void)args;
+    SimulationObject* self = (SimulationObject*)obj;
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+
+    PyObject* copy_obj = alloc_instance((PyObject*)Py_TYPE(obj));
+    if (copy_obj == NULL) {
+        return NULL;
+    }
+    SimulationObject* copy = (SimulationObject*)copy_obj;
+    copy->nx = self->nx;
+    copy->ny = self->ny;
+    copy->xmin = self->xmin;
+    copy->xmax = self->xmax;
+    copy->ymin = self->ymin;
+    copy->ymax = self->ymax;
+    memcpy(copy->solver_type, self->solver_type, sizeof(copy->solver_type));
+    copy->step_count = self->step_count;
+    copy->time = self->time;
+
+    cfd_status_t status = CFD_ERROR_NOMEM;
+    Py_BEGIN_ALLOW_THREADS
+    copy->sim = simulation_create(copy);
+    if (copy->sim != NULL) {
+        copy->sim->params = self->sim->params;
+        status = flow_field_copy_parallel(copy->sim->field, self->sim->field);
+    }
+    Py_END_ALLOW_THREADS
+
+    if (copy->sim == NULL) {
+        Py_DECREF(copy_obj);
+        PyErr_SetString(PyExc_RuntimeError, "Failed to initialize simulation clone");
+        return NULL;
+    }
+    if (status == CFD_SUCCESS && self->guard.capacity > 0) {
+        // Same policy, fresh history: the clone starts a new rollback record
+        status = divergence_guard_init(&copy->guard, &self->guard.policy, self->guard.capacity,
+                                       copy->nx, copy->ny, 1);
+    }
+    if (status != CFD_SUCCESS) {
+        Py_DECREF(copy_obj);
+        return raise_cfd_status(status, "Simulation.clone");
+    }
+    return copy_obj;
+}
+
+static PyObject* Simulation_set_fields(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"u", "v", "p", NULL};
+    PyObject* inputs[3] = {Py_None, Py_None, Py_None};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OOO", (char**)kwlist,
+                                     &inputs[0], &inputs[1], &inputs[2])) {
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+
+    flow_field* field = self->sim->field;
+    double* targets[3] = {field->u, field->v, field->p};
+    Py_ssize_t count = (Py_ssize_t)(self->nx * self->ny);
+    static const char* const names[3] = {"u", "v", "p"};
+
+    for (int i = 0; i < 3; i++) {
+        if (inputs[i] == Py_None) {
+            continue;
+        }
+        double_buffer buf;
+        if (acquire_double_buffer(inputs[i], 0, &buf) < 0) {
+            return NULL;
+        }
+        if (buf.count != count) {
+            PyErr_Format(PyExc_ValueError, "%s must have nx*ny = %zd elements, got %zd",
+                         names[i], count, buf.count);
+            release_double_buffer(&buf);
+            return NULL;
+        }
+        if (buf.data != targets[i]) {
+            copy_doubles_parallel(targets[i], buf.data, (size_t)count);
+        }
+        release_double_buffer(&buf);
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* Simulation_snapshot(PyObject* obj, PyObject* args) {
+    (void)args;
+    SimulationObject* self = (SimulationObject*)obj;
+    flow_field* field = self->sim->field;
+    return field_snapshot_from_arrays(self->nx, self->ny, self->time, self->step_count,
+                                      field->u, field->v, field->p);
+}
+
+static PyObject* Simulation_set_divergence_guard(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"check_every", "max_velocity", "max_retries",
+                                         "dt_factor", "history", NULL};
+    Py_ssize_t check_every = 10;
+    double max_velocity = 0.0;
+    int max_retries = 3;
+    double dt_factor = 0.5;
+    Py_ssize_t history = 2;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|ndidn", (char**)kwlist,
+                                     &check_every, &max_velocity, &max_retries,
+                                     &dt_factor, &history)) {
+        return NULL;
+    }
+    if (check_every < 0 || max_retries < 0) {
+        PyErr_SetString(PyExc_ValueError, "check_every and max_retries must be non-negative");
+        return NULL;
+    }
+    if (!(dt_factor > 0.0 && dt_factor < 1.0)) {
+        PyErr_SetString(PyExc_ValueError, "dt_factor must be in (0, 1)");
+        return NULL;
+    }
+    if (history < 1) {
+        PyErr_SetString(PyExc_ValueError, "history must be at least 1");
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+
+    divergence_policy policy = {(size_t)check_every, max_velocity, max_retries, dt_factor};
+    divergence_guard_free(&self->guard);
+    cfd_status_t status = divergence_guard_init(&self->guard, &policy,
+                                                check_every > 0 ? (size_t)history : 0,
+                                                self->nx, self->ny, 1);
+    if (status != CFD_SUCCESS) {
+        return raise_cfd_status(status, "Simulation.set_divergence_guard");
+    }
+    Py_RETURN_NONE;
+}
+
+static void accumulator_capsule_destructor(PyObject* capsule) {
+    field_accumulator_destroy(
+        (field_accumulator*)PyCapsule_GetPointer(capsule, "cfd_python.field_accumulator"));
+}
+
+static PyObject* Simulation_start_averaging(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"every", NULL};
+    Py_ssize_t every = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|n", (char**)kwlist, &every)) {
+        return NULL;
+    }
+    if (every < 1) {
+        PyErr_SetString(PyExc_ValueError, "every must be at least 1");
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+
+    field_accumulator* acc = field_accumulator_create(self->nx * self->ny, (size_t)every);
+    if (acc == NULL) {
+        return PyErr_NoMemory();
+    }
+    PyObject* owner = PyCapsule_New(acc, "cfd_python.field_accumulator",
+                                    accumulator_capsule_destructor);
+    if (owner == NULL) {
+        field_accumulator_destroy(acc);
+        return NULL;
+    }
+    PyObject* old = self->averages_owner;
+    self->averages_owner = owner;
+    self->averages = acc;
+    Py_XDECREF(old);
+    Py_RETURN_NONE;
+}
+
+static PyObject* Simulation_stop_averaging(PyObject* obj, PyObject* args) {
+    (void)args;
+    SimulationObject* self = (SimulationObject*)obj;
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    self->averages = NULL;
+    Py_CLEAR(self->averages_owner);
+    Py_RETURN_NONE;
+}
+
+static PyObject* Simulation_get_averages(PyObject* obj, void* closure) {
+    (void)closure;
+    SimulationObject* self = (SimulationObject*)obj;
+    const field_accumulator* acc = self->averages;
+    if (acc == NULL) {
+        Py_RETURN_NONE;
+    }
+    PyObject* result = Py_BuildValue("{s:n,s:n}", "samples", (Py_ssize_t)acc->samples,
+                                     "every", (Py_ssize_t)acc->interval);
+    if (result == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < ACCUM_NUM_FIELDS; i++) {
+        PyObject* view = make_double_view(self->averages_owner,
+                                          field_accumulator_get(acc, (accumulator_field)i),
+                                          (Py_ssize_t)acc->count, 1);
+        if (view == NULL ||
+            PyDict_SetItemString(result, field_accumulator_name((accumulator_field)i), view) < 0) {
+            Py_XDECREF(view);
+            Py_DECREF(result);
+            return NULL;
+        }
+        Py_DECREF(view);
+    }
+    return result;
+}
+
+static PyObject* Simulation_set_probes(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"points", "every", "max_samples", NULL};
+    PyObject* points_obj;
+    Py_ssize_t every = 1;
+    Py_ssize_t max_samples = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|nn", (char**)kwlist,
+                                     &points_obj, &every, &max_samples)) {
+        return NULL;
+    }
+    if (every < 1) {
+        PyErr_SetString(PyExc_ValueError, "every must be at least 1");
+        return NULL;
+    }
+    if (max_samples < 0) {
+        PyErr_SetString(PyExc_ValueError, "max_samples must be non-negative");
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    if (points_obj == Py_None) {
+        probe_set_free(&self->probes);
+        Py_RETURN_NONE;
+    }
+
+    PyObject* points = PySequence_List(points_obj);
+    if (points == NULL) {
+        return NULL;
+    }
+    Py_ssize_t count = PyList_Size(points);
+    double* xy = (double*)malloc((size_t)(count > 0 ? count : 1) * 2 * sizeof(double));
+    if (xy == NULL) {
+        Py_DECREF(points);
+        return PyErr_NoMemory();
+    }
+
+    const grid* g = self->sim->grid;
+    int ok = 1;
+    for (Py_ssize_t k = 0; ok && k < count; k++) {
+        PyObject* pair = PySequence_List(PyList_GetItem(points, k));
+        ok = pair != NULL;
+        if (ok && PyList_Size(pair) != 2) {
+            PyErr_Format(PyExc_ValueError, "probe %zd must be an (x, y) pair", k);
+            ok = 0;
+        }
+        if (ok) {
+            xy[2 * k] = PyFloat_AsDouble(PyList_GetItem(pair, 0));
+            xy[2 * k + 1] = PyFloat_AsDouble(PyList_GetItem(pair, 1));
+            ok = !PyErr_Occurred();
+        }
+        if (ok && !(xy[2 * k] >= g->x[0] && xy[2 * k] <= g->x[g->nx - 1] &&
+                    xy[2 * k + 1] >= g->y[0] && xy[2 * k + 1] <= g->y[g->ny - 1])) {
+            PyErr_Format(PyExc_ValueError, "probe %zd at (%g, %g) is outside the grid",
+                         k, xy[2 * k], xy[2 * k + 1]);
+            ok = 0;
+        }
+        Py_XDECREF(pair);
+    }
+    Py_DECREF(points);
+    if (!ok) {
+        free(xy);
+        return NULL;
+    }
+
+    probe_set_free(&self->probes);
+    cfd_status_t status = CFD_SUCCESS;
+    if (count > 0) {
+        status = probe_set_init(&self->probes, g, xy, (size_t)count,
+                                (size_t)every, (size_t)max_samples);
+    }
+    free(xy);
+    if (status != CFD_SUCCESS) {
+        return raise_cfd_status(status, "Simulation.set_probes");
+    }
+    Py_RETURN_NONE;
+}
+
+// New private array of `count` doubles exposed as a writable view
+static PyObject* new_double_array(Py_ssize_t count, double** data) {
+    double_buffer buf;
+    if (alloc_double_buffer(&buf, count, NULL) < 0) {
+        return NULL;
+    }
+    PyObject* view = make_double_view(buf.owner, buf.data, count, 0);
+    *data = buf.data;
+    release_double_buffer(&buf);
+    return view;
+}
+
+static PyObject* Simulation_probe_data(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"clear", NULL};
+    int clear = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|p", (char**)kwlist, &clear)) {
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    probe_set* probes = &self->probes;
+    if (probes->num_points == 0) {
+        Py_RETURN_NONE;
+    }
+
+    Py_ssize_t n = (Py_ssize_t)probes->samples.count;
+    Py_ssize_t np = (Py_ssize_t)probes->num_points;
+    double* time = NULL;
+    double* step = NULL;
+    PyObject* result = Py_BuildValue("{s:n,s:n}", "samples", n,
+                                     "dropped", (Py_ssize_t)probes->samples.dropped);
+    PyObject* time_view = new_double_array(n, &time);
+    PyObject* step_view = new_double_array(n, &step);
+    PyObject* point_list = PyList_New(np);
+    PyObject* value_list = PyList_New(np);
+    double** columns = (double**)calloc((size_t)np, sizeof(double*));
+    int ok = result != NULL && time_view != NULL && step_view != NULL &&
+             point_list != NULL && value_list != NULL && columns != NULL;
+    if (columns == NULL) {
+        PyErr_NoMemory();
+    }
+
+    for (Py_ssize_t k = 0; ok && k < np; k++) {
+        PyObject* point = Py_BuildValue("(dd)", probes->points[k].x, probes->points[k].y);
+        PyObject* values = new_double_array(3 * n, &columns[k]);
+        ok = point != NULL && values != NULL;
+        if (ok) {
+            PyList_SetItem(point_list, k, point);
+            PyList_SetItem(value_list, k, values);
+        } else {
+            Py_XDECREF(point);
+            Py_XDECREF(values);
+        }
+    }
+
+    if (ok) {
+        // Transpose the sample rows into one packed (u, v, p) array per probe
+        for (Py_ssize_t r = 0; r < n; r++) {
+            const double* row = sample_store_row(&probes->samples, (size_t)r);
+            time[r] = row[0];
+            step[r] = row[1];
+            for (Py_ssize_t k = 0; k < np; k++) {
+                memcpy(columns[k] + 3 * r, row + 2 + 3 * k, 3 * sizeof(double));
+            }
+        }
+        ok = PyDict_SetItemString(result, "points", point_list) == 0 &&
+             PyDict_SetItemString(result, "time", time_view) == 0 &&
+             PyDict_SetItemString(result, "step", step_view) == 0 &&
+             PyDict_SetItemString(result, "probes", value_list) == 0;
+    }
+
+    free(columns);
+    Py_XDECREF(time_view);
+    Py_XDECREF(step_view);
+    Py_XDECREF(point_list);
+    Py_XDECREF(value_list);
+    if (!ok) {
+        Py_XDECREF(result);
+        return NULL;
+    }
+    if (clear) {
+        sample_store_clear(&probes->samples);
+    }
+    return result;
+}
+
+static PyObject* Simulation_set_diagnostics(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"every", "max_samples", NULL};
+    Py_ssize_t every = 1;
+    Py_ssize_t max_samples = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|nn", (char**)kwlist, &every, &max_samples)) {
+        return NULL;
+    }
+    if (every < 0 || max_samples < 0) {
+        PyErr_SetString(PyExc_ValueError, "every and max_samples must be non-negative");
+        return NULL;
+    }
+    if (every > 0 && (self->nx < 3 || self->ny < 3)) {
+        PyErr_SetString(PyExc_ValueError, "diagnostics need at least 3x3 grid points");
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+
+    flow_diagnostics_free(&self->diagnostics);
+    if (every == 0) {
+        Py_RETURN_NONE;
+    }
+    cfd_status_t status = flow_diagnostics_init(&self->diagnostics, self->sim->grid,
+                                                (size_t)every, (size_t)max_samples);
+    if (status != CFD_SUCCESS) {
+        return raise_cfd_status(status, "Simulation.set_diagnostics");
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* Simulation_diagnostic_data(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"clear", NULL};
+    int clear = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|p", (char**)kwlist, &clear)) {
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    sample_store* store = &self->diagnostics.samples;
+    if (self->diagnostics.interval == 0) {
+        Py_RETURN_NONE;
+    }
+
+    Py_ssize_t n = (Py_ssize_t)store->count;
+    PyObject* result = Py_BuildValue("{s:n,s:n}", "samples", n,
+                                     "dropped", (Py_ssize_t)store->dropped);
+    if (result == NULL) {
+        return NULL;
+    }
+    // One packed array per diagnostic, transposed from the sample rows
+    for (int c = 0; c < DIAG_NUM_COLUMNS; c++) {
+        double* column = NULL;
+        PyObject* view = new_double_array(n, &column);
+        if (view == NULL) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        for (Py_ssize_t r = 0; r < n; r++) {
+            column[r] = sample_store_row(store, (size_t)r)[c];
+        }
+        int rc = PyDict_SetItemString(result, flow_diagnostics_name((diagnostic_column)c), view);
+        Py_DECREF(view);
+        if (rc < 0) {
+            Py_DECREF(result);
+            return NULL;
+        }
+    }
+    if (clear) {
+        sample_store_clear(store);
+    }
+    return result;
+}
+
+static void particles_capsule_destructor(PyObject* capsule) {
+    particle_set_destroy(
+        (particle_set*)PyCapsule_GetPointer(capsule, "cfd_python.particle_set"));
+}
+
+static int parse_tracer_method(const char* name, tracer_method* method) {
+    if (strcmp(name, "rk4") == 0) {
+        *method = TRACER_RK4;
+    } else if (strcmp(name, "rk2") == 0) {
+        *method = TRACER_RK2;
+    } else {
+        PyErr_Format(PyExc_ValueError, "method must be 'rk2' or 'rk4', got '%s'", name);
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject* Simulation_set_particles(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"x", "y", "method", "every", NULL};
+    PyObject* x_obj;
+    PyObject* y_obj = Py_None;
+    const char* method_name = "rk4";
+    Py_ssize_t every = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|Osn", (char**)kwlist, &x_obj, &y_obj,
+                                     &method_name, &every)) {
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    if (x_obj == Py_None) {
+        self->particles = NULL;
+        Py_CLEAR(self->particles_owner);
+        Py_RETURN_NONE;
+    }
+    tracer_method method;
+    if (parse_tracer_method(method_name, &method) < 0) {
+        return NULL;
+    }
+    if (every < 0) {
+        PyErr_SetString(PyExc_ValueError, "every must be non-negative");
+        return NULL;
+    }
+
+    double_buffer x, y;
+    if (acquire_double_buffer(x_obj, 0, &x) < 0) {
+        return NULL;
+    }
+    if (acquire_double_buffer(y_obj, 0, &y) < 0) {
+        release_double_buffer(&x);
+        return NULL;
+    }
+    particle_set* particles = NULL;
+    if (x.count != y.count) {
+        PyErr_Format(PyExc_ValueError, "x and y must have the same length, got %zd and %zd",
+                     x.count, y.count);
+    } else {
+        particles = particle_set_create(x.data, y.data, (size_t)x.count, method, (size_t)every);
+        if (particles == NULL) {
+            PyErr_NoMemory();
+        }
+    }
+    release_double_buffer(&x);
+    release_double_buffer(&y);
+    if (particles == NULL) {
+        return NULL;
+    }
+
+    PyObject* owner = PyCapsule_New(particles, "cfd_python.particle_set",
+                                    particles_capsule_destructor);
+    if (owner == NULL) {
+        particle_set_destroy(particles);
+        return NULL;
+    }
+    PyObject* old = self->particles_owner;
+    self->particles_owner = owner;
+    self->particles = particles;
+    Py_XDECREF(old);
+    Py_RETURN_NONE;
+}
+
+static PyObject* Simulation_advect_particles(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"dt", "steps", NULL};
+    PyObject* dt_obj = Py_None;
+    Py_ssize_t steps = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|On", (char**)kwlist, &dt_obj, &steps)) {
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    if (self->particles == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "no particles set; call set_particles() first");
+        return NULL;
+    }
+    double dt = self->sim->params.dt;
+    if (dt_obj != Py_None) {
+        dt = PyFloat_AsDouble(dt_obj);
+        if (dt == -1.0 && PyErr_Occurred()) {
+            return NULL;
+        }
+    }
+    if (steps < 1) {
+        PyErr_SetString(PyExc_ValueError, "steps must be at least 1");
+        return NULL;
+    }
+
+    size_t active;
+    self->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    active = simulation_advect_particles(self, dt, (size_t)steps);
+    Py_END_ALLOW_THREADS
+    self->busy = 0;
+    return PyLong_FromSize_t(active);
+}
+
+static PyObject* Simulation_get_particles(PyObject* obj, void* closure) {
+    (void)closure;
+    SimulationObject* self = (SimulationObject*)obj;
+    const particle_set* particles = self->particles;
+    if (particles == NULL) {
+        Py_RETURN_NONE;
+    }
+    PyObject* result = Py_BuildValue(
+        "{s:n,s:n,s:s,s:n,s:n}", "count", (Py_ssize_t)particles->count,
+        "active", (Py_ssize_t)particle_set_active(particles),
+        "method", particles->method == TRACER_RK2 ? "rk2" : "rk4",
+        "every", (Py_ssize_t)particles->interval, "steps", (Py_ssize_t)particles->steps);
+    if (result == NULL) {
+        return NULL;
+    }
+    // Writable views of the native positions, so seeds can be edited in place
+    const char* names[2] = {"x", "y"};
+    double* arrays[2] = {particles->x, particles->y};
+    for (int a = 0; a < 2; a++) {
+        PyObject* view = make_double_view(self->particles_owner, arrays[a],
+                                          (Py_ssize_t)particles->count, 0);
+        if (view == NULL || PyDict_SetItemString(result, names[a], view) < 0) {
+            Py_XDECREF(view);
+            Py_DECREF(result);
+            return NULL;
+        }
+        Py_DECREF(view);
+    }
+    return result;
+}
+
+static PyObject* Simulation_add_output(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"type", "pattern", "every", "binary", "precision",
+                                         NULL};
+    int type;
+    const char* pattern;
+    Py_ssize_t every = 1;
+    int binary = 0;
+    int precision = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "is|npi", (char**)kwlist,
+                                     &type, &pattern, &every, &binary, &precision)) {
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0 ||
+        schedule_output(&self->outputs, type, pattern, every, binary, precision) < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* Simulation_clear_outputs(PyObject* obj, PyObject* args) {
+    (void)args;
+    SimulationObject* self = (SimulationObject*)obj;
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    output_schedule_clear(&self->outputs);
+    Py_RETURN_NONE;
+}
+
+static PyObject* Simulation_get_outputs(PyObject* obj, void* closure) {
+    (void)closure;
+    SimulationObject* self = (SimulationObject*)obj;
+    const output_schedule* schedule = &self->outputs;
+    PyObject* result = PyList_New((Py_ssize_t)schedule->count);
+    if (result == NULL) {
+        return NULL;
+    }
+    for (size_t k = 0; k < schedule->count; k++) {
+        const scheduled_output* item = &schedule->items[k];
+        PyObject* entry = Py_BuildValue(
+            "{s:i,s:s,s:n,s:O,s:i,s:n}", "type", (int)item->type, "pattern", item->pattern,
+            "every", (Py_ssize_t)item->interval, "binary", item->binary ? Py_True : Py_False,
+            "precision", item->precision, "writes", (Py_ssize_t)item->writes);
+        if (entry == NULL) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyList_SetItem(result, (Py_ssize_t)k, entry);
+    }
+    return result;
+}
+
+static PyObject* compute_gradient_fields(const gradient_inputs* in, PyObject* fields,
+                                         PyObject* out_obj);
+static PyObject* sample_lines_impl(const double* x, size_t nx, const double* y, size_t ny,
+                                   const char* const* names, const double* const* fields,
+                                   size_t num_fields, PyObject* lines, Py_ssize_t num_points);
+
+static PyObject* Simulation_sample_lines(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"lines", "num_points", NULL};
+    static const char* const names[3] = {"u", "v", "p"};
+    PyObject* lines;
+    Py_ssize_t num_points = 100;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|n", (char**)kwlist, &lines, &num_points)) {
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    const flow_field* field = self->sim->field;
+    const grid* g = self->sim->grid;
+    const double* fields[3] = {field->u, field->v, field->p};
+    self->busy = 1;
+    PyObject* result = sample_lines_impl(g->x, self->nx, g->y, self->ny, names, fields, 3,
+                                         lines, num_points);
+    self->busy = 0;
+    return result;
+}
+
+static int parse_resample_plan(PyObject* factor_obj, PyObject* roi_obj, const char* mode,
+                               size_t nx, size_t ny, resample_plan* plan);
+static PyObject* resample_impl(const double* x, const double* y, size_t nx,
+                               const char* const* names, const double* const* fields,
+                               size_t num_fields, const resample_plan* plan);
+
+static PyObject* Simulation_resample(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"factor", "roi", "mode", NULL};
+    static const char* const names[3] = {"u", "v", "p"};
+    PyObject* factor_obj = NULL;
+    PyObject* roi_obj = Py_None;
+    const char* mode = "average";
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OOs", (char**)kwlist, &factor_obj, &roi_obj,
+                                     &mode)) {
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    resample_plan plan;
+    if (parse_resample_plan(factor_obj, roi_obj, mode, self->nx, self->ny, &plan) < 0) {
+        return NULL;
+    }
+    const flow_field* field = self->sim->field;
+    const grid* g = self->sim->grid;
+    const double* fields[3] = {field->u, field->v, field->p};
+    self->busy = 1;
+    PyObject* result = resample_impl(g->x, g->y, self->nx, names, fields, 3, &plan);
+    self->busy = 0;
+    return result;
+}
+
+/*
+ * Write u, v, p as a legacy VTK flow field, ASCII with `precision` digits or
+ * BINARY, through the in-tree writers. Returns -1 with OSError set if the
+ * write fails.
+ */
+static int write_flow_vtk(const char* filename, const flow_field* field, size_t nx, size_t ny,
+                          size_t nz, double xmin, double xmax, double ymin, double ymax,
+                          double zmin, double zmax, int binary, int precision) {
+    vtk_geometry geom;
+    vtk_geometry_from_bounds(&geom, nx, ny, nz, xmin, xmax, ymin, ymax, zmin, zmax);
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    if (binary) {
+        rc = vtk_binary_write_flow(filename, field->u, field->v, field->p, &geom);
+    } else {
+        rc = vtk_ascii_write_flow(filename, field->u, field->v, field->p, &geom, precision);
+    }
+    Py_END_ALLOW_THREADS
+    if (rc < 0) {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Write a .vtr file with the GIL released. compress is a zlib level; 0
+ * writes raw appended data.
+ */
+static int write_vtr_file(const char* filename, const vtk_xml_coords* coords,
+                          const vtk_xml_array* arrays, size_t count, int compress) {
+    if (compress < 0 || compress > 9) {
+        PyErr_SetString(PyExc_ValueError, "compress must be a zlib level between 0 and 9");
+        return -1;
+    }
+    if (compress > 0 && !vtk_xml_compression_available()) {
+        PyErr_SetString(PyExc_NotImplementedError,
+                        "Compressed VTK XML output needs cfd_python built with zlib");
+        return -1;
+    }
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = vtk_xml_write_rectilinear(filename, coords, arrays, count, compress);
+    Py_END_ALLOW_THREADS
+    if (rc < 0) {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
+        return -1;
+    }
+    return 0;
+}
+
+static int append_pvd_entry(const char* collection, const char* dataset, double time, int part,
+                            int create_new) {
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = vtk_pvd_append(collection, dataset, time, part, create_new);
+    Py_END_ALLOW_THREADS
+    if (rc < 0) {
+        if (errno == EINVAL) {
+            PyErr_Format(PyExc_ValueError, "'%s' is not a .pvd collection written by cfd_python",
+                         collection);
+        } else {
+            PyErr_SetFromErrnoWithFilename(PyExc_OSError, collection);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+// Dataset path relative to the collection when both share its directory prefix
+static const char* pvd_dataset_entry(const char* collection, const char* dataset) {
+    const char* sep = NULL;
+    for (const char* c = collection; *c != '\0'; c++) {
+        if (*c == '/' || *c == '\\') {
+            sep = c;
+        }
+    }
+    if (sep == NULL) {
+        return dataset;
+    }
+    size_t len = (size_t)(sep - collection) + 1;
+    return strncmp(dataset, collection, len) == 0 ? dataset + len : dataset;
+}
+
+// Injection plan for the writers; the output must be at least 2x2 points
+static int simulation_output_plan(SimulationObject* self, PyObject* factor_obj,
+                                  PyObject* roi_obj, resample_plan* plan) {
+    if (parse_resample_plan(factor_obj, roi_obj, "inject", self->nx, self->ny, plan) < 0) {
+        return -1;
+    }
+    if (resample_out_nx(plan) < 2 || resample_out_ny(plan) < 2) {
+        PyErr_SetString(PyExc_ValueError, "output region must be at least 2x2 points");
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Inject u, v and p of the live state into `out`, sized for the plan, and
+ * return the window bounds. Injection keeps every output point on a grid
+ * node, so the bounds describe the written geometry exactly.
+ */
+static void simulation_fill_output(SimulationObject* self, const resample_plan* plan,
+                                   flow_field* out, double bounds[4]) {
+    size_t mx = resample_out_nx(plan);
+    size_t my = resample_out_ny(plan);
+    const flow_field* field = self->sim->field;
+    const grid* g = self->sim->grid;
+    Py_BEGIN_ALLOW_THREADS
+    resample_field(field->u, self->nx, plan, out->u);
+    resample_field(field->v, self->nx, plan, out->v);
+    resample_field(field->p, self->nx, plan, out->p);
+    Py_END_ALLOW_THREADS
+    bounds[0] = g->x[plan->i0];
+    bounds[1] = g->x[plan->i0 + (mx - 1) * plan->fx];
+    bounds[2] = g->y[plan->j0];
+    bounds[3] = g->y[plan->j0 + (my - 1) * plan->fy];
+}
+
+// Node coordinates of the injected points: x followed by y
+static void simulation_output_coords(SimulationObject* self, const resample_plan* plan,
+                                     double* coords) {
+    const grid* g = self->sim->grid;
+    resample_axis(g->x, plan->i0, plan->i1, plan->fx, RESAMPLE_INJECT, coords);
+    resample_axis(g->y, plan->j0, plan->j1, plan->fy, RESAMPLE_INJECT,
+                  coords + resample_out_nx(plan));
+}
+
+// Inject the live state into a new flow field for the writers
+static flow_field* simulation_output_field(SimulationObject* self, PyObject* factor_obj,
+                                           PyObject* roi_obj, resample_plan* plan,
+                                           double bounds[4]) {
+    if (simulation_output_plan(self, factor_obj, roi_obj, plan) < 0) {
+        return NULL;
+    }
+    flow_field* out = flow_field_create(resample_out_nx(plan), resample_out_ny(plan), 1);
+    if (out == NULL) {
+        PyErr_SetString(PyExc_MemoryError, "Failed to allocate flow field");
+        return NULL;
+    }
+    // Parsing the plan may have run Python code, so check again before the
+    // copy releases the GIL
+    if (simulation_check_idle(self) < 0) {
+        flow_field_destroy(out);
+        return NULL;
+    }
+    self->busy = 1;
+    simulation_fill_output(self, plan, out, bounds);
+    self->busy = 0;
+    return out;
+}
+
+static PyObject* Simulation_write_vtk(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"filename", "factor", "roi", "binary", "precision",
+                                         NULL};
+    const char* filename;
+    PyObject* factor_obj = NULL;
+    PyObject* roi_obj = Py_None;
+    int binary = 0;
+    int precision = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|OOpi", (char**)kwlist, &filename,
+                                     &factor_obj, &roi_obj, &binary, &precision)) {
+        return NULL;
+    }
+    if (check_precision(precision) < 0 || simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    resample_plan plan;
+    double bounds[4];
+    flow_field* out = simulation_output_field(self, factor_obj, roi_obj, &plan, bounds);
+    if (out == NULL) {
+        return NULL;
+    }
+    int rc = write_flow_vtk(filename, out, resample_out_nx(&plan), resample_out_ny(&plan), 1,
+                            bounds[0], bounds[1], bounds[2], bounds[3], 0.0, 0.0, binary,
+                            precision);
+    flow_field_destroy(out);
+    if (rc < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* Simulation_write_vtr(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"filename", "factor", "roi", "compress", "collection",
+                                         NULL};
+    const char* filename;
+    PyObject* factor_obj = NULL;
+    PyObject* roi_obj = Py_None;
+    int compress = 0;
+    const char* collection = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|OOiz", (char**)kwlist, &filename,
+                                     &factor_obj, &roi_obj, &compress, &collection)) {
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    resample_plan plan;
+    double bounds[4];
+    flow_field* out = simulation_output_field(self, factor_obj, roi_obj, &plan, bounds);
+    if (out == NULL) {
+        return NULL;
+    }
+    size_t mx = resample_out_nx(&plan);
+    size_t my = resample_out_ny(&plan);
+    double* coords = (double*)malloc((mx + my) * sizeof(double));
+    if (coords == NULL) {
+        flow_field_destroy(out);
+        return PyErr_NoMemory();
+    }
+    // Injected node coordinates, so stretched grids are written exactly
+    simulation_output_coords(self, &plan, coords);
+
+    vtk_xml_coords geom = {coords, coords + mx, NULL, mx, my, 1};
+    vtk_xml_array arrays[2] = {
+        {"velocity", 3, {out->u, out->v, NULL}},
+        {"pressure", 1, {out->p, NULL, NULL}},
+    };
+    int rc = write_vtr_file(filename, &geom, arrays, 2, compress);
+    free(coords);
+    flow_field_destroy(out);
+    if (rc < 0) {
+        return NULL;
+    }
+    if (collection != NULL &&
+        append_pvd_entry(collection, pvd_dataset_entry(collection, filename), self->time, 0,
+                         0) < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* Simulation_write_csv(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"filename", "factor", "roi", "create_new", NULL};
+    const char* filename;
+    PyObject* factor_obj = NULL;
+    PyObject* roi_obj = Py_None;
+    int create_new = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|OOp", (char**)kwlist, &filename, &factor_obj,
+                                     &roi_obj, &create_new)) {
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    resample_plan plan;
+    double bounds[4];
+    flow_field* out = simulation_output_field(self, factor_obj, roi_obj, &plan, bounds);
+    if (out == NULL) {
+        return NULL;
+    }
+    write_csv_timeseries(filename, (int)self->step_count, self->time, out, NULL,
+                         &self->sim->params, simulation_get_stats(self->sim),
+                         resample_out_nx(&plan), resample_out_ny(&plan), create_new);
+    flow_field_destroy(out);
+    Py_RETURN_NONE;
+}
+
+static PyObject* energy_spectrum_impl(const double* u, const double* v, const double* x,
+                                      const double* y, size_t nx, size_t ny, int skip_endpoint);
+
+static PyObject* Simulation_energy_spectrum(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"skip_endpoint", NULL};
+    int skip_endpoint = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|p", (char**)kwlist, &skip_endpoint)) {
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    const flow_field* field = self->sim->field;
+    const grid* g = self->sim->grid;
+    self->busy = 1;
+    PyObject* result = energy_spectrum_impl(field->u, field->v, g->x, g->y, self->nx, self->ny,
+                                            skip_endpoint);
+    self->busy = 0;
+    return result;
+}
+
+static PyObject* Simulation_derived_fields(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SimulationObject* self = (SimulationObject*)obj;
+    static const char* const kwlist[] = {"fields", "out", NULL};
+    PyObject* fields = Py_None;
+    PyObject* out_obj = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OO", (char**)kwlist, &fields, &out_obj)) {
+        return NULL;
+    }
+    if (simulation_check_idle(self) < 0) {
+        return NULL;
+    }
+    const flow_field* field = self->sim->field;
+    const grid* g = self->sim->grid;
+    gradient_inputs in = {field->u, field->v, field->p, g->x, g->y, self->nx, self->ny};
+    self->busy = 1;
+    PyObject* result = compute_gradient_fields(&in, fields, out_obj);
+    self->busy = 0;
+    return result;
+}
+
+static PyObject* Simulation_get_divergence_info(PyObject* obj, void* closure) {
+    (void)closure;
+    const divergence_guard* guard = &((SimulationObject*)obj)->guard;
+    return Py_BuildValue("{s:O,s:n,s:d,s:i,s:d,s:n,s:n,s:n,s:i,s:d}",
+                         "enabled", guard->policy.check_interval > 0 ? Py_True : Py_False,
+                         "check_every", (Py_ssize_t)guard->policy.check_interval,
+                         "max_velocity", guard->policy.max_velocity,
+                         "max_retries", guard->policy.max_retries,
+                         "dt_factor", guard->policy.dt_factor,
+                         "history", (Py_ssize_t)guard->capacity,
+                         "saved_states", (Py_ssize_t)guard->count,
+                         "rollbacks", (Py_ssize_t)guard->rollbacks,
+                         "retries", guard->retries,
+                         "last_max_velocity", guard->last_max_velocity);
+}
+
+static PyObject* Simulation_get_stats(PyObject* obj, void* closure) {
+    (void)closure;
+    SimulationObject* self = (SimulationObject*)obj;
+    const ns_solver_stats_t* stats = simulation_get_stats(self->sim);
+    if (stats == NULL) {
+        Py_RETURN_NONE;
+    }
+    return Py_BuildValue("{s:i,s:d,s:d,s:d}",
+                         "iterations", stats->iterations,
+                         "max_velocity", stats->max_velocity,
+                         "max_pressure", stats->max_pressure,
+                         "elapsed_time_ms", stats->elapsed_time_ms);
+}
+
+static PyObject* Simulation_get_field(PyObject* obj, void* closure) {
+    SimulationObject* self = (SimulationObject*)obj;
+    flow_field* field = self->sim->field;
+    double* data = NULL;
+    switch ((int)(intptr_t)closure) {
+        case 0: data = field->u; break;
+        case 1: data = field->v; break;
+        default: data = field->p; break;
+    }
+    return make_double_view(obj, data, (Py_ssize_t)(self->nx * self->ny), 0);
+}
+
+static PyObject* Simulation_get_grid(PyObject* obj, void* closure) {
+    (void)closure;
+    return grid_object_from_grid(((SimulationObject*)obj)->sim->grid);
+}
+
+static PyObject* Simulation_get_solver_name(PyObject* obj, void* closure) {
+    (void)closure;
+    ns_solver_t* solver = simulation_get_solver(((SimulationObject*)obj)->sim);
+    if (solver == NULL || solver->name == NULL) {
+        Py_RETURN_NONE;
+    }
+    return PyUnicode_FromString(solver->name);
+}
+
+static PyObject* Simulation_get_param(PyObject* obj, void* closure) {
+    SimulationObject* self = (SimulationObject*)obj;
+    return PyFloat_FromDouble(closure ? self->sim->params.cfl : self->sim->params.dt);
+}
+
+static int Simulation_set_param(PyObject* obj, PyObject* value, void* closure) {
+    SimulationObject* self = (SimulationObject*)obj;
+    if (value == NULL) {
+        PyErr_SetString(PyExc_AttributeError, "cannot delete simulation parameter");
+        return -1;
+    }
+    double v = PyFloat_AsDouble(value);
+    if (v == -1.0 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (v <= 0.0) {
+        PyErr_SetString(PyExc_ValueError, "value must be positive");
+        return -1;
+    }
+    if (closure) {
+        self->sim->params.cfl = v;
+    } else {
+        self->sim->params.dt = v;
+    }
+    return 0;
+}
+
+static PyObject* Simulation_repr(PyObject* obj) {
+    SimulationObject* self = (SimulationObject*)obj;
+    char buffer[160];
+    snprintf(buffer, sizeof(buffer), "Simulation(nx=%zu, ny=%zu, step=%zu, time=%g)",
+             self->nx, self->ny, self->step_count, self->time);
+    return PyUnicode_FromString(buffer);
+}
+
+static PyMemberDef Simulation_members[] = {
+    {"nx", T_PYSSIZET, offsetof(SimulationObject, nx), READONLY, "Grid points in x direction"},
+    {"ny", T_PYSSIZET, offsetof(SimulationObject, ny), READONLY, "Grid points in y direction"},
+    {"step_count", T_PYSSIZET, offsetof(SimulationObject, step_count), READONLY,
+     "Number of completed time steps"},
+    {"time", T_DOUBLE, offsetof(SimulationObject, time), READONLY, "Simulation time"},
+    {NULL, 0, 0, 0, NULL}
+};
+
+static PyGetSetDef Simulation_getset[] = {
+    {"u", Simulation_get_field, NULL, "Live x-velocity field (writable memoryview, no copy)", (void*)0},
+    {"v", Simulation_get_field, NULL, "Live y-velocity field (writable memoryview, no copy)", (void*)1},
+    {"p", Simulation_get_field, NULL, "Live pressure field (writable memoryview, no copy)", (void*)2},
+    {"grid", Simulation_get_grid, NULL, "Simulation grid (Grid copy)", NULL},
+    {"stats", Simulation_get_stats, NULL, "Solver statistics of the last step", NULL},
+    {"solver_name", Simulation_get_solver_name, NULL, "Name of the active solver", NULL},
+    {"dt", Simulation_get_param, Simulation_set_param, "Time step size", NULL},
+    {"cfl", Simulation_get_param, Simulation_set_param, "CFL number", (void*)1},
+    {"divergence_info", Simulation_get_divergence_info, NULL,
+     "Divergence guard policy and rollback counters (dict)", NULL},
+    {"averages", Simulation_get_averages, NULL,
+     "Running averages as live read-only views (dict), or None", NULL},
+    {"particles", Simulation_get_particles, NULL,
+     "Tracer particles: dict with writable 'x' and 'y' float64 views of the\n"
+     "native positions (zero-copy; NaN once a particle leaves the grid),\n"
+     "'count', 'active', 'method', 'every' and 'steps'; None if unset", NULL},
+    {"outputs", Simulation_get_outputs, NULL,
+     "Scheduled outputs: list of dicts with 'type', 'pattern', 'every',\n"
+     "'binary' and 'writes'", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyMethodDef Simulation_methods[] = {
+    {"step", (PyCFunction)(void(*)(void))Simulation_step, METH_VARARGS | METH_KEYWORDS,
+     "Advance the simulation.\n\n"
+     "The GIL is released while the solver runs.\n\n"
+     "Args:\n"
+     "    steps (int, optional): Number of time steps (default: 1)\n\n"
+     "Returns:\n"
+     "    int: Number of steps completed\n\n"
+     "Raises:\n"
+     "    CFDError: Subclass matching the failing step's status code"},
+    {"clone", Simulation_clone, METH_NOARGS,
+     "Return an independent copy of the current state.\n\n"
+     "The copy is re-initialized with the same grid and solver, then the flow\n"
+     "field arrays, solver parameters, step count and time are copied with a\n"
+     "parallel memcpy. Solver-internal scratch state is rebuilt by the solver."},
+    {"set_fields", (PyCFunction)(void(*)(void))Simulation_set_fields, METH_VARARGS | METH_KEYWORDS,
+     "Overwrite u, v and/or p (lists, NumPy float64 arrays or float64 buffers).\n\n"
+     "Args:\n"
+     "    u, v, p (optional): New values, nx*ny elements each"},
+    {"snapshot", Simulation_snapshot, METH_NOARGS,
+     "Return a FieldSnapshot copy of the current u, v and p."},
+    {"set_divergence_guard", (PyCFunction)(void(*)(void))Simulation_set_divergence_guard,
+     METH_VARARGS | METH_KEYWORDS,
+     "Enable automatic divergence detection with rollback and dt retry.\n\n"
+     "Every check_every steps u, v and p are scanned in one fused pass for\n"
+     "NaN/Inf and for velocity magnitudes above max_velocity. Passing states\n"
+     "are kept in a ring of the last `history` states. On divergence the\n"
+     "simulation rolls back (further back on each retry), multiplies dt by\n"
+     "dt_factor and continues. After max_retries failed retries the newest\n"
+     "saved state is restored and step() raises CFDDivergedError.\n\n"
+     "Args:\n"
+     "    check_every (int, optional): Check interval in steps, 0 disables (default: 10)\n"
+     "    max_velocity (float, optional): Velocity limit, <= 0 checks NaN/Inf only (default: 0)\n"
+     "    max_retries (int, optional): Retries per divergence (default: 3)\n"
+     "    dt_factor (float, optional): dt multiplier per retry (default: 0.5)\n"
+     "    history (int, optional): Saved states kept for rollback (default: 2)"},
+    {"start_averaging", (PyCFunction)(void(*)(void))Simulation_start_averaging,
+     METH_VARARGS | METH_KEYWORDS,
+     "Start (or restart) running time-average accumulators.\n\n"
+     "Every `every` steps the step loop folds u, v and p into per-point running\n"
+     "means, second moments (uu, vv, uv, pp) and min/max envelopes. Memory is\n"
+     "13 fields regardless of run length. Read the results at any time through\n"
+     "the averages property. Clones start without accumulators.\n\n"
+     "Args:\n"
+     "    every (int, optional): Sampling interval in steps (default: 1)"},
+    {"stop_averaging", Simulation_stop_averaging, METH_NOARGS,
+     "Detach the accumulators; views obtained earlier keep their final values."},
+    {"set_probes", (PyCFunction)(void(*)(void))Simulation_set_probes, METH_VARARGS | METH_KEYWORDS,
+     "Record u, v and p at fixed points inside the step loop.\n\n"
+     "Each probe is bilinearly interpolated from the four surrounding grid\n"
+     "nodes (uniform or stretched); the stencil is resolved once here. Samples\n"
+     "go into a native store that grows on demand, or keeps only the newest\n"
+     "max_samples rows. Replaces any earlier probes and their samples.\n\n"
+     "Args:\n"
+     "    points (sequence): (x, y) pairs inside the grid, or None to remove probes\n"
+     "    every (int, optional): Sampling interval in steps (default: 1)\n"
+     "    max_samples (int, optional): Ring-buffer size, 0 grows without limit (default: 0)"},
+    {"probe_data", (PyCFunction)(void(*)(void))Simulation_probe_data, METH_VARARGS | METH_KEYWORDS,
+     "Return the recorded probe samples.\n\n"
+     "Args:\n"
+     "    clear (bool, optional): Empty the store after reading (default: False)\n\n"
+     "Returns:\n"
+     "    dict: 'points', 'samples', 'dropped', 'time' and 'step' (float64 views),\n"
+     "        and 'probes' - one packed float64 view per probe holding (u, v, p)\n"
+     "        per sample; None if no probes are set"},
+    {"set_diagnostics", (PyCFunction)(void(*)(void))Simulation_set_diagnostics,
+     METH_VARARGS | METH_KEYWORDS,
+     "Record integral diagnostics inside the step loop.\n\n"
+     "Every `every` steps one fused reduction computes the kinetic energy\n"
+     "(1/2 integral of u^2 + v^2), the enstrophy (1/2 integral of vorticity^2),\n"
+     "the outward mass flux through each edge and the peak |divergence|.\n"
+     "Integrals use trapezoidal weights from the grid coordinates. Replaces any\n"
+     "earlier diagnostics and their samples.\n\n"
+     "Args:\n"
+     "    every (int, optional): Sampling interval in steps, 0 disables (default: 1)\n"
+     "    max_samples (int, optional): Ring-buffer size, 0 grows without limit (default: 0)"},
+    {"diagnostic_data", (PyCFunction)(void(*)(void))Simulation_diagnostic_data,
+     METH_VARARGS | METH_KEYWORDS,
+     "Return the recorded diagnostics time series.\n\n"
+     "Args:\n"
+     "    clear (bool, optional): Empty the store after reading (default: False)\n\n"
+     "Returns:\n"
+     "    dict: 'samples', 'dropped' and one float64 view per column: 'time',\n"
+     "        'step', 'kinetic_energy', 'enstrophy', 'flux_left', 'flux_right',\n"
+     "        'flux_bottom', 'flux_top', 'max_divergence'; None if disabled"},
+    {"set_particles", (PyCFunction)(void(*)(void))Simulation_set_particles,
+     METH_VARARGS | METH_KEYWORDS,
+     "Seed massless tracer particles advected inside the step loop.\n\n"
+     "Positions are copied into native x and y arrays. Every `every` steps the\n"
+     "step loop advects them by every*dt through the new velocity field with\n"
+     "RK2 or RK4 and bilinear interpolation (uniform or stretched grids),\n"
+     "OpenMP-parallel over particles. Particles that leave the grid become NaN.\n"
+     "Positions are not restored by divergence-guard rollbacks. Replaces any\n"
+     "earlier particles; clones start without particles.\n\n"
+     "Args:\n"
+     "    x, y: Seed coordinates (lists, NumPy float64 arrays or float64\n"
+     "        buffers), or x=None to remove the particles\n"
+     "    method (str, optional): 'rk2' or 'rk4' (default: 'rk4')\n"
+     "    every (int, optional): Advection interval in steps, 0 advects only\n"
+     "        through advect_particles() (default: 1)"},
+    {"advect_particles", (PyCFunction)(void(*)(void))Simulation_advect_particles,
+     METH_VARARGS | METH_KEYWORDS,
+     "Advect the particles through the current velocity field, between steps.\n\n"
+     "The field is held fixed; the GIL is released.\n\n"
+     "Args:\n"
+     "    dt (float, optional): Step size (default: the simulation dt)\n"
+     "    steps (int, optional): Number of steps (default: 1)\n\n"
+     "Returns:\n"
+     "    int: Particles still inside the grid"},
+    {"add_output", (PyCFunction)(void(*)(void))Simulation_add_output,
+     METH_VARARGS | METH_KEYWORDS,
+     "Write an output file inside the step loop every `every` steps.\n\n"
+     "The file name is `pattern` with one printf-style step conversion\n"
+     "expanded (\"flow_%06d.vtk\"); other conversions are rejected. A pattern\n"
+     "without one names a single file: CSV types append a row per write and\n"
+     "VTK types overwrite it. Outputs are written in the order they were\n"
+     "added; a failed write stops step() with CFDIOError. Clones start\n"
+     "without outputs.\n\n"
+     "Types:\n"
+     "    OUTPUT_VELOCITY_MAGNITUDE: VTK scalars 'velocity_magnitude'\n"
+     "    OUTPUT_VELOCITY: VTK vectors 'velocity'\n"
+     "    OUTPUT_FULL_FIELD: VTK velocity and pressure\n"
+     "    OUTPUT_CSV_TIMESERIES: CSV timeseries row (library format)\n"
+     "    OUTPUT_CSV_CENTERLINE: CSV of u, v, p along the horizontal and\n"
+     "        vertical centerlines (axis, x, y, u, v, p)\n"
+     "    OUTPUT_CSV_STATISTICS: CSV row of step, time and min/max/mean of\n"
+     "        u, v, p and velocity magnitude\n\n"
+     "Args:\n"
+     "    type (int): OUTPUT_* constant\n"
+     "    pattern (str): File name pattern\n"
+     "    every (int, optional): Output interval in steps (default: 1)\n"
+     "    binary (bool, optional): Legacy BINARY encoding for VTK types\n"
+     "        (default: False)\n"
+     "    precision (int, optional): Significant digits of text values (ASCII\n"
+     "        VTK, centerline and statistics CSV); 0 writes the shortest digits\n"
+     "        that read back exactly (default: 0)"},
+    {"clear_outputs", Simulation_clear_outputs, METH_NOARGS,
+     "Remove all scheduled outputs."},
+    {"sample_lines", (PyCFunction)(void(*)(void))Simulation_sample_lines,
+     METH_VARARGS | METH_KEYWORDS,
+     "Sample u, v and p along lines with bilinear interpolation.\n\n"
+     "Same as sample_lines() on the live fields and the simulation grid.\n\n"
+     "Args:\n"
+     "    lines (sequence): {'x': x0}, {'y': y0} or polylines of (x, y) pairs\n"
+     "    num_points (int, optional): Samples per polyline (default: 100)\n\n"
+     "Returns:\n"
+     "    list: One dict per line with 'x', 'y', 'distance', 'u', 'v' and 'p' views"},
+    {"resample", (PyCFunction)(void(*)(void))Simulation_resample, METH_VARARGS | METH_KEYWORDS,
+     "Restrict and/or crop u, v and p of the live state.\n\n"
+     "Same as resample_fields() on the live fields and the simulation grid.\n\n"
+     "Args:\n"
+     "    factor (int or (int, int), optional): Reduction factor per axis (default: 1)\n"
+     "    roi (tuple, optional): Index window (i0, i1, j0, j1), ends exclusive\n"
+     "    mode (str, optional): 'average' or 'inject' (default: 'average')\n\n"
+     "Returns:\n"
+     "    dict: 'nx', 'ny', 'x', 'y', 'u', 'v' and 'p'"},
+    {"write_vtk", (PyCFunction)(void(*)(void))Simulation_write_vtk, METH_VARARGS | METH_KEYWORDS,
+     "Write u, v and p of the live state as a VTK flow field.\n\n"
+     "The fields are decimated by injection and/or cropped natively before\n"
+     "the writer runs, so only the selected points are formatted.\n\n"
+     "Args:\n"
+     "    filename (str): Output file\n"
+     "    factor (int or (int, int), optional): Keep every factor-th node (default: 1)\n"
+     "    roi (tuple, optional): Index window (i0, i1, j0, j1), ends exclusive\n"
+     "    binary (bool, optional): Legacy BINARY encoding (big-endian float64)\n"
+     "        instead of ASCII (default: False)\n"
+     "    precision (int, optional): Significant digits of ASCII values; 0 writes\n"
+     "        the shortest digits that read back exactly (default: 0)"},
+    {"write_vtr", (PyCFunction)(void(*)(void))Simulation_write_vtr, METH_VARARGS | METH_KEYWORDS,
+     "Write velocity and pressure of the live state as a VTK XML .vtr file.\n\n"
+     "The file stores the actual x and y coordinates, so stretched grids are\n"
+     "written exactly, with the fields as appended raw float64 data.\n\n"
+     "Args:\n"
+     "    filename (str): Output file\n"
+     "    factor (int or (int, int), optional): Keep every factor-th node (default: 1)\n"
+     "    roi (tuple, optional): Index window (i0, i1, j0, j1), ends exclusive\n"
+     "    compress (int, optional): zlib level 1-9 for block compression, 0 for\n"
+     "        raw data; True means 1 (default: 0)\n"
+     "    collection (str, optional): .pvd collection to append this file to at\n"
+     "        the current simulation time"},
+    {"write_csv", (PyCFunction)(void(*)(void))Simulation_write_csv, METH_VARARGS | METH_KEYWORDS,
+     "Append a CSV timeseries row for the live state.\n\n"
+     "Statistics are taken over the decimated and/or cropped fields, with the\n"
+     "current step, time, solver parameters and last solver stats.\n\n"
+     "Args:\n"
+     "    filename (str): Output file\n"
+     "    factor (int or (int, int), optional): Keep every factor-th node (default: 1)\n"
+     "    roi (tuple, optional): Index window (i0, i1, j0, j1), ends exclusive\n"
+     "    create_new (bool, optional): Start a new file with a header (default: False)"},
+    {"energy_spectrum", (PyCFunction)(void(*)(void))Simulation_energy_spectrum,
+     METH_VARARGS | METH_KEYWORDS,
+     "Kinetic energy spectra of the live u and v.\n\n"
+     "Same as energy_spectrum() on the live fields and the simulation grid,\n"
+     "without copying them.\n\n"
+     "Args:\n"
+     "    skip_endpoint (bool, optional): Drop the last column and row when they\n"
+     "        repeat the first (default: False)\n\n"
+     "Returns:\n"
+     "    dict: 'k', 'E', 'kx', 'E_x', 'ky', 'E_y', 'dk' and 'energy'"},
+    {"derived_fields", (PyCFunction)(void(*)(void))Simulation_derived_fields,
+     METH_VARARGS | METH_KEYWORDS,
+     "Compute derived fields of the live state in one fused sweep.\n\n"
+     "Same as compute_derived_fields() on u, v, p and the simulation grid.\n\n"
+     "Args:\n"
+     "    fields (iterable, optional): Subset of 'vorticity', 'divergence',\n"
+     "        'strain_rate', 'q_criterion', 'dpdx', 'dpdy' (default: all)\n"
+     "    out (dict, optional): Caller-provided writable float64 buffers by name;\n"
+     "        they must not overlap u, v, p or each other\n\n"
+     "Returns:\n"
+     "    dict: Field name -> buffer of nx*ny doubles"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot Simulation_slots[] = {
+    {Py_tp_doc, (void*)
+     "Simulation(nx, ny, xmin=0.0, xmax=1.0, ymin=0.0, ymax=1.0, solver_type=None,\n"
+     "           dt=0.001, cfl=0.2)\n\n"
+     "Persistent simulation state that can be advanced, inspected and cloned.\n\n"
+     "u, v and p are live zero-copy views of the solver fields. Use clone() to\n"
+     "branch ensemble members from a spun-up state in-process, or os.fork() for\n"
+     "page-level copy-on-write branching (see reinit_after_fork)."},
+    {Py_tp_new, (void*)Simulation_new},
+    {Py_tp_dealloc, (void*)Simulation_dealloc},
+    {Py_tp_repr, (void*)Simulation_repr},
+    {Py_tp_members, Simulation_members},
+    {Py_tp_getset, Simulation_getset},
+    {Py_tp_methods, Simulation_methods},
+    {0, NULL}
+};
+
+static PyType_Spec Simulation_spec = {
+    "cfd_python.Simulation",
+    sizeof(SimulationObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    Simulation_slots
+};
+
+// ----------------------------------------------------------------------------
+// AsyncWriter
+// ----------------------------------------------------------------------------
+
+typedef enum {
+    ASYNC_VTK = 0,
+    ASYNC_VTR,
+    ASYNC_CSV
+} async_format;
+
+/*
+ * One pooled snapshot: the injected fields plus everything the writer needs,
+ * so the writer thread never touches the simulation or Python
+ */
+typedef struct {
+    async_format format;
+    char* filename;
+    char* collection;  // .pvd indexing VTR output, or NULL
+    flow_field* field;
+    double* coords;    // x then y of the output points (VTR)
+    size_t coords_capacity;
+    double bounds[4];
+    int binary;
+    int precision;
+    int compress;
+    int create_new;
+    int step;
+    double time;
+    ns_solver_params_t params;
+    ns_solver_stats_t stats;
+} async_job;
+
+typedef struct {
+    PyObject_HEAD
+    async_writer* writer;  // NULL once closed
+    async_job* jobs;
+    size_t num_jobs;
+    size_t in_use;  // Calls using `writer` with the GIL released
+} AsyncWriterObject;
+
+static PyObject* g_async_writer_type = NULL;
+
+// Runs on the writer thread
+static int async_job_write(void* context, size_t slot, const char** path) {
+    async_job* job = &((async_job*)context)[slot];
+    size_t nx = job->field->nx;
+    size_t ny = job->field->ny;
+    int rc = 0;
+    *path = job->filename;
+    errno = 0;
+    switch (job->format) {
+        case ASYNC_VTK: {
+            vtk_geometry geom;
+            vtk_geometry_from_bounds(&geom, nx, ny, 1, job->bounds[0], job->bounds[1],
+                                     job->bounds[2], job->bounds[3], 0.0, 0.0);
+            if (job->binary) {
+                rc = vtk_binary_write_flow(job->filename, job->field->u, job->field->v,
+                                           job->field->p, &geom);
+            } else {
+                rc = vtk_ascii_write_flow(job->filename, job->field->u, job->field->v,
+                                          job->field->p, &geom, job->precision);
+            }
+            break;
+        }
+        case ASYNC_VTR: {
+            vtk_xml_coords geom = {job->coords, job->coords + nx, NULL, nx, ny, 1};
+            vtk_xml_array arrays[2] = {
+                {"velocity", 3, {job->field->u, job->field->v, NULL}},
+                {"pressure", 1, {job->field->p, NULL, NULL}},
+            };
+            rc = vtk_xml_write_rectilinear(job->filename, &geom, arrays, 2, job->compress);
+            if (rc == 0 && job->collection != NULL) {
+                *path = job->collection;
+                rc = vtk_pvd_append(job->collection,
+                                    pvd_dataset_entry(job->collection, job->filename), job->time,
+                                    0, 0);
+            }
+            break;
+        }
+        case ASYNC_CSV:
+            write_csv_timeseries(job->filename, job->step, job->time, job->field, NULL,
+                                 &job->params, &job->stats, nx, ny, job->create_new);
+            break;
+    }
+    return rc < 0 ? (errno != 0 ? errno : EIO) : 0;
+}
+
+static void async_jobs_free(async_job* jobs, size_t count) {
+    for (size_t k = 0; k < count; k++) {
+        free(jobs[k].filename);
+        free(jobs[k].collection);
+        free(jobs[k].coords);
+        if (jobs[k].field != NULL) {
+            flow_field_destroy(jobs[k].field);
+        }
+    }
+    free(jobs);
+}
+
+static char* copy_string(const char* text) {
+    size_t len = strlen(text) + 1;
+    char* copy = (char*)malloc(len);
+    if (copy != NULL) {
+        memcpy(copy, text, len);
+    }
+    return copy;
+}
+
+// Size the slot's buffers for an mx x my snapshot, reusing them when they fit
+static int async_job_reserve(async_job* job, size_t mx, size_t my) {
+    if (job->field == NULL || job->field->nx != mx || job->field->ny != my) {
+        if (job->field != NULL) {
+            flow_field_destroy(job->field);
+        }
+        job->field = flow_field_create(mx, my, 1);
+        if (job->field == NULL) {
+            return -1;
+        }
+    }
+    if (job->coords_capacity < mx + my) {
+        double* coords = (double*)realloc(job->coords, (mx + my) * sizeof(double));
+        if (coords == NULL) {
+            return -1;
+        }
+        job->coords = coords;
+        job->coords_capacity = mx + my;
+    }
+    return 0;
+}
+
+// Wait for queued snapshots and raise the first background failure as OSError
+static int async_raise_error(AsyncWriterObject* self) {
+    async_writer* writer = self->writer;
+    char path[1024];
+    int error;
+    self->in_use++;
+    Py_BEGIN_ALLOW_THREADS
+    error = async_writer_flush(writer, path, sizeof(path));
+    Py_END_ALLOW_THREADS
+    self->in_use--;
+    if (error == 0) {
+        return 0;
+    }
+    errno = error;
+    PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+    return -1;
+}
+
+static int async_check_open(AsyncWriterObject* self) {
+    if (self->writer == NULL) {
+        PyErr_SetString(PyExc_ValueError, "AsyncWriter is closed");
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Raise a background failure only if one is already pending, so write()
+ * never waits for earlier snapshots to reach disk
+ */
+static int async_check_error(AsyncWriterObject* self) {
+    if (async_writer_error(self->writer) == 0) {
+        return 0;
+    }
+    return async_raise_error(self);
+}
+
+static PyObject* AsyncWriter_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static const char* const kwlist[] = {"buffers", NULL};
+    Py_ssize_t buffers = 2;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|n", (char**)kwlist, &buffers)) {
+        return NULL;
+    }
+    if (buffers < 1) {
+        PyErr_SetString(PyExc_ValueError, "buffers must be at least 1");
+        return NULL;
+    }
+    PyObject* obj = alloc_instance((PyObject*)type);
+    if (obj == NULL) {
+        return NULL;
+    }
+    AsyncWriterObject* self = (AsyncWriterObject*)obj;
+    self->jobs = (async_job*)calloc((size_t)buffers, sizeof(async_job));
+    if (self->jobs == NULL) {
+        Py_DECREF(obj);
+        return PyErr_NoMemory();
+    }
+    self->num_jobs = (size_t)buffers;
+    self->writer = async_writer_create(self->num_jobs, async_job_write, self->jobs);
+    if (self->writer == NULL) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        Py_DECREF(obj);
+        return NULL;
+    }
+    return obj;
+}
+
+static void async_writer_shutdown(AsyncWriterObject* self) {
+    async_writer* writer = self->writer;
+    self->writer = NULL;
+    Py_BEGIN_ALLOW_THREADS
+    async_writer_destroy(writer);
+    Py_END_ALLOW_THREADS
+}
+
+static void AsyncWriter_dealloc(PyObject* obj) {
+    AsyncWriterObject* self = (AsyncWriterObject*)obj;
+    // Every in-use call holds a reference, so in_use is 0 here; never free
+    // a writer that another thread is still waiting on
+    if (self->in_use > 0) {
+        return;
+    }
+    if (self->writer != NULL) {
+        async_writer_shutdown(self);
+    }
+    async_jobs_free(self->jobs, self->num_jobs);
+    dealloc_instance(obj);
+}
+
+static PyObject* AsyncWriter_write(PyObject* obj, PyObject* args, PyObject* kwds) {
+    AsyncWriterObject* self = (AsyncWriterObject*)obj;
+    static const char* const kwlist[] = {"simulation", "filename", "format", "factor", "roi",
+                                         "binary", "compress", "collection", "create_new",
+                                         "precision", NULL};
+    PyObject* sim_obj;
+    const char* filename;
+    const char* format_name = "vtk";
+    PyObject* factor_obj = NULL;
+    PyObject* roi_obj = Py_None;
+    int binary = 0;
+    int compress = 0;
+    const char* collection = NULL;
+    int create_new = 0;
+    int precision = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!s|sOOpizpi", (char**)kwlist,
+                                     (PyTypeObject*)g_simulation_type, &sim_obj, &filename,
+                                     &format_name, &factor_obj, &roi_obj, &binary, &compress,
+                                     &collection, &create_new, &precision)) {
+        return NULL;
+    }
+    if (check_precision(precision) < 0 || async_check_open(self) < 0 ||
+        async_check_error(self) < 0) {
+        return NULL;
+    }
+    async_format format;
+    if (strcmp(format_name, "vtk") == 0) {
+        format = ASYNC_VTK;
+    } else if (strcmp(format_name, "vtr") == 0) {
+        format = ASYNC_VTR;
+    } else if (strcmp(format_name, "csv") == 0) {
+        format = ASYNC_CSV;
+    } else {
+        PyErr_Format(PyExc_ValueError, "format must be 'vtk', 'vtr' or 'csv', got '%s'",
+                     format_name);
+        return NULL;
+    }
+    if (format == ASYNC_VTR) {
+        if (compress < 0 || compress > 9) {
+            PyErr_SetString(PyExc_ValueError, "compress must be a zlib level between 0 and 9");
+            return NULL;
+        }
+        if (compress > 0 && !vtk_xml_compression_available()) {
+            PyErr_SetString(PyExc_NotImplementedError,
+                            "Compressed VTK XML output needs cfd_python built with zlib");
+            return NULL;
+        }
+    }
+
+    SimulationObject* sim = (SimulationObject*)sim_obj;
+    resample_plan plan;
+    if (simulation_check_idle(sim) < 0 ||
+        simulation_output_plan(sim, factor_obj, roi_obj, &plan) < 0) {
+        return NULL;
+    }
+
+    // Back-pressure: wait for the writer to hand a buffer back. The writer
+    // stays in use until the slot is submitted, since the copy below also
+    // runs without the GIL.
+    async_writer* writer = self->writer;
+    size_t slot;
+    self->in_use++;
+    Py_BEGIN_ALLOW_THREADS
+    slot = async_writer_acquire(writer);
+    Py_END_ALLOW_THREADS
+
+    // Another thread may have started stepping the simulation meanwhile
+    if (async_check_open(self) < 0 || simulation_check_idle(sim) < 0) {
+        async_writer_release(writer, slot);
+        self->in_use--;
+        return NULL;
+    }
+
+    async_job* job = &self->jobs[slot];
+    free(job->filename);
+    free(job->collection);
+    job->filename = copy_string(filename);
+    job->collection = collection != NULL ? copy_string(collection) : NULL;
+    if (job->filename == NULL || (collection != NULL && job->collection == NULL) ||
+        async_job_reserve(job, resample_out_nx(&plan), resample_out_ny(&plan)) < 0) {
+        async_writer_release(writer, slot);
+        self->in_use--;
+        return PyErr_NoMemory();
+    }
+    job->format = format;
+    job->binary = binary;
+    job->precision = precision;
+    job->compress = compress;
+    job->create_new = create_new;
+    job->step = (int)sim->step_count;
+    job->time = sim->time;
+    job->params = sim->sim->params;
+    const ns_solver_stats_t* stats = simulation_get_stats(sim->sim);
+    job->stats = stats != NULL ? *stats : ns_solver_stats_default();
+
+    sim->busy = 1;
+    simulation_fill_output(sim, &plan, job->field, job->bounds);
+    simulation_output_coords(sim, &plan, job->coords);
+    sim->busy = 0;
+
+    async_writer_submit(writer, slot);
+    self->in_use--;
+    Py_RETURN_NONE;
+}
+
+static PyObject* AsyncWriter_flush(PyObject* obj, PyObject* args) {
+    (void)args;
+    AsyncWriterObject* self = (AsyncWriterObject*)obj;
+    if (async_check_open(self) < 0 || async_raise_error(self) < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* AsyncWriter_close(PyObject* obj, PyObject* args) {
+    (void)args;
+    AsyncWriterObject* self = (AsyncWriterObject*)obj;
+    if (self->writer == NULL) {
+        Py_RETURN_NONE;
+    }
+    int rc = async_raise_error(self);
+    if (self->in_use > 0) {
+        if (rc == 0) {
+            PyErr_SetString(PyExc_RuntimeError, "AsyncWriter is in use by another thread");
+        }
+        return NULL;
+    }
+    async_writer_shutdown(self);
+    if (rc < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* AsyncWriter_enter(PyObject* obj, PyObject* args) {
+    (void)args;
+    if (async_check_open((AsyncWriterObject*)obj) < 0) {
+        return NULL;
+    }
+    Py_INCREF(obj);
+    return obj;
+}
+
+static PyObject* AsyncWriter_exit(PyObject* obj, PyObject* args) {
+    (void)args;
+    PyObject* result = AsyncWriter_close(obj, NULL);
+    if (result == NULL) {
+        return NULL;
+    }
+    Py_DECREF(result);
+    Py_RETURN_FALSE;
+}
+
+static PyObject* AsyncWriter_get_pending(PyObject* obj, void* closure) {
+    (void)closure;
+    AsyncWriterObject* self = (AsyncWriterObject*)obj;
+    if (self->writer == NULL) {
+        return PyLong_FromLong(0);
+    }
+    return PyLong_FromSize_t(async_writer_pending(self->writer));
+}
+
+static PyObject* AsyncWriter_get_closed(PyObject* obj, void* closure) {
+    (void)closure;
+    return PyBool_FromLong(((AsyncWriterObject*)obj)->writer == NULL);
+}
+
+static PyObject* AsyncWriter_get_stats(PyObject* obj, void* closure) {
+    (void)closure;
+    AsyncWriterObject* self = (AsyncWriterObject*)obj;
+    if (async_check_open(self) < 0) {
+        return NULL;
+    }
+    async_writer_stats stats;
+    async_writer_get_stats(self->writer, &stats);
+    return Py_BuildValue("{s:n,s:n,s:n,s:n,s:n}",
+                         "buffers", (Py_ssize_t)self->num_jobs,
+                         "submitted", (Py_ssize_t)stats.submitted,
+                         "completed", (Py_ssize_t)stats.completed,
+                         "failed", (Py_ssize_t)stats.failed,
+                         "stalls", (Py_ssize_t)stats.stalls);
+}
+
+static PyGetSetDef AsyncWriter_getset[] = {
+    {"pending", AsyncWriter_get_pending, NULL, "Snapshots queued or being written", NULL},
+    {"closed", AsyncWriter_get_closed, NULL, "True after close()", NULL},
+    {"stats", AsyncWriter_get_stats, NULL,
+     "Dict with buffers, submitted, completed, failed and stalls (writes that\n"
+     "waited for a free buffer)", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyMethodDef AsyncWriter_methods[] = {
+    {"write", (PyCFunction)(void(*)(void))AsyncWriter_write, METH_VARARGS | METH_KEYWORDS,
+     "Copy the live state of a simulation and write it in the background.\n\n"
+     "The fields are injected into a pooled buffer (an OpenMP-parallel copy)\n"
+     "and the call returns; the writer thread formats and writes the file.\n"
+     "When every buffer is still queued the call waits for one to free up.\n"
+     "Failures of earlier writes are raised here, by flush() or by close().\n\n"
+     "Args:\n"
+     "    simulation (Simulation): State to snapshot\n"
+     "    filename (str): Output file\n"
+     "    format (str, optional): 'vtk', 'vtr' or 'csv' (default: 'vtk')\n"
+     "    factor (int or (int, int), optional): Keep every factor-th node (default: 1)\n"
+     "    roi (tuple, optional): Index window (i0, i1, j0, j1), ends exclusive\n"
+     "    binary (bool, optional): Legacy BINARY encoding for 'vtk' (default: False)\n"
+     "    compress (int, optional): zlib level for 'vtr' (default: 0)\n"
+     "    collection (str, optional): .pvd collection indexing 'vtr' output\n"
+     "    create_new (bool, optional): Start a new file for 'csv' (default: False)\n"
+     "    precision (int, optional): Significant digits of ASCII 'vtk' values; 0\n"
+     "        writes the shortest digits that read back exactly (default: 0)"},
+    {"flush", AsyncWriter_flush, METH_NOARGS,
+     "Wait until every submitted snapshot is written.\n\n"
+     "Raises:\n"
+     "    OSError: For the first failed write since the last flush"},
+    {"close", AsyncWriter_close, METH_NOARGS,
+     "Flush and stop the writer thread. Further calls do nothing.\n\n"
+     "Raises:\n"
+     "    RuntimeError: While another thread is inside write() or flush()"},
+    {"__enter__", AsyncWriter_enter, METH_NOARGS, NULL},
+    {"__exit__", AsyncWriter_exit, METH_VARARGS, NULL},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot AsyncWriter_slots[] = {
+    {Py_tp_doc, (void*)
+     "AsyncWriter(buffers=2)\n\n"
+     "Background snapshot writer with a pool of reusable field buffers.\n\n"
+     "write() copies a simulation's fields into a free buffer and returns while\n"
+     "a dedicated thread writes the file, so output overlaps with stepping.\n"
+     "With the default two buffers one snapshot can be written while the next\n"
+     "is taken. Use as a context manager or call close() to finish."},
+    {Py_tp_new, (void*)AsyncWriter_new},
+    {Py_tp_dealloc, (void*)AsyncWriter_dealloc},
+    {Py_tp_getset, AsyncWriter_getset},
+    {Py_tp_methods, AsyncWriter_methods},
+    {0, NULL}
+};
+
+static PyType_Spec AsyncWriter_spec = {
+    "cfd_python.AsyncWriter",
+    sizeof(AsyncWriterObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    AsyncWriter_slots
+};
+
+/*
+ * Reset library state in a forked child process
+ *
+ * The default path runs from os.register_at_fork in every child, so it only
+ * clears per-process state that is safe to reset under live Simulations.
+ * reset_library=True additionally tears the CFD library down and back up,
+ * which invalidates every Simulation inherited from the parent.
+ */
+static PyObject* reinit_after_fork_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static const char* const kwlist[] = {"num_threads", "reset_library", NULL};
+    int num_threads = 0;
+    int reset_library = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|ip", (char**)kwlist, &num_threads,
+                                     &reset_library)) {
+        return NULL;
+    }
+    if (num_threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "num_threads must be non-negative");
+        return NULL;
+    }
+
+    if (reset_library) {
+        ns_solver_registry_t* registry = cfd_registry_create();
+        if (registry == NULL) {
+            PyErr_SetString(PyExc_RuntimeError, "Failed to create solver registry");
+            return NULL;
+        }
+        cfd_registry_register_defaults(registry);
+        // The inherited registry is leaked on purpose: solvers created from
+        // it by inherited objects may still refer to it, and it is small
+        g_registry = registry;
+
+        // Re-run library initialization so global state (e.g. GPU contexts) is not shared
+        if (cfd_is_initialized()) {
+            cfd_finalize();
+            cfd_status_t status = cfd_init();
+            if (status != CFD_SUCCESS) {
+                return raise_cfd_error(status, "cfd_init");
+            }
+        }
+    }
+    cfd_clear_error();
+
+#ifdef _OPENMP
+    // Children of a process pool should not each claim every core. This only
+    // sizes later parallel regions; the OpenMP runtime itself is inherited.
+    if (num_threads > 0) {
+        omp_set_num_threads(num_threads);
+    }
+#endif
+
+    Py_RETURN_NONE;
+}
+
+// ============================================================================
+// Ensemble Runs
+// ============================================================================
+
+typedef struct {
+    ensemble_outcome outcome;
+    cfd_status_t status;
+    size_t steps;
+    field_sample sample;
+} ensemble_result;
+
+/*
+ * Advance one member in check_interval chunks until it completes or a
+ * stopping predicate fires. Runs without the GIL.
+ */
+static void ensemble_run_member(SimulationObject* member, size_t steps,
+                                const ensemble_policy* policy, ensemble_result* result) {
+    flow_field* field = member->sim->field;
+    size_t count = member->nx * member->ny;
+    size_t start = member->step_count;
+    double* prev = NULL;
+    int with_divergence = policy->max_divergence > 0.0;
+
+    memset(result, 0, sizeof(*result));
+    result->outcome = ENSEMBLE_RUNNING;
+    if (ensemble_policy_needs_history(policy)) {
+        prev = (double*)malloc(2 * count * sizeof(double));
+        if (prev == NULL) {
+            result->outcome = ENSEMBLE_FAILED;
+            result->status = CFD_ERROR_NOMEM;
+            return;
+        }
+        memcpy(prev, field->u, count * sizeof(double));
+        memcpy(prev + count, field->v, count * sizeof(double));
+    }
+
+    size_t remaining = steps;
+    while (remaining > 0 && result->outcome == ENSEMBLE_RUNNING) {
+        size_t chunk = remaining < policy->check_interval ? remaining : policy->check_interval;
+        size_t done = 0;
+        cfd_status_t status = simulation_advance(member, chunk, &done);
+        member->last_status = status;
+        if (status == CFD_ERROR_DIVERGED) {
+            result->outcome = ENSEMBLE_DIVERGED;
+            result->status = status;
+            break;
+        }
+        if (status != CFD_SUCCESS) {
+            result->outcome = ENSEMBLE_FAILED;
+            result->status = status;
+            break;
+        }
+        remaining -= chunk;
+        flow_field_sample(field, member->sim->grid, prev, prev ? prev + count : NULL,
+                          chunk, with_divergence, &result->sample);
+        result->outcome = ensemble_policy_check(policy, &result->sample);
+    }
+
+    if (result->outcome == ENSEMBLE_RUNNING) {
+        result->outcome = ENSEMBLE_COMPLETED;
+    }
+    result->steps = member->step_count > start ? member->step_count - start : 0;
+    free(prev);
+}
+
+static PyObject* ensemble_result_to_dict(const SimulationObject* member,
+                                         const ensemble_result* result) {
+    return Py_BuildValue("{s:s,s:n,s:n,s:d,s:d,s:d,s:d,s:d,s:i}",
+                         "status", ensemble_outcome_name(result->outcome),
+                         "steps", (Py_ssize_t)result->steps,
+                         "step_count", (Py_ssize_t)member->step_count,
+                         "time", member->time,
+                         "max_velocity", result->sample.max_speed,
+                         "max_pressure", result->sample.max_pressure,
+                         "residual", result->sample.residual,
+                         "max_divergence", result->sample.max_divergence,
+                         "error_code", (int)result->status);
+}
+
+/*
+ * Advance several Simulation objects in parallel with early-exit predicates
+ */
+static PyObject* run_ensemble_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static const char* const kwlist[] = {"simulations", "steps", "check_every", "max_velocity",
+                                         "max_pressure", "max_residual", "max_divergence",
+                                         "converge_tol", "num_threads", NULL};
+    PyObject* sims_obj;
+    Py_ssize_t steps;
+    Py_ssize_t check_every = 10;
+    ensemble_policy policy = {0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    int num_threads = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "On|ndddddi", (char**)kwlist,
+                                     &sims_obj, &steps, &check_every,
+                                     &policy.max_velocity, &policy.max_pressure,
+                                     &policy.max_residual, &policy.max_divergence,
+                                     &policy.converge_tol, &num_threads)) {
+        return NULL;
+    }
+    if (steps < 0) {
+        PyErr_SetString(PyExc_ValueError, "steps must be non-negative");
+        return NULL;
+    }
+    if (check_every < 1) {
+        PyErr_SetString(PyExc_ValueError, "check_every must be at least 1");
+        return NULL;
+    }
+    if (num_threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "num_threads must be non-negative");
+        return NULL;
+    }
+    policy.check_interval = (size_t)check_every;
+
+    PyObject* seq = PySequence_List(sims_obj);
+    if (seq == NULL) {
+        return NULL;
+    }
+    Py_ssize_t count = PyList_Size(seq);
+    SimulationObject** members = (SimulationObject**)calloc(count > 0 ? (size_t)count : 1,
+                                                            sizeof(SimulationObject*));
+    ensemble_result* results = (ensemble_result*)calloc(count > 0 ? (size_t)count : 1,
+                                                        sizeof(ensemble_result));
+    if (members == NULL || results == NULL) {
+        free(members);
+        free(results);
+        Py_DECREF(seq);
+        return PyErr_NoMemory();
+    }
+
+    // Mark members busy as they are collected so duplicates are rejected
+    Py_ssize_t claimed = 0;
+    for (; claimed < count; claimed++) {
+        PyObject* item = PyList_GetItem(seq, claimed);
+        if (!PyObject_TypeCheck(item, (PyTypeObject*)g_simulation_type)) {
+            PyErr_Format(PyExc_TypeError, "simulations[%zd] is not a Simulation", claimed);
+            break;
+        }
+        SimulationObject* member = (SimulationObject*)item;
+        if (member->busy) {
+            PyErr_Format(PyExc_ValueError,
+                         "simulations[%zd] is listed twice or running in another thread", claimed);
+            break;
+        }
+        member->busy = 1;
+        members[claimed] = member;
+    }
+
+    PyObject* out = NULL;
+    if (claimed == count) {
+        int threads = num_threads;
+        Py_BEGIN_ALLOW_THREADS
+#ifdef _OPENMP
+        if (threads == 0) {
+            threads = omp_get_max_threads();
+        }
+#endif
+        (void)threads;
+        // Dynamic scheduling hands the next member to whichever thread frees
+        // up first, so cores of members stopped early are reused at once
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+        for (ptrdiff_t i = 0; i < (ptrdiff_t)count; i++) {
+            ensemble_run_member(members[i], (size_t)steps, &policy, &results[i]);
+        }
+        Py_END_ALLOW_THREADS
+        cfd_clear_error();
+
+        out = PyList_New(count);
+        for (Py_ssize_t i = 0; out != NULL && i < count; i++) {
+            PyObject* item = ensemble_result_to_dict(members[i], &results[i]);
+            if (item == NULL) {
+                Py_CLEAR(out);
+                break;
+            }
+            PyList_SetItem(out, i, item);
+        }
+    }
+
+    for (Py_ssize_t i = 0; i < claimed; i++) {
+        members[i]->busy = 0;
+    }
+    free(members);
+    free(results);
+    Py_DECREF(seq);
+    return out;
+}
+
+/*
+ * List available solvers
+ */
+static PyObject* list_solvers(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+
+    if (g_registry == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "Solver registry not initialized");
+        return NULL;
+    }
+
+    const char* names[32];
+    int count = cfd_registry_list(g_registry, names, 32);
+
+    PyObject* solver_list = PyList_New(0);
+    if (solver_list == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        PyObject* name = PyUnicode_FromString(names[i]);
+        if (name == NULL || PyList_Append(solver_list, name) < 0) {
+            Py_XDECREF(name);
+            Py_DECREF(solver_list);
+            return NULL;
+        }
+        Py_DECREF(name);
+    }
+
+    return solver_list;
+}
+
+/*
+ * Check if a solver type is available
+ */
+static PyObject* has_solver(PyObject* self, PyObject* args) {
+    (void)self;
+    const char* solver_type;
+
+    if (!PyArg_ParseTuple(args, "s", &solver_type)) {
+        return NULL;
+    }
+
+    if (g_registry == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "Solver registry not initialized");
+        return NULL;
+    }
+
+    int available = cfd_registry_has(g_registry, solver_type);
+    return PyBool_FromLong(available);
+}
+
+/*
+ * Get solver information
+ */
+static PyObject* get_solver_info(PyObject* self, PyObject* args) {
+    (void)self;
+    const char* solver_type;
+
+    if (!PyArg_ParseTuple(args, "s", &solver_type)) {
+        return NULL;
+    }
+
+    if (g_registry == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "Solver registry not initialized");
+        return NULL;
+    }
+
+    // Create a temporary solver to get its info
+    ns_solver_t* solver = cfd_solver_create(g_registry, solver_type);
+    if (solver == NULL) {
+        PyErr_Format(PyExc_ValueError, "Unknown solver type: %s", solver_type);
+        return NULL;
+    }
+
+    PyObject* info = PyDict_New();
+    if (info == NULL) {
+        solver_destroy(solver);
+        return NULL;
+    }
+
+    // Helper macro to add string to dict with proper refcount
+    #define ADD_STRING_TO_DICT(dict, key, value) do { \
+        PyObject* tmp = PyUnicode_FromString(value); \
+        if (tmp == NULL) { Py_DECREF(dict); solver_destroy(solver); return NULL; } \
+        PyDict_SetItemString(dict, key, tmp); \
+        Py_DECREF(tmp); \
+    } while(0)
+
+    ADD_STRING_TO_DICT(info, "name", solver->name);
+    ADD_STRING_TO_DICT(info, "description", solver->description);
+    ADD_STRING_TO_DICT(info, "version", solver->version);
+
+    #undef ADD_STRING_TO_DICT
+
+    // Build capabilities list
+    PyObject* caps = PyList_New(0);
+    if (caps == NULL) {
+        Py_DECREF(info);
+        solver_destroy(solver);
+        return NULL;
+    }
+
+    // Helper macro to append capability string
+    #define APPEND_CAP(list, cap_flag, cap_name) do { \
+        if (solver->capabilities & cap_flag) { \
+            PyObject* s = PyUnicode_FromString(cap_name); \
+            if (s == NULL || PyList_Append(list, s) < 0) { \
+                Py_XDECREF(s); Py_DECREF(list); Py_DECREF(info); \
+                solver_destroy(solver); return NULL; \
+            } \
+            Py_DECREF(s); \
+        } \
+    } while(0)
+
+    APPEND_CAP(caps, NS_SOLVER_CAP_INCOMPRESSIBLE, "incompressible");
+    APPEND_CAP(caps, NS_SOLVER_CAP_COMPRESSIBLE, "compressible");
+    APPEND_CAP(caps, NS_SOLVER_CAP_STEADY_STATE, "steady_state");
+    APPEND_CAP(caps, NS_SOLVER_CAP_TRANSIENT, "transient");
+    APPEND_CAP(caps, NS_SOLVER_CAP_SIMD, "simd");
+    APPEND_CAP(caps, NS_SOLVER_CAP_PARALLEL, "parallel");
+    APPEND_CAP(caps, NS_SOLVER_CAP_GPU, "gpu");
+
+    #undef APPEND_CAP
+
+    PyDict_SetItemString(info, "capabilities", caps);
+    Py_DECREF(caps);
+
+    solver_destroy(solver);
+    return info;
+}
+
+/*
+ * Simple high-level run_simulation function
+ */
+static PyObject* run_simulation(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static char* kwlist[] = {"nx", "ny", "steps", "xmin", "xmax", "ymin", "ymax",
+                             "solver_type", "output_file", "binary", "outputs", NULL};
+    size_t nx, ny, steps = 100;
+    double xmin = 0.0, xmax = 1.0, ymin = 0.0, ymax = 1.0;
+    const char* solver_type = NULL;
+    const char* output_file = NULL;
+    int binary = 0;
+    PyObject* outputs_obj = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "nn|nddddsspO", kwlist,
+                                     &nx, &ny, &steps, &xmin, &xmax, &ymin, &ymax,
+                                     &solver_type, &output_file, &binary, &outputs_obj)) {
+        return NULL;
+    }
+
+    output_schedule schedule;
+    if (parse_output_list(outputs_obj, &schedule) < 0) {
+        return NULL;
+    }
+
+    simulation_data* sim_data;
+    if (solver_type) {
+        sim_data = init_simulation_with_solver(nx, ny, 1, xmin, xmax, ymin, ymax, 0.0, 0.0, solver_type);
+    } else {
+        sim_data = init_simulation(nx, ny, 1, xmin, xmax, ymin, ymax, 0.0, 0.0);
+    }
+
+    if (sim_data == NULL) {
+        output_schedule_free(&schedule);
+        if (solver_type) {
+            PyErr_Format(PyExc_RuntimeError, "Failed to initialize simulation with solver '%s'", solver_type);
+        } else {
+            PyErr_SetString(PyExc_RuntimeError, "Failed to initialize simulation");
+        }
+        return NULL;
+    }
+
+    // Run simulation steps
+    // Stop on divergence instead of stepping on NaN fields; other statuses
+    // are left to the solver as before
+    for (size_t i = 0; i < steps; i++) {
+        if (run_simulation_step(sim_data) == CFD_ERROR_DIVERGED) {
+            char context[96];
+            snprintf(context, sizeof(context), "Simulation diverged at step %zu", i + 1);
+            output_schedule_free(&schedule);
+            free_simulation(sim_data);
+            return raise_cfd_status(CFD_ERROR_DIVERGED, context);
+        }
+        if (run_scheduled_outputs(&schedule, sim_data, i + 1) < 0) {
+            output_schedule_free(&schedule);
+            free_simulation(sim_data);
+            return NULL;
+        }
+    }
+    output_schedule_free(&schedule);
+
+    // Write output if requested
+    if (output_file &&
+        write_flow_vtk(output_file, sim_data->field,
+                       sim_data->grid->nx, sim_data->grid->ny, sim_data->grid->nz,
+                       sim_data->grid->xmin, sim_data->grid->xmax,
+                       sim_data->grid->ymin, sim_data->grid->ymax,
+                       sim_data->grid->zmin, sim_data->grid->zmax, binary, 0) < 0) {
+        free_simulation(sim_data);
+        return NULL;
+    }
+
+    // Compute velocity magnitude using derived_fields
+    flow_field* field = sim_data->field;
+    derived_fields* derived = derived_fields_create(field->nx, field->ny, field->nz);
+    if (derived == NULL) {
+        free_simulation(sim_data);
+        PyErr_SetString(PyExc_MemoryError, "Failed to create derived fields");
+        return NULL;
+    }
+
+    derived_fields_compute_velocity_magnitude(derived, field);
+
+    PyObject* result = PyList_New(0);
+    if (result == NULL) {
+        derived_fields_destroy(derived);
+        free_simulation(sim_data);
+        return NULL;
+    }
+
+    if (derived->velocity_magnitude != NULL) {
+        size_t size = field->nx * field->ny;
+        for (size_t i = 0; i < size; i++) {
+            PyObject* val = PyFloat_FromDouble(derived->velocity_magnitude[i]);
+            if (val == NULL || PyList_Append(result, val) < 0) {
+                Py_XDECREF(val);
+                Py_DECREF(result);
+                derived_fields_destroy(derived);
+                free_simulation(sim_data);
+                return NULL;
+            }
+            Py_DECREF(val);
+        }
+    }
+
+    derived_fields_destroy(derived);
+    free_simulation(sim_data);
+    return result;
+}
+
+/*
+ * Create a simple grid function
+ */
+static PyObject* create_grid(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static const char* const kwlist[] = {"nx", "ny", "xmin", "xmax", "ymin", "ymax",
+                                         "nz", "zmin", "zmax", NULL};
+    Py_ssize_t nx_signed, ny_signed;
+    Py_ssize_t nz_signed = 1;
+    double xmin, xmax, ymin, ymax;
+    double zmin = 0.0, zmax = 0.0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "nndddd|ndd", (char**)kwlist,
+                                     &nx_signed, &ny_signed, &xmin, &xmax, &ymin, &ymax,
+                                     &nz_signed, &zmin, &zmax)) {
+        return NULL;
+    }
+
+    // Validate dimensions before calling C library
+    if (nx_signed < 2) {
+        PyErr_SetString(PyExc_ValueError, "nx must be at least 2");
+        return NULL;
+    }
+    if (ny_signed < 2) {
+        PyErr_SetString(PyExc_ValueError, "ny must be at least 2");
+        return NULL;
+    }
+    if (nz_signed < 1) {
+        PyErr_SetString(PyExc_ValueError, "nz must be at least 1");
+        return NULL;
+    }
+    if (xmax <= xmin) {
+        PyErr_SetString(PyExc_ValueError, "xmax must be greater than xmin");
+        return NULL;
+    }
+    if (ymax <= ymin) {
+        PyErr_SetString(PyExc_ValueError, "ymax must be greater than ymin");
+        return NULL;
+    }
+    if (nz_signed > 1 && zmax <= zmin) {
+        PyErr_SetString(PyExc_ValueError, "zmax must be greater than zmin when nz > 1");
+        return NULL;
+    }
+
+    size_t nx = (size_t)nx_signed;
+    size_t ny = (size_t)ny_signed;
+    size_t nz = (size_t)nz_signed;
+
+    grid* g = grid_create(nx, ny, nz, xmin, xmax, ymin, ymax, zmin, zmax);
+    if (g == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to create grid");
         return NULL;
     }
 
@@ -326,29 +4117,1061 @@ static PyObject* create_grid(PyObject* self, PyObject* args, PyObject* kwds) {
         return NULL;
     }
 
-    // Helper macro to add values to dict with proper refcount
-    #define ADD_TO_DICT(dict, key, py_val) do { \
+    // Helper macro to add values to dict with proper refcount
+    #define ADD_TO_DICT(dict, key, py_val) do { \
+        PyObject* tmp = (py_val); \
+        if (tmp == NULL) { Py_DECREF(dict); grid_destroy(g); return NULL; } \
+        PyDict_SetItemString(dict, key, tmp); \
+        Py_DECREF(tmp); \
+    } while(0)
+
+    ADD_TO_DICT(grid_dict, "nx", PyLong_FromSize_t(g->nx));
+    ADD_TO_DICT(grid_dict, "ny", PyLong_FromSize_t(g->ny));
+    ADD_TO_DICT(grid_dict, "nz", PyLong_FromSize_t(g->nz));
+    ADD_TO_DICT(grid_dict, "xmin", PyFloat_FromDouble(g->xmin));
+    ADD_TO_DICT(grid_dict, "xmax", PyFloat_FromDouble(g->xmax));
+    ADD_TO_DICT(grid_dict, "ymin", PyFloat_FromDouble(g->ymin));
+    ADD_TO_DICT(grid_dict, "ymax", PyFloat_FromDouble(g->ymax));
+    ADD_TO_DICT(grid_dict, "zmin", PyFloat_FromDouble(g->zmin));
+    ADD_TO_DICT(grid_dict, "zmax", PyFloat_FromDouble(g->zmax));
+
+    #undef ADD_TO_DICT
+
+    // Create coordinate lists
+    PyObject* x_list = PyList_New(0);
+    PyObject* y_list = PyList_New(0);
+    if (x_list == NULL || y_list == NULL) {
+        Py_XDECREF(x_list);
+        Py_XDECREF(y_list);
+        Py_DECREF(grid_dict);
+        grid_destroy(g);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < g->nx; i++) {
+        PyObject* val = PyFloat_FromDouble(g->x[i]);
+        if (val == NULL || PyList_Append(x_list, val) < 0) {
+            Py_XDECREF(val);
+            Py_DECREF(x_list);
+            Py_DECREF(y_list);
+            Py_DECREF(grid_dict);
+            grid_destroy(g);
+            return NULL;
+        }
+        Py_DECREF(val);
+    }
+
+    for (size_t i = 0; i < g->ny; i++) {
+        PyObject* val = PyFloat_FromDouble(g->y[i]);
+        if (val == NULL || PyList_Append(y_list, val) < 0) {
+            Py_XDECREF(val);
+            Py_DECREF(x_list);
+            Py_DECREF(y_list);
+            Py_DECREF(grid_dict);
+            grid_destroy(g);
+            return NULL;
+        }
+        Py_DECREF(val);
+    }
+
+    PyDict_SetItemString(grid_dict, "x_coords", x_list);
+    PyDict_SetItemString(grid_dict, "y_coords", y_list);
+    Py_DECREF(x_list);
+    Py_DECREF(y_list);
+
+    // Add z coordinates when 3D
+    if (g->nz > 1 && g->z != NULL) {
+        PyObject* z_list = PyList_New(0);
+        if (z_list == NULL) {
+            Py_DECREF(grid_dict);
+            grid_destroy(g);
+            return NULL;
+        }
+        for (size_t i = 0; i < g->nz; i++) {
+            PyObject* val = PyFloat_FromDouble(g->z[i]);
+            if (val == NULL || PyList_Append(z_list, val) < 0) {
+                Py_XDECREF(val);
+                Py_DECREF(z_list);
+                Py_DECREF(grid_dict);
+                grid_destroy(g);
+                return NULL;
+            }
+            Py_DECREF(val);
+        }
+        PyDict_SetItemString(grid_dict, "z_coords", z_list);
+        Py_DECREF(z_list);
+    }
+
+    grid_destroy(g);
+    return grid_dict;
+}
+
+/*
+ * Get default solver parameters
+ */
+static PyObject* get_default_solver_params(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+    ns_solver_params_t params = ns_solver_params_default();
+
+    PyObject* params_dict = PyDict_New();
+    if (params_dict == NULL) {
+        return NULL;
+    }
+
+    // Helper macro to add values to dict with proper refcount
+    #define ADD_TO_DICT(dict, key, py_val) do { \
+        PyObject* tmp = (py_val); \
+        if (tmp == NULL) { Py_DECREF(dict); return NULL; } \
+        PyDict_SetItemString(dict, key, tmp); \
+        Py_DECREF(tmp); \
+    } while(0)
+
+    ADD_TO_DICT(params_dict, "dt", PyFloat_FromDouble(params.dt));
+    ADD_TO_DICT(params_dict, "cfl", PyFloat_FromDouble(params.cfl));
+    ADD_TO_DICT(params_dict, "gamma", PyFloat_FromDouble(params.gamma));
+    ADD_TO_DICT(params_dict, "mu", PyFloat_FromDouble(params.mu));
+    ADD_TO_DICT(params_dict, "k", PyFloat_FromDouble(params.k));
+    ADD_TO_DICT(params_dict, "max_iter", PyLong_FromLong(params.max_iter));
+    ADD_TO_DICT(params_dict, "tolerance", PyFloat_FromDouble(params.tolerance));
+
+    #undef ADD_TO_DICT
+
+    return params_dict;
+}
+
+/*
+ * Run simulation with detailed parameters and solver selection
+ */
+static PyObject* run_simulation_with_params(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static char* kwlist[] = {"nx", "ny", "xmin", "xmax", "ymin", "ymax",
+                             "steps", "dt", "cfl", "solver_type", "output_file",
+                             "shm_name", "snapshot", "binary", "outputs", NULL};
+    size_t nx, ny, steps = 1;
+    double xmin, xmax, ymin, ymax;
+    double dt = 0.001, cfl = 0.2;
+    const char* solver_type = NULL;
+    const char* output_file = NULL;
+    const char* shm_name = NULL;
+    int want_snapshot = 0;
+    int binary = 0;
+    PyObject* outputs_obj = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "nndddd|nddzzzppO", kwlist,
+                                     &nx, &ny, &xmin, &xmax, &ymin, &ymax,
+                                     &steps, &dt, &cfl, &solver_type, &output_file,
+                                     &shm_name, &want_snapshot, &binary, &outputs_obj)) {
+        return NULL;
+    }
+
+    output_schedule schedule;
+    if (parse_output_list(outputs_obj, &schedule) < 0) {
+        return NULL;
+    }
+
+    simulation_data* sim_data;
+    if (solver_type) {
+        sim_data = init_simulation_with_solver(nx, ny, 1, xmin, xmax, ymin, ymax, 0.0, 0.0, solver_type);
+    } else {
+        sim_data = init_simulation(nx, ny, 1, xmin, xmax, ymin, ymax, 0.0, 0.0);
+    }
+
+    if (sim_data == NULL) {
+        output_schedule_free(&schedule);
+        if (solver_type) {
+            PyErr_Format(PyExc_RuntimeError, "Failed to initialize simulation with solver '%s'", solver_type);
+        } else {
+            PyErr_SetString(PyExc_RuntimeError, "Failed to initialize simulation");
+        }
+        return NULL;
+    }
+
+    // Modify solver parameters
+    sim_data->params.dt = dt;
+    sim_data->params.cfl = cfl;
+
+    // Run simulation steps
+    // Stop on divergence instead of stepping on NaN fields; other statuses
+    // are left to the solver as before
+    for (size_t i = 0; i < steps; i++) {
+        if (run_simulation_step(sim_data) == CFD_ERROR_DIVERGED) {
+            char context[96];
+            snprintf(context, sizeof(context), "Simulation diverged at step %zu", i + 1);
+            output_schedule_free(&schedule);
+            free_simulation(sim_data);
+            return raise_cfd_status(CFD_ERROR_DIVERGED, context);
+        }
+        if (run_scheduled_outputs(&schedule, sim_data, i + 1) < 0) {
+            output_schedule_free(&schedule);
+            free_simulation(sim_data);
+            return NULL;
+        }
+    }
+    output_schedule_free(&schedule);
+
+    // Create results dictionary
+    PyObject* results = PyDict_New();
+    if (results == NULL) {
+        free_simulation(sim_data);
+        return NULL;
+    }
+
+    // Compute velocity magnitude using derived_fields
+    flow_field* field = sim_data->field;
+    if (shm_name) {
+        // Fields go straight into shared memory; only a descriptor is returned
+        PyObject* descriptor = write_results_to_shm(shm_name, field);
+        if (descriptor == NULL) {
+            Py_DECREF(results);
+            free_simulation(sim_data);
+            return NULL;
+        }
+        PyDict_SetItemString(results, "shm", descriptor);
+        Py_DECREF(descriptor);
+    }
+    if (want_snapshot) {
+        // Native snapshot instead of a list; pickles out-of-band with protocol 5
+        PyObject* snapshot = field_snapshot_from_arrays(field->nx, field->ny, (double)steps * dt,
+                                                        steps, field->u, field->v, field->p);
+        if (snapshot == NULL) {
+            Py_DECREF(results);
+            free_simulation(sim_data);
+            return NULL;
+        }
+        PyDict_SetItemString(results, "snapshot", snapshot);
+        Py_DECREF(snapshot);
+
+        PyObject* grid_obj = grid_object_from_grid(sim_data->grid);
+        if (grid_obj == NULL) {
+            Py_DECREF(results);
+            free_simulation(sim_data);
+            return NULL;
+        }
+        PyDict_SetItemString(results, "grid", grid_obj);
+        Py_DECREF(grid_obj);
+    }
+    derived_fields* derived = (shm_name || want_snapshot)
+                                  ? NULL
+                                  : derived_fields_create(field->nx, field->ny, field->nz);
+    if (derived != NULL) {
+        derived_fields_compute_velocity_magnitude(derived, field);
+
+        if (derived->velocity_magnitude != NULL) {
+            size_t size = field->nx * field->ny;
+            PyObject* vel_list = PyList_New(0);
+            if (vel_list == NULL) {
+                derived_fields_destroy(derived);
+                Py_DECREF(results);
+                free_simulation(sim_data);
+                return NULL;
+            }
+            for (size_t i = 0; i < size; i++) {
+                PyObject* val = PyFloat_FromDouble(derived->velocity_magnitude[i]);
+                if (val == NULL || PyList_Append(vel_list, val) < 0) {
+                    Py_XDECREF(val);
+                    Py_DECREF(vel_list);
+                    derived_fields_destroy(derived);
+                    Py_DECREF(results);
+                    free_simulation(sim_data);
+                    return NULL;
+                }
+                Py_DECREF(val);
+            }
+            PyDict_SetItemString(results, "velocity_magnitude", vel_list);
+            Py_DECREF(vel_list);
+        }
+        derived_fields_destroy(derived);
+    }
+
+    // Helper macro to add values to dict with proper refcount
+    #define ADD_TO_DICT(dict, key, py_val) do { \
+        PyObject* tmp = (py_val); \
+        if (tmp == NULL) { Py_DECREF(dict); free_simulation(sim_data); return NULL; } \
+        PyDict_SetItemString(dict, key, tmp); \
+        Py_DECREF(tmp); \
+    } while(0)
+
+    // Add simulation info
+    ADD_TO_DICT(results, "nx", PyLong_FromSize_t(nx));
+    ADD_TO_DICT(results, "ny", PyLong_FromSize_t(ny));
+    ADD_TO_DICT(results, "steps", PyLong_FromSize_t(steps));
+
+    // Add solver info
+    ns_solver_t* solver = simulation_get_solver(sim_data);
+    if (solver) {
+        ADD_TO_DICT(results, "solver_name", PyUnicode_FromString(solver->name));
+        ADD_TO_DICT(results, "solver_description", PyUnicode_FromString(solver->description));
+    }
+
+    // Add solver statistics
+    const ns_solver_stats_t* stats = simulation_get_stats(sim_data);
+    if (stats) {
+        PyObject* stats_dict = PyDict_New();
+        if (stats_dict == NULL) {
+            Py_DECREF(results);
+            free_simulation(sim_data);
+            return NULL;
+        }
+
+        // Use a local macro for stats_dict
+        #define ADD_TO_STATS(key, py_val) do { \
+            PyObject* tmp = (py_val); \
+            if (tmp == NULL) { Py_DECREF(stats_dict); Py_DECREF(results); free_simulation(sim_data); return NULL; } \
+            PyDict_SetItemString(stats_dict, key, tmp); \
+            Py_DECREF(tmp); \
+        } while(0)
+
+        ADD_TO_STATS("iterations", PyLong_FromLong(stats->iterations));
+        ADD_TO_STATS("max_velocity", PyFloat_FromDouble(stats->max_velocity));
+        ADD_TO_STATS("max_pressure", PyFloat_FromDouble(stats->max_pressure));
+        ADD_TO_STATS("elapsed_time_ms", PyFloat_FromDouble(stats->elapsed_time_ms));
+
+        #undef ADD_TO_STATS
+
+        PyDict_SetItemString(results, "stats", stats_dict);
+        Py_DECREF(stats_dict);
+    }
+
+    #undef ADD_TO_DICT
+
+    // Write output if requested
+    if (output_file) {
+        if (write_flow_vtk(output_file, sim_data->field,
+                           sim_data->grid->nx, sim_data->grid->ny, sim_data->grid->nz,
+                           sim_data->grid->xmin, sim_data->grid->xmax,
+                           sim_data->grid->ymin, sim_data->grid->ymax,
+                           sim_data->grid->zmin, sim_data->grid->zmax, binary, 0) < 0) {
+            // Nobody will learn the segment name, so do not leave it behind
+            if (shm_name != NULL) {
+                cfd_shm_unlink(shm_name);
+            }
+            Py_DECREF(results);
+            free_simulation(sim_data);
+            return NULL;
+        }
+        PyObject* output_str = PyUnicode_FromString(output_file);
+        if (output_str != NULL) {
+            PyDict_SetItemString(results, "output_file", output_str);
+            Py_DECREF(output_str);
+        }
+    }
+
+    free_simulation(sim_data);
+    return results;
+}
+
+/*
+ * Set the output directory for simulation outputs
+ */
+static PyObject* set_output_dir(PyObject* self, PyObject* args) {
+    (void)self;
+    const char* output_dir;
+
+    if (!PyArg_ParseTuple(args, "s", &output_dir)) {
+        return NULL;
+    }
+
+    // Note: This function now requires a simulation_data context
+    // For now, we'll warn that this is a no-op without a simulation context
+    PyErr_WarnEx(PyExc_DeprecationWarning,
+                 "set_output_dir() without simulation context is deprecated. "
+                 "Use simulation_data.output_base_dir instead.", 1);
+    Py_RETURN_NONE;
+}
+
+/*
+ * Write VTK scalar output
+ */
+static PyObject* write_vtk_scalar(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static const char* const kwlist[] = {"filename", "field_name", "data", "nx", "ny",
+                                         "xmin", "xmax", "ymin", "ymax",
+                                         "nz", "zmin", "zmax", "binary", "precision", NULL};
+    const char* filename;
+    const char* field_name;
+    PyObject* data_list;
+    size_t nx, ny;
+    size_t nz = 1;
+    double xmin, xmax, ymin, ymax;
+    double zmin = 0.0, zmax = 0.0;
+    int binary = 0;
+    int precision = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "ssOnndddd|nddpi", (char**)kwlist,
+                                     &filename, &field_name, &data_list,
+                                     &nx, &ny, &xmin, &xmax, &ymin, &ymax,
+                                     &nz, &zmin, &zmax, &binary, &precision)) {
+        return NULL;
+    }
+    if (check_precision(precision) < 0) {
+        return NULL;
+    }
+
+    // Convert Python list to C array
+    if (!PyList_Check(data_list)) {
+        PyErr_SetString(PyExc_TypeError, "data must be a list");
+        return NULL;
+    }
+
+    size_t size = nx * ny * nz;
+    if ((size_t)PyList_Size(data_list) != size) {
+        PyErr_Format(PyExc_ValueError, "data list size (%zd) must match nx*ny*nz (%zu)",
+                     PyList_Size(data_list), size);
+        return NULL;
+    }
+
+    double* data = (double*)malloc(size * sizeof(double));
+    if (data == NULL) {
+        PyErr_SetString(PyExc_MemoryError, "Failed to allocate data array");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        PyObject* item = PyList_GetItem(data_list, i);
+        if (item == NULL) {
+            free(data);
+            return NULL;
+        }
+        data[i] = PyFloat_AsDouble(item);
+        if (PyErr_Occurred()) {
+            free(data);
+            return NULL;
+        }
+    }
+
+    vtk_geometry geom;
+    vtk_geometry_from_bounds(&geom, nx, ny, nz, xmin, xmax, ymin, ymax, zmin, zmax);
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    if (binary) {
+        rc = vtk_binary_write_scalar(filename, field_name, data, &geom);
+    } else {
+        rc = vtk_ascii_write_scalar(filename, field_name, data, &geom, precision);
+    }
+    Py_END_ALLOW_THREADS
+    free(data);
+    if (rc < 0) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
+    }
+
+    Py_RETURN_NONE;
+}
+
+/*
+ * Write VTK vector output
+ */
+static PyObject* write_vtk_vector(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static const char* const kwlist[] = {"filename", "field_name", "u_data", "v_data", "nx", "ny",
+                                         "xmin", "xmax", "ymin", "ymax",
+                                         "w_data", "nz", "zmin", "zmax", "binary", "precision",
+                                         NULL};
+    const char* filename;
+    const char* field_name;
+    PyObject* u_list;
+    PyObject* v_list;
+    PyObject* w_list = NULL;
+    size_t nx, ny;
+    size_t nz = 1;
+    double xmin, xmax, ymin, ymax;
+    double zmin = 0.0, zmax = 0.0;
+    int binary = 0;
+    int precision = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "ssOOnndddd|Onddpi", (char**)kwlist,
+                                     &filename, &field_name, &u_list, &v_list,
+                                     &nx, &ny, &xmin, &xmax, &ymin, &ymax,
+                                     &w_list, &nz, &zmin, &zmax, &binary, &precision)) {
+        return NULL;
+    }
+    if (check_precision(precision) < 0) {
+        return NULL;
+    }
+
+    // Validate lists
+    if (!PyList_Check(u_list) || !PyList_Check(v_list)) {
+        PyErr_SetString(PyExc_TypeError, "u_data and v_data must be lists");
+        return NULL;
+    }
+
+    // Treat None as no w_data
+    if (w_list == Py_None) {
+        w_list = NULL;
+    }
+
+    if (w_list != NULL && !PyList_Check(w_list)) {
+        PyErr_SetString(PyExc_TypeError, "w_data must be a list or None");
+        return NULL;
+    }
+
+    size_t size = nx * ny * nz;
+    if ((size_t)PyList_Size(u_list) != size || (size_t)PyList_Size(v_list) != size) {
+        PyErr_SetString(PyExc_ValueError, "data list sizes must match nx*ny*nz");
+        return NULL;
+    }
+
+    if (w_list != NULL && (size_t)PyList_Size(w_list) != size) {
+        PyErr_SetString(PyExc_ValueError, "w_data size must match nx*ny*nz");
+        return NULL;
+    }
+
+    double* u_data = (double*)malloc(size * sizeof(double));
+    double* v_data = (double*)malloc(size * sizeof(double));
+    double* w_data = NULL;
+    if (w_list != NULL) {
+        w_data = (double*)malloc(size * sizeof(double));
+    }
+
+    if (u_data == NULL || v_data == NULL || (w_list != NULL && w_data == NULL)) {
+        free(u_data);
+        free(v_data);
+        free(w_data);
+        PyErr_SetString(PyExc_MemoryError, "Failed to allocate data arrays");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        PyObject* u_item = PyList_GetItem(u_list, i);
+        PyObject* v_item = PyList_GetItem(v_list, i);
+        if (u_item == NULL || v_item == NULL) {
+            free(u_data);
+            free(v_data);
+            free(w_data);
+            return NULL;
+        }
+        u_data[i] = PyFloat_AsDouble(u_item);
+        v_data[i] = PyFloat_AsDouble(v_item);
+        if (w_list != NULL) {
+            PyObject* w_item = PyList_GetItem(w_list, i);
+            if (w_item == NULL) {
+                free(u_data);
+                free(v_data);
+                free(w_data);
+                return NULL;
+            }
+            w_data[i] = PyFloat_AsDouble(w_item);
+        }
+        if (PyErr_Occurred()) {
+            free(u_data);
+            free(v_data);
+            free(w_data);
+            return NULL;
+        }
+    }
+
+    vtk_geometry geom;
+    vtk_geometry_from_bounds(&geom, nx, ny, nz, xmin, xmax, ymin, ymax, zmin, zmax);
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    if (binary) {
+        rc = vtk_binary_write_vector(filename, field_name, u_data, v_data, w_data, &geom);
+    } else {
+        rc = vtk_ascii_write_vector(filename, field_name, u_data, v_data, w_data, &geom,
+                                    precision);
+    }
+    Py_END_ALLOW_THREADS
+    free(u_data);
+    free(v_data);
+    free(w_data);
+    if (rc < 0) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
+    }
+
+    Py_RETURN_NONE;
+}
+
+/*
+ * Write CSV timeseries data
+ */
+static PyObject* write_csv_timeseries_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static char* kwlist[] = {"filename", "step", "time", "u_data", "v_data", "p_data",
+                             "nx", "ny", "dt", "iterations", "create_new", NULL};
+    const char* filename;
+    int step;
+    double time;
+    PyObject* u_list;
+    PyObject* v_list;
+    PyObject* p_list;
+    size_t nx, ny;
+    double dt;
+    int iterations;
+    int create_new = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "sidOOOnndip", kwlist,
+                                     &filename, &step, &time, &u_list, &v_list, &p_list,
+                                     &nx, &ny, &dt, &iterations, &create_new)) {
+        return NULL;
+    }
+
+    // Validate lists
+    if (!PyList_Check(u_list) || !PyList_Check(v_list) || !PyList_Check(p_list)) {
+        PyErr_SetString(PyExc_TypeError, "u_data, v_data, and p_data must be lists");
+        return NULL;
+    }
+
+    size_t size = nx * ny;
+    if ((size_t)PyList_Size(u_list) != size || (size_t)PyList_Size(v_list) != size ||
+        (size_t)PyList_Size(p_list) != size) {
+        PyErr_SetString(PyExc_ValueError, "data list sizes must match nx*ny");
+        return NULL;
+    }
+
+    // Allocate and populate flow field
+    flow_field* field = flow_field_create(nx, ny, 1);
+    if (field == NULL) {
+        PyErr_SetString(PyExc_MemoryError, "Failed to allocate flow field");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        PyObject* u_item = PyList_GetItem(u_list, i);
+        PyObject* v_item = PyList_GetItem(v_list, i);
+        PyObject* p_item = PyList_GetItem(p_list, i);
+        if (u_item == NULL || v_item == NULL || p_item == NULL) {
+            flow_field_destroy(field);
+            return NULL;
+        }
+        field->u[i] = PyFloat_AsDouble(u_item);
+        field->v[i] = PyFloat_AsDouble(v_item);
+        field->p[i] = PyFloat_AsDouble(p_item);
+        if (PyErr_Occurred()) {
+            flow_field_destroy(field);
+            return NULL;
+        }
+    }
+
+    ns_solver_params_t params = ns_solver_params_default();
+    params.dt = dt;
+
+    ns_solver_stats_t stats = ns_solver_stats_default();
+    stats.iterations = iterations;
+
+    // New API: write_csv_timeseries takes derived_fields* (can be NULL)
+    write_csv_timeseries(filename, step, time, field, NULL, &params, &stats, nx, ny, create_new);
+
+    flow_field_destroy(field);
+    Py_RETURN_NONE;
+}
+
+/*
+ * Get last CFD error
+ */
+static PyObject* get_last_error(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+
+    const char* error = cfd_get_last_error();
+    if (error && error[0] != '\0') {
+        PyObject* result = PyUnicode_FromString(error);
+        if (result == NULL) {
+            return NULL;  // PyUnicode_FromString sets exception on failure
+        }
+        return result;
+    }
+    Py_RETURN_NONE;
+}
+
+/*
+ * Get last CFD status code
+ */
+static PyObject* get_last_status(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+
+    cfd_status_t status = cfd_get_last_status();
+    PyObject* result = PyLong_FromLong((long)status);
+    if (result == NULL) {
+        return NULL;  // PyLong_FromLong sets MemoryError on failure
+    }
+    return result;
+}
+
+/*
+ * Clear CFD error state
+ */
+static PyObject* clear_error(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+
+    cfd_clear_error();
+    Py_RETURN_NONE;
+}
+
+/*
+ * Get error string for status code
+ */
+static PyObject* get_error_string(PyObject* self, PyObject* args) {
+    (void)self;
+    int status;
+
+    if (!PyArg_ParseTuple(args, "i", &status)) {
+        return NULL;
+    }
+
+    const char* str = cfd_get_error_string((cfd_status_t)status);
+    PyObject* result = PyUnicode_FromString(str);
+    if (result == NULL) {
+        return NULL;  // PyUnicode_FromString sets exception on failure
+    }
+    return result;
+}
+
+/* ============================================================================
+ * BOUNDARY CONDITIONS API
+ * ============================================================================ */
+
+/*
+ * Get current BC backend
+ */
+static PyObject* bc_get_backend_py(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+    PyObject* result = PyLong_FromLong((long)bc_get_backend());
+    if (result == NULL) {
+        return NULL;  // PyLong_FromLong sets MemoryError on failure
+    }
+    return result;
+}
+
+/*
+ * Get BC backend name as string
+ */
+static PyObject* bc_get_backend_name_py(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+    PyObject* result = PyUnicode_FromString(bc_get_backend_name());
+    if (result == NULL) {
+        return NULL;  // PyUnicode_FromString sets exception on failure
+    }
+    return result;
+}
+
+/*
+ * Set BC backend
+ */
+static PyObject* bc_set_backend_py(PyObject* self, PyObject* args) {
+    (void)self;
+    int backend;
+
+    if (!PyArg_ParseTuple(args, "i", &backend)) {
+        return NULL;
+    }
+
+    bool success = bc_set_backend((bc_backend_t)backend);
+    return PyBool_FromLong(success);
+}
+
+/*
+ * Check if BC backend is available
+ */
+static PyObject* bc_backend_available_py(PyObject* self, PyObject* args) {
+    (void)self;
+    int backend;
+
+    if (!PyArg_ParseTuple(args, "i", &backend)) {
+        return NULL;
+    }
+
+    bool available = bc_backend_available((bc_backend_t)backend);
+    return PyBool_FromLong(available);
+}
+
+/*
+ * ========================================
+ * Solver Backend Availability API (v0.1.6)
+ * ========================================
+ */
+
+/*
+ * Check if a solver backend is available at runtime
+ */
+static PyObject* backend_is_available_py(PyObject* self, PyObject* args) {
+    (void)self;
+    int backend;
+
+    if (!PyArg_ParseTuple(args, "i", &backend)) {
+        return NULL;
+    }
+
+    int available = cfd_backend_is_available((ns_solver_backend_t)backend);
+    return PyBool_FromLong(available);
+}
+
+/*
+ * Get human-readable name for a solver backend
+ */
+static PyObject* backend_get_name_py(PyObject* self, PyObject* args) {
+    (void)self;
+    int backend;
+
+    if (!PyArg_ParseTuple(args, "i", &backend)) {
+        return NULL;
+    }
+
+    const char* name = cfd_backend_get_name((ns_solver_backend_t)backend);
+    if (name == NULL) {
+        Py_RETURN_NONE;
+    }
+    PyObject* result = PyUnicode_FromString(name);
+    if (result == NULL) {
+        return NULL;  // PyUnicode_FromString sets exception on failure
+    }
+    return result;
+}
+
+/*
+ * Get list of solvers for a specific backend
+ */
+static PyObject* list_solvers_by_backend_py(PyObject* self, PyObject* args) {
+    (void)self;
+    int backend;
+
+    if (!PyArg_ParseTuple(args, "i", &backend)) {
+        return NULL;
+    }
+
+    if (g_registry == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "Solver registry not initialized");
+        return NULL;
+    }
+
+    // First, get the count
+    int count = cfd_registry_list_by_backend(g_registry, (ns_solver_backend_t)backend, NULL, 0);
+    if (count <= 0) {
+        return PyList_New(0);  // Return empty list
+    }
+
+    // Allocate array for names
+    const char** names = (const char**)malloc(count * sizeof(const char*));
+    if (names == NULL) {
+        PyErr_SetString(PyExc_MemoryError, "Failed to allocate names array");
+        return NULL;
+    }
+
+    // Get the actual names
+    int actual_count = cfd_registry_list_by_backend(g_registry, (ns_solver_backend_t)backend, names, count);
+
+    // Build Python list
+    PyObject* result = PyList_New(actual_count);
+    if (result == NULL) {
+        free(names);
+        return NULL;
+    }
+
+    for (int i = 0; i < actual_count; i++) {
+        PyObject* name = PyUnicode_FromString(names[i]);
+        if (name == NULL) {
+            Py_DECREF(result);
+            free(names);
+            return NULL;
+        }
+        if (PyList_SetItem(result, i, name) < 0) {  // Steals reference on success
+            Py_DECREF(name);
+            Py_DECREF(result);
+            free(names);
+            return NULL;
+        }
+    }
+
+    free(names);
+    return result;
+}
+
+/*
+ * Get list of all available backends
+ */
+static PyObject* get_available_backends_py(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+
+    PyObject* result = PyList_New(0);
+    if (result == NULL) {
+        return NULL;
+    }
+
+    // Check each backend
+    ns_solver_backend_t backends[] = {
+        NS_SOLVER_BACKEND_SCALAR,
+        NS_SOLVER_BACKEND_SIMD,
+        NS_SOLVER_BACKEND_OMP,
+        NS_SOLVER_BACKEND_CUDA
+    };
+    int num_backends = sizeof(backends) / sizeof(backends[0]);
+
+    for (int i = 0; i < num_backends; i++) {
+        if (cfd_backend_is_available(backends[i])) {
+            const char* name = cfd_backend_get_name(backends[i]);
+            if (name != NULL) {
+                PyObject* name_obj = PyUnicode_FromString(name);
+                if (name_obj == NULL) {
+                    Py_DECREF(result);
+                    return NULL;
+                }
+                if (PyList_Append(result, name_obj) < 0) {
+                    Py_DECREF(name_obj);
+                    Py_DECREF(result);
+                    return NULL;
+                }
+                Py_DECREF(name_obj);
+            }
+        }
+    }
+
+    return result;
+}
+
+// ============================================================================
+// CPU Features API (Phase 6)
+// ============================================================================
+
+/*
+ * Get the detected SIMD architecture
+ * Returns: int (SIMD_NONE=0, SIMD_AVX2=1, SIMD_NEON=2)
+ */
+static PyObject* get_simd_arch_py(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+
+    cfd_simd_arch_t arch = cfd_detect_simd_arch();
+    PyObject* result = PyLong_FromLong((long)arch);
+    if (result == NULL) {
+        return NULL;  // PyLong_FromLong sets MemoryError on failure
+    }
+    return result;
+}
+
+/*
+ * Get the name of the detected SIMD architecture
+ * Returns: str ("avx2", "neon", or "none")
+ */
+static PyObject* get_simd_name_py(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+
+    const char* name = cfd_get_simd_name();
+    PyObject* result = PyUnicode_FromString(name);
+    if (result == NULL) {
+        return NULL;  // PyUnicode_FromString sets exception on failure
+    }
+    return result;
+}
+
+/*
+ * Check if AVX2 is available
+ * Returns: bool
+ */
+static PyObject* has_avx2_py(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+
+    bool available = cfd_has_avx2();
+    return PyBool_FromLong(available);
+}
+
+/*
+ * Check if ARM NEON is available
+ * Returns: bool
+ */
+static PyObject* has_neon_py(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+
+    bool available = cfd_has_neon();
+    return PyBool_FromLong(available);
+}
+
+/*
+ * Check if any SIMD is available (AVX2 or NEON)
+ * Returns: bool
+ */
+static PyObject* has_simd_py(PyObject* self, PyObject* args) {
+    (void)self;
+    (void)args;
+
+    bool available = cfd_has_simd();
+    return PyBool_FromLong(available);
+}
+
+// ============================================================================
+// Grid Initialization Variants (Phase 6)
+// ============================================================================
+
+/*
+ * Create a grid with stretched (non-uniform) spacing
+ * Args: nx, ny, xmin, xmax, ymin, ymax, beta
+ * Returns: dict with grid information
+ */
+static PyObject* create_grid_stretched_py(PyObject* self, PyObject* args) {
+    (void)self;
+
+    long nx_signed, ny_signed;
+    double xmin, xmax, ymin, ymax, beta;
+
+    if (!PyArg_ParseTuple(args, "llddddd", &nx_signed, &ny_signed,
+                          &xmin, &xmax, &ymin, &ymax, &beta)) {
+        return NULL;
+    }
+
+    if (nx_signed <= 0 || ny_signed <= 0) {
+        PyErr_SetString(PyExc_ValueError, "Grid dimensions must be positive");
+        return NULL;
+    }
+    if (xmax <= xmin) {
+        PyErr_SetString(PyExc_ValueError, "xmax must be greater than xmin");
+        return NULL;
+    }
+    if (ymax <= ymin) {
+        PyErr_SetString(PyExc_ValueError, "ymax must be greater than ymin");
+        return NULL;
+    }
+    if (beta <= 0.0) {
+        PyErr_SetString(PyExc_ValueError, "beta must be positive");
+        return NULL;
+    }
+
+    size_t nx = (size_t)nx_signed;
+    size_t ny = (size_t)ny_signed;
+
+    grid* g = grid_create(nx, ny, 1, xmin, xmax, ymin, ymax, 0.0, 0.0);
+    if (g == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to create grid");
+        return NULL;
+    }
+
+    grid_initialize_stretched(g, beta);
+
+    // Return grid information as a dictionary
+    PyObject* grid_dict = PyDict_New();
+    if (grid_dict == NULL) {
+        grid_destroy(g);
+        return NULL;
+    }
+
+    // Helper macro to add values to dict with proper refcount and error handling
+    #define ADD_TO_DICT_STRETCHED(dict, key, py_val) do { \
         PyObject* tmp = (py_val); \
         if (tmp == NULL) { Py_DECREF(dict); grid_destroy(g); return NULL; } \
-        PyDict_SetItemString(dict, key, tmp); \
+        if (PyDict_SetItemString(dict, key, tmp) < 0) { \
+            Py_DECREF(tmp); Py_DECREF(dict); grid_destroy(g); return NULL; \
+        } \
         Py_DECREF(tmp); \
     } while(0)
 
-    ADD_TO_DICT(grid_dict, "nx", PyLong_FromSize_t(g->nx));
-    ADD_TO_DICT(grid_dict, "ny", PyLong_FromSize_t(g->ny));
-    ADD_TO_DICT(grid_dict, "nz", PyLong_FromSize_t(g->nz));
-    ADD_TO_DICT(grid_dict, "xmin", PyFloat_FromDouble(g->xmin));
-    ADD_TO_DICT(grid_dict, "xmax", PyFloat_FromDouble(g->xmax));
-    ADD_TO_DICT(grid_dict, "ymin", PyFloat_FromDouble(g->ymin));
-    ADD_TO_DICT(grid_dict, "ymax", PyFloat_FromDouble(g->ymax));
-    ADD_TO_DICT(grid_dict, "zmin", PyFloat_FromDouble(g->zmin));
-    ADD_TO_DICT(grid_dict, "zmax", PyFloat_FromDouble(g->zmax));
+    ADD_TO_DICT_STRETCHED(grid_dict, "nx", PyLong_FromSize_t(g->nx));
+    ADD_TO_DICT_STRETCHED(grid_dict, "ny", PyLong_FromSize_t(g->ny));
+    ADD_TO_DICT_STRETCHED(grid_dict, "xmin", PyFloat_FromDouble(g->xmin));
+    ADD_TO_DICT_STRETCHED(grid_dict, "xmax", PyFloat_FromDouble(g->xmax));
+    ADD_TO_DICT_STRETCHED(grid_dict, "ymin", PyFloat_FromDouble(g->ymin));
+    ADD_TO_DICT_STRETCHED(grid_dict, "ymax", PyFloat_FromDouble(g->ymax));
+    ADD_TO_DICT_STRETCHED(grid_dict, "beta", PyFloat_FromDouble(beta));
 
-    #undef ADD_TO_DICT
+    #undef ADD_TO_DICT_STRETCHED
 
     // Create coordinate lists
-    PyObject* x_list = PyList_New(0);
-    PyObject* y_list = PyList_New(0);
+    PyObject* x_list = PyList_New((Py_ssize_t)g->nx);
+    PyObject* y_list = PyList_New((Py_ssize_t)g->ny);
     if (x_list == NULL || y_list == NULL) {
         Py_XDECREF(x_list);
         Py_XDECREF(y_list);
@@ -359,316 +5182,384 @@ static PyObject* create_grid(PyObject* self, PyObject* args, PyObject* kwds) {
 
     for (size_t i = 0; i < g->nx; i++) {
         PyObject* val = PyFloat_FromDouble(g->x[i]);
-        if (val == NULL || PyList_Append(x_list, val) < 0) {
-            Py_XDECREF(val);
+        if (val == NULL) {
+            Py_DECREF(x_list);
+            Py_DECREF(y_list);
+            Py_DECREF(grid_dict);
+            grid_destroy(g);
+            return NULL;
+        }
+        if (PyList_SetItem(x_list, (Py_ssize_t)i, val) < 0) {  // steals reference on success
+            Py_DECREF(val);  // PyList_SetItem doesn't steal on failure
             Py_DECREF(x_list);
             Py_DECREF(y_list);
             Py_DECREF(grid_dict);
             grid_destroy(g);
             return NULL;
         }
-        Py_DECREF(val);
     }
 
     for (size_t i = 0; i < g->ny; i++) {
         PyObject* val = PyFloat_FromDouble(g->y[i]);
-        if (val == NULL || PyList_Append(y_list, val) < 0) {
-            Py_XDECREF(val);
+        if (val == NULL) {
             Py_DECREF(x_list);
             Py_DECREF(y_list);
             Py_DECREF(grid_dict);
             grid_destroy(g);
             return NULL;
         }
-        Py_DECREF(val);
-    }
-
-    PyDict_SetItemString(grid_dict, "x_coords", x_list);
-    PyDict_SetItemString(grid_dict, "y_coords", y_list);
-    Py_DECREF(x_list);
-    Py_DECREF(y_list);
-
-    // Add z coordinates when 3D
-    if (g->nz > 1 && g->z != NULL) {
-        PyObject* z_list = PyList_New(0);
-        if (z_list == NULL) {
+        if (PyList_SetItem(y_list, (Py_ssize_t)i, val) < 0) {  // steals reference on success
+            Py_DECREF(val);  // PyList_SetItem doesn't steal on failure
+            Py_DECREF(x_list);
+            Py_DECREF(y_list);
             Py_DECREF(grid_dict);
             grid_destroy(g);
             return NULL;
         }
-        for (size_t i = 0; i < g->nz; i++) {
-            PyObject* val = PyFloat_FromDouble(g->z[i]);
-            if (val == NULL || PyList_Append(z_list, val) < 0) {
-                Py_XDECREF(val);
-                Py_DECREF(z_list);
-                Py_DECREF(grid_dict);
-                grid_destroy(g);
-                return NULL;
-            }
-            Py_DECREF(val);
-        }
-        PyDict_SetItemString(grid_dict, "z_coords", z_list);
-        Py_DECREF(z_list);
     }
 
+    if (PyDict_SetItemString(grid_dict, "x_coords", x_list) < 0 ||
+        PyDict_SetItemString(grid_dict, "y_coords", y_list) < 0) {
+        Py_DECREF(x_list);
+        Py_DECREF(y_list);
+        Py_DECREF(grid_dict);
+        grid_destroy(g);
+        return NULL;
+    }
+    Py_DECREF(x_list);
+    Py_DECREF(y_list);
+
     grid_destroy(g);
     return grid_dict;
 }
 
 /*
- * Get default solver parameters
+ * A field updated in place by a boundary condition call. Lists are copied
+ * in and written back afterwards; writable float64 buffers (NumPy arrays,
+ * Simulation views, load_npy(..., writable=True)) are updated directly.
  */
-static PyObject* get_default_solver_params(PyObject* self, PyObject* args) {
-    (void)self;
-    (void)args;
-    ns_solver_params_t params = ns_solver_params_default();
+typedef struct {
+    PyObject* list;  // Borrowed; NULL for buffers
+    double_buffer buf;
+} bc_field;
+
+static int acquire_bc_field(PyObject* obj, const char* name, bc_field* field) {
+    memset(field, 0, sizeof(*field));
+    if (PyList_Check(obj)) {
+        field->list = obj;
+        return acquire_double_buffer(obj, 0, &field->buf);
+    }
+    if (!PyTuple_Check(obj)) {
+        if (acquire_double_buffer(obj, 1, &field->buf) < 0) {
+            if (!PyErr_ExceptionMatches(PyExc_TypeError)) {
+                return -1;
+            }
+            PyErr_Clear();
+        } else if (!field->buf.copied) {
+            return 0;
+        } else {
+            // Results written to a converted copy would be lost
+            release_double_buffer(&field->buf);
+        }
+    }
+    PyErr_Format(PyExc_TypeError, "%s must be a list or a writable float64 buffer", name);
+    return -1;
+}
 
-    PyObject* params_dict = PyDict_New();
-    if (params_dict == NULL) {
+// Release `count` fields, writing lists back unless the call failed with `status`
+static PyObject* finish_bc_fields(bc_field* fields, int count, cfd_status_t status,
+                                  const char* func) {
+    int rc = 0;
+    for (int f = 0; f < count; f++) {
+        for (Py_ssize_t i = 0; status == CFD_SUCCESS && rc == 0 && fields[f].list != NULL &&
+                               i < fields[f].buf.count; i++) {
+            PyObject* val = PyFloat_FromDouble(fields[f].buf.data[i]);
+            if (val == NULL || PyList_SetItem(fields[f].list, i, val) < 0) {
+                rc = -1;
+            }
+        }
+        release_double_buffer(&fields[f].buf);
+    }
+    if (status != CFD_SUCCESS) {
+        return raise_cfd_error(status, func);
+    }
+    if (rc < 0) {
         return NULL;
     }
+    Py_RETURN_NONE;
+}
 
-    // Helper macro to add values to dict with proper refcount
-    #define ADD_TO_DICT(dict, key, py_val) do { \
-        PyObject* tmp = (py_val); \
-        if (tmp == NULL) { Py_DECREF(dict); return NULL; } \
-        PyDict_SetItemString(dict, key, tmp); \
-        Py_DECREF(tmp); \
-    } while(0)
-
-    ADD_TO_DICT(params_dict, "dt", PyFloat_FromDouble(params.dt));
-    ADD_TO_DICT(params_dict, "cfl", PyFloat_FromDouble(params.cfl));
-    ADD_TO_DICT(params_dict, "gamma", PyFloat_FromDouble(params.gamma));
-    ADD_TO_DICT(params_dict, "mu", PyFloat_FromDouble(params.mu));
-    ADD_TO_DICT(params_dict, "k", PyFloat_FromDouble(params.k));
-    ADD_TO_DICT(params_dict, "max_iter", PyLong_FromLong(params.max_iter));
-    ADD_TO_DICT(params_dict, "tolerance", PyFloat_FromDouble(params.tolerance));
-
-    #undef ADD_TO_DICT
+static int acquire_bc_scalar(PyObject* obj, size_t nx, size_t ny, bc_field* field) {
+    if (acquire_bc_field(obj, "field", field) < 0) {
+        return -1;
+    }
+    if ((size_t)field->buf.count != nx * ny) {
+        PyErr_Format(PyExc_ValueError, "field size (%zd) must match nx*ny (%zu)",
+                     field->buf.count, nx * ny);
+        release_double_buffer(&field->buf);
+        return -1;
+    }
+    return 0;
+}
 
-    return params_dict;
+static int acquire_bc_velocity(PyObject* u_obj, PyObject* v_obj, size_t nx, size_t ny,
+                               bc_field fields[2]) {
+    if (acquire_bc_field(u_obj, "u", &fields[0]) < 0) {
+        return -1;
+    }
+    if (acquire_bc_field(v_obj, "v", &fields[1]) < 0) {
+        release_double_buffer(&fields[0].buf);
+        return -1;
+    }
+    if ((size_t)fields[0].buf.count != nx * ny || (size_t)fields[1].buf.count != nx * ny) {
+        PyErr_SetString(PyExc_ValueError, "u and v sizes must match nx*ny");
+        release_double_buffer(&fields[0].buf);
+        release_double_buffer(&fields[1].buf);
+        return -1;
+    }
+    return 0;
 }
 
 /*
- * Run simulation with detailed parameters and solver selection
+ * Apply boundary conditions to scalar field
  */
-static PyObject* run_simulation_with_params(PyObject* self, PyObject* args, PyObject* kwds) {
+static PyObject* bc_apply_scalar_py(PyObject* self, PyObject* args, PyObject* kwds) {
     (void)self;
-    static char* kwlist[] = {"nx", "ny", "xmin", "xmax", "ymin", "ymax",
-                             "steps", "dt", "cfl", "solver_type", "output_file", NULL};
-    size_t nx, ny, steps = 1;
-    double xmin, xmax, ymin, ymax;
-    double dt = 0.001, cfl = 0.2;
-    const char* solver_type = NULL;
-    const char* output_file = NULL;
+    static char* kwlist[] = {"field", "nx", "ny", "bc_type", NULL};
+    PyObject* field_obj;
+    size_t nx, ny;
+    int bc_type;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "nndddd|nddss", kwlist,
-                                     &nx, &ny, &xmin, &xmax, &ymin, &ymax,
-                                     &steps, &dt, &cfl, &solver_type, &output_file)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Onni", kwlist,
+                                     &field_obj, &nx, &ny, &bc_type)) {
         return NULL;
     }
-
-    simulation_data* sim_data;
-    if (solver_type) {
-        sim_data = init_simulation_with_solver(nx, ny, 1, xmin, xmax, ymin, ymax, 0.0, 0.0, solver_type);
-    } else {
-        sim_data = init_simulation(nx, ny, 1, xmin, xmax, ymin, ymax, 0.0, 0.0);
+    bc_field field;
+    if (acquire_bc_scalar(field_obj, nx, ny, &field) < 0) {
+        return NULL;
     }
 
-    if (sim_data == NULL) {
-        if (solver_type) {
-            PyErr_Format(PyExc_RuntimeError, "Failed to initialize simulation with solver '%s'", solver_type);
-        } else {
-            PyErr_SetString(PyExc_RuntimeError, "Failed to initialize simulation");
-        }
+    cfd_status_t status = bc_apply_scalar(field.buf.data, nx, ny, (bc_type_t)bc_type);
+    return finish_bc_fields(&field, 1, status, "bc_apply_scalar");
+}
+
+/*
+ * Apply boundary conditions to velocity fields
+ */
+static PyObject* bc_apply_velocity_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static char* kwlist[] = {"u", "v", "nx", "ny", "bc_type", NULL};
+    PyObject* u_obj;
+    PyObject* v_obj;
+    size_t nx, ny;
+    int bc_type;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOnni", kwlist,
+                                     &u_obj, &v_obj, &nx, &ny, &bc_type)) {
+        return NULL;
+    }
+    bc_field uv[2];
+    if (acquire_bc_velocity(u_obj, v_obj, nx, ny, uv) < 0) {
         return NULL;
     }
 
-    // Modify solver parameters
-    sim_data->params.dt = dt;
-    sim_data->params.cfl = cfl;
+    cfd_status_t status = bc_apply_velocity(uv[0].buf.data, uv[1].buf.data, nx, ny,
+                                            (bc_type_t)bc_type);
+    return finish_bc_fields(uv, 2, status, "bc_apply_velocity");
+}
 
-    // Run simulation steps
-    for (size_t i = 0; i < steps; i++) {
-        run_simulation_step(sim_data);
-    }
+/*
+ * Apply Dirichlet boundary conditions to scalar field
+ */
+static PyObject* bc_apply_dirichlet_scalar_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static char* kwlist[] = {"field", "nx", "ny", "left", "right", "bottom", "top", NULL};
+    PyObject* field_obj;
+    size_t nx, ny;
+    double left, right, bottom, top;
 
-    // Create results dictionary
-    PyObject* results = PyDict_New();
-    if (results == NULL) {
-        free_simulation(sim_data);
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Onndddd", kwlist,
+                                     &field_obj, &nx, &ny, &left, &right, &bottom, &top)) {
+        return NULL;
+    }
+    bc_field field;
+    if (acquire_bc_scalar(field_obj, nx, ny, &field) < 0) {
         return NULL;
     }
 
-    // Compute velocity magnitude using derived_fields
-    flow_field* field = sim_data->field;
-    derived_fields* derived = derived_fields_create(field->nx, field->ny, field->nz);
-    if (derived != NULL) {
-        derived_fields_compute_velocity_magnitude(derived, field);
+    bc_dirichlet_values_t values = {.left = left, .right = right, .bottom = bottom, .top = top};
+    cfd_status_t status = bc_apply_dirichlet_scalar(field.buf.data, nx, ny, &values);
+    return finish_bc_fields(&field, 1, status, "bc_apply_dirichlet_scalar");
+}
 
-        if (derived->velocity_magnitude != NULL) {
-            size_t size = field->nx * field->ny;
-            PyObject* vel_list = PyList_New(0);
-            if (vel_list == NULL) {
-                derived_fields_destroy(derived);
-                Py_DECREF(results);
-                free_simulation(sim_data);
-                return NULL;
-            }
-            for (size_t i = 0; i < size; i++) {
-                PyObject* val = PyFloat_FromDouble(derived->velocity_magnitude[i]);
-                if (val == NULL || PyList_Append(vel_list, val) < 0) {
-                    Py_XDECREF(val);
-                    Py_DECREF(vel_list);
-                    derived_fields_destroy(derived);
-                    Py_DECREF(results);
-                    free_simulation(sim_data);
-                    return NULL;
-                }
-                Py_DECREF(val);
-            }
-            PyDict_SetItemString(results, "velocity_magnitude", vel_list);
-            Py_DECREF(vel_list);
-        }
-        derived_fields_destroy(derived);
+/*
+ * Apply no-slip boundary conditions to velocity fields
+ */
+static PyObject* bc_apply_noslip_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static char* kwlist[] = {"u", "v", "nx", "ny", NULL};
+    PyObject* u_obj;
+    PyObject* v_obj;
+    size_t nx, ny;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOnn", kwlist,
+                                     &u_obj, &v_obj, &nx, &ny)) {
+        return NULL;
+    }
+    bc_field uv[2];
+    if (acquire_bc_velocity(u_obj, v_obj, nx, ny, uv) < 0) {
+        return NULL;
     }
 
-    // Helper macro to add values to dict with proper refcount
-    #define ADD_TO_DICT(dict, key, py_val) do { \
-        PyObject* tmp = (py_val); \
-        if (tmp == NULL) { Py_DECREF(dict); free_simulation(sim_data); return NULL; } \
-        PyDict_SetItemString(dict, key, tmp); \
-        Py_DECREF(tmp); \
-    } while(0)
+    cfd_status_t status = bc_apply_noslip(uv[0].buf.data, uv[1].buf.data, nx, ny);
+    return finish_bc_fields(uv, 2, status, "bc_apply_noslip");
+}
 
-    // Add simulation info
-    ADD_TO_DICT(results, "nx", PyLong_FromSize_t(nx));
-    ADD_TO_DICT(results, "ny", PyLong_FromSize_t(ny));
-    ADD_TO_DICT(results, "steps", PyLong_FromSize_t(steps));
+/*
+ * Apply inlet boundary conditions
+ */
+static PyObject* bc_apply_inlet_uniform_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static char* kwlist[] = {"u", "v", "nx", "ny", "u_inlet", "v_inlet", "edge", NULL};
+    PyObject* u_obj;
+    PyObject* v_obj;
+    size_t nx, ny;
+    double u_inlet, v_inlet;
+    int edge = BC_EDGE_LEFT;
 
-    // Add solver info
-    ns_solver_t* solver = simulation_get_solver(sim_data);
-    if (solver) {
-        ADD_TO_DICT(results, "solver_name", PyUnicode_FromString(solver->name));
-        ADD_TO_DICT(results, "solver_description", PyUnicode_FromString(solver->description));
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOnndd|i", kwlist,
+                                     &u_obj, &v_obj, &nx, &ny, &u_inlet, &v_inlet, &edge)) {
+        return NULL;
+    }
+    bc_field uv[2];
+    if (acquire_bc_velocity(u_obj, v_obj, nx, ny, uv) < 0) {
+        return NULL;
     }
 
-    // Add solver statistics
-    const ns_solver_stats_t* stats = simulation_get_stats(sim_data);
-    if (stats) {
-        PyObject* stats_dict = PyDict_New();
-        if (stats_dict == NULL) {
-            Py_DECREF(results);
-            free_simulation(sim_data);
-            return NULL;
-        }
-
-        // Use a local macro for stats_dict
-        #define ADD_TO_STATS(key, py_val) do { \
-            PyObject* tmp = (py_val); \
-            if (tmp == NULL) { Py_DECREF(stats_dict); Py_DECREF(results); free_simulation(sim_data); return NULL; } \
-            PyDict_SetItemString(stats_dict, key, tmp); \
-            Py_DECREF(tmp); \
-        } while(0)
-
-        ADD_TO_STATS("iterations", PyLong_FromLong(stats->iterations));
-        ADD_TO_STATS("max_velocity", PyFloat_FromDouble(stats->max_velocity));
-        ADD_TO_STATS("max_pressure", PyFloat_FromDouble(stats->max_pressure));
-        ADD_TO_STATS("elapsed_time_ms", PyFloat_FromDouble(stats->elapsed_time_ms));
+    // Create inlet config and apply
+    bc_inlet_config_t config = bc_inlet_config_uniform(u_inlet, v_inlet);
+    bc_inlet_set_edge(&config, (bc_edge_t)edge);
+    cfd_status_t status = bc_apply_inlet(uv[0].buf.data, uv[1].buf.data, nx, ny, &config);
+    return finish_bc_fields(uv, 2, status, "bc_apply_inlet");
+}
 
-        #undef ADD_TO_STATS
+/*
+ * Apply parabolic inlet boundary conditions
+ */
+static PyObject* bc_apply_inlet_parabolic_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static char* kwlist[] = {"u", "v", "nx", "ny", "max_velocity", "edge", NULL};
+    PyObject* u_obj;
+    PyObject* v_obj;
+    size_t nx, ny;
+    double max_velocity;
+    int edge = BC_EDGE_LEFT;
 
-        PyDict_SetItemString(results, "stats", stats_dict);
-        Py_DECREF(stats_dict);
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOnnd|i", kwlist,
+                                     &u_obj, &v_obj, &nx, &ny, &max_velocity, &edge)) {
+        return NULL;
+    }
+    bc_field uv[2];
+    if (acquire_bc_velocity(u_obj, v_obj, nx, ny, uv) < 0) {
+        return NULL;
     }
 
-    #undef ADD_TO_DICT
+    // Create parabolic inlet config and apply
+    bc_inlet_config_t config = bc_inlet_config_parabolic(max_velocity);
+    bc_inlet_set_edge(&config, (bc_edge_t)edge);
+    cfd_status_t status = bc_apply_inlet(uv[0].buf.data, uv[1].buf.data, nx, ny, &config);
+    return finish_bc_fields(uv, 2, status, "bc_apply_inlet");
+}
 
-    // Write output if requested
-    if (output_file) {
-        write_vtk_flow_field(output_file, sim_data->field,
-                            sim_data->grid->nx, sim_data->grid->ny, sim_data->grid->nz,
-                            sim_data->grid->xmin, sim_data->grid->xmax,
-                            sim_data->grid->ymin, sim_data->grid->ymax,
-                            sim_data->grid->zmin, sim_data->grid->zmax);
-        PyObject* output_str = PyUnicode_FromString(output_file);
-        if (output_str != NULL) {
-            PyDict_SetItemString(results, "output_file", output_str);
-            Py_DECREF(output_str);
-        }
+/*
+ * Apply outlet (zero-gradient) boundary conditions to scalar field
+ */
+static PyObject* bc_apply_outlet_scalar_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static char* kwlist[] = {"field", "nx", "ny", "edge", NULL};
+    PyObject* field_obj;
+    size_t nx, ny;
+    int edge = BC_EDGE_RIGHT;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Onn|i", kwlist,
+                                     &field_obj, &nx, &ny, &edge)) {
+        return NULL;
+    }
+    bc_field field;
+    if (acquire_bc_scalar(field_obj, nx, ny, &field) < 0) {
+        return NULL;
     }
 
-    free_simulation(sim_data);
-    return results;
+    // Create outlet config and apply
+    bc_outlet_config_t config = bc_outlet_config_zero_gradient();
+    bc_outlet_set_edge(&config, (bc_edge_t)edge);
+    cfd_status_t status = bc_apply_outlet_scalar(field.buf.data, nx, ny, &config);
+    return finish_bc_fields(&field, 1, status, "bc_apply_outlet_scalar");
 }
 
 /*
- * Set the output directory for simulation outputs
+ * Apply outlet boundary conditions to velocity fields
  */
-static PyObject* set_output_dir(PyObject* self, PyObject* args) {
+static PyObject* bc_apply_outlet_velocity_py(PyObject* self, PyObject* args, PyObject* kwds) {
     (void)self;
-    const char* output_dir;
+    static char* kwlist[] = {"u", "v", "nx", "ny", "edge", NULL};
+    PyObject* u_obj;
+    PyObject* v_obj;
+    size_t nx, ny;
+    int edge = BC_EDGE_RIGHT;
 
-    if (!PyArg_ParseTuple(args, "s", &output_dir)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOnn|i", kwlist,
+                                     &u_obj, &v_obj, &nx, &ny, &edge)) {
+        return NULL;
+    }
+    bc_field uv[2];
+    if (acquire_bc_velocity(u_obj, v_obj, nx, ny, uv) < 0) {
         return NULL;
     }
 
-    // Note: This function now requires a simulation_data context
-    // For now, we'll warn that this is a no-op without a simulation context
-    PyErr_WarnEx(PyExc_DeprecationWarning,
-                 "set_output_dir() without simulation context is deprecated. "
-                 "Use simulation_data.output_base_dir instead.", 1);
-    Py_RETURN_NONE;
+    // Create outlet config and apply
+    bc_outlet_config_t config = bc_outlet_config_zero_gradient();
+    bc_outlet_set_edge(&config, (bc_edge_t)edge);
+    cfd_status_t status = bc_apply_outlet_velocity(uv[0].buf.data, uv[1].buf.data, nx, ny,
+                                                   &config);
+    return finish_bc_fields(uv, 2, status, "bc_apply_outlet_velocity");
 }
 
+//=============================================================================
+// DERIVED FIELDS API (Phase 3)
+//=============================================================================
+
 /*
- * Write VTK scalar output
+ * Calculate field statistics (min, max, avg, sum)
  */
-static PyObject* write_vtk_scalar(PyObject* self, PyObject* args, PyObject* kwds) {
+static PyObject* calculate_field_stats_py(PyObject* self, PyObject* args) {
     (void)self;
-    static const char* const kwlist[] = {"filename", "field_name", "data", "nx", "ny",
-                                         "xmin", "xmax", "ymin", "ymax",
-                                         "nz", "zmin", "zmax", NULL};
-    const char* filename;
-    const char* field_name;
     PyObject* data_list;
-    size_t nx, ny;
-    size_t nz = 1;
-    double xmin, xmax, ymin, ymax;
-    double zmin = 0.0, zmax = 0.0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "ssOnndddd|ndd", (char**)kwlist,
-                                     &filename, &field_name, &data_list,
-                                     &nx, &ny, &xmin, &xmax, &ymin, &ymax,
-                                     &nz, &zmin, &zmax)) {
+    if (!PyArg_ParseTuple(args, "O", &data_list)) {
         return NULL;
     }
 
-    // Convert Python list to C array
     if (!PyList_Check(data_list)) {
         PyErr_SetString(PyExc_TypeError, "data must be a list");
         return NULL;
     }
 
-    size_t size = nx * ny * nz;
-    if ((size_t)PyList_Size(data_list) != size) {
-        PyErr_Format(PyExc_ValueError, "data list size (%zd) must match nx*ny*nz (%zu)",
-                     PyList_Size(data_list), size);
+    Py_ssize_t count = PyList_Size(data_list);
+    if (count == 0) {
+        PyErr_SetString(PyExc_ValueError, "data list cannot be empty");
         return NULL;
     }
 
-    double* data = (double*)malloc(size * sizeof(double));
+    // Convert list to C array
+    double* data = (double*)malloc((size_t)count * sizeof(double));
     if (data == NULL) {
         PyErr_SetString(PyExc_MemoryError, "Failed to allocate data array");
         return NULL;
     }
 
-    for (size_t i = 0; i < size; i++) {
+    for (Py_ssize_t i = 0; i < count; i++) {
         PyObject* item = PyList_GetItem(data_list, i);
-        if (item == NULL) {
-            free(data);
-            return NULL;
-        }
         data[i] = PyFloat_AsDouble(item);
         if (PyErr_Occurred()) {
             free(data);
@@ -676,1614 +5567,3145 @@ static PyObject* write_vtk_scalar(PyObject* self, PyObject* args, PyObject* kwds
         }
     }
 
-    write_vtk_output(filename, field_name, data, nx, ny, nz, xmin, xmax, ymin, ymax, zmin, zmax);
-    free(data);
-
-    Py_RETURN_NONE;
+    // Calculate statistics
+    field_stats stats = calculate_field_statistics(data, (size_t)count);
+    free(data);
+
+    // Return as dictionary
+    PyObject* result = PyDict_New();
+    if (result == NULL) {
+        return NULL;
+    }
+
+    PyObject* min_val = PyFloat_FromDouble(stats.min_val);
+    PyObject* max_val = PyFloat_FromDouble(stats.max_val);
+    PyObject* avg_val = PyFloat_FromDouble(stats.avg_val);
+    PyObject* sum_val = PyFloat_FromDouble(stats.sum_val);
+
+    if (min_val == NULL || max_val == NULL || avg_val == NULL || sum_val == NULL) {
+        Py_XDECREF(min_val);
+        Py_XDECREF(max_val);
+        Py_XDECREF(avg_val);
+        Py_XDECREF(sum_val);
+        Py_DECREF(result);
+        return NULL;
+    }
+
+    if (PyDict_SetItemString(result, "min", min_val) < 0 ||
+        PyDict_SetItemString(result, "max", max_val) < 0 ||
+        PyDict_SetItemString(result, "avg", avg_val) < 0 ||
+        PyDict_SetItemString(result, "sum", sum_val) < 0) {
+        Py_DECREF(min_val);
+        Py_DECREF(max_val);
+        Py_DECREF(avg_val);
+        Py_DECREF(sum_val);
+        Py_DECREF(result);
+        return NULL;
+    }
+
+    Py_DECREF(min_val);
+    Py_DECREF(max_val);
+    Py_DECREF(avg_val);
+    Py_DECREF(sum_val);
+
+    return result;
+}
+
+// Resolution of the internal histogram used for approximate percentiles
+#define PERCENTILE_BINS 4096
+
+static PyObject* histogram_to_dict(const field_histogram* hist) {
+    PyObject* counts = PyList_New((Py_ssize_t)hist->bins);
+    PyObject* edges = PyList_New((Py_ssize_t)hist->bins + 1);
+    if (counts == NULL || edges == NULL) {
+        Py_XDECREF(counts);
+        Py_XDECREF(edges);
+        return NULL;
+    }
+    double width = (hist->hi - hist->lo) / (double)hist->bins;
+    for (size_t i = 0; i <= hist->bins; i++) {
+        double edge = i == hist->bins ? hist->hi : hist->lo + width * (double)i;
+        PyObject* e = PyFloat_FromDouble(edge);
+        PyObject* c = i < hist->bins ? PyLong_FromUnsignedLongLong(hist->counts[i]) : NULL;
+        if (e == NULL || (i < hist->bins && c == NULL)) {
+            Py_XDECREF(e);
+            Py_XDECREF(c);
+            Py_DECREF(counts);
+            Py_DECREF(edges);
+            return NULL;
+        }
+        PyList_SetItem(edges, (Py_ssize_t)i, e);
+        if (c != NULL) {
+            PyList_SetItem(counts, (Py_ssize_t)i, c);
+        }
+    }
+    return Py_BuildValue("{s:N,s:N,s:K,s:K}", "counts", counts, "edges", edges,
+                         "below", (unsigned long long)hist->below,
+                         "above", (unsigned long long)hist->above);
+}
+
+/*
+ * Single-pass statistics with norms, NaN counts, histogram and percentiles
+ */
+static PyObject* field_statistics_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static const char* const kwlist[] = {"data", "bins", "range", "percentiles", NULL};
+    PyObject* data_obj;
+    Py_ssize_t bins = 0;
+    PyObject* range_obj = Py_None;
+    PyObject* pct_obj = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|nOO", (char**)kwlist,
+                                     &data_obj, &bins, &range_obj, &pct_obj)) {
+        return NULL;
+    }
+    if (bins < 0) {
+        PyErr_SetString(PyExc_ValueError, "bins must be non-negative");
+        return NULL;
+    }
+    double lo = 0.0, hi = 0.0;
+    int has_range = range_obj != Py_None;
+    if (has_range) {
+        if (!PyArg_ParseTuple(range_obj, "dd", &lo, &hi)) {
+            return NULL;
+        }
+        if (!(hi > lo)) {
+            PyErr_SetString(PyExc_ValueError, "range must satisfy lo < hi");
+            return NULL;
+        }
+    }
+
+    PyObject* pct_list = NULL;
+    if (pct_obj != Py_None) {
+        pct_list = PySequence_List(pct_obj);
+        if (pct_list == NULL) {
+            return NULL;
+        }
+        for (Py_ssize_t i = 0; i < PyList_Size(pct_list); i++) {
+            double q = PyFloat_AsDouble(PyList_GetItem(pct_list, i));
+            if (q == -1.0 && PyErr_Occurred()) {
+                Py_DECREF(pct_list);
+                return NULL;
+            }
+            if (!(q >= 0.0 && q <= 100.0)) {
+                Py_DECREF(pct_list);
+                PyErr_SetString(PyExc_ValueError, "percentiles must be in [0, 100]");
+                return NULL;
+            }
+        }
+    }
+
+    double_buffer data;
+    if (acquire_double_buffer(data_obj, 0, &data) < 0) {
+        Py_XDECREF(pct_list);
+        return NULL;
+    }
+    if (data.count == 0) {
+        release_double_buffer(&data);
+        Py_XDECREF(pct_list);
+        PyErr_SetString(PyExc_ValueError, "data cannot be empty");
+        return NULL;
+    }
+
+    // [0] user histogram, [1] percentile histogram
+    field_histogram hists[2];
+    memset(hists, 0, sizeof(hists));
+    int want_hist = bins > 0;
+    int want_pct = pct_list != NULL && PyList_Size(pct_list) > 0;
+    hists[0].bins = (size_t)bins;
+    hists[0].lo = lo;
+    hists[0].hi = hi;
+    hists[1].bins = PERCENTILE_BINS;
+    hists[0].counts = want_hist ? (uint64_t*)calloc((size_t)bins, sizeof(uint64_t)) : NULL;
+    hists[1].counts = want_pct ? (uint64_t*)calloc(PERCENTILE_BINS, sizeof(uint64_t)) : NULL;
+    if ((want_hist && hists[0].counts == NULL) || (want_pct && hists[1].counts == NULL)) {
+        free(hists[0].counts);
+        free(hists[1].counts);
+        release_double_buffer(&data);
+        Py_XDECREF(pct_list);
+        return PyErr_NoMemory();
+    }
+
+    field_moments m;
+    cfd_status_t status;
+    Py_BEGIN_ALLOW_THREADS
+    // The user histogram joins the moment pass when its range is given;
+    // otherwise histograms over [min, max] need a second pass
+    int fused = want_hist && has_range;
+    status = field_stats_compute(data.data, (size_t)data.count, &m, fused ? hists : NULL,
+                                 fused ? 1 : 0);
+    if (status == CFD_SUCCESS && m.count > 0 && ((want_hist && !fused) || want_pct)) {
+        double span_hi = m.max > m.min ? m.max : m.min + 1.0;
+        field_histogram* pending = want_hist && !fused ? &hists[0] : &hists[1];
+        int num_pending = (want_hist && !fused) + want_pct;
+        if (want_hist && !fused) {
+            hists[0].lo = m.min;
+            hists[0].hi = span_hi;
+        }
+        hists[1].lo = m.min;
+        hists[1].hi = span_hi;
+        status = field_stats_histogram(data.data, (size_t)data.count, pending, num_pending);
+    }
+    Py_END_ALLOW_THREADS
+    release_double_buffer(&data);
+
+    PyObject* result = NULL;
+    if (status != CFD_SUCCESS) {
+        raise_cfd_error(status, "field_statistics");
+        goto done;
+    }
+
+    double n = (double)m.count;
+    double variance = m.count > 0 ? m.m2 / n : NAN;
+    result = Py_BuildValue("{s:n,s:n,s:n,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d}",
+                           "count", (Py_ssize_t)m.count,
+                           "nan_count", (Py_ssize_t)m.nan_count,
+                           "inf_count", (Py_ssize_t)m.inf_count,
+                           "min", m.count > 0 ? m.min : NAN,
+                           "max", m.count > 0 ? m.max : NAN,
+                           "sum", m.sum,
+                           "avg", m.count > 0 ? m.mean : NAN,
+                           "variance", variance,
+                           "std", sqrt(variance),
+                           "rms", m.count > 0 ? sqrt(m.sum_sq / n) : NAN,
+                           "l1", m.abs_sum,
+                           "l2", sqrt(m.sum_sq),
+                           "linf", m.max_abs);
+    if (result == NULL) {
+        goto done;
+    }
+    if (want_hist && m.count > 0) {
+        PyObject* hist = histogram_to_dict(&hists[0]);
+        if (hist == NULL || PyDict_SetItemString(result, "histogram", hist) < 0) {
+            Py_XDECREF(hist);
+            Py_CLEAR(result);
+            goto done;
+        }
+        Py_DECREF(hist);
+    }
+    if (pct_list != NULL) {
+        PyObject* pcts = PyDict_New();
+        for (Py_ssize_t i = 0; pcts != NULL && i < PyList_Size(pct_list); i++) {
+            PyObject* key = PyList_GetItem(pct_list, i);
+            double q = PyFloat_AsDouble(key);
+            PyObject* value = PyFloat_FromDouble(field_histogram_percentile(&hists[1], &m, q));
+            if (value == NULL || PyDict_SetItem(pcts, key, value) < 0) {
+                Py_XDECREF(value);
+                Py_CLEAR(pcts);
+                break;
+            }
+            Py_DECREF(value);
+        }
+        if (pcts == NULL || PyDict_SetItemString(result, "percentiles", pcts) < 0) {
+            Py_XDECREF(pcts);
+            Py_CLEAR(result);
+            goto done;
+        }
+        Py_DECREF(pcts);
+    }
+
+done:
+    free(hists[0].counts);
+    free(hists[1].counts);
+    Py_XDECREF(pct_list);
+    return result;
+}
+
+static double relative_error(double err, double ref) {
+    if (ref > 0.0) {
+        return err / ref;
+    }
+    return err == 0.0 ? 0.0 : INFINITY;
+}
+
+// Result dict of field_compare(); nx > 0 adds the (i, j) of the max error
+static PyObject* comparison_to_dict(const field_comparison* cmp, Py_ssize_t nx) {
+    double l2 = sqrt(cmp->l2_sq);
+    PyObject* result = Py_BuildValue(
+        "{s:n,s:n,s:n,s:d,s:d,s:d,s:d,s:d,s:d,s:K,s:d}",
+        "count", (Py_ssize_t)cmp->count,
+        "nan_mismatch", (Py_ssize_t)cmp->nan_mismatch,
+        "exact", (Py_ssize_t)cmp->exact,
+        "l1", cmp->l1,
+        "l2", l2,
+        "linf", cmp->linf,
+        "rel_l1", relative_error(cmp->l1, cmp->ref_l1),
+        "rel_l2", relative_error(l2, sqrt(cmp->ref_l2_sq)),
+        "rel_linf", relative_error(cmp->linf, cmp->ref_linf),
+        "max_ulp", (unsigned long long)cmp->max_ulp,
+        "mean_ulp", cmp->count > 0 ? cmp->ulp_sum / (double)cmp->count : 0.0);
+    if (result == NULL) {
+        return NULL;
+    }
+
+    // No comparable pairs leaves the location as None
+    int rc = 0;
+    if (cmp->count == 0) {
+        rc = PyDict_SetItemString(result, "max_index", Py_None);
+        if (rc == 0 && nx > 0) {
+            rc = PyDict_SetItemString(result, "max_location", Py_None);
+        }
+    } else {
+        Py_ssize_t k = (Py_ssize_t)cmp->linf_index;
+        PyObject* index = PyLong_FromSsize_t(k);
+        rc = index != NULL ? PyDict_SetItemString(result, "max_index", index) : -1;
+        Py_XDECREF(index);
+        if (rc == 0 && nx > 0) {
+            PyObject* location = Py_BuildValue("(nn)", k % nx, k / nx);
+            rc = location != NULL ? PyDict_SetItemString(result, "max_location", location) : -1;
+            Py_XDECREF(location);
+        }
+    }
+    if (rc < 0) {
+        Py_DECREF(result);
+        return NULL;
+    }
+    return result;
 }
 
 /*
- * Write VTK vector output
+ * Compare a field against a reference in one parallel pass
  */
-static PyObject* write_vtk_vector(PyObject* self, PyObject* args, PyObject* kwds) {
+static PyObject* compare_fields_py(PyObject* self, PyObject* args, PyObject* kwds) {
     (void)self;
-    static const char* const kwlist[] = {"filename", "field_name", "u_data", "v_data", "nx", "ny",
-                                         "xmin", "xmax", "ymin", "ymax",
-                                         "w_data", "nz", "zmin", "zmax", NULL};
-    const char* filename;
-    const char* field_name;
-    PyObject* u_list;
-    PyObject* v_list;
-    PyObject* w_list = NULL;
-    size_t nx, ny;
-    size_t nz = 1;
-    double xmin, xmax, ymin, ymax;
-    double zmin = 0.0, zmax = 0.0;
+    static const char* const kwlist[] = {"a", "b", "nx", NULL};
+    PyObject *a_obj, *b_obj;
+    Py_ssize_t nx = 0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "ssOOnndddd|Ondd", (char**)kwlist,
-                                     &filename, &field_name, &u_list, &v_list,
-                                     &nx, &ny, &xmin, &xmax, &ymin, &ymax,
-                                     &w_list, &nz, &zmin, &zmax)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|n", (char**)kwlist, &a_obj, &b_obj, &nx)) {
         return NULL;
     }
-
-    // Validate lists
-    if (!PyList_Check(u_list) || !PyList_Check(v_list)) {
-        PyErr_SetString(PyExc_TypeError, "u_data and v_data must be lists");
+    if (nx < 0) {
+        PyErr_SetString(PyExc_ValueError, "nx must be non-negative");
         return NULL;
     }
-
-    // Treat None as no w_data
-    if (w_list == Py_None) {
-        w_list = NULL;
-    }
-
-    if (w_list != NULL && !PyList_Check(w_list)) {
-        PyErr_SetString(PyExc_TypeError, "w_data must be a list or None");
+    double_buffer a, b;
+    if (acquire_double_buffer(a_obj, 0, &a) < 0) {
         return NULL;
     }
-
-    size_t size = nx * ny * nz;
-    if ((size_t)PyList_Size(u_list) != size || (size_t)PyList_Size(v_list) != size) {
-        PyErr_SetString(PyExc_ValueError, "data list sizes must match nx*ny*nz");
+    if (acquire_double_buffer(b_obj, 0, &b) < 0) {
+        release_double_buffer(&a);
         return NULL;
     }
 
-    if (w_list != NULL && (size_t)PyList_Size(w_list) != size) {
-        PyErr_SetString(PyExc_ValueError, "w_data size must match nx*ny*nz");
-        return NULL;
-    }
+    PyObject* result = NULL;
+    if (a.count != b.count) {
+        PyErr_Format(PyExc_ValueError, "a and b must have the same size, got %zd and %zd",
+                     a.count, b.count);
+    } else if (nx > 0 && a.count % nx != 0) {
+        PyErr_Format(PyExc_ValueError, "size %zd is not a multiple of nx = %zd", a.count, nx);
+    } else {
+        field_comparison cmp;
+        Py_BEGIN_ALLOW_THREADS
+        field_compare(a.data, b.data, (size_t)a.count, &cmp);
+        Py_END_ALLOW_THREADS
+        result = comparison_to_dict(&cmp, nx);
+    }
+    release_double_buffer(&a);
+    release_double_buffer(&b);
+    return result;
+}
 
-    double* u_data = (double*)malloc(size * sizeof(double));
-    double* v_data = (double*)malloc(size * sizeof(double));
-    double* w_data = NULL;
-    if (w_list != NULL) {
-        w_data = (double*)malloc(size * sizeof(double));
-    }
+typedef struct {
+    double_buffer fields[3];  // u, v, p
+    Py_ssize_t nx;
+} flow_arrays;
 
-    if (u_data == NULL || v_data == NULL || (w_list != NULL && w_data == NULL)) {
-        free(u_data);
-        free(v_data);
-        free(w_data);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate data arrays");
-        return NULL;
+static void release_flow_arrays(flow_arrays* arrays) {
+    for (int f = 0; f < 3; f++) {
+        release_double_buffer(&arrays->fields[f]);
     }
+}
 
-    for (size_t i = 0; i < size; i++) {
-        PyObject* u_item = PyList_GetItem(u_list, i);
-        PyObject* v_item = PyList_GetItem(v_list, i);
-        if (u_item == NULL || v_item == NULL) {
-            free(u_data);
-            free(v_data);
-            free(w_data);
-            return NULL;
+// Borrow u, v and p of a Simulation, FieldSnapshot or {'u', 'v', 'p'[, 'nx']} dict
+static int acquire_flow_arrays(PyObject* obj, const char* label, flow_arrays* arrays) {
+    static const char* const names[3] = {"u", "v", "p"};
+    memset(arrays, 0, sizeof(*arrays));
+
+    if (PyObject_TypeCheck(obj, (PyTypeObject*)g_simulation_type)) {
+        SimulationObject* sim = (SimulationObject*)obj;
+        if (simulation_check_idle(sim) < 0) {
+            return -1;
         }
-        u_data[i] = PyFloat_AsDouble(u_item);
-        v_data[i] = PyFloat_AsDouble(v_item);
-        if (w_list != NULL) {
-            PyObject* w_item = PyList_GetItem(w_list, i);
-            if (w_item == NULL) {
-                free(u_data);
-                free(v_data);
-                free(w_data);
-                return NULL;
-            }
-            w_data[i] = PyFloat_AsDouble(w_item);
+        double* data[3] = {sim->sim->field->u, sim->sim->field->v, sim->sim->field->p};
+        for (int f = 0; f < 3; f++) {
+            Py_INCREF(obj);
+            adopt_double_buffer(&arrays->fields[f], obj, (char*)data[f],
+                                (Py_ssize_t)(sim->nx * sim->ny * sizeof(double)), 1, 0);
         }
-        if (PyErr_Occurred()) {
-            free(u_data);
-            free(v_data);
-            free(w_data);
-            return NULL;
+        arrays->nx = (Py_ssize_t)sim->nx;
+        return 0;
+    }
+    if (PyObject_TypeCheck(obj, (PyTypeObject*)g_field_snapshot_type)) {
+        FieldSnapshotObject* snap = (FieldSnapshotObject*)obj;
+        const double_buffer* src[3] = {&snap->u, &snap->v, &snap->p};
+        for (int f = 0; f < 3; f++) {
+            arrays->fields[f] = *src[f];
+            arrays->fields[f].copied = 0;
+            Py_INCREF(arrays->fields[f].owner);
         }
+        arrays->nx = snap->nx;
+        return 0;
     }
-
-    write_vtk_vector_output(filename, field_name, u_data, v_data, w_data,
-                            nx, ny, nz, xmin, xmax, ymin, ymax, zmin, zmax);
-    free(u_data);
-    free(v_data);
-    free(w_data);
-
-    Py_RETURN_NONE;
+    if (!PyDict_Check(obj)) {
+        PyErr_Format(PyExc_TypeError, "%s must be a Simulation, FieldSnapshot or dict with "
+                     "'u', 'v' and 'p'", label);
+        return -1;
+    }
+    for (int f = 0; f < 3; f++) {
+        PyObject* item = PyDict_GetItemString(obj, names[f]);
+        if (item == NULL) {
+            PyErr_Format(PyExc_KeyError, "%s has no '%s' entry", label, names[f]);
+            release_flow_arrays(arrays);
+            return -1;
+        }
+        if (acquire_double_buffer(item, 0, &arrays->fields[f]) < 0) {
+            release_flow_arrays(arrays);
+            return -1;
+        }
+    }
+    PyObject* nx = PyDict_GetItemString(obj, "nx");
+    if (nx != NULL) {
+        arrays->nx = PyLong_AsSsize_t(nx);
+        if (arrays->nx < 0) {
+            if (!PyErr_Occurred()) {
+                PyErr_Format(PyExc_ValueError, "%s['nx'] must be non-negative", label);
+            }
+            release_flow_arrays(arrays);
+            return -1;
+        }
+    }
+    return 0;
 }
 
 /*
- * Write CSV timeseries data
+ * Compare u, v and p of two flow states
  */
-static PyObject* write_csv_timeseries_py(PyObject* self, PyObject* args, PyObject* kwds) {
+static PyObject* compare_flow_fields_py(PyObject* self, PyObject* args) {
     (void)self;
-    static char* kwlist[] = {"filename", "step", "time", "u_data", "v_data", "p_data",
-                             "nx", "ny", "dt", "iterations", "create_new", NULL};
-    const char* filename;
-    int step;
-    double time;
-    PyObject* u_list;
-    PyObject* v_list;
-    PyObject* p_list;
-    size_t nx, ny;
-    double dt;
-    int iterations;
-    int create_new = 0;
+    static const char* const names[3] = {"u", "v", "p"};
+    PyObject *a_obj, *b_obj;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "sidOOOnndip", kwlist,
-                                     &filename, &step, &time, &u_list, &v_list, &p_list,
-                                     &nx, &ny, &dt, &iterations, &create_new)) {
+    if (!PyArg_ParseTuple(args, "OO", &a_obj, &b_obj)) {
         return NULL;
     }
-
-    // Validate lists
-    if (!PyList_Check(u_list) || !PyList_Check(v_list) || !PyList_Check(p_list)) {
-        PyErr_SetString(PyExc_TypeError, "u_data, v_data, and p_data must be lists");
+    flow_arrays a, b;
+    if (acquire_flow_arrays(a_obj, "a", &a) < 0) {
         return NULL;
     }
-
-    size_t size = nx * ny;
-    if ((size_t)PyList_Size(u_list) != size || (size_t)PyList_Size(v_list) != size ||
-        (size_t)PyList_Size(p_list) != size) {
-        PyErr_SetString(PyExc_ValueError, "data list sizes must match nx*ny");
+    if (acquire_flow_arrays(b_obj, "b", &b) < 0) {
+        release_flow_arrays(&a);
         return NULL;
     }
 
-    // Allocate and populate flow field
-    flow_field* field = flow_field_create(nx, ny, 1);
-    if (field == NULL) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate flow field");
-        return NULL;
+    PyObject* result = NULL;
+    Py_ssize_t nx = a.nx > 0 ? a.nx : b.nx;
+    Py_ssize_t count = a.fields[0].count;
+    int ok = 1;
+    for (int f = 0; f < 3; f++) {
+        if (a.fields[f].count != count || b.fields[f].count != count) {
+            PyErr_SetString(PyExc_ValueError, "u, v and p of a and b must all have the same size");
+            ok = 0;
+            break;
+        }
+    }
+    if (ok && ((a.nx > 0 && b.nx > 0 && a.nx != b.nx) || (nx > 0 && count % nx != 0))) {
+        PyErr_SetString(PyExc_ValueError, "a and b have different grid dimensions");
+        ok = 0;
     }
 
-    for (size_t i = 0; i < size; i++) {
-        PyObject* u_item = PyList_GetItem(u_list, i);
-        PyObject* v_item = PyList_GetItem(v_list, i);
-        PyObject* p_item = PyList_GetItem(p_list, i);
-        if (u_item == NULL || v_item == NULL || p_item == NULL) {
-            flow_field_destroy(field);
-            return NULL;
+    // Simulation sources lend their live fields; keep them from stepping
+    // during the compare. Acquiring b may have run Python code, so check again.
+    SimulationObject* sims[2] = {NULL, NULL};
+    PyObject* sources[2] = {a_obj, b_obj};
+    for (int k = 0; ok && k < 2; k++) {
+        if (PyObject_TypeCheck(sources[k], (PyTypeObject*)g_simulation_type)) {
+            sims[k] = (SimulationObject*)sources[k];
+            ok = simulation_check_idle(sims[k]) == 0;
         }
-        field->u[i] = PyFloat_AsDouble(u_item);
-        field->v[i] = PyFloat_AsDouble(v_item);
-        field->p[i] = PyFloat_AsDouble(p_item);
-        if (PyErr_Occurred()) {
-            flow_field_destroy(field);
-            return NULL;
+    }
+
+    if (ok) {
+        field_comparison cmp[3];
+        for (int k = 0; k < 2; k++) {
+            if (sims[k] != NULL) {
+                sims[k]->busy = 1;
+            }
+        }
+        Py_BEGIN_ALLOW_THREADS
+        for (int f = 0; f < 3; f++) {
+            field_compare(a.fields[f].data, b.fields[f].data, (size_t)count, &cmp[f]);
+        }
+        Py_END_ALLOW_THREADS
+        for (int k = 0; k < 2; k++) {
+            if (sims[k] != NULL) {
+                sims[k]->busy = 0;
+            }
+        }
+        result = PyDict_New();
+        for (int f = 0; result != NULL && f < 3; f++) {
+            PyObject* entry = comparison_to_dict(&cmp[f], nx);
+            if (entry == NULL || PyDict_SetItemString(result, names[f], entry) < 0) {
+                Py_CLEAR(result);
+            }
+            Py_XDECREF(entry);
         }
     }
+    release_flow_arrays(&a);
+    release_flow_arrays(&b);
+    return result;
+}
 
-    ns_solver_params_t params = ns_solver_params_default();
-    params.dt = dt;
+// ============================================================================
+// Streaming CSV Timeseries Writer
+// ============================================================================
 
-    ns_solver_stats_t stats = ns_solver_stats_default();
-    stats.iterations = iterations;
+typedef struct {
+    PyObject_HEAD
+    csv_stream stream;
+    char* filename;
+    int busy;  // Set while a call runs without the GIL
+} CsvWriterObject;
 
-    // New API: write_csv_timeseries takes derived_fields* (can be NULL)
-    write_csv_timeseries(filename, step, time, field, NULL, &params, &stats, nx, ny, create_new);
+static PyObject* g_csv_writer_type = NULL;
 
-    flow_field_destroy(field);
-    Py_RETURN_NONE;
+static int csv_check_open(CsvWriterObject* self) {
+    if (self->stream.file == NULL) {
+        PyErr_SetString(PyExc_ValueError, "CsvWriter is closed");
+        return -1;
+    }
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "CsvWriter is in use by another thread");
+        return -1;
+    }
+    return 0;
 }
 
-/*
- * Get last CFD error
- */
-static PyObject* get_last_error(PyObject* self, PyObject* args) {
-    (void)self;
-    (void)args;
+static PyObject* CsvWriter_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static const char* const kwlist[] = {"filename", "append", "buffer_size", "flush_every",
+                                         "precision", NULL};
+    const char* filename;
+    int append = 0;
+    Py_ssize_t buffer_size = 1 << 20;
+    Py_ssize_t flush_every = 0;
+    int precision = 0;
 
-    const char* error = cfd_get_last_error();
-    if (error && error[0] != '\0') {
-        PyObject* result = PyUnicode_FromString(error);
-        if (result == NULL) {
-            return NULL;  // PyUnicode_FromString sets exception on failure
-        }
-        return result;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|pnni", (char**)kwlist, &filename, &append,
+                                     &buffer_size, &flush_every, &precision)) {
+        return NULL;
     }
-    Py_RETURN_NONE;
+    if (check_precision(precision) < 0) {
+        return NULL;
+    }
+    if (buffer_size < 256) {
+        PyErr_SetString(PyExc_ValueError, "buffer_size must be at least 256 bytes");
+        return NULL;
+    }
+    if (flush_every < 0) {
+        PyErr_SetString(PyExc_ValueError, "flush_every must be non-negative");
+        return NULL;
+    }
+    PyObject* obj = alloc_instance((PyObject*)type);
+    if (obj == NULL) {
+        return NULL;
+    }
+    CsvWriterObject* self = (CsvWriterObject*)obj;
+    self->filename = copy_string(filename);
+    if (self->filename == NULL) {
+        Py_DECREF(obj);
+        return PyErr_NoMemory();
+    }
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = csv_stream_open(&self->stream, filename, append, (size_t)buffer_size,
+                         (size_t)flush_every, precision);
+    Py_END_ALLOW_THREADS
+    if (rc < 0) {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
+        Py_DECREF(obj);
+        return NULL;
+    }
+    return obj;
 }
 
-/*
- * Get last CFD status code
- */
-static PyObject* get_last_status(PyObject* self, PyObject* args) {
-    (void)self;
-    (void)args;
+static void CsvWriter_dealloc(PyObject* obj) {
+    CsvWriterObject* self = (CsvWriterObject*)obj;
+    // A running call holds a reference, so busy is never set here
+    csv_stream_close(&self->stream);
+    free(self->filename);
+    dealloc_instance(obj);
+}
 
-    cfd_status_t status = cfd_get_last_status();
-    PyObject* result = PyLong_FromLong((long)status);
-    if (result == NULL) {
-        return NULL;  // PyLong_FromLong sets MemoryError on failure
+// Value of an optional keyword, or `fallback` when it was not given
+static int csv_optional(PyObject* obj, const char* name, double fallback, double* out) {
+    if (obj == NULL || obj == Py_None) {
+        *out = fallback;
+        return 0;
     }
-    return result;
+    *out = PyFloat_AsDouble(obj);
+    if (*out == -1.0 && PyErr_Occurred()) {
+        PyErr_Format(PyExc_TypeError, "%s must be a number", name);
+        return -1;
+    }
+    return 0;
 }
 
-/*
- * Clear CFD error state
- */
-static PyObject* clear_error(PyObject* self, PyObject* args) {
-    (void)self;
-    (void)args;
+static PyObject* CsvWriter_write(PyObject* obj, PyObject* args, PyObject* kwds) {
+    CsvWriterObject* self = (CsvWriterObject*)obj;
+    static const char* const kwlist[] = {"source", "step", "time", "dt", "iterations", NULL};
+    PyObject* source;
+    PyObject* step_obj = Py_None;
+    PyObject* time_obj = Py_None;
+    PyObject* dt_obj = Py_None;
+    PyObject* iterations_obj = Py_None;
 
-    cfd_clear_error();
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OOOO", (char**)kwlist, &source, &step_obj,
+                                     &time_obj, &dt_obj, &iterations_obj)) {
+        return NULL;
+    }
+    flow_arrays arrays;
+    if (csv_check_open(self) < 0 || acquire_flow_arrays(source, "source", &arrays) < 0) {
+        return NULL;
+    }
+
+    // Defaults come from the source when it knows them
+    SimulationObject* sim = NULL;
+    double step_default = -1.0, time_default = NAN, dt_default = 0.0, iterations_default = 0.0;
+    if (PyObject_TypeCheck(source, (PyTypeObject*)g_simulation_type)) {
+        sim = (SimulationObject*)source;
+        const ns_solver_stats_t* stats = simulation_get_stats(sim->sim);
+        step_default = (double)sim->step_count;
+        time_default = sim->time;
+        dt_default = sim->sim->params.dt;
+        iterations_default = stats != NULL ? (double)stats->iterations : 0.0;
+    } else if (PyObject_TypeCheck(source, (PyTypeObject*)g_field_snapshot_type)) {
+        const FieldSnapshotObject* snap = (const FieldSnapshotObject*)source;
+        step_default = (double)snap->step;
+        time_default = snap->time;
+    }
+    double step, iterations;
+    csv_row row;
+    if ((sim != NULL && simulation_check_idle(sim) < 0) ||
+        csv_optional(step_obj, "step", step_default, &step) < 0 ||
+        csv_optional(time_obj, "time", time_default, &row.time) < 0 ||
+        csv_optional(dt_obj, "dt", dt_default, &row.dt) < 0 ||
+        csv_optional(iterations_obj, "iterations", iterations_default, &iterations) < 0) {
+        release_flow_arrays(&arrays);
+        return NULL;
+    }
+    Py_ssize_t count = arrays.fields[0].count;
+    if (step < 0.0 || isnan(row.time)) {
+        PyErr_SetString(PyExc_ValueError, "step and time are required for dict sources");
+    } else if (arrays.fields[1].count != count || arrays.fields[2].count != count) {
+        PyErr_SetString(PyExc_ValueError, "u, v and p must have the same length");
+    }
+    if (PyErr_Occurred()) {
+        release_flow_arrays(&arrays);
+        return NULL;
+    }
+    row.step = (size_t)step;
+    row.iterations = (int)iterations;
+
+    if (sim != NULL) {
+        sim->busy = 1;
+    }
+    self->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    csv_row_compute(&row, arrays.fields[0].data, arrays.fields[1].data, arrays.fields[2].data,
+                    (size_t)count);
+    Py_END_ALLOW_THREADS
+    self->busy = 0;
+    if (sim != NULL) {
+        sim->busy = 0;
+    }
+    release_flow_arrays(&arrays);
+
+    if (csv_stream_write(&self->stream, &row) < 0) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, self->filename);
+    }
     Py_RETURN_NONE;
 }
 
-/*
- * Get error string for status code
- */
-static PyObject* get_error_string(PyObject* self, PyObject* args) {
-    (void)self;
-    int status;
-
-    if (!PyArg_ParseTuple(args, "i", &status)) {
+static PyObject* CsvWriter_flush(PyObject* obj, PyObject* args) {
+    (void)args;
+    CsvWriterObject* self = (CsvWriterObject*)obj;
+    if (csv_check_open(self) < 0) {
         return NULL;
     }
-
-    const char* str = cfd_get_error_string((cfd_status_t)status);
-    PyObject* result = PyUnicode_FromString(str);
-    if (result == NULL) {
-        return NULL;  // PyUnicode_FromString sets exception on failure
+    int rc;
+    self->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    rc = csv_stream_flush(&self->stream);
+    Py_END_ALLOW_THREADS
+    self->busy = 0;
+    if (rc < 0) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, self->filename);
     }
-    return result;
+    Py_RETURN_NONE;
 }
 
-/* ============================================================================
- * BOUNDARY CONDITIONS API
- * ============================================================================ */
+static PyObject* CsvWriter_close(PyObject* obj, PyObject* args) {
+    (void)args;
+    CsvWriterObject* self = (CsvWriterObject*)obj;
+    if (self->stream.file == NULL) {
+        Py_RETURN_NONE;
+    }
+    if (csv_check_open(self) < 0) {
+        return NULL;
+    }
+    int rc;
+    self->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    rc = csv_stream_close(&self->stream);
+    Py_END_ALLOW_THREADS
+    self->busy = 0;
+    if (rc < 0) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, self->filename);
+    }
+    Py_RETURN_NONE;
+}
 
-/*
- * Get current BC backend
- */
-static PyObject* bc_get_backend_py(PyObject* self, PyObject* args) {
-    (void)self;
+static PyObject* CsvWriter_enter(PyObject* obj, PyObject* args) {
     (void)args;
-    PyObject* result = PyLong_FromLong((long)bc_get_backend());
-    if (result == NULL) {
-        return NULL;  // PyLong_FromLong sets MemoryError on failure
+    if (csv_check_open((CsvWriterObject*)obj) < 0) {
+        return NULL;
     }
-    return result;
+    Py_INCREF(obj);
+    return obj;
 }
 
-/*
- * Get BC backend name as string
- */
-static PyObject* bc_get_backend_name_py(PyObject* self, PyObject* args) {
-    (void)self;
+static PyObject* CsvWriter_exit(PyObject* obj, PyObject* args) {
     (void)args;
-    PyObject* result = PyUnicode_FromString(bc_get_backend_name());
+    PyObject* result = CsvWriter_close(obj, NULL);
     if (result == NULL) {
-        return NULL;  // PyUnicode_FromString sets exception on failure
+        return NULL;
     }
-    return result;
+    Py_DECREF(result);
+    Py_RETURN_FALSE;
 }
 
-/*
- * Set BC backend
- */
-static PyObject* bc_set_backend_py(PyObject* self, PyObject* args) {
-    (void)self;
-    int backend;
+static PyObject* CsvWriter_get_rows(PyObject* obj, void* closure) {
+    (void)closure;
+    return PyLong_FromSize_t(((CsvWriterObject*)obj)->stream.rows);
+}
 
-    if (!PyArg_ParseTuple(args, "i", &backend)) {
-        return NULL;
-    }
+static PyObject* CsvWriter_get_closed(PyObject* obj, void* closure) {
+    (void)closure;
+    return PyBool_FromLong(((CsvWriterObject*)obj)->stream.file == NULL);
+}
 
-    bool success = bc_set_backend((bc_backend_t)backend);
-    return PyBool_FromLong(success);
+static PyObject* CsvWriter_get_filename(PyObject* obj, void* closure) {
+    (void)closure;
+    return PyUnicode_FromString(((CsvWriterObject*)obj)->filename);
 }
 
-/*
- * Check if BC backend is available
- */
-static PyObject* bc_backend_available_py(PyObject* self, PyObject* args) {
-    (void)self;
-    int backend;
+static PyGetSetDef CsvWriter_getset[] = {
+    {"rows", CsvWriter_get_rows, NULL, "Rows written since the file was opened", NULL},
+    {"closed", CsvWriter_get_closed, NULL, "True after close()", NULL},
+    {"filename", CsvWriter_get_filename, NULL, "Output file", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
 
-    if (!PyArg_ParseTuple(args, "i", &backend)) {
-        return NULL;
-    }
+static PyMethodDef CsvWriter_methods[] = {
+    {"write", (PyCFunction)(void(*)(void))CsvWriter_write, METH_VARARGS | METH_KEYWORDS,
+     "Append one row computed from u, v and p without copying them.\n\n"
+     "Statistics are computed in one OpenMP pass with the GIL released. For a\n"
+     "Simulation, step, time, dt and iterations default to its live values;\n"
+     "for a FieldSnapshot, step and time default to the snapshot's.\n\n"
+     "Args:\n"
+     "    source: Simulation, FieldSnapshot or dict with 'u', 'v' and 'p'\n"
+     "        (lists, NumPy float64 arrays or float64 buffers)\n"
+     "    step (int, optional): Step number (required for dicts)\n"
+     "    time (float, optional): Simulation time (required for dicts)\n"
+     "    dt (float, optional): Time step size (default: 0.0 for dicts)\n"
+     "    iterations (int, optional): Solver iterations (default: 0 for dicts)"},
+    {"flush", CsvWriter_flush, METH_NOARGS, "Write buffered rows to the file."},
+    {"close", CsvWriter_close, METH_NOARGS,
+     "Flush and close the file. Further calls do nothing.\n\n"
+     "Raises:\n"
+     "    RuntimeError: While another thread is inside write() or flush()"},
+    {"__enter__", CsvWriter_enter, METH_NOARGS, NULL},
+    {"__exit__", CsvWriter_exit, METH_VARARGS, NULL},
+    {NULL, NULL, 0, NULL}
+};
 
-    bool available = bc_backend_available((bc_backend_t)backend);
-    return PyBool_FromLong(available);
-}
+static PyType_Slot CsvWriter_slots[] = {
+    {Py_tp_doc, (void*)
+     "CsvWriter(filename, append=False, buffer_size=1048576, flush_every=0, precision=0)\n\n"
+     "CSV timeseries log that keeps its file open for the whole run.\n\n"
+     "Rows go into a user-space buffer of buffer_size bytes, which reaches the\n"
+     "file when it fills, every flush_every rows (0 disables), on flush() and\n"
+     "on close(). Columns are step, time, dt, max_u, max_v, max_p (largest\n"
+     "magnitudes), avg_u, avg_v, avg_p and iterations. Values are written with\n"
+     "the shortest digits that read back exactly, or with precision significant\n"
+     "digits when it is non-zero. The header is skipped when appending to a\n"
+     "non-empty file. Use as a context manager or call close() to finish."},
+    {Py_tp_new, (void*)CsvWriter_new},
+    {Py_tp_dealloc, (void*)CsvWriter_dealloc},
+    {Py_tp_getset, CsvWriter_getset},
+    {Py_tp_methods, CsvWriter_methods},
+    {0, NULL}
+};
 
-/*
- * ========================================
- * Solver Backend Availability API (v0.1.6)
- * ========================================
- */
+static PyType_Spec CsvWriter_spec = {
+    "cfd_python.CsvWriter",
+    sizeof(CsvWriterObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    CsvWriter_slots
+};
 
-/*
- * Check if a solver backend is available at runtime
- */
-static PyObject* backend_is_available_py(PyObject* self, PyObject* args) {
-    (void)self;
-    int backend;
+// ============================================================================
+// Field Compression
+// ============================================================================
 
-    if (!PyArg_ParseTuple(args, "i", &backend)) {
-        return NULL;
+// Check a max_error argument; it must be usable as an absolute bound too
+static int check_max_error(double max_error) {
+    if (!(max_error >= 0.0) || !isfinite(2.0 * max_error)) {
+        PyErr_SetString(PyExc_ValueError, "max_error must be a non-negative finite number");
+        return -1;
     }
-
-    int available = cfd_backend_is_available((ns_solver_backend_t)backend);
-    return PyBool_FromLong(available);
+    return 0;
 }
 
 /*
- * Get human-readable name for a solver backend
+ * Compress one float64 field with the in-tree codec, losslessly or within
+ * an error bound
  */
-static PyObject* backend_get_name_py(PyObject* self, PyObject* args) {
+static PyObject* compress_field_py(PyObject* self, PyObject* args, PyObject* kwds) {
     (void)self;
-    int backend;
+    static const char* const kwlist[] = {"data", "max_error", "relative", NULL};
+    PyObject* data_obj;
+    double max_error = 0.0;
+    int relative = 0;
 
-    if (!PyArg_ParseTuple(args, "i", &backend)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|dp", (char**)kwlist, &data_obj, &max_error,
+                                     &relative)) {
         return NULL;
     }
-
-    const char* name = cfd_backend_get_name((ns_solver_backend_t)backend);
-    if (name == NULL) {
-        Py_RETURN_NONE;
+    if (check_max_error(max_error) < 0) {
+        return NULL;
     }
-    PyObject* result = PyUnicode_FromString(name);
-    if (result == NULL) {
-        return NULL;  // PyUnicode_FromString sets exception on failure
+    double_buffer data;
+    if (acquire_double_buffer(data_obj, 0, &data) < 0) {
+        return NULL;
     }
-    return result;
+    size_t bound = field_codec_bound((size_t)data.count);
+    PyObject* out = PyByteArray_FromStringAndSize(NULL, (Py_ssize_t)bound);
+    if (out == NULL) {
+        release_double_buffer(&data);
+        return NULL;
+    }
+    char* dst = PyByteArray_AsString(out);
+    size_t size = 0;
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    if (relative && max_error > 0.0) {
+        max_error = field_codec_relative_bound(data.data, (size_t)data.count, max_error);
+    }
+    rc = field_codec_encode(data.data, (size_t)data.count, max_error, dst, &size);
+    Py_END_ALLOW_THREADS
+    release_double_buffer(&data);
+    if (rc < 0) {
+        Py_DECREF(out);
+        return PyErr_NoMemory();
+    }
+    if (PyByteArray_Resize(out, (Py_ssize_t)size) < 0) {
+        Py_DECREF(out);
+        return NULL;
+    }
+    return out;
 }
 
 /*
- * Get list of solvers for a specific backend
+ * Decode the output of compress_field() into a new or caller-provided array
  */
-static PyObject* list_solvers_by_backend_py(PyObject* self, PyObject* args) {
+static PyObject* decompress_field_py(PyObject* self, PyObject* args, PyObject* kwds) {
     (void)self;
-    int backend;
+    static const char* const kwlist[] = {"data", "out", NULL};
+    PyObject* data_obj;
+    PyObject* out_obj = Py_None;
 
-    if (!PyArg_ParseTuple(args, "i", &backend)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", (char**)kwlist, &data_obj, &out_obj)) {
         return NULL;
     }
-
-    if (g_registry == NULL) {
-        PyErr_SetString(PyExc_RuntimeError, "Solver registry not initialized");
-        return NULL;
+    // bytes and bytearray are read in place; other buffers are copied once
+    PyObject* blob;
+    if (PyBytes_Check(data_obj) || PyByteArray_Check(data_obj)) {
+        Py_INCREF(data_obj);
+        blob = data_obj;
+    } else {
+        blob = PyBytes_FromObject(data_obj);
+        if (blob == NULL) {
+            return NULL;
+        }
     }
-
-    // First, get the count
-    int count = cfd_registry_list_by_backend(g_registry, (ns_solver_backend_t)backend, NULL, 0);
-    if (count <= 0) {
-        return PyList_New(0);  // Return empty list
+    const char* src = PyBytes_Check(blob) ? PyBytes_AsString(blob) : PyByteArray_AsString(blob);
+    size_t size = (size_t)(PyBytes_Check(blob) ? PyBytes_Size(blob) : PyByteArray_Size(blob));
+    size_t count;
+    if (field_codec_info(src, size, &count, NULL) < 0) {
+        Py_DECREF(blob);
+        PyErr_SetString(PyExc_ValueError, "data is not a compressed field");
+        return NULL;
+    }
+
+    PyObject* result;
+    double* dst;
+    double_buffer out;
+    memset(&out, 0, sizeof(out));
+    if (out_obj == Py_None) {
+        result = new_double_array((Py_ssize_t)count, &dst);
+    } else if (acquire_double_buffer(out_obj, 1, &out) < 0) {
+        result = NULL;
+    } else if ((size_t)out.count != count) {
+        PyErr_Format(PyExc_ValueError, "out must have %zd elements", (Py_ssize_t)count);
+        release_double_buffer(&out);
+        result = NULL;
+    } else {
+        Py_INCREF(out_obj);
+        result = out_obj;
+        dst = out.data;
+    }
+    if (result == NULL) {
+        Py_DECREF(blob);
+        return NULL;
     }
 
-    // Allocate array for names
-    const char** names = (const char**)malloc(count * sizeof(const char*));
-    if (names == NULL) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate names array");
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = field_codec_decode(src, size, dst, count);
+    Py_END_ALLOW_THREADS
+    release_double_buffer(&out);
+    Py_DECREF(blob);
+    if (rc < 0) {
+        Py_DECREF(result);
+        if (errno == ENOMEM) {
+            return PyErr_NoMemory();
+        }
+        PyErr_SetString(PyExc_ValueError, "compressed field is corrupt");
         return NULL;
     }
+    return result;
+}
 
-    // Get the actual names
-    int actual_count = cfd_registry_list_by_backend(g_registry, (ns_solver_backend_t)backend, names, count);
+// ============================================================================
+// Memory-Mapped Snapshot Store
+// ============================================================================
 
-    // Build Python list
-    PyObject* result = PyList_New(actual_count);
-    if (result == NULL) {
-        free(names);
-        return NULL;
+typedef struct {
+    PyObject_HEAD
+    cfd_store_writer writer;
+    int codec;  // CFD_STORE_RAW, CFD_STORE_LOSSLESS or CFD_STORE_LOSSY
+    double max_error;
+    int relative;  // max_error is a fraction of each field's range
+    char* filename;
+    int busy;  // Set while a call uses the file without the GIL
+} SnapshotWriterObject;
+
+typedef struct {
+    PyObject_HEAD
+    PyObject* mapping;  // Capsule owning the cfd_store_map; shared with every snapshot
+    char* filename;
+} SnapshotStoreObject;
+
+static PyObject* g_snapshot_writer_type = NULL;
+static PyObject* g_snapshot_store_type = NULL;
+
+static PyObject* raise_store_error(const char* filename) {
+    if (errno == ENOSYS) {
+        PyErr_SetString(PyExc_NotImplementedError,
+                        "Memory-mapped snapshot stores are not supported on this platform");
+    } else if (errno == EINVAL) {
+        PyErr_Format(PyExc_ValueError, "'%s' is not a valid snapshot store", filename);
+    } else {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
     }
+    return NULL;
+}
 
-    for (int i = 0; i < actual_count; i++) {
-        PyObject* name = PyUnicode_FromString(names[i]);
-        if (name == NULL) {
-            Py_DECREF(result);
-            free(names);
-            return NULL;
-        }
-        if (PyList_SetItem(result, i, name) < 0) {  // Steals reference on success
-            Py_DECREF(name);
-            Py_DECREF(result);
-            free(names);
-            return NULL;
-        }
+static int store_writer_check_open(SnapshotWriterObject* self) {
+    if (self->writer.file == NULL) {
+        PyErr_SetString(PyExc_ValueError, "SnapshotWriter is closed");
+        return -1;
     }
+    return 0;
+}
 
-    free(names);
-    return result;
+static int store_writer_check_idle(SnapshotWriterObject* self) {
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "SnapshotWriter is in use by another thread");
+        return -1;
+    }
+    return 0;
 }
 
-/*
- * Get list of all available backends
- */
-static PyObject* get_available_backends_py(PyObject* self, PyObject* args) {
-    (void)self;
-    (void)args;
+static PyObject* SnapshotWriter_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static const char* const kwlist[] = {"filename", "nx",        "ny",       "append",
+                                         "compress", "max_error", "relative", NULL};
+    const char* filename;
+    Py_ssize_t nx, ny;
+    int append = 0;
+    int compress = 0;
+    double max_error = 0.0;
+    int relative = 0;
 
-    PyObject* result = PyList_New(0);
-    if (result == NULL) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "snn|ppdp", (char**)kwlist, &filename, &nx,
+                                     &ny, &append, &compress, &max_error, &relative)) {
         return NULL;
     }
-
-    // Check each backend
-    ns_solver_backend_t backends[] = {
-        NS_SOLVER_BACKEND_SCALAR,
-        NS_SOLVER_BACKEND_SIMD,
-        NS_SOLVER_BACKEND_OMP,
-        NS_SOLVER_BACKEND_CUDA
-    };
-    int num_backends = sizeof(backends) / sizeof(backends[0]);
-
-    for (int i = 0; i < num_backends; i++) {
-        if (cfd_backend_is_available(backends[i])) {
-            const char* name = cfd_backend_get_name(backends[i]);
-            if (name != NULL) {
-                PyObject* name_obj = PyUnicode_FromString(name);
-                if (name_obj == NULL) {
-                    Py_DECREF(result);
-                    return NULL;
-                }
-                if (PyList_Append(result, name_obj) < 0) {
-                    Py_DECREF(name_obj);
-                    Py_DECREF(result);
-                    return NULL;
-                }
-                Py_DECREF(name_obj);
-            }
+    if (nx < 1 || ny < 1) {
+        PyErr_SetString(PyExc_ValueError, "nx and ny must be positive");
+        return NULL;
+    }
+    if (check_max_error(max_error) < 0) {
+        return NULL;
+    }
+    PyObject* obj = alloc_instance((PyObject*)type);
+    if (obj == NULL) {
+        return NULL;
+    }
+    SnapshotWriterObject* self = (SnapshotWriterObject*)obj;
+    self->codec = max_error > 0.0 ? CFD_STORE_LOSSY
+                  : compress      ? CFD_STORE_LOSSLESS
+                                  : CFD_STORE_RAW;
+    self->max_error = max_error;
+    self->relative = relative;
+    self->filename = copy_string(filename);
+    if (self->filename == NULL) {
+        Py_DECREF(obj);
+        return PyErr_NoMemory();
+    }
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = cfd_store_writer_open(&self->writer, filename, (size_t)nx, (size_t)ny, append);
+    Py_END_ALLOW_THREADS
+    if (rc < 0) {
+        if (errno == EINVAL) {
+            PyErr_Format(PyExc_ValueError,
+                         "'%s' is not a snapshot store with nx=%zd and ny=%zd", filename, nx, ny);
+        } else {
+            PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
         }
+        Py_DECREF(obj);
+        return NULL;
     }
+    return obj;
+}
 
-    return result;
+static void SnapshotWriter_dealloc(PyObject* obj) {
+    SnapshotWriterObject* self = (SnapshotWriterObject*)obj;
+    // A running call holds a reference, so busy is never set here
+    cfd_store_writer_close(&self->writer);
+    free(self->filename);
+    dealloc_instance(obj);
 }
 
-// ============================================================================
-// CPU Features API (Phase 6)
-// ============================================================================
+static PyObject* SnapshotWriter_write(PyObject* obj, PyObject* args, PyObject* kwds) {
+    SnapshotWriterObject* self = (SnapshotWriterObject*)obj;
+    static const char* const kwlist[] = {"source", "step", "time", NULL};
+    PyObject* source;
+    PyObject* step_obj = Py_None;
+    PyObject* time_obj = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OO", (char**)kwlist, &source, &step_obj,
+                                     &time_obj)) {
+        return NULL;
+    }
+    flow_arrays arrays;
+    if (store_writer_check_open(self) < 0 || store_writer_check_idle(self) < 0 ||
+        acquire_flow_arrays(source, "source", &arrays) < 0) {
+        return NULL;
+    }
+
+    // Defaults come from the source when it knows them
+    SimulationObject* sim = NULL;
+    double step_default = -1.0, time_default = NAN;
+    if (PyObject_TypeCheck(source, (PyTypeObject*)g_simulation_type)) {
+        sim = (SimulationObject*)source;
+        step_default = (double)sim->step_count;
+        time_default = sim->time;
+    } else if (PyObject_TypeCheck(source, (PyTypeObject*)g_field_snapshot_type)) {
+        const FieldSnapshotObject* snap = (const FieldSnapshotObject*)source;
+        step_default = (double)snap->step;
+        time_default = snap->time;
+    }
+    double step, time;
+    if ((sim != NULL && simulation_check_idle(sim) < 0) ||
+        csv_optional(step_obj, "step", step_default, &step) < 0 ||
+        csv_optional(time_obj, "time", time_default, &time) < 0) {
+        release_flow_arrays(&arrays);
+        return NULL;
+    }
+    Py_ssize_t count = (Py_ssize_t)(self->writer.nx * self->writer.ny);
+    if (step < 0.0 || isnan(time)) {
+        PyErr_SetString(PyExc_ValueError, "step and time are required for dict sources");
+    } else if (self->writer.num_records > 0 && (uint64_t)step <= self->writer.last_step) {
+        PyErr_Format(PyExc_ValueError, "step %llu is not after the last stored step %llu",
+                     (unsigned long long)step, (unsigned long long)self->writer.last_step);
+    } else if (arrays.fields[0].count != count || arrays.fields[1].count != count ||
+               arrays.fields[2].count != count ||
+               (arrays.nx != 0 && (uint64_t)arrays.nx != self->writer.nx)) {
+        PyErr_Format(PyExc_ValueError, "u, v and p must match the store's %zdx%zd grid",
+                     (Py_ssize_t)self->writer.nx, (Py_ssize_t)self->writer.ny);
+    }
+    if (PyErr_Occurred()) {
+        release_flow_arrays(&arrays);
+        return NULL;
+    }
+
+    int rc;
+    double bounds[CFD_STORE_NUM_FIELDS];
+    if (sim != NULL) {
+        sim->busy = 1;
+    }
+    self->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    for (int k = 0; k < CFD_STORE_NUM_FIELDS; k++) {
+        bounds[k] = self->relative ? field_codec_relative_bound(arrays.fields[k].data,
+                                                                (size_t)count, self->max_error)
+                                   : self->max_error;
+    }
+    rc = cfd_store_writer_append(&self->writer, (uint64_t)step, time, arrays.fields[0].data,
+                                 arrays.fields[1].data, arrays.fields[2].data, self->codec,
+                                 bounds);
+    Py_END_ALLOW_THREADS
+    self->busy = 0;
+    if (sim != NULL) {
+        sim->busy = 0;
+    }
+    release_flow_arrays(&arrays);
+    if (rc < 0) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, self->filename);
+    }
+    Py_RETURN_NONE;
+}
 
-/*
- * Get the detected SIMD architecture
- * Returns: int (SIMD_NONE=0, SIMD_AVX2=1, SIMD_NEON=2)
- */
-static PyObject* get_simd_arch_py(PyObject* self, PyObject* args) {
-    (void)self;
+static PyObject* SnapshotWriter_flush(PyObject* obj, PyObject* args) {
     (void)args;
-
-    cfd_simd_arch_t arch = cfd_detect_simd_arch();
-    PyObject* result = PyLong_FromLong((long)arch);
-    if (result == NULL) {
-        return NULL;  // PyLong_FromLong sets MemoryError on failure
+    SnapshotWriterObject* self = (SnapshotWriterObject*)obj;
+    if (store_writer_check_open(self) < 0 || store_writer_check_idle(self) < 0) {
+        return NULL;
     }
-    return result;
+    int rc;
+    self->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    rc = cfd_store_writer_flush(&self->writer);
+    Py_END_ALLOW_THREADS
+    self->busy = 0;
+    if (rc < 0) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, self->filename);
+    }
+    Py_RETURN_NONE;
 }
 
-/*
- * Get the name of the detected SIMD architecture
- * Returns: str ("avx2", "neon", or "none")
- */
-static PyObject* get_simd_name_py(PyObject* self, PyObject* args) {
-    (void)self;
+static PyObject* SnapshotWriter_close(PyObject* obj, PyObject* args) {
     (void)args;
-
-    const char* name = cfd_get_simd_name();
-    PyObject* result = PyUnicode_FromString(name);
-    if (result == NULL) {
-        return NULL;  // PyUnicode_FromString sets exception on failure
+    SnapshotWriterObject* self = (SnapshotWriterObject*)obj;
+    if (self->writer.file == NULL) {
+        Py_RETURN_NONE;
     }
-    return result;
+    if (store_writer_check_idle(self) < 0) {
+        return NULL;
+    }
+    int rc;
+    self->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    rc = cfd_store_writer_close(&self->writer);
+    Py_END_ALLOW_THREADS
+    self->busy = 0;
+    if (rc < 0) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, self->filename);
+    }
+    Py_RETURN_NONE;
 }
 
-/*
- * Check if AVX2 is available
- * Returns: bool
- */
-static PyObject* has_avx2_py(PyObject* self, PyObject* args) {
-    (void)self;
+static PyObject* SnapshotWriter_enter(PyObject* obj, PyObject* args) {
     (void)args;
-
-    bool available = cfd_has_avx2();
-    return PyBool_FromLong(available);
+    if (store_writer_check_open((SnapshotWriterObject*)obj) < 0) {
+        return NULL;
+    }
+    Py_INCREF(obj);
+    return obj;
 }
 
-/*
- * Check if ARM NEON is available
- * Returns: bool
- */
-static PyObject* has_neon_py(PyObject* self, PyObject* args) {
-    (void)self;
+static PyObject* SnapshotWriter_exit(PyObject* obj, PyObject* args) {
     (void)args;
+    PyObject* result = SnapshotWriter_close(obj, NULL);
+    if (result == NULL) {
+        return NULL;
+    }
+    Py_DECREF(result);
+    Py_RETURN_FALSE;
+}
+
+static Py_ssize_t SnapshotWriter_length(PyObject* obj) {
+    return (Py_ssize_t)((SnapshotWriterObject*)obj)->writer.num_records;
+}
 
-    bool available = cfd_has_neon();
-    return PyBool_FromLong(available);
+static PyObject* SnapshotWriter_get_closed(PyObject* obj, void* closure) {
+    (void)closure;
+    return PyBool_FromLong(((SnapshotWriterObject*)obj)->writer.file == NULL);
 }
 
-/*
- * Check if any SIMD is available (AVX2 or NEON)
- * Returns: bool
- */
-static PyObject* has_simd_py(PyObject* self, PyObject* args) {
-    (void)self;
-    (void)args;
+static PyObject* SnapshotWriter_get_filename(PyObject* obj, void* closure) {
+    (void)closure;
+    return PyUnicode_FromString(((SnapshotWriterObject*)obj)->filename);
+}
 
-    bool available = cfd_has_simd();
-    return PyBool_FromLong(available);
+static PyObject* SnapshotWriter_get_nx(PyObject* obj, void* closure) {
+    (void)closure;
+    return PyLong_FromUnsignedLongLong(((SnapshotWriterObject*)obj)->writer.nx);
 }
 
-// ============================================================================
-// Grid Initialization Variants (Phase 6)
-// ============================================================================
+static PyObject* SnapshotWriter_get_ny(PyObject* obj, void* closure) {
+    (void)closure;
+    return PyLong_FromUnsignedLongLong(((SnapshotWriterObject*)obj)->writer.ny);
+}
 
-/*
- * Create a grid with stretched (non-uniform) spacing
- * Args: nx, ny, xmin, xmax, ymin, ymax, beta
- * Returns: dict with grid information
- */
-static PyObject* create_grid_stretched_py(PyObject* self, PyObject* args) {
-    (void)self;
+static PyObject* SnapshotWriter_get_nbytes(PyObject* obj, void* closure) {
+    (void)closure;
+    return PyLong_FromUnsignedLongLong(((SnapshotWriterObject*)obj)->writer.data_end);
+}
 
-    long nx_signed, ny_signed;
-    double xmin, xmax, ymin, ymax, beta;
+static PyObject* SnapshotWriter_get_compression_ratio(PyObject* obj, void* closure) {
+    (void)closure;
+    const cfd_store_writer* writer = &((SnapshotWriterObject*)obj)->writer;
+    if (writer->stored_bytes == 0) {
+        return PyFloat_FromDouble(1.0);
+    }
+    return PyFloat_FromDouble((double)writer->raw_bytes / (double)writer->stored_bytes);
+}
 
-    if (!PyArg_ParseTuple(args, "llddddd", &nx_signed, &ny_signed,
-                          &xmin, &xmax, &ymin, &ymax, &beta)) {
-        return NULL;
+static PyGetSetDef SnapshotWriter_getset[] = {
+    {"closed", SnapshotWriter_get_closed, NULL, "True after close()", NULL},
+    {"compression_ratio", SnapshotWriter_get_compression_ratio, NULL,
+     "Raw over stored field bytes of the records written since opening", NULL},
+    {"nbytes", SnapshotWriter_get_nbytes, NULL, "Size of the store up to the last record", NULL},
+    {"filename", SnapshotWriter_get_filename, NULL, "Store file", NULL},
+    {"nx", SnapshotWriter_get_nx, NULL, "Grid points in x direction", NULL},
+    {"ny", SnapshotWriter_get_ny, NULL, "Grid points in y direction", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyMethodDef SnapshotWriter_methods[] = {
+    {"write", (PyCFunction)(void(*)(void))SnapshotWriter_write, METH_VARARGS | METH_KEYWORDS,
+     "Append u, v and p as one record without copying them first.\n\n"
+     "The record is written with the GIL released. For a Simulation, step and\n"
+     "time default to its live values; for a FieldSnapshot, to the snapshot's.\n\n"
+     "Args:\n"
+     "    source: Simulation, FieldSnapshot or dict with 'u', 'v' and 'p'\n"
+     "        (lists, NumPy float64 arrays or float64 buffers)\n"
+     "    step (int, optional): Step number, larger than any stored step\n"
+     "        (required for dicts)\n"
+     "    time (float, optional): Simulation time (required for dicts)"},
+    {"flush", SnapshotWriter_flush, METH_NOARGS,
+     "Write buffered data to the file so readers can map it."},
+    {"close", SnapshotWriter_close, METH_NOARGS,
+     "Flush and close the file. Further calls do nothing.\n\n"
+     "Raises:\n"
+     "    RuntimeError: While another thread is inside write() or flush()"},
+    {"__enter__", SnapshotWriter_enter, METH_NOARGS, NULL},
+    {"__exit__", SnapshotWriter_exit, METH_VARARGS, NULL},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot SnapshotWriter_slots[] = {
+    {Py_tp_doc, (void*)
+     "SnapshotWriter(filename, nx, ny, append=False, compress=False,\n"
+     "               max_error=0.0, relative=False)\n\n"
+     "Append-only writer of a snapshot store, read back with SnapshotStore.\n\n"
+     "The file has a fixed header followed by one record per write(): step,\n"
+     "time and offset, then u, v and p as raw float64 arrays each starting on\n"
+     "a 64-byte boundary. With compress=True the fields are stored losslessly\n"
+     "compressed (see compress_field()) and decoded on access instead of\n"
+     "being mapped. A positive max_error stores them lossy instead, each\n"
+     "value within max_error of the original, or within max_error times the\n"
+     "field's value range with relative=True (for example 1e-4), which is\n"
+     "meant for visualization output. Steps must be strictly increasing.\n"
+     "With append=True an existing store of the same grid is continued (a\n"
+     "missing file is created). len() is the number of stored records,\n"
+     "nbytes the file size they take and compression_ratio the size\n"
+     "reduction achieved. Use as a context manager or call close() to finish."},
+    {Py_tp_new, (void*)SnapshotWriter_new},
+    {Py_tp_dealloc, (void*)SnapshotWriter_dealloc},
+    {Py_tp_getset, SnapshotWriter_getset},
+    {Py_tp_methods, SnapshotWriter_methods},
+    {Py_mp_length, (void*)SnapshotWriter_length},
+    {0, NULL}
+};
+
+static PyType_Spec SnapshotWriter_spec = {
+    "cfd_python.SnapshotWriter",
+    sizeof(SnapshotWriterObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    SnapshotWriter_slots
+};
+
+static void store_capsule_destructor(PyObject* capsule) {
+    cfd_store_map* map = (cfd_store_map*)PyCapsule_GetPointer(capsule, "cfd_python.store_map");
+    if (map != NULL) {
+        cfd_store_map_close(map);
+        free(map);
     }
+}
 
-    if (nx_signed <= 0 || ny_signed <= 0) {
-        PyErr_SetString(PyExc_ValueError, "Grid dimensions must be positive");
+static const cfd_store_map* store_map(SnapshotStoreObject* self) {
+    return (const cfd_store_map*)PyCapsule_GetPointer(self->mapping, "cfd_python.store_map");
+}
+
+static PyObject* SnapshotStore_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static const char* const kwlist[] = {"filename", NULL};
+    const char* filename;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s", (char**)kwlist, &filename)) {
         return NULL;
     }
-    if (xmax <= xmin) {
-        PyErr_SetString(PyExc_ValueError, "xmax must be greater than xmin");
-        return NULL;
+    cfd_store_map* map = (cfd_store_map*)malloc(sizeof(cfd_store_map));
+    if (map == NULL) {
+        return PyErr_NoMemory();
     }
-    if (ymax <= ymin) {
-        PyErr_SetString(PyExc_ValueError, "ymax must be greater than ymin");
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = cfd_store_map_open(filename, map);
+    Py_END_ALLOW_THREADS
+    if (rc < 0) {
+        free(map);
+        return raise_store_error(filename);
+    }
+
+    // The capsule owns the mapping; every snapshot taken from it keeps it alive
+    PyObject* mapping = PyCapsule_New(map, "cfd_python.store_map", store_capsule_destructor);
+    if (mapping == NULL) {
+        cfd_store_map_close(map);
+        free(map);
         return NULL;
     }
-    if (beta <= 0.0) {
-        PyErr_SetString(PyExc_ValueError, "beta must be positive");
+    PyObject* obj = alloc_instance((PyObject*)type);
+    if (obj == NULL) {
+        Py_DECREF(mapping);
         return NULL;
     }
+    SnapshotStoreObject* self = (SnapshotStoreObject*)obj;
+    self->mapping = mapping;
+    self->filename = copy_string(filename);
+    if (self->filename == NULL) {
+        Py_DECREF(obj);
+        return PyErr_NoMemory();
+    }
+    return obj;
+}
 
-    size_t nx = (size_t)nx_signed;
-    size_t ny = (size_t)ny_signed;
+static void SnapshotStore_dealloc(PyObject* obj) {
+    SnapshotStoreObject* self = (SnapshotStoreObject*)obj;
+    Py_XDECREF(self->mapping);
+    free(self->filename);
+    dealloc_instance(obj);
+}
 
-    grid* g = grid_create(nx, ny, 1, xmin, xmax, ymin, ymax, 0.0, 0.0);
-    if (g == NULL) {
-        PyErr_SetString(PyExc_RuntimeError, "Failed to create grid");
-        return NULL;
+// FieldSnapshot of the record at index position `record`: read-only views
+// of the mapping for raw records, decoded copies for compressed ones
+static PyObject* store_snapshot(SnapshotStoreObject* self, size_t record) {
+    const cfd_store_map* map = store_map(self);
+    const cfd_store_record* header = cfd_store_get_record(map, record);
+    PyObject* obj = alloc_instance(g_field_snapshot_type);
+    if (obj == NULL) {
+        return NULL;
+    }
+    FieldSnapshotObject* snap = (FieldSnapshotObject*)obj;
+    Py_ssize_t count = (Py_ssize_t)(map->nx * map->ny);
+    snap->nx = (Py_ssize_t)map->nx;
+    snap->ny = (Py_ssize_t)map->ny;
+    snap->step = (Py_ssize_t)header->step;
+    snap->time = header->time;
+    double_buffer* outputs[3] = {&snap->u, &snap->v, &snap->p};
+    if (header->codec == CFD_STORE_RAW) {
+        for (int f = 0; f < 3; f++) {
+            Py_INCREF(self->mapping);
+            if (adopt_double_buffer(outputs[f], self->mapping,
+                                    (void*)cfd_store_field(map, record, f),
+                                    count * (Py_ssize_t)sizeof(double), 1, 0) < 0) {
+                Py_DECREF(obj);
+                return NULL;
+            }
+        }
+        return obj;
     }
 
-    grid_initialize_stretched(g, beta);
-
-    // Return grid information as a dictionary
-    PyObject* grid_dict = PyDict_New();
-    if (grid_dict == NULL) {
-        grid_destroy(g);
+    for (int f = 0; f < 3; f++) {
+        if (alloc_double_buffer(outputs[f], count, NULL) < 0) {
+            Py_DECREF(obj);
+            return NULL;
+        }
+    }
+    int rc = 0;
+    Py_BEGIN_ALLOW_THREADS
+    for (int f = 0; f < 3 && rc == 0; f++) {
+        rc = cfd_store_read_field(map, record, f, outputs[f]->data);
+    }
+    Py_END_ALLOW_THREADS
+    if (rc < 0) {
+        raise_store_error(self->filename);
+        Py_DECREF(obj);
         return NULL;
     }
+    return obj;
+}
 
-    // Helper macro to add values to dict with proper refcount and error handling
-    #define ADD_TO_DICT_STRETCHED(dict, key, py_val) do { \
-        PyObject* tmp = (py_val); \
-        if (tmp == NULL) { Py_DECREF(dict); grid_destroy(g); return NULL; } \
-        if (PyDict_SetItemString(dict, key, tmp) < 0) { \
-            Py_DECREF(tmp); Py_DECREF(dict); grid_destroy(g); return NULL; \
-        } \
-        Py_DECREF(tmp); \
-    } while(0)
+// Index position of a step given as a Python int, or -1 with KeyError set
+static Py_ssize_t store_lookup(SnapshotStoreObject* self, PyObject* key, int raise) {
+    if (!PyLong_Check(key)) {
+        if (raise) {
+            PyErr_SetString(PyExc_TypeError, "store keys are integer step numbers");
+        }
+        return -1;
+    }
+    unsigned long long step = PyLong_AsUnsignedLongLong(key);
+    ptrdiff_t record = -1;
+    if (step == (unsigned long long)-1 && PyErr_Occurred()) {
+        // Negative or huge steps are never stored
+        PyErr_Clear();
+    } else {
+        record = cfd_store_find(store_map(self), (uint64_t)step);
+    }
+    if (record < 0 && raise) {
+        PyErr_SetObject(PyExc_KeyError, key);
+    }
+    return (Py_ssize_t)record;
+}
 
-    ADD_TO_DICT_STRETCHED(grid_dict, "nx", PyLong_FromSize_t(g->nx));
-    ADD_TO_DICT_STRETCHED(grid_dict, "ny", PyLong_FromSize_t(g->ny));
-    ADD_TO_DICT_STRETCHED(grid_dict, "xmin", PyFloat_FromDouble(g->xmin));
-    ADD_TO_DICT_STRETCHED(grid_dict, "xmax", PyFloat_FromDouble(g->xmax));
-    ADD_TO_DICT_STRETCHED(grid_dict, "ymin", PyFloat_FromDouble(g->ymin));
-    ADD_TO_DICT_STRETCHED(grid_dict, "ymax", PyFloat_FromDouble(g->ymax));
-    ADD_TO_DICT_STRETCHED(grid_dict, "beta", PyFloat_FromDouble(beta));
+static PyObject* SnapshotStore_subscript(PyObject* obj, PyObject* key) {
+    SnapshotStoreObject* self = (SnapshotStoreObject*)obj;
+    Py_ssize_t record = store_lookup(self, key, 1);
+    return record < 0 ? NULL : store_snapshot(self, (size_t)record);
+}
 
-    #undef ADD_TO_DICT_STRETCHED
+static int SnapshotStore_contains(PyObject* obj, PyObject* key) {
+    return store_lookup((SnapshotStoreObject*)obj, key, 0) >= 0;
+}
 
-    // Create coordinate lists
-    PyObject* x_list = PyList_New((Py_ssize_t)g->nx);
-    PyObject* y_list = PyList_New((Py_ssize_t)g->ny);
-    if (x_list == NULL || y_list == NULL) {
-        Py_XDECREF(x_list);
-        Py_XDECREF(y_list);
-        Py_DECREF(grid_dict);
-        grid_destroy(g);
+static Py_ssize_t SnapshotStore_length(PyObject* obj) {
+    return (Py_ssize_t)store_map((SnapshotStoreObject*)obj)->num_records;
+}
+
+static PyObject* SnapshotStore_at(PyObject* obj, PyObject* args) {
+    SnapshotStoreObject* self = (SnapshotStoreObject*)obj;
+    Py_ssize_t position;
+
+    if (!PyArg_ParseTuple(args, "n", &position)) {
+        return NULL;
+    }
+    Py_ssize_t count = (Py_ssize_t)store_map(self)->num_records;
+    if (position < 0) {
+        position += count;
+    }
+    if (position < 0 || position >= count) {
+        PyErr_SetString(PyExc_IndexError, "store position out of range");
         return NULL;
     }
+    return store_snapshot(self, (size_t)position);
+}
 
-    for (size_t i = 0; i < g->nx; i++) {
-        PyObject* val = PyFloat_FromDouble(g->x[i]);
-        if (val == NULL) {
-            Py_DECREF(x_list);
-            Py_DECREF(y_list);
-            Py_DECREF(grid_dict);
-            grid_destroy(g);
-            return NULL;
-        }
-        if (PyList_SetItem(x_list, (Py_ssize_t)i, val) < 0) {  // steals reference on success
-            Py_DECREF(val);  // PyList_SetItem doesn't steal on failure
-            Py_DECREF(x_list);
-            Py_DECREF(y_list);
-            Py_DECREF(grid_dict);
-            grid_destroy(g);
-            return NULL;
+static PyObject* SnapshotStore_get_steps(PyObject* obj, void* closure) {
+    (void)closure;
+    const cfd_store_map* map = store_map((SnapshotStoreObject*)obj);
+    PyObject* list = PyList_New((Py_ssize_t)map->num_records);
+    for (size_t i = 0; list != NULL && i < map->num_records; i++) {
+        PyObject* item = PyLong_FromUnsignedLongLong(map->index[i].step);
+        if (item == NULL) {
+            Py_CLEAR(list);
+            break;
         }
+        PyList_SetItem(list, (Py_ssize_t)i, item);
     }
+    return list;
+}
 
-    for (size_t i = 0; i < g->ny; i++) {
-        PyObject* val = PyFloat_FromDouble(g->y[i]);
-        if (val == NULL) {
-            Py_DECREF(x_list);
-            Py_DECREF(y_list);
-            Py_DECREF(grid_dict);
-            grid_destroy(g);
-            return NULL;
-        }
-        if (PyList_SetItem(y_list, (Py_ssize_t)i, val) < 0) {  // steals reference on success
-            Py_DECREF(val);  // PyList_SetItem doesn't steal on failure
-            Py_DECREF(x_list);
-            Py_DECREF(y_list);
-            Py_DECREF(grid_dict);
-            grid_destroy(g);
-            return NULL;
+static PyObject* SnapshotStore_get_times(PyObject* obj, void* closure) {
+    (void)closure;
+    const cfd_store_map* map = store_map((SnapshotStoreObject*)obj);
+    PyObject* list = PyList_New((Py_ssize_t)map->num_records);
+    for (size_t i = 0; list != NULL && i < map->num_records; i++) {
+        PyObject* item = PyFloat_FromDouble(map->index[i].time);
+        if (item == NULL) {
+            Py_CLEAR(list);
+            break;
         }
+        PyList_SetItem(list, (Py_ssize_t)i, item);
     }
+    return list;
+}
 
-    if (PyDict_SetItemString(grid_dict, "x_coords", x_list) < 0 ||
-        PyDict_SetItemString(grid_dict, "y_coords", y_list) < 0) {
-        Py_DECREF(x_list);
-        Py_DECREF(y_list);
-        Py_DECREF(grid_dict);
-        grid_destroy(g);
-        return NULL;
-    }
-    Py_DECREF(x_list);
-    Py_DECREF(y_list);
+static PyObject* SnapshotStore_get_filename(PyObject* obj, void* closure) {
+    (void)closure;
+    return PyUnicode_FromString(((SnapshotStoreObject*)obj)->filename);
+}
 
-    grid_destroy(g);
-    return grid_dict;
+static PyObject* SnapshotStore_get_nx(PyObject* obj, void* closure) {
+    (void)closure;
+    return PyLong_FromUnsignedLongLong(store_map((SnapshotStoreObject*)obj)->nx);
 }
 
+static PyObject* SnapshotStore_get_ny(PyObject* obj, void* closure) {
+    (void)closure;
+    return PyLong_FromUnsignedLongLong(store_map((SnapshotStoreObject*)obj)->ny);
+}
+
+static PyGetSetDef SnapshotStore_getset[] = {
+    {"steps", SnapshotStore_get_steps, NULL, "Stored step numbers in increasing order", NULL},
+    {"times", SnapshotStore_get_times, NULL, "Simulation time of each stored step", NULL},
+    {"filename", SnapshotStore_get_filename, NULL, "Store file", NULL},
+    {"nx", SnapshotStore_get_nx, NULL, "Grid points in x direction", NULL},
+    {"ny", SnapshotStore_get_ny, NULL, "Grid points in y direction", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyMethodDef SnapshotStore_methods[] = {
+    {"at", SnapshotStore_at, METH_VARARGS,
+     "Snapshot at a position in step order (negative counts from the end).\n\n"
+     "Args:\n"
+     "    position (int): Record position, not a step number\n\n"
+     "Returns:\n"
+     "    FieldSnapshot: Read-only zero-copy view of the record"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot SnapshotStore_slots[] = {
+    {Py_tp_doc, (void*)
+     "SnapshotStore(filename)\n\n"
+     "Read-only memory-mapped view of a file written by SnapshotWriter.\n\n"
+     "store[step] returns a FieldSnapshot whose u, v and p are read-only\n"
+     "zero-copy views of the mapped file, found by binary search over the\n"
+     "step index; a missing step raises KeyError. Compressed records are\n"
+     "decoded into a new writable snapshot instead. 'step in store', len(),\n"
+     "steps and times work from the index without touching field data.\n"
+     "Snapshots keep the mapping alive after the store is released. Records\n"
+     "appended after opening are not visible; open the file again to see\n"
+     "them. Not available on Windows."},
+    {Py_tp_new, (void*)SnapshotStore_new},
+    {Py_tp_dealloc, (void*)SnapshotStore_dealloc},
+    {Py_tp_getset, SnapshotStore_getset},
+    {Py_tp_methods, SnapshotStore_methods},
+    {Py_mp_subscript, (void*)SnapshotStore_subscript},
+    {Py_mp_length, (void*)SnapshotStore_length},
+    {Py_sq_contains, (void*)SnapshotStore_contains},
+    {0, NULL}
+};
+
+static PyType_Spec SnapshotStore_spec = {
+    "cfd_python.SnapshotStore",
+    sizeof(SnapshotStoreObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    SnapshotStore_slots
+};
+
+// ============================================================================
+// NumPy .npy/.npz Files
+// ============================================================================
+
 /*
- * Apply boundary conditions to scalar field
+ * Fill the shape of `array` from None (flat), an int or a sequence of ints
+ * holding exactly `count` values
  */
-static PyObject* bc_apply_scalar_py(PyObject* self, PyObject* args, PyObject* kwds) {
+static int parse_npy_shape(PyObject* shape_obj, Py_ssize_t count, npy_array* array) {
+    array->ndim = 1;
+    array->shape[0] = (size_t)count;
+    if (shape_obj == Py_None) {
+        return 0;
+    }
+    PyObject* dims = PyLong_Check(shape_obj) ? PyTuple_Pack(1, shape_obj)
+                                             : PySequence_Tuple(shape_obj);
+    if (dims == NULL) {
+        return -1;
+    }
+    Py_ssize_t ndim = PyTuple_Size(dims);
+    size_t total = 1;
+    int ok = ndim <= NPY_FILE_MAX_DIMS;
+    for (Py_ssize_t d = 0; ok && d < ndim; d++) {
+        Py_ssize_t n = PyLong_AsSsize_t(PyTuple_GetItem(dims, d));
+        if (n < 0) {
+            Py_DECREF(dims);
+            if (!PyErr_Occurred()) {
+                PyErr_SetString(PyExc_ValueError, "shape entries must be non-negative");
+            }
+            return -1;
+        }
+        array->shape[d] = (size_t)n;
+        // Stop before overflowing; any such product is already a mismatch
+        ok = n == 0 || total <= (size_t)count / (size_t)n;
+        total *= (size_t)n;
+    }
+    Py_DECREF(dims);
+    if (!ok || total != (size_t)count) {
+        PyErr_Format(PyExc_ValueError, "shape does not match the %zd values of the data", count);
+        return -1;
+    }
+    array->ndim = (int)ndim;
+    return 0;
+}
+
+/*
+ * Write one float64 field as an .npy file
+ */
+static PyObject* save_npy_py(PyObject* self, PyObject* args, PyObject* kwds) {
     (void)self;
-    static char* kwlist[] = {"field", "nx", "ny", "bc_type", NULL};
-    PyObject* field_list;
-    size_t nx, ny;
-    int bc_type;
+    static const char* const kwlist[] = {"filename", "data", "shape", NULL};
+    const char* filename;
+    PyObject* data_obj;
+    PyObject* shape_obj = Py_None;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Onni", kwlist,
-                                     &field_list, &nx, &ny, &bc_type)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "sO|O", (char**)kwlist, &filename, &data_obj,
+                                     &shape_obj)) {
         return NULL;
     }
-
-    if (!PyList_Check(field_list)) {
-        PyErr_SetString(PyExc_TypeError, "field must be a list");
+    double_buffer data;
+    if (acquire_double_buffer(data_obj, 0, &data) < 0) {
         return NULL;
     }
-
-    size_t size = nx * ny;
-    if ((size_t)PyList_Size(field_list) != size) {
-        PyErr_Format(PyExc_ValueError, "field size (%zd) must match nx*ny (%zu)",
-                     PyList_Size(field_list), size);
+    npy_array array;
+    memset(&array, 0, sizeof(array));
+    array.data = data.data;
+    if (parse_npy_shape(shape_obj, data.count, &array) < 0) {
+        release_double_buffer(&data);
         return NULL;
     }
-
-    // Convert list to C array
-    double* field = (double*)malloc(size * sizeof(double));
-    if (field == NULL) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate field array");
-        return NULL;
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = npy_write(filename, &array);
+    Py_END_ALLOW_THREADS
+    release_double_buffer(&data);
+    if (rc < 0) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
     }
+    Py_RETURN_NONE;
+}
 
-    for (size_t i = 0; i < size; i++) {
-        PyObject* item = PyList_GetItem(field_list, i);
-        field[i] = PyFloat_AsDouble(item);
-        if (PyErr_Occurred()) {
-            free(field);
-            return NULL;
+/*
+ * Collect the members of save_npz(): u, v and p of a Simulation or
+ * FieldSnapshot, or every entry of a dict. Fills `bufs`, `names` (UTF-8
+ * bytes keeping each name alive) and `arrays`, all of `*count` entries.
+ */
+static int collect_npz_members(PyObject* source, PyObject* shape_obj, double_buffer** bufs,
+                               PyObject*** names, npy_array** arrays, Py_ssize_t* count) {
+    static const char* const flow_names[3] = {"u", "v", "p"};
+    int flow = PyObject_TypeCheck(source, (PyTypeObject*)g_simulation_type) ||
+               PyObject_TypeCheck(source, (PyTypeObject*)g_field_snapshot_type);
+    if (!flow && !PyDict_Check(source)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "arrays must be a Simulation, FieldSnapshot or dict of float64 fields");
+        return -1;
+    }
+    Py_ssize_t n = flow ? 3 : PyDict_Size(source);
+    size_t slots = n > 0 ? (size_t)n : 1;
+    *bufs = (double_buffer*)calloc(slots, sizeof(double_buffer));
+    *names = (PyObject**)calloc(slots, sizeof(PyObject*));
+    *arrays = (npy_array*)calloc(slots, sizeof(npy_array));
+    *count = 0;
+    if (*bufs == NULL || *names == NULL || *arrays == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    Py_ssize_t nx = 0;
+    if (flow) {
+        flow_arrays fields;
+        if (acquire_flow_arrays(source, "arrays", &fields) < 0) {
+            return -1;
+        }
+        nx = fields.nx;
+        memcpy(*bufs, fields.fields, sizeof(fields.fields));  // Ownership moves to bufs
+        *count = 3;
+        for (int f = 0; f < 3; f++) {
+            (*names)[f] = PyBytes_FromString(flow_names[f]);
+            if ((*names)[f] == NULL) {
+                return -1;
+            }
+        }
+    } else {
+        Py_ssize_t pos = 0;
+        PyObject* key;
+        PyObject* value;
+        while (PyDict_Next(source, &pos, &key, &value)) {
+            Py_ssize_t k = *count;
+            if (k == n) {
+                PyErr_SetString(PyExc_RuntimeError, "arrays changed size during iteration");
+                return -1;
+            }
+            if (!PyUnicode_Check(key)) {
+                PyErr_SetString(PyExc_TypeError, "array names must be strings");
+                return -1;
+            }
+            (*names)[k] = PyUnicode_AsUTF8String(key);
+            if ((*names)[k] == NULL) {
+                return -1;
+            }
+            *count = k + 1;
+            if (acquire_double_buffer(value, 0, &(*bufs)[k]) < 0) {
+                return -1;
+            }
         }
     }
 
-    // Apply BC
-    cfd_status_t status = bc_apply_scalar(field, nx, ny, (bc_type_t)bc_type);
-    if (status != CFD_SUCCESS) {
-        free(field);
-        return raise_cfd_error(status, "bc_apply_scalar");
+    for (Py_ssize_t k = 0; k < *count; k++) {
+        npy_array* array = &(*arrays)[k];
+        array->name = PyBytes_AsString((*names)[k]);
+        array->data = (*bufs)[k].data;
+        if (array->name[0] == '\0') {
+            PyErr_SetString(PyExc_ValueError, "array names must not be empty");
+            return -1;
+        }
+        // Flow fields are (ny, nx) unless a shape is given
+        if (flow && shape_obj == Py_None && nx > 0) {
+            array->ndim = 2;
+            array->shape[0] = (size_t)((*bufs)[k].count / nx);
+            array->shape[1] = (size_t)nx;
+        } else if (parse_npy_shape(shape_obj, (*bufs)[k].count, array) < 0) {
+            return -1;
+        }
     }
+    return 0;
+}
 
-    // Copy back to list
-    for (size_t i = 0; i < size; i++) {
-        PyObject* val = PyFloat_FromDouble(field[i]);
-        if (val == NULL) {
-            free(field);
-            return NULL;
+static void release_npz_members(double_buffer* bufs, PyObject** names, npy_array* arrays,
+                                Py_ssize_t count) {
+    for (Py_ssize_t k = 0; k < count; k++) {
+        if (bufs != NULL) {
+            release_double_buffer(&bufs[k]);
         }
-        if (PyList_SetItem(field_list, i, val) < 0) {
-            Py_DECREF(val);  // PyList_SetItem doesn't steal on failure
-            free(field);
-            return NULL;
+        if (names != NULL) {
+            Py_XDECREF(names[k]);
         }
     }
-
-    free(field);
-    Py_RETURN_NONE;
+    free(bufs);
+    free(names);
+    free(arrays);
 }
 
 /*
- * Apply boundary conditions to velocity fields
+ * Write several float64 fields as an uncompressed .npz archive
  */
-static PyObject* bc_apply_velocity_py(PyObject* self, PyObject* args, PyObject* kwds) {
+static PyObject* save_npz_py(PyObject* self, PyObject* args, PyObject* kwds) {
     (void)self;
-    static char* kwlist[] = {"u", "v", "nx", "ny", "bc_type", NULL};
-    PyObject* u_list;
-    PyObject* v_list;
-    size_t nx, ny;
-    int bc_type;
+    static const char* const kwlist[] = {"filename", "arrays", "shape", NULL};
+    const char* filename;
+    PyObject* source;
+    PyObject* shape_obj = Py_None;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOnni", kwlist,
-                                     &u_list, &v_list, &nx, &ny, &bc_type)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "sO|O", (char**)kwlist, &filename, &source,
+                                     &shape_obj)) {
         return NULL;
     }
-
-    if (!PyList_Check(u_list) || !PyList_Check(v_list)) {
-        PyErr_SetString(PyExc_TypeError, "u and v must be lists");
+    double_buffer* bufs = NULL;
+    PyObject** names = NULL;
+    npy_array* arrays = NULL;
+    Py_ssize_t count = 0;
+    if (collect_npz_members(source, shape_obj, &bufs, &names, &arrays, &count) < 0) {
+        release_npz_members(bufs, names, arrays, count);
         return NULL;
     }
 
-    size_t size = nx * ny;
-    if ((size_t)PyList_Size(u_list) != size || (size_t)PyList_Size(v_list) != size) {
-        PyErr_SetString(PyExc_ValueError, "u and v sizes must match nx*ny");
-        return NULL;
+    SimulationObject* sim = NULL;
+    if (PyObject_TypeCheck(source, (PyTypeObject*)g_simulation_type)) {
+        sim = (SimulationObject*)source;
+        sim->busy = 1;
     }
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = npz_write(filename, arrays, (size_t)count);
+    Py_END_ALLOW_THREADS
+    if (sim != NULL) {
+        sim->busy = 0;
+    }
+    release_npz_members(bufs, names, arrays, count);
+    if (rc < 0) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
+    }
+    Py_RETURN_NONE;
+}
 
-    // Convert lists to C arrays
-    double* u = (double*)malloc(size * sizeof(double));
-    double* v = (double*)malloc(size * sizeof(double));
-    if (u == NULL || v == NULL) {
-        free(u);
-        free(v);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate velocity arrays");
-        return NULL;
+static void npy_capsule_destructor(PyObject* capsule) {
+    npy_map* map = (npy_map*)PyCapsule_GetPointer(capsule, "cfd_python.npy_map");
+    if (map != NULL) {
+        npy_map_close(map);
+        free(map);
     }
+}
 
-    for (size_t i = 0; i < size; i++) {
-        u[i] = PyFloat_AsDouble(PyList_GetItem(u_list, i));
-        v[i] = PyFloat_AsDouble(PyList_GetItem(v_list, i));
-        if (PyErr_Occurred()) {
-            free(u);
-            free(v);
-            return NULL;
+/*
+ * Map an .npy file and return a memoryview of its data without copying
+ */
+static PyObject* load_npy_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static const char* const kwlist[] = {"filename", "writable", NULL};
+    const char* filename;
+    int writable = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|p", (char**)kwlist, &filename, &writable)) {
+        return NULL;
+    }
+    npy_map* map = (npy_map*)malloc(sizeof(npy_map));
+    if (map == NULL) {
+        return PyErr_NoMemory();
+    }
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = npy_map_open(filename, writable, map);
+    Py_END_ALLOW_THREADS
+    if (rc < 0) {
+        free(map);
+        if (errno == ENOSYS) {
+            PyErr_SetString(PyExc_NotImplementedError,
+                            "Memory-mapped .npy files are not supported on this platform");
+        } else if (errno == EINVAL) {
+            PyErr_Format(PyExc_ValueError,
+                         "'%s' is not a C-ordered native float64 .npy file", filename);
+        } else {
+            PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename);
         }
+        return NULL;
     }
 
-    // Apply BC
-    cfd_status_t status = bc_apply_velocity(u, v, nx, ny, (bc_type_t)bc_type);
-    if (status != CFD_SUCCESS) {
-        free(u);
-        free(v);
-        return raise_cfd_error(status, "bc_apply_velocity");
+    // The capsule owns the mapping and the view keeps the capsule alive
+    PyObject* owner = PyCapsule_New(map, "cfd_python.npy_map", npy_capsule_destructor);
+    if (owner == NULL) {
+        npy_map_close(map);
+        free(map);
+        return NULL;
     }
-
-    // Copy back to lists
-    for (size_t i = 0; i < size; i++) {
-        PyObject* u_val = PyFloat_FromDouble(u[i]);
-        PyObject* v_val = PyFloat_FromDouble(v[i]);
-        if (u_val == NULL || v_val == NULL) {
-            Py_XDECREF(u_val);
-            Py_XDECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
-        }
-        if (PyList_SetItem(u_list, i, u_val) < 0) {
-            Py_DECREF(u_val);
-            Py_DECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
-        }
-        if (PyList_SetItem(v_list, i, v_val) < 0) {
-            Py_DECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
-        }
+    PyObject* view = make_double_view(owner, map->data, (Py_ssize_t)map->count, !writable);
+    Py_DECREF(owner);
+    if (view == NULL || map->ndim == 1 || map->count == 0) {
+        return view;
     }
 
-    free(u);
-    free(v);
-    Py_RETURN_NONE;
+    // memoryview only reshapes from bytes
+    PyObject* shape = PyTuple_New(map->ndim);
+    for (int d = 0; shape != NULL && d < map->ndim; d++) {
+        PyObject* n = PyLong_FromSize_t(map->shape[d]);
+        if (n == NULL) {
+            Py_CLEAR(shape);
+            break;
+        }
+        PyTuple_SetItem(shape, d, n);
+    }
+    PyObject* bytes_view = shape ? PyObject_CallMethod(view, "cast", "s", "B") : NULL;
+    PyObject* shaped = bytes_view ? PyObject_CallMethod(bytes_view, "cast", "sO", "d", shape)
+                                  : NULL;
+    Py_XDECREF(bytes_view);
+    Py_XDECREF(shape);
+    Py_DECREF(view);
+    return shaped;
 }
 
 /*
- * Apply Dirichlet boundary conditions to scalar field
+ * Compute velocity magnitude from u,v components
  */
-static PyObject* bc_apply_dirichlet_scalar_py(PyObject* self, PyObject* args, PyObject* kwds) {
+static PyObject* compute_velocity_magnitude_py(PyObject* self, PyObject* args) {
     (void)self;
-    static char* kwlist[] = {"field", "nx", "ny", "left", "right", "bottom", "top", NULL};
-    PyObject* field_list;
+    PyObject* u_list;
+    PyObject* v_list;
     size_t nx, ny;
-    double left, right, bottom, top;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Onndddd", kwlist,
-                                     &field_list, &nx, &ny, &left, &right, &bottom, &top)) {
+    if (!PyArg_ParseTuple(args, "OOnn", &u_list, &v_list, &nx, &ny)) {
         return NULL;
     }
 
-    if (!PyList_Check(field_list)) {
-        PyErr_SetString(PyExc_TypeError, "field must be a list");
+    if (!PyList_Check(u_list) || !PyList_Check(v_list)) {
+        PyErr_SetString(PyExc_TypeError, "u and v must be lists");
         return NULL;
     }
 
     size_t size = nx * ny;
-    if ((size_t)PyList_Size(field_list) != size) {
-        PyErr_Format(PyExc_ValueError, "field size (%zd) must match nx*ny (%zu)",
-                     PyList_Size(field_list), size);
+    if ((size_t)PyList_Size(u_list) != size || (size_t)PyList_Size(v_list) != size) {
+        PyErr_Format(PyExc_ValueError,
+                     "u and v size must match nx*ny (%zu), got %zd and %zd",
+                     size, PyList_Size(u_list), PyList_Size(v_list));
         return NULL;
     }
 
-    // Convert list to C array
-    double* field = (double*)malloc(size * sizeof(double));
+    // Create a temporary flow_field structure
+    flow_field* field = flow_field_create(nx, ny, 1);
     if (field == NULL) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate field array");
+        PyErr_SetString(PyExc_MemoryError, "Failed to allocate flow field");
         return NULL;
     }
 
+    // Copy u, v from lists
     for (size_t i = 0; i < size; i++) {
-        field[i] = PyFloat_AsDouble(PyList_GetItem(field_list, i));
+        field->u[i] = PyFloat_AsDouble(PyList_GetItem(u_list, i));
+        field->v[i] = PyFloat_AsDouble(PyList_GetItem(v_list, i));
         if (PyErr_Occurred()) {
-            free(field);
+            flow_field_destroy(field);
             return NULL;
         }
     }
 
-    // Apply Dirichlet BC
-    bc_dirichlet_values_t values = {.left = left, .right = right, .bottom = bottom, .top = top};
-    cfd_status_t status = bc_apply_dirichlet_scalar(field, nx, ny, &values);
-    if (status != CFD_SUCCESS) {
-        free(field);
-        return raise_cfd_error(status, "bc_apply_dirichlet_scalar");
+    // Create derived fields and compute velocity magnitude
+    derived_fields* derived = derived_fields_create(nx, ny, 1);
+    if (derived == NULL) {
+        flow_field_destroy(field);
+        PyErr_SetString(PyExc_MemoryError, "Failed to allocate derived fields");
+        return NULL;
+    }
+
+    derived_fields_compute_velocity_magnitude(derived, field);
+
+    // Create output list
+    PyObject* result = PyList_New(size);
+    if (result == NULL) {
+        derived_fields_destroy(derived);
+        flow_field_destroy(field);
+        return NULL;
     }
 
-    // Copy back to list
     for (size_t i = 0; i < size; i++) {
-        PyObject* val = PyFloat_FromDouble(field[i]);
+        PyObject* val = PyFloat_FromDouble(derived->velocity_magnitude[i]);
         if (val == NULL) {
-            free(field);
+            Py_DECREF(result);
+            derived_fields_destroy(derived);
+            flow_field_destroy(field);
             return NULL;
         }
-        if (PyList_SetItem(field_list, i, val) < 0) {
+        if (PyList_SetItem(result, i, val) < 0) {
             Py_DECREF(val);
-            free(field);
+            Py_DECREF(result);
+            derived_fields_destroy(derived);
+            flow_field_destroy(field);
             return NULL;
         }
     }
 
-    free(field);
-    Py_RETURN_NONE;
+    derived_fields_destroy(derived);
+    flow_field_destroy(field);
+
+    return result;
 }
 
 /*
- * Apply no-slip boundary conditions to velocity fields
+ * Compute all field statistics for flow field components
  */
-static PyObject* bc_apply_noslip_py(PyObject* self, PyObject* args, PyObject* kwds) {
+static PyObject* compute_flow_statistics_py(PyObject* self, PyObject* args) {
     (void)self;
-    static char* kwlist[] = {"u", "v", "nx", "ny", NULL};
     PyObject* u_list;
     PyObject* v_list;
+    PyObject* p_list;
     size_t nx, ny;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOnn", kwlist,
-                                     &u_list, &v_list, &nx, &ny)) {
+    if (!PyArg_ParseTuple(args, "OOOnn", &u_list, &v_list, &p_list, &nx, &ny)) {
         return NULL;
     }
 
-    if (!PyList_Check(u_list) || !PyList_Check(v_list)) {
-        PyErr_SetString(PyExc_TypeError, "u and v must be lists");
+    if (!PyList_Check(u_list) || !PyList_Check(v_list) || !PyList_Check(p_list)) {
+        PyErr_SetString(PyExc_TypeError, "u, v, and p must be lists");
         return NULL;
     }
 
     size_t size = nx * ny;
-    if ((size_t)PyList_Size(u_list) != size || (size_t)PyList_Size(v_list) != size) {
-        PyErr_SetString(PyExc_ValueError, "u and v sizes must match nx*ny");
+    if ((size_t)PyList_Size(u_list) != size ||
+        (size_t)PyList_Size(v_list) != size ||
+        (size_t)PyList_Size(p_list) != size) {
+        PyErr_Format(PyExc_ValueError,
+                     "All fields must have size nx*ny (%zu)", size);
         return NULL;
     }
 
-    // Convert lists to C arrays
-    double* u = (double*)malloc(size * sizeof(double));
-    double* v = (double*)malloc(size * sizeof(double));
-    if (u == NULL || v == NULL) {
-        free(u);
-        free(v);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate velocity arrays");
+    // Create a temporary flow_field structure
+    flow_field* field = flow_field_create(nx, ny, 1);
+    if (field == NULL) {
+        PyErr_SetString(PyExc_MemoryError, "Failed to allocate flow field");
         return NULL;
     }
 
+    // Copy data from lists
     for (size_t i = 0; i < size; i++) {
-        u[i] = PyFloat_AsDouble(PyList_GetItem(u_list, i));
-        v[i] = PyFloat_AsDouble(PyList_GetItem(v_list, i));
+        field->u[i] = PyFloat_AsDouble(PyList_GetItem(u_list, i));
+        field->v[i] = PyFloat_AsDouble(PyList_GetItem(v_list, i));
+        field->p[i] = PyFloat_AsDouble(PyList_GetItem(p_list, i));
         if (PyErr_Occurred()) {
-            free(u);
-            free(v);
+            flow_field_destroy(field);
             return NULL;
         }
     }
 
-    // Apply no-slip BC
-    cfd_status_t status = bc_apply_noslip(u, v, nx, ny);
-    if (status != CFD_SUCCESS) {
-        free(u);
-        free(v);
-        return raise_cfd_error(status, "bc_apply_noslip");
+    // Create derived fields and compute statistics
+    derived_fields* derived = derived_fields_create(nx, ny, 1);
+    if (derived == NULL) {
+        flow_field_destroy(field);
+        PyErr_SetString(PyExc_MemoryError, "Failed to allocate derived fields");
+        return NULL;
     }
 
-    // Copy back to lists
-    for (size_t i = 0; i < size; i++) {
-        PyObject* u_val = PyFloat_FromDouble(u[i]);
-        PyObject* v_val = PyFloat_FromDouble(v[i]);
-        if (u_val == NULL || v_val == NULL) {
-            Py_XDECREF(u_val);
-            Py_XDECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
-        }
-        if (PyList_SetItem(u_list, i, u_val) < 0) {
-            Py_DECREF(u_val);
-            Py_DECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
-        }
-        if (PyList_SetItem(v_list, i, v_val) < 0) {
-            Py_DECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
-        }
+    // First compute velocity magnitude (required for vel_mag_stats)
+    derived_fields_compute_velocity_magnitude(derived, field);
+    // Then compute all statistics
+    derived_fields_compute_statistics(derived, field);
+
+    // Build result dictionary with all statistics
+    PyObject* result = PyDict_New();
+    if (result == NULL) {
+        derived_fields_destroy(derived);
+        flow_field_destroy(field);
+        return NULL;
     }
 
-    free(u);
-    free(v);
-    Py_RETURN_NONE;
+    // Helper macro to add stats dict (properly handles reference counts and errors)
+    #define ADD_STATS(name, stats_struct) do { \
+        PyObject* stats_dict = PyDict_New(); \
+        if (stats_dict == NULL) { \
+            Py_DECREF(result); \
+            derived_fields_destroy(derived); \
+            flow_field_destroy(field); \
+            return NULL; \
+        } \
+        PyObject* tmp_min = PyFloat_FromDouble((stats_struct).min_val); \
+        PyObject* tmp_max = PyFloat_FromDouble((stats_struct).max_val); \
+        PyObject* tmp_avg = PyFloat_FromDouble((stats_struct).avg_val); \
+        PyObject* tmp_sum = PyFloat_FromDouble((stats_struct).sum_val); \
+        if (tmp_min == NULL || tmp_max == NULL || tmp_avg == NULL || tmp_sum == NULL) { \
+            Py_XDECREF(tmp_min); \
+            Py_XDECREF(tmp_max); \
+            Py_XDECREF(tmp_avg); \
+            Py_XDECREF(tmp_sum); \
+            Py_DECREF(stats_dict); \
+            Py_DECREF(result); \
+            derived_fields_destroy(derived); \
+            flow_field_destroy(field); \
+            return NULL; \
+        } \
+        if (PyDict_SetItemString(stats_dict, "min", tmp_min) < 0 || \
+            PyDict_SetItemString(stats_dict, "max", tmp_max) < 0 || \
+            PyDict_SetItemString(stats_dict, "avg", tmp_avg) < 0 || \
+            PyDict_SetItemString(stats_dict, "sum", tmp_sum) < 0) { \
+            Py_DECREF(tmp_min); \
+            Py_DECREF(tmp_max); \
+            Py_DECREF(tmp_avg); \
+            Py_DECREF(tmp_sum); \
+            Py_DECREF(stats_dict); \
+            Py_DECREF(result); \
+            derived_fields_destroy(derived); \
+            flow_field_destroy(field); \
+            return NULL; \
+        } \
+        Py_DECREF(tmp_min); \
+        Py_DECREF(tmp_max); \
+        Py_DECREF(tmp_avg); \
+        Py_DECREF(tmp_sum); \
+        if (PyDict_SetItemString(result, name, stats_dict) < 0) { \
+            Py_DECREF(stats_dict); \
+            Py_DECREF(result); \
+            derived_fields_destroy(derived); \
+            flow_field_destroy(field); \
+            return NULL; \
+        } \
+        Py_DECREF(stats_dict); \
+    } while(0)
+
+    ADD_STATS("u", derived->u_stats);
+    ADD_STATS("v", derived->v_stats);
+    ADD_STATS("p", derived->p_stats);
+    ADD_STATS("velocity_magnitude", derived->vel_mag_stats);
+
+    #undef ADD_STATS
+
+    derived_fields_destroy(derived);
+    flow_field_destroy(field);
+
+    return result;
+}
+
+// True if output `f` shares memory with an input or an earlier output
+static int gradient_output_aliases(const gradient_inputs* in, const double_buffer* bufs, int f) {
+    const double* data = bufs[f].data;
+    size_t count = (size_t)bufs[f].count;
+    size_t points = in->nx * in->ny;
+    if (double_ranges_overlap(data, count, in->u, points) ||
+        double_ranges_overlap(data, count, in->v, points) ||
+        double_ranges_overlap(data, count, in->p, points) ||
+        double_ranges_overlap(data, count, in->x, in->nx) ||
+        double_ranges_overlap(data, count, in->y, in->ny)) {
+        return 1;
+    }
+    for (int k = 0; k < f; k++) {
+        if (double_ranges_overlap(data, count, bufs[k].data, (size_t)bufs[k].count)) {
+            return 1;
+        }
+    }
+    return 0;
 }
 
+static const char* const gradient_field_names[] = {
+    "vorticity", "divergence", "strain_rate", "q_criterion", "dpdx", "dpdy"
+};
+#define NUM_GRADIENT_FIELDS 6
+
 /*
- * Apply inlet boundary conditions
+ * Run the fused gradient sweep for the requested `fields` (None = all that
+ * the inputs allow) and return {name: buffer}. Entries of the `out` dict are
+ * written in place and returned as given; other outputs are allocated. The
+ * stencil reads neighbours from other threads' rows, so an output may not
+ * share memory with any input or with another output.
  */
-static PyObject* bc_apply_inlet_uniform_py(PyObject* self, PyObject* args, PyObject* kwds) {
-    (void)self;
-    static char* kwlist[] = {"u", "v", "nx", "ny", "u_inlet", "v_inlet", "edge", NULL};
-    PyObject* u_list;
-    PyObject* v_list;
-    size_t nx, ny;
-    double u_inlet, v_inlet;
-    int edge = BC_EDGE_LEFT;
-
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOnndd|i", kwlist,
-                                     &u_list, &v_list, &nx, &ny, &u_inlet, &v_inlet, &edge)) {
-        return NULL;
-    }
+static PyObject* compute_gradient_fields(const gradient_inputs* in, PyObject* fields,
+                                         PyObject* out_obj) {
+    int wanted[NUM_GRADIENT_FIELDS] = {0};
+    Py_ssize_t count = (Py_ssize_t)(in->nx * in->ny);
 
-    if (!PyList_Check(u_list) || !PyList_Check(v_list)) {
-        PyErr_SetString(PyExc_TypeError, "u and v must be lists");
+    if (out_obj != Py_None && !PyDict_Check(out_obj)) {
+        PyErr_SetString(PyExc_TypeError, "out must be a dict of output buffers");
         return NULL;
     }
-
-    size_t size = nx * ny;
-    if ((size_t)PyList_Size(u_list) != size || (size_t)PyList_Size(v_list) != size) {
-        PyErr_SetString(PyExc_ValueError, "u and v sizes must match nx*ny");
-        return NULL;
+    if (fields == Py_None) {
+        for (int f = 0; f < NUM_GRADIENT_FIELDS; f++) {
+            wanted[f] = f < 4 || in->p != NULL;
+        }
+    } else {
+        PyObject* iter = PyObject_GetIter(fields);
+        if (iter == NULL) {
+            return NULL;
+        }
+        PyObject* item;
+        while ((item = PyIter_Next(iter)) != NULL) {
+            int found = -1;
+            for (int f = 0; PyUnicode_Check(item) && f < NUM_GRADIENT_FIELDS; f++) {
+                if (PyUnicode_CompareWithASCIIString(item, gradient_field_names[f]) == 0) {
+                    found = f;
+                }
+            }
+            if (found < 0) {
+                PyErr_Format(PyExc_ValueError, "Unknown derived field %R", item);
+                Py_DECREF(item);
+                Py_DECREF(iter);
+                return NULL;
+            }
+            wanted[found] = 1;
+            Py_DECREF(item);
+        }
+        Py_DECREF(iter);
+        if (PyErr_Occurred()) {
+            return NULL;
+        }
+        if ((wanted[4] || wanted[5]) && in->p == NULL) {
+            PyErr_SetString(PyExc_ValueError, "Pressure gradients require p");
+            return NULL;
+        }
     }
 
-    // Convert lists to C arrays
-    double* u = (double*)malloc(size * sizeof(double));
-    double* v = (double*)malloc(size * sizeof(double));
-    if (u == NULL || v == NULL) {
-        free(u);
-        free(v);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate velocity arrays");
+    PyObject* result = PyDict_New();
+    if (result == NULL) {
         return NULL;
     }
+    double_buffer bufs[NUM_GRADIENT_FIELDS];
+    double* targets[NUM_GRADIENT_FIELDS] = {NULL};
+    memset(bufs, 0, sizeof(bufs));
+    int ok = 1;
 
-    for (size_t i = 0; i < size; i++) {
-        u[i] = PyFloat_AsDouble(PyList_GetItem(u_list, i));
-        v[i] = PyFloat_AsDouble(PyList_GetItem(v_list, i));
-        if (PyErr_Occurred()) {
-            free(u);
-            free(v);
-            return NULL;
+    for (int f = 0; ok && f < NUM_GRADIENT_FIELDS; f++) {
+        if (!wanted[f]) {
+            continue;
+        }
+        const char* name = gradient_field_names[f];
+        PyObject* target = out_obj != Py_None ? PyDict_GetItemString(out_obj, name) : NULL;
+        PyObject* value = NULL;
+        if (target != NULL) {
+            ok = acquire_double_buffer(target, 1, &bufs[f]) == 0;
+            if (ok && (bufs[f].copied || bufs[f].count != count)) {
+                PyErr_Format(PyExc_ValueError,
+                             "out['%s'] must be a writable float64 buffer of nx*ny = %zd elements",
+                             name, count);
+                ok = 0;
+            }
+            if (ok && gradient_output_aliases(in, bufs, f)) {
+                PyErr_Format(PyExc_ValueError, "out['%s'] overlaps an input or another output",
+                             name);
+                ok = 0;
+            }
+            if (ok) {
+                Py_INCREF(target);
+                value = target;
+            }
+        } else {
+            ok = alloc_double_buffer(&bufs[f], count, NULL) == 0;
+            if (ok) {
+                value = make_double_view(bufs[f].owner, bufs[f].data, count, 0);
+                ok = value != NULL;
+            }
         }
+        if (ok) {
+            targets[f] = bufs[f].data;
+            ok = PyDict_SetItemString(result, name, value) == 0;
+        }
+        Py_XDECREF(value);
     }
 
-    // Create inlet config and apply
-    bc_inlet_config_t config = bc_inlet_config_uniform(u_inlet, v_inlet);
-    bc_inlet_set_edge(&config, (bc_edge_t)edge);
-
-    cfd_status_t status = bc_apply_inlet(u, v, nx, ny, &config);
+    cfd_status_t status = CFD_SUCCESS;
+    if (ok) {
+        gradient_outputs out = {targets[0], targets[1], targets[2],
+                                targets[3], targets[4], targets[5]};
+        Py_BEGIN_ALLOW_THREADS
+        status = compute_flow_gradients(in, &out);
+        Py_END_ALLOW_THREADS
+    }
+    for (int f = 0; f < NUM_GRADIENT_FIELDS; f++) {
+        release_double_buffer(&bufs[f]);
+    }
+    if (!ok) {
+        Py_DECREF(result);
+        return NULL;
+    }
     if (status != CFD_SUCCESS) {
-        free(u);
-        free(v);
-        return raise_cfd_error(status, "bc_apply_inlet");
+        Py_DECREF(result);
+        if (status == CFD_ERROR_INVALID) {
+            PyErr_SetString(PyExc_ValueError,
+                            "Derived fields need at least 3x3 points and strictly increasing coordinates");
+            return NULL;
+        }
+        return raise_cfd_error(status, "compute_derived_fields");
     }
+    return result;
+}
 
-    // Copy back to lists
-    for (size_t i = 0; i < size; i++) {
-        PyObject* u_val = PyFloat_FromDouble(u[i]);
-        PyObject* v_val = PyFloat_FromDouble(v[i]);
-        if (u_val == NULL || v_val == NULL) {
-            Py_XDECREF(u_val);
-            Py_XDECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
+// Grid coordinates from a Grid, a create_grid() dict or None (unit square)
+static int resolve_grid_coordinates(PyObject* grid_obj, size_t nx, size_t ny,
+                                    double_buffer* x, double_buffer* y) {
+    memset(x, 0, sizeof(*x));
+    memset(y, 0, sizeof(*y));
+    if (grid_obj == Py_None) {
+        if (alloc_double_buffer(x, (Py_ssize_t)nx, NULL) < 0 ||
+            alloc_double_buffer(y, (Py_ssize_t)ny, NULL) < 0) {
+            release_double_buffer(x);
+            return -1;
         }
-        if (PyList_SetItem(u_list, i, u_val) < 0) {
-            Py_DECREF(u_val);
-            Py_DECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
+        for (size_t i = 0; i < nx; i++) {
+            x->data[i] = (double)i / (double)(nx - 1);
         }
-        if (PyList_SetItem(v_list, i, v_val) < 0) {
-            Py_DECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
+        for (size_t j = 0; j < ny; j++) {
+            y->data[j] = (double)j / (double)(ny - 1);
+        }
+        return 0;
+    }
+
+    if (PyObject_TypeCheck(grid_obj, (PyTypeObject*)g_grid_type)) {
+        GridObject* g = (GridObject*)grid_obj;
+        *x = g->x;
+        *y = g->y;
+        Py_INCREF(x->owner);
+        Py_INCREF(y->owner);
+    } else if (PyDict_Check(grid_obj)) {
+        PyObject* xs = PyDict_GetItemString(grid_obj, "x_coords");
+        PyObject* ys = PyDict_GetItemString(grid_obj, "y_coords");
+        if (xs == NULL || ys == NULL) {
+            PyErr_SetString(PyExc_ValueError, "grid dict must contain 'x_coords' and 'y_coords'");
+            return -1;
         }
+        if (acquire_double_buffer(xs, 0, x) < 0) {
+            return -1;
+        }
+        if (acquire_double_buffer(ys, 0, y) < 0) {
+            release_double_buffer(x);
+            return -1;
+        }
+    } else {
+        PyErr_SetString(PyExc_TypeError, "grid must be a Grid, a create_grid() dict or None");
+        return -1;
     }
 
-    free(u);
-    free(v);
-    Py_RETURN_NONE;
+    if ((size_t)x->count != nx || (size_t)y->count != ny) {
+        PyErr_Format(PyExc_ValueError, "grid has %zd x %zd points, fields have %zu x %zu",
+                     x->count, y->count, nx, ny);
+        release_double_buffer(x);
+        release_double_buffer(y);
+        return -1;
+    }
+    return 0;
 }
 
 /*
- * Apply parabolic inlet boundary conditions
+ * Compute vorticity, divergence, strain rate, Q-criterion and pressure
+ * gradients in one fused sweep
  */
-static PyObject* bc_apply_inlet_parabolic_py(PyObject* self, PyObject* args, PyObject* kwds) {
+static PyObject* compute_derived_fields_py(PyObject* self, PyObject* args, PyObject* kwds) {
     (void)self;
-    static char* kwlist[] = {"u", "v", "nx", "ny", "max_velocity", "edge", NULL};
-    PyObject* u_list;
-    PyObject* v_list;
-    size_t nx, ny;
-    double max_velocity;
-    int edge = BC_EDGE_LEFT;
+    static const char* const kwlist[] = {"u", "v", "nx", "ny", "grid", "p", "fields", "out", NULL};
+    PyObject *u_obj, *v_obj;
+    Py_ssize_t nx, ny;
+    PyObject* grid_obj = Py_None;
+    PyObject* p_obj = Py_None;
+    PyObject* fields = Py_None;
+    PyObject* out_obj = Py_None;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOnnd|i", kwlist,
-                                     &u_list, &v_list, &nx, &ny, &max_velocity, &edge)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOnn|OOOO", (char**)kwlist,
+                                     &u_obj, &v_obj, &nx, &ny, &grid_obj, &p_obj,
+                                     &fields, &out_obj)) {
         return NULL;
     }
-
-    if (!PyList_Check(u_list) || !PyList_Check(v_list)) {
-        PyErr_SetString(PyExc_TypeError, "u and v must be lists");
+    if (nx < 3 || ny < 3) {
+        PyErr_SetString(PyExc_ValueError, "nx and ny must be at least 3");
         return NULL;
     }
 
-    size_t size = nx * ny;
-    if ((size_t)PyList_Size(u_list) != size || (size_t)PyList_Size(v_list) != size) {
-        PyErr_SetString(PyExc_ValueError, "u and v sizes must match nx*ny");
+    Py_ssize_t count = nx * ny;
+    double_buffer u, v, p, x, y;
+    memset(&p, 0, sizeof(p));
+    if (acquire_double_buffer(u_obj, 0, &u) < 0) {
         return NULL;
     }
-
-    // Convert lists to C arrays
-    double* u = (double*)malloc(size * sizeof(double));
-    double* v = (double*)malloc(size * sizeof(double));
-    if (u == NULL || v == NULL) {
-        free(u);
-        free(v);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate velocity arrays");
+    if (acquire_double_buffer(v_obj, 0, &v) < 0) {
+        release_double_buffer(&u);
         return NULL;
     }
-
-    for (size_t i = 0; i < size; i++) {
-        u[i] = PyFloat_AsDouble(PyList_GetItem(u_list, i));
-        v[i] = PyFloat_AsDouble(PyList_GetItem(v_list, i));
-        if (PyErr_Occurred()) {
-            free(u);
-            free(v);
-            return NULL;
-        }
+    if (p_obj != Py_None && acquire_double_buffer(p_obj, 0, &p) < 0) {
+        release_double_buffer(&u);
+        release_double_buffer(&v);
+        return NULL;
     }
 
-    // Create parabolic inlet config and apply
-    bc_inlet_config_t config = bc_inlet_config_parabolic(max_velocity);
-    bc_inlet_set_edge(&config, (bc_edge_t)edge);
-
-    cfd_status_t status = bc_apply_inlet(u, v, nx, ny, &config);
-    if (status != CFD_SUCCESS) {
-        free(u);
-        free(v);
-        return raise_cfd_error(status, "bc_apply_inlet");
+    PyObject* result = NULL;
+    if (u.count != count || v.count != count || (p.data != NULL && p.count != count)) {
+        PyErr_Format(PyExc_ValueError, "u, v and p must have nx*ny = %zd elements", count);
+    } else if (resolve_grid_coordinates(grid_obj, (size_t)nx, (size_t)ny, &x, &y) == 0) {
+        gradient_inputs in = {u.data, v.data, p.data, x.data, y.data, (size_t)nx, (size_t)ny};
+        result = compute_gradient_fields(&in, fields, out_obj);
+        release_double_buffer(&x);
+        release_double_buffer(&y);
     }
+    release_double_buffer(&u);
+    release_double_buffer(&v);
+    release_double_buffer(&p);
+    return result;
+}
 
-    // Copy back to lists
-    for (size_t i = 0; i < size; i++) {
-        PyObject* u_val = PyFloat_FromDouble(u[i]);
-        PyObject* v_val = PyFloat_FromDouble(v[i]);
-        if (u_val == NULL || v_val == NULL) {
-            Py_XDECREF(u_val);
-            Py_XDECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
+/*
+ * Line sampling
+ *
+ * Each line is resolved to sample points first; all lines of a call share
+ * one allocation per output so every field is interpolated in a single
+ * parallel pass. Per-line results are views into those shared arrays.
+ */
+
+typedef struct {
+    Py_ssize_t offset;
+    Py_ssize_t count;
+    double* vertices;  // Polyline vertices, NULL for a grid line
+    Py_ssize_t num_vertices;
+    int axis;          // Grid lines: 0 for constant x, 1 for constant y
+    double value;
+} line_spec;
+
+static int parse_line_spec(PyObject* item, Py_ssize_t index, const double* x, size_t nx,
+                           const double* y, size_t ny, Py_ssize_t num_points, line_spec* line) {
+    memset(line, 0, sizeof(*line));
+    if (PyDict_Check(item)) {
+        PyObject* value = PyDict_GetItemString(item, "x");
+        line->axis = 0;
+        if (value == NULL) {
+            value = PyDict_GetItemString(item, "y");
+            line->axis = 1;
         }
-        if (PyList_SetItem(u_list, i, u_val) < 0) {
-            Py_DECREF(u_val);
-            Py_DECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
+        if (value == NULL || PyDict_Size(item) != 1) {
+            PyErr_Format(PyExc_ValueError, "line %zd: dict lines must be {'x': x0} or {'y': y0}",
+                         index);
+            return -1;
         }
-        if (PyList_SetItem(v_list, i, v_val) < 0) {
-            Py_DECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
+        line->value = PyFloat_AsDouble(value);
+        if (line->value == -1.0 && PyErr_Occurred()) {
+            return -1;
+        }
+        const double* c = line->axis == 0 ? x : y;
+        size_t n = line->axis == 0 ? nx : ny;
+        if (!(line->value >= c[0] && line->value <= c[n - 1])) {
+            PyErr_Format(PyExc_ValueError, "line %zd: %c = %g is outside the grid",
+                         index, line->axis == 0 ? 'x' : 'y', line->value);
+            return -1;
+        }
+        line->count = (Py_ssize_t)(line->axis == 0 ? ny : nx);
+        return 0;
+    }
+
+    PyObject* vertices = PySequence_List(item);
+    if (vertices == NULL) {
+        return -1;
+    }
+    Py_ssize_t nv = PyList_Size(vertices);
+    if (nv < 2) {
+        PyErr_Format(PyExc_ValueError, "line %zd: a polyline needs at least 2 points", index);
+        Py_DECREF(vertices);
+        return -1;
+    }
+    line->vertices = (double*)malloc((size_t)nv * 2 * sizeof(double));
+    if (line->vertices == NULL) {
+        Py_DECREF(vertices);
+        PyErr_NoMemory();
+        return -1;
+    }
+    int ok = 1;
+    for (Py_ssize_t v = 0; ok && v < nv; v++) {
+        PyObject* pair = PySequence_List(PyList_GetItem(vertices, v));
+        ok = pair != NULL;
+        if (ok && PyList_Size(pair) != 2) {
+            PyErr_Format(PyExc_ValueError, "line %zd: points must be (x, y) pairs", index);
+            ok = 0;
+        }
+        if (ok) {
+            line->vertices[2 * v] = PyFloat_AsDouble(PyList_GetItem(pair, 0));
+            line->vertices[2 * v + 1] = PyFloat_AsDouble(PyList_GetItem(pair, 1));
+            ok = !PyErr_Occurred();
         }
+        Py_XDECREF(pair);
     }
-
-    free(u);
-    free(v);
-    Py_RETURN_NONE;
+    Py_DECREF(vertices);
+    if (!ok) {
+        free(line->vertices);
+        line->vertices = NULL;
+        return -1;
+    }
+    line->num_vertices = nv;
+    line->count = num_points;
+    return 0;
 }
 
-/*
- * Apply outlet (zero-gradient) boundary conditions to scalar field
- */
-static PyObject* bc_apply_outlet_scalar_py(PyObject* self, PyObject* args, PyObject* kwds) {
-    (void)self;
-    static char* kwlist[] = {"field", "nx", "ny", "edge", NULL};
-    PyObject* field_list;
-    size_t nx, ny;
-    int edge = BC_EDGE_RIGHT;
-
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Onn|i", kwlist,
-                                     &field_list, &nx, &ny, &edge)) {
+static PyObject* sample_lines_impl(const double* x, size_t nx, const double* y, size_t ny,
+                                   const char* const* names, const double* const* fields,
+                                   size_t num_fields, PyObject* lines, Py_ssize_t num_points) {
+    if (num_points < 2) {
+        PyErr_SetString(PyExc_ValueError, "num_points must be at least 2");
         return NULL;
     }
-
-    if (!PyList_Check(field_list)) {
-        PyErr_SetString(PyExc_TypeError, "field must be a list");
+    if (PyDict_Check(lines)) {
+        PyErr_SetString(PyExc_TypeError, "lines must be a sequence of line specifications");
         return NULL;
     }
-
-    size_t size = nx * ny;
-    if ((size_t)PyList_Size(field_list) != size) {
-        PyErr_Format(PyExc_ValueError, "field size (%zd) must match nx*ny (%zu)",
-                     PyList_Size(field_list), size);
+    PyObject* items = PySequence_List(lines);
+    if (items == NULL) {
         return NULL;
     }
+    Py_ssize_t num_lines = PyList_Size(items);
+    line_spec* specs = (line_spec*)calloc((size_t)(num_lines > 0 ? num_lines : 1),
+                                          sizeof(line_spec));
+    if (specs == NULL) {
+        Py_DECREF(items);
+        return PyErr_NoMemory();
+    }
 
-    // Convert list to C array
-    double* field = (double*)malloc(size * sizeof(double));
-    if (field == NULL) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate field array");
-        return NULL;
+    // Outputs 0-2 are x, y, distance; the fields follow
+    size_t num_out = 3 + num_fields;
+    double_buffer* bufs = (double_buffer*)calloc(num_out, sizeof(double_buffer));
+    double** out = (double**)calloc(num_out, sizeof(double*));
+    PyObject* result = NULL;
+    Py_ssize_t total = 0;
+    int ok = bufs != NULL && out != NULL;
+    if (!ok) {
+        PyErr_NoMemory();
     }
 
-    for (size_t i = 0; i < size; i++) {
-        field[i] = PyFloat_AsDouble(PyList_GetItem(field_list, i));
-        if (PyErr_Occurred()) {
-            free(field);
-            return NULL;
-        }
+    for (Py_ssize_t l = 0; ok && l < num_lines; l++) {
+        ok = parse_line_spec(PyList_GetItem(items, l), l, x, nx, y, ny, num_points,
+                             &specs[l]) == 0;
+        specs[l].offset = total;
+        total += specs[l].count;
+    }
+    for (size_t o = 0; ok && o < num_out; o++) {
+        ok = alloc_double_buffer(&bufs[o], total, NULL) == 0;
+        out[o] = bufs[o].data;
     }
 
-    // Create outlet config and apply
-    bc_outlet_config_t config = bc_outlet_config_zero_gradient();
-    bc_outlet_set_edge(&config, (bc_edge_t)edge);
+    if (ok) {
+        double* px = out[0];
+        double* py = out[1];
+        double* dist = out[2];
+        for (Py_ssize_t l = 0; l < num_lines; l++) {
+            const line_spec* line = &specs[l];
+            Py_ssize_t o = line->offset;
+            if (line->vertices != NULL) {
+                polyline_resample(line->vertices, (size_t)line->num_vertices,
+                                  (size_t)line->count, px + o, py + o, dist + o);
+                continue;
+            }
+            // Grid lines sample at every node along the other axis
+            const double* c = line->axis == 0 ? y : x;
+            for (Py_ssize_t k = 0; k < line->count; k++) {
+                px[o + k] = line->axis == 0 ? line->value : c[k];
+                py[o + k] = line->axis == 0 ? c[k] : line->value;
+                dist[o + k] = c[k] - c[0];
+            }
+        }
 
-    cfd_status_t status = bc_apply_outlet_scalar(field, nx, ny, &config);
-    if (status != CFD_SUCCESS) {
-        free(field);
-        return raise_cfd_error(status, "bc_apply_outlet_scalar");
+        Py_BEGIN_ALLOW_THREADS
+        bilinear_sample(x, nx, y, ny, fields, num_fields, px, py, (size_t)total, out + 3);
+        Py_END_ALLOW_THREADS
+
+        result = PyList_New(num_lines);
+        ok = result != NULL;
     }
 
-    // Copy back to list
-    for (size_t i = 0; i < size; i++) {
-        PyObject* val = PyFloat_FromDouble(field[i]);
-        if (val == NULL) {
-            free(field);
-            return NULL;
+    static const char* const coord_names[3] = {"x", "y", "distance"};
+    for (Py_ssize_t l = 0; ok && l < num_lines; l++) {
+        PyObject* entry = PyDict_New();
+        ok = entry != NULL;
+        for (size_t o = 0; ok && o < num_out; o++) {
+            PyObject* view = make_double_view(bufs[o].owner, out[o] + specs[l].offset,
+                                              specs[l].count, 0);
+            ok = view != NULL &&
+                 PyDict_SetItemString(entry, o < 3 ? coord_names[o] : names[o - 3], view) == 0;
+            Py_XDECREF(view);
         }
-        if (PyList_SetItem(field_list, i, val) < 0) {
-            Py_DECREF(val);
-            free(field);
-            return NULL;
+        if (ok) {
+            PyList_SetItem(result, l, entry);
+        } else {
+            Py_XDECREF(entry);
         }
     }
 
-    free(field);
-    Py_RETURN_NONE;
-}
-
-/*
- * Apply outlet boundary conditions to velocity fields
- */
-static PyObject* bc_apply_outlet_velocity_py(PyObject* self, PyObject* args, PyObject* kwds) {
-    (void)self;
-    static char* kwlist[] = {"u", "v", "nx", "ny", "edge", NULL};
-    PyObject* u_list;
-    PyObject* v_list;
-    size_t nx, ny;
-    int edge = BC_EDGE_RIGHT;
-
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOnn|i", kwlist,
-                                     &u_list, &v_list, &nx, &ny, &edge)) {
-        return NULL;
+    for (Py_ssize_t l = 0; l < num_lines; l++) {
+        free(specs[l].vertices);
     }
-
-    if (!PyList_Check(u_list) || !PyList_Check(v_list)) {
-        PyErr_SetString(PyExc_TypeError, "u and v must be lists");
-        return NULL;
+    free(specs);
+    for (size_t o = 0; bufs != NULL && o < num_out; o++) {
+        release_double_buffer(&bufs[o]);
     }
-
-    size_t size = nx * ny;
-    if ((size_t)PyList_Size(u_list) != size || (size_t)PyList_Size(v_list) != size) {
-        PyErr_SetString(PyExc_ValueError, "u and v sizes must match nx*ny");
+    free(bufs);
+    free(out);
+    Py_DECREF(items);
+    if (!ok) {
+        Py_XDECREF(result);
         return NULL;
     }
+    return result;
+}
 
-    // Convert lists to C arrays
-    double* u = (double*)malloc(size * sizeof(double));
-    double* v = (double*)malloc(size * sizeof(double));
-    if (u == NULL || v == NULL) {
-        free(u);
-        free(v);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate velocity arrays");
-        return NULL;
-    }
+/*
+ * Named float64 fields taken from a dict, or a single buffer named "values"
+ */
+typedef struct {
+    Py_ssize_t num_fields;
+    Py_ssize_t acquired;
+    double_buffer* bufs;
+    const double** data;
+    const char** names;
+    PyObject* keys;
+    PyObject* values;
+    PyObject* name_bytes;  // Keeps the UTF-8 names alive
+} named_fields;
+
+static void release_named_fields(named_fields* nf) {
+    for (Py_ssize_t f = 0; f < nf->acquired; f++) {
+        release_double_buffer(&nf->bufs[f]);
+    }
+    free(nf->bufs);
+    free(nf->data);
+    free(nf->names);
+    Py_XDECREF(nf->name_bytes);
+    Py_XDECREF(nf->keys);
+    Py_XDECREF(nf->values);
+    memset(nf, 0, sizeof(*nf));
+}
 
-    for (size_t i = 0; i < size; i++) {
-        u[i] = PyFloat_AsDouble(PyList_GetItem(u_list, i));
-        v[i] = PyFloat_AsDouble(PyList_GetItem(v_list, i));
-        if (PyErr_Occurred()) {
-            free(u);
-            free(v);
-            return NULL;
+static int acquire_named_fields(PyObject* data_obj, Py_ssize_t count, named_fields* nf) {
+    memset(nf, 0, sizeof(*nf));
+    if (PyDict_Check(data_obj)) {
+        nf->keys = PyDict_Keys(data_obj);
+        nf->values = PyDict_Values(data_obj);
+    } else {
+        nf->keys = Py_BuildValue("[s]", "values");
+        nf->values = PyList_New(1);
+        if (nf->values != NULL) {
+            Py_INCREF(data_obj);
+            PyList_SetItem(nf->values, 0, data_obj);
         }
     }
+    if (nf->keys == NULL || nf->values == NULL) {
+        release_named_fields(nf);
+        return -1;
+    }
 
-    // Create outlet config and apply
-    bc_outlet_config_t config = bc_outlet_config_zero_gradient();
-    bc_outlet_set_edge(&config, (bc_edge_t)edge);
-
-    cfd_status_t status = bc_apply_outlet_velocity(u, v, nx, ny, &config);
-    if (status != CFD_SUCCESS) {
-        free(u);
-        free(v);
-        return raise_cfd_error(status, "bc_apply_outlet_velocity");
+    nf->num_fields = PyList_Size(nf->values);
+    size_t alloc = (size_t)(nf->num_fields > 0 ? nf->num_fields : 1);
+    nf->bufs = (double_buffer*)calloc(alloc, sizeof(double_buffer));
+    nf->data = (const double**)calloc(alloc, sizeof(double*));
+    nf->names = (const char**)calloc(alloc, sizeof(char*));
+    nf->name_bytes = PyList_New(nf->num_fields);
+    if (nf->bufs == NULL || nf->data == NULL || nf->names == NULL || nf->name_bytes == NULL) {
+        if (nf->name_bytes != NULL) {
+            PyErr_NoMemory();
+        }
+        release_named_fields(nf);
+        return -1;
     }
 
-    // Copy back to lists
-    for (size_t i = 0; i < size; i++) {
-        PyObject* u_val = PyFloat_FromDouble(u[i]);
-        PyObject* v_val = PyFloat_FromDouble(v[i]);
-        if (u_val == NULL || v_val == NULL) {
-            Py_XDECREF(u_val);
-            Py_XDECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
+    for (Py_ssize_t f = 0; f < nf->num_fields; f++) {
+        PyObject* key = PyList_GetItem(nf->keys, f);
+        if (!PyUnicode_Check(key)) {
+            PyErr_SetString(PyExc_TypeError, "data dict keys must be strings");
+            release_named_fields(nf);
+            return -1;
         }
-        if (PyList_SetItem(u_list, i, u_val) < 0) {
-            Py_DECREF(u_val);
-            Py_DECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
+        PyObject* encoded = PyUnicode_AsUTF8String(key);
+        if (encoded == NULL) {
+            release_named_fields(nf);
+            return -1;
         }
-        if (PyList_SetItem(v_list, i, v_val) < 0) {
-            Py_DECREF(v_val);
-            free(u);
-            free(v);
-            return NULL;
+        PyList_SetItem(nf->name_bytes, f, encoded);
+        nf->names[f] = PyBytes_AsString(encoded);
+        if (acquire_double_buffer(PyList_GetItem(nf->values, f), 0, &nf->bufs[f]) < 0) {
+            release_named_fields(nf);
+            return -1;
+        }
+        nf->acquired++;
+        nf->data[f] = nf->bufs[f].data;
+        if (nf->bufs[f].count != count) {
+            PyErr_Format(PyExc_ValueError, "field '%s' must have nx*ny = %zd elements, got %zd",
+                         nf->names[f], count, nf->bufs[f].count);
+            release_named_fields(nf);
+            return -1;
         }
     }
-
-    free(u);
-    free(v);
-    Py_RETURN_NONE;
+    return 0;
 }
 
-//=============================================================================
-// DERIVED FIELDS API (Phase 3)
-//=============================================================================
-
 /*
- * Calculate field statistics (min, max, avg, sum)
+ * Sample one or more fields along batches of lines with bilinear interpolation
  */
-static PyObject* calculate_field_stats_py(PyObject* self, PyObject* args) {
+static PyObject* sample_lines_py(PyObject* self, PyObject* args, PyObject* kwds) {
     (void)self;
-    PyObject* data_list;
+    static const char* const kwlist[] = {"data", "nx", "ny", "lines", "grid", "num_points", NULL};
+    PyObject* data_obj;
+    Py_ssize_t nx, ny;
+    PyObject* lines;
+    PyObject* grid_obj = Py_None;
+    Py_ssize_t num_points = 100;
 
-    if (!PyArg_ParseTuple(args, "O", &data_list)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OnnO|On", (char**)kwlist, &data_obj,
+                                     &nx, &ny, &lines, &grid_obj, &num_points)) {
         return NULL;
     }
-
-    if (!PyList_Check(data_list)) {
-        PyErr_SetString(PyExc_TypeError, "data must be a list");
+    if (nx < 2 || ny < 2) {
+        PyErr_SetString(PyExc_ValueError, "nx and ny must be at least 2");
         return NULL;
     }
 
-    Py_ssize_t count = PyList_Size(data_list);
-    if (count == 0) {
-        PyErr_SetString(PyExc_ValueError, "data list cannot be empty");
+    // A dict samples every named field; anything else is one field "values"
+    named_fields nf;
+    if (acquire_named_fields(data_obj, nx * ny, &nf) < 0) {
         return NULL;
     }
-
-    // Convert list to C array
-    double* data = (double*)malloc((size_t)count * sizeof(double));
-    if (data == NULL) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate data array");
-        return NULL;
+    PyObject* result = NULL;
+    double_buffer x, y;
+    if (resolve_grid_coordinates(grid_obj, (size_t)nx, (size_t)ny, &x, &y) == 0) {
+        result = sample_lines_impl(x.data, (size_t)nx, y.data, (size_t)ny, nf.names, nf.data,
+                                   (size_t)nf.num_fields, lines, num_points);
+        release_double_buffer(&x);
+        release_double_buffer(&y);
     }
+    release_named_fields(&nf);
+    return result;
+}
 
-    for (Py_ssize_t i = 0; i < count; i++) {
-        PyObject* item = PyList_GetItem(data_list, i);
-        data[i] = PyFloat_AsDouble(item);
-        if (PyErr_Occurred()) {
-            free(data);
-            return NULL;
+// Unpack a tuple or list of 2 or 4 ints; the format's ";message" is the TypeError text
+static int parse_index_tuple(PyObject* obj, const char* format, Py_ssize_t* a, Py_ssize_t* b,
+                             Py_ssize_t* c, Py_ssize_t* d) {
+    if (!PyTuple_Check(obj) && !PyList_Check(obj)) {
+        PyErr_SetString(PyExc_TypeError, strchr(format, ';') + 1);
+        return -1;
+    }
+    PyObject* items = PySequence_Tuple(obj);
+    if (items == NULL) {
+        return -1;
+    }
+    int ok = c == NULL ? PyArg_ParseTuple(items, format, a, b)
+                       : PyArg_ParseTuple(items, format, a, b, c, d);
+    Py_DECREF(items);
+    return ok ? 0 : -1;
+}
+
+/*
+ * Parse factor (int, (fx, fy) or NULL for 1), roi ((i0, i1, j0, j1) or None)
+ * and mode into a resample plan for an nx x ny field
+ */
+static int parse_resample_plan(PyObject* factor_obj, PyObject* roi_obj, const char* mode,
+                               size_t nx, size_t ny, resample_plan* plan) {
+    Py_ssize_t fx = 1, fy = 1;
+    if (factor_obj == NULL) {
+        // Keep the full resolution
+    } else if (PyLong_Check(factor_obj)) {
+        fx = fy = PyLong_AsSsize_t(factor_obj);
+        if (fx == -1 && PyErr_Occurred()) {
+            return -1;
         }
+    } else if (parse_index_tuple(factor_obj, "nn;factor must be an int or an (fx, fy) pair",
+                                 &fx, &fy, NULL, NULL) < 0) {
+        return -1;
     }
 
-    // Calculate statistics
-    field_stats stats = calculate_field_statistics(data, (size_t)count);
-    free(data);
-
-    // Return as dictionary
-    PyObject* result = PyDict_New();
-    if (result == NULL) {
-        return NULL;
+    Py_ssize_t i0 = 0, i1 = (Py_ssize_t)nx, j0 = 0, j1 = (Py_ssize_t)ny;
+    if (roi_obj != Py_None &&
+        parse_index_tuple(roi_obj, "nnnn;roi must be an (i0, i1, j0, j1) tuple or None",
+                          &i0, &i1, &j0, &j1) < 0) {
+        return -1;
+    }
+    if (fx < 1 || fy < 1) {
+        PyErr_SetString(PyExc_ValueError, "factor must be at least 1");
+        return -1;
+    }
+    if (i0 < 0 || j0 < 0 || i0 >= i1 || j0 >= j1) {
+        PyErr_SetString(PyExc_ValueError, "roi must satisfy 0 <= i0 < i1 and 0 <= j0 < j1");
+        return -1;
     }
 
-    PyObject* min_val = PyFloat_FromDouble(stats.min_val);
-    PyObject* max_val = PyFloat_FromDouble(stats.max_val);
-    PyObject* avg_val = PyFloat_FromDouble(stats.avg_val);
-    PyObject* sum_val = PyFloat_FromDouble(stats.sum_val);
+    if (strcmp(mode, "average") == 0) {
+        plan->mode = RESAMPLE_AVERAGE;
+    } else if (strcmp(mode, "inject") == 0) {
+        plan->mode = RESAMPLE_INJECT;
+    } else {
+        PyErr_Format(PyExc_ValueError, "mode must be 'average' or 'inject', got '%s'", mode);
+        return -1;
+    }
+    plan->i0 = (size_t)i0;
+    plan->i1 = (size_t)i1;
+    plan->j0 = (size_t)j0;
+    plan->j1 = (size_t)j1;
+    plan->fx = (size_t)fx;
+    plan->fy = (size_t)fy;
+    if (resample_plan_check(plan, nx, ny) != CFD_SUCCESS) {
+        PyErr_Format(PyExc_ValueError, "roi (%zd, %zd, %zd, %zd) exceeds the %zu x %zu grid",
+                     i0, i1, j0, j1, nx, ny);
+        return -1;
+    }
+    return 0;
+}
 
-    if (min_val == NULL || max_val == NULL || avg_val == NULL || sum_val == NULL) {
-        Py_XDECREF(min_val);
-        Py_XDECREF(max_val);
-        Py_XDECREF(avg_val);
-        Py_XDECREF(sum_val);
-        Py_DECREF(result);
-        return NULL;
+static PyObject* resample_impl(const double* x, const double* y, size_t nx,
+                               const char* const* names, const double* const* fields,
+                               size_t num_fields, const resample_plan* plan) {
+    size_t mx = resample_out_nx(plan);
+    size_t my = resample_out_ny(plan);
+    double* ox;
+    double* oy;
+    PyObject* x_view = new_double_array((Py_ssize_t)mx, &ox);
+    PyObject* y_view = new_double_array((Py_ssize_t)my, &oy);
+    PyObject* result = PyDict_New();
+    size_t f = 0;
+    double** out = (double**)calloc(num_fields > 0 ? num_fields : 1, sizeof(double*));
+    PyObject** views = (PyObject**)calloc(num_fields > 0 ? num_fields : 1, sizeof(PyObject*));
+    int ok = x_view != NULL && y_view != NULL && result != NULL;
+    if (ok && (out == NULL || views == NULL)) {
+        PyErr_NoMemory();
+        ok = 0;
+    }
+    for (; ok && f < num_fields; f++) {
+        views[f] = new_double_array((Py_ssize_t)(mx * my), &out[f]);
+        ok = views[f] != NULL;
+    }
+
+    if (ok) {
+        Py_BEGIN_ALLOW_THREADS
+        resample_axis(x, plan->i0, plan->i1, plan->fx, plan->mode, ox);
+        resample_axis(y, plan->j0, plan->j1, plan->fy, plan->mode, oy);
+        for (size_t k = 0; k < num_fields; k++) {
+            resample_field(fields[k], nx, plan, out[k]);
+        }
+        Py_END_ALLOW_THREADS
+
+        PyObject* dims = Py_BuildValue("{s:n,s:n}", "nx", (Py_ssize_t)mx, "ny", (Py_ssize_t)my);
+        ok = dims != NULL && PyDict_Update(result, dims) == 0 &&
+             PyDict_SetItemString(result, "x", x_view) == 0 &&
+             PyDict_SetItemString(result, "y", y_view) == 0;
+        Py_XDECREF(dims);
+    }
+    for (size_t k = 0; ok && k < num_fields; k++) {
+        ok = PyDict_SetItemString(result, names[k], views[k]) == 0;
     }
 
-    if (PyDict_SetItemString(result, "min", min_val) < 0 ||
-        PyDict_SetItemString(result, "max", max_val) < 0 ||
-        PyDict_SetItemString(result, "avg", avg_val) < 0 ||
-        PyDict_SetItemString(result, "sum", sum_val) < 0) {
-        Py_DECREF(min_val);
-        Py_DECREF(max_val);
-        Py_DECREF(avg_val);
-        Py_DECREF(sum_val);
-        Py_DECREF(result);
+    for (size_t k = 0; views != NULL && k < num_fields; k++) {
+        Py_XDECREF(views[k]);
+    }
+    free(views);
+    free(out);
+    Py_XDECREF(x_view);
+    Py_XDECREF(y_view);
+    if (!ok) {
+        Py_XDECREF(result);
         return NULL;
     }
-
-    Py_DECREF(min_val);
-    Py_DECREF(max_val);
-    Py_DECREF(avg_val);
-    Py_DECREF(sum_val);
-
     return result;
 }
 
 /*
- * Compute velocity magnitude from u,v components
+ * Restrict fields by an integer factor and/or extract an index-space region
  */
-static PyObject* compute_velocity_magnitude_py(PyObject* self, PyObject* args) {
+static PyObject* resample_fields_py(PyObject* self, PyObject* args, PyObject* kwds) {
     (void)self;
-    PyObject* u_list;
-    PyObject* v_list;
-    size_t nx, ny;
+    static const char* const kwlist[] = {"data", "nx", "ny", "factor", "roi", "mode", "grid",
+                                         NULL};
+    PyObject* data_obj;
+    Py_ssize_t nx, ny;
+    PyObject* factor_obj = NULL;
+    PyObject* roi_obj = Py_None;
+    const char* mode = "average";
+    PyObject* grid_obj = Py_None;
 
-    if (!PyArg_ParseTuple(args, "OOnn", &u_list, &v_list, &nx, &ny)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Onn|OOsO", (char**)kwlist, &data_obj,
+                                     &nx, &ny, &factor_obj, &roi_obj, &mode, &grid_obj)) {
         return NULL;
     }
-
-    if (!PyList_Check(u_list) || !PyList_Check(v_list)) {
-        PyErr_SetString(PyExc_TypeError, "u and v must be lists");
+    if (nx < 2 || ny < 2) {
+        PyErr_SetString(PyExc_ValueError, "nx and ny must be at least 2");
         return NULL;
     }
-
-    size_t size = nx * ny;
-    if ((size_t)PyList_Size(u_list) != size || (size_t)PyList_Size(v_list) != size) {
-        PyErr_Format(PyExc_ValueError,
-                     "u and v size must match nx*ny (%zu), got %zd and %zd",
-                     size, PyList_Size(u_list), PyList_Size(v_list));
+    resample_plan plan;
+    if (parse_resample_plan(factor_obj, roi_obj, mode, (size_t)nx, (size_t)ny, &plan) < 0) {
         return NULL;
     }
 
-    // Create a temporary flow_field structure
-    flow_field* field = flow_field_create(nx, ny, 1);
-    if (field == NULL) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate flow field");
+    named_fields nf;
+    if (acquire_named_fields(data_obj, nx * ny, &nf) < 0) {
         return NULL;
     }
-
-    // Copy u, v from lists
-    for (size_t i = 0; i < size; i++) {
-        field->u[i] = PyFloat_AsDouble(PyList_GetItem(u_list, i));
-        field->v[i] = PyFloat_AsDouble(PyList_GetItem(v_list, i));
-        if (PyErr_Occurred()) {
-            flow_field_destroy(field);
-            return NULL;
-        }
+    PyObject* result = NULL;
+    double_buffer x, y;
+    if (resolve_grid_coordinates(grid_obj, (size_t)nx, (size_t)ny, &x, &y) == 0) {
+        result = resample_impl(x.data, y.data, (size_t)nx, nf.names, nf.data,
+                               (size_t)nf.num_fields, &plan);
+        release_double_buffer(&x);
+        release_double_buffer(&y);
     }
+    release_named_fields(&nf);
+    return result;
+}
+
+/*
+ * Write named scalar and vector fields as a VTK XML rectilinear grid
+ */
+static PyObject* write_vtr_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static const char* const kwlist[] = {"filename", "data", "nx", "ny", "grid", "vectors",
+                                         "compress", NULL};
+    const char* filename;
+    PyObject* data_obj;
+    Py_ssize_t nx, ny;
+    PyObject* grid_obj = Py_None;
+    PyObject* vectors_obj = Py_None;
+    int compress = 0;
 
-    // Create derived fields and compute velocity magnitude
-    derived_fields* derived = derived_fields_create(nx, ny, 1);
-    if (derived == NULL) {
-        flow_field_destroy(field);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate derived fields");
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "sOnn|OOi", (char**)kwlist, &filename,
+                                     &data_obj, &nx, &ny, &grid_obj, &vectors_obj, &compress)) {
+        return NULL;
+    }
+    if (nx < 2 || ny < 2) {
+        PyErr_SetString(PyExc_ValueError, "nx and ny must be at least 2");
+        return NULL;
+    }
+    if (vectors_obj != Py_None && !PyDict_Check(vectors_obj)) {
+        PyErr_SetString(PyExc_TypeError, "vectors must be a dict of (u, v) or (u, v, w)");
         return NULL;
     }
 
-    derived_fields_compute_velocity_magnitude(derived, field);
-
-    // Create output list
-    PyObject* result = PyList_New(size);
-    if (result == NULL) {
-        derived_fields_destroy(derived);
-        flow_field_destroy(field);
+    named_fields nf;
+    if (acquire_named_fields(data_obj, nx * ny, &nf) < 0) {
         return NULL;
     }
 
-    for (size_t i = 0; i < size; i++) {
-        PyObject* val = PyFloat_FromDouble(derived->velocity_magnitude[i]);
-        if (val == NULL) {
-            Py_DECREF(result);
-            derived_fields_destroy(derived);
-            flow_field_destroy(field);
-            return NULL;
+    // Vector fields reuse named_fields with three buffer slots per vector;
+    // slots left empty by 2-component vectors release as no-ops
+    named_fields vf;
+    memset(&vf, 0, sizeof(vf));
+    vtk_xml_array* arrays = NULL;
+    PyObject* result = NULL;
+    double_buffer x, y;
+    int have_grid = 0;
+    if (vectors_obj != Py_None) {
+        vf.keys = PyDict_Keys(vectors_obj);
+        vf.values = PyDict_Values(vectors_obj);
+        if (vf.keys == NULL || vf.values == NULL) {
+            goto done;
         }
-        if (PyList_SetItem(result, i, val) < 0) {
-            Py_DECREF(val);
-            Py_DECREF(result);
-            derived_fields_destroy(derived);
-            flow_field_destroy(field);
-            return NULL;
+        vf.num_fields = PyList_Size(vf.keys);
+    }
+    size_t num_arrays = (size_t)(nf.num_fields + vf.num_fields);
+    arrays = (vtk_xml_array*)calloc(num_arrays > 0 ? num_arrays : 1, sizeof(vtk_xml_array));
+    vf.bufs = (double_buffer*)calloc((size_t)(3 * vf.num_fields + 1), sizeof(double_buffer));
+    vf.name_bytes = PyList_New(vf.num_fields);
+    if (arrays == NULL || vf.bufs == NULL || vf.name_bytes == NULL) {
+        if (vf.name_bytes != NULL) {
+            PyErr_NoMemory();
+        }
+        goto done;
+    }
+    for (Py_ssize_t f = 0; f < nf.num_fields; f++) {
+        arrays[f].name = nf.names[f];
+        arrays[f].components = 1;
+        arrays[f].data[0] = nf.data[f];
+    }
+    for (Py_ssize_t f = 0; f < vf.num_fields; f++) {
+        PyObject* key = PyList_GetItem(vf.keys, f);
+        if (!PyUnicode_Check(key)) {
+            PyErr_SetString(PyExc_TypeError, "vectors dict keys must be strings");
+            goto done;
+        }
+        PyObject* encoded = PyUnicode_AsUTF8String(key);
+        if (encoded == NULL) {
+            goto done;
         }
+        PyList_SetItem(vf.name_bytes, f, encoded);
+        PyObject* comps = PySequence_Tuple(PyList_GetItem(vf.values, f));
+        if (comps == NULL || (PyTuple_Size(comps) != 2 && PyTuple_Size(comps) != 3)) {
+            if (comps != NULL) {
+                PyErr_Format(PyExc_ValueError, "vector '%s' must have 2 or 3 components",
+                             PyBytes_AsString(encoded));
+            }
+            Py_XDECREF(comps);
+            goto done;
+        }
+        vtk_xml_array* a = &arrays[nf.num_fields + f];
+        a->name = PyBytes_AsString(encoded);
+        a->components = 3;
+        for (Py_ssize_t c = 0; c < PyTuple_Size(comps); c++) {
+            double_buffer* buf = &vf.bufs[3 * f + c];
+            if (acquire_double_buffer(PyTuple_GetItem(comps, c), 0, buf) < 0) {
+                Py_DECREF(comps);
+                goto done;
+            }
+            vf.acquired = 3 * f + c + 1;
+            if (buf->count != nx * ny) {
+                PyErr_Format(PyExc_ValueError,
+                             "vector '%s' components must have nx*ny = %zd elements, got %zd",
+                             a->name, nx * ny, buf->count);
+                Py_DECREF(comps);
+                goto done;
+            }
+            a->data[c] = buf->data;
+        }
+        Py_DECREF(comps);
     }
 
-    derived_fields_destroy(derived);
-    flow_field_destroy(field);
+    if (resolve_grid_coordinates(grid_obj, (size_t)nx, (size_t)ny, &x, &y) < 0) {
+        goto done;
+    }
+    have_grid = 1;
+    vtk_xml_coords geom = {x.data, y.data, NULL, (size_t)nx, (size_t)ny, 1};
+    if (write_vtr_file(filename, &geom, arrays, num_arrays, compress) == 0) {
+        result = Py_None;
+        Py_INCREF(result);
+    }
 
+done:
+    if (have_grid) {
+        release_double_buffer(&x);
+        release_double_buffer(&y);
+    }
+    release_named_fields(&vf);
+    release_named_fields(&nf);
+    free(arrays);
     return result;
 }
 
 /*
- * Compute all field statistics for flow field components
+ * Append one dataset to a ParaView .pvd collection
  */
-static PyObject* compute_flow_statistics_py(PyObject* self, PyObject* args) {
+static PyObject* append_pvd_py(PyObject* self, PyObject* args, PyObject* kwds) {
     (void)self;
-    PyObject* u_list;
-    PyObject* v_list;
-    PyObject* p_list;
-    size_t nx, ny;
-
-    if (!PyArg_ParseTuple(args, "OOOnn", &u_list, &v_list, &p_list, &nx, &ny)) {
-        return NULL;
-    }
+    static const char* const kwlist[] = {"filename", "dataset", "time", "part", "create_new",
+                                         NULL};
+    const char* filename;
+    const char* dataset;
+    double time;
+    int part = 0;
+    int create_new = 0;
 
-    if (!PyList_Check(u_list) || !PyList_Check(v_list) || !PyList_Check(p_list)) {
-        PyErr_SetString(PyExc_TypeError, "u, v, and p must be lists");
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "ssd|ip", (char**)kwlist, &filename, &dataset,
+                                     &time, &part, &create_new)) {
         return NULL;
     }
-
-    size_t size = nx * ny;
-    if ((size_t)PyList_Size(u_list) != size ||
-        (size_t)PyList_Size(v_list) != size ||
-        (size_t)PyList_Size(p_list) != size) {
-        PyErr_Format(PyExc_ValueError,
-                     "All fields must have size nx*ny (%zu)", size);
+    if (append_pvd_entry(filename, dataset, time, part, create_new) < 0) {
         return NULL;
     }
+    Py_RETURN_NONE;
+}
 
-    // Create a temporary flow_field structure
-    flow_field* field = flow_field_create(nx, ny, 1);
-    if (field == NULL) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate flow field");
-        return NULL;
+/*
+ * Energy spectrum of u and v on a uniform grid. skip_endpoint drops the last
+ * column and row when they repeat the first (periodic grids that store both
+ * ends); the period is the number of transformed points times the spacing.
+ */
+static PyObject* energy_spectrum_impl(const double* u, const double* v, const double* x,
+                                      const double* y, size_t nx, size_t ny, int skip_endpoint) {
+    const double* coords[2] = {x, y};
+    size_t n[2] = {nx, ny};
+    double period[2];
+    for (int axis = 0; axis < 2; axis++) {
+        const double* c = coords[axis];
+        double h = (c[n[axis] - 1] - c[0]) / (double)(n[axis] - 1);
+        for (size_t i = 1; i < n[axis]; i++) {
+            if (fabs(c[i] - c[i - 1] - h) > 1e-6 * fabs(h)) {
+                PyErr_SetString(PyExc_ValueError, "energy spectra need a uniform grid");
+                return NULL;
+            }
+        }
+        period[axis] = h * (double)(skip_endpoint ? n[axis] - 1 : n[axis]);
     }
+    size_t mx = skip_endpoint ? nx - 1 : nx;
+    size_t my = skip_endpoint ? ny - 1 : ny;
 
-    // Copy data from lists
-    for (size_t i = 0; i < size; i++) {
-        field->u[i] = PyFloat_AsDouble(PyList_GetItem(u_list, i));
-        field->v[i] = PyFloat_AsDouble(PyList_GetItem(v_list, i));
-        field->p[i] = PyFloat_AsDouble(PyList_GetItem(p_list, i));
-        if (PyErr_Occurred()) {
-            flow_field_destroy(field);
-            return NULL;
+    energy_spectrum spec;
+    cfd_status_t status;
+    Py_BEGIN_ALLOW_THREADS
+    status = energy_spectrum_compute(u, v, nx, mx, my, period[0], period[1], &spec);
+    Py_END_ALLOW_THREADS
+    if (status != CFD_SUCCESS) {
+        return raise_cfd_status(status, "energy_spectrum");
+    }
+
+    // (wavenumber name, spectrum name, count, wavenumber step, values)
+    struct {
+        const char* k_name;
+        const char* e_name;
+        size_t count;
+        double dk;
+        const double* values;
+    } series[3] = {
+        {"k", "E", spec.num_shells, spec.dk, spec.shell},
+        {"kx", "E_x", spec.num_kx, spec.dkx, spec.ex},
+        {"ky", "E_y", spec.num_ky, spec.dky, spec.ey},
+    };
+    PyObject* result = Py_BuildValue("{s:d,s:d}", "energy", spec.energy, "dk", spec.dk);
+    for (int s = 0; result != NULL && s < 3; s++) {
+        double* k;
+        double* e;
+        PyObject* k_view = new_double_array((Py_ssize_t)series[s].count, &k);
+        PyObject* e_view = new_double_array((Py_ssize_t)series[s].count, &e);
+        int ok = k_view != NULL && e_view != NULL;
+        if (ok) {
+            for (size_t i = 0; i < series[s].count; i++) {
+                k[i] = series[s].dk * (double)i;
+            }
+            memcpy(e, series[s].values, series[s].count * sizeof(double));
+            ok = PyDict_SetItemString(result, series[s].k_name, k_view) == 0 &&
+                 PyDict_SetItemString(result, series[s].e_name, e_view) == 0;
+        }
+        Py_XDECREF(k_view);
+        Py_XDECREF(e_view);
+        if (!ok) {
+            Py_CLEAR(result);
         }
     }
+    energy_spectrum_free(&spec);
+    return result;
+}
 
-    // Create derived fields and compute statistics
-    derived_fields* derived = derived_fields_create(nx, ny, 1);
-    if (derived == NULL) {
-        flow_field_destroy(field);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate derived fields");
+/*
+ * Radially binned and 1D kinetic energy spectra of periodic u, v fields
+ */
+static PyObject* energy_spectrum_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static const char* const kwlist[] = {"u", "v", "nx", "ny", "grid", "skip_endpoint", NULL};
+    PyObject* u_obj;
+    PyObject* v_obj;
+    Py_ssize_t nx, ny;
+    PyObject* grid_obj = Py_None;
+    int skip_endpoint = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOnn|Op", (char**)kwlist, &u_obj, &v_obj,
+                                     &nx, &ny, &grid_obj, &skip_endpoint)) {
         return NULL;
     }
-
-    // First compute velocity magnitude (required for vel_mag_stats)
-    derived_fields_compute_velocity_magnitude(derived, field);
-    // Then compute all statistics
-    derived_fields_compute_statistics(derived, field);
-
-    // Build result dictionary with all statistics
-    PyObject* result = PyDict_New();
-    if (result == NULL) {
-        derived_fields_destroy(derived);
-        flow_field_destroy(field);
+    Py_ssize_t min_n = skip_endpoint ? 3 : 2;
+    if (nx < min_n || ny < min_n) {
+        PyErr_Format(PyExc_ValueError, "nx and ny must be at least %zd", min_n);
         return NULL;
     }
 
-    // Helper macro to add stats dict (properly handles reference counts and errors)
-    #define ADD_STATS(name, stats_struct) do { \
-        PyObject* stats_dict = PyDict_New(); \
-        if (stats_dict == NULL) { \
-            Py_DECREF(result); \
-            derived_fields_destroy(derived); \
-            flow_field_destroy(field); \
-            return NULL; \
-        } \
-        PyObject* tmp_min = PyFloat_FromDouble((stats_struct).min_val); \
-        PyObject* tmp_max = PyFloat_FromDouble((stats_struct).max_val); \
-        PyObject* tmp_avg = PyFloat_FromDouble((stats_struct).avg_val); \
-        PyObject* tmp_sum = PyFloat_FromDouble((stats_struct).sum_val); \
-        if (tmp_min == NULL || tmp_max == NULL || tmp_avg == NULL || tmp_sum == NULL) { \
-            Py_XDECREF(tmp_min); \
-            Py_XDECREF(tmp_max); \
-            Py_XDECREF(tmp_avg); \
-            Py_XDECREF(tmp_sum); \
-            Py_DECREF(stats_dict); \
-            Py_DECREF(result); \
-            derived_fields_destroy(derived); \
-            flow_field_destroy(field); \
-            return NULL; \
-        } \
-        if (PyDict_SetItemString(stats_dict, "min", tmp_min) < 0 || \
-            PyDict_SetItemString(stats_dict, "max", tmp_max) < 0 || \
-            PyDict_SetItemString(stats_dict, "avg", tmp_avg) < 0 || \
-            PyDict_SetItemString(stats_dict, "sum", tmp_sum) < 0) { \
-            Py_DECREF(tmp_min); \
-            Py_DECREF(tmp_max); \
-            Py_DECREF(tmp_avg); \
-            Py_DECREF(tmp_sum); \
-            Py_DECREF(stats_dict); \
-            Py_DECREF(result); \
-            derived_fields_destroy(derived); \
-            flow_field_destroy(field); \
-            return NULL; \
-        } \
-        Py_DECREF(tmp_min); \
-        Py_DECREF(tmp_max); \
-        Py_DECREF(tmp_avg); \
-        Py_DECREF(tmp_sum); \
-        if (PyDict_SetItemString(result, name, stats_dict) < 0) { \
-            Py_DECREF(stats_dict); \
-            Py_DECREF(result); \
-            derived_fields_destroy(derived); \
-            flow_field_destroy(field); \
-            return NULL; \
-        } \
-        Py_DECREF(stats_dict); \
-    } while(0)
-
-    ADD_STATS("u", derived->u_stats);
-    ADD_STATS("v", derived->v_stats);
-    ADD_STATS("p", derived->p_stats);
-    ADD_STATS("velocity_magnitude", derived->vel_mag_stats);
+    double_buffer u, v;
+    if (acquire_double_buffer(u_obj, 0, &u) < 0) {
+        return NULL;
+    }
+    if (acquire_double_buffer(v_obj, 0, &v) < 0) {
+        release_double_buffer(&u);
+        return NULL;
+    }
+    PyObject* result = NULL;
+    double_buffer x, y;
+    if (u.count != nx * ny || v.count != nx * ny) {
+        PyErr_Format(PyExc_ValueError, "u and v must have nx*ny = %zd elements", nx * ny);
+    } else if (resolve_grid_coordinates(grid_obj, (size_t)nx, (size_t)ny, &x, &y) == 0) {
+        result = energy_spectrum_impl(u.data, v.data, x.data, y.data, (size_t)nx, (size_t)ny,
+                                      skip_endpoint);
+        release_double_buffer(&x);
+        release_double_buffer(&y);
+    }
+    release_double_buffer(&u);
+    release_double_buffer(&v);
+    return result;
+}
 
-    #undef ADD_STATS
+/*
+ * Advect tracer positions in place through a frozen velocity field
+ */
+static PyObject* advect_particles_py(PyObject* self, PyObject* args, PyObject* kwds) {
+    (void)self;
+    static const char* const kwlist[] = {"x", "y", "u", "v", "nx", "ny", "dt", "steps", "grid",
+                                         "method", NULL};
+    PyObject* x_obj;
+    PyObject* y_obj;
+    PyObject* u_obj;
+    PyObject* v_obj;
+    Py_ssize_t nx, ny;
+    double dt;
+    Py_ssize_t steps = 1;
+    PyObject* grid_obj = Py_None;
+    const char* method_name = "rk4";
 
-    derived_fields_destroy(derived);
-    flow_field_destroy(field);
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOOOnnd|nOs", (char**)kwlist, &x_obj, &y_obj,
+                                     &u_obj, &v_obj, &nx, &ny, &dt, &steps, &grid_obj,
+                                     &method_name)) {
+        return NULL;
+    }
+    if (nx < 2 || ny < 2) {
+        PyErr_SetString(PyExc_ValueError, "nx and ny must be at least 2");
+        return NULL;
+    }
+    if (steps < 1) {
+        PyErr_SetString(PyExc_ValueError, "steps must be at least 1");
+        return NULL;
+    }
+    tracer_method method;
+    if (parse_tracer_method(method_name, &method) < 0) {
+        return NULL;
+    }
 
+    // bufs: x, y (written in place), u, v
+    PyObject* objs[4] = {x_obj, y_obj, u_obj, v_obj};
+    double_buffer bufs[4];
+    int acquired = 0;
+    for (; acquired < 4; acquired++) {
+        if (acquire_double_buffer(objs[acquired], acquired < 2, &bufs[acquired]) < 0) {
+            break;
+        }
+    }
+    PyObject* result = NULL;
+    double_buffer gx, gy;
+    if (acquired < 4) {
+        // Error already set
+    } else if (bufs[0].copied || bufs[1].copied) {
+        PyErr_SetString(PyExc_TypeError,
+                         "x and y must be writable float64 buffers (e.g. NumPy arrays)");
+    } else if (bufs[0].count != bufs[1].count) {
+        PyErr_SetString(PyExc_ValueError, "x and y must have the same length");
+    } else if (bufs[2].count != nx * ny || bufs[3].count != nx * ny) {
+        PyErr_Format(PyExc_ValueError, "u and v must have nx*ny = %zd elements", nx * ny);
+    } else if (resolve_grid_coordinates(grid_obj, (size_t)nx, (size_t)ny, &gx, &gy) == 0) {
+        tracer_field field = {bufs[2].data, bufs[3].data, gx.data, gy.data, (size_t)nx,
+                              (size_t)ny};
+        size_t active;
+        Py_BEGIN_ALLOW_THREADS
+        active = tracer_advect(bufs[0].data, bufs[1].data, (size_t)bufs[0].count, &field, dt,
+                               (size_t)steps, method);
+        Py_END_ALLOW_THREADS
+        result = PyLong_FromSize_t(active);
+        release_double_buffer(&gx);
+        release_double_buffer(&gy);
+    }
+    for (int b = 0; b < acquired; b++) {
+        release_double_buffer(&bufs[b]);
+    }
     return result;
 }
 
@@ -2582,7 +9004,12 @@ static PyMethodDef cfd_python_methods[] = {
      "    ymin (float, optional): Minimum y coordinate (default: 0.0)\n"
      "    ymax (float, optional): Maximum y coordinate (default: 1.0)\n"
      "    solver_type (str, optional): Solver type name (uses library default if not specified)\n"
-     "    output_file (str, optional): VTK output file path\n\n"
+     "    output_file (str, optional): VTK output file path\n"
+     "    binary (bool, optional): Legacy BINARY encoding (big-endian float64)\n"
+     "        instead of ASCII (default: False)\n"
+     "    outputs (sequence, optional): Periodic outputs written inside the step\n"
+     "        loop, as (type, pattern[, every[, binary[, precision]]]) tuples; see\n"
+     "        Simulation.add_output()\n\n"
      "Returns:\n"
      "    list: Velocity magnitude values as a flat list"},
     {"create_grid", (PyCFunction)create_grid, METH_VARARGS | METH_KEYWORDS,
@@ -2616,9 +9043,77 @@ static PyMethodDef cfd_python_methods[] = {
      "    dt (float, optional): Time step size (default: 0.001)\n"
      "    cfl (float, optional): CFL number (default: 0.2)\n"
      "    solver_type (str, optional): Solver type name\n"
-     "    output_file (str, optional): VTK output file path\n\n"
+     "    output_file (str, optional): VTK output file path\n"
+     "    shm_name (str, optional): Write velocity_magnitude, u, v and p into a new\n"
+     "        POSIX shared-memory segment of this name instead of returning lists\n"
+     "    snapshot (bool, optional): Return the final u, v, p as a FieldSnapshot under\n"
+     "        'snapshot' and the grid as a Grid under 'grid' instead of the\n"
+     "        velocity_magnitude list (default: False)\n"
+     "    binary (bool, optional): Legacy BINARY encoding (big-endian float64)\n"
+     "        instead of ASCII (default: False)\n"
+     "    outputs (sequence, optional): Periodic outputs written inside the step\n"
+     "        loop, as (type, pattern[, every[, binary[, precision]]]) tuples; see\n"
+     "        Simulation.add_output()\n\n"
+     "Returns:\n"
+     "    dict: Results including velocity_magnitude, solver info, and stats.\n"
+     "          With shm_name, 'velocity_magnitude' is replaced by a 'shm' descriptor\n"
+     "          dict (name, size, nx, ny, fields) for attach_shared_result()"},
+    {"attach_shared_result", (PyCFunction)attach_shared_result_py, METH_VARARGS | METH_KEYWORDS,
+     "Attach to a shared-memory result segment without copying.\n\n"
+     "Args:\n"
+     "    name (str or dict): Segment name, or the 'shm' descriptor dict\n"
+     "    unlink (bool, optional): Remove the segment name after attaching (default: False).\n"
+     "        The returned views stay valid until they are garbage collected.\n\n"
+     "Returns:\n"
+     "    dict: 'name', 'nx', 'ny' and one writable memoryview of doubles per field\n"
+     "          (flat, row-major, length nx*ny)\n\n"
+     "Raises:\n"
+     "    NotImplementedError: On platforms without POSIX shared memory\n"
+     "    FileNotFoundError: If no segment of this name exists\n"
+     "    ValueError: If the segment was not written by cfd_python"},
+    {"reinit_after_fork", (PyCFunction)reinit_after_fork_py, METH_VARARGS | METH_KEYWORDS,
+     "Reset library state in a forked child process.\n\n"
+     "Registered automatically with os.register_at_fork(after_in_child=...),\n"
+     "where it only clears the error state, so inherited Simulation objects\n"
+     "remain valid and share pages with the parent copy-on-write.\n\n"
+     "With reset_library=True it also recreates the solver registry and\n"
+     "re-initializes the CFD library. Every Simulation inherited from the\n"
+     "parent is then invalid and must be recreated in the child.\n\n"
+     "num_threads only sets the thread count of later OpenMP regions; the\n"
+     "OpenMP runtime is not reinitialized.\n\n"
+     "Args:\n"
+     "    num_threads (int, optional): OpenMP threads for the child (default: unchanged)\n"
+     "    reset_library (bool, optional): Re-initialize the CFD library (default: False)"},
+    {"run_ensemble", (PyCFunction)(void(*)(void))run_ensemble_py, METH_VARARGS | METH_KEYWORDS,
+     "Advance several Simulation objects in parallel with early-exit predicates.\n\n"
+     "Members are distributed over OpenMP threads with dynamic scheduling and\n"
+     "the GIL released. Every check_every steps each member is sampled in one\n"
+     "fused pass and stopped as soon as a predicate fires, freeing its thread\n"
+     "for the next member. Thresholds <= 0 are disabled. NaN/Inf fields and\n"
+     "CFD_ERROR_DIVERGED always stop a member; a member's divergence guard\n"
+     "(set_divergence_guard) still rolls back and retries first.\n\n"
+     "Args:\n"
+     "    simulations (sequence): Simulation objects, advanced in place\n"
+     "    steps (int): Maximum number of steps per member\n"
+     "    check_every (int, optional): Steps between predicate checks (default: 10)\n"
+     "    max_velocity (float, optional): Stop if peak speed exceeds this\n"
+     "    max_pressure (float, optional): Stop if peak |p| exceeds this\n"
+     "    max_residual (float, optional): Stop if the residual exceeds this\n"
+     "    max_divergence (float, optional): Stop if peak |du/dx + dv/dy| exceeds this\n"
+     "    converge_tol (float, optional): Stop as converged once the residual falls below this\n"
+     "    num_threads (int, optional): OpenMP threads (default: all)\n\n"
+     "The residual is the largest change of u or v per step since the last check.\n\n"
      "Returns:\n"
-     "    dict: Results including velocity_magnitude, solver info, and stats"},
+     "    list: One dict per member with 'status' ('completed', 'converged',\n"
+     "          'max_velocity', 'max_pressure', 'max_residual', 'max_divergence',\n"
+     "          'diverged' or 'error'), 'steps', 'step_count', 'time',\n"
+     "          'max_velocity', 'max_pressure', 'residual', 'max_divergence'\n"
+     "          (values at the last check) and 'error_code'"},
+    {"unlink_shared_result", unlink_shared_result_py, METH_VARARGS,
+     "Remove a shared-memory result segment name.\n\n"
+     "Existing attachments remain valid; the memory is released once they are gone.\n\n"
+     "Args:\n"
+     "    name (str): Segment name"},
     {"list_solvers", list_solvers, METH_NOARGS,
      "List available solver types.\n\n"
      "Returns:\n"
@@ -2648,7 +9143,11 @@ static PyMethodDef cfd_python_methods[] = {
      "    data (list): Flat list of scalar values (nx*ny)\n"
      "    nx (int): Grid points in x direction\n"
      "    ny (int): Grid points in y direction\n"
-     "    xmin, xmax, ymin, ymax (float): Domain bounds"},
+     "    xmin, xmax, ymin, ymax (float): Domain bounds\n"
+     "    binary (bool, optional): Legacy BINARY encoding (big-endian float64)\n"
+     "        instead of ASCII (default: False)\n"
+     "    precision (int, optional): Significant digits of ASCII values; 0 writes\n"
+     "        the shortest digits that read back exactly (default: 0)"},
     {"write_vtk_vector", (PyCFunction)write_vtk_vector, METH_VARARGS | METH_KEYWORDS,
      "Write vector field data to VTK file.\n\n"
      "Args:\n"
@@ -2658,7 +9157,11 @@ static PyMethodDef cfd_python_methods[] = {
      "    v_data (list): Flat list of v-component values\n"
      "    nx (int): Grid points in x direction\n"
      "    ny (int): Grid points in y direction\n"
-     "    xmin, xmax, ymin, ymax (float): Domain bounds"},
+     "    xmin, xmax, ymin, ymax (float): Domain bounds\n"
+     "    binary (bool, optional): Legacy BINARY encoding (big-endian float64)\n"
+     "        instead of ASCII (default: False)\n"
+     "    precision (int, optional): Significant digits of ASCII values; 0 writes\n"
+     "        the shortest digits that read back exactly (default: 0)"},
     {"write_csv_timeseries", (PyCFunction)write_csv_timeseries_py, METH_VARARGS | METH_KEYWORDS,
      "Write simulation timeseries data to CSV file.\n\n"
      "Args:\n"
@@ -2670,6 +9173,118 @@ static PyMethodDef cfd_python_methods[] = {
      "    dt (float): Time step size\n"
      "    iterations (int): Solver iterations\n"
      "    create_new (bool): True to create new file, False to append"},
+    {"write_vtr", (PyCFunction)(void(*)(void))write_vtr_py, METH_VARARGS | METH_KEYWORDS,
+     "Write fields as a VTK XML rectilinear grid (.vtr).\n\n"
+     "The file stores the grid's coordinate arrays, so stretched grids are\n"
+     "written exactly. Fields go to one appended section as raw float64, or\n"
+     "as zlib-compressed 32 KiB blocks (encoded in parallel) with compress.\n"
+     "The GIL is released while writing.\n\n"
+     "Args:\n"
+     "    filename (str): Output file path\n"
+     "    data (dict or buffer): Scalar fields by name, or one field named 'values'\n"
+     "    nx (int): Grid points in x direction\n"
+     "    ny (int): Grid points in y direction\n"
+     "    grid (Grid or dict, optional): Grid or create_grid*() result; None is\n"
+     "        the unit square\n"
+     "    vectors (dict, optional): Vector fields by name as (u, v) or (u, v, w)\n"
+     "    compress (int, optional): zlib level 1-9, 0 for raw data; True means 1\n"
+     "        (default: 0)\n\n"
+     "Raises:\n"
+     "    NotImplementedError: If compress is set and the build has no zlib\n"
+     "    OSError: If the file cannot be written"},
+    {"compress_field", (PyCFunction)(void(*)(void))compress_field_py,
+     METH_VARARGS | METH_KEYWORDS,
+     "Compress a float64 field with the in-tree codec.\n\n"
+     "By default the field is stored losslessly: each value is XORed with\n"
+     "its predecessor, the results are split into byte planes and the planes\n"
+     "are LZ-compressed, in 16384-value chunks encoded in parallel with the\n"
+     "GIL released. Ratios depend on the data: about 1.3x for smooth\n"
+     "full-precision fields, far more for fields with constant regions or\n"
+     "reduced precision. Incompressible chunks are stored raw.\n\n"
+     "A positive max_error selects error-bounded lossy compression for\n"
+     "visualization output: every value is predicted from its two\n"
+     "predecessors and the prediction error quantized to one byte, so each\n"
+     "decoded value is within max_error of the original. Values out of reach\n"
+     "of the byte, NaN and infinities are stored exactly.\n\n"
+     "Args:\n"
+     "    data: Field as a list or float64 buffer\n"
+     "    max_error (float, optional): Largest absolute error allowed, 0 for\n"
+     "        lossless (default)\n"
+     "    relative (bool, optional): Treat max_error as a fraction of the\n"
+     "        range of the finite values (a constant field stays lossless)\n\n"
+     "Returns:\n"
+     "    bytearray: Self-describing compressed stream\n\n"
+     "Raises:\n"
+     "    ValueError: If max_error is negative or not finite"},
+    {"decompress_field", (PyCFunction)(void(*)(void))decompress_field_py,
+     METH_VARARGS | METH_KEYWORDS,
+     "Decode the output of compress_field().\n\n"
+     "Lossless streams decode bit for bit, lossy ones within their error\n"
+     "bound.\n\n"
+     "Args:\n"
+     "    data (bytes-like): Compressed stream\n"
+     "    out (buffer, optional): Writable float64 buffer of the right length\n"
+     "        to decode into instead of a new array\n\n"
+     "Returns:\n"
+     "    memoryview: The values (out itself when given)\n\n"
+     "Raises:\n"
+     "    ValueError: If data is not a valid compressed field"},
+    {"save_npy", (PyCFunction)(void(*)(void))save_npy_py, METH_VARARGS | METH_KEYWORDS,
+     "Write a float64 field straight to a NumPy .npy file.\n\n"
+     "The data is written from its own memory with the GIL released, with no\n"
+     "intermediate list or array. The header is padded so the data starts on\n"
+     "a 64-byte boundary, as NumPy writes it.\n\n"
+     "Args:\n"
+     "    filename (str): Output file path\n"
+     "    data: Field as a list or float64 buffer (e.g. Simulation.u)\n"
+     "    shape (int or tuple, optional): Array shape, e.g. (ny, nx); flat by\n"
+     "        default\n\n"
+     "Raises:\n"
+     "    ValueError: If shape does not match the number of values\n"
+     "    OSError: If the file cannot be written"},
+    {"save_npz", (PyCFunction)(void(*)(void))save_npz_py, METH_VARARGS | METH_KEYWORDS,
+     "Write several float64 fields as one uncompressed NumPy .npz archive.\n\n"
+     "For a Simulation or FieldSnapshot the members are u, v and p with shape\n"
+     "(ny, nx); for a dict, one NAME.npy member per entry. Fields are written\n"
+     "from their own memory with the GIL released; np.load() reads the result.\n\n"
+     "Args:\n"
+     "    filename (str): Output file path\n"
+     "    arrays: Simulation, FieldSnapshot or dict of name -> field\n"
+     "    shape (int or tuple, optional): Shape applied to every member\n\n"
+     "Raises:\n"
+     "    ValueError: If shape does not match a member or a name is empty\n"
+     "    OSError: If the file cannot be written"},
+    {"load_npy", (PyCFunction)(void(*)(void))load_npy_py, METH_VARARGS | METH_KEYWORDS,
+     "Map a float64 .npy file and return its data without copying.\n\n"
+     "The header is validated: native-endian float64, C order (or a layout\n"
+     "where that makes no difference) and enough data for the shape. The\n"
+     "result is a memoryview of the mapping with the file's shape (flat when\n"
+     "empty) that keeps the mapping alive, and can be passed as-is to\n"
+     "Simulation.set_fields(), compute_derived_fields(), the bc_apply_*\n"
+     "functions (with writable=True) and every other function taking float64\n"
+     "buffers. POSIX only.\n\n"
+     "Args:\n"
+     "    filename (str): .npy file path\n"
+     "    writable (bool, optional): Map copy-on-write so the data can be\n"
+     "        modified in memory; the file itself is never changed\n\n"
+     "Returns:\n"
+     "    memoryview: The data, read-only unless writable\n\n"
+     "Raises:\n"
+     "    ValueError: If the file is not a float64 .npy this reader accepts\n"
+     "    NotImplementedError: On Windows"},
+    {"append_pvd", (PyCFunction)(void(*)(void))append_pvd_py, METH_VARARGS | METH_KEYWORDS,
+     "Append one dataset to a ParaView .pvd collection.\n\n"
+     "Only the closing tags are rewritten, so each call costs the same no\n"
+     "matter how long the collection is, and the file stays valid between\n"
+     "calls. The file is created if it does not exist.\n\n"
+     "Args:\n"
+     "    filename (str): Collection file path\n"
+     "    dataset (str): Dataset file, relative to the collection's directory\n"
+     "    time (float): Time step value\n"
+     "    part (int, optional): Part index (default: 0)\n"
+     "    create_new (bool, optional): Start a new collection (default: False)\n\n"
+     "Raises:\n"
+     "    ValueError: If an existing file is not a collection written here"},
     {"get_last_error", get_last_error, METH_NOARGS,
      "Get the last CFD library error message.\n\n"
      "Returns:\n"
@@ -2800,6 +9415,144 @@ static PyMethodDef cfd_python_methods[] = {
      "Returns:\n"
      "    dict: Statistics for 'u', 'v', 'p', 'velocity_magnitude'\n"
      "          Each contains 'min', 'max', 'avg', 'sum'"},
+    {"field_statistics", (PyCFunction)(void(*)(void))field_statistics_py,
+     METH_VARARGS | METH_KEYWORDS,
+     "Compute field statistics in one OpenMP-parallel pass.\n\n"
+     "Blocks are reduced with a two-level scheme (per-block moments merged\n"
+     "pairwise with Chan's update) for accurate variance on large fields.\n"
+     "NaN and Inf values are counted and excluded from every other statistic.\n"
+     "The GIL is released during the computation.\n\n"
+     "Args:\n"
+     "    data: List, NumPy float64 array or float64 buffer (including the live\n"
+     "        Simulation.u/v/p views)\n"
+     "    bins (int, optional): Histogram bins, 0 for no histogram (default: 0)\n"
+     "    range (tuple, optional): Histogram (lo, hi); default is (min, max),\n"
+     "        which needs a second pass\n"
+     "    percentiles (iterable, optional): Percentiles in [0, 100], approximated\n"
+     "        from a 4096-bin histogram (second pass)\n\n"
+     "Returns:\n"
+     "    dict: 'count', 'nan_count', 'inf_count', 'min', 'max', 'sum', 'avg',\n"
+     "          'variance' (population), 'std', 'rms', 'l1', 'l2', 'linf', plus\n"
+     "          'histogram' ('counts', 'edges', 'below', 'above') and\n"
+     "          'percentiles' ({q: value}) when requested"},
+    {"compare_fields", (PyCFunction)(void(*)(void))compare_fields_py, METH_VARARGS | METH_KEYWORDS,
+     "Compare a field against a reference in one OpenMP-parallel pass.\n\n"
+     "Buffers are read in place; the GIL is released during the pass. NaN\n"
+     "pairs are skipped and counted in 'nan_mismatch' when only one is NaN.\n\n"
+     "Args:\n"
+     "    a: Field to check (list, NumPy float64 array or float64 buffer)\n"
+     "    b: Reference field of the same size\n"
+     "    nx (int, optional): Row length, adds 'max_location' = (i, j)\n\n"
+     "Returns:\n"
+     "    dict: 'count', 'nan_mismatch', 'exact', 'l1', 'l2', 'linf', 'rel_l1',\n"
+     "          'rel_l2', 'rel_linf' (relative to the norms of b), 'max_ulp',\n"
+     "          'mean_ulp' and 'max_index' of the largest absolute error"},
+    {"compare_flow_fields", compare_flow_fields_py, METH_VARARGS,
+     "Compare u, v and p of two flow states.\n\n"
+     "Args:\n"
+     "    a, b: Simulation, FieldSnapshot or dict with 'u', 'v', 'p' (and\n"
+     "        optionally 'nx'); b is the reference\n\n"
+     "Returns:\n"
+     "    dict: 'u', 'v', 'p' -> compare_fields() result"},
+    {"compute_derived_fields", (PyCFunction)(void(*)(void))compute_derived_fields_py,
+     METH_VARARGS | METH_KEYWORDS,
+     "Compute velocity-gradient quantities in one fused, OpenMP-parallel sweep.\n\n"
+     "Derivatives use second-order three-point stencils that account for\n"
+     "non-uniform spacing; boundary points use one-sided stencils.\n"
+     "The GIL is released during the sweep.\n\n"
+     "Args:\n"
+     "    u, v: X/Y-velocity (lists, NumPy float64 arrays or float64 buffers)\n"
+     "    nx (int): Grid points in x direction\n"
+     "    ny (int): Grid points in y direction\n"
+     "    grid (optional): Grid, create_grid() dict, or None for the unit square\n"
+     "    p (optional): Pressure, required for 'dpdx'/'dpdy'\n"
+     "    fields (iterable, optional): Subset of 'vorticity', 'divergence',\n"
+     "        'strain_rate', 'q_criterion', 'dpdx', 'dpdy' (default: all available)\n"
+     "    out (dict, optional): Writable float64 buffers of nx*ny elements to\n"
+     "        fill in place, keyed by field name; they must not overlap an\n"
+     "        input or each other\n\n"
+     "Returns:\n"
+     "    dict: Field name -> buffer. Buffers from `out` are returned as given,\n"
+     "          others are new flat memoryviews of doubles"},
+    {"sample_lines", (PyCFunction)(void(*)(void))sample_lines_py, METH_VARARGS | METH_KEYWORDS,
+     "Sample fields along many lines in one batched, OpenMP-parallel pass.\n\n"
+     "Values are bilinearly interpolated on uniform or stretched grids; polyline\n"
+     "samples outside the grid are NaN. The GIL is released while sampling.\n\n"
+     "Args:\n"
+     "    data: One field buffer (list, NumPy float64 array or float64 buffer),\n"
+     "        or a dict of field name -> buffer\n"
+     "    nx (int): Grid points in x direction\n"
+     "    ny (int): Grid points in y direction\n"
+     "    lines (sequence): Line specifications, each one of\n"
+     "        {'x': x0} - constant-x grid line, sampled at every grid y\n"
+     "        {'y': y0} - constant-y grid line, sampled at every grid x\n"
+     "        [(x, y), (x, y), ...] - segment or polyline, num_points samples\n"
+     "        evenly spaced by arc length\n"
+     "    grid (optional): Grid, create_grid() dict, or None for the unit square\n"
+     "    num_points (int, optional): Samples per polyline (default: 100)\n\n"
+     "Returns:\n"
+     "    list: One dict per line with 'x', 'y' and 'distance' (arc length)\n"
+     "          views plus one view per field ('values' for a single buffer)"},
+    {"energy_spectrum", (PyCFunction)(void(*)(void))energy_spectrum_py,
+     METH_VARARGS | METH_KEYWORDS,
+     "Kinetic energy spectra of periodic u, v fields on a uniform grid.\n\n"
+     "u and v are transformed with an in-tree FFT (real transforms along rows,\n"
+     "complex along columns, any size, OpenMP over rows and columns) with the\n"
+     "GIL released. The modal energy 1/2 (|u_k|^2 + |v_k|^2) is binned into\n"
+     "shells of width dk = min(2 pi / Lx, 2 pi / Ly) around |k| = n dk, and\n"
+     "summed into 1D spectra over kx and ky. Every spectrum sums to the mean\n"
+     "kinetic energy; divide by the bin width for a spectral density.\n\n"
+     "Args:\n"
+     "    u, v: Velocity fields (lists, NumPy float64 arrays or float64 buffers)\n"
+     "    nx (int): Grid points in x direction\n"
+     "    ny (int): Grid points in y direction\n"
+     "    grid (optional): Uniform Grid, create_grid() dict, or None for the\n"
+     "        unit square; sets the periods Lx and Ly\n"
+     "    skip_endpoint (bool, optional): Drop the last column and row when they\n"
+     "        repeat the first (default: False)\n\n"
+     "Returns:\n"
+     "    dict: 'k' and 'E' (shell spectrum), 'kx' and 'E_x', 'ky' and 'E_y'\n"
+     "          (1D spectra, non-negative wavenumbers), 'dk' and 'energy'"},
+    {"advect_particles", (PyCFunction)(void(*)(void))advect_particles_py,
+     METH_VARARGS | METH_KEYWORDS,
+     "Advect massless particles in place through a frozen velocity field.\n\n"
+     "RK2 (midpoint) or RK4 steps with bilinear velocity interpolation on\n"
+     "uniform or stretched grids, OpenMP-parallel over particles with the GIL\n"
+     "released. Particles that leave the grid are set to NaN and skipped on\n"
+     "later calls.\n\n"
+     "Args:\n"
+     "    x, y: Particle positions, writable float64 buffers (e.g. NumPy\n"
+     "        arrays) updated in place\n"
+     "    u, v: Velocity fields of nx*ny elements\n"
+     "    nx (int): Grid points in x direction\n"
+     "    ny (int): Grid points in y direction\n"
+     "    dt (float): Step size\n"
+     "    steps (int, optional): Number of steps (default: 1)\n"
+     "    grid (optional): Grid, create_grid() dict, or None for the unit square\n"
+     "    method (str, optional): 'rk2' or 'rk4' (default: 'rk4')\n\n"
+     "Returns:\n"
+     "    int: Particles still inside the grid"},
+    {"resample_fields", (PyCFunction)(void(*)(void))resample_fields_py,
+     METH_VARARGS | METH_KEYWORDS,
+     "Restrict fields by integer factors and/or extract an index-space region.\n\n"
+     "One OpenMP-parallel pass per field over the window [i0, i1) x [j0, j1).\n"
+     "'average' takes the mean of each factor x factor block (partial blocks at\n"
+     "the far edges average what they cover); 'inject' keeps every factor-th\n"
+     "node starting at the window corner. Both give ceil(width / factor) points\n"
+     "per axis. factor=1 is a plain region copy. The GIL is released.\n\n"
+     "Args:\n"
+     "    data: One field buffer (list, NumPy float64 array or float64 buffer),\n"
+     "        or a dict of field name -> buffer (e.g. {'u': u, 'v': v})\n"
+     "    nx (int): Grid points in x direction\n"
+     "    ny (int): Grid points in y direction\n"
+     "    factor (int or (int, int), optional): Reduction factor per axis (default: 1)\n"
+     "    roi (tuple, optional): Index window (i0, i1, j0, j1), ends exclusive\n"
+     "    mode (str, optional): 'average' or 'inject' (default: 'average')\n"
+     "    grid (optional): Grid, create_grid() dict, or None for the unit square\n\n"
+     "Returns:\n"
+     "    dict: 'nx' and 'ny' of the result, 'x' and 'y' coordinate views (node or\n"
+     "          block-mean coordinates) and one view per field ('values' for a\n"
+     "          single buffer)"},
     // Solver Backend Availability API (v0.1.6)
     {"backend_is_available", backend_is_available_py, METH_VARARGS,
      "Check if a solver backend is available at runtime.\n\n"
@@ -2939,6 +9692,15 @@ static void cfd_python_free(void* module) {
     Py_XDECREF(g_log_callback);
     g_log_callback = NULL;
     cfd_set_log_callback(NULL);
+    Py_CLEAR(g_grid_type);
+    Py_CLEAR(g_field_snapshot_type);
+    Py_CLEAR(g_simulation_type);
+    Py_CLEAR(g_async_writer_type);
+    Py_CLEAR(g_csv_writer_type);
+    Py_CLEAR(g_snapshot_writer_type);
+    Py_CLEAR(g_snapshot_store_type);
+    Py_CLEAR(g_pickle_buffer_type);
+    Py_CLEAR(g_ctypes);
 }
 
 static struct PyModuleDef cfd_python_module = {
@@ -2951,12 +9713,25 @@ static struct PyModuleDef cfd_python_module = {
     "  - get_solver_info(name): Get solver details\n"
     "  - run_simulation(...): Run a simulation\n"
     "  - run_simulation_with_params(...): Run with detailed parameters\n"
+    "  - attach_shared_result(name): Attach to shared-memory results\n"
     "  - create_grid(...): Create a computational grid\n"
+    "  - Grid, FieldSnapshot: Native grid and field objects (pickle protocol 5)\n"
+    "  - Simulation: Persistent, cloneable simulation state\n"
+    "  - AsyncWriter: Background snapshot writer with pooled buffers\n"
+    "  - CsvWriter: Buffered CSV timeseries log with native row statistics\n"
+    "  - SnapshotWriter, SnapshotStore: Append-only snapshot file read via mmap\n"
+    "  - run_ensemble(simulations, steps, ...): Parallel members with early exit\n"
     "  - get_default_solver_params(): Get default parameters\n"
     "  - set_output_dir(path): Set output directory (deprecated)\n"
     "  - write_vtk_scalar(...): Write scalar VTK output\n"
     "  - write_vtk_vector(...): Write vector VTK output\n"
     "  - write_csv_timeseries(...): Write CSV timeseries\n"
+    "  - write_vtr(...): Write VTK XML rectilinear output\n"
+    "  - append_pvd(...): Append a dataset to a .pvd collection\n"
+    "  - compress_field(data, max_error=0.0), decompress_field(data): Lossless\n"
+    "    and error-bounded lossy field codec\n"
+    "  - save_npy(...), save_npz(...): Write fields as NumPy .npy/.npz files\n"
+    "  - load_npy(filename, writable=False): Zero-copy memory-mapped .npy reader\n"
     "  - get_last_error(): Get last error message\n"
     "  - get_last_status(): Get last status code\n"
     "  - clear_error(): Clear error state\n"
@@ -2999,6 +9774,41 @@ PyMODINIT_FUNC PyInit_cfd_python(void) {
     }
     cfd_registry_register_defaults(g_registry);
 
+    // Native object types
+    g_grid_type = PyType_FromSpec(&Grid_spec);
+    g_field_snapshot_type = PyType_FromSpec(&FieldSnapshot_spec);
+    if (g_grid_type == NULL || g_field_snapshot_type == NULL) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    Py_INCREF(g_grid_type);
+    Py_INCREF(g_field_snapshot_type);
+    g_simulation_type = PyType_FromSpec(&Simulation_spec);
+    g_async_writer_type = PyType_FromSpec(&AsyncWriter_spec);
+    g_csv_writer_type = PyType_FromSpec(&CsvWriter_spec);
+    g_snapshot_writer_type = PyType_FromSpec(&SnapshotWriter_spec);
+    g_snapshot_store_type = PyType_FromSpec(&SnapshotStore_spec);
+    if (g_simulation_type == NULL || g_async_writer_type == NULL || g_csv_writer_type == NULL ||
+        g_snapshot_writer_type == NULL || g_snapshot_store_type == NULL) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    Py_INCREF(g_simulation_type);
+    Py_INCREF(g_async_writer_type);
+    Py_INCREF(g_csv_writer_type);
+    Py_INCREF(g_snapshot_writer_type);
+    Py_INCREF(g_snapshot_store_type);
+    if (PyModule_AddObject(m, "Grid", g_grid_type) < 0 ||
+        PyModule_AddObject(m, "FieldSnapshot", g_field_snapshot_type) < 0 ||
+        PyModule_AddObject(m, "Simulation", g_simulation_type) < 0 ||
+        PyModule_AddObject(m, "AsyncWriter", g_async_writer_type) < 0 ||
+        PyModule_AddObject(m, "CsvWriter", g_csv_writer_type) < 0 ||
+        PyModule_AddObject(m, "SnapshotWriter", g_snapshot_writer_type) < 0 ||
+        PyModule_AddObject(m, "SnapshotStore", g_snapshot_store_type) < 0) {
+        Py_DECREF(m);
+        return NULL;
+    }
+
     // Dynamically add solver type constants from the registry
     // This automatically picks up any new solvers added to the C library
     const char* solver_names[32];
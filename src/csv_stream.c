@@ -0,0 +1,137 @@
+/*
+ * Streaming CSV timeseries writer
+ */
+
+#include "csv_stream.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "double_format.h"
+
+// Fields smaller than this are reduced on one thread; starting the team
+// would cost more than the pass itself
+#define CSV_PARALLEL_MIN ((size_t)1 << 15)
+
+int csv_stream_open(csv_stream* stream, const char* filename, int append, size_t buffer_size,
+                    size_t flush_every, int precision) {
+    memset(stream, 0, sizeof(*stream));
+    stream->buffer = (char*)malloc(buffer_size);
+    if (stream->buffer == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    errno = 0;
+    FILE* f = fopen(filename, append ? "ab" : "wb");
+    if (f == NULL || setvbuf(f, stream->buffer, _IOFBF, buffer_size) != 0) {
+        int saved = errno != 0 ? errno : EIO;
+        if (f != NULL) {
+            fclose(f);
+        }
+        free(stream->buffer);
+        stream->buffer = NULL;
+        errno = saved;
+        return -1;
+    }
+    stream->file = f;
+    stream->flush_every = flush_every;
+    stream->precision = precision;
+
+    // Appending to a file that already has rows: keep its header
+    long size = 0;
+    if (append && fseek(f, 0, SEEK_END) == 0) {
+        size = ftell(f);
+    }
+    if (size <= 0 && fputs(CSV_STREAM_HEADER, f) == EOF) {
+        int saved = errno;
+        csv_stream_close(stream);
+        errno = saved;
+        return -1;
+    }
+    return 0;
+}
+
+void csv_row_compute(csv_row* row, const double* u, const double* v, const double* p,
+                     size_t count) {
+    double sum_u = 0.0, sum_v = 0.0, sum_p = 0.0;
+    double max_u = 0.0, max_v = 0.0, max_p = 0.0;
+
+    #pragma omp parallel if (count >= CSV_PARALLEL_MIN)
+    {
+        double local_u = 0.0, local_v = 0.0, local_p = 0.0;
+
+        #pragma omp for schedule(static) reduction(+:sum_u, sum_v, sum_p)
+        for (ptrdiff_t i = 0; i < (ptrdiff_t)count; i++) {
+            double au = fabs(u[i]), av = fabs(v[i]), ap = fabs(p[i]);
+            local_u = au > local_u ? au : local_u;
+            local_v = av > local_v ? av : local_v;
+            local_p = ap > local_p ? ap : local_p;
+            sum_u += u[i];
+            sum_v += v[i];
+            sum_p += p[i];
+        }
+
+        #pragma omp critical
+        {
+            max_u = local_u > max_u ? local_u : max_u;
+            max_v = local_v > max_v ? local_v : max_v;
+            max_p = local_p > max_p ? local_p : max_p;
+        }
+    }
+
+    double scale = count > 0 ? 1.0 / (double)count : 0.0;
+    row->max_u = max_u;
+    row->max_v = max_v;
+    row->max_p = max_p;
+    row->avg_u = sum_u * scale;
+    row->avg_v = sum_v * scale;
+    row->avg_p = sum_p * scale;
+}
+
+int csv_stream_write(csv_stream* stream, const csv_row* row) {
+    if (stream->file == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+    const double values[8] = {row->time,  row->dt,    row->max_u, row->max_v,
+                              row->max_p, row->avg_u, row->avg_v, row->avg_p};
+    char line[64 + 8 * (DOUBLE_FORMAT_MAX + 1)];
+    int len = snprintf(line, 32, "%zu", row->step);
+    for (int k = 0; k < 8; k++) {
+        line[len++] = ',';
+        len += double_format(values[k], stream->precision, line + len);
+    }
+    len += snprintf(line + len, 32, ",%d\n", row->iterations);
+    if (fwrite(line, 1, (size_t)len, stream->file) != (size_t)len) {
+        return -1;
+    }
+    stream->rows++;
+    stream->unflushed++;
+    if (stream->flush_every > 0 && stream->unflushed >= stream->flush_every) {
+        return csv_stream_flush(stream);
+    }
+    return 0;
+}
+
+int csv_stream_flush(csv_stream* stream) {
+    if (stream->file == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+    stream->unflushed = 0;
+    return fflush(stream->file) == 0 ? 0 : -1;
+}
+
+int csv_stream_close(csv_stream* stream) {
+    int rc = 0;
+    if (stream->file != NULL) {
+        rc = fclose(stream->file) == 0 ? 0 : -1;
+        stream->file = NULL;
+    }
+    // The buffer may only be released after fclose() has flushed it
+    free(stream->buffer);
+    stream->buffer = NULL;
+    return rc;
+}
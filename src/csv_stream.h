@@ -0,0 +1,61 @@
+/*
+ * Streaming CSV timeseries writer
+ *
+ * Keeps one file open for a whole run behind a large user-space buffer,
+ * so a row costs one fused statistics pass plus formatting into memory;
+ * the file is only written when the buffer fills, every `flush_every`
+ * rows, or on flush/close. Row statistics (largest magnitude and mean of
+ * u, v and p) are computed in a single OpenMP pass over the three fields
+ * and formatted with double_format().
+ */
+
+#ifndef CFD_PYTHON_CSV_STREAM_H
+#define CFD_PYTHON_CSV_STREAM_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define CSV_STREAM_HEADER "step,time,dt,max_u,max_v,max_p,avg_u,avg_v,avg_p,iterations\n"
+
+typedef struct {
+    size_t step;
+    double time;
+    double dt;
+    double max_u, max_v, max_p;  // Largest magnitude
+    double avg_u, avg_v, avg_p;
+    int iterations;
+} csv_row;
+
+typedef struct {
+    FILE* file;         // NULL once closed
+    char* buffer;
+    size_t rows;        // Rows written since open
+    size_t flush_every; // Flush after this many rows; 0 leaves it to the buffer
+    size_t unflushed;
+    int precision;      // Significant digits; 0 for shortest round-trip
+} csv_stream;
+
+/*
+ * Open `filename` for writing (truncating, or appending when `append` is
+ * set) with a `buffer_size`-byte buffer. The header is written unless an
+ * existing non-empty file is appended to. Returns 0, or -1 with errno set.
+ */
+int csv_stream_open(csv_stream* stream, const char* filename, int append, size_t buffer_size,
+                    size_t flush_every, int precision);
+
+// Fill the statistics columns of `row` from `count` values of u, v and p
+void csv_row_compute(csv_row* row, const double* u, const double* v, const double* p,
+                     size_t count);
+
+/*
+ * Append one row, flushing when the interval is reached. Returns 0, or -1
+ * with errno set if a write to the file failed.
+ */
+int csv_stream_write(csv_stream* stream, const csv_row* row);
+
+int csv_stream_flush(csv_stream* stream);
+
+// Flush and close; safe to call on a closed stream
+int csv_stream_close(csv_stream* stream);
+
+#endif  // CFD_PYTHON_CSV_STREAM_H
@@ -0,0 +1,56 @@
+/*
+ * Fused velocity-gradient kernels
+ *
+ * One OpenMP-parallel sweep over u/v (and optionally p) computes the
+ * velocity gradient tensor per point and derives vorticity, divergence,
+ * strain rate, Q-criterion and pressure gradients from it. Derivatives use
+ * second-order three-point stencils for non-uniform spacing: centred in the
+ * interior (central differences on uniform grids) and one-sided on the
+ * boundaries.
+ */
+
+#ifndef CFD_PYTHON_DERIVED_KERNELS_H
+#define CFD_PYTHON_DERIVED_KERNELS_H
+
+#include <stddef.h>
+
+#include "cfd/core/cfd_status.h"
+
+typedef struct {
+    const double* u;
+    const double* v;
+    const double* p;  // Required only for dpdx/dpdy
+    const double* x;  // nx strictly increasing coordinates
+    const double* y;  // ny strictly increasing coordinates
+    size_t nx, ny;
+} gradient_inputs;
+
+// Row-major nx*ny output arrays; NULL entries are not computed
+typedef struct {
+    double* vorticity;    // dv/dx - du/dy
+    double* divergence;   // du/dx + dv/dy
+    double* strain_rate;  // |S| = sqrt(2 S_ij S_ij)
+    double* q_criterion;  // (|W|^2 - |S|^2) / 2
+    double* dpdx;
+    double* dpdy;
+} gradient_outputs;
+
+/*
+ * Derivative weights for a three-point stencil at each of n >= 3 points,
+ * stored as w[3i..3i+2]. Interior points use (i-1, i, i+1); the first and
+ * last points use the one-sided stencils (0, 1, 2) and (n-3, n-2, n-1).
+ * Returns -1 if the coordinates are not strictly increasing.
+ */
+int fd_derivative_weights(const double* x, size_t n, double* w);
+
+// First index of the three-point stencil used at point i
+size_t fd_stencil_start(size_t i, size_t n);
+
+/*
+ * Compute every requested output in one sweep. Returns CFD_ERROR_INVALID for
+ * grids smaller than 3x3, non-increasing coordinates or pressure gradients
+ * requested without p.
+ */
+cfd_status_t compute_flow_gradients(const gradient_inputs* in, const gradient_outputs* out);
+
+#endif  // CFD_PYTHON_DERIVED_KERNELS_H
@@ -0,0 +1,121 @@
+/*
+ * Divergence detection and rollback
+ */
+
+#include "divergence_guard.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "field_state.h"
+
+int flow_field_diverged(const flow_field* field, double max_velocity, double* max_speed) {
+    const double* u = field->u;
+    const double* v = field->v;
+    const double* p = field->p;
+    ptrdiff_t n = (ptrdiff_t)(field->nx * field->ny * field->nz);
+    double max_sq = 0.0;
+    int non_finite = 0;
+
+    #pragma omp parallel
+    {
+        double local_max = 0.0;
+        int local_bad = 0;
+
+        // x - x is 0 for finite x and NaN for NaN/Inf, so one compare
+        // covers all three fields without branches in the loop
+        #pragma omp for schedule(static)
+        for (ptrdiff_t i = 0; i < n; i++) {
+            double speed_sq = u[i] * u[i] + v[i] * v[i];
+            double probe = (u[i] - u[i]) + (v[i] - v[i]) + (p[i] - p[i]);
+            local_bad |= probe != 0.0;
+            local_max = speed_sq > local_max ? speed_sq : local_max;
+        }
+
+        #pragma omp critical
+        {
+            non_finite |= local_bad;
+            if (local_max > max_sq) {
+                max_sq = local_max;
+            }
+        }
+    }
+
+    double speed = sqrt(max_sq);
+    if (max_speed != NULL) {
+        *max_speed = non_finite ? NAN : speed;
+    }
+    return non_finite || (max_velocity > 0.0 && speed > max_velocity);
+}
+
+cfd_status_t divergence_guard_init(divergence_guard* guard, const divergence_policy* policy,
+                                   size_t history, size_t nx, size_t ny, size_t nz) {
+    memset(guard, 0, sizeof(*guard));
+    guard->policy = *policy;
+    if (history == 0) {
+        return CFD_SUCCESS;
+    }
+
+    guard->ring = (saved_state*)calloc(history, sizeof(saved_state));
+    if (guard->ring == NULL) {
+        return CFD_ERROR_NOMEM;
+    }
+    guard->capacity = history;
+    for (size_t i = 0; i < history; i++) {
+        guard->ring[i].field = flow_field_create(nx, ny, nz);
+        if (guard->ring[i].field == NULL) {
+            divergence_guard_free(guard);
+            return CFD_ERROR_NOMEM;
+        }
+    }
+    return CFD_SUCCESS;
+}
+
+void divergence_guard_free(divergence_guard* guard) {
+    if (guard->ring != NULL) {
+        for (size_t i = 0; i < guard->capacity; i++) {
+            if (guard->ring[i].field != NULL) {
+                flow_field_destroy(guard->ring[i].field);
+            }
+        }
+        free(guard->ring);
+    }
+    memset(guard, 0, sizeof(*guard));
+}
+
+void divergence_guard_save(divergence_guard* guard, const flow_field* field,
+                           size_t step, double time) {
+    if (guard->capacity == 0) {
+        return;
+    }
+    saved_state* slot = &guard->ring[guard->head];
+    flow_field_copy_parallel(slot->field, field);
+    slot->step = step;
+    slot->time = time;
+    guard->head = (guard->head + 1) % guard->capacity;
+    if (guard->count < guard->capacity) {
+        guard->count++;
+    }
+}
+
+const saved_state* divergence_guard_restore(divergence_guard* guard, flow_field* field,
+                                            size_t depth) {
+    if (guard->count == 0) {
+        return NULL;
+    }
+    if (depth < 1) {
+        depth = 1;
+    }
+    if (depth > guard->count) {
+        depth = guard->count;
+    }
+
+    // Entry `depth` back from head; newer entries are discarded
+    size_t index = (guard->head + guard->capacity - depth) % guard->capacity;
+    saved_state* entry = &guard->ring[index];
+    flow_field_copy_parallel(field, entry->field);
+    guard->head = (index + 1) % guard->capacity;
+    guard->count -= depth - 1;
+    return entry;
+}
@@ -0,0 +1,66 @@
+/*
+ * Divergence detection and rollback
+ *
+ * A fused NaN/Inf and velocity blow-up check over a flow field, plus a ring
+ * buffer of recent verified states so a diverged run can be rolled back and
+ * retried with a smaller time step.
+ */
+
+#ifndef CFD_PYTHON_DIVERGENCE_GUARD_H
+#define CFD_PYTHON_DIVERGENCE_GUARD_H
+
+#include <stddef.h>
+
+#include "cfd/core/cfd_status.h"
+#include "cfd/solvers/navier_stokes_solver.h"
+
+typedef struct {
+    size_t check_interval;  // Check every k steps; 0 disables the guard
+    double max_velocity;    // Velocity magnitude limit; <= 0 checks NaN/Inf only
+    int max_retries;        // Rollbacks allowed per divergence episode
+    double dt_factor;       // dt multiplier applied on every retry (0 < f < 1)
+} divergence_policy;
+
+typedef struct {
+    flow_field* field;
+    size_t step;
+    double time;
+} saved_state;
+
+typedef struct {
+    divergence_policy policy;
+    saved_state* ring;
+    size_t capacity;
+    size_t count;           // Valid entries
+    size_t head;            // Slot written next
+    int retries;            // Retries used in the current episode
+    size_t episode_step;    // Step at which the current episode diverged
+    size_t rollbacks;       // Total rollbacks performed
+    double last_max_velocity;
+} divergence_guard;
+
+/*
+ * Fused check over u, v and p. Returns 1 if any value is NaN/Inf or the
+ * velocity magnitude exceeds `max_velocity` (when > 0), else 0. The largest
+ * velocity magnitude seen is stored in `max_speed` if non-NULL.
+ */
+int flow_field_diverged(const flow_field* field, double max_velocity, double* max_speed);
+
+// Allocate `history` saved states for fields of the given size
+cfd_status_t divergence_guard_init(divergence_guard* guard, const divergence_policy* policy,
+                                   size_t history, size_t nx, size_t ny, size_t nz);
+void divergence_guard_free(divergence_guard* guard);
+
+// Save a verified state, overwriting the oldest entry when full
+void divergence_guard_save(divergence_guard* guard, const flow_field* field,
+                           size_t step, double time);
+
+/*
+ * Restore the `depth`-th most recent saved state (1 = newest, clamped to the
+ * oldest) into `field` and drop every newer entry. Returns the restored
+ * entry, or NULL if nothing is saved.
+ */
+const saved_state* divergence_guard_restore(divergence_guard* guard, flow_field* field,
+                                            size_t depth);
+
+#endif  // CFD_PYTHON_DIVERGENCE_GUARD_H
@@ -0,0 +1,410 @@
+/*
+ * Shortest round-trip double formatting
+ */
+
+#include "double_format.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Lines formatted by one thread into one buffer
+#define FORMAT_CHUNK_LINES 4096
+
+// Chunks per thread formatted before the batch is written out
+#define FORMAT_CHUNKS_PER_THREAD 2
+
+#define HIDDEN_BIT ((uint64_t)1 << 52)
+
+// Significand f and binary exponent e of f * 2^e
+typedef struct {
+    uint64_t f;
+    int e;
+} diy_fp;
+
+// 10^k for k = -348, -340, ..., 340, normalized and rounded to 64 bits
+static const diy_fp cached_powers[] = {
+    {0xFA8FD5A0081C0288ULL, -1220}, {0xBAAEE17FA23EBF76ULL, -1193}, {0x8B16FB203055AC76ULL, -1166},
+    {0xCF42894A5DCE35EAULL, -1140}, {0x9A6BB0AA55653B2DULL, -1113}, {0xE61ACF033D1A45DFULL, -1087},
+    {0xAB70FE17C79AC6CAULL, -1060}, {0xFF77B1FCBEBCDC4FULL, -1034}, {0xBE5691EF416BD60CULL, -1007},
+    {0x8DD01FAD907FFC3CULL, -980}, {0xD3515C2831559A83ULL, -954}, {0x9D71AC8FADA6C9B5ULL, -927},
+    {0xEA9C227723EE8BCBULL, -901}, {0xAECC49914078536DULL, -874}, {0x823C12795DB6CE57ULL, -847},
+    {0xC21094364DFB5637ULL, -821}, {0x9096EA6F3848984FULL, -794}, {0xD77485CB25823AC7ULL, -768},
+    {0xA086CFCD97BF97F4ULL, -741}, {0xEF340A98172AACE5ULL, -715}, {0xB23867FB2A35B28EULL, -688},
+    {0x84C8D4DFD2C63F3BULL, -661}, {0xC5DD44271AD3CDBAULL, -635}, {0x936B9FCEBB25C996ULL, -608},
+    {0xDBAC6C247D62A584ULL, -582}, {0xA3AB66580D5FDAF6ULL, -555}, {0xF3E2F893DEC3F126ULL, -529},
+    {0xB5B5ADA8AAFF80B8ULL, -502}, {0x87625F056C7C4A8BULL, -475}, {0xC9BCFF6034C13053ULL, -449},
+    {0x964E858C91BA2655ULL, -422}, {0xDFF9772470297EBDULL, -396}, {0xA6DFBD9FB8E5B88FULL, -369},
+    {0xF8A95FCF88747D94ULL, -343}, {0xB94470938FA89BCFULL, -316}, {0x8A08F0F8BF0F156BULL, -289},
+    {0xCDB02555653131B6ULL, -263}, {0x993FE2C6D07B7FACULL, -236}, {0xE45C10C42A2B3B06ULL, -210},
+    {0xAA242499697392D3ULL, -183}, {0xFD87B5F28300CA0EULL, -157}, {0xBCE5086492111AEBULL, -130},
+    {0x8CBCCC096F5088CCULL, -103}, {0xD1B71758E219652CULL, -77}, {0x9C40000000000000ULL, -50},
+    {0xE8D4A51000000000ULL, -24}, {0xAD78EBC5AC620000ULL, 3}, {0x813F3978F8940984ULL, 30},
+    {0xC097CE7BC90715B3ULL, 56}, {0x8F7E32CE7BEA5C70ULL, 83}, {0xD5D238A4ABE98068ULL, 109},
+    {0x9F4F2726179A2245ULL, 136}, {0xED63A231D4C4FB27ULL, 162}, {0xB0DE65388CC8ADA8ULL, 189},
+    {0x83C7088E1AAB65DBULL, 216}, {0xC45D1DF942711D9AULL, 242}, {0x924D692CA61BE758ULL, 269},
+    {0xDA01EE641A708DEAULL, 295}, {0xA26DA3999AEF774AULL, 322}, {0xF209787BB47D6B85ULL, 348},
+    {0xB454E4A179DD1877ULL, 375}, {0x865B86925B9BC5C2ULL, 402}, {0xC83553C5C8965D3DULL, 428},
+    {0x952AB45CFA97A0B3ULL, 455}, {0xDE469FBD99A05FE3ULL, 481}, {0xA59BC234DB398C25ULL, 508},
+    {0xF6C69A72A3989F5CULL, 534}, {0xB7DCBF5354E9BECEULL, 561}, {0x88FCF317F22241E2ULL, 588},
+    {0xCC20CE9BD35C78A5ULL, 614}, {0x98165AF37B2153DFULL, 641}, {0xE2A0B5DC971F303AULL, 667},
+    {0xA8D9D1535CE3B396ULL, 694}, {0xFB9B7CD9A4A7443CULL, 720}, {0xBB764C4CA7A44410ULL, 747},
+    {0x8BAB8EEFB6409C1AULL, 774}, {0xD01FEF10A657842CULL, 800}, {0x9B10A4E5E9913129ULL, 827},
+    {0xE7109BFBA19C0C9DULL, 853}, {0xAC2820D9623BF429ULL, 880}, {0x80444B5E7AA7CF85ULL, 907},
+    {0xBF21E44003ACDD2DULL, 933}, {0x8E679C2F5E44FF8FULL, 960}, {0xD433179D9C8CB841ULL, 986},
+    {0x9E19DB92B4E31BA9ULL, 1013}, {0xEB96BF6EBADF77D9ULL, 1039}, {0xAF87023B9BF0EE6BULL, 1066},
+};
+
+static const uint64_t pow10_table[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+// Upper 64 bits of the 128-bit product, rounded
+static diy_fp diy_multiply(diy_fp a, diy_fp b) {
+    const uint64_t mask = 0xFFFFFFFFULL;
+    uint64_t a_hi = a.f >> 32, a_lo = a.f & mask;
+    uint64_t b_hi = b.f >> 32, b_lo = b.f & mask;
+    uint64_t hh = a_hi * b_hi;
+    uint64_t hl = a_hi * b_lo;
+    uint64_t lh = a_lo * b_hi;
+    uint64_t ll = a_lo * b_lo;
+    uint64_t mid = (ll >> 32) + (hl & mask) + (lh & mask) + ((uint64_t)1 << 31);
+    diy_fp r = {hh + (hl >> 32) + (lh >> 32) + (mid >> 32), a.e + b.e + 64};
+    return r;
+}
+
+static diy_fp diy_normalize(diy_fp x) {
+    while ((x.f & ((uint64_t)1 << 63)) == 0) {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
+
+// Positive finite doubles only
+static diy_fp diy_from_double(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biased = (int)((bits >> 52) & 0x7FF);
+    diy_fp v = {bits & (HIDDEN_BIT - 1), -1074};
+    if (biased != 0) {
+        v.f += HIDDEN_BIT;
+        v.e = biased - 1075;
+    }
+    return v;
+}
+
+// Midpoints to the neighbouring doubles, normalized to a common exponent
+static void diy_boundaries(diy_fp v, diy_fp* minus, diy_fp* plus) {
+    diy_fp pl = {(v.f << 1) + 1, v.e - 1};
+    while ((pl.f & (HIDDEN_BIT << 1)) == 0) {
+        pl.f <<= 1;
+        pl.e--;
+    }
+    pl.f <<= 10;
+    pl.e -= 10;
+
+    // Below a power of two the gap to the next lower double is half as wide
+    diy_fp mi = {(v.f << 1) - 1, v.e - 1};
+    if (v.f == HIDDEN_BIT) {
+        mi.f = (v.f << 2) - 1;
+        mi.e = v.e - 2;
+    }
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+    *minus = mi;
+    *plus = pl;
+}
+
+// Cached 10^-k that brings a number with binary exponent e into [2^-60, 2^-32)
+static diy_fp cached_power(int e, int* k) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int ik = (int)dk;
+    if (dk - ik > 0.0) {
+        ik++;
+    }
+    int index = (ik >> 3) + 1;
+    *k = -(-348 + index * 8);
+    return cached_powers[index];
+}
+
+static int decimal_digits(uint32_t n) {
+    int digits = 1;
+    while (digits < 10 && n >= pow10_table[digits]) {
+        digits++;
+    }
+    return digits;
+}
+
+// Step the last digit down while that brings it closer to the exact value
+static void grisu_round(char* digits, int len, uint64_t delta, uint64_t rest,
+                        uint64_t ten_kappa, uint64_t wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        digits[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+/*
+ * Generate the fewest digits of a number inside (wp - delta, wp], with w
+ * the scaled value itself. Returns the digit count; *k gains the decimal
+ * exponent of the last digit.
+ */
+static int digit_gen(diy_fp w, diy_fp wp, uint64_t delta, char* digits, int* k) {
+    const int shift = -wp.e;
+    const uint64_t one = (uint64_t)1 << shift;
+    const uint64_t wp_w = wp.f - w.f;
+    uint32_t p1 = (uint32_t)(wp.f >> shift);
+    uint64_t p2 = wp.f & (one - 1);
+    int kappa = decimal_digits(p1);
+    int len = 0;
+
+    // Integral part
+    while (kappa > 0) {
+        uint32_t div = (uint32_t)pow10_table[kappa - 1];
+        uint32_t d = p1 / div;
+        p1 %= div;
+        if (d != 0 || len != 0) {
+            digits[len++] = (char)('0' + d);
+        }
+        kappa--;
+        uint64_t rest = ((uint64_t)p1 << shift) + p2;
+        if (rest <= delta) {
+            *k += kappa;
+            grisu_round(digits, len, delta, rest, pow10_table[kappa] << shift, wp_w);
+            return len;
+        }
+    }
+
+    // Fractional part
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> shift);
+        if (d != 0 || len != 0) {
+            digits[len++] = (char)('0' + d);
+        }
+        p2 &= one - 1;
+        kappa--;
+        if (p2 < delta) {
+            *k += kappa;
+            int index = -kappa;
+            grisu_round(digits, len, delta, p2, one, wp_w * (index < 20 ? pow10_table[index] : 0));
+            return len;
+        }
+    }
+}
+
+// Shortest digits of a positive finite value; it equals digits * 10^*k
+static int grisu2(double value, char* digits, int* k) {
+    diy_fp v = diy_from_double(value);
+    diy_fp minus, plus;
+    diy_boundaries(v, &minus, &plus);
+    diy_fp c = cached_power(plus.e, k);
+    diy_fp w = diy_multiply(diy_normalize(v), c);
+    diy_fp wp = diy_multiply(plus, c);
+    diy_fp wm = diy_multiply(minus, c);
+    // Shrink the interval by one unit to stay inside it despite rounding
+    wm.f++;
+    wp.f--;
+    return digit_gen(w, wp, wp.f - wm.f, digits, k);
+}
+
+/*
+ * Round to `precision` digits, dropping trailing zeros; may move the point.
+ * A single dropped '5' is a tie only in the shortest digits, not in the
+ * exact value, so that case is left to the C library to round.
+ */
+static int round_digits(double value, char* digits, int len, int precision, int* point) {
+    if (digits[precision] == '5' && len == precision + 1) {
+        char exact[40];
+        snprintf(exact, sizeof(exact), "%.*e", precision - 1, value);
+        const char* e = strchr(exact, 'e');
+        len = 0;
+        for (const char* c = exact; c < e; c++) {
+            if (*c != '.') {
+                digits[len++] = *c;
+            }
+        }
+        *point = atoi(e + 1) + 1;
+        while (len > 1 && digits[len - 1] == '0') {
+            len--;
+        }
+        return len;
+    }
+    int round_up = digits[precision] >= '5';
+    len = precision;
+    if (round_up) {
+        int i = len - 1;
+        while (i >= 0 && digits[i] == '9') {
+            i--;
+        }
+        if (i < 0) {
+            digits[0] = '1';
+            len = 1;
+            (*point)++;
+        } else {
+            digits[i]++;
+            len = i + 1;
+        }
+    }
+    while (len > 1 && digits[len - 1] == '0') {
+        len--;
+    }
+    return len;
+}
+
+// Lay out digits d1d2... as 0.d1d2... * 10^point
+static int layout(char* out, const char* digits, int len, int point) {
+    char* p = out;
+    if (point > -4 && point <= 16) {
+        if (point <= 0) {
+            *p++ = '0';
+            *p++ = '.';
+            memset(p, '0', (size_t)-point);
+            p += -point;
+            memcpy(p, digits, (size_t)len);
+            p += len;
+        } else if (point >= len) {
+            memcpy(p, digits, (size_t)len);
+            p += len;
+            memset(p, '0', (size_t)(point - len));
+            p += point - len;
+        } else {
+            memcpy(p, digits, (size_t)point);
+            p += point;
+            *p++ = '.';
+            memcpy(p, digits + point, (size_t)(len - point));
+            p += len - point;
+        }
+    } else {
+        *p++ = digits[0];
+        if (len > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, (size_t)(len - 1));
+            p += len - 1;
+        }
+        int exponent = point - 1;
+        *p++ = 'e';
+        *p++ = exponent < 0 ? '-' : '+';
+        if (exponent < 0) {
+            exponent = -exponent;
+        }
+        if (exponent >= 100) {
+            *p++ = (char)('0' + exponent / 100);
+            exponent %= 100;
+        }
+        *p++ = (char)('0' + exponent / 10);
+        *p++ = (char)('0' + exponent % 10);
+    }
+    *p = '\0';
+    return (int)(p - out);
+}
+
+int double_format(double value, int precision, char* buf) {
+    char* out = buf;
+    if (isnan(value)) {
+        memcpy(buf, "nan", 4);
+        return 3;
+    }
+    if (signbit(value)) {
+        *out++ = '-';
+        value = -value;
+    }
+    if (isinf(value)) {
+        memcpy(out, "inf", 4);
+        return (int)(out - buf) + 3;
+    }
+    if (value == 0.0) {
+        memcpy(out, "0", 2);
+        return (int)(out - buf) + 1;
+    }
+
+    char digits[32];
+    int k = 0;
+    int len = grisu2(value, digits, &k);
+    int point = len + k;
+    if (precision > 0 && precision < len) {
+        len = round_digits(value, digits, len, precision, &point);
+    }
+    return (int)(out - buf) + layout(out, digits, len, point);
+}
+
+static size_t format_chunk(char* out, const double* const* comps, int ncomp, size_t start,
+                           size_t end, int precision) {
+    char* p = out;
+    for (size_t i = start; i < end; i++) {
+        for (int c = 0; c < ncomp; c++) {
+            if (c > 0) {
+                *p++ = ' ';
+            }
+            if (comps[c] != NULL) {
+                p += double_format(comps[c][i], precision, p);
+            } else {
+                *p++ = '0';
+            }
+        }
+        *p++ = '\n';
+    }
+    return (size_t)(p - out);
+}
+
+int double_format_lines(FILE* f, const double* const* comps, int ncomp, size_t count,
+                        int precision) {
+    size_t nchunks = (count + FORMAT_CHUNK_LINES - 1) / FORMAT_CHUNK_LINES;
+    if (nchunks == 0) {
+        return 0;
+    }
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    size_t batch = (size_t)threads * FORMAT_CHUNKS_PER_THREAD;
+    if (batch > nchunks) {
+        batch = nchunks;
+    }
+    // A value plus its separator or newline per component
+    size_t chunk_bytes = FORMAT_CHUNK_LINES * (size_t)ncomp * (DOUBLE_FORMAT_MAX + 1);
+    char* text = (char*)malloc(batch * chunk_bytes);
+    size_t* lengths = (size_t*)malloc(batch * sizeof(size_t));
+    if (text == NULL || lengths == NULL) {
+        free(text);
+        free(lengths);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    int rc = 0;
+    for (size_t first = 0; first < nchunks && rc == 0; first += batch) {
+        size_t n = nchunks - first < batch ? nchunks - first : batch;
+
+        #pragma omp parallel for schedule(static) if (n > 1)
+        for (ptrdiff_t c = 0; c < (ptrdiff_t)n; c++) {
+            size_t start = (first + (size_t)c) * FORMAT_CHUNK_LINES;
+            size_t end = count - start < FORMAT_CHUNK_LINES ? count : start + FORMAT_CHUNK_LINES;
+            lengths[c] = format_chunk(text + (size_t)c * chunk_bytes, comps, ncomp, start, end,
+                                      precision);
+        }
+
+        // Chunks are written in order, so the file does not depend on the schedule
+        for (size_t c = 0; c < n && rc == 0; c++) {
+            if (fwrite(text + c * chunk_bytes, 1, lengths[c], f) != lengths[c]) {
+                rc = -1;
+            }
+        }
+    }
+    free(text);
+    free(lengths);
+    return rc;
+}
@@ -0,0 +1,50 @@
+/*
+ * Shortest round-trip double formatting
+ *
+ * Grisu2 digit generation (Loitsch, "Printing Floating-Point Numbers
+ * Quickly and Accurately with Integers") with 64-bit integer arithmetic
+ * and a table of cached powers of ten. The digits always parse back to
+ * the same double; they are the shortest such string for all but a tiny
+ * fraction of inputs, where one extra digit may be emitted.
+ *
+ * A fixed number of significant digits can be requested instead, for
+ * previews and logs where file size matters more than exactness. Those
+ * are rounded to nearest like printf's "%.*g".
+ *
+ * Layout follows Python's repr(): plain decimal notation for decimal
+ * exponents from -4 to 15, "1.5e+20" style otherwise, "inf"/"-inf"/"nan"
+ * for the non-finite values.
+ */
+
+#ifndef CFD_PYTHON_DOUBLE_FORMAT_H
+#define CFD_PYTHON_DOUBLE_FORMAT_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+// Longest string double_format() produces, without the terminator
+#define DOUBLE_FORMAT_MAX 24
+
+// Significant digits that always round-trip; larger precisions are clamped
+#define DOUBLE_FORMAT_DIGITS 17
+
+/*
+ * Format `value` into `buf` (at least DOUBLE_FORMAT_MAX + 1 bytes) and
+ * NUL-terminate it. `precision` 0 selects the shortest round-trip digits,
+ * otherwise at most that many significant digits are written. Returns the
+ * length of the string.
+ */
+int double_format(double value, int precision, char* buf);
+
+/*
+ * Write `count` lines of `ncomp` space-separated values taken from the
+ * component arrays (NULL components are written as 0) to `f`.
+ *
+ * Lines are formatted in fixed-size chunks in parallel, each chunk into
+ * its own buffer, and the buffers are written in order, so the output is
+ * identical to the serial one. Returns 0, or -1 with errno set.
+ */
+int double_format_lines(FILE* f, const double* const* comps, int ncomp, size_t count,
+                        int precision);
+
+#endif  // CFD_PYTHON_DOUBLE_FORMAT_H
@@ -0,0 +1,167 @@
+/*
+ * Kinetic energy spectra of periodic fields on uniform grids
+ */
+
+#include "energy_spectrum.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fft.h"
+
+#define SPECTRUM_TWO_PI 6.28318530717958647692
+
+void energy_spectrum_free(energy_spectrum* spec) {
+    free(spec->shell);
+    free(spec->ex);
+    free(spec->ey);
+    memset(spec, 0, sizeof(*spec));
+}
+
+cfd_status_t energy_spectrum_compute(const double* u, const double* v, size_t nx,
+                                     size_t mx, size_t my, double lx, double ly,
+                                     energy_spectrum* out) {
+    memset(out, 0, sizeof(*out));
+    if (mx < 2 || my < 2 || mx > nx || !(lx > 0.0) || !(ly > 0.0)) {
+        return CFD_ERROR_INVALID;
+    }
+
+    size_t hx = mx / 2 + 1;
+    size_t hy = my / 2 + 1;
+    double kx0 = SPECTRUM_TWO_PI / lx;
+    double ky0 = SPECTRUM_TWO_PI / ly;
+    double dk = kx0 < ky0 ? kx0 : ky0;
+    double kmax = sqrt((double)(hx - 1) * (hx - 1) * kx0 * kx0 +
+                       (double)(my / 2) * (my / 2) * ky0 * ky0);
+    size_t num_shells = (size_t)ceil(kmax / dk) + 1;
+
+    rfft_plan row_plan;
+    fft_plan col_plan;
+    cfd_status_t status = rfft_plan_init(&row_plan, mx);
+    if (status != CFD_SUCCESS) {
+        return status;
+    }
+    status = fft_plan_init(&col_plan, my);
+    if (status != CFD_SUCCESS) {
+        rfft_plan_free(&row_plan);
+        return status;
+    }
+
+    // Row transforms of u and v, stored as my rows of hx interleaved modes
+    double* modes = (double*)malloc(2 * 2 * hx * my * sizeof(double));
+    out->shell = (double*)calloc(num_shells, sizeof(double));
+    out->ex = (double*)calloc(hx, sizeof(double));
+    out->ey = (double*)calloc(hy, sizeof(double));
+    if (modes == NULL || out->shell == NULL || out->ex == NULL || out->ey == NULL) {
+        free(modes);
+        energy_spectrum_free(out);
+        rfft_plan_free(&row_plan);
+        fft_plan_free(&col_plan);
+        return CFD_ERROR_NOMEM;
+    }
+    double* u_modes = modes;
+    double* v_modes = modes + 2 * hx * my;
+    size_t row_scratch = rfft_scratch_size(&row_plan);
+    size_t col_scratch = 2 * my + fft_scratch_size(&col_plan);
+    double norm = 0.5 / ((double)mx * (double)my * (double)mx * (double)my);
+    int failed = 0;
+    double energy = 0.0;
+
+    #pragma omp parallel
+    {
+        double* scratch = (double*)malloc(row_scratch * sizeof(double));
+        if (scratch == NULL) {
+            #pragma omp critical
+            failed = 1;
+        }
+        #pragma omp for schedule(static)
+        for (ptrdiff_t j = 0; j < (ptrdiff_t)my; j++) {
+            if (scratch == NULL) {
+                continue;
+            }
+            rfft_forward(&row_plan, u + (size_t)j * nx, u_modes + 2 * hx * (size_t)j, scratch);
+            rfft_forward(&row_plan, v + (size_t)j * nx, v_modes + 2 * hx * (size_t)j, scratch);
+        }
+        free(scratch);
+    }
+
+    if (!failed) {
+        #pragma omp parallel
+        {
+            // Column data followed by the column transform's own scratch
+            double* work = (double*)malloc(col_scratch * sizeof(double));
+            double* shell = (double*)calloc(num_shells, sizeof(double));
+            double* ey = (double*)calloc(hy, sizeof(double));
+            double local_energy = 0.0;
+            if (work == NULL || shell == NULL || ey == NULL) {
+                #pragma omp critical
+                failed = 1;
+            }
+
+            #pragma omp for schedule(static)
+            for (ptrdiff_t i = 0; i < (ptrdiff_t)hx; i++) {
+                if (work == NULL || shell == NULL || ey == NULL) {
+                    continue;
+                }
+                // Columns 1..(mx-1)/2 stand for themselves and their conjugate twins
+                double weight = (i == 0 || 2 * (size_t)i == mx) ? norm : 2.0 * norm;
+                double column = 0.0;
+                for (int c = 0; c < 2; c++) {
+                    const double* src = (c == 0 ? u_modes : v_modes) + 2 * (size_t)i;
+                    for (size_t j = 0; j < my; j++) {
+                        work[2 * j] = src[2 * hx * j];
+                        work[2 * j + 1] = src[2 * hx * j + 1];
+                    }
+                    fft_forward(&col_plan, work, work + 2 * my);
+                    for (size_t j = 0; j < my; j++) {
+                        // Signed wavenumber index of row j
+                        size_t ky_index = j <= my / 2 ? j : my - j;
+                        double e = weight * (work[2 * j] * work[2 * j] +
+                                             work[2 * j + 1] * work[2 * j + 1]);
+                        double kx = kx0 * (double)i;
+                        double ky = ky0 * (double)ky_index;
+                        size_t s = (size_t)floor(sqrt(kx * kx + ky * ky) / dk + 0.5);
+                        shell[s < num_shells ? s : num_shells - 1] += e;
+                        ey[ky_index] += e;
+                        column += e;
+                    }
+                }
+                out->ex[i] = column;
+                local_energy += column;
+            }
+
+            #pragma omp critical
+            {
+                if (shell != NULL && ey != NULL) {
+                    for (size_t s = 0; s < num_shells; s++) {
+                        out->shell[s] += shell[s];
+                    }
+                    for (size_t k = 0; k < hy; k++) {
+                        out->ey[k] += ey[k];
+                    }
+                }
+                energy += local_energy;
+            }
+            free(work);
+            free(shell);
+            free(ey);
+        }
+    }
+
+    free(modes);
+    rfft_plan_free(&row_plan);
+    fft_plan_free(&col_plan);
+    if (failed) {
+        energy_spectrum_free(out);
+        return CFD_ERROR_NOMEM;
+    }
+    out->num_shells = num_shells;
+    out->num_kx = hx;
+    out->num_ky = hy;
+    out->dk = dk;
+    out->dkx = kx0;
+    out->dky = ky0;
+    out->energy = energy;
+    return CFD_SUCCESS;
+}
@@ -0,0 +1,42 @@
+/*
+ * Kinetic energy spectra of periodic fields on uniform grids
+ *
+ * u and v are transformed in 2D (real FFT along rows, complex FFT along
+ * columns) and the modal energy 1/2 (|u_k|^2 + |v_k|^2) / N^2 is
+ *   - binned into shells of |k| with width dk = min(2 pi / Lx, 2 pi / Ly),
+ *     shell s collecting round(|k| / dk) == s,
+ *   - summed over ky into E_x(kx) and over kx into E_y(ky), which equal the
+ *     row-averaged (column-averaged) 1D spectra by Parseval.
+ * Every spectrum sums to the mean kinetic energy 1/2 <u^2 + v^2>.
+ */
+
+#ifndef CFD_PYTHON_ENERGY_SPECTRUM_H
+#define CFD_PYTHON_ENERGY_SPECTRUM_H
+
+#include <stddef.h>
+
+#include "cfd/core/cfd_status.h"
+
+typedef struct {
+    size_t num_shells;  // ceil of the largest |k| / dk, plus one
+    size_t num_kx;      // mx / 2 + 1
+    size_t num_ky;      // my / 2 + 1
+    double dk;          // Shell width
+    double dkx, dky;    // Fundamental wavenumbers 2 pi / Lx and 2 pi / Ly
+    double* shell;      // E(|k|), num_shells entries
+    double* ex;         // E_x(kx), num_kx entries
+    double* ey;         // E_y(ky), num_ky entries
+    double energy;      // 1/2 <u^2 + v^2>
+} energy_spectrum;
+
+/*
+ * Spectrum of the leading mx x my block of row-major fields with row length
+ * nx (mx < nx drops a duplicated periodic column). lx and ly are the
+ * periods. The output arrays are allocated here.
+ */
+cfd_status_t energy_spectrum_compute(const double* u, const double* v, size_t nx,
+                                     size_t mx, size_t my, double lx, double ly,
+                                     energy_spectrum* out);
+void energy_spectrum_free(energy_spectrum* spec);
+
+#endif  // CFD_PYTHON_ENERGY_SPECTRUM_H
@@ -0,0 +1,114 @@
+/*
+ * Ensemble stopping policies
+ */
+
+#include "ensemble.h"
+
+#include <math.h>
+
+static const char* const outcome_names[] = {
+    "running",
+    "completed",
+    "converged",
+    "max_velocity",
+    "max_pressure",
+    "max_residual",
+    "max_divergence",
+    "diverged",
+    "error",
+};
+
+const char* ensemble_outcome_name(ensemble_outcome outcome) {
+    if ((int)outcome < 0 || (size_t)outcome >= sizeof(outcome_names) / sizeof(outcome_names[0])) {
+        return "unknown";
+    }
+    return outcome_names[outcome];
+}
+
+int ensemble_policy_needs_history(const ensemble_policy* policy) {
+    return policy->max_residual > 0.0 || policy->converge_tol > 0.0;
+}
+
+void flow_field_sample(const flow_field* field, const grid* g, double* prev_u, double* prev_v,
+                       size_t steps, int with_divergence, field_sample* out) {
+    const double* u = field->u;
+    const double* v = field->v;
+    const double* p = field->p;
+    const double* x = g->x;
+    const double* y = g->y;
+    ptrdiff_t nx = (ptrdiff_t)field->nx;
+    ptrdiff_t ny = (ptrdiff_t)field->ny;
+    int track = prev_u != NULL && prev_v != NULL;
+    double max_sq = 0.0, max_p = 0.0, max_change = 0.0, max_div = 0.0;
+    int non_finite = 0;
+
+    #pragma omp parallel
+    {
+        double l_sq = 0.0, l_p = 0.0, l_change = 0.0, l_div = 0.0;
+        int l_bad = 0;
+
+        #pragma omp for schedule(static)
+        for (ptrdiff_t j = 0; j < ny; j++) {
+            int interior_row = with_divergence && j > 0 && j < ny - 1;
+            for (ptrdiff_t i = 0; i < nx; i++) {
+                ptrdiff_t k = j * nx + i;
+                double speed_sq = u[k] * u[k] + v[k] * v[k];
+                double abs_p = fabs(p[k]);
+                l_bad |= ((u[k] - u[k]) + (v[k] - v[k]) + (p[k] - p[k])) != 0.0;
+                l_sq = speed_sq > l_sq ? speed_sq : l_sq;
+                l_p = abs_p > l_p ? abs_p : l_p;
+                if (track) {
+                    double du = fabs(u[k] - prev_u[k]);
+                    double dv = fabs(v[k] - prev_v[k]);
+                    double change = du > dv ? du : dv;
+                    l_change = change > l_change ? change : l_change;
+                    prev_u[k] = u[k];
+                    prev_v[k] = v[k];
+                }
+                if (interior_row && i > 0 && i < nx - 1) {
+                    double div = (u[k + 1] - u[k - 1]) / (x[i + 1] - x[i - 1]) +
+                                 (v[k + nx] - v[k - nx]) / (y[j + 1] - y[j - 1]);
+                    div = fabs(div);
+                    l_div = div > l_div ? div : l_div;
+                }
+            }
+        }
+
+        #pragma omp critical
+        {
+            non_finite |= l_bad;
+            max_sq = l_sq > max_sq ? l_sq : max_sq;
+            max_p = l_p > max_p ? l_p : max_p;
+            max_change = l_change > max_change ? l_change : max_change;
+            max_div = l_div > max_div ? l_div : max_div;
+        }
+    }
+
+    out->max_speed = sqrt(max_sq);
+    out->max_pressure = max_p;
+    out->residual = track && steps > 0 ? max_change / (double)steps : 0.0;
+    out->max_divergence = max_div;
+    out->non_finite = non_finite;
+}
+
+ensemble_outcome ensemble_policy_check(const ensemble_policy* policy, const field_sample* sample) {
+    if (sample->non_finite) {
+        return ENSEMBLE_DIVERGED;
+    }
+    if (policy->max_velocity > 0.0 && sample->max_speed > policy->max_velocity) {
+        return ENSEMBLE_STOP_VELOCITY;
+    }
+    if (policy->max_pressure > 0.0 && sample->max_pressure > policy->max_pressure) {
+        return ENSEMBLE_STOP_PRESSURE;
+    }
+    if (policy->max_divergence > 0.0 && sample->max_divergence > policy->max_divergence) {
+        return ENSEMBLE_STOP_DIVERGENCE;
+    }
+    if (policy->max_residual > 0.0 && sample->residual > policy->max_residual) {
+        return ENSEMBLE_STOP_RESIDUAL;
+    }
+    if (policy->converge_tol > 0.0 && sample->residual < policy->converge_tol) {
+        return ENSEMBLE_CONVERGED;
+    }
+    return ENSEMBLE_RUNNING;
+}
@@ -0,0 +1,65 @@
+/*
+ * Ensemble stopping policies
+ *
+ * A fused scan that samples the quantities the stopping predicates need
+ * (peak speed, peak pressure, per-step change and velocity divergence) and
+ * the evaluation of those predicates for one ensemble member.
+ */
+
+#ifndef CFD_PYTHON_ENSEMBLE_H
+#define CFD_PYTHON_ENSEMBLE_H
+
+#include <stddef.h>
+
+#include "cfd/core/grid.h"
+#include "cfd/solvers/navier_stokes_solver.h"
+
+typedef enum {
+    ENSEMBLE_RUNNING = 0,
+    ENSEMBLE_COMPLETED,        // Ran all requested steps
+    ENSEMBLE_CONVERGED,        // Residual fell below converge_tol
+    ENSEMBLE_STOP_VELOCITY,    // Peak speed above max_velocity
+    ENSEMBLE_STOP_PRESSURE,    // Peak |p| above max_pressure
+    ENSEMBLE_STOP_RESIDUAL,    // Residual above max_residual
+    ENSEMBLE_STOP_DIVERGENCE,  // Peak |div u| above max_divergence
+    ENSEMBLE_DIVERGED,         // NaN/Inf or CFD_ERROR_DIVERGED
+    ENSEMBLE_FAILED            // Any other solver error
+} ensemble_outcome;
+
+// Thresholds <= 0 are disabled
+typedef struct {
+    size_t check_interval;
+    double max_velocity;
+    double max_pressure;
+    double max_residual;
+    double max_divergence;
+    double converge_tol;
+} ensemble_policy;
+
+typedef struct {
+    double max_speed;
+    double max_pressure;    // Largest |p|
+    double residual;        // Largest |du|, |dv| per step since the last sample
+    double max_divergence;  // Largest |du/dx + dv/dy| over interior points
+    int non_finite;
+} field_sample;
+
+// Name used for an outcome in the Python results ("converged", ...)
+const char* ensemble_outcome_name(ensemble_outcome outcome);
+
+// 1 if the policy needs the previous u/v to compute residuals
+int ensemble_policy_needs_history(const ensemble_policy* policy);
+
+/*
+ * Sample `field` in one pass. When `prev_u`/`prev_v` are given the residual
+ * is taken against them over `steps` steps and they are updated to the
+ * current values. Divergence uses central differences on the grid
+ * coordinates and is only computed if `with_divergence` is set.
+ */
+void flow_field_sample(const flow_field* field, const grid* g, double* prev_u, double* prev_v,
+                       size_t steps, int with_divergence, field_sample* out);
+
+// Evaluate the stopping predicates; ENSEMBLE_RUNNING means keep going
+ensemble_outcome ensemble_policy_check(const ensemble_policy* policy, const field_sample* sample);
+
+#endif  // CFD_PYTHON_ENSEMBLE_H
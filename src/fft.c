@@ -0,0 +1,223 @@
+/*
+ * In-tree forward FFT
+ */
+
+#include "fft.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FFT_PI 3.14159265358979323846
+
+static int is_power_of_two(size_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+// Radix-2 decimation in time on plan->m interleaved values
+static void fft_radix2(const fft_plan* plan, double* a) {
+    size_t m = plan->m;
+    for (size_t i = 0; i < m; i++) {
+        size_t r = plan->bitrev[i];
+        if (r > i) {
+            double re = a[2 * i], im = a[2 * i + 1];
+            a[2 * i] = a[2 * r];
+            a[2 * i + 1] = a[2 * r + 1];
+            a[2 * r] = re;
+            a[2 * r + 1] = im;
+        }
+    }
+
+    // Each butterfly stage walks contiguous halves so the inner loop vectorizes
+    for (size_t half = 1; half < m; half *= 2) {
+        size_t stride = m / (2 * half);
+        for (size_t base = 0; base < m; base += 2 * half) {
+            double* lo = a + 2 * base;
+            double* hi = lo + 2 * half;
+            for (size_t k = 0; k < half; k++) {
+                double wr = plan->twiddle[2 * k * stride];
+                double wi = plan->twiddle[2 * k * stride + 1];
+                double tr = hi[2 * k] * wr - hi[2 * k + 1] * wi;
+                double ti = hi[2 * k] * wi + hi[2 * k + 1] * wr;
+                hi[2 * k] = lo[2 * k] - tr;
+                hi[2 * k + 1] = lo[2 * k + 1] - ti;
+                lo[2 * k] += tr;
+                lo[2 * k + 1] += ti;
+            }
+        }
+    }
+}
+
+cfd_status_t fft_plan_init(fft_plan* plan, size_t n) {
+    memset(plan, 0, sizeof(*plan));
+    if (n == 0) {
+        return CFD_ERROR_INVALID;
+    }
+    size_t m = 1;
+    size_t bits = 0;
+    size_t target = is_power_of_two(n) ? n : 2 * n - 1;
+    while (m < target) {
+        m *= 2;
+        bits++;
+    }
+    plan->n = n;
+    plan->m = m;
+    plan->bitrev = (size_t*)malloc(m * sizeof(size_t));
+    plan->twiddle = (double*)malloc((m > 1 ? m : 2) * sizeof(double));
+    if (plan->bitrev == NULL || plan->twiddle == NULL) {
+        fft_plan_free(plan);
+        return CFD_ERROR_NOMEM;
+    }
+    for (size_t i = 0; i < m; i++) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; b++) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        plan->bitrev[i] = r;
+    }
+    for (size_t k = 0; k < m / 2; k++) {
+        double angle = -2.0 * FFT_PI * (double)k / (double)m;
+        plan->twiddle[2 * k] = cos(angle);
+        plan->twiddle[2 * k + 1] = sin(angle);
+    }
+    if (m == n) {
+        return CFD_SUCCESS;
+    }
+
+    // Bluestein: X_k = c_k * sum_j (x_j c_j) conj(c_(k-j)) with c_k = exp(-i pi k^2 / n)
+    plan->chirp = (double*)malloc(2 * n * sizeof(double));
+    plan->chirp_fft = (double*)calloc(2 * m, sizeof(double));
+    if (plan->chirp == NULL || plan->chirp_fft == NULL) {
+        fft_plan_free(plan);
+        return CFD_ERROR_NOMEM;
+    }
+    for (size_t k = 0; k < n; k++) {
+        // k^2 mod 2n keeps the angle small and exact for large k
+        size_t q = (size_t)(((unsigned long long)k * k) % (2ULL * n));
+        double angle = -FFT_PI * (double)q / (double)n;
+        plan->chirp[2 * k] = cos(angle);
+        plan->chirp[2 * k + 1] = sin(angle);
+    }
+    double* b = plan->chirp_fft;
+    b[0] = plan->chirp[0];
+    b[1] = -plan->chirp[1];
+    for (size_t k = 1; k < n; k++) {
+        b[2 * k] = b[2 * (m - k)] = plan->chirp[2 * k];
+        b[2 * k + 1] = b[2 * (m - k) + 1] = -plan->chirp[2 * k + 1];
+    }
+    fft_radix2(plan, b);
+    return CFD_SUCCESS;
+}
+
+void fft_plan_free(fft_plan* plan) {
+    free(plan->bitrev);
+    free(plan->twiddle);
+    free(plan->chirp);
+    free(plan->chirp_fft);
+    memset(plan, 0, sizeof(*plan));
+}
+
+size_t fft_scratch_size(const fft_plan* plan) {
+    return plan->m == plan->n ? 0 : 2 * plan->m;
+}
+
+void fft_forward(const fft_plan* plan, double* data, double* scratch) {
+    size_t n = plan->n;
+    size_t m = plan->m;
+    if (m == n) {
+        fft_radix2(plan, data);
+        return;
+    }
+
+    const double* c = plan->chirp;
+    const double* bf = plan->chirp_fft;
+    for (size_t k = 0; k < n; k++) {
+        double xr = data[2 * k], xi = data[2 * k + 1];
+        scratch[2 * k] = xr * c[2 * k] - xi * c[2 * k + 1];
+        scratch[2 * k + 1] = xr * c[2 * k + 1] + xi * c[2 * k];
+    }
+    memset(scratch + 2 * n, 0, 2 * (m - n) * sizeof(double));
+    fft_radix2(plan, scratch);
+
+    // Pointwise product, conjugated so a forward transform acts as the inverse
+    for (size_t k = 0; k < m; k++) {
+        double ar = scratch[2 * k], ai = scratch[2 * k + 1];
+        scratch[2 * k] = ar * bf[2 * k] - ai * bf[2 * k + 1];
+        scratch[2 * k + 1] = -(ar * bf[2 * k + 1] + ai * bf[2 * k]);
+    }
+    fft_radix2(plan, scratch);
+
+    double scale = 1.0 / (double)m;
+    for (size_t k = 0; k < n; k++) {
+        double yr = scratch[2 * k] * scale, yi = -scratch[2 * k + 1] * scale;
+        data[2 * k] = yr * c[2 * k] - yi * c[2 * k + 1];
+        data[2 * k + 1] = yr * c[2 * k + 1] + yi * c[2 * k];
+    }
+}
+
+cfd_status_t rfft_plan_init(rfft_plan* plan, size_t n) {
+    memset(plan, 0, sizeof(*plan));
+    if (n == 0) {
+        return CFD_ERROR_INVALID;
+    }
+    plan->n = n;
+    size_t len = n % 2 == 0 ? n / 2 : n;
+    cfd_status_t status = fft_plan_init(&plan->complex, len);
+    if (status != CFD_SUCCESS || n % 2 != 0) {
+        return status;
+    }
+    plan->split = (double*)malloc(n * sizeof(double));
+    if (plan->split == NULL) {
+        rfft_plan_free(plan);
+        return CFD_ERROR_NOMEM;
+    }
+    for (size_t k = 0; k < n / 2; k++) {
+        double angle = -2.0 * FFT_PI * (double)k / (double)n;
+        plan->split[2 * k] = cos(angle);
+        plan->split[2 * k + 1] = sin(angle);
+    }
+    return CFD_SUCCESS;
+}
+
+void rfft_plan_free(rfft_plan* plan) {
+    fft_plan_free(&plan->complex);
+    free(plan->split);
+    memset(plan, 0, sizeof(*plan));
+}
+
+size_t rfft_scratch_size(const rfft_plan* plan) {
+    return 2 * plan->complex.n + fft_scratch_size(&plan->complex);
+}
+
+void rfft_forward(const rfft_plan* plan, const double* in, double* out, double* scratch) {
+    size_t n = plan->n;
+    double* z = scratch;
+    double* rest = scratch + 2 * plan->complex.n;
+
+    if (n % 2 != 0) {
+        for (size_t k = 0; k < n; k++) {
+            z[2 * k] = in[k];
+            z[2 * k + 1] = 0.0;
+        }
+        fft_forward(&plan->complex, z, rest);
+        memcpy(out, z, 2 * (n / 2 + 1) * sizeof(double));
+        return;
+    }
+
+    // Pack even/odd samples as one half-length complex signal, then split
+    size_t h = n / 2;
+    memcpy(z, in, n * sizeof(double));
+    fft_forward(&plan->complex, z, rest);
+    for (size_t k = 0; k <= h; k++) {
+        size_t a = k % h;
+        size_t b = (h - k) % h;
+        double zr = z[2 * a], zi = z[2 * a + 1];
+        double cr = z[2 * b], ci = -z[2 * b + 1];
+        double er = 0.5 * (zr + cr), ei = 0.5 * (zi + ci);
+        double dr = 0.5 * (zi - ci), di = -0.5 * (zr - cr);
+        double wr = k < h ? plan->split[2 * k] : -1.0;
+        double wi = k < h ? plan->split[2 * k + 1] : 0.0;
+        out[2 * k] = er + wr * dr - wi * di;
+        out[2 * k + 1] = ei + wr * di + wi * dr;
+    }
+}
@@ -0,0 +1,50 @@
+/*
+ * In-tree forward FFT
+ *
+ * Complex transforms of any length: iterative radix-2 for powers of two,
+ * Bluestein's chirp-z algorithm (via a power-of-two transform) otherwise.
+ * Real transforms of even length run as a half-length complex transform
+ * plus a split step. Complex data is interleaved (re, im) doubles.
+ *
+ * Plans are read-only after init and may be shared between threads; each
+ * thread passes its own scratch array of *_scratch_size() doubles.
+ */
+
+#ifndef CFD_PYTHON_FFT_H
+#define CFD_PYTHON_FFT_H
+
+#include <stddef.h>
+
+#include "cfd/core/cfd_status.h"
+
+typedef struct {
+    size_t n;           // Transform length
+    size_t m;           // Power-of-two work length (n, or the Bluestein length)
+    size_t* bitrev;     // Bit-reversal permutation of 0..m-1
+    double* twiddle;    // m/2 interleaved exp(-2 pi i k / m)
+    double* chirp;      // Bluestein only: n interleaved exp(-i pi k^2 / n)
+    double* chirp_fft;  // Bluestein only: transform of the m-point chirp filter
+} fft_plan;
+
+typedef struct {
+    size_t n;          // Real input length
+    fft_plan complex;  // n/2-point plan for even n, n-point plan for odd n
+    double* split;     // Even n only: n/2 interleaved exp(-2 pi i k / n)
+} rfft_plan;
+
+// CFD_ERROR_INVALID for n == 0, CFD_ERROR_NOMEM on allocation failure
+cfd_status_t fft_plan_init(fft_plan* plan, size_t n);
+void fft_plan_free(fft_plan* plan);
+size_t fft_scratch_size(const fft_plan* plan);
+
+// In-place forward transform of n interleaved complex values
+void fft_forward(const fft_plan* plan, double* data, double* scratch);
+
+cfd_status_t rfft_plan_init(rfft_plan* plan, size_t n);
+void rfft_plan_free(rfft_plan* plan);
+size_t rfft_scratch_size(const rfft_plan* plan);
+
+// Forward transform of n reals into the n/2 + 1 non-negative frequencies
+void rfft_forward(const rfft_plan* plan, const double* in, double* out, double* scratch);
+
+#endif  // CFD_PYTHON_FFT_H
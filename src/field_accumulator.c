@@ -0,0 +1,133 @@
+/*
+ * Running time-average accumulators
+ */
+
+#include "field_accumulator.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char* const accumulator_names[ACCUM_NUM_FIELDS] = {
+    "mean_u", "mean_v", "mean_p",
+    "uu", "vv", "uv", "pp",
+    "min_u", "max_u", "min_v", "max_v", "min_p", "max_p",
+};
+
+field_accumulator* field_accumulator_create(size_t count, size_t interval) {
+    if (count == 0 || interval == 0) {
+        return NULL;
+    }
+    field_accumulator* acc = (field_accumulator*)calloc(1, sizeof(field_accumulator));
+    if (acc == NULL) {
+        return NULL;
+    }
+    acc->data = (double*)calloc(count * ACCUM_NUM_FIELDS, sizeof(double));
+    if (acc->data == NULL) {
+        free(acc);
+        return NULL;
+    }
+    acc->count = count;
+    acc->interval = interval;
+    return acc;
+}
+
+void field_accumulator_destroy(field_accumulator* acc) {
+    if (acc != NULL) {
+        free(acc->data);
+        free(acc->committed);
+        free(acc);
+    }
+}
+
+double* field_accumulator_get(const field_accumulator* acc, accumulator_field which) {
+    return acc->data + (size_t)which * acc->count;
+}
+
+const char* field_accumulator_name(accumulator_field which) {
+    return accumulator_names[which];
+}
+
+void field_accumulator_update(field_accumulator* acc, const flow_field* field, size_t step) {
+    if (acc->samples > 0 && step <= acc->last_step) {
+        return;
+    }
+    const double* u = field->u;
+    const double* v = field->v;
+    const double* p = field->p;
+    double* mu = field_accumulator_get(acc, ACCUM_MEAN_U);
+    double* mv = field_accumulator_get(acc, ACCUM_MEAN_V);
+    double* mp = field_accumulator_get(acc, ACCUM_MEAN_P);
+    double* uu = field_accumulator_get(acc, ACCUM_UU);
+    double* vv = field_accumulator_get(acc, ACCUM_VV);
+    double* uv = field_accumulator_get(acc, ACCUM_UV);
+    double* pp = field_accumulator_get(acc, ACCUM_PP);
+    double* min_u = field_accumulator_get(acc, ACCUM_MIN_U);
+    double* max_u = field_accumulator_get(acc, ACCUM_MAX_U);
+    double* min_v = field_accumulator_get(acc, ACCUM_MIN_V);
+    double* max_v = field_accumulator_get(acc, ACCUM_MAX_V);
+    double* min_p = field_accumulator_get(acc, ACCUM_MIN_P);
+    double* max_p = field_accumulator_get(acc, ACCUM_MAX_P);
+    ptrdiff_t n = (ptrdiff_t)acc->count;
+
+    acc->samples++;
+    acc->last_step = step;
+    double inv = 1.0 / (double)acc->samples;
+
+    if (acc->samples == 1) {
+        #pragma omp parallel for schedule(static)
+        for (ptrdiff_t i = 0; i < n; i++) {
+            mu[i] = min_u[i] = max_u[i] = u[i];
+            mv[i] = min_v[i] = max_v[i] = v[i];
+            mp[i] = min_p[i] = max_p[i] = p[i];
+            uu[i] = vv[i] = uv[i] = pp[i] = 0.0;
+        }
+        return;
+    }
+
+    // Welford: mean += d/n and M2 += d * (x - new_mean), kept divided by n
+    #pragma omp parallel for schedule(static)
+    for (ptrdiff_t i = 0; i < n; i++) {
+        double du = u[i] - mu[i];
+        double dv = v[i] - mv[i];
+        double dp = p[i] - mp[i];
+        mu[i] += du * inv;
+        mv[i] += dv * inv;
+        mp[i] += dp * inv;
+        uu[i] += (du * (u[i] - mu[i]) - uu[i]) * inv;
+        vv[i] += (dv * (v[i] - mv[i]) - vv[i]) * inv;
+        uv[i] += (du * (v[i] - mv[i]) - uv[i]) * inv;
+        pp[i] += (dp * (p[i] - mp[i]) - pp[i]) * inv;
+        min_u[i] = u[i] < min_u[i] ? u[i] : min_u[i];
+        max_u[i] = u[i] > max_u[i] ? u[i] : max_u[i];
+        min_v[i] = v[i] < min_v[i] ? v[i] : min_v[i];
+        max_v[i] = v[i] > max_v[i] ? v[i] : max_v[i];
+        min_p[i] = p[i] < min_p[i] ? p[i] : min_p[i];
+        max_p[i] = p[i] > max_p[i] ? p[i] : max_p[i];
+    }
+}
+
+int field_accumulator_commit(field_accumulator* acc) {
+    if (acc->committed == NULL) {
+        acc->committed = (double*)malloc(acc->count * ACCUM_NUM_FIELDS * sizeof(double));
+        if (acc->committed == NULL) {
+            return -1;
+        }
+    } else if (acc->committed_samples == acc->samples) {
+        return 0;
+    }
+    memcpy(acc->committed, acc->data, acc->count * ACCUM_NUM_FIELDS * sizeof(double));
+    acc->committed_samples = acc->samples;
+    acc->committed_step = acc->last_step;
+    return 0;
+}
+
+void field_accumulator_revert(field_accumulator* acc) {
+    if (acc->committed == NULL) {
+        acc->samples = 0;
+        acc->last_step = 0;
+        return;
+    }
+    memcpy(acc->data, acc->committed, acc->count * ACCUM_NUM_FIELDS * sizeof(double));
+    acc->samples = acc->committed_samples;
+    acc->last_step = acc->committed_step;
+}
@@ -0,0 +1,74 @@
+/*
+ * Running time-average accumulators
+ *
+ * Per-point running mean, second moments and min/max envelopes of u, v and
+ * p, updated in place from the solver state. Memory is a fixed 13 fields
+ * regardless of how many samples are taken. All statistics are stored in
+ * final form (the moments are updated with Welford's recurrence), so the
+ * arrays can be read at any time without a finalization step.
+ *
+ * With a divergence guard the state at each verified checkpoint is
+ * committed to a second copy, so samples taken since then can be discarded
+ * when the run rolls back.
+ */
+
+#ifndef CFD_PYTHON_FIELD_ACCUMULATOR_H
+#define CFD_PYTHON_FIELD_ACCUMULATOR_H
+
+#include <stddef.h>
+
+#include "cfd/solvers/navier_stokes_solver.h"
+
+typedef enum {
+    ACCUM_MEAN_U = 0,
+    ACCUM_MEAN_V,
+    ACCUM_MEAN_P,
+    ACCUM_UU,      // <u'u'>
+    ACCUM_VV,      // <v'v'>
+    ACCUM_UV,      // <u'v'>
+    ACCUM_PP,      // <p'p'>
+    ACCUM_MIN_U,
+    ACCUM_MAX_U,
+    ACCUM_MIN_V,
+    ACCUM_MAX_V,
+    ACCUM_MIN_P,
+    ACCUM_MAX_P,
+    ACCUM_NUM_FIELDS
+} accumulator_field;
+
+typedef struct {
+    size_t interval;  // Sample every `interval` steps
+    size_t samples;
+    size_t count;     // Points per field
+    size_t last_step; // Step of the newest sample
+    double* data;     // ACCUM_NUM_FIELDS arrays of `count` doubles
+    // Copy of data at the last commit (NULL until the first commit)
+    double* committed;
+    size_t committed_samples;
+    size_t committed_step;
+} field_accumulator;
+
+// Allocate an empty accumulator for fields of `count` points; NULL on failure
+field_accumulator* field_accumulator_create(size_t count, size_t interval);
+void field_accumulator_destroy(field_accumulator* acc);
+
+// Array of one accumulated quantity
+double* field_accumulator_get(const field_accumulator* acc, accumulator_field which);
+
+// Name used for a quantity in the Python API ("mean_u", "uu", ...)
+const char* field_accumulator_name(accumulator_field which);
+
+/*
+ * Fold the current u, v and p at `step` into the accumulator. Steps at or
+ * before the newest sample were already counted (they are re-run after a
+ * rollback past a commit) and are skipped.
+ */
+void field_accumulator_update(field_accumulator* acc, const flow_field* field, size_t step);
+
+// Mark every sample so far as verified. Returns -1 if out of memory.
+int field_accumulator_commit(field_accumulator* acc);
+
+// Discard the samples taken since the last commit
+void field_accumulator_revert(field_accumulator* acc);
+
+#endif  // CFD_PYTHON_FIELD_ACCUMULATOR_H
@@ -0,0 +1,541 @@
+/*
+ * Float64 field compression: lossless and error-bounded lossy methods
+ */
+
+#include "field_codec.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 12
+#define LZ_MAX_OFFSET 65535
+
+#define CHUNK_RAW ((uint32_t)1 << 31)
+
+static uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t lz_hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Write the continuation bytes of a length that did not fit its nibble
+static uint8_t* put_length(uint8_t* op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+static int get_length(const uint8_t** ip, const uint8_t* end, size_t* len) {
+    uint8_t byte;
+    do {
+        if (*ip >= end) {
+            return -1;
+        }
+        byte = *(*ip)++;
+        *len += byte;
+    } while (byte == 255);
+    return 0;
+}
+
+// Bytes a sequence of `lit` literals and a match of `extra` bytes past the minimum may take
+static size_t sequence_bound(size_t lit, size_t extra) {
+    return 1 + lit / 255 + 1 + lit + 2 + extra / 255 + 1;
+}
+
+/*
+ * Compress `n` bytes into at most `cap` bytes. Returns the compressed size,
+ * or 0 if the output would not fit.
+ */
+static size_t lz_compress(const uint8_t* src, size_t n, uint8_t* dst, size_t cap) {
+    uint32_t table[1 << LZ_HASH_BITS];
+    memset(table, 0, sizeof(table));
+    const uint8_t* ip = src;
+    const uint8_t* anchor = src;
+    const uint8_t* end = src + n;
+    uint8_t* op = dst;
+    uint8_t* limit = dst + cap;
+
+    while (n >= LZ_MIN_MATCH && ip <= end - LZ_MIN_MATCH) {
+        uint32_t seq = read32(ip);
+        uint32_t h = lz_hash(seq);
+        const uint8_t* ref = src + table[h];
+        table[h] = (uint32_t)(ip - src);
+        if (ref >= ip || ip - ref > LZ_MAX_OFFSET || read32(ref) != seq) {
+            // Skip faster through data that keeps missing, such as noisy low bytes
+            ip += 1 + ((size_t)(ip - anchor) >> 6);
+            continue;
+        }
+        const uint8_t* mp = ip + LZ_MIN_MATCH;
+        const uint8_t* rp = ref + LZ_MIN_MATCH;
+        while (mp < end && *mp == *rp) {
+            mp++;
+            rp++;
+        }
+        size_t lit = (size_t)(ip - anchor);
+        size_t extra = (size_t)(mp - ip) - LZ_MIN_MATCH;
+        if (sequence_bound(lit, extra) > (size_t)(limit - op)) {
+            return 0;
+        }
+        uint8_t* token = op++;
+        *token = (uint8_t)(((lit >= 15 ? 15 : lit) << 4) | (extra >= 15 ? 15 : extra));
+        if (lit >= 15) {
+            op = put_length(op, lit - 15);
+        }
+        memcpy(op, anchor, lit);
+        op += lit;
+        size_t offset = (size_t)(ip - ref);
+        *op++ = (uint8_t)(offset & 0xff);
+        *op++ = (uint8_t)(offset >> 8);
+        if (extra >= 15) {
+            op = put_length(op, extra - 15);
+        }
+        ip = anchor = mp;
+    }
+
+    // The last sequence is literals only
+    size_t lit = (size_t)(end - anchor);
+    if (1 + lit / 255 + 1 + lit > (size_t)(limit - op)) {
+        return 0;
+    }
+    *op++ = (uint8_t)((lit >= 15 ? 15 : lit) << 4);
+    if (lit >= 15) {
+        op = put_length(op, lit - 15);
+    }
+    memcpy(op, anchor, lit);
+    op += lit;
+    return (size_t)(op - dst);
+}
+
+// Decompress into exactly `out_n` bytes; returns -1 for malformed input
+static int lz_decompress(const uint8_t* src, size_t n, uint8_t* dst, size_t out_n) {
+    const uint8_t* ip = src;
+    const uint8_t* end = src + n;
+    uint8_t* op = dst;
+    uint8_t* oend = dst + out_n;
+
+    while (ip < end) {
+        unsigned token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15 && get_length(&ip, end, &lit) < 0) {
+            return -1;
+        }
+        if (lit > (size_t)(end - ip) || lit > (size_t)(oend - op)) {
+            return -1;
+        }
+        memcpy(op, ip, lit);
+        op += lit;
+        ip += lit;
+        if (ip == end) {
+            break;
+        }
+        if (end - ip < 2) {
+            return -1;
+        }
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t len = token & 15;
+        if (len == 15 && get_length(&ip, end, &len) < 0) {
+            return -1;
+        }
+        len += LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - dst) || len > (size_t)(oend - op)) {
+            return -1;
+        }
+        const uint8_t* ref = op - offset;
+        if (offset == 1) {
+            memset(op, *ref, len);
+        } else if (offset >= len) {
+            memcpy(op, ref, len);
+        } else {
+            // Overlapping match: repeats the last `offset` bytes
+            for (size_t k = 0; k < len; k++) {
+                op[k] = ref[k];
+            }
+        }
+        op += len;
+    }
+    return op == oend ? 0 : -1;
+}
+
+// XOR each value with its predecessor and split the results into byte planes
+static void shuffle_delta(const double* values, size_t n, uint8_t* planes) {
+    uint64_t prev = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t bits;
+        memcpy(&bits, &values[i], sizeof(bits));
+        uint64_t x = bits ^ prev;
+        prev = bits;
+        for (int b = 0; b < 8; b++) {
+            planes[(size_t)(7 - b) * n + i] = (uint8_t)(x >> (8 * b));
+        }
+    }
+}
+
+static void unshuffle_delta(const uint8_t* planes, size_t n, double* values) {
+    uint64_t prev = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t x = 0;
+        for (int b = 0; b < 8; b++) {
+            x |= (uint64_t)planes[(size_t)(7 - b) * n + i] << (8 * b);
+        }
+        prev ^= x;
+        memcpy(&values[i], &prev, sizeof(prev));
+    }
+}
+
+static size_t chunk_count(size_t count) {
+    return (count + FIELD_CODEC_CHUNK - 1) / FIELD_CODEC_CHUNK;
+}
+
+static size_t chunk_length(size_t count, size_t c) {
+    size_t first = c * FIELD_CODEC_CHUNK;
+    return count - first < FIELD_CODEC_CHUNK ? count - first : FIELD_CODEC_CHUNK;
+}
+
+// Work space and largest payload of one chunk: a code byte and a possible
+// outlier per value, behind the outlier count
+#define CHUNK_WORK (FIELD_CODEC_CHUNK * (1 + sizeof(double)))
+#define CHUNK_SLOT (sizeof(uint32_t) + CHUNK_WORK)
+
+size_t field_codec_bound(size_t count) {
+    return sizeof(field_codec_header) + chunk_count(count) * 2 * sizeof(uint32_t) +
+           count * (1 + sizeof(double));
+}
+
+/*
+ * Error-bounded quantization
+ *
+ * Each value is predicted by linear extrapolation from the two previous
+ * reconstructed values, and the prediction error is quantized in steps of
+ * the largest power of two not above twice the error bound. Power-of-two
+ * steps make q * step exact, so the decoder reconstructs bit-identical
+ * values whether or not the compiler fuses the multiply-add. A value whose
+ * quantized error needs more than 127 steps, or whose reconstruction
+ * misses the bound by rounding, is stored exactly as an outlier.
+ */
+typedef struct {
+    double bound;
+    double step;
+    double inv_step;
+} quantizer;
+
+#define LOSSY_ESCAPE 255
+
+static int quantizer_init(quantizer* q, double bound) {
+    if (!(bound > 0.0) || !isfinite(2.0 * bound)) {
+        return -1;
+    }
+    int e;
+    frexp(2.0 * bound, &e);
+    q->bound = bound;
+    q->step = ldexp(1.0, e - 1);
+    q->inv_step = 1.0 / q->step;
+    return 0;
+}
+
+static double predict(double r1, double r2, size_t i) {
+    return i >= 2 ? 2.0 * r1 - r2 : (i == 1 ? r1 : 0.0);
+}
+
+// Quantize `n` values into codes followed by outliers; returns the outlier count
+static size_t quantize(const quantizer* q, const double* values, size_t n, uint8_t* codes) {
+    uint8_t* outliers = codes + n;
+    double r1 = 0.0, r2 = 0.0;
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        double v = values[i];
+        double pred = predict(r1, r2, i);
+        double d = (v - pred) * q->inv_step;
+        double r = v;
+        uint8_t code = LOSSY_ESCAPE;
+        if (fabs(d) < 127.5) {
+            double steps = floor(d + 0.5);
+            double guess = pred + steps * q->step;
+            if (fabs(guess - v) <= q->bound) {
+                int s = (int)steps;
+                code = (uint8_t)(s >= 0 ? 2 * s : -2 * s - 1);
+                r = guess;
+            }
+        }
+        if (code == LOSSY_ESCAPE) {
+            memcpy(outliers + k * sizeof(double), &v, sizeof(v));
+            k++;
+        }
+        codes[i] = code;
+        r2 = r1;
+        r1 = r;
+    }
+    return k;
+}
+
+static int dequantize(const quantizer* q, const uint8_t* codes, size_t n, size_t k,
+                      double* values) {
+    const uint8_t* outliers = codes + n;
+    double r1 = 0.0, r2 = 0.0;
+    size_t used = 0;
+    for (size_t i = 0; i < n; i++) {
+        double r;
+        if (codes[i] == LOSSY_ESCAPE) {
+            if (used == k) {
+                return -1;
+            }
+            memcpy(&r, outliers + used * sizeof(double), sizeof(r));
+            used++;
+        } else {
+            int s = codes[i] & 1 ? -(int)(codes[i] >> 1) - 1 : (int)(codes[i] >> 1);
+            r = predict(r1, r2, i) + (double)s * q->step;
+        }
+        values[i] = r;
+        r2 = r1;
+        r1 = r;
+    }
+    return used == k ? 0 : -1;
+}
+
+// Encode one chunk into `dst`; returns its size table entry
+static uint32_t encode_chunk(const quantizer* q, const double* src, size_t n, uint8_t* work,
+                             uint8_t* dst) {
+    if (q == NULL) {
+        shuffle_delta(src, n, work);
+        size_t len = lz_compress(work, n * sizeof(double), dst, n * sizeof(double) - 1);
+        if (len > 0) {
+            return (uint32_t)len;
+        }
+        memcpy(dst, src, n * sizeof(double));
+        return (uint32_t)(n * sizeof(double)) | CHUNK_RAW;
+    }
+    uint32_t k = (uint32_t)quantize(q, src, n, work);
+    size_t total = n + k * sizeof(double);
+    memcpy(dst, &k, sizeof(k));
+    size_t len = lz_compress(work, total, dst + sizeof(k), total - 1);
+    if (len > 0) {
+        return (uint32_t)(sizeof(k) + len);
+    }
+    memcpy(dst + sizeof(k), work, total);
+    return (uint32_t)(sizeof(k) + total) | CHUNK_RAW;
+}
+
+// Decode one chunk of `len` bytes; returns -1 for malformed input
+static int decode_chunk(const quantizer* q, const uint8_t* src, size_t len, int raw, size_t n,
+                        uint8_t* work, double* dst) {
+    if (q == NULL) {
+        if (raw) {
+            if (len != n * sizeof(double)) {
+                return -1;
+            }
+            memcpy(dst, src, len);
+            return 0;
+        }
+        if (lz_decompress(src, len, work, n * sizeof(double)) < 0) {
+            return -1;
+        }
+        unshuffle_delta(work, n, dst);
+        return 0;
+    }
+    uint32_t k;
+    if (len < sizeof(k)) {
+        return -1;
+    }
+    memcpy(&k, src, sizeof(k));
+    if (k > n) {
+        return -1;
+    }
+    size_t total = n + (size_t)k * sizeof(double);
+    src += sizeof(k);
+    len -= sizeof(k);
+    if (raw) {
+        if (len != total) {
+            return -1;
+        }
+        memcpy(work, src, total);
+    } else if (lz_decompress(src, len, work, total) < 0) {
+        return -1;
+    }
+    return dequantize(q, work, n, k, dst);
+}
+
+double field_codec_relative_bound(const double* values, size_t count, double fraction) {
+    double lo = INFINITY, hi = -INFINITY;
+    for (size_t i = 0; i < count; i++) {
+        if (isfinite(values[i])) {
+            lo = values[i] < lo ? values[i] : lo;
+            hi = values[i] > hi ? values[i] : hi;
+        }
+    }
+    double bound = lo <= hi ? fraction * (hi - lo) : 0.0;
+    return isfinite(2.0 * bound) ? bound : 0.0;
+}
+
+int field_codec_encode(const double* values, size_t count, double max_error, void* out,
+                       size_t* size) {
+    quantizer q;
+    if (max_error != 0.0 && quantizer_init(&q, max_error) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    const quantizer* lossy = max_error != 0.0 ? &q : NULL;
+    size_t num_chunks = chunk_count(count);
+    field_codec_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FIELD_CODEC_MAGIC, sizeof(header.magic));
+    header.method = lossy != NULL ? FIELD_CODEC_LOSSY : FIELD_CODEC_LOSSLESS;
+    header.chunk_values = FIELD_CODEC_CHUNK;
+    header.num_chunks = (uint32_t)num_chunks;
+    header.count = count;
+    header.max_error = max_error;
+
+    uint8_t* base = (uint8_t*)out;
+    uint32_t* sizes = (uint32_t*)(base + sizeof(header));
+    uint8_t* payload = base + sizeof(header) + num_chunks * sizeof(uint32_t);
+    memcpy(base, &header, sizeof(header));
+    int failed = 0;
+
+    // Each chunk is encoded into its own full-size slot, then the slots are packed
+    #pragma omp parallel if (num_chunks > 1)
+    {
+        uint8_t* work = (uint8_t*)malloc(CHUNK_WORK);
+        if (work == NULL) {
+            #pragma omp critical
+            failed = 1;
+        }
+        #pragma omp for schedule(dynamic)
+        for (ptrdiff_t c = 0; c < (ptrdiff_t)num_chunks; c++) {
+            if (work == NULL) {
+                continue;
+            }
+            size_t n = chunk_length(count, (size_t)c);
+            sizes[c] = encode_chunk(lossy, values + (size_t)c * FIELD_CODEC_CHUNK, n, work,
+                                    payload + (size_t)c * CHUNK_SLOT);
+        }
+        free(work);
+    }
+    if (failed) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    // Every slot starts at or after the end of the packed data before it
+    uint8_t* op = payload;
+    for (size_t c = 0; c < num_chunks; c++) {
+        size_t len = sizes[c] & ~CHUNK_RAW;
+        memmove(op, payload + c * CHUNK_SLOT, len);
+        op += len;
+    }
+    *size = (size_t)(op - base);
+    return 0;
+}
+
+// Read and check the header; fills `header` on success
+static int read_header(const void* in, size_t size, field_codec_header* header) {
+    if (size < sizeof(*header)) {
+        errno = EINVAL;
+        return -1;
+    }
+    memcpy(header, in, sizeof(*header));
+    int method_ok = header->method == FIELD_CODEC_LOSSLESS ? header->max_error == 0.0
+                    : header->method == FIELD_CODEC_LOSSY &&
+                      header->max_error > 0.0 && isfinite(2.0 * header->max_error);
+    if (memcmp(header->magic, FIELD_CODEC_MAGIC, sizeof(header->magic)) != 0 || !method_ok ||
+        header->chunk_values != FIELD_CODEC_CHUNK ||
+        header->count > SIZE_MAX / sizeof(double) ||
+        header->num_chunks != chunk_count((size_t)header->count) ||
+        (size - sizeof(*header)) / sizeof(uint32_t) < header->num_chunks) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+int field_codec_info(const void* in, size_t size, size_t* count, double* max_error) {
+    field_codec_header header;
+    if (read_header(in, size, &header) < 0) {
+        return -1;
+    }
+    *count = (size_t)header.count;
+    if (max_error != NULL) {
+        *max_error = header.max_error;
+    }
+    return 0;
+}
+
+int field_codec_decode(const void* in, size_t size, double* values, size_t count) {
+    field_codec_header header;
+    if (read_header(in, size, &header) < 0) {
+        return -1;
+    }
+    if (header.count != count) {
+        errno = EINVAL;
+        return -1;
+    }
+    quantizer q;
+    const quantizer* lossy = NULL;
+    if (header.method == FIELD_CODEC_LOSSY) {
+        quantizer_init(&q, header.max_error);
+        lossy = &q;
+    }
+    size_t num_chunks = header.num_chunks;
+    const uint8_t* base = (const uint8_t*)in;
+    const uint8_t* table = base + sizeof(header);
+    size_t payload = sizeof(header) + num_chunks * sizeof(uint32_t);
+
+    // Chunk offsets from the size table, checked against the stream length
+    size_t* offsets = (size_t*)malloc((num_chunks > 0 ? num_chunks : 1) * sizeof(size_t));
+    if (offsets == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    size_t offset = payload;
+    for (size_t c = 0; c < num_chunks; c++) {
+        uint32_t entry;
+        memcpy(&entry, table + c * sizeof(uint32_t), sizeof(entry));
+        size_t len = entry & ~CHUNK_RAW;
+        if (len > size - offset) {
+            free(offsets);
+            errno = EINVAL;
+            return -1;
+        }
+        offsets[c] = offset;
+        offset += len;
+    }
+    int failed = 0;
+
+    #pragma omp parallel if (num_chunks > 1)
+    {
+        uint8_t* work = (uint8_t*)malloc(CHUNK_WORK);
+        if (work == NULL) {
+            #pragma omp critical
+            failed = ENOMEM;
+        }
+        #pragma omp for schedule(dynamic)
+        for (ptrdiff_t c = 0; c < (ptrdiff_t)num_chunks; c++) {
+            if (work == NULL) {
+                continue;
+            }
+            uint32_t entry;
+            memcpy(&entry, table + (size_t)c * sizeof(uint32_t), sizeof(entry));
+            if (decode_chunk(lossy, base + offsets[c], entry & ~CHUNK_RAW,
+                             (entry & CHUNK_RAW) != 0, chunk_length(count, (size_t)c), work,
+                             values + (size_t)c * FIELD_CODEC_CHUNK) < 0) {
+                #pragma omp critical
+                failed = EINVAL;
+            }
+        }
+        free(work);
+    }
+    free(offsets);
+    if (failed) {
+        errno = failed;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+/*
+ * Float64 field compression
+ *
+ * A dependency-free codec for simulation fields with a lossless and an
+ * error-bounded lossy method. Values are split into fixed-size chunks that
+ * are encoded and decoded independently on all OpenMP threads.
+ *
+ * Lossless: within a chunk every value is XORed with its predecessor, so
+ * the sign, exponent and leading mantissa bits that neighbouring values
+ * share become zero bytes. The XORed values are then byte-shuffled into
+ * eight planes, most significant byte first, which turns those zero bytes
+ * into long runs, and the planes are compressed with a small LZ77 coder
+ * (LZ4-style sequences, 64 KiB window). A chunk that does not shrink is
+ * stored raw, so the output is never more than a few bytes per chunk
+ * larger than the input.
+ *
+ * Lossy: every value is predicted from the two values before it as the
+ * decoder will see them, and the prediction error is quantized to one
+ * byte, so the reconstruction differs from the input by at most the
+ * stored error bound. Values the byte cannot reach (including NaN and
+ * infinities) are kept exactly as outliers. The codes and outliers go
+ * through the same LZ77 coder. In the spirit of SZ, without its entropy
+ * stage.
+ *
+ * Stream layout (native byte order):
+ *   [field_codec_header][uint32 chunk size x num_chunks][chunk payloads]
+ *
+ * Bit 31 of a chunk size marks a chunk whose payload skipped the LZ77
+ * stage. Lossy payloads are [uint32 outliers][codes][outlier doubles].
+ */
+
+#ifndef CFD_PYTHON_FIELD_CODEC_H
+#define CFD_PYTHON_FIELD_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FIELD_CODEC_MAGIC "CFZ1"
+#define FIELD_CODEC_CHUNK 16384  // Values per chunk (128 KiB of doubles)
+
+// Encoding methods stored in the header
+#define FIELD_CODEC_LOSSLESS 1
+#define FIELD_CODEC_LOSSY 2
+
+typedef struct {
+    char magic[4];
+    uint8_t method;
+    uint8_t reserved[3];
+    uint32_t chunk_values;
+    uint32_t num_chunks;
+    uint64_t count;     // Values in the field
+    double max_error;   // Absolute error bound of a lossy stream, 0 if lossless
+} field_codec_header;
+
+// Largest encoded size of `count` values
+size_t field_codec_bound(size_t count);
+
+/*
+ * Encode `count` values into `out`, which must hold field_codec_bound(count)
+ * bytes, and store the encoded size in `size`. A `max_error` of 0 selects
+ * the lossless method; a positive finite one the lossy method, where every
+ * decoded value is within `max_error` of its input. Returns 0, or -1 with
+ * errno = EINVAL for any other `max_error` or ENOMEM.
+ */
+int field_codec_encode(const double* values, size_t count, double max_error, void* out,
+                       size_t* size);
+
+/*
+ * Absolute error bound for `fraction` of the range of the finite values,
+ * or 0 (lossless) when that range is empty, zero or too large
+ */
+double field_codec_relative_bound(const double* values, size_t count, double fraction);
+
+/*
+ * Validate the header of an encoded stream of `size` bytes and store the
+ * number of values it holds in `count` and, unless NULL, its error bound
+ * in `max_error`. Returns 0, or -1 with errno = EINVAL.
+ */
+int field_codec_info(const void* in, size_t size, size_t* count, double* max_error);
+
+/*
+ * Decode a stream holding exactly `count` values into `values`. Returns 0,
+ * or -1 with errno = EINVAL for a malformed stream or ENOMEM.
+ */
+int field_codec_decode(const void* in, size_t size, double* values, size_t count);
+
+#endif  // CFD_PYTHON_FIELD_CODEC_H
@@ -0,0 +1,87 @@
+/*
+ * Field comparison and error norms
+ */
+
+#include "field_compare.h"
+
+#include <math.h>
+#include <string.h>
+
+/*
+ * Map a double's bit pattern onto integers that are ordered like the
+ * values, with -0.0 and 0.0 both mapping to 0
+ */
+static int64_t ordered_bits(double x) {
+    int64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return bits < 0 ? INT64_MIN - bits : bits;
+}
+
+uint64_t double_ulp_distance(double a, double b) {
+    int64_t ia = ordered_bits(a);
+    int64_t ib = ordered_bits(b);
+    return ia > ib ? (uint64_t)ia - (uint64_t)ib : (uint64_t)ib - (uint64_t)ia;
+}
+
+void field_compare(const double* a, const double* b, size_t n, field_comparison* out) {
+    memset(out, 0, sizeof(*out));
+    out->linf_index = n;
+    ptrdiff_t count = (ptrdiff_t)n;
+
+    #pragma omp parallel
+    {
+        field_comparison local;
+        memset(&local, 0, sizeof(local));
+        local.linf_index = n;
+
+        #pragma omp for schedule(static)
+        for (ptrdiff_t i = 0; i < count; i++) {
+            double x = a[i];
+            double y = b[i];
+            int x_nan = x != x;
+            int y_nan = y != y;
+            if (x_nan || y_nan) {
+                local.nan_mismatch += x_nan != y_nan;
+                continue;
+            }
+            // Equal infinities differ by 0, not inf - inf
+            double err = x == y ? 0.0 : fabs(x - y);
+            double ref = fabs(y);
+            uint64_t ulp = double_ulp_distance(x, y);
+            local.count++;
+            local.exact += ulp == 0;
+            local.l1 += err;
+            local.l2_sq += err * err;
+            local.ref_l1 += ref;
+            local.ref_l2_sq += ref * ref;
+            local.ulp_sum += (double)ulp;
+            if (err > local.linf || local.linf_index == n) {
+                local.linf = err;
+                local.linf_index = (size_t)i;
+            }
+            local.ref_linf = ref > local.ref_linf ? ref : local.ref_linf;
+            local.max_ulp = ulp > local.max_ulp ? ulp : local.max_ulp;
+        }
+
+        #pragma omp critical
+        {
+            out->count += local.count;
+            out->nan_mismatch += local.nan_mismatch;
+            out->exact += local.exact;
+            out->l1 += local.l1;
+            out->l2_sq += local.l2_sq;
+            out->ref_l1 += local.ref_l1;
+            out->ref_l2_sq += local.ref_l2_sq;
+            out->ulp_sum += local.ulp_sum;
+            // Ties go to the lowest index so the result is deterministic
+            if (local.linf_index < n &&
+                (out->linf_index == n || local.linf > out->linf ||
+                 (local.linf == out->linf && local.linf_index < out->linf_index))) {
+                out->linf = local.linf;
+                out->linf_index = local.linf_index;
+            }
+            out->ref_linf = local.ref_linf > out->ref_linf ? local.ref_linf : out->ref_linf;
+            out->max_ulp = local.max_ulp > out->max_ulp ? local.max_ulp : out->max_ulp;
+        }
+    }
+}
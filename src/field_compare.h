@@ -0,0 +1,37 @@
+/*
+ * Field comparison and error norms
+ *
+ * One OpenMP-parallel pass over two equally sized arrays accumulates the
+ * absolute error norms, the reference norms needed for relative errors,
+ * the location of the largest error and the distance in units in the last
+ * place (ULPs) between corresponding values.
+ */
+
+#ifndef CFD_PYTHON_FIELD_COMPARE_H
+#define CFD_PYTHON_FIELD_COMPARE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    size_t count;         // Pairs compared (both values non-NaN)
+    size_t nan_mismatch;  // Pairs where exactly one value is NaN
+    size_t exact;         // Bitwise-equal pairs (0.0 and -0.0 count as equal)
+    double l1;            // sum |a - b|
+    double l2_sq;         // sum (a - b)^2
+    double linf;          // max |a - b|
+    size_t linf_index;    // Lowest index attaining linf
+    double ref_l1;        // Norms of the reference b
+    double ref_l2_sq;
+    double ref_linf;
+    uint64_t max_ulp;
+    double ulp_sum;
+} field_comparison;
+
+// Compare `a` against the reference `b`
+void field_compare(const double* a, const double* b, size_t n, field_comparison* out);
+
+// Distance in ULPs between two non-NaN doubles (adjacent doubles are 1 apart)
+uint64_t double_ulp_distance(double a, double b);
+
+#endif  // CFD_PYTHON_FIELD_COMPARE_H
@@ -0,0 +1,85 @@
+/*
+ * Field restriction and region-of-interest extraction
+ */
+
+#include "field_resample.h"
+
+#include <string.h>
+
+static size_t out_extent(size_t begin, size_t end, size_t factor) {
+    return (end - begin + factor - 1) / factor;
+}
+
+cfd_status_t resample_plan_check(const resample_plan* plan, size_t nx, size_t ny) {
+    if (plan->fx == 0 || plan->fy == 0 || plan->i0 >= plan->i1 || plan->j0 >= plan->j1 ||
+        plan->i1 > nx || plan->j1 > ny) {
+        return CFD_ERROR_INVALID;
+    }
+    return CFD_SUCCESS;
+}
+
+size_t resample_out_nx(const resample_plan* plan) {
+    return out_extent(plan->i0, plan->i1, plan->fx);
+}
+
+size_t resample_out_ny(const resample_plan* plan) {
+    return out_extent(plan->j0, plan->j1, plan->fy);
+}
+
+void resample_field(const double* src, size_t nx, const resample_plan* plan, double* dst) {
+    size_t mx = resample_out_nx(plan);
+    ptrdiff_t my = (ptrdiff_t)resample_out_ny(plan);
+    size_t fx = plan->fx;
+    size_t fy = plan->fy;
+
+    #pragma omp parallel for schedule(static)
+    for (ptrdiff_t oj = 0; oj < my; oj++) {
+        size_t j = plan->j0 + (size_t)oj * fy;
+        double* out = dst + (size_t)oj * mx;
+        const double* row = src + j * nx + plan->i0;
+
+        if (plan->mode == RESAMPLE_INJECT) {
+            if (fx == 1) {
+                memcpy(out, row, mx * sizeof(double));
+            } else {
+                for (size_t oi = 0; oi < mx; oi++) {
+                    out[oi] = row[oi * fx];
+                }
+            }
+            continue;
+        }
+
+        // Mean of each rows x cols block; blocks at the far edges may be partial
+        size_t rows = j + fy <= plan->j1 ? fy : plan->j1 - j;
+        size_t width = plan->i1 - plan->i0;
+        for (size_t oi = 0; oi < mx; oi++) {
+            size_t cols = (oi + 1) * fx <= width ? fx : width - oi * fx;
+            double sum = 0.0;
+            for (size_t r = 0; r < rows; r++) {
+                const double* block = row + r * nx + oi * fx;
+                for (size_t c = 0; c < cols; c++) {
+                    sum += block[c];
+                }
+            }
+            out[oi] = sum / (double)(rows * cols);
+        }
+    }
+}
+
+void resample_axis(const double* coords, size_t begin, size_t end, size_t factor,
+                   resample_mode mode, double* dst) {
+    size_t m = out_extent(begin, end, factor);
+    for (size_t o = 0; o < m; o++) {
+        size_t first = begin + o * factor;
+        if (mode == RESAMPLE_INJECT) {
+            dst[o] = coords[first];
+            continue;
+        }
+        size_t last = first + factor < end ? first + factor : end;
+        double sum = 0.0;
+        for (size_t k = first; k < last; k++) {
+            sum += coords[k];
+        }
+        dst[o] = sum / (double)(last - first);
+    }
+}
@@ -0,0 +1,48 @@
+/*
+ * Field restriction and region-of-interest extraction
+ *
+ * One kernel covers both: an index-space window [i0, i1) x [j0, j1) of a
+ * row-major field is reduced by integer factors (fx, fy), either by
+ * injection (every fx-th/fy-th node, starting at the window corner) or by
+ * averaging each fx x fy block. A factor of 1 is a plain ROI copy. The
+ * output has ceil(width / fx) x ceil(height / fy) points in both modes;
+ * blocks at the far edges may be partial.
+ */
+
+#ifndef CFD_PYTHON_FIELD_RESAMPLE_H
+#define CFD_PYTHON_FIELD_RESAMPLE_H
+
+#include <stddef.h>
+
+#include "cfd/core/cfd_status.h"
+
+typedef enum {
+    RESAMPLE_INJECT = 0,
+    RESAMPLE_AVERAGE
+} resample_mode;
+
+typedef struct {
+    size_t i0, i1;  // Column window, end exclusive
+    size_t j0, j1;  // Row window, end exclusive
+    size_t fx, fy;  // Reduction factors (>= 1)
+    resample_mode mode;
+} resample_plan;
+
+// CFD_ERROR_INVALID unless the window is non-empty, inside nx x ny and the factors are >= 1
+cfd_status_t resample_plan_check(const resample_plan* plan, size_t nx, size_t ny);
+
+// Output points in x and y
+size_t resample_out_nx(const resample_plan* plan);
+size_t resample_out_ny(const resample_plan* plan);
+
+// Resample a row-major field of row length nx into dst
+void resample_field(const double* src, size_t nx, const resample_plan* plan, double* dst);
+
+/*
+ * Coordinates of the output points along one axis: the injected node
+ * coordinates, or the mean coordinate of each block when averaging
+ */
+void resample_axis(const double* coords, size_t begin, size_t end, size_t factor,
+                   resample_mode mode, double* dst);
+
+#endif  // CFD_PYTHON_FIELD_RESAMPLE_H
@@ -0,0 +1,40 @@
+/*
+ * Flow-field state copies
+ */
+
+#include "field_state.h"
+
+#include <string.h>
+
+// Doubles per copy chunk (512 KiB); small copies stay on one thread
+#define COPY_CHUNK ((size_t)1 << 16)
+
+void copy_doubles_parallel(double* dst, const double* src, size_t count) {
+    if (dst == NULL || src == NULL || count == 0) {
+        return;
+    }
+    int nchunks = (int)((count + COPY_CHUNK - 1) / COPY_CHUNK);
+
+    #pragma omp parallel for schedule(static) if (nchunks > 1)
+    for (int c = 0; c < nchunks; c++) {
+        size_t start = (size_t)c * COPY_CHUNK;
+        size_t len = count - start < COPY_CHUNK ? count - start : COPY_CHUNK;
+        memcpy(dst + start, src + start, len * sizeof(double));
+    }
+}
+
+cfd_status_t flow_field_copy_parallel(flow_field* dst, const flow_field* src) {
+    if (dst == NULL || src == NULL ||
+        dst->nx != src->nx || dst->ny != src->ny || dst->nz != src->nz) {
+        return CFD_ERROR_INVALID;
+    }
+    size_t count = src->nx * src->ny * src->nz;
+
+    copy_doubles_parallel(dst->u, src->u, count);
+    copy_doubles_parallel(dst->v, src->v, count);
+    copy_doubles_parallel(dst->w, src->w, count);
+    copy_doubles_parallel(dst->p, src->p, count);
+    copy_doubles_parallel(dst->rho, src->rho, count);
+    copy_doubles_parallel(dst->T, src->T, count);
+    return CFD_SUCCESS;
+}
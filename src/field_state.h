@@ -0,0 +1,22 @@
+/*
+ * Flow-field state copies
+ *
+ * Chunked, OpenMP-parallel copies of flow_field arrays. Used to clone
+ * simulations and to save and restore solver states.
+ */
+
+#ifndef CFD_PYTHON_FIELD_STATE_H
+#define CFD_PYTHON_FIELD_STATE_H
+
+#include <stddef.h>
+
+#include "cfd/core/cfd_status.h"
+#include "cfd/solvers/navier_stokes_solver.h"
+
+// Copy `count` doubles, splitting large copies across OpenMP threads
+void copy_doubles_parallel(double* dst, const double* src, size_t count);
+
+// Copy every allocated array of `src` into `dst` (dimensions must match)
+cfd_status_t flow_field_copy_parallel(flow_field* dst, const flow_field* src);
+
+#endif  // CFD_PYTHON_FIELD_STATE_H
@@ -0,0 +1,255 @@
+/*
+ * Single-pass field statistics
+ */
+
+#include "field_stats.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Values per block: 32 KiB of doubles, reduced while it sits in L1/L2
+#define STATS_BLOCK 4096
+
+static void moments_empty(field_moments* m) {
+    memset(m, 0, sizeof(*m));
+    m->min = INFINITY;
+    m->max = -INFINITY;
+}
+
+/*
+ * Reduce one block. The fast path assumes all values are finite and keeps
+ * every loop free of branches; a non-finite block sum sends the block to
+ * the slow path, which skips and counts NaN/Inf values.
+ */
+static void moments_block(const double* x, size_t n, field_moments* m) {
+    moments_empty(m);
+
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sum += x[i];
+    }
+
+    if (isfinite(sum)) {
+        double mean = sum / (double)n;
+        double m2 = 0.0, abs_sum = 0.0, sum_sq = 0.0;
+        double lo = x[0], hi = x[0];
+        for (size_t i = 0; i < n; i++) {
+            double d = x[i] - mean;
+            m2 += d * d;
+            abs_sum += fabs(x[i]);
+            sum_sq += x[i] * x[i];
+            lo = x[i] < lo ? x[i] : lo;
+            hi = x[i] > hi ? x[i] : hi;
+        }
+        m->count = n;
+        m->sum = sum;
+        m->mean = mean;
+        m->m2 = m2;
+        m->abs_sum = abs_sum;
+        m->sum_sq = sum_sq;
+        m->min = lo;
+        m->max = hi;
+        m->max_abs = fabs(lo) > fabs(hi) ? fabs(lo) : fabs(hi);
+        return;
+    }
+
+    // Slow path: Welford over the finite values only
+    for (size_t i = 0; i < n; i++) {
+        double v = x[i];
+        if (isnan(v)) {
+            m->nan_count++;
+            continue;
+        }
+        if (isinf(v)) {
+            m->inf_count++;
+            continue;
+        }
+        m->count++;
+        double d = v - m->mean;
+        m->mean += d / (double)m->count;
+        m->m2 += d * (v - m->mean);
+        m->sum += v;
+        m->abs_sum += fabs(v);
+        m->sum_sq += v * v;
+        m->min = v < m->min ? v : m->min;
+        m->max = v > m->max ? v : m->max;
+        m->max_abs = fabs(v) > m->max_abs ? fabs(v) : m->max_abs;
+    }
+}
+
+// Chan et al. parallel update: fold `b` into `a`
+static void moments_merge(field_moments* a, const field_moments* b) {
+    a->nan_count += b->nan_count;
+    a->inf_count += b->inf_count;
+    if (b->count == 0) {
+        return;
+    }
+    if (a->count == 0) {
+        size_t nan_count = a->nan_count, inf_count = a->inf_count;
+        *a = *b;
+        a->nan_count = nan_count;
+        a->inf_count = inf_count;
+        return;
+    }
+    double na = (double)a->count, nb = (double)b->count, n = na + nb;
+    double delta = b->mean - a->mean;
+    a->mean += delta * nb / n;
+    a->m2 += b->m2 + delta * delta * na * nb / n;
+    a->count += b->count;
+    a->sum += b->sum;
+    a->abs_sum += b->abs_sum;
+    a->sum_sq += b->sum_sq;
+    a->min = b->min < a->min ? b->min : a->min;
+    a->max = b->max > a->max ? b->max : a->max;
+    a->max_abs = b->max_abs > a->max_abs ? b->max_abs : a->max_abs;
+}
+
+static void histogram_block(const double* x, size_t n, const field_histogram* hist,
+                            uint64_t* counts, uint64_t* below, uint64_t* above) {
+    double scale = (double)hist->bins / (hist->hi - hist->lo);
+    for (size_t i = 0; i < n; i++) {
+        double v = x[i];
+        if (!(v >= hist->lo)) {
+            *below += v < hist->lo;  // NaN is neither below nor above
+            continue;
+        }
+        if (v > hist->hi) {
+            (*above)++;
+            continue;
+        }
+        size_t bin = (size_t)((v - hist->lo) * scale);
+        counts[bin < hist->bins ? bin : hist->bins - 1]++;
+    }
+}
+
+/*
+ * Shared driver: blocks are reduced in parallel into `partials` (when
+ * moments are wanted) and into per-thread histogram counts, which are summed
+ * at the end. Integer counts make the merge order irrelevant.
+ */
+static cfd_status_t stats_pass(const double* data, size_t count, field_moments* moments,
+                               field_histogram* histograms, int num_histograms) {
+    ptrdiff_t nblocks = (ptrdiff_t)((count + STATS_BLOCK - 1) / STATS_BLOCK);
+    field_moments* partials = NULL;
+    size_t total_bins = 0;
+    int failed = 0;
+
+    for (int h = 0; h < num_histograms; h++) {
+        if (histograms[h].bins == 0 || !(histograms[h].hi > histograms[h].lo)) {
+            return CFD_ERROR_INVALID;
+        }
+        total_bins += histograms[h].bins;
+    }
+    if (moments != NULL) {
+        partials = (field_moments*)malloc((size_t)(nblocks > 0 ? nblocks : 1) * sizeof(field_moments));
+        if (partials == NULL) {
+            return CFD_ERROR_NOMEM;
+        }
+    }
+
+    #pragma omp parallel
+    {
+        // Per-thread counts: [bins..., below, above] for each histogram
+        uint64_t* local = NULL;
+        if (num_histograms > 0) {
+            local = (uint64_t*)calloc(total_bins + 2 * (size_t)num_histograms, sizeof(uint64_t));
+            if (local == NULL) {
+                #pragma omp critical
+                failed = 1;
+            }
+        }
+
+        #pragma omp for schedule(static)
+        for (ptrdiff_t b = 0; b < nblocks; b++) {
+            size_t start = (size_t)b * STATS_BLOCK;
+            size_t n = count - start < STATS_BLOCK ? count - start : STATS_BLOCK;
+            if (partials != NULL) {
+                moments_block(data + start, n, &partials[b]);
+            }
+            if (local != NULL) {
+                uint64_t* slot = local;
+                for (int h = 0; h < num_histograms; h++) {
+                    histogram_block(data + start, n, &histograms[h], slot,
+                                    slot + histograms[h].bins, slot + histograms[h].bins + 1);
+                    slot += histograms[h].bins + 2;
+                }
+            }
+        }
+
+        if (local != NULL) {
+            #pragma omp critical
+            {
+                uint64_t* slot = local;
+                for (int h = 0; h < num_histograms; h++) {
+                    for (size_t i = 0; i < histograms[h].bins; i++) {
+                        histograms[h].counts[i] += slot[i];
+                    }
+                    histograms[h].below += slot[histograms[h].bins];
+                    histograms[h].above += slot[histograms[h].bins + 1];
+                    slot += histograms[h].bins + 2;
+                }
+            }
+            free(local);
+        }
+    }
+
+    if (failed) {
+        free(partials);
+        return CFD_ERROR_NOMEM;
+    }
+    if (partials != NULL) {
+        // Pairwise tree merge keeps rounding error at O(log n) block merges
+        for (ptrdiff_t stride = 1; stride < nblocks; stride *= 2) {
+            for (ptrdiff_t b = 0; b + stride < nblocks; b += 2 * stride) {
+                moments_merge(&partials[b], &partials[b + stride]);
+            }
+        }
+        if (nblocks > 0) {
+            *moments = partials[0];
+        } else {
+            moments_empty(moments);
+        }
+        free(partials);
+    }
+    return CFD_SUCCESS;
+}
+
+cfd_status_t field_stats_compute(const double* data, size_t count, field_moments* moments,
+                                 field_histogram* histograms, int num_histograms) {
+    return stats_pass(data, count, moments, histograms, num_histograms);
+}
+
+cfd_status_t field_stats_histogram(const double* data, size_t count,
+                                   field_histogram* histograms, int num_histograms) {
+    return stats_pass(data, count, NULL, histograms, num_histograms);
+}
+
+double field_histogram_percentile(const field_histogram* hist, const field_moments* moments,
+                                  double q) {
+    if (moments->count == 0) {
+        return NAN;
+    }
+    if (q <= 0.0) {
+        return moments->min;
+    }
+    if (q >= 100.0) {
+        return moments->max;
+    }
+
+    // Rank among the finite values, then locate its bin. The histogram spans
+    // [min, max], so `below`/`above` only hold infinities and are skipped
+    double rank = q / 100.0 * (double)moments->count;
+    double seen = 0.0;
+    double width = (hist->hi - hist->lo) / (double)hist->bins;
+    for (size_t i = 0; i < hist->bins; i++) {
+        double c = (double)hist->counts[i];
+        if (c > 0.0 && seen + c >= rank) {
+            double value = hist->lo + width * ((double)i + (rank - seen) / c);
+            value = value < moments->min ? moments->min : value;
+            return value > moments->max ? moments->max : value;
+        }
+        seen += c;
+    }
+    return moments->max;
+}
@@ -0,0 +1,58 @@
+/*
+ * Single-pass field statistics
+ *
+ * Moments, norms and non-finite counts of a double array computed in one
+ * OpenMP-parallel pass. Each cache-sized block is reduced in registers and
+ * blocks are merged pairwise with Chan's update, so mean and variance stay
+ * accurate on fields with tens of millions of cells and the result does not
+ * depend on the thread count. Histograms are accumulated in the same pass
+ * when their range is known up front.
+ */
+
+#ifndef CFD_PYTHON_FIELD_STATS_H
+#define CFD_PYTHON_FIELD_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cfd/core/cfd_status.h"
+
+// Statistics over the finite values of a field
+typedef struct {
+    size_t count;      // Finite values
+    size_t nan_count;
+    size_t inf_count;
+    double min, max;
+    double sum;
+    double mean;
+    double m2;         // Sum of squared deviations from the mean
+    double abs_sum;    // L1 norm
+    double sum_sq;     // Squared L2 norm
+    double max_abs;    // Linf norm
+} field_moments;
+
+// Equal-width histogram over [lo, hi]; values outside are counted separately
+typedef struct {
+    double lo, hi;
+    size_t bins;
+    uint64_t* counts;  // `bins` entries, zeroed by the caller
+    uint64_t below, above;
+} field_histogram;
+
+/*
+ * Compute moments of `data` and fill `histograms` (may be NULL when
+ * `num_histograms` is 0) in one pass. Histogram ranges must be set.
+ */
+cfd_status_t field_stats_compute(const double* data, size_t count, field_moments* moments,
+                                 field_histogram* histograms, int num_histograms);
+
+// Accumulate finite values of `data` into histograms whose range is now known
+cfd_status_t field_stats_histogram(const double* data, size_t count,
+                                   field_histogram* histograms, int num_histograms);
+
+// Approximate percentile q (0..100) from a histogram over [min, max] by
+// linear interpolation inside the bin holding the rank
+double field_histogram_percentile(const field_histogram* hist, const field_moments* moments,
+                                  double q);
+
+#endif  // CFD_PYTHON_FIELD_STATS_H
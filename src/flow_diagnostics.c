@@ -0,0 +1,150 @@
+/*
+ * Per-step integral diagnostics
+ */
+
+#include "flow_diagnostics.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "derived_kernels.h"
+
+static const char* const diagnostic_names[DIAG_NUM_COLUMNS] = {
+    "time", "step", "kinetic_energy", "enstrophy",
+    "flux_left", "flux_right", "flux_bottom", "flux_top", "max_divergence",
+};
+
+// Trapezoidal weights: half the distance between the neighbours of each node
+static void trapezoid_weights(const double* x, size_t n, double* q) {
+    q[0] = 0.5 * (x[1] - x[0]);
+    for (size_t i = 1; i + 1 < n; i++) {
+        q[i] = 0.5 * (x[i + 1] - x[i - 1]);
+    }
+    q[n - 1] = 0.5 * (x[n - 1] - x[n - 2]);
+}
+
+cfd_status_t flow_diagnostics_init(flow_diagnostics* diag, const grid* g,
+                                   size_t interval, size_t max_samples) {
+    memset(diag, 0, sizeof(*diag));
+    if (g->nx < 3 || g->ny < 3 || interval == 0) {
+        return CFD_ERROR_INVALID;
+    }
+    size_t nx = g->nx;
+    size_t ny = g->ny;
+    diag->dx_w = (double*)malloc(4 * (nx + ny) * sizeof(double));
+    if (diag->dx_w == NULL) {
+        return CFD_ERROR_NOMEM;
+    }
+    diag->dy_w = diag->dx_w + 3 * nx;
+    diag->qx = diag->dy_w + 3 * ny;
+    diag->qy = diag->qx + nx;
+    if (fd_derivative_weights(g->x, nx, diag->dx_w) < 0 ||
+        fd_derivative_weights(g->y, ny, diag->dy_w) < 0) {
+        flow_diagnostics_free(diag);
+        return CFD_ERROR_INVALID;
+    }
+    trapezoid_weights(g->x, nx, diag->qx);
+    trapezoid_weights(g->y, ny, diag->qy);
+
+    diag->nx = nx;
+    diag->ny = ny;
+    diag->interval = interval;
+    sample_store_init(&diag->samples, DIAG_NUM_COLUMNS, max_samples);
+    return CFD_SUCCESS;
+}
+
+void flow_diagnostics_free(flow_diagnostics* diag) {
+    free(diag->dx_w);
+    sample_store_free(&diag->samples);
+    memset(diag, 0, sizeof(*diag));
+}
+
+void flow_diagnostics_compute(const flow_diagnostics* diag, const flow_field* field, double* out) {
+    const double* u = field->u;
+    const double* v = field->v;
+    const double* wx = diag->dx_w;
+    const double* wy = diag->dy_w;
+    const double* qx = diag->qx;
+    const double* qy = diag->qy;
+    size_t nx = diag->nx;
+    ptrdiff_t ny = (ptrdiff_t)diag->ny;
+    double energy = 0.0;
+    double enstrophy = 0.0;
+    double max_div = 0.0;
+
+    #pragma omp parallel
+    {
+        double local_max = 0.0;
+
+        #pragma omp for schedule(static) reduction(+:energy, enstrophy)
+        for (ptrdiff_t j = 0; j < ny; j++) {
+            size_t ja = fd_stencil_start((size_t)j, (size_t)ny);
+            size_t r0 = (size_t)j * nx;
+            size_t ra = ja * nx, rb = ra + nx, rc = rb + nx;
+            double cya = wy[3 * j], cyb = wy[3 * j + 1], cyc = wy[3 * j + 2];
+            double row_energy = 0.0;
+            double row_enstrophy = 0.0;
+
+            for (size_t i = 0; i < nx; i++) {
+                size_t xa = r0 + fd_stencil_start(i, nx);
+                double cxa = wx[3 * i], cxb = wx[3 * i + 1], cxc = wx[3 * i + 2];
+                double dudx = cxa * u[xa] + cxb * u[xa + 1] + cxc * u[xa + 2];
+                double dvdx = cxa * v[xa] + cxb * v[xa + 1] + cxc * v[xa + 2];
+                double dudy = cya * u[ra + i] + cyb * u[rb + i] + cyc * u[rc + i];
+                double dvdy = cya * v[ra + i] + cyb * v[rb + i] + cyc * v[rc + i];
+                double w = dvdx - dudy;
+                double div = fabs(dudx + dvdy);
+                size_t k = r0 + i;
+                row_energy += qx[i] * (u[k] * u[k] + v[k] * v[k]);
+                row_enstrophy += qx[i] * w * w;
+                local_max = div > local_max ? div : local_max;
+            }
+            energy += qy[j] * row_energy;
+            enstrophy += qy[j] * row_enstrophy;
+        }
+
+        #pragma omp critical
+        {
+            if (local_max > max_div) {
+                max_div = local_max;
+            }
+        }
+    }
+
+    // Edge fluxes are O(nx + ny); integrate the normal velocity outward
+    double left = 0.0, right = 0.0, bottom = 0.0, top = 0.0;
+    size_t last_row = (size_t)(ny - 1) * nx;
+    for (ptrdiff_t j = 0; j < ny; j++) {
+        left -= qy[j] * u[(size_t)j * nx];
+        right += qy[j] * u[(size_t)j * nx + nx - 1];
+    }
+    for (size_t i = 0; i < nx; i++) {
+        bottom -= qx[i] * v[i];
+        top += qx[i] * v[last_row + i];
+    }
+
+    out[DIAG_KINETIC_ENERGY] = 0.5 * energy;
+    out[DIAG_ENSTROPHY] = 0.5 * enstrophy;
+    out[DIAG_FLUX_LEFT] = left;
+    out[DIAG_FLUX_RIGHT] = right;
+    out[DIAG_FLUX_BOTTOM] = bottom;
+    out[DIAG_FLUX_TOP] = top;
+    out[DIAG_MAX_DIVERGENCE] = max_div;
+}
+
+cfd_status_t flow_diagnostics_record(flow_diagnostics* diag, const flow_field* field,
+                                     size_t step, double time) {
+    double* row = sample_store_append(&diag->samples);
+    if (row == NULL) {
+        return CFD_ERROR_NOMEM;
+    }
+    row[DIAG_TIME] = time;
+    row[DIAG_STEP] = (double)step;
+    flow_diagnostics_compute(diag, field, row);
+    return CFD_SUCCESS;
+}
+
+const char* flow_diagnostics_name(diagnostic_column column) {
+    return diagnostic_names[column];
+}
@@ -0,0 +1,66 @@
+/*
+ * Per-step integral diagnostics
+ *
+ * Global scalars of a flow field computed in one fused OpenMP reduction:
+ * kinetic energy, enstrophy, outward mass flux through each boundary edge
+ * and the peak |divergence|. Integrals use trapezoidal node weights from
+ * the grid coordinates, so stretched grids are integrated correctly, and
+ * derivatives use the three-point stencils of derived_kernels.
+ *
+ * Samples are stored as rows of DIAG_NUM_COLUMNS doubles in a sample_store.
+ */
+
+#ifndef CFD_PYTHON_FLOW_DIAGNOSTICS_H
+#define CFD_PYTHON_FLOW_DIAGNOSTICS_H
+
+#include <stddef.h>
+
+#include "cfd/core/cfd_status.h"
+#include "cfd/core/grid.h"
+#include "cfd/solvers/navier_stokes_solver.h"
+
+#include "sample_store.h"
+
+typedef enum {
+    DIAG_TIME = 0,
+    DIAG_STEP,
+    DIAG_KINETIC_ENERGY,  // 1/2 * integral of (u^2 + v^2)
+    DIAG_ENSTROPHY,       // 1/2 * integral of vorticity^2
+    DIAG_FLUX_LEFT,       // Outward mass flux per edge (positive = outflow)
+    DIAG_FLUX_RIGHT,
+    DIAG_FLUX_BOTTOM,
+    DIAG_FLUX_TOP,
+    DIAG_MAX_DIVERGENCE,  // max |du/dx + dv/dy|
+    DIAG_NUM_COLUMNS
+} diagnostic_column;
+
+typedef struct {
+    size_t nx, ny;
+    size_t interval;  // Record every `interval` steps
+    double* dx_w;     // Derivative weights, 3 per x node
+    double* dy_w;     // Derivative weights, 3 per y node
+    double* qx;       // Trapezoidal quadrature weights per x node
+    double* qy;       // Trapezoidal quadrature weights per y node
+    sample_store samples;
+} flow_diagnostics;
+
+/*
+ * Precompute weights for the grid. `max_samples` > 0 keeps only the newest
+ * rows. Returns CFD_ERROR_INVALID for grids smaller than 3x3 or
+ * non-increasing coordinates.
+ */
+cfd_status_t flow_diagnostics_init(flow_diagnostics* diag, const grid* g,
+                                   size_t interval, size_t max_samples);
+void flow_diagnostics_free(flow_diagnostics* diag);
+
+// Compute all diagnostics of `field` into out[DIAG_KINETIC_ENERGY..]
+void flow_diagnostics_compute(const flow_diagnostics* diag, const flow_field* field, double* out);
+
+// Append one row; CFD_ERROR_NOMEM if the store cannot grow
+cfd_status_t flow_diagnostics_record(flow_diagnostics* diag, const flow_field* field,
+                                     size_t step, double time);
+
+// Column name used in the Python API ("kinetic_energy", "flux_left", ...)
+const char* flow_diagnostics_name(diagnostic_column column);
+
+#endif  // CFD_PYTHON_FLOW_DIAGNOSTICS_H
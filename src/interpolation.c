@@ -0,0 +1,100 @@
+/*
+ * Bilinear interpolation on structured grids
+ */
+
+#include "interpolation.h"
+
+#include <math.h>
+
+/*
+ * Index of the cell [c[i], c[i+1]] containing `value`, or -1 if outside.
+ * A value on the last node uses the last cell.
+ */
+static ptrdiff_t find_cell(const double* c, size_t n, double value) {
+    if (n < 2 || !(value >= c[0] && value <= c[n - 1])) {
+        return -1;
+    }
+    size_t lo = 0;
+    size_t hi = n - 1;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (c[mid] <= value) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return (ptrdiff_t)lo;
+}
+
+int bilinear_locate(const double* x, size_t nx, const double* y, size_t ny,
+                    double px, double py, bilinear_stencil* stencil) {
+    ptrdiff_t i = find_cell(x, nx, px);
+    ptrdiff_t j = find_cell(y, ny, py);
+    if (i < 0 || j < 0) {
+        return -1;
+    }
+    stencil->index = (size_t)j * nx + (size_t)i;
+    stencil->wx = (px - x[i]) / (x[i + 1] - x[i]);
+    stencil->wy = (py - y[j]) / (y[j + 1] - y[j]);
+    return 0;
+}
+
+double bilinear_eval(const double* field, const bilinear_stencil* stencil, size_t nx) {
+    const double* lo = field + stencil->index;
+    const double* hi = lo + nx;
+    double bottom = lo[0] + stencil->wx * (lo[1] - lo[0]);
+    double top = hi[0] + stencil->wx * (hi[1] - hi[0]);
+    return bottom + stencil->wy * (top - bottom);
+}
+
+void bilinear_sample(const double* x, size_t nx, const double* y, size_t ny,
+                     const double* const* fields, size_t num_fields,
+                     const double* px, const double* py, size_t count, double* const* out) {
+    ptrdiff_t n = (ptrdiff_t)count;
+
+    #pragma omp parallel for schedule(static)
+    for (ptrdiff_t k = 0; k < n; k++) {
+        bilinear_stencil stencil;
+        int inside = bilinear_locate(x, nx, y, ny, px[k], py[k], &stencil) == 0;
+        for (size_t f = 0; f < num_fields; f++) {
+            out[f][k] = inside ? bilinear_eval(fields[f], &stencil, nx) : NAN;
+        }
+    }
+}
+
+void polyline_resample(const double* vertices, size_t num_vertices, size_t count,
+                       double* px, double* py, double* distance) {
+    double total = 0.0;
+    for (size_t v = 1; v < num_vertices; v++) {
+        total += hypot(vertices[2 * v] - vertices[2 * v - 2],
+                       vertices[2 * v + 1] - vertices[2 * v - 1]);
+    }
+
+    // Walk the segments once; `start` is the arc length at vertex `seg`
+    size_t seg = 0;
+    double start = 0.0;
+    for (size_t k = 0; k < count; k++) {
+        double s = k + 1 == count ? total : total * (double)k / (double)(count - 1);
+        double length = 0.0;
+        while (seg + 1 < num_vertices) {
+            length = hypot(vertices[2 * seg + 2] - vertices[2 * seg],
+                           vertices[2 * seg + 3] - vertices[2 * seg + 1]);
+            if (s <= start + length || seg + 2 == num_vertices) {
+                break;
+            }
+            start += length;
+            seg++;
+        }
+        double t = length > 0.0 ? (s - start) / length : 0.0;
+        t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+        const double* a = vertices + 2 * seg;
+        const double* b = seg + 1 < num_vertices ? a + 2 : a;
+        // (1 - t) * a + t * b hits both endpoints exactly
+        px[k] = (1.0 - t) * a[0] + t * b[0];
+        py[k] = (1.0 - t) * a[1] + t * b[1];
+        if (distance != NULL) {
+            distance[k] = s;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+/*
+ * Bilinear interpolation on structured grids
+ *
+ * Points are located against the grid coordinate arrays by binary search,
+ * so uniform and stretched grids are handled alike. A located point keeps
+ * its stencil (lower-left node and weights) and can be evaluated on any
+ * number of fields without searching again.
+ */
+
+#ifndef CFD_PYTHON_INTERPOLATION_H
+#define CFD_PYTHON_INTERPOLATION_H
+
+#include <stddef.h>
+
+typedef struct {
+    size_t index;   // Row-major index of the lower-left node
+    double wx, wy;  // Weights of the right/upper neighbours
+} bilinear_stencil;
+
+/*
+ * Locate (px, py) in the grid spanned by increasing coordinates x[nx] and
+ * y[ny]. Returns 0 on success, -1 if the point lies outside the grid.
+ */
+int bilinear_locate(const double* x, size_t nx, const double* y, size_t ny,
+                    double px, double py, bilinear_stencil* stencil);
+
+// Interpolate a row-major nx-wide field at a located point
+double bilinear_eval(const double* field, const bilinear_stencil* stencil, size_t nx);
+
+/*
+ * Interpolate `num_fields` fields at `count` points. out[f][k] receives
+ * field f at point k; points outside the grid give NaN.
+ */
+void bilinear_sample(const double* x, size_t nx, const double* y, size_t ny,
+                     const double* const* fields, size_t num_fields,
+                     const double* px, const double* py, size_t count, double* const* out);
+
+/*
+ * Place `count` >= 2 points evenly by arc length along a polyline of
+ * `num_vertices` (x, y) pairs, endpoints included. The arc length of each
+ * point is stored in `distance` if non-NULL.
+ */
+void polyline_resample(const double* vertices, size_t num_vertices, size_t count,
+                       double* px, double* py, double* distance);
+
+#endif  // CFD_PYTHON_INTERPOLATION_H
@@ -0,0 +1,600 @@
+/*
+ * NumPy .npy/.npz files (stdio writers, POSIX mmap reader)
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "npy_file.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#define NPY_MAGIC "\x93NUMPY"
+#define NPY_MAGIC_LEN 6
+#define NPY_HEADER_MAX 1024  // Preamble of the largest shape this writer allows
+
+#define ZIP_LIMIT 0xFFFFFFFFu  // 32-bit fields at this value defer to ZIP64
+#define ZIP_DOS_DATE 0x21      // 1980-01-01
+
+static int is_little_endian(void) {
+    const uint16_t probe = 1;
+    return *(const unsigned char*)&probe == 1;
+}
+
+size_t npy_array_count(const npy_array* array) {
+    size_t count = 1;
+    for (int d = 0; d < array->ndim; d++) {
+        count *= array->shape[d];
+    }
+    return count;
+}
+
+// Check the shape and that its data size fits in size_t
+static int array_valid(const npy_array* array) {
+    if (array->ndim < 0 || array->ndim > NPY_FILE_MAX_DIMS) {
+        return 0;
+    }
+    size_t count = 1;
+    for (int d = 0; d < array->ndim; d++) {
+        size_t n = array->shape[d];
+        if (n != 0 && count > SIZE_MAX / sizeof(double) / n) {
+            return 0;
+        }
+        count *= n;
+    }
+    return count == 0 || array->data != NULL;
+}
+
+/*
+ * Format the magic, version, header length and padded header dict of
+ * `array` into `out` (NPY_HEADER_MAX bytes); returns the preamble length
+ */
+static size_t npy_preamble(const npy_array* array, char* out) {
+    char* dict = out + NPY_MAGIC_LEN + 4;
+    size_t len = (size_t)sprintf(dict, "{'descr': '%cf8', 'fortran_order': False, 'shape': (",
+                                 is_little_endian() ? '<' : '>');
+    for (int d = 0; d < array->ndim; d++) {
+        len += (size_t)sprintf(dict + len, d > 0 ? ", %llu" : "%llu",
+                               (unsigned long long)array->shape[d]);
+    }
+    len += (size_t)sprintf(dict + len, array->ndim == 1 ? ",), }" : "), }");
+
+    // Spaces and a closing newline up to the data alignment
+    size_t total = NPY_MAGIC_LEN + 4 + len + 1;
+    size_t padded = (total + NPY_FILE_ALIGNMENT - 1) / NPY_FILE_ALIGNMENT * NPY_FILE_ALIGNMENT;
+    memset(dict + len, ' ', padded - total);
+    out[padded - 1] = '\n';
+
+    size_t header_len = padded - NPY_MAGIC_LEN - 4;
+    memcpy(out, NPY_MAGIC, NPY_MAGIC_LEN);
+    out[6] = 1;  // Version 1.0
+    out[7] = 0;
+    out[8] = (char)(header_len & 0xff);
+    out[9] = (char)(header_len >> 8);
+    return padded;
+}
+
+int npy_write(const char* filename, const npy_array* array) {
+    if (!array_valid(array)) {
+        errno = EINVAL;
+        return -1;
+    }
+    char preamble[NPY_HEADER_MAX];
+    size_t header_len = npy_preamble(array, preamble);
+    size_t count = npy_array_count(array);
+
+    FILE* f = fopen(filename, "wb");
+    if (f == NULL) {
+        return -1;
+    }
+    int ok = fwrite(preamble, 1, header_len, f) == header_len &&
+             (count == 0 || fwrite(array->data, sizeof(double), count, f) == count);
+    int saved = errno;
+    if (fclose(f) != 0 && ok) {
+        return -1;
+    }
+    if (!ok) {
+        errno = saved != 0 ? saved : EIO;
+        return -1;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Uncompressed .npz
+// ============================================================================
+
+typedef uint32_t crc_table[8][256];
+
+static void crc32_init(crc_table table) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[0][i] = c;
+    }
+    for (int i = 0; i < 256; i++) {
+        for (int t = 1; t < 8; t++) {
+            table[t][i] = (table[t - 1][i] >> 8) ^ table[0][table[t - 1][i] & 0xff];
+        }
+    }
+}
+
+static uint32_t load32le(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+// Zip CRC-32, eight bytes per step
+static uint32_t crc32_update(const crc_table table, uint32_t crc, const void* data, size_t n) {
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    while (n >= 8) {
+        uint32_t a = crc ^ load32le(p);
+        uint32_t b = load32le(p + 4);
+        crc = table[7][a & 0xff] ^ table[6][(a >> 8) & 0xff] ^ table[5][(a >> 16) & 0xff] ^
+              table[4][a >> 24] ^ table[3][b & 0xff] ^ table[2][(b >> 8) & 0xff] ^
+              table[1][(b >> 16) & 0xff] ^ table[0][b >> 24];
+        p += 8;
+        n -= 8;
+    }
+    while (n-- > 0) {
+        crc = table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// Little-endian field writers for zip records; each returns the advanced pointer
+static uint8_t* put16(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t* put32(uint8_t* p, uint32_t v) {
+    return put16(put16(p, v & 0xffff), v >> 16);
+}
+
+static uint8_t* put64(uint8_t* p, uint64_t v) {
+    return put32(put32(p, (uint32_t)v), (uint32_t)(v >> 32));
+}
+
+static uint32_t clamp32(uint64_t v) {
+    return v >= ZIP_LIMIT ? ZIP_LIMIT : (uint32_t)v;
+}
+
+typedef struct {
+    uint64_t offset;  // Of the local header
+    uint64_t size;    // Of the .npy member
+    uint32_t crc;
+} zip_member;
+
+static int write_all(FILE* f, const void* data, size_t n, uint64_t* offset) {
+    if (n > 0 && fwrite(data, 1, n, f) != n) {
+        return -1;
+    }
+    *offset += n;
+    return 0;
+}
+
+// Local header, .npy preamble and data of one member
+static int write_member(FILE* f, const crc_table table, const npy_array* array,
+                        zip_member* member, uint64_t* offset) {
+    char preamble[NPY_HEADER_MAX];
+    size_t header_len = npy_preamble(array, preamble);
+    size_t nbytes = npy_array_count(array) * sizeof(double);
+    member->offset = *offset;
+    member->size = (uint64_t)header_len + nbytes;
+    member->crc = crc32_update(table, crc32_update(table, 0, preamble, header_len),
+                               array->data, nbytes);
+
+    size_t name_len = strlen(array->name);
+    int zip64 = member->size >= ZIP_LIMIT;
+    uint8_t record[30 + 20];
+    uint8_t* p = put32(record, 0x04034b50);
+    p = put16(p, zip64 ? 45 : 20);  // Version needed
+    p = put16(p, 0);                // Flags
+    p = put16(p, 0);                // Stored
+    p = put16(p, 0);                // Time
+    p = put16(p, ZIP_DOS_DATE);
+    p = put32(p, member->crc);
+    p = put32(p, clamp32(member->size));
+    p = put32(p, clamp32(member->size));
+    p = put16(p, (uint32_t)(name_len + 4));
+    p = put16(p, zip64 ? 20 : 0);
+    uint8_t extra[20];
+    uint8_t* e = put16(put16(extra, 0x0001), 16);
+    e = put64(put64(e, member->size), member->size);
+    if (write_all(f, record, (size_t)(p - record), offset) < 0 ||
+        write_all(f, array->name, name_len, offset) < 0 ||
+        write_all(f, ".npy", 4, offset) < 0 ||
+        (zip64 && write_all(f, extra, (size_t)(e - extra), offset) < 0) ||
+        write_all(f, preamble, header_len, offset) < 0 ||
+        write_all(f, array->data, nbytes, offset) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int write_central_entry(FILE* f, const npy_array* array, const zip_member* member,
+                               uint64_t* offset) {
+    size_t name_len = strlen(array->name);
+    uint8_t extra[4 + 24];
+    uint8_t* e = extra + 4;
+    if (member->size >= ZIP_LIMIT) {
+        e = put64(put64(e, member->size), member->size);
+    }
+    if (member->offset >= ZIP_LIMIT) {
+        e = put64(e, member->offset);
+    }
+    size_t extra_len = e == extra + 4 ? 0 : (size_t)(e - extra);
+    put16(put16(extra, 0x0001), (uint32_t)(extra_len > 0 ? extra_len - 4 : 0));
+    uint32_t version = extra_len > 0 ? 45 : 20;
+
+    uint8_t record[46];
+    uint8_t* p = put32(record, 0x02014b50);
+    p = put16(p, version);  // Made by
+    p = put16(p, version);  // Needed
+    p = put16(p, 0);
+    p = put16(p, 0);
+    p = put16(p, 0);
+    p = put16(p, ZIP_DOS_DATE);
+    p = put32(p, member->crc);
+    p = put32(p, clamp32(member->size));
+    p = put32(p, clamp32(member->size));
+    p = put16(p, (uint32_t)(name_len + 4));
+    p = put16(p, (uint32_t)extra_len);
+    p = put16(p, 0);  // Comment
+    p = put16(p, 0);  // Disk
+    p = put16(p, 0);  // Internal attributes
+    p = put32(p, 0);  // External attributes
+    p = put32(p, clamp32(member->offset));
+    if (write_all(f, record, sizeof(record), offset) < 0 ||
+        write_all(f, array->name, name_len, offset) < 0 ||
+        write_all(f, ".npy", 4, offset) < 0 ||
+        write_all(f, extra, extra_len, offset) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// End of central directory, preceded by its ZIP64 form when needed
+static int write_end_records(FILE* f, uint64_t entries, uint64_t cd_offset, uint64_t cd_size,
+                             uint64_t* offset) {
+    uint8_t record[56 + 20 + 22];
+    uint8_t* p = record;
+    if (entries >= 0xFFFF || cd_offset >= ZIP_LIMIT || cd_size >= ZIP_LIMIT) {
+        uint64_t zip64_end = *offset;
+        p = put32(p, 0x06064b50);
+        p = put64(p, 44);  // Remaining record size
+        p = put16(p, 45);
+        p = put16(p, 45);
+        p = put32(p, 0);
+        p = put32(p, 0);
+        p = put64(p, entries);
+        p = put64(p, entries);
+        p = put64(p, cd_size);
+        p = put64(p, cd_offset);
+        p = put32(p, 0x07064b50);  // Locator
+        p = put32(p, 0);
+        p = put64(p, zip64_end);
+        p = put32(p, 1);
+    }
+    p = put32(p, 0x06054b50);
+    p = put16(p, 0);
+    p = put16(p, 0);
+    p = put16(p, entries >= 0xFFFF ? 0xFFFF : (uint32_t)entries);
+    p = put16(p, entries >= 0xFFFF ? 0xFFFF : (uint32_t)entries);
+    p = put32(p, clamp32(cd_size));
+    p = put32(p, clamp32(cd_offset));
+    p = put16(p, 0);  // Comment
+    return write_all(f, record, (size_t)(p - record), offset);
+}
+
+int npz_write(const char* filename, const npy_array* arrays, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (!array_valid(&arrays[i]) || arrays[i].name == NULL || arrays[i].name[0] == '\0' ||
+            strlen(arrays[i].name) > 0xFFFF - 4) {
+            errno = EINVAL;
+            return -1;
+        }
+        for (size_t j = 0; j < i; j++) {
+            if (strcmp(arrays[i].name, arrays[j].name) == 0) {
+                errno = EINVAL;
+                return -1;
+            }
+        }
+    }
+    zip_member* members = (zip_member*)malloc((count > 0 ? count : 1) * sizeof(zip_member));
+    crc_table* table = (crc_table*)malloc(sizeof(crc_table));
+    if (members == NULL || table == NULL) {
+        free(members);
+        free(table);
+        errno = ENOMEM;
+        return -1;
+    }
+    crc32_init(*table);
+
+    FILE* f = fopen(filename, "wb");
+    int ok = f != NULL;
+    uint64_t offset = 0;
+    for (size_t i = 0; ok && i < count; i++) {
+        ok = write_member(f, (const uint32_t(*)[256])*table, &arrays[i], &members[i],
+                          &offset) == 0;
+    }
+    uint64_t cd_offset = offset;
+    for (size_t i = 0; ok && i < count; i++) {
+        ok = write_central_entry(f, &arrays[i], &members[i], &offset) == 0;
+    }
+    ok = ok && write_end_records(f, count, cd_offset, offset - cd_offset, &offset) == 0;
+    int saved = errno;
+    free(members);
+    free(table);
+    if (f == NULL) {
+        errno = saved;
+        return -1;
+    }
+    if (fclose(f) != 0 && ok) {
+        return -1;
+    }
+    if (!ok) {
+        errno = saved != 0 ? saved : EIO;
+        return -1;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Memory-mapped reader
+// ============================================================================
+
+#ifdef _WIN32
+
+int npy_map_open(const char* filename, int writable, npy_map* map) {
+    (void)filename;
+    (void)writable;
+    memset(map, 0, sizeof(*map));
+    errno = ENOSYS;
+    return -1;
+}
+
+void npy_map_close(npy_map* map) {
+    (void)map;
+}
+
+#else
+
+typedef struct {
+    const char* p;
+    const char* end;
+} cursor;
+
+static void skip_space(cursor* c) {
+    while (c->p < c->end && (*c->p == ' ' || *c->p == '\t' || *c->p == '\n' || *c->p == '\r')) {
+        c->p++;
+    }
+}
+
+// Consume `ch` after optional whitespace
+static int expect(cursor* c, char ch) {
+    skip_space(c);
+    if (c->p < c->end && *c->p == ch) {
+        c->p++;
+        return 1;
+    }
+    return 0;
+}
+
+// Consume `word` after optional whitespace
+static int expect_word(cursor* c, const char* word) {
+    skip_space(c);
+    size_t len = strlen(word);
+    if ((size_t)(c->end - c->p) >= len && memcmp(c->p, word, len) == 0) {
+        c->p += len;
+        return 1;
+    }
+    return 0;
+}
+
+// A quoted Python string literal without escapes, copied into `out`
+static int parse_string(cursor* c, char* out, size_t cap) {
+    skip_space(c);
+    if (c->p >= c->end || (*c->p != '\'' && *c->p != '"')) {
+        return 0;
+    }
+    char quote = *c->p++;
+    size_t len = 0;
+    while (c->p < c->end && *c->p != quote) {
+        if (*c->p == '\\' || len + 1 >= cap) {
+            return 0;
+        }
+        out[len++] = *c->p++;
+    }
+    if (c->p >= c->end) {
+        return 0;
+    }
+    c->p++;
+    out[len] = '\0';
+    return 1;
+}
+
+// Shape tuple of non-negative integers; the data size must fit in size_t
+static int parse_shape(cursor* c, npy_map* map) {
+    if (!expect(c, '(')) {
+        return 0;
+    }
+    map->ndim = 0;
+    map->count = 1;
+    skip_space(c);
+    while (c->p < c->end && *c->p != ')') {
+        if (map->ndim == NPY_FILE_MAX_DIMS || *c->p < '0' || *c->p > '9') {
+            return 0;
+        }
+        size_t n = 0;
+        while (c->p < c->end && *c->p >= '0' && *c->p <= '9') {
+            size_t digit = (size_t)(*c->p++ - '0');
+            if (n > (SIZE_MAX - digit) / 10) {
+                return 0;
+            }
+            n = n * 10 + digit;
+        }
+        if (c->p < c->end && *c->p == 'L') {  // Written by Python 2
+            c->p++;
+        }
+        if (n != 0 && map->count > SIZE_MAX / sizeof(double) / n) {
+            return 0;
+        }
+        map->count *= n;
+        map->shape[map->ndim++] = n;
+        if (!expect(c, ',')) {
+            break;
+        }
+        skip_space(c);
+    }
+    return expect(c, ')');
+}
+
+/*
+ * Parse the header dict: exactly 'descr' (native float64), 'fortran_order'
+ * (False, unless at most one dimension is larger than 1) and 'shape'
+ */
+static int parse_dict(cursor* c, npy_map* map) {
+    const char* native = is_little_endian() ? "<f8" : ">f8";
+    int seen_descr = 0, seen_order = 0, seen_shape = 0, fortran = 0;
+    if (!expect(c, '{')) {
+        return 0;
+    }
+    while (!expect(c, '}')) {
+        char key[16], value[16];
+        if (!parse_string(c, key, sizeof(key)) || !expect(c, ':')) {
+            return 0;
+        }
+        if (strcmp(key, "descr") == 0 && !seen_descr) {
+            if (!parse_string(c, value, sizeof(value)) || strcmp(value, native) != 0) {
+                return 0;
+            }
+            seen_descr = 1;
+        } else if (strcmp(key, "fortran_order") == 0 && !seen_order) {
+            if (expect_word(c, "True")) {
+                fortran = 1;
+            } else if (!expect_word(c, "False")) {
+                return 0;
+            }
+            seen_order = 1;
+        } else if (strcmp(key, "shape") == 0 && !seen_shape) {
+            if (!parse_shape(c, map)) {
+                return 0;
+            }
+            seen_shape = 1;
+        } else {
+            return 0;
+        }
+        if (!expect(c, ',')) {
+            if (!expect(c, '}')) {
+                return 0;
+            }
+            break;
+        }
+    }
+    skip_space(c);
+    if (c->p != c->end || !seen_descr || !seen_order || !seen_shape) {
+        return 0;
+    }
+    // Fortran order is only the same layout when one axis carries all values
+    int spread = 0;
+    for (int d = 0; d < map->ndim; d++) {
+        spread += map->shape[d] > 1;
+    }
+    return !fortran || spread <= 1;
+}
+
+static int parse_npy(npy_map* map) {
+    const unsigned char* base = (const unsigned char*)map->base;
+    if (map->size < NPY_MAGIC_LEN + 4 || memcmp(base, NPY_MAGIC, NPY_MAGIC_LEN) != 0 ||
+        base[7] != 0) {
+        return 0;
+    }
+    size_t header_len, start;
+    if (base[6] == 1) {
+        header_len = (size_t)base[8] | ((size_t)base[9] << 8);
+        start = NPY_MAGIC_LEN + 4;
+    } else if ((base[6] == 2 || base[6] == 3) && map->size >= NPY_MAGIC_LEN + 6) {
+        header_len = (size_t)load32le(base + 8);
+        start = NPY_MAGIC_LEN + 6;
+    } else {
+        return 0;
+    }
+    if (header_len > map->size - start) {
+        return 0;
+    }
+    size_t data_offset = start + header_len;
+    cursor c = {(const char*)base + start, (const char*)base + data_offset};
+    // The mapping is page-aligned, so an aligned offset gives aligned doubles
+    if (data_offset % sizeof(double) != 0 || !parse_dict(&c, map) ||
+        map->count > (map->size - data_offset) / sizeof(double)) {
+        return 0;
+    }
+    map->data = (double*)((char*)map->base + data_offset);
+    return 1;
+}
+
+int npy_map_open(const char* filename, int writable, npy_map* map) {
+    memset(map, 0, sizeof(*map));
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    if (size < NPY_MAGIC_LEN + 4) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+
+    void* base = writable ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+                          : mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    int saved = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        errno = saved;
+        return -1;
+    }
+    map->base = base;
+    map->size = size;
+    if (!parse_npy(map)) {
+        npy_map_close(map);
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+void npy_map_close(npy_map* map) {
+    if (map->base != NULL) {
+        munmap(map->base, map->size);
+    }
+    memset(map, 0, sizeof(*map));
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * NumPy .npy/.npz files
+ *
+ * Writers for float64 arrays in the NumPy .npy format (version 1.0) and
+ * for uncompressed .npz archives of several such arrays, plus a validating
+ * memory-mapped .npy reader that also accepts versions 2.0 and 3.0.
+ *
+ * .npy layout:
+ *   ["\x93NUMPY"][major][minor][header length][header dict][pad][data]
+ *
+ * The header is a Python dict literal such as
+ *   {'descr': '<f8', 'fortran_order': False, 'shape': (64, 128), }
+ * padded with spaces and a newline so the data starts on a 64-byte
+ * boundary, as NumPy itself writes it. Data is stored in native byte
+ * order, which the descr records.
+ *
+ * An .npz is a zip archive with one stored (uncompressed) NAME.npy member
+ * per array; ZIP64 records are added once sizes or offsets pass 4 GiB.
+ */
+
+#ifndef CFD_PYTHON_NPY_FILE_H
+#define CFD_PYTHON_NPY_FILE_H
+
+#include <stddef.h>
+
+#define NPY_FILE_MAX_DIMS 32
+#define NPY_FILE_ALIGNMENT 64
+
+typedef struct {
+    const char* name;  // Member name without ".npy" (npz only)
+    const double* data;
+    int ndim;
+    size_t shape[NPY_FILE_MAX_DIMS];
+} npy_array;
+
+typedef struct {
+    void* base;
+    size_t size;
+    double* data;  // Inside the mapping
+    size_t count;
+    int ndim;
+    size_t shape[NPY_FILE_MAX_DIMS];
+} npy_map;
+
+/*
+ * All functions returning int return 0 on success and -1 on failure with
+ * errno set; EINVAL marks a file that is not a C-ordered native float64
+ * .npy, or invalid arguments.
+ */
+
+// Number of values in an array of this shape
+size_t npy_array_count(const npy_array* array);
+
+// Write one array as an .npy file
+int npy_write(const char* filename, const npy_array* array);
+
+/*
+ * Write `count` arrays as the members of an uncompressed .npz; names must
+ * be non-empty and unique
+ */
+int npz_write(const char* filename, const npy_array* arrays, size_t count);
+
+/*
+ * Map an .npy file and validate its header. With `writable` the mapping is
+ * copy-on-write: the data can be modified in memory but the file is never
+ * changed. ENOSYS on Windows.
+ */
+int npy_map_open(const char* filename, int writable, npy_map* map);
+
+void npy_map_close(npy_map* map);
+
+#endif  // CFD_PYTHON_NPY_FILE_H
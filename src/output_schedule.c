@@ -0,0 +1,364 @@
+/*
+ * Periodic output inside the native step loop
+ */
+
+#include "output_schedule.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cfd/io/csv_output.h"
+
+#include "double_format.h"
+#include "field_stats.h"
+#include "vtk_ascii.h"
+#include "vtk_binary.h"
+
+// Widest step conversion accepted; a 64-bit size_t has at most 20 digits
+#define OUTPUT_PATTERN_MAX_WIDTH 20
+
+/*
+ * Walk a pattern. Each "%[0][width]d" conversion is reported through
+ * `width`/`zero_pad` and returned as 1; "%%" and ordinary characters as 0.
+ * Returns -1 for anything else. *pos advances past the token.
+ */
+static int pattern_token(const char* pattern, size_t* pos, int* width, int* zero_pad) {
+    const char* s = pattern + *pos;
+    if (s[0] != '%') {
+        *pos += 1;
+        return 0;
+    }
+    if (s[1] == '%') {
+        *pos += 2;
+        return 0;
+    }
+    size_t k = 1;
+    *zero_pad = s[k] == '0';
+    if (*zero_pad) {
+        k++;
+    }
+    *width = 0;
+    while (s[k] >= '0' && s[k] <= '9') {
+        *width = *width * 10 + (s[k] - '0');
+        if (*width > OUTPUT_PATTERN_MAX_WIDTH) {
+            return -1;
+        }
+        k++;
+    }
+    if (s[k] != 'd') {
+        return -1;
+    }
+    *pos += k + 1;
+    return 1;
+}
+
+int output_pattern_check(const char* pattern) {
+    int conversions = 0;
+    size_t pos = 0;
+    while (pattern[pos] != '\0') {
+        int width, zero_pad;
+        int kind = pattern_token(pattern, &pos, &width, &zero_pad);
+        if (kind < 0 || (conversions += kind) > 1) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    return conversions;
+}
+
+int output_format_filename(const char* pattern, size_t step, char* buf, size_t size) {
+    size_t len = 0;
+    size_t pos = 0;
+    while (pattern[pos] != '\0') {
+        size_t start = pos;
+        int width = 0, zero_pad = 0;
+        char piece[32];
+        size_t piece_len;
+        int kind = pattern_token(pattern, &pos, &width, &zero_pad);
+        if (kind < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (kind == 1) {
+            int n = snprintf(piece, sizeof(piece), zero_pad ? "%0*zu" : "%*zu", width, step);
+            if (n < 0 || (size_t)n >= sizeof(piece)) {
+                errno = EINVAL;
+                return -1;
+            }
+            piece_len = (size_t)n;
+        } else {
+            // A literal character, or the '%' of "%%"
+            piece[0] = pattern[start];
+            piece_len = 1;
+        }
+        if (len + piece_len >= size) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        memcpy(buf + len, piece, piece_len);
+        len += piece_len;
+    }
+    buf[len] = '\0';
+    return 0;
+}
+
+int output_schedule_add(output_schedule* schedule, output_field_type type, size_t interval,
+                        const char* pattern, int binary, int precision) {
+    int per_step = output_pattern_check(pattern);
+    if ((int)type < (int)OUTPUT_VELOCITY_MAGNITUDE || (int)type > (int)OUTPUT_CSV_STATISTICS ||
+        interval == 0 || per_step < 0 || pattern[0] == '\0' || precision < 0 ||
+        precision > DOUBLE_FORMAT_DIGITS) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (schedule->count == schedule->capacity) {
+        size_t capacity = schedule->capacity > 0 ? 2 * schedule->capacity : 4;
+        scheduled_output* items = (scheduled_output*)realloc(
+            schedule->items, capacity * sizeof(scheduled_output));
+        if (items == NULL) {
+            errno = ENOMEM;
+            return -1;
+        }
+        schedule->items = items;
+        schedule->capacity = capacity;
+    }
+    size_t length = strlen(pattern);
+    char* copy = (char*)malloc(length + 1);
+    if (copy == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    memcpy(copy, pattern, length + 1);
+
+    scheduled_output* item = &schedule->items[schedule->count++];
+    item->type = type;
+    item->interval = interval;
+    item->pattern = copy;
+    item->per_step = per_step;
+    item->binary = binary != 0;
+    item->precision = precision;
+    item->writes = 0;
+    return 0;
+}
+
+void output_schedule_clear(output_schedule* schedule) {
+    for (size_t k = 0; k < schedule->count; k++) {
+        free(schedule->items[k].pattern);
+    }
+    schedule->count = 0;
+}
+
+void output_schedule_free(output_schedule* schedule) {
+    output_schedule_clear(schedule);
+    free(schedule->items);
+    free(schedule->scratch);
+    memset(schedule, 0, sizeof(*schedule));
+}
+
+static double* velocity_magnitude(output_schedule* schedule, const flow_field* field,
+                                  size_t count) {
+    if (schedule->scratch_size < count) {
+        double* scratch = (double*)realloc(schedule->scratch, count * sizeof(double));
+        if (scratch == NULL) {
+            errno = ENOMEM;
+            return NULL;
+        }
+        schedule->scratch = scratch;
+        schedule->scratch_size = count;
+    }
+    double* out = schedule->scratch;
+    const double* u = field->u;
+    const double* v = field->v;
+#pragma omp parallel for schedule(static)
+    for (ptrdiff_t i = 0; i < (ptrdiff_t)count; i++) {
+        out[i] = sqrt(u[i] * u[i] + v[i] * v[i]);
+    }
+    return out;
+}
+
+// Close the file, keeping the first error (write or close) in errno
+static int finish(FILE* f, int rc) {
+    int saved = errno;
+    if (fclose(f) != 0 && rc == 0) {
+        return -1;
+    }
+    if (rc != 0) {
+        errno = saved != 0 ? saved : EIO;
+    }
+    return rc;
+}
+
+// Most values on one CSV row after its label
+#define ROW_VALUES 13
+
+// Write `label` and `count` values as one CSV row
+static int write_row(FILE* f, const char* label, const double* values, int count,
+                     int precision) {
+    char line[32 + ROW_VALUES * (DOUBLE_FORMAT_MAX + 1)];
+    size_t len = strlen(label);
+    memcpy(line, label, len);
+    for (int k = 0; k < count; k++) {
+        line[len++] = ',';
+        len += (size_t)double_format(values[k], precision, line + len);
+    }
+    line[len++] = '\n';
+    return fwrite(line, 1, len, f) == len ? 0 : -1;
+}
+
+// Horizontal line through j = ny/2, then vertical line through i = nx/2
+static int write_centerline_csv(const char* filename, const simulation_data* sim,
+                                int precision) {
+    const grid* g = sim->grid;
+    const flow_field* field = sim->field;
+    size_t nx = field->nx;
+    size_t ny = field->ny;
+    FILE* f = fopen(filename, "w");
+    if (f == NULL) {
+        return -1;
+    }
+    errno = 0;
+    int rc = fputs("axis,x,y,u,v,p\n", f) == EOF ? -1 : 0;
+    size_t jc = ny / 2;
+    for (size_t i = 0; i < nx && rc == 0; i++) {
+        size_t idx = jc * nx + i;
+        const double values[5] = {g->x[i], g->y[jc], field->u[idx], field->v[idx],
+                                  field->p[idx]};
+        rc = write_row(f, "x", values, 5, precision);
+    }
+    size_t ic = nx / 2;
+    for (size_t j = 0; j < ny && rc == 0; j++) {
+        size_t idx = j * nx + ic;
+        const double values[5] = {g->x[ic], g->y[j], field->u[idx], field->v[idx],
+                                  field->p[idx]};
+        rc = write_row(f, "y", values, 5, precision);
+    }
+    return finish(f, rc);
+}
+
+// One row of min/max/mean per field; the header goes into new files only
+static int write_statistics_csv(output_schedule* schedule, const char* filename,
+                                const simulation_data* sim, size_t step, double time,
+                                int create_new, int precision) {
+    const flow_field* field = sim->field;
+    size_t count = field->nx * field->ny * field->nz;
+    const double* magnitude = velocity_magnitude(schedule, field, count);
+    if (magnitude == NULL) {
+        return -1;
+    }
+    const double* columns[4] = {field->u, field->v, field->p, magnitude};
+    field_moments moments[4];
+    for (int c = 0; c < 4; c++) {
+        if (field_stats_compute(columns[c], count, &moments[c], NULL, 0) != CFD_SUCCESS) {
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+
+    FILE* f = fopen(filename, create_new ? "w" : "a");
+    if (f == NULL) {
+        return -1;
+    }
+    errno = 0;
+    int rc = 0;
+    if (create_new &&
+        fputs("step,time,u_min,u_max,u_mean,v_min,v_max,v_mean,p_min,p_max,p_mean,"
+              "velocity_magnitude_min,velocity_magnitude_max,velocity_magnitude_mean\n",
+              f) == EOF) {
+        rc = -1;
+    }
+    if (rc == 0) {
+        char label[32];
+        double values[1 + 3 * 4] = {time};
+        for (int c = 0; c < 4; c++) {
+            values[1 + 3 * c] = moments[c].min;
+            values[2 + 3 * c] = moments[c].max;
+            values[3 + 3 * c] = moments[c].mean;
+        }
+        snprintf(label, sizeof(label), "%zu", step);
+        rc = write_row(f, label, values, 1 + 3 * 4, precision);
+    }
+    return finish(f, rc);
+}
+
+static int write_scheduled(output_schedule* schedule, const scheduled_output* item,
+                           const char* filename, const simulation_data* sim, size_t step,
+                           double time) {
+    const grid* g = sim->grid;
+    const flow_field* field = sim->field;
+    size_t nx = field->nx, ny = field->ny, nz = field->nz;
+    size_t count = nx * ny * nz;
+    int create_new = item->per_step || item->writes == 0;
+    vtk_geometry geom;
+    vtk_geometry_from_bounds(&geom, nx, ny, nz, g->xmin, g->xmax, g->ymin, g->ymax,
+                             g->zmin, g->zmax);
+
+    switch (item->type) {
+        case OUTPUT_VELOCITY_MAGNITUDE: {
+            const double* magnitude = velocity_magnitude(schedule, field, count);
+            if (magnitude == NULL) {
+                return -1;
+            }
+            if (item->binary) {
+                return vtk_binary_write_scalar(filename, "velocity_magnitude", magnitude, &geom);
+            }
+            return vtk_ascii_write_scalar(filename, "velocity_magnitude", magnitude, &geom,
+                                          item->precision);
+        }
+        case OUTPUT_VELOCITY:
+            if (item->binary) {
+                return vtk_binary_write_vector(filename, "velocity", field->u, field->v, NULL,
+                                               &geom);
+            }
+            return vtk_ascii_write_vector(filename, "velocity", field->u, field->v, NULL, &geom,
+                                          item->precision);
+        case OUTPUT_FULL_FIELD:
+            if (item->binary) {
+                return vtk_binary_write_flow(filename, field->u, field->v, field->p, &geom);
+            }
+            return vtk_ascii_write_flow(filename, field->u, field->v, field->p, &geom,
+                                        item->precision);
+        case OUTPUT_CSV_TIMESERIES:
+            write_csv_timeseries(filename, (int)step, time, field, NULL, &sim->params,
+                                 &sim->last_stats, nx, ny, create_new);
+            return 0;
+        case OUTPUT_CSV_CENTERLINE:
+            return write_centerline_csv(filename, sim, item->precision);
+        case OUTPUT_CSV_STATISTICS:
+            return write_statistics_csv(schedule, filename, sim, step, time, create_new,
+                                        item->precision);
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+int output_schedule_run(output_schedule* schedule, const simulation_data* sim, size_t step,
+                        double time, char* failed_path, size_t path_size) {
+    char filename[1024];
+    for (size_t k = 0; k < schedule->count; k++) {
+        scheduled_output* item = &schedule->items[k];
+        if (step % item->interval != 0) {
+            continue;
+        }
+        // Report the pattern itself when it cannot be expanded
+        const char* name = item->pattern;
+        int rc = output_format_filename(item->pattern, step, filename, sizeof(filename));
+        if (rc == 0) {
+            name = filename;
+            rc = write_scheduled(schedule, item, filename, sim, step, time);
+        }
+        if (rc < 0) {
+            int saved = errno;
+            if (failed_path != NULL && path_size > 0) {
+                failed_path[0] = '\0';
+                strncat(failed_path, name, path_size - 1);
+            }
+            errno = saved;
+            return -1;
+        }
+        item->writes++;
+    }
+    return 0;
+}
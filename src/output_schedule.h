@@ -0,0 +1,75 @@
+/*
+ * Periodic output inside the native step loop
+ *
+ * A schedule is a list of (OUTPUT_* type, interval, filename pattern)
+ * entries run after every step whose number is a multiple of the interval.
+ * Patterns may hold one printf-style step conversion ("%d", "%06d", width
+ * at most 20) and "%%"; they are expanded here rather than passed to printf, so a user
+ * pattern can never read stray arguments. A pattern without a conversion
+ * names a single file: CSV outputs append a row to it and VTK outputs
+ * overwrite it.
+ *
+ * VTK outputs go through the in-tree ASCII or binary legacy writers.
+ * CSV_TIMESERIES uses the library's writer; CSV_CENTERLINE and
+ * CSV_STATISTICS are written here because the library only writes them
+ * from its own output registry. Text values of both use double_format().
+ */
+
+#ifndef CFD_PYTHON_OUTPUT_SCHEDULE_H
+#define CFD_PYTHON_OUTPUT_SCHEDULE_H
+
+#include <stddef.h>
+
+#include "cfd/api/simulation_api.h"
+
+typedef struct {
+    output_field_type type;
+    size_t interval;  // Write after every `interval` steps
+    char* pattern;
+    int per_step;     // The pattern holds a step conversion
+    int binary;       // Binary legacy VTK instead of ASCII
+    int precision;    // Significant digits of text values; 0 for shortest round-trip
+    size_t writes;    // Files written (or rows appended) so far
+} scheduled_output;
+
+typedef struct {
+    scheduled_output* items;
+    size_t count;
+    size_t capacity;
+    double* scratch;  // Velocity magnitude workspace, grown on demand
+    size_t scratch_size;
+} output_schedule;
+
+/*
+ * Check a filename pattern. Returns 1 if it holds a step conversion, 0 if
+ * it holds none, and -1 with errno = EINVAL for any other conversion or
+ * more than one.
+ */
+int output_pattern_check(const char* pattern);
+
+/*
+ * Expand a checked pattern for `step` into buf. Returns 0, or -1 with
+ * errno = ENAMETOOLONG if it does not fit.
+ */
+int output_format_filename(const char* pattern, size_t step, char* buf, size_t size);
+
+/*
+ * Append an entry. Returns 0, or -1 with errno = EINVAL (unknown type, zero
+ * interval, bad pattern) or ENOMEM.
+ */
+int output_schedule_add(output_schedule* schedule, output_field_type type, size_t interval,
+                        const char* pattern, int binary, int precision);
+
+// Remove all entries, keeping the workspace
+void output_schedule_clear(output_schedule* schedule);
+void output_schedule_free(output_schedule* schedule);
+
+/*
+ * Write every entry due at `step`. Returns 0, or -1 with errno set and the
+ * failing file name copied into failed_path (if not NULL); entries after
+ * the failing one are not written for this step.
+ */
+int output_schedule_run(output_schedule* schedule, const simulation_data* sim, size_t step,
+                        double time, char* failed_path, size_t path_size);
+
+#endif  // CFD_PYTHON_OUTPUT_SCHEDULE_H
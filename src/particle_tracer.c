@@ -0,0 +1,115 @@
+/*
+ * Massless particle tracers
+ */
+
+#include "particle_tracer.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "interpolation.h"
+
+// Velocity at (px, py); returns -1 outside the grid
+static int velocity_at(const tracer_field* f, double px, double py, double* up, double* vp) {
+    bilinear_stencil stencil;
+    if (bilinear_locate(f->x, f->nx, f->y, f->ny, px, py, &stencil) < 0) {
+        return -1;
+    }
+    *up = bilinear_eval(f->u, &stencil, f->nx);
+    *vp = bilinear_eval(f->v, &stencil, f->nx);
+    return 0;
+}
+
+static int rk2_step(const tracer_field* f, double* px, double* py, double dt) {
+    double u1, v1, u2, v2;
+    if (velocity_at(f, *px, *py, &u1, &v1) < 0 ||
+        velocity_at(f, *px + 0.5 * dt * u1, *py + 0.5 * dt * v1, &u2, &v2) < 0) {
+        return -1;
+    }
+    *px += dt * u2;
+    *py += dt * v2;
+    return 0;
+}
+
+static int rk4_step(const tracer_field* f, double* px, double* py, double dt) {
+    double u1, v1, u2, v2, u3, v3, u4, v4;
+    double x = *px, y = *py;
+    if (velocity_at(f, x, y, &u1, &v1) < 0 ||
+        velocity_at(f, x + 0.5 * dt * u1, y + 0.5 * dt * v1, &u2, &v2) < 0 ||
+        velocity_at(f, x + 0.5 * dt * u2, y + 0.5 * dt * v2, &u3, &v3) < 0 ||
+        velocity_at(f, x + dt * u3, y + dt * v3, &u4, &v4) < 0) {
+        return -1;
+    }
+    *px = x + dt / 6.0 * (u1 + 2.0 * u2 + 2.0 * u3 + u4);
+    *py = y + dt / 6.0 * (v1 + 2.0 * v2 + 2.0 * v3 + v4);
+    return 0;
+}
+
+size_t tracer_advect(double* px, double* py, size_t count, const tracer_field* field,
+                     double dt, size_t steps, tracer_method method) {
+    ptrdiff_t n = (ptrdiff_t)count;
+    ptrdiff_t active = 0;
+
+    #pragma omp parallel for schedule(static) reduction(+:active)
+    for (ptrdiff_t k = 0; k < n; k++) {
+        double x = px[k], y = py[k];
+        if (isnan(x) || isnan(y)) {
+            continue;
+        }
+        int ok = 1;
+        for (size_t s = 0; ok && s < steps; s++) {
+            ok = (method == TRACER_RK2 ? rk2_step(field, &x, &y, dt)
+                                       : rk4_step(field, &x, &y, dt)) == 0;
+        }
+        // The final position must also lie inside the grid
+        double u, v;
+        if (ok && velocity_at(field, x, y, &u, &v) < 0) {
+            ok = 0;
+        }
+        px[k] = ok ? x : NAN;
+        py[k] = ok ? y : NAN;
+        active += ok ? 1 : 0;
+    }
+    return (size_t)active;
+}
+
+particle_set* particle_set_create(const double* x, const double* y, size_t count,
+                                  tracer_method method, size_t interval) {
+    particle_set* particles = (particle_set*)calloc(1, sizeof(particle_set));
+    if (particles == NULL) {
+        return NULL;
+    }
+    size_t bytes = (count > 0 ? count : 1) * sizeof(double);
+    particles->x = (double*)malloc(bytes);
+    particles->y = (double*)malloc(bytes);
+    if (particles->x == NULL || particles->y == NULL) {
+        particle_set_destroy(particles);
+        return NULL;
+    }
+    if (count > 0) {
+        memcpy(particles->x, x, count * sizeof(double));
+        memcpy(particles->y, y, count * sizeof(double));
+    }
+    particles->count = count;
+    particles->method = method;
+    particles->interval = interval;
+    return particles;
+}
+
+void particle_set_destroy(particle_set* particles) {
+    if (particles == NULL) {
+        return;
+    }
+    free(particles->x);
+    free(particles->y);
+    free(particles);
+}
+
+size_t particle_set_active(const particle_set* particles) {
+    size_t active = 0;
+    for (size_t k = 0; k < particles->count; k++) {
+        active += !isnan(particles->x[k]) && !isnan(particles->y[k]);
+    }
+    return active;
+}
@@ -0,0 +1,55 @@
+/*
+ * Massless particle tracers
+ *
+ * Positions are kept as a struct of arrays (x[], y[]) and advected through
+ * a velocity field that is frozen over each step, with explicit midpoint
+ * (RK2) or classical RK4 integration. Velocities are bilinearly
+ * interpolated with the stencils from interpolation.h, so uniform and
+ * stretched grids are handled alike. A particle whose position or any
+ * intermediate stage leaves the grid is set to NaN and is skipped from
+ * then on.
+ */
+
+#ifndef CFD_PYTHON_PARTICLE_TRACER_H
+#define CFD_PYTHON_PARTICLE_TRACER_H
+
+#include <stddef.h>
+
+typedef enum {
+    TRACER_RK2 = 2,
+    TRACER_RK4 = 4
+} tracer_method;
+
+typedef struct {
+    const double* u;
+    const double* v;
+    const double* x;  // Grid coordinates, nx increasing values
+    const double* y;  // Grid coordinates, ny increasing values
+    size_t nx, ny;
+} tracer_field;
+
+typedef struct {
+    size_t count;
+    double* x;
+    double* y;
+    tracer_method method;
+    size_t interval;  // Advect every `interval` solver steps
+    size_t steps;     // Advection steps taken
+} particle_set;
+
+/*
+ * Advance `count` particles by `steps` steps of size dt. Returns the number
+ * of particles still inside the grid afterwards.
+ */
+size_t tracer_advect(double* px, double* py, size_t count, const tracer_field* field,
+                     double dt, size_t steps, tracer_method method);
+
+// Copy the seed positions into a new set; NULL on allocation failure
+particle_set* particle_set_create(const double* x, const double* y, size_t count,
+                                  tracer_method method, size_t interval);
+void particle_set_destroy(particle_set* particles);
+
+// Particles still inside the grid (positions not NaN)
+size_t particle_set_active(const particle_set* particles);
+
+#endif  // CFD_PYTHON_PARTICLE_TRACER_H
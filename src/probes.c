@@ -0,0 +1,58 @@
+/*
+ * Probe (monitor) points
+ */
+
+#include "probes.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+cfd_status_t probe_set_init(probe_set* probes, const grid* g, const double* xy,
+                            size_t num_points, size_t interval, size_t max_samples) {
+    memset(probes, 0, sizeof(*probes));
+    if (num_points == 0 || interval == 0 || g->nx < 2 || g->ny < 2) {
+        return CFD_ERROR_INVALID;
+    }
+
+    probes->points = (probe_point*)calloc(num_points, sizeof(probe_point));
+    if (probes->points == NULL) {
+        return CFD_ERROR_NOMEM;
+    }
+    for (size_t k = 0; k < num_points; k++) {
+        probe_point* pt = &probes->points[k];
+        pt->x = xy[2 * k];
+        pt->y = xy[2 * k + 1];
+        if (bilinear_locate(g->x, g->nx, g->y, g->ny, pt->x, pt->y, &pt->stencil) < 0) {
+            probe_set_free(probes);
+            return CFD_ERROR_INVALID;
+        }
+    }
+    probes->num_points = num_points;
+    probes->nx = g->nx;
+    probes->interval = interval;
+    sample_store_init(&probes->samples, PROBE_ROW_WIDTH(num_points), max_samples);
+    return CFD_SUCCESS;
+}
+
+void probe_set_free(probe_set* probes) {
+    free(probes->points);
+    sample_store_free(&probes->samples);
+    memset(probes, 0, sizeof(*probes));
+}
+
+cfd_status_t probe_set_record(probe_set* probes, const flow_field* field,
+                              size_t step, double time) {
+    double* row = sample_store_append(&probes->samples);
+    if (row == NULL) {
+        return CFD_ERROR_NOMEM;
+    }
+    row[0] = time;
+    row[1] = (double)step;
+    for (size_t k = 0; k < probes->num_points; k++) {
+        const probe_point* pt = &probes->points[k];
+        row[2 + 3 * k] = bilinear_eval(field->u, &pt->stencil, probes->nx);
+        row[3 + 3 * k] = bilinear_eval(field->v, &pt->stencil, probes->nx);
+        row[4 + 3 * k] = bilinear_eval(field->p, &pt->stencil, probes->nx);
+    }
+    return CFD_SUCCESS;
+}
@@ -0,0 +1,53 @@
+/*
+ * Probe (monitor) points
+ *
+ * Point sensors at physical coordinates, bilinearly interpolated from the
+ * surrounding grid nodes (uniform or stretched). The interpolation stencil is
+ * resolved once when the probes are defined, so recording a sample costs four
+ * loads per quantity per probe.
+ *
+ * Samples are stored as rows of PROBE_ROW_WIDTH(n) doubles:
+ *   [time, step, u0, v0, p0, u1, v1, p1, ...]
+ */
+
+#ifndef CFD_PYTHON_PROBES_H
+#define CFD_PYTHON_PROBES_H
+
+#include <stddef.h>
+
+#include "cfd/core/cfd_status.h"
+#include "cfd/core/grid.h"
+#include "cfd/solvers/navier_stokes_solver.h"
+
+#include "interpolation.h"
+#include "sample_store.h"
+
+#define PROBE_ROW_WIDTH(n) (2 + 3 * (n))
+
+typedef struct {
+    double x, y;
+    bilinear_stencil stencil;
+} probe_point;
+
+typedef struct {
+    probe_point* points;
+    size_t num_points;
+    size_t nx;
+    size_t interval;  // Record every `interval` steps
+    sample_store samples;
+} probe_set;
+
+/*
+ * Resolve `num_points` (x, y) pairs against the grid. `max_samples` > 0
+ * keeps only the newest rows. Returns CFD_ERROR_INVALID if a point lies
+ * outside the grid bounds.
+ */
+cfd_status_t probe_set_init(probe_set* probes, const grid* g, const double* xy,
+                            size_t num_points, size_t interval, size_t max_samples);
+void probe_set_free(probe_set* probes);
+
+// Append one sample of every probe; CFD_ERROR_NOMEM if the store cannot grow
+cfd_status_t probe_set_record(probe_set* probes, const flow_field* field,
+                              size_t step, double time);
+
+#endif  // CFD_PYTHON_PROBES_H
@@ -0,0 +1,67 @@
+/*
+ * Row store for in-loop time series
+ */
+
+#include "sample_store.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLE_STORE_INITIAL_ROWS 256
+
+void sample_store_init(sample_store* store, size_t width, size_t max_rows) {
+    memset(store, 0, sizeof(*store));
+    store->width = width;
+    store->max_rows = max_rows;
+}
+
+void sample_store_free(sample_store* store) {
+    free(store->rows);
+    memset(store, 0, sizeof(*store));
+}
+
+double* sample_store_append(sample_store* store) {
+    size_t slot;
+
+    if (store->max_rows > 0 && store->count == store->max_rows) {
+        // Ring mode: overwrite the oldest row
+        slot = store->start;
+        store->start = (store->start + 1) % store->max_rows;
+        store->dropped++;
+    } else {
+        if (store->count == store->capacity) {
+            size_t rows = store->capacity > 0 ? store->capacity * 2 : SAMPLE_STORE_INITIAL_ROWS;
+            if (store->max_rows > 0 && rows > store->max_rows) {
+                rows = store->max_rows;
+            }
+            double* grown = (double*)realloc(store->rows, rows * store->width * sizeof(double));
+            if (grown == NULL) {
+                return NULL;
+            }
+            store->rows = grown;
+            store->capacity = rows;
+        }
+        // The store only grows before the ring first wraps, while start is 0
+        slot = store->max_rows > 0 ? (store->start + store->count) % store->max_rows
+                                   : store->count;
+        store->count++;
+    }
+    return store->rows + slot * store->width;
+}
+
+const double* sample_store_row(const sample_store* store, size_t k) {
+    size_t slot = store->max_rows > 0 ? (store->start + k) % store->max_rows : k;
+    return store->rows + slot * store->width;
+}
+
+void sample_store_truncate(sample_store* store, size_t step) {
+    while (store->count > 0 && sample_store_row(store, store->count - 1)[1] > (double)step) {
+        store->count--;
+    }
+}
+
+void sample_store_clear(sample_store* store) {
+    store->start = 0;
+    store->count = 0;
+    store->dropped = 0;
+}
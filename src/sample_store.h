@@ -0,0 +1,39 @@
+/*
+ * Row store for in-loop time series
+ *
+ * Fixed-width rows of doubles appended from the step loop. The store grows
+ * on demand or, with a row limit, acts as a ring buffer keeping the newest
+ * rows. By convention column 0 is the time and column 1 the step, so rows
+ * recorded after a rolled-back step can be dropped.
+ */
+
+#ifndef CFD_PYTHON_SAMPLE_STORE_H
+#define CFD_PYTHON_SAMPLE_STORE_H
+
+#include <stddef.h>
+
+typedef struct {
+    size_t width;     // Doubles per row
+    size_t max_rows;  // Ring capacity; 0 grows without limit
+    double* rows;
+    size_t capacity;  // Allocated rows
+    size_t start;     // Oldest row
+    size_t count;     // Stored rows
+    size_t dropped;   // Rows overwritten in ring mode
+} sample_store;
+
+void sample_store_init(sample_store* store, size_t width, size_t max_rows);
+void sample_store_free(sample_store* store);
+
+// Slot for a new row (overwriting the oldest in ring mode); NULL if the store cannot grow
+double* sample_store_append(sample_store* store);
+
+// k-th stored row, oldest first
+const double* sample_store_row(const sample_store* store, size_t k);
+
+// Drop trailing rows whose step column is greater than `step`
+void sample_store_truncate(sample_store* store, size_t step);
+
+void sample_store_clear(sample_store* store);
+
+#endif  // CFD_PYTHON_SAMPLE_STORE_H
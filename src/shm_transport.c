@@ -0,0 +1,235 @@
+/*
+ * Shared-memory result transport (POSIX shm_open/mmap)
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "shm_transport.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define CFD_SHM_NAME_MAX 255
+
+static size_t align_up(size_t value) {
+    return (value + CFD_SHM_ALIGNMENT - 1) & ~(size_t)(CFD_SHM_ALIGNMENT - 1);
+}
+
+/*
+ * Normalize a segment name to the "/name" form expected by shm_open.
+ * Names must be non-empty and must not contain further slashes.
+ */
+static int normalize_name(const char* name, char* out, size_t out_size) {
+    if (name == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (name[0] == '/') {
+        name++;
+    }
+    if (name[0] == '\0' || strchr(name, '/') != NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    int written = snprintf(out, out_size, "/%s", name);
+    if (written < 0 || (size_t)written >= out_size) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    return 0;
+}
+
+const cfd_shm_header* cfd_shm_get_header(const cfd_shm_segment* seg) {
+    return (const cfd_shm_header*)seg->base;
+}
+
+double* cfd_shm_field_data(const cfd_shm_segment* seg, int index) {
+    const cfd_shm_header* header = cfd_shm_get_header(seg);
+    if (index < 0 || (uint32_t)index >= header->num_fields) {
+        return NULL;
+    }
+    return (double*)((char*)seg->base + header->fields[index].offset);
+}
+
+#ifdef _WIN32
+
+int cfd_shm_supported(void) {
+    return 0;
+}
+
+int cfd_shm_create(const char* name, size_t nx, size_t ny,
+                   const char* const* field_names, int num_fields,
+                   cfd_shm_segment* seg) {
+    (void)name; (void)nx; (void)ny; (void)field_names; (void)num_fields; (void)seg;
+    errno = ENOSYS;
+    return -1;
+}
+
+int cfd_shm_attach(const char* name, cfd_shm_segment* seg) {
+    (void)name; (void)seg;
+    errno = ENOSYS;
+    return -1;
+}
+
+void cfd_shm_detach(cfd_shm_segment* seg) {
+    (void)seg;
+}
+
+int cfd_shm_unlink(const char* name) {
+    (void)name;
+    errno = ENOSYS;
+    return -1;
+}
+
+#else
+
+int cfd_shm_supported(void) {
+    return 1;
+}
+
+int cfd_shm_create(const char* name, size_t nx, size_t ny,
+                   const char* const* field_names, int num_fields,
+                   cfd_shm_segment* seg) {
+    char shm_name[CFD_SHM_NAME_MAX + 2];
+    if (normalize_name(name, shm_name, sizeof(shm_name)) < 0) {
+        return -1;
+    }
+    if (num_fields <= 0 || num_fields > CFD_SHM_MAX_FIELDS || nx == 0 || ny == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (nx > SIZE_MAX / ny || nx * ny > SIZE_MAX / sizeof(double) / (size_t)num_fields) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+
+    size_t count = nx * ny;
+    size_t field_bytes = align_up(count * sizeof(double));
+    size_t total_size = align_up(sizeof(cfd_shm_header)) + field_bytes * (size_t)num_fields;
+
+    int fd = shm_open(shm_name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)total_size) < 0) {
+        int saved = errno;
+        close(fd);
+        shm_unlink(shm_name);
+        errno = saved;
+        return -1;
+    }
+
+    void* base = mmap(NULL, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int saved = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(shm_name);
+        errno = saved;
+        return -1;
+    }
+
+    cfd_shm_header* header = (cfd_shm_header*)base;
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, CFD_SHM_MAGIC, sizeof(header->magic));
+    header->version = CFD_SHM_VERSION;
+    header->num_fields = (uint32_t)num_fields;
+    header->nx = nx;
+    header->ny = ny;
+    header->total_size = total_size;
+
+    size_t offset = align_up(sizeof(cfd_shm_header));
+    for (int i = 0; i < num_fields; i++) {
+        strncpy(header->fields[i].name, field_names[i], CFD_SHM_FIELD_NAME_LEN - 1);
+        header->fields[i].offset = offset;
+        header->fields[i].count = count;
+        offset += field_bytes;
+    }
+
+    seg->base = base;
+    seg->size = total_size;
+    return 0;
+}
+
+int cfd_shm_attach(const char* name, cfd_shm_segment* seg) {
+    char shm_name[CFD_SHM_NAME_MAX + 2];
+    if (normalize_name(name, shm_name, sizeof(shm_name)) < 0) {
+        return -1;
+    }
+
+    int fd = shm_open(shm_name, O_RDWR, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    if (size < sizeof(cfd_shm_header)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int saved = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        errno = saved;
+        return -1;
+    }
+
+    // Validate the header so a foreign or truncated segment is rejected
+    const cfd_shm_header* header = (const cfd_shm_header*)base;
+    int valid = memcmp(header->magic, CFD_SHM_MAGIC, sizeof(header->magic)) == 0 &&
+                header->version == CFD_SHM_VERSION &&
+                header->num_fields > 0 && header->num_fields <= CFD_SHM_MAX_FIELDS &&
+                header->total_size <= size;
+    for (uint32_t i = 0; valid && i < header->num_fields; i++) {
+        const cfd_shm_field_desc* f = &header->fields[i];
+        valid = f->offset % CFD_SHM_ALIGNMENT == 0 &&
+                f->offset <= header->total_size &&
+                f->count <= (header->total_size - f->offset) / sizeof(double) &&
+                memchr(f->name, '\0', CFD_SHM_FIELD_NAME_LEN) != NULL;
+    }
+    if (!valid) {
+        munmap(base, size);
+        errno = EINVAL;
+        return -1;
+    }
+
+    seg->base = base;
+    seg->size = size;
+    return 0;
+}
+
+void cfd_shm_detach(cfd_shm_segment* seg) {
+    if (seg->base != NULL) {
+        munmap(seg->base, seg->size);
+        seg->base = NULL;
+        seg->size = 0;
+    }
+}
+
+int cfd_shm_unlink(const char* name) {
+    char shm_name[CFD_SHM_NAME_MAX + 2];
+    if (normalize_name(name, shm_name, sizeof(shm_name)) < 0) {
+        return -1;
+    }
+    return shm_unlink(shm_name);
+}
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * Shared-memory result transport
+ *
+ * Named POSIX shared-memory segments holding simulation result fields.
+ * A worker process creates a segment and writes fields straight into it;
+ * the parent attaches by name and reads the fields without copying.
+ *
+ * Segment layout (all offsets relative to segment start):
+ *   [cfd_shm_header][pad to 64][field 0][pad to 64][field 1]...
+ *
+ * Each field is a contiguous row-major array of nx*ny doubles.
+ */
+
+#ifndef CFD_PYTHON_SHM_TRANSPORT_H
+#define CFD_PYTHON_SHM_TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CFD_SHM_MAGIC "CFDSHM01"
+#define CFD_SHM_VERSION 1
+#define CFD_SHM_MAX_FIELDS 8
+#define CFD_SHM_FIELD_NAME_LEN 32
+#define CFD_SHM_ALIGNMENT 64
+
+typedef struct {
+    char name[CFD_SHM_FIELD_NAME_LEN];
+    uint64_t offset;  // Byte offset from segment start (64-byte aligned)
+    uint64_t count;   // Number of doubles
+} cfd_shm_field_desc;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_fields;
+    uint64_t nx;
+    uint64_t ny;
+    uint64_t total_size;
+    cfd_shm_field_desc fields[CFD_SHM_MAX_FIELDS];
+} cfd_shm_header;
+
+typedef struct {
+    void* base;
+    size_t size;
+} cfd_shm_segment;
+
+/*
+ * All functions return 0 on success and -1 on failure with errno set.
+ * Names may be given with or without the leading '/' required by POSIX,
+ * so names from multiprocessing.shared_memory can be used directly.
+ */
+
+// Returns 1 if named shared memory is supported on this platform
+int cfd_shm_supported(void);
+
+// Create a new segment (fails with EEXIST if the name is taken) and map it
+int cfd_shm_create(const char* name, size_t nx, size_t ny,
+                   const char* const* field_names, int num_fields,
+                   cfd_shm_segment* seg);
+
+// Map an existing segment and validate its header
+int cfd_shm_attach(const char* name, cfd_shm_segment* seg);
+
+// Header and field accessors for a mapped segment
+const cfd_shm_header* cfd_shm_get_header(const cfd_shm_segment* seg);
+double* cfd_shm_field_data(const cfd_shm_segment* seg, int index);
+
+// Unmap the segment; the name stays valid until cfd_shm_unlink()
+void cfd_shm_detach(cfd_shm_segment* seg);
+
+// Remove the segment name; existing mappings stay valid
+int cfd_shm_unlink(const char* name);
+
+#endif  // CFD_PYTHON_SHM_TRANSPORT_H
@@ -0,0 +1,432 @@
+/*
+ * Memory-mapped snapshot store (stdio writer, POSIX mmap reader)
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "snapshot_store.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "field_codec.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+static const unsigned char k_zero_pad[CFD_STORE_ALIGNMENT];
+
+static uint64_t align_up(uint64_t value) {
+    return (value + CFD_STORE_ALIGNMENT - 1) & ~(uint64_t)(CFD_STORE_ALIGNMENT - 1);
+}
+
+// Stores grow past 2 GiB, beyond what fseek() can address on every platform
+static int seek_to(FILE* f, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(f, (__int64)offset, SEEK_SET);
+#else
+    return fseeko(f, (off_t)offset, SEEK_SET);
+#endif
+}
+
+static uint64_t data_offset(void) {
+    return align_up(sizeof(cfd_store_header));
+}
+
+// Check a header read from disk or memory against what this version writes
+static int header_valid(const cfd_store_header* header) {
+    return memcmp(header->magic, CFD_STORE_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == CFD_STORE_VERSION &&
+           header->num_fields == CFD_STORE_NUM_FIELDS &&
+           header->nx > 0 && header->ny > 0 && header->nx <= UINT64_MAX / header->ny &&
+           header->nx * header->ny <= (UINT64_MAX / 4) / sizeof(double) &&
+           header->data_offset == data_offset() &&
+           header->data_end >= header->data_offset &&
+           (header->num_records == 0) == (header->data_end == header->data_offset);
+}
+
+// Offset of field `field` from the start of its record
+static uint64_t field_offset(const cfd_store_record* record, int field) {
+    uint64_t offset = sizeof(cfd_store_record);
+    for (int k = 0; k < field; k++) {
+        offset += align_up(record->field_bytes[k]);
+    }
+    return offset;
+}
+
+static int write_header(FILE* f, const cfd_store_header* header) {
+    size_t pad = (size_t)(data_offset() - sizeof(*header));
+    if (seek_to(f, 0) != 0 || fwrite(header, sizeof(*header), 1, f) != 1 ||
+        (pad > 0 && fwrite(k_zero_pad, 1, pad, f) != pad)) {
+        return -1;
+    }
+    return 0;
+}
+
+static int fail_close(cfd_store_writer* writer) {
+    int saved = errno != 0 ? errno : EIO;
+    fclose(writer->file);
+    writer->file = NULL;
+    errno = saved;
+    return -1;
+}
+
+// Continue an existing store; returns 1 if `f` holds none to continue
+static int resume(cfd_store_writer* writer) {
+    cfd_store_header header;
+    FILE* f = writer->file;
+    if (fread(&header, sizeof(header), 1, f) != 1) {
+        if (ferror(f)) {
+            return -1;
+        }
+        // An empty file is started afresh; anything shorter than a header is not a store
+        if (seek_to(f, 0) != 0) {
+            return -1;
+        }
+        if (fgetc(f) == EOF && !ferror(f)) {
+            return 1;
+        }
+        errno = EINVAL;
+        return -1;
+    }
+    if (!header_valid(&header) || header.nx != writer->nx || header.ny != writer->ny) {
+        errno = EINVAL;
+        return -1;
+    }
+    writer->num_records = header.num_records;
+    writer->data_end = header.data_end;
+    writer->last_step = header.last_step;
+    // A partial record left by an interrupted writer is overwritten
+    return seek_to(f, header.data_end) == 0 ? 0 : -1;
+}
+
+int cfd_store_writer_open(cfd_store_writer* writer, const char* filename, size_t nx, size_t ny,
+                          int append) {
+    memset(writer, 0, sizeof(*writer));
+    writer->nx = nx;
+    writer->ny = ny;
+    writer->data_end = data_offset();
+    if (nx == 0 || ny == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (nx > SIZE_MAX / ny || nx * ny > (SIZE_MAX / 4) / sizeof(double)) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+
+    errno = 0;
+    int fresh = 1;
+    if (append) {
+        writer->file = fopen(filename, "r+b");
+        if (writer->file != NULL) {
+            fresh = resume(writer);
+            if (fresh < 0) {
+                return fail_close(writer);
+            }
+        } else if (errno != ENOENT) {
+            return -1;
+        }
+    }
+    if (writer->file == NULL) {
+        writer->file = fopen(filename, "w+b");
+        if (writer->file == NULL) {
+            return -1;
+        }
+    }
+    if (fresh) {
+        cfd_store_header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CFD_STORE_MAGIC, sizeof(header.magic));
+        header.version = CFD_STORE_VERSION;
+        header.num_fields = CFD_STORE_NUM_FIELDS;
+        header.nx = nx;
+        header.ny = ny;
+        header.data_offset = data_offset();
+        header.data_end = data_offset();
+        if (write_header(writer->file, &header) < 0) {
+            return fail_close(writer);
+        }
+    }
+    return 0;
+}
+
+int cfd_store_writer_append(cfd_store_writer* writer, uint64_t step, double time,
+                            const double* u, const double* v, const double* p, int codec,
+                            const double* max_error) {
+    if (writer->file == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+    if ((writer->num_records > 0 && step <= writer->last_step) ||
+        (codec != CFD_STORE_RAW && codec != CFD_STORE_LOSSLESS && codec != CFD_STORE_LOSSY) ||
+        (codec == CFD_STORE_LOSSY && max_error == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    FILE* f = writer->file;
+    size_t count = (size_t)(writer->nx * writer->ny);
+    const double* fields[CFD_STORE_NUM_FIELDS] = {u, v, p};
+    const void* payloads[CFD_STORE_NUM_FIELDS];
+
+    cfd_store_record record;
+    memset(&record, 0, sizeof(record));
+    record.step = step;
+    record.time = time;
+    record.offset = writer->data_end;
+    record.codec = (uint32_t)codec;
+    record.size = sizeof(record);
+    if (codec != CFD_STORE_RAW) {
+        size_t bound = field_codec_bound(count);
+        if (writer->scratch == NULL) {
+            writer->scratch = (unsigned char*)malloc(bound * CFD_STORE_NUM_FIELDS);
+            if (writer->scratch == NULL) {
+                errno = ENOMEM;
+                return -1;
+            }
+        }
+        for (int k = 0; k < CFD_STORE_NUM_FIELDS; k++) {
+            size_t size;
+            unsigned char* dst = writer->scratch + (size_t)k * bound;
+            double bound_k = codec == CFD_STORE_LOSSY ? max_error[k] : 0.0;
+            if (field_codec_encode(fields[k], count, bound_k, dst, &size) < 0) {
+                return -1;
+            }
+            payloads[k] = dst;
+            record.field_bytes[k] = size;
+        }
+    } else {
+        for (int k = 0; k < CFD_STORE_NUM_FIELDS; k++) {
+            payloads[k] = fields[k];
+            record.field_bytes[k] = count * sizeof(double);
+        }
+    }
+    for (int k = 0; k < CFD_STORE_NUM_FIELDS; k++) {
+        record.size += align_up(record.field_bytes[k]);
+    }
+
+    // A failed append may have left the position past the committed data
+    if (seek_to(f, writer->data_end) != 0 || fwrite(&record, sizeof(record), 1, f) != 1) {
+        return -1;
+    }
+    for (int k = 0; k < CFD_STORE_NUM_FIELDS; k++) {
+        size_t nbytes = (size_t)record.field_bytes[k];
+        size_t pad = (size_t)(align_up(nbytes) - nbytes);
+        if (fwrite(payloads[k], 1, nbytes, f) != nbytes ||
+            (pad > 0 && fwrite(k_zero_pad, 1, pad, f) != pad)) {
+            return -1;
+        }
+    }
+
+    // Publish the record only once all of it has been written
+    uint64_t commit[3] = {writer->num_records + 1, record.offset + record.size, step};
+    if (seek_to(f, offsetof(cfd_store_header, num_records)) != 0 ||
+        fwrite(commit, sizeof(commit), 1, f) != 1 ||
+        seek_to(f, commit[1]) != 0) {
+        return -1;
+    }
+    writer->num_records = commit[0];
+    writer->data_end = commit[1];
+    writer->last_step = step;
+    for (int k = 0; k < CFD_STORE_NUM_FIELDS; k++) {
+        writer->raw_bytes += count * sizeof(double);
+        writer->stored_bytes += record.field_bytes[k];
+    }
+    return 0;
+}
+
+int cfd_store_writer_flush(cfd_store_writer* writer) {
+    if (writer->file == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+    return fflush(writer->file) == 0 ? 0 : -1;
+}
+
+int cfd_store_writer_close(cfd_store_writer* writer) {
+    int rc = 0;
+    if (writer->file != NULL) {
+        rc = fclose(writer->file) == 0 ? 0 : -1;
+        writer->file = NULL;
+    }
+    free(writer->scratch);
+    writer->scratch = NULL;
+    return rc;
+}
+
+ptrdiff_t cfd_store_find(const cfd_store_map* map, uint64_t step) {
+    size_t lo = 0, hi = map->num_records;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (map->index[mid].step < step) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < map->num_records && map->index[lo].step == step ? (ptrdiff_t)lo : -1;
+}
+
+const cfd_store_record* cfd_store_get_record(const cfd_store_map* map, size_t record) {
+    if (record >= map->num_records) {
+        return NULL;
+    }
+    return (const cfd_store_record*)((const char*)map->base + map->index[record].offset);
+}
+
+const double* cfd_store_field(const cfd_store_map* map, size_t record, int field) {
+    const cfd_store_record* header = cfd_store_get_record(map, record);
+    if (header == NULL || header->codec != CFD_STORE_RAW || field < 0 ||
+        field >= CFD_STORE_NUM_FIELDS) {
+        return NULL;
+    }
+    return (const double*)((const char*)header + field_offset(header, field));
+}
+
+int cfd_store_read_field(const cfd_store_map* map, size_t record, int field, double* out) {
+    const cfd_store_record* header = cfd_store_get_record(map, record);
+    if (header == NULL || field < 0 || field >= CFD_STORE_NUM_FIELDS) {
+        errno = EINVAL;
+        return -1;
+    }
+    const char* data = (const char*)header + field_offset(header, field);
+    size_t count = (size_t)(map->nx * map->ny);
+    if (header->codec == CFD_STORE_RAW) {
+        memcpy(out, data, count * sizeof(double));
+        return 0;
+    }
+    return field_codec_decode(data, (size_t)header->field_bytes[field], out, count);
+}
+
+#ifdef _WIN32
+
+int cfd_store_map_open(const char* filename, cfd_store_map* map) {
+    (void)filename;
+    memset(map, 0, sizeof(*map));
+    errno = ENOSYS;
+    return -1;
+}
+
+void cfd_store_map_close(cfd_store_map* map) {
+    (void)map;
+}
+
+#else
+
+// Check the header of a mapped record of `count`-value fields found at `offset`
+static int record_valid(const cfd_store_record* record, uint64_t offset, uint64_t count) {
+    if (record->offset != offset ||
+        (record->codec != CFD_STORE_RAW && record->codec != CFD_STORE_LOSSLESS &&
+         record->codec != CFD_STORE_LOSSY)) {
+        return 0;
+    }
+    uint64_t size = sizeof(cfd_store_record);
+    for (int k = 0; k < CFD_STORE_NUM_FIELDS; k++) {
+        uint64_t nbytes = record->field_bytes[k];
+        uint64_t most = record->codec == CFD_STORE_RAW ? count * sizeof(double)
+                                                       : field_codec_bound((size_t)count);
+        if (nbytes > most || (record->codec == CFD_STORE_RAW && nbytes != most)) {
+            return 0;
+        }
+        size += align_up(nbytes);
+    }
+    return size == record->size;
+}
+
+// Validate the mapped header and records and fill in the index
+static int build_index(cfd_store_map* map) {
+    const cfd_store_header* header = (const cfd_store_header*)map->base;
+    if (!header_valid(header) || header->data_offset > map->size) {
+        errno = EINVAL;
+        return -1;
+    }
+    // The header wins, but never trust it past the end of the file
+    uint64_t end = header->data_end < map->size ? header->data_end : map->size;
+    uint64_t most = (end - header->data_offset) / sizeof(cfd_store_record);
+    size_t capacity = (size_t)(header->num_records < most ? header->num_records : most);
+
+    map->nx = header->nx;
+    map->ny = header->ny;
+    map->index = (cfd_store_entry*)malloc((capacity > 0 ? capacity : 1) * sizeof(cfd_store_entry));
+    if (map->index == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    uint64_t offset = header->data_offset;
+    size_t count = 0;
+    while (count < capacity && end - offset >= sizeof(cfd_store_record)) {
+        const cfd_store_record* record =
+            (const cfd_store_record*)((const char*)map->base + offset);
+        if (!record_valid(record, offset, header->nx * header->ny) ||
+            (count > 0 && record->step <= map->index[count - 1].step)) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (record->size > end - offset) {
+            break;  // Cut off by an interrupted writer
+        }
+        map->index[count].step = record->step;
+        map->index[count].time = record->time;
+        map->index[count].offset = offset;
+        offset += record->size;
+        count++;
+    }
+    map->num_records = count;
+    return 0;
+}
+
+int cfd_store_map_open(const char* filename, cfd_store_map* map) {
+    memset(map, 0, sizeof(*map));
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    if (size < sizeof(cfd_store_header)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+
+    void* base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    int saved = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        errno = saved;
+        return -1;
+    }
+    map->base = base;
+    map->size = size;
+    if (build_index(map) < 0) {
+        saved = errno;
+        cfd_store_map_close(map);
+        errno = saved;
+        return -1;
+    }
+    return 0;
+}
+
+void cfd_store_map_close(cfd_store_map* map) {
+    if (map->base != NULL) {
+        munmap(map->base, map->size);
+    }
+    free(map->index);
+    memset(map, 0, sizeof(*map));
+}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Memory-mapped snapshot store
+ *
+ * One append-only file holding every u, v, p snapshot of a run, written
+ * sequentially and read back through mmap so that any step can be looked
+ * up without parsing or copying.
+ *
+ * File layout (all offsets from the start of the file, native byte order):
+ *   [cfd_store_header][pad to 64][record 0][record 1]...
+ *
+ * Each record is
+ *   [cfd_store_record][u][pad to 64][v][pad to 64][p][pad to 64]
+ *
+ * Raw records hold each field as a contiguous row-major array of nx*ny
+ * doubles starting on a 64-byte boundary. Compressed records hold a
+ * field_codec stream per field instead, lossless or error-bounded, and
+ * are decoded on access. Steps
+ * are strictly increasing, so the index built from the record headers can
+ * be binary searched. The header's record count and end offset are
+ * updated after each record is complete; a reader ignores any partial
+ * record left behind by an interrupted writer.
+ */
+
+#ifndef CFD_PYTHON_SNAPSHOT_STORE_H
+#define CFD_PYTHON_SNAPSHOT_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define CFD_STORE_MAGIC "CFDSTOR1"
+#define CFD_STORE_VERSION 1
+#define CFD_STORE_NUM_FIELDS 3  // u, v, p
+#define CFD_STORE_ALIGNMENT 64
+
+// Record encodings
+#define CFD_STORE_RAW 0
+#define CFD_STORE_LOSSLESS 1  // field_codec streams
+#define CFD_STORE_LOSSY 2     // field_codec streams with per-field error bounds
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_fields;
+    uint64_t nx;
+    uint64_t ny;
+    uint64_t data_offset;  // Offset of record 0
+    // Updated together once a record is complete
+    uint64_t num_records;
+    uint64_t data_end;     // Offset just past the last complete record
+    uint64_t last_step;    // Valid when num_records > 0
+} cfd_store_header;
+
+typedef struct {
+    uint64_t step;
+    double time;
+    uint64_t offset;  // Offset of this record, checked when reading
+    uint64_t size;    // Bytes up to the next record, a multiple of 64
+    uint64_t field_bytes[CFD_STORE_NUM_FIELDS];
+    uint32_t codec;   // CFD_STORE_RAW, CFD_STORE_LOSSLESS or CFD_STORE_LOSSY
+    uint32_t reserved;
+} cfd_store_record;
+
+// One index entry of a mapped store
+typedef struct {
+    uint64_t step;
+    double time;
+    uint64_t offset;
+} cfd_store_entry;
+
+typedef struct {
+    FILE* file;  // NULL once closed
+    uint64_t nx, ny;
+    uint64_t num_records;
+    uint64_t data_end;
+    uint64_t last_step;   // Valid when num_records > 0
+    unsigned char* scratch;  // Encoded fields of compressed records
+    // Field bytes of the records appended since open, before and after encoding
+    uint64_t raw_bytes;
+    uint64_t stored_bytes;
+} cfd_store_writer;
+
+typedef struct {
+    void* base;
+    size_t size;
+    uint64_t nx, ny;
+    size_t num_records;
+    cfd_store_entry* index;
+} cfd_store_map;
+
+/*
+ * All functions returning int return 0 on success and -1 on failure with
+ * errno set; EINVAL marks a file that is not a valid store.
+ */
+
+/*
+ * Create `filename`, or with `append` continue an existing store of the
+ * same dimensions (a missing file is created).
+ */
+int cfd_store_writer_open(cfd_store_writer* writer, const char* filename, size_t nx, size_t ny,
+                          int append);
+
+/*
+ * Append one record encoded with `codec`; `step` must be larger than the
+ * last step written. CFD_STORE_LOSSY takes the absolute error bound of
+ * u, v and p in `max_error` (0 keeps that field lossless); other codecs
+ * ignore it.
+ */
+int cfd_store_writer_append(cfd_store_writer* writer, uint64_t step, double time,
+                            const double* u, const double* v, const double* p, int codec,
+                            const double* max_error);
+
+int cfd_store_writer_flush(cfd_store_writer* writer);
+
+// Flush and close; safe to call on a closed writer
+int cfd_store_writer_close(cfd_store_writer* writer);
+
+// Map a store read-only, validate it and build its index (ENOSYS on Windows)
+int cfd_store_map_open(const char* filename, cfd_store_map* map);
+
+// Position of `step` in the index, or -1 if it was not stored
+ptrdiff_t cfd_store_find(const cfd_store_map* map, uint64_t step);
+
+// Header of the record at index position `record`
+const cfd_store_record* cfd_store_get_record(const cfd_store_map* map, size_t record);
+
+/*
+ * Field `field` (0 = u, 1 = v, 2 = p) of a raw record, or NULL if the
+ * record is compressed
+ */
+const double* cfd_store_field(const cfd_store_map* map, size_t record, int field);
+
+// Copy or decode field `field` of a record into nx*ny doubles at `out`
+int cfd_store_read_field(const cfd_store_map* map, size_t record, int field, double* out);
+
+void cfd_store_map_close(cfd_store_map* map);
+
+#endif  // CFD_PYTHON_SNAPSHOT_STORE_H
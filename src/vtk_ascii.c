@@ -0,0 +1,77 @@
+/*
+ * Legacy VTK writer, ASCII encoding
+ */
+
+#include "vtk_ascii.h"
+
+#include <errno.h>
+#include <stdio.h>
+
+#include "double_format.h"
+
+static int write_scalars(FILE* f, const char* name, const double* data, size_t count,
+                         int precision) {
+    if (fprintf(f, "SCALARS %s double 1\nLOOKUP_TABLE default\n", name) < 0) {
+        return -1;
+    }
+    const double* comps[1] = {data};
+    return double_format_lines(f, comps, 1, count, precision);
+}
+
+static int write_vectors(FILE* f, const char* name, const double* u, const double* v,
+                         const double* w, size_t count, int precision) {
+    if (fprintf(f, "VECTORS %s double\n", name) < 0) {
+        return -1;
+    }
+    const double* comps[3] = {u, v, w};
+    return double_format_lines(f, comps, 3, count, precision);
+}
+
+// Close the file, keeping the first error (write or close) in errno
+static int finish(FILE* f, int rc) {
+    int saved = errno;
+    if (fclose(f) != 0 && rc == 0) {
+        return -1;
+    }
+    if (rc != 0) {
+        errno = saved != 0 ? saved : EIO;
+    }
+    return rc;
+}
+
+int vtk_ascii_write_scalar(const char* filename, const char* name, const double* data,
+                           const vtk_geometry* geom, int precision) {
+    FILE* f = vtk_legacy_open(filename, geom, "ASCII");
+    if (f == NULL) {
+        return -1;
+    }
+    errno = 0;
+    return finish(f, write_scalars(f, name, data, geom->nx * geom->ny * geom->nz, precision));
+}
+
+int vtk_ascii_write_vector(const char* filename, const char* name, const double* u,
+                           const double* v, const double* w, const vtk_geometry* geom,
+                           int precision) {
+    FILE* f = vtk_legacy_open(filename, geom, "ASCII");
+    if (f == NULL) {
+        return -1;
+    }
+    errno = 0;
+    return finish(f,
+                  write_vectors(f, name, u, v, w, geom->nx * geom->ny * geom->nz, precision));
+}
+
+int vtk_ascii_write_flow(const char* filename, const double* u, const double* v,
+                         const double* p, const vtk_geometry* geom, int precision) {
+    FILE* f = vtk_legacy_open(filename, geom, "ASCII");
+    if (f == NULL) {
+        return -1;
+    }
+    size_t count = geom->nx * geom->ny * geom->nz;
+    errno = 0;
+    int rc = write_vectors(f, "velocity", u, v, NULL, count, precision);
+    if (rc == 0) {
+        rc = write_scalars(f, "pressure", p, count, precision);
+    }
+    return finish(f, rc);
+}
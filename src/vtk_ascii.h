@@ -0,0 +1,29 @@
+/*
+ * Legacy VTK writer, ASCII encoding
+ *
+ * Writes the same STRUCTURED_POINTS datasets as the BINARY writers in
+ * vtk_binary.h, with the point data as text from double_format_lines():
+ * shortest round-trip digits by default, so the file holds the exact
+ * doubles, or `precision` significant digits for smaller previews.
+ */
+
+#ifndef CFD_PYTHON_VTK_ASCII_H
+#define CFD_PYTHON_VTK_ASCII_H
+
+#include "vtk_binary.h"
+
+/*
+ * All writers return 0 on success and -1 on failure with errno set.
+ * A NULL w writes zeros for the third vector component.
+ */
+int vtk_ascii_write_scalar(const char* filename, const char* name, const double* data,
+                           const vtk_geometry* geom, int precision);
+int vtk_ascii_write_vector(const char* filename, const char* name, const double* u,
+                           const double* v, const double* w, const vtk_geometry* geom,
+                           int precision);
+
+// Velocity vectors (u, v, 0) named "velocity" and scalars named "pressure"
+int vtk_ascii_write_flow(const char* filename, const double* u, const double* v,
+                         const double* p, const vtk_geometry* geom, int precision);
+
+#endif  // CFD_PYTHON_VTK_ASCII_H
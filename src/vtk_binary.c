@@ -0,0 +1,168 @@
+/*
+ * Legacy VTK writer, BINARY encoding
+ */
+
+#include "vtk_binary.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Doubles converted per fwrite
+#define VTK_CHUNK 4096
+
+static int host_is_little_endian(void) {
+    const uint16_t probe = 1;
+    return *(const uint8_t*)&probe == 1;
+}
+
+static uint64_t swap64(uint64_t v) {
+    v = ((v & 0x00FF00FF00FF00FFULL) << 8) | ((v >> 8) & 0x00FF00FF00FF00FFULL);
+    v = ((v & 0x0000FFFF0000FFFFULL) << 16) | ((v >> 16) & 0x0000FFFF0000FFFFULL);
+    return (v << 32) | (v >> 32);
+}
+
+/*
+ * Write `count` points of `ncomp` interleaved components, taken from the
+ * component arrays (NULL components are written as zero), as big-endian
+ * doubles. The branch-free swap loop is left for the compiler to vectorize.
+ */
+static int write_components(FILE* f, const double* const* comps, int ncomp, size_t count) {
+    uint64_t chunk[VTK_CHUNK];
+    size_t per_chunk = VTK_CHUNK / (size_t)ncomp;
+    int swap = host_is_little_endian();
+
+    for (size_t start = 0; start < count; start += per_chunk) {
+        size_t n = count - start < per_chunk ? count - start : per_chunk;
+        for (int c = 0; c < ncomp; c++) {
+            const double* src = comps[c];
+            for (size_t i = 0; i < n; i++) {
+                double value = src != NULL ? src[start + i] : 0.0;
+                memcpy(&chunk[i * (size_t)ncomp + (size_t)c], &value, sizeof(value));
+            }
+        }
+        size_t words = n * (size_t)ncomp;
+        if (swap) {
+            for (size_t i = 0; i < words; i++) {
+                chunk[i] = swap64(chunk[i]);
+            }
+        }
+        if (fwrite(chunk, sizeof(uint64_t), words, f) != words) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void vtk_geometry_from_bounds(vtk_geometry* geom, size_t nx, size_t ny, size_t nz,
+                              double xmin, double xmax, double ymin, double ymax,
+                              double zmin, double zmax) {
+    size_t n[3] = {nx, ny, nz};
+    double lo[3] = {xmin, ymin, zmin};
+    double hi[3] = {xmax, ymax, zmax};
+    geom->nx = nx;
+    geom->ny = ny;
+    geom->nz = nz;
+    for (int a = 0; a < 3; a++) {
+        geom->origin[a] = lo[a];
+        geom->spacing[a] = n[a] > 1 ? (hi[a] - lo[a]) / (double)(n[a] - 1) : 1.0;
+    }
+}
+
+FILE* vtk_legacy_open(const char* filename, const vtk_geometry* geom, const char* encoding) {
+    FILE* f = fopen(filename, "wb");
+    if (f == NULL) {
+        return NULL;
+    }
+    int rc = fprintf(f,
+                     "# vtk DataFile Version 3.0\n"
+                     "CFD\n"
+                     "%s\n"
+                     "DATASET STRUCTURED_POINTS\n"
+                     "DIMENSIONS %zu %zu %zu\n"
+                     "ORIGIN %.17g %.17g %.17g\n"
+                     "SPACING %.17g %.17g %.17g\n"
+                     "POINT_DATA %zu\n",
+                     encoding, geom->nx, geom->ny, geom->nz,
+                     geom->origin[0], geom->origin[1], geom->origin[2],
+                     geom->spacing[0], geom->spacing[1], geom->spacing[2],
+                     geom->nx * geom->ny * geom->nz);
+    if (rc < 0) {
+        int saved = errno;
+        fclose(f);
+        errno = saved;
+        return NULL;
+    }
+    return f;
+}
+
+static int write_scalars(FILE* f, const char* name, const double* data, size_t count) {
+    if (fprintf(f, "SCALARS %s double 1\nLOOKUP_TABLE default\n", name) < 0) {
+        return -1;
+    }
+    const double* comps[1] = {data};
+    if (write_components(f, comps, 1, count) < 0) {
+        return -1;
+    }
+    return fputc('\n', f) == EOF ? -1 : 0;
+}
+
+static int write_vectors(FILE* f, const char* name, const double* u, const double* v,
+                         const double* w, size_t count) {
+    if (fprintf(f, "VECTORS %s double\n", name) < 0) {
+        return -1;
+    }
+    const double* comps[3] = {u, v, w};
+    if (write_components(f, comps, 3, count) < 0) {
+        return -1;
+    }
+    return fputc('\n', f) == EOF ? -1 : 0;
+}
+
+// Close the file, keeping the first error (write or close) in errno
+static int finish(FILE* f, int rc) {
+    int saved = errno;
+    if (fclose(f) != 0 && rc == 0) {
+        return -1;
+    }
+    if (rc != 0) {
+        errno = saved != 0 ? saved : EIO;
+    }
+    return rc;
+}
+
+int vtk_binary_write_scalar(const char* filename, const char* name, const double* data,
+                            const vtk_geometry* geom) {
+    FILE* f = vtk_legacy_open(filename, geom, "BINARY");
+    if (f == NULL) {
+        return -1;
+    }
+    errno = 0;
+    return finish(f, write_scalars(f, name, data, geom->nx * geom->ny * geom->nz));
+}
+
+int vtk_binary_write_vector(const char* filename, const char* name, const double* u,
+                            const double* v, const double* w, const vtk_geometry* geom) {
+    FILE* f = vtk_legacy_open(filename, geom, "BINARY");
+    if (f == NULL) {
+        return -1;
+    }
+    errno = 0;
+    return finish(f, write_vectors(f, name, u, v, w, geom->nx * geom->ny * geom->nz));
+}
+
+int vtk_binary_write_flow(const char* filename, const double* u, const double* v,
+                          const double* p, const vtk_geometry* geom) {
+    FILE* f = vtk_legacy_open(filename, geom, "BINARY");
+    if (f == NULL) {
+        return -1;
+    }
+    size_t count = geom->nx * geom->ny * geom->nz;
+    errno = 0;
+    int rc = write_vectors(f, "velocity", u, v, NULL, count);
+    if (rc == 0) {
+        rc = write_scalars(f, "pressure", p, count);
+    }
+    return finish(f, rc);
+}
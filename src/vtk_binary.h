@@ -0,0 +1,48 @@
+/*
+ * Legacy VTK writer, BINARY encoding
+ *
+ * Writes the same STRUCTURED_POINTS datasets as the library's ASCII
+ * writers (write_vtk_output, write_vtk_vector_output, write_vtk_flow_field),
+ * but with the point data stored as big-endian float64 as the legacy format
+ * requires. Values are byte-swapped in fixed-size chunks on little-endian
+ * hosts and written with one fwrite per chunk.
+ */
+
+#ifndef CFD_PYTHON_VTK_BINARY_H
+#define CFD_PYTHON_VTK_BINARY_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+typedef struct {
+    size_t nx, ny, nz;
+    double origin[3];
+    double spacing[3];
+} vtk_geometry;
+
+// Uniform geometry spanning the given bounds (spacing 1 along axes with one point)
+void vtk_geometry_from_bounds(vtk_geometry* geom, size_t nx, size_t ny, size_t nz,
+                              double xmin, double xmax, double ymin, double ymax,
+                              double zmin, double zmax);
+
+/*
+ * Create `filename` and write the STRUCTURED_POINTS header up to POINT_DATA
+ * with the given encoding line ("ASCII" or "BINARY"). Returns NULL with
+ * errno set on failure.
+ */
+FILE* vtk_legacy_open(const char* filename, const vtk_geometry* geom, const char* encoding);
+
+/*
+ * All writers return 0 on success and -1 on failure with errno set.
+ * A NULL w writes zeros for the third vector component.
+ */
+int vtk_binary_write_scalar(const char* filename, const char* name, const double* data,
+                            const vtk_geometry* geom);
+int vtk_binary_write_vector(const char* filename, const char* name, const double* u,
+                            const double* v, const double* w, const vtk_geometry* geom);
+
+// Velocity vectors (u, v, 0) named "velocity" and scalars named "pressure"
+int vtk_binary_write_flow(const char* filename, const double* u, const double* v,
+                          const double* p, const vtk_geometry* geom);
+
+#endif  // CFD_PYTHON_VTK_BINARY_H
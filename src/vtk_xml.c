@@ -0,0 +1,403 @@
+/*
+ * VTK XML RectilinearGrid (.vtr) writer and ParaView collection (.pvd) index
+ */
+
+#include "vtk_xml.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef CFD_PYTHON_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// Doubles per fwrite chunk and per compressed block (32 KiB, the VTK default)
+#define VTR_BLOCK 4096
+
+static const char PVD_FOOTER[] = "  </Collection>\n</VTKFile>\n";
+
+/*
+ * One appended array: `tuples` points of `ncomp` components interleaved
+ * from separate component arrays
+ */
+typedef struct {
+    const double* comps[3];
+    size_t ncomp;
+    size_t count;     // Values (tuples * ncomp)
+    uint64_t offset;  // Byte offset inside the appended section
+
+    // Compressed blocks, one slot of `slot` bytes per block
+    unsigned char* blocks;
+    uint64_t* sizes;
+    size_t num_blocks;
+    size_t slot;
+} vtr_array;
+
+static const double zero_plane[1] = {0.0};
+
+static int host_is_little_endian(void) {
+    const uint16_t probe = 1;
+    return *(const uint8_t*)&probe == 1;
+}
+
+int vtk_xml_compression_available(void) {
+#ifdef CFD_PYTHON_HAVE_ZLIB
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+// Copy values [first, first + n) of an interleaved array into dst
+static void gather(const vtr_array* a, size_t first, size_t n, double* dst) {
+    if (a->ncomp == 1) {
+        memcpy(dst, a->comps[0] + first, n * sizeof(double));
+        return;
+    }
+    for (size_t k = 0; k < n; k++) {
+        size_t t = (first + k) / a->ncomp;
+        const double* src = a->comps[(first + k) % a->ncomp];
+        dst[k] = src != NULL ? src[t] : 0.0;
+    }
+}
+
+// Bytes the array occupies in the appended section, header included
+static uint64_t appended_size(const vtr_array* a, int compressed) {
+    if (!compressed) {
+        return sizeof(uint64_t) + (uint64_t)a->count * sizeof(double);
+    }
+    uint64_t total = (3 + (uint64_t)a->num_blocks) * sizeof(uint64_t);
+    for (size_t b = 0; b < a->num_blocks; b++) {
+        total += a->sizes[b];
+    }
+    return total;
+}
+
+#ifdef CFD_PYTHON_HAVE_ZLIB
+static size_t num_blocks(const vtr_array* a) {
+    return (a->count + VTR_BLOCK - 1) / VTR_BLOCK;
+}
+
+// Compress every block of an array in parallel, each into its own slot
+static int compress_array(vtr_array* a, int level) {
+    a->num_blocks = num_blocks(a);
+    a->slot = (size_t)compressBound(VTR_BLOCK * sizeof(double));
+    size_t alloc = a->num_blocks > 0 ? a->num_blocks : 1;
+    a->blocks = (unsigned char*)malloc(alloc * a->slot);
+    a->sizes = (uint64_t*)calloc(alloc, sizeof(uint64_t));
+    if (a->blocks == NULL || a->sizes == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    int failed = 0;
+
+    #pragma omp parallel
+    {
+        double* values = (double*)malloc(VTR_BLOCK * sizeof(double));
+        if (values == NULL) {
+            #pragma omp critical
+            failed = 1;
+        }
+        #pragma omp for schedule(dynamic)
+        for (ptrdiff_t b = 0; b < (ptrdiff_t)a->num_blocks; b++) {
+            if (values == NULL) {
+                continue;
+            }
+            size_t first = (size_t)b * VTR_BLOCK;
+            size_t n = a->count - first < VTR_BLOCK ? a->count - first : VTR_BLOCK;
+            gather(a, first, n, values);
+            uLongf len = (uLongf)a->slot;
+            if (compress2(a->blocks + (size_t)b * a->slot, &len, (const Bytef*)values,
+                          (uLong)(n * sizeof(double)), level) != Z_OK) {
+                #pragma omp critical
+                failed = 1;
+            }
+            a->sizes[b] = (uint64_t)len;
+        }
+        free(values);
+    }
+
+    if (failed) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+#endif
+
+static int write_raw(FILE* f, const vtr_array* a) {
+    double chunk[VTR_BLOCK];
+    uint64_t nbytes = (uint64_t)a->count * sizeof(double);
+    if (fwrite(&nbytes, sizeof(nbytes), 1, f) != 1) {
+        return -1;
+    }
+    for (size_t first = 0; first < a->count; first += VTR_BLOCK) {
+        size_t n = a->count - first < VTR_BLOCK ? a->count - first : VTR_BLOCK;
+        const double* src = chunk;
+        if (a->ncomp == 1) {
+            src = a->comps[0] + first;
+        } else {
+            gather(a, first, n, chunk);
+        }
+        if (fwrite(src, sizeof(double), n, f) != n) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int write_compressed(FILE* f, const vtr_array* a) {
+    size_t tail = a->count % VTR_BLOCK;
+    uint64_t header[3] = {(uint64_t)a->num_blocks, VTR_BLOCK * sizeof(double),
+                          (uint64_t)tail * sizeof(double)};
+    if (fwrite(header, sizeof(uint64_t), 3, f) != 3 ||
+        fwrite(a->sizes, sizeof(uint64_t), a->num_blocks, f) != a->num_blocks) {
+        return -1;
+    }
+    for (size_t b = 0; b < a->num_blocks; b++) {
+        if (fwrite(a->blocks + b * a->slot, 1, (size_t)a->sizes[b], f) != (size_t)a->sizes[b]) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Attribute values are XML-escaped
+static int write_escaped(FILE* f, const char* text) {
+    for (const char* c = text; *c != '\0'; c++) {
+        int rc;
+        switch (*c) {
+            case '&': rc = fputs("&amp;", f); break;
+            case '<': rc = fputs("&lt;", f); break;
+            case '>': rc = fputs("&gt;", f); break;
+            case '"': rc = fputs("&quot;", f); break;
+            default: rc = fputc(*c, f); break;
+        }
+        if (rc == EOF) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int write_data_array(FILE* f, const char* name, const vtr_array* a, const char* indent) {
+    if (fprintf(f, "%s<DataArray type=\"Float64\" Name=\"", indent) < 0 ||
+        write_escaped(f, name) < 0) {
+        return -1;
+    }
+    return fprintf(f, "\" NumberOfComponents=\"%zu\" format=\"appended\" offset=\"%llu\"/>\n",
+                   a->ncomp, (unsigned long long)a->offset) < 0 ? -1 : 0;
+}
+
+static int write_document(FILE* f, const vtk_xml_coords* coords, const vtk_xml_array* arrays,
+                          const vtr_array* data, size_t count, int compressed) {
+    const vtr_array* axes = data + count;
+    char extent[96];
+    snprintf(extent, sizeof(extent), "0 %zu 0 %zu 0 %zu", coords->nx - 1, coords->ny - 1,
+             coords->nz - 1);
+
+    if (fprintf(f,
+                "<?xml version=\"1.0\"?>\n"
+                "<VTKFile type=\"RectilinearGrid\" version=\"1.0\" byte_order=\"%s\" "
+                "header_type=\"UInt64\"%s>\n"
+                "  <RectilinearGrid WholeExtent=\"%s\">\n"
+                "    <Piece Extent=\"%s\">\n"
+                "      <PointData",
+                host_is_little_endian() ? "LittleEndian" : "BigEndian",
+                compressed ? " compressor=\"vtkZLibDataCompressor\"" : "", extent, extent) < 0) {
+        return -1;
+    }
+    // First scalar and first vector array are the active attributes
+    const char* active[2] = {"Scalars", "Vectors"};
+    for (int kind = 0; kind < 2; kind++) {
+        for (size_t k = 0; k < count; k++) {
+            if ((arrays[k].components == 3) == (kind == 1)) {
+                if (fprintf(f, " %s=\"", active[kind]) < 0 ||
+                    write_escaped(f, arrays[k].name) < 0 || fputc('"', f) == EOF) {
+                    return -1;
+                }
+                break;
+            }
+        }
+    }
+    if (fputs(">\n", f) == EOF) {
+        return -1;
+    }
+    for (size_t k = 0; k < count; k++) {
+        if (write_data_array(f, arrays[k].name, &data[k], "        ") < 0) {
+            return -1;
+        }
+    }
+    if (fputs("      </PointData>\n      <Coordinates>\n", f) == EOF ||
+        write_data_array(f, "x", &axes[0], "        ") < 0 ||
+        write_data_array(f, "y", &axes[1], "        ") < 0 ||
+        write_data_array(f, "z", &axes[2], "        ") < 0 ||
+        fputs("      </Coordinates>\n"
+              "    </Piece>\n"
+              "  </RectilinearGrid>\n"
+              "  <AppendedData encoding=\"raw\">\n"
+              "   _", f) == EOF) {
+        return -1;
+    }
+
+    for (size_t k = 0; k < count + 3; k++) {
+        if ((compressed ? write_compressed(f, &data[k]) : write_raw(f, &data[k])) < 0) {
+            return -1;
+        }
+    }
+    return fputs("\n  </AppendedData>\n</VTKFile>\n", f) == EOF ? -1 : 0;
+}
+
+static void free_arrays(vtr_array* data, size_t count) {
+    for (size_t k = 0; k < count; k++) {
+        free(data[k].blocks);
+        free(data[k].sizes);
+    }
+    free(data);
+}
+
+int vtk_xml_write_rectilinear(const char* filename, const vtk_xml_coords* coords,
+                              const vtk_xml_array* arrays, size_t count, int compress_level) {
+    if (coords->nx == 0 || coords->ny == 0 || coords->nz == 0 ||
+        (coords->z == NULL && coords->nz != 1) || compress_level < 0 || compress_level > 9) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (size_t k = 0; k < count; k++) {
+        if (arrays[k].components != 1 && arrays[k].components != 3) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+#ifndef CFD_PYTHON_HAVE_ZLIB
+    if (compress_level > 0) {
+        errno = ENOSYS;
+        return -1;
+    }
+#endif
+
+    // Point arrays followed by the x, y and z coordinate arrays
+    size_t points = coords->nx * coords->ny * coords->nz;
+    vtr_array* data = (vtr_array*)calloc(count + 3, sizeof(vtr_array));
+    if (data == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    for (size_t k = 0; k < count; k++) {
+        data[k].ncomp = (size_t)arrays[k].components;
+        data[k].count = points * data[k].ncomp;
+        memcpy(data[k].comps, arrays[k].data, data[k].ncomp * sizeof(double*));
+    }
+    const double* axes[3] = {coords->x, coords->y, coords->z != NULL ? coords->z : zero_plane};
+    size_t lengths[3] = {coords->nx, coords->ny, coords->nz};
+    for (int a = 0; a < 3; a++) {
+        data[count + (size_t)a].ncomp = 1;
+        data[count + (size_t)a].count = lengths[a];
+        data[count + (size_t)a].comps[0] = axes[a];
+    }
+
+    uint64_t offset = 0;
+    for (size_t k = 0; k < count + 3; k++) {
+#ifdef CFD_PYTHON_HAVE_ZLIB
+        if (compress_level > 0 && compress_array(&data[k], compress_level) < 0) {
+            free_arrays(data, count + 3);
+            return -1;
+        }
+#endif
+        data[k].offset = offset;
+        offset += appended_size(&data[k], compress_level > 0);
+    }
+
+    FILE* f = fopen(filename, "wb");
+    if (f == NULL) {
+        int saved = errno;
+        free_arrays(data, count + 3);
+        errno = saved;
+        return -1;
+    }
+    errno = 0;
+    int rc = write_document(f, coords, arrays, data, count, compress_level > 0);
+    int saved = errno;
+    free_arrays(data, count + 3);
+    if (fclose(f) != 0 && rc == 0) {
+        return -1;
+    }
+    if (rc != 0) {
+        errno = saved != 0 ? saved : EIO;
+    }
+    return rc;
+}
+
+static FILE* pvd_create(const char* filename) {
+    FILE* f = fopen(filename, "w+b");
+    if (f == NULL) {
+        return NULL;
+    }
+    if (fprintf(f,
+                "<?xml version=\"1.0\"?>\n"
+                "<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"%s\">\n"
+                "  <Collection>\n%s",
+                host_is_little_endian() ? "LittleEndian" : "BigEndian", PVD_FOOTER) < 0) {
+        int saved = errno;
+        fclose(f);
+        errno = saved;
+        return NULL;
+    }
+    return f;
+}
+
+// Position the file on its closing tags, checking they are ours
+static int pvd_seek_footer(FILE* f) {
+    long footer = (long)(sizeof(PVD_FOOTER) - 1);
+    char tail[sizeof(PVD_FOOTER)];
+    if (fseek(f, -footer, SEEK_END) != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (fread(tail, 1, (size_t)footer, f) != (size_t)footer ||
+        memcmp(tail, PVD_FOOTER, (size_t)footer) != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return fseek(f, -footer, SEEK_END);
+}
+
+int vtk_pvd_append(const char* filename, const char* dataset, double time, int part,
+                   int create_new) {
+    FILE* f = NULL;
+    if (!create_new) {
+        f = fopen(filename, "r+b");
+        if (f == NULL && errno != ENOENT) {
+            return -1;
+        }
+    }
+    if (f == NULL) {
+        f = pvd_create(filename);
+        if (f == NULL) {
+            return -1;
+        }
+    }
+
+    errno = 0;
+    int rc = pvd_seek_footer(f);
+    if (rc == 0) {
+        if (fprintf(f, "    <DataSet timestep=\"%.17g\" group=\"\" part=\"%d\" file=\"", time,
+                    part) < 0 ||
+            write_escaped(f, dataset) < 0 || fputs("\"/>\n", f) == EOF ||
+            fputs(PVD_FOOTER, f) == EOF) {
+            rc = -1;
+        }
+    }
+    int saved = errno;
+    if (fclose(f) != 0 && rc == 0) {
+        return -1;
+    }
+    if (rc != 0) {
+        errno = saved != 0 ? saved : EIO;
+    }
+    return rc;
+}
@@ -0,0 +1,54 @@
+/*
+ * VTK XML RectilinearGrid (.vtr) writer and ParaView collection (.pvd) index
+ *
+ * .vtr files carry the actual coordinate arrays, so stretched grids are
+ * written exactly. All arrays go to one appended section as raw
+ * native-endian float64 with UInt64 size headers, or, when the extension
+ * is built with zlib (CFD_PYTHON_HAVE_ZLIB), as 32 KiB blocks compressed
+ * in parallel in the vtkZLibDataCompressor layout.
+ *
+ * A .pvd collection stays a valid document after every append: the new
+ * DataSet entry overwrites the fixed closing tags, which are then written
+ * again, so the index grows without being rewritten.
+ */
+
+#ifndef CFD_PYTHON_VTK_XML_H
+#define CFD_PYTHON_VTK_XML_H
+
+#include <stddef.h>
+
+typedef struct {
+    const char* name;
+    int components;         // 1 (scalar) or 3 (vector)
+    const double* data[3];  // Component arrays; NULL components are written as zeros
+} vtk_xml_array;
+
+typedef struct {
+    const double* x;  // nx coordinates
+    const double* y;  // ny coordinates
+    const double* z;  // nz coordinates, or NULL for a single z = 0 plane (nz = 1)
+    size_t nx, ny, nz;
+} vtk_xml_coords;
+
+// Nonzero if compressed output is available in this build
+int vtk_xml_compression_available(void);
+
+/*
+ * Write point arrays on a rectilinear grid. compress_level 0 writes raw
+ * data; 1-9 selects the zlib level (ENOSYS without zlib).
+ * Returns 0 on success and -1 on failure with errno set.
+ */
+int vtk_xml_write_rectilinear(const char* filename, const vtk_xml_coords* coords,
+                              const vtk_xml_array* arrays, size_t count, int compress_level);
+
+/*
+ * Append one DataSet entry to a collection, creating it first if it does
+ * not exist or create_new is set. The dataset path is written as given;
+ * readers resolve it relative to the .pvd. Fails with EINVAL if an existing
+ * file does not end in the closing tags this writer produces.
+ * Returns 0 on success and -1 on failure with errno set.
+ */
+int vtk_pvd_append(const char* filename, const char* dataset, double time, int part,
+                   int create_new);
+
+#endif  // CFD_PYTHON_VTK_XML_H
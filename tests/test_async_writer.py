@@ -0,0 +1,159 @@
+"""
+Tests for the background snapshot writer
+"""
+
+import threading
+
+import pytest
+
+import cfd_python
+
+
+class TestAsyncWriter:
+    """Test AsyncWriter"""
+
+    def test_vtk_matches_synchronous(self, tmp_path):
+        """Test background VTK output equals Simulation.write_vtk()"""
+        sim = cfd_python.Simulation(16, 12)
+        sim.step(3)
+        sync_path = tmp_path / "sync.vtk"
+        async_path = tmp_path / "async.vtk"
+        sim.write_vtk(str(sync_path), binary=True)
+        with cfd_python.AsyncWriter() as writer:
+            writer.write(sim, str(async_path), binary=True)
+        assert async_path.read_bytes() == sync_path.read_bytes()
+
+    def test_snapshot_is_taken_at_call_time(self, tmp_path):
+        """Test stepping after write() does not change the queued snapshot"""
+        sim = cfd_python.Simulation(10, 10)
+        sim.step()
+        expected = tmp_path / "expected.vtr"
+        sim.write_vtr(str(expected))
+        with cfd_python.AsyncWriter(buffers=1) as writer:
+            writer.write(sim, str(tmp_path / "queued.vtr"), format="vtr")
+            sim.step(5)
+        assert (tmp_path / "queued.vtr").read_bytes() == expected.read_bytes()
+
+    def test_time_series_with_collection(self, tmp_path):
+        """Test many writes through a small pool land in order in the .pvd"""
+        sim = cfd_python.Simulation(12, 12)
+        pvd = tmp_path / "run.pvd"
+        with cfd_python.AsyncWriter(buffers=2) as writer:
+            for k in range(8):
+                sim.step()
+                writer.write(
+                    sim, str(tmp_path / f"flow_{k}.vtr"), format="vtr", collection=str(pvd)
+                )
+            writer.flush()
+            assert writer.pending == 0
+            stats = writer.stats
+        assert stats["submitted"] == stats["completed"] == 8
+        assert stats["failed"] == 0
+        text = pvd.read_text()
+        assert [f"flow_{k}.vtr" in text for k in range(8)] == [True] * 8
+        assert text.index("flow_0.vtr") < text.index("flow_7.vtr")
+
+    def test_csv_rows(self, tmp_path):
+        """Test CSV rows are appended in submission order"""
+        sim = cfd_python.Simulation(8, 8)
+        path = tmp_path / "series.csv"
+        with cfd_python.AsyncWriter() as writer:
+            writer.write(sim, str(path), format="csv", create_new=True)
+            for _ in range(3):
+                sim.step()
+                writer.write(sim, str(path), format="csv", factor=2)
+        assert len(path.read_text().splitlines()) >= 4
+
+    def test_failure_raised_on_flush(self, tmp_path):
+        """Test a failed background write raises OSError once, then clears"""
+        sim = cfd_python.Simulation(6, 6)
+        writer = cfd_python.AsyncWriter()
+        writer.write(sim, str(tmp_path / "missing" / "a.vtk"), binary=True)
+        with pytest.raises(OSError) as info:
+            writer.flush()
+        assert "missing" in str(info.value)
+        writer.flush()
+        assert writer.stats["failed"] == 1
+        writer.close()
+
+    def test_close(self, tmp_path):
+        """Test close() is idempotent and later writes raise"""
+        writer = cfd_python.AsyncWriter()
+        writer.close()
+        writer.close()
+        assert writer.closed
+        with pytest.raises(ValueError):
+            writer.write(cfd_python.Simulation(4, 4), str(tmp_path / "a.vtk"))
+
+    def test_concurrent_producers(self, tmp_path):
+        """Test writes from several Python threads share the pool safely"""
+        sims = [cfd_python.Simulation(8, 8) for _ in range(4)]
+        with cfd_python.AsyncWriter(buffers=2) as writer:
+
+            def produce(idx):
+                for k in range(5):
+                    writer.write(sims[idx], str(tmp_path / f"s{idx}_{k}.vtk"), binary=True)
+
+            threads = [threading.Thread(target=produce, args=(i,)) for i in range(4)]
+            for t in threads:
+                t.start()
+            for t in threads:
+                t.join()
+        assert len(list(tmp_path.glob("*.vtk"))) == 20
+
+    def test_writes_queue_without_waiting(self, tmp_path):
+        """Test write() only blocks once every buffer is queued"""
+        sim = cfd_python.Simulation(128, 128)
+        with cfd_python.AsyncWriter(buffers=2) as writer:
+            for k in range(12):
+                writer.write(sim, str(tmp_path / f"q{k}.vtk"))
+            writer.flush()
+            stats = writer.stats
+        assert stats["stalls"] > 0
+        assert stats["completed"] == 12
+        assert len(list(tmp_path.glob("q*.vtk"))) == 12
+
+    def test_close_while_another_thread_waits(self, tmp_path):
+        """Test close() refuses while a producer waits for a buffer"""
+        sim = cfd_python.Simulation(128, 128)
+        writer = cfd_python.AsyncWriter(buffers=1)
+        errors = []
+
+        def produce():
+            for k in range(8):
+                try:
+                    writer.write(sim, str(tmp_path / f"c{k}.vtk"))
+                except ValueError:
+                    return
+                except RuntimeError as exc:
+                    errors.append(exc)
+
+        thread = threading.Thread(target=produce)
+        thread.start()
+        while thread.is_alive():
+            try:
+                writer.close()
+            except RuntimeError:
+                continue
+        thread.join()
+        writer.close()
+        assert writer.closed
+        assert errors == []
+
+    def test_invalid_arguments(self, tmp_path):
+        """Test bad options raise before anything is queued"""
+        sim = cfd_python.Simulation(8, 8)
+        with pytest.raises(ValueError):
+            cfd_python.AsyncWriter(buffers=0)
+        with cfd_python.AsyncWriter() as writer:
+            with pytest.raises(ValueError):
+                writer.write(sim, str(tmp_path / "a.vtk"), format="hdf5")
+            with pytest.raises(ValueError):
+                writer.write(sim, str(tmp_path / "a.vtk"), roi=(0, 1, 0, 8))
+            with pytest.raises(TypeError):
+                writer.write(object(), str(tmp_path / "a.vtk"))
+            assert writer.stats["submitted"] == 0
+
+    def test_exported(self):
+        """Test AsyncWriter is in __all__"""
+        assert "AsyncWriter" in cfd_python.__all__
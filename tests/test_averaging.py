@@ -0,0 +1,172 @@
+"""
+Tests for running time-average accumulators on Simulation
+"""
+
+import math
+
+import pytest
+
+import cfd_python
+
+FIELDS = [
+    "mean_u",
+    "mean_v",
+    "mean_p",
+    "uu",
+    "vv",
+    "uv",
+    "pp",
+    "min_u",
+    "max_u",
+    "min_v",
+    "max_v",
+    "min_p",
+    "max_p",
+]
+
+
+def _record(sim, steps):
+    """Step one at a time and keep a copy of u, v, p after each step"""
+    samples = []
+    for _ in range(steps):
+        sim.step()
+        samples.append((sim.u.tolist(), sim.v.tolist(), sim.p.tolist()))
+    return samples
+
+
+class TestStartAveraging:
+    """Test Simulation.start_averaging and Simulation.averages"""
+
+    def test_disabled_by_default(self):
+        """Test averages is None until averaging starts"""
+        assert cfd_python.Simulation(8, 8).averages is None
+
+    def test_views(self):
+        """Test every statistic is a read-only double view of nx*ny points"""
+        sim = cfd_python.Simulation(8, 6)
+        sim.start_averaging()
+        avg = sim.averages
+        assert avg["samples"] == 0
+        assert avg["every"] == 1
+        for name in FIELDS:
+            view = avg[name]
+            assert isinstance(view, memoryview)
+            assert view.format == "d"
+            assert view.readonly
+            assert len(view) == 48
+
+    def test_matches_reference(self):
+        """Test means, moments and envelopes match a Python reference"""
+        sim = cfd_python.Simulation(10, 10, dt=0.01)
+        sim.start_averaging()
+        samples = _record(sim, 12)
+        avg = sim.averages
+        assert avg["samples"] == 12
+
+        n = len(samples)
+        for i in range(100):
+            us = [s[0][i] for s in samples]
+            vs = [s[1][i] for s in samples]
+            ps = [s[2][i] for s in samples]
+            mu, mv, mp = sum(us) / n, sum(vs) / n, sum(ps) / n
+            uu = sum((x - mu) ** 2 for x in us) / n
+            uv = sum((x - mu) * (y - mv) for x, y in zip(us, vs)) / n
+            pp = sum((x - mp) ** 2 for x in ps) / n
+            assert math.isclose(avg["mean_u"][i], mu, rel_tol=1e-12, abs_tol=1e-14)
+            assert math.isclose(avg["mean_p"][i], mp, rel_tol=1e-12, abs_tol=1e-14)
+            assert math.isclose(avg["uu"][i], uu, rel_tol=1e-9, abs_tol=1e-14)
+            assert math.isclose(avg["uv"][i], uv, rel_tol=1e-9, abs_tol=1e-14)
+            assert math.isclose(avg["pp"][i], pp, rel_tol=1e-9, abs_tol=1e-14)
+            assert avg["min_u"][i] == min(us)
+            assert avg["max_u"][i] == max(us)
+            assert avg["min_v"][i] == min(vs)
+            assert avg["max_p"][i] == max(ps)
+
+    def test_sampling_interval(self):
+        """Test only every k-th step is sampled"""
+        sim = cfd_python.Simulation(8, 8, dt=0.01)
+        sim.start_averaging(every=3)
+        samples = _record(sim, 10)
+        avg = sim.averages
+        assert avg["samples"] == 3
+        picked = [samples[2], samples[5], samples[8]]
+        expected = sum(s[0][20] for s in picked) / 3
+        assert math.isclose(avg["mean_u"][20], expected, rel_tol=1e-12, abs_tol=1e-14)
+
+    def test_views_are_live(self):
+        """Test a view obtained earlier sees later samples"""
+        sim = cfd_python.Simulation(8, 8, dt=0.01)
+        sim.start_averaging()
+        mean_u = sim.averages["mean_u"]
+        sim.step(5)
+        assert mean_u.tolist() == sim.averages["mean_u"].tolist()
+        assert any(x != 0.0 for x in mean_u.tolist())
+
+    def test_restart_resets(self):
+        """Test start_averaging() again starts from zero samples"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.start_averaging()
+        sim.step(4)
+        sim.start_averaging(every=2)
+        assert sim.averages["samples"] == 0
+        assert sim.averages["every"] == 2
+
+    def test_stop_keeps_views_valid(self):
+        """Test views stay readable after stop_averaging()"""
+        sim = cfd_python.Simulation(8, 8, dt=0.01)
+        sim.start_averaging()
+        sim.step(3)
+        mean_u = sim.averages["mean_u"]
+        frozen = mean_u.tolist()
+        sim.stop_averaging()
+        assert sim.averages is None
+        sim.step(3)
+        del sim
+        assert mean_u.tolist() == frozen
+
+    def test_rollback_discards_unverified_samples(self):
+        """Test samples taken after the last verified state are dropped on rollback"""
+        sim = cfd_python.Simulation(8, 8, dt=0.001)
+        sim.set_divergence_guard(check_every=2, max_velocity=10.0, max_retries=2)
+        sim.start_averaging()
+        sim.step(4)
+        u = sim.u
+        u[20] = 1e6
+        sim.step(2)
+        assert sim.divergence_info["rollbacks"] == 1
+        avg = sim.averages
+        assert avg["samples"] == 6
+        assert max(avg["max_u"].tolist()) <= 10.0
+        assert max(abs(x) for x in avg["mean_u"].tolist()) <= 10.0
+        for name in FIELDS:
+            assert all(math.isfinite(x) for x in avg[name].tolist()), name
+
+    def test_rollback_past_commit_does_not_resample(self):
+        """Test steps re-run after a deep rollback are not counted twice"""
+        sim = cfd_python.Simulation(8, 8, dt=0.001)
+        sim.set_divergence_guard(check_every=2, max_velocity=10.0, max_retries=3, history=3)
+        sim.start_averaging()
+        sim.step(6)
+        u = sim.u
+        u[20] = 1e6
+        sim.step(1)
+        sim.step(1)
+        assert sim.divergence_info["rollbacks"] == 1
+        u = sim.u
+        u[20] = 1e6
+        sim.step(2)
+        assert sim.divergence_info["rollbacks"] == 2
+        assert sim.step_count == 10
+        assert sim.averages["samples"] == 10
+
+    def test_clone_starts_without_averages(self):
+        """Test clones do not inherit accumulators"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.start_averaging()
+        assert sim.clone().averages is None
+
+    def test_invalid_interval(self):
+        """Test every < 1 raises ValueError"""
+        sim = cfd_python.Simulation(8, 8)
+        with pytest.raises(ValueError):
+            sim.start_averaging(every=0)
@@ -2,6 +2,8 @@
 Tests for boundary condition bindings in cfd_python.
 """
 
+import array
+
 import pytest
 
 import cfd_python
@@ -390,6 +392,37 @@ class TestBCApplyOutlet:
             assert v[boundary_idx] == v[interior_idx], f"v outlet should copy interior at row {j}"
 
 
+class TestBCBufferFields:
+    """Test BC functions on float64 buffers instead of lists"""
+
+    def test_array_updated_in_place(self):
+        """Test a writable array.array is modified directly"""
+        nx, ny = 4, 4
+        field = array.array("d", [0.0] * (nx * ny))
+        cfd_python.bc_apply_dirichlet(field, nx, ny, 1.0, 2.0, 3.0, 4.0)
+        assert field[nx] == 1.0
+        assert field[0] == 3.0
+
+    def test_velocity_views_updated_in_place(self):
+        """Test the live Simulation views take boundary conditions directly"""
+        sim = cfd_python.Simulation(8, 6)
+        cfd_python.bc_apply_inlet_uniform(sim.u, sim.v, 8, 6, 1.5, 0.0)
+        assert sim.u[8] == 1.5
+
+    def test_read_only_and_tuple_rejected(self):
+        """Test inputs that cannot take the results raise TypeError"""
+        with pytest.raises(TypeError):
+            cfd_python.bc_apply_scalar(bytes(16 * 8), 4, 4, cfd_python.BC_TYPE_NEUMANN)
+        with pytest.raises(TypeError):
+            cfd_python.bc_apply_scalar((0.0,) * 16, 4, 4, cfd_python.BC_TYPE_NEUMANN)
+
+    def test_buffer_size_checked(self):
+        """Test buffers of the wrong length raise ValueError"""
+        u = array.array("d", [0.0] * 16)
+        with pytest.raises(ValueError):
+            cfd_python.bc_apply_noslip(u, array.array("d", [0.0] * 8), 4, 4)
+
+
 class TestBCFunctionsExported:
     """Test that all BC functions are properly exported"""
 
@@ -0,0 +1,177 @@
+"""
+Tests for native field comparison and error norms
+"""
+
+import array
+import math
+import struct
+
+import pytest
+
+import cfd_python
+
+
+def _next_up(x):
+    """Adjacent double above a positive x"""
+    return struct.unpack("<d", struct.pack("<q", struct.unpack("<q", struct.pack("<d", x))[0] + 1))[
+        0
+    ]
+
+
+class TestCompareFields:
+    """Test compare_fields function"""
+
+    def test_identical(self):
+        """Test identical fields have zero error"""
+        data = [0.5 * i for i in range(100)]
+        result = cfd_python.compare_fields(data, data)
+        assert result["count"] == 100
+        assert result["exact"] == 100
+        assert result["nan_mismatch"] == 0
+        for key in ["l1", "l2", "linf", "rel_l1", "rel_l2", "rel_linf", "mean_ulp"]:
+            assert result[key] == 0.0
+        assert result["max_ulp"] == 0
+
+    def test_norms(self):
+        """Test absolute and relative norms and the max-error location"""
+        a = [1.0, 2.0, 3.0, 4.0]
+        b = [1.0, 2.5, 2.75, 4.0]
+        result = cfd_python.compare_fields(a, b)
+        assert result["l1"] == pytest.approx(0.75)
+        assert result["l2"] == pytest.approx(math.sqrt(0.25 + 0.0625))
+        assert result["linf"] == pytest.approx(0.5)
+        assert result["max_index"] == 1
+        assert result["rel_l1"] == pytest.approx(0.75 / 10.25)
+        assert result["rel_l2"] == pytest.approx(
+            math.sqrt(0.3125) / math.sqrt(1 + 6.25 + 7.5625 + 16)
+        )
+        assert result["rel_linf"] == pytest.approx(0.5 / 4.0)
+        assert result["exact"] == 2
+
+    def test_max_location(self):
+        """Test nx adds the (i, j) of the largest error"""
+        a = [0.0] * 12
+        b = [0.0] * 12
+        b[7] = 3.0
+        result = cfd_python.compare_fields(a, b, nx=4)
+        assert result["max_index"] == 7
+        assert result["max_location"] == (3, 1)
+        with pytest.raises(ValueError):
+            cfd_python.compare_fields(a, b, nx=5)
+
+    def test_ties_pick_lowest_index(self):
+        """Test equal max errors report the first location"""
+        n = 50000
+        a = [0.0] * n
+        b = [0.0] * n
+        for k in (30000, 4000, 45000):
+            b[k] = 1.0
+        assert cfd_python.compare_fields(a, b)["max_index"] == 4000
+
+    def test_ulp_distance(self):
+        """Test ULP distances between adjacent and signed-zero values"""
+        assert cfd_python.compare_fields([_next_up(1.0)], [1.0])["max_ulp"] == 1
+        assert cfd_python.compare_fields([-0.0], [0.0])["max_ulp"] == 0
+        tiny = 5e-324
+        assert cfd_python.compare_fields([tiny], [-tiny])["max_ulp"] == 2
+        result = cfd_python.compare_fields([1.0, _next_up(_next_up(1.0))], [1.0, 1.0])
+        assert result["max_ulp"] == 2
+        assert result["mean_ulp"] == 1.0
+
+    def test_nan_handling(self):
+        """Test NaN pairs are skipped and one-sided NaNs are counted"""
+        nan = float("nan")
+        result = cfd_python.compare_fields([nan, nan, 1.0], [nan, 2.0, 1.5])
+        assert result["count"] == 1
+        assert result["nan_mismatch"] == 1
+        assert result["linf"] == 0.5
+        assert result["max_index"] == 2
+
+    def test_infinities(self):
+        """Test equal infinities compare as exact"""
+        inf = float("inf")
+        result = cfd_python.compare_fields([inf, 1.0], [inf, 1.0])
+        assert result["linf"] == 0.0
+        assert result["exact"] == 2
+
+    def test_zero_copy_buffers(self):
+        """Test array buffers are accepted"""
+        a = array.array("d", [1.0, 2.0, 3.0])
+        b = array.array("d", [1.0, 2.0, 4.0])
+        assert cfd_python.compare_fields(a, b)["linf"] == 1.0
+
+    def test_matches_python_on_large_fields(self):
+        """Test parallel reduction matches a Python reference"""
+        n = 100003
+        a = [math.sin(0.001 * i) for i in range(n)]
+        b = [x + 1e-9 * math.cos(0.01 * i) for i, x in enumerate(a)]
+        result = cfd_python.compare_fields(a, b)
+        errors = [abs(x - y) for x, y in zip(a, b)]
+        assert result["l1"] == pytest.approx(sum(errors), rel=1e-9)
+        assert result["linf"] == max(errors)
+        assert result["max_index"] == errors.index(max(errors))
+
+    def test_size_mismatch(self):
+        """Test fields of different sizes raise ValueError"""
+        with pytest.raises(ValueError):
+            cfd_python.compare_fields([1.0, 2.0], [1.0])
+
+
+class TestCompareFlowFields:
+    """Test compare_flow_fields function"""
+
+    def test_clone_is_exact(self):
+        """Test a clone compares bitwise equal"""
+        sim = cfd_python.Simulation(10, 8)
+        sim.step(3)
+        result = cfd_python.compare_flow_fields(sim.clone(), sim)
+        assert set(result) == {"u", "v", "p"}
+        for entry in result.values():
+            assert entry["exact"] == 80
+            assert entry["max_location"] == (0, 0)
+
+    def test_diverged_states(self):
+        """Test states at different steps differ"""
+        sim = cfd_python.Simulation(10, 8)
+        other = sim.clone()
+        sim.step(4)
+        result = cfd_python.compare_flow_fields(sim, other)
+        assert result["u"]["linf"] > 0.0
+        i, j = result["u"]["max_location"]
+        k = result["u"]["max_index"]
+        assert k == j * 10 + i
+
+    def test_snapshot_and_dict(self):
+        """Test snapshots and dicts of buffers are accepted"""
+        sim = cfd_python.Simulation(6, 6)
+        sim.step(2)
+        snap = sim.snapshot()
+        fields = {"u": sim.u, "v": sim.v, "p": sim.p, "nx": 6}
+        result = cfd_python.compare_flow_fields(snap, fields)
+        assert all(entry["linf"] == 0.0 for entry in result.values())
+
+    def test_solver_harness(self):
+        """Test every registered solver can be compared against the first"""
+        solvers = cfd_python.list_solvers()
+        reference = cfd_python.Simulation(12, 12, solver_type=solvers[0])
+        reference.step(3)
+        for name in solvers[1:]:
+            sim = cfd_python.Simulation(12, 12, solver_type=name)
+            sim.step(3)
+            result = cfd_python.compare_flow_fields(sim, reference)
+            assert result["u"]["count"] + result["u"]["nan_mismatch"] <= 144
+
+    def test_invalid_inputs(self):
+        """Test unsupported objects and mismatched sizes raise"""
+        with pytest.raises(TypeError):
+            cfd_python.compare_flow_fields([1.0], [1.0])
+        with pytest.raises(KeyError):
+            cfd_python.compare_flow_fields({"u": [1.0]}, {"u": [1.0]})
+        with pytest.raises(ValueError):
+            cfd_python.compare_flow_fields(cfd_python.Simulation(6, 6), cfd_python.Simulation(8, 6))
+
+    def test_functions_in_all(self):
+        """Test comparison functions are exported"""
+        for name in ["compare_fields", "compare_flow_fields"]:
+            assert name in cfd_python.__all__
+            assert callable(getattr(cfd_python, name))
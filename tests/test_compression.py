@@ -0,0 +1,221 @@
+"""
+Tests for the field codec and compressed snapshot stores
+"""
+
+import array
+import math
+import random
+import struct
+import sys
+
+import pytest
+
+import cfd_python
+
+
+def _bits(values):
+    return [struct.pack("<d", x) for x in values]
+
+
+def _smooth(nx, ny, phase=0.0):
+    return [
+        math.sin(3.0 * i / nx + phase) * math.cos(2.0 * j / ny)
+        for j in range(ny)
+        for i in range(nx)
+    ]
+
+
+class TestCompressField:
+    """Test compress_field() and decompress_field()"""
+
+    def test_round_trip_is_exact(self):
+        """Test random, smooth and special values decode bit for bit"""
+        rng = random.Random(48)
+        data = [rng.uniform(-1.0, 1.0) * 10.0 ** rng.randint(-300, 300) for _ in range(40000)]
+        data += _smooth(200, 100)
+        data += [0.0, -0.0, math.inf, -math.inf, math.nan, 5e-324, 1.7976931348623157e308]
+        blob = cfd_python.compress_field(data)
+        assert isinstance(blob, bytearray)
+        assert _bits(cfd_python.decompress_field(blob).tolist()) == _bits(data)
+
+    def test_empty_and_tiny(self):
+        """Test fields smaller than a chunk, down to empty ones"""
+        for data in ([], [1.5], [1.0, 2.0, 3.0]):
+            assert cfd_python.decompress_field(cfd_python.compress_field(data)).tolist() == data
+
+    def test_compresses_structured_fields(self):
+        """Test constant regions and smooth fields shrink while noise stays bounded"""
+        n = 256 * 256
+        step = [0.0 if i % 256 < 128 else 1.0 for i in range(n)]
+        assert len(cfd_python.compress_field(step)) < n * 8 / 50
+        assert len(cfd_python.compress_field(_smooth(256, 256))) < n * 8 / 1.15
+        rng = random.Random(1)
+        noise = array.array("Q", (rng.getrandbits(64) for _ in range(n)))
+        noise = array.array("d", noise.tobytes())
+        assert len(cfd_python.compress_field(noise)) <= n * 8 + 64
+
+    def test_out_and_buffer_inputs(self):
+        """Test decoding into out= and from memoryview input"""
+        data = array.array("d", _smooth(50, 40))
+        blob = bytes(cfd_python.compress_field(data))
+        out = array.array("d", [0.0]) * len(data)
+        assert cfd_python.decompress_field(memoryview(blob), out=out) is out
+        assert out == data
+        with pytest.raises(ValueError):
+            cfd_python.decompress_field(blob, out=array.array("d", [0.0]))
+
+    def test_invalid_streams(self):
+        """Test foreign and truncated streams raise ValueError and damaged ones never crash"""
+        with pytest.raises(ValueError):
+            cfd_python.decompress_field(b"not compressed data")
+        blob = cfd_python.compress_field(_smooth(100, 100))
+        with pytest.raises(ValueError):
+            cfd_python.decompress_field(blob[: len(blob) // 2])
+        rng = random.Random(3)
+        for _ in range(50):
+            damaged = bytearray(blob)
+            damaged[rng.randrange(32, len(damaged))] ^= 0xFF
+            try:
+                cfd_python.decompress_field(damaged)
+            except ValueError:
+                pass
+
+    def test_exported(self):
+        """Test the codec functions are in __all__"""
+        assert "compress_field" in cfd_python.__all__
+        assert "decompress_field" in cfd_python.__all__
+
+
+class TestLossyCompression:
+    """Test compress_field(max_error=...)"""
+
+    def test_error_bound_holds(self):
+        """Test every decoded value is within the bound for smooth, noisy and scaled data"""
+        rng = random.Random(49)
+        cases = [
+            (_smooth(300, 200), 1e-4),
+            ([rng.gauss(0.0, 1.0) for _ in range(50000)], 1e-3),
+            ([1e6 + 1e3 * x for x in _smooth(100, 100)], 1e-9),
+            ([1e-12 * x for x in _smooth(100, 100)], 1e-17),
+        ]
+        for data, bound in cases:
+            out = cfd_python.decompress_field(cfd_python.compress_field(data, max_error=bound))
+            assert max(abs(a - b) for a, b in zip(out.tolist(), data)) <= bound
+
+    def test_relative_bound_and_ratio(self):
+        """Test relative bounds scale with the range and beat lossless by a wide margin"""
+        data = [5.0 + 2.0 * x for x in _smooth(256, 256)]
+        span = max(data) - min(data)
+        blob = cfd_python.compress_field(data, max_error=1e-4, relative=True)
+        out = cfd_python.decompress_field(blob).tolist()
+        assert max(abs(a - b) for a, b in zip(out, data)) <= 1e-4 * span
+        lossless = cfd_python.compress_field(data)
+        assert len(blob) * 4 < len(lossless)
+        assert len(data) * 8 / len(blob) > 6.0
+
+    def test_special_values_exact(self):
+        """Test NaN, infinities and huge values pass through exactly"""
+        data = _smooth(40, 40)
+        specials = [math.nan, math.inf, -math.inf, 1e308, -1e308, 0.0]
+        for k, x in enumerate(specials):
+            data[100 * k + 7] = x
+        out = cfd_python.decompress_field(cfd_python.compress_field(data, max_error=1e-6))
+        out = out.tolist()
+        for k, x in enumerate(specials):
+            assert _bits([out[100 * k + 7]]) == _bits([x])
+        finite = [i for i, x in enumerate(data) if math.isfinite(x)]
+        assert max(abs(out[i] - data[i]) for i in finite) <= 1e-6
+
+    def test_constant_field_relative_is_lossless(self):
+        """Test a relative bound on a zero-range field falls back to lossless"""
+        data = [0.1] * 1000
+        blob = cfd_python.compress_field(data, max_error=0.01, relative=True)
+        assert cfd_python.decompress_field(blob).tolist() == data
+
+    def test_invalid_max_error(self):
+        """Test negative and non-finite bounds are rejected"""
+        for bad in (-1.0, math.inf, math.nan, 1e308):
+            with pytest.raises(ValueError):
+                cfd_python.compress_field([1.0, 2.0], max_error=bad)
+
+    def test_damaged_streams(self):
+        """Test damaged lossy streams raise ValueError or decode without crashing"""
+        blob = cfd_python.compress_field(_smooth(150, 150), max_error=1e-5)
+        rng = random.Random(5)
+        for _ in range(50):
+            damaged = bytearray(blob)
+            damaged[rng.randrange(40, len(damaged))] ^= 0xFF
+            try:
+                cfd_python.decompress_field(damaged)
+            except ValueError:
+                pass
+
+
+@pytest.mark.skipif(
+    sys.platform == "win32", reason="Memory-mapped stores are not available on Windows"
+)
+class TestCompressedStore:
+    """Test SnapshotWriter(compress=True)"""
+
+    def test_round_trip(self, tmp_path):
+        """Test compressed records decode exactly and take less space"""
+        nx, ny = 64, 48
+        raw_path, packed_path = tmp_path / "raw.store", tmp_path / "packed.store"
+        fields = []
+        for k in range(4):
+            u = [0.0] * (nx * ny)
+            fields.append({"u": u, "v": _smooth(nx, ny, k), "p": _smooth(nx, ny, -k)})
+        for path, compress in ((raw_path, False), (packed_path, True)):
+            with cfd_python.SnapshotWriter(str(path), nx, ny, compress=compress) as writer:
+                for k, f in enumerate(fields):
+                    writer.write(f, step=10 * k, time=0.5 * k)
+                nbytes = writer.nbytes
+            assert path.stat().st_size == nbytes
+        assert packed_path.stat().st_size < raw_path.stat().st_size / 1.3
+        store = cfd_python.SnapshotStore(str(packed_path))
+        assert store.steps == [0, 10, 20, 30]
+        snap = store[20]
+        assert (snap.step, snap.time) == (20, 1.0)
+        assert snap.p.tolist() == fields[2]["p"]
+        assert snap.u.tolist() == fields[2]["u"]
+        assert not snap.v.readonly
+
+    def test_mixed_records(self, tmp_path):
+        """Test raw and compressed records can share one store"""
+        path = tmp_path / "mixed.store"
+        sim = cfd_python.Simulation(16, 12)
+        with cfd_python.SnapshotWriter(str(path), 16, 12) as writer:
+            sim.step()
+            writer.write(sim)
+        with cfd_python.SnapshotWriter(str(path), 16, 12, append=True, compress=True) as writer:
+            sim.step()
+            writer.write(sim)
+        store = cfd_python.SnapshotStore(str(path))
+        assert store[1].u.readonly and not store[2].u.readonly
+        assert store[2].p.tolist() == sim.p.tolist()
+
+    def test_lossy_records(self, tmp_path):
+        """Test max_error stores records within the bound and reports the ratio"""
+        nx, ny = 96, 64
+        path = tmp_path / "lossy.store"
+        fields = {"u": _smooth(nx, ny), "v": _smooth(nx, ny, 1.0), "p": [2.5] * (nx * ny)}
+        with cfd_python.SnapshotWriter(str(path), nx, ny, max_error=1e-4, relative=True) as writer:
+            assert writer.compression_ratio == 1.0
+            writer.write(fields, step=1, time=0.1)
+            ratio = writer.compression_ratio
+        assert ratio > 4.0
+        snap = cfd_python.SnapshotStore(str(path))[1]
+        for name in ("u", "v"):
+            data = fields[name]
+            span = max(data) - min(data)
+            out = getattr(snap, name).tolist()
+            assert max(abs(a - b) for a, b in zip(out, data)) <= 1e-4 * span
+        assert snap.p.tolist() == fields["p"]
+
+    def test_ratio_of_raw_records(self, tmp_path):
+        """Test uncompressed writers report a ratio of 1"""
+        with cfd_python.SnapshotWriter(str(tmp_path / "raw.store"), 8, 8) as writer:
+            writer.write(cfd_python.Simulation(8, 8))
+            assert writer.compression_ratio == 1.0
+        with pytest.raises(ValueError):
+            cfd_python.SnapshotWriter(str(tmp_path / "bad.store"), 8, 8, max_error=-1.0)
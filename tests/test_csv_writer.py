@@ -0,0 +1,136 @@
+"""
+Tests for the streaming CSV timeseries writer
+"""
+
+import csv
+import threading
+
+import pytest
+
+import cfd_python
+
+
+def _read_rows(path):
+    with open(path, newline="") as f:
+        return list(csv.DictReader(f))
+
+
+class TestCsvWriter:
+    """Test CsvWriter"""
+
+    def test_simulation_rows(self, tmp_path):
+        """Test rows carry the live step, time, dt and exact statistics"""
+        sim = cfd_python.Simulation(9, 7)
+        sim.set_fields(u=[float(i) - 20.0 for i in range(63)])
+        path = tmp_path / "log.csv"
+        with cfd_python.CsvWriter(str(path)) as writer:
+            for _ in range(3):
+                sim.step()
+                writer.write(sim)
+            assert writer.rows == 3
+        rows = _read_rows(path)
+        assert [int(r["step"]) for r in rows] == [1, 2, 3]
+        last = rows[-1]
+        assert float(last["time"]) == sim.time
+        assert float(last["dt"]) == sim.dt
+        u = sim.u.tolist()
+        assert float(last["max_u"]) == max(abs(x) for x in u)
+        assert float(last["avg_u"]) == pytest.approx(sum(u) / len(u), rel=1e-12, abs=1e-15)
+
+    def test_snapshot_and_dict_sources(self, tmp_path):
+        """Test FieldSnapshot defaults and dict sources with explicit step/time"""
+        u = [1.0, -3.0, 2.0, 0.0]
+        v = [0.5] * 4
+        p = [0.0, 0.0, 0.0, -8.0]
+        snap = cfd_python.FieldSnapshot(u, v, p, 2, 2, time=1.5, step=30)
+        path = tmp_path / "log.csv"
+        with cfd_python.CsvWriter(str(path)) as writer:
+            writer.write(snap)
+            writer.write({"u": u, "v": v, "p": p}, step=31, time=1.55, dt=0.05, iterations=4)
+            with pytest.raises(ValueError):
+                writer.write({"u": u, "v": v, "p": p})
+        first, second = _read_rows(path)
+        assert (int(first["step"]), float(first["time"])) == (30, 1.5)
+        assert float(first["max_u"]) == 3.0 and float(first["max_p"]) == 8.0
+        assert float(first["avg_u"]) == 0.0 and float(first["avg_v"]) == 0.5
+        assert (int(second["iterations"]), float(second["dt"])) == (4, 0.05)
+
+    def test_buffered_until_flush(self, tmp_path):
+        """Test rows stay in the buffer until flush() and flush_every reaches the file"""
+        path = tmp_path / "log.csv"
+        fields = {"u": [0.0] * 4, "v": [0.0] * 4, "p": [0.0] * 4}
+        writer = cfd_python.CsvWriter(str(path))
+        writer.write(fields, step=1, time=0.1)
+        assert path.read_text() == ""
+        writer.flush()
+        assert len(path.read_text().splitlines()) == 2
+        writer.close()
+
+        writer = cfd_python.CsvWriter(str(path), append=True, flush_every=2)
+        writer.write(fields, step=2, time=0.2)
+        writer.write(fields, step=3, time=0.3)
+        assert [int(r["step"]) for r in _read_rows(path)] == [1, 2, 3]
+        writer.close()
+
+    def test_append_keeps_single_header(self, tmp_path):
+        """Test appending to a non-empty file does not repeat the header"""
+        path = tmp_path / "log.csv"
+        sim = cfd_python.Simulation(4, 4)
+        for _ in range(2):
+            with cfd_python.CsvWriter(str(path), append=True) as writer:
+                writer.write(sim)
+        lines = path.read_text().splitlines()
+        assert lines[0].startswith("step,time,dt,")
+        assert len(lines) == 3
+
+    def test_close(self, tmp_path):
+        """Test close() is idempotent and later writes raise"""
+        writer = cfd_python.CsvWriter(str(tmp_path / "log.csv"))
+        writer.close()
+        writer.close()
+        assert writer.closed
+        with pytest.raises(ValueError):
+            writer.write(cfd_python.Simulation(4, 4))
+
+    def test_close_during_write_from_another_thread(self, tmp_path):
+        """Test close() refuses while another thread writes, keeping every row"""
+        path = tmp_path / "log.csv"
+        n = 256 * 256
+        fields = {"u": [1.0] * n, "v": [0.0] * n, "p": [0.0] * n}
+        writer = cfd_python.CsvWriter(str(path))
+        written = []
+
+        def produce():
+            for k in range(100):
+                try:
+                    writer.write(fields, step=k, time=0.0)
+                except (ValueError, RuntimeError):
+                    return
+                written.append(k)
+
+        thread = threading.Thread(target=produce)
+        thread.start()
+        while not writer.closed:
+            try:
+                writer.close()
+            except RuntimeError:
+                pass
+        thread.join()
+        assert [int(row["step"]) for row in _read_rows(path)] == written
+
+    def test_invalid_arguments(self, tmp_path):
+        """Test bad paths, sizes and sources raise"""
+        with pytest.raises(OSError):
+            cfd_python.CsvWriter(str(tmp_path / "missing" / "log.csv"))
+        with pytest.raises(ValueError):
+            cfd_python.CsvWriter(str(tmp_path / "a.csv"), buffer_size=0)
+        with cfd_python.CsvWriter(str(tmp_path / "b.csv")) as writer:
+            with pytest.raises(ValueError):
+                writer.write({"u": [0.0] * 4, "v": [0.0] * 3, "p": [0.0] * 4}, step=0, time=0.0)
+            with pytest.raises(TypeError):
+                writer.write([0.0] * 4)
+            assert writer.rows == 0
+
+    def test_exported(self):
+        """Test CsvWriter is in __all__"""
+        assert "CsvWriter" in cfd_python.__all__
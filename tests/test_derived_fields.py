@@ -2,7 +2,9 @@
 Tests for derived fields and statistics API in cfd_python.
 """
 
+import array
 import math
+import statistics
 
 import pytest
 
@@ -199,6 +201,340 @@ class TestComputeFlowStatistics:
             cfd_python.compute_flow_statistics([1.0], "not list", [1.0], 1, 1)
 
 
+class TestFieldStatistics:
+    """Test field_statistics function"""
+
+    def test_basic_statistics(self):
+        """Test moments and norms of a small field"""
+        data = [-2.0, -1.0, 0.0, 1.0, 2.0]
+        stats = cfd_python.field_statistics(data)
+        assert stats["count"] == 5
+        assert stats["min"] == -2.0
+        assert stats["max"] == 2.0
+        assert stats["sum"] == 0.0
+        assert stats["avg"] == 0.0
+        assert stats["variance"] == pytest.approx(2.0)
+        assert stats["std"] == pytest.approx(math.sqrt(2.0))
+        assert stats["rms"] == pytest.approx(math.sqrt(2.0))
+        assert stats["l1"] == 6.0
+        assert stats["l2"] == pytest.approx(math.sqrt(10.0))
+        assert stats["linf"] == 2.0
+
+    def test_matches_calculate_field_stats(self):
+        """Test common keys agree with calculate_field_stats"""
+        data = [float(i) for i in range(100)]
+        stats = cfd_python.field_statistics(data)
+        legacy = cfd_python.calculate_field_stats(data)
+        for key in ("min", "max", "avg", "sum"):
+            assert stats[key] == pytest.approx(legacy[key])
+
+    def test_variance_accuracy_large_offset(self):
+        """Test variance stays accurate when the mean dwarfs the spread"""
+        data = array.array("d", [1e9 + (i % 7) for i in range(50000)])
+        reference = statistics.pvariance([float(i % 7) for i in range(50000)])
+        assert cfd_python.field_statistics(data)["variance"] == pytest.approx(reference, rel=1e-9)
+
+    def test_multiple_blocks(self):
+        """Test fields spanning many blocks"""
+        n = 100003
+        data = array.array("d", (float(i) for i in range(n)))
+        stats = cfd_python.field_statistics(data)
+        assert stats["sum"] == n * (n - 1) / 2
+        assert stats["variance"] == pytest.approx((n * n - 1) / 12.0)
+
+    def test_nan_and_inf_counted_and_excluded(self):
+        """Test non-finite values are counted and skipped"""
+        data = [1.0, float("nan"), 3.0, float("inf"), float("-inf")]
+        stats = cfd_python.field_statistics(data)
+        assert stats["count"] == 2
+        assert stats["nan_count"] == 1
+        assert stats["inf_count"] == 2
+        assert stats["avg"] == 2.0
+        assert stats["max"] == 3.0
+
+    def test_histogram_with_range(self):
+        """Test histogram counts, edges and out-of-range counts"""
+        stats = cfd_python.field_statistics([0.5, 1.5, 1.7, 2.5, 5.0, -1.0], bins=3, range=(0, 3))
+        hist = stats["histogram"]
+        assert hist["counts"] == [1, 2, 1]
+        assert hist["edges"] == [0.0, 1.0, 2.0, 3.0]
+        assert hist["below"] == 1
+        assert hist["above"] == 1
+
+    def test_histogram_default_range(self):
+        """Test histograms default to the data range"""
+        stats = cfd_python.field_statistics([float(i) for i in range(10)], bins=5)
+        hist = stats["histogram"]
+        assert sum(hist["counts"]) == 10
+        assert hist["edges"][0] == 0.0
+        assert hist["edges"][-1] == 9.0
+
+    def test_percentiles(self):
+        """Test approximate percentiles"""
+        data = array.array("d", (float(i) for i in range(10001)))
+        pcts = cfd_python.field_statistics(data, percentiles=[0, 25, 50, 100])["percentiles"]
+        assert pcts[0] == 0.0
+        assert pcts[100] == 10000.0
+        assert pcts[50] == pytest.approx(5000.0, abs=10000 / 4096 + 1)
+        assert pcts[25] == pytest.approx(2500.0, abs=10000 / 4096 + 1)
+
+    def test_live_simulation_field(self):
+        """Test statistics of a live simulation view"""
+        sim = cfd_python.Simulation(16, 16)
+        sim.step(2)
+        stats = cfd_python.field_statistics(sim.u)
+        values = sim.u.tolist()
+        assert stats["count"] == 256
+        assert stats["max"] == max(values)
+
+    def test_invalid_arguments(self):
+        """Test invalid arguments raise"""
+        with pytest.raises(ValueError):
+            cfd_python.field_statistics([])
+        with pytest.raises(ValueError):
+            cfd_python.field_statistics([1.0], bins=4, range=(1.0, 1.0))
+        with pytest.raises(ValueError):
+            cfd_python.field_statistics([1.0], percentiles=[101])
+        with pytest.raises(TypeError):
+            cfd_python.field_statistics("not a field")
+
+
+def _sample_fields(grid, fu, fv, fp=None):
+    """Evaluate analytic fields on the grid points (row-major)"""
+    x = grid.x.tolist()
+    y = grid.y.tolist()
+    points = [(xi, yj) for yj in y for xi in x]
+    u = [fu(xi, yj) for xi, yj in points]
+    v = [fv(xi, yj) for xi, yj in points]
+    p = [fp(xi, yj) for xi, yj in points] if fp else None
+    return points, u, v, p
+
+
+class TestComputeDerivedFields:
+    """Test compute_derived_fields function"""
+
+    @pytest.mark.parametrize("beta", [None, 1.5])
+    def test_quadratic_fields_exact(self, beta):
+        """Test the second-order stencils are exact for quadratic fields"""
+        grid = cfd_python.Grid(9, 7, 0.0, 2.0, 0.0, 1.0, beta=beta)
+        points, u, v, p = _sample_fields(
+            grid, lambda x, y: x * y, lambda x, y: x - 0.5 * y * y, lambda x, y: x * x + 2 * y
+        )
+        result = cfd_python.compute_derived_fields(u, v, 9, 7, grid=grid, p=p)
+        for k, (x, y) in enumerate(points):
+            assert result["divergence"][k] == pytest.approx(0.0, abs=1e-12)
+            assert result["vorticity"][k] == pytest.approx(1.0 - x, abs=1e-12)
+            assert result["dpdx"][k] == pytest.approx(2.0 * x, abs=1e-12)
+            assert result["dpdy"][k] == pytest.approx(2.0, abs=1e-12)
+
+    def test_solid_body_rotation(self):
+        """Test Q-criterion and strain rate for rigid rotation"""
+        grid = cfd_python.Grid(6, 6, -1.0, 1.0, -1.0, 1.0)
+        _, u, v, _ = _sample_fields(grid, lambda x, y: -y, lambda x, y: x)
+        result = cfd_python.compute_derived_fields(u, v, 6, 6, grid=grid)
+        for k in range(36):
+            assert result["vorticity"][k] == pytest.approx(2.0)
+            assert result["q_criterion"][k] == pytest.approx(1.0)
+            assert result["strain_rate"][k] == pytest.approx(0.0, abs=1e-12)
+
+    def test_pure_shear(self):
+        """Test strain rate and Q-criterion for simple shear u = y"""
+        grid = cfd_python.Grid(5, 5, 0.0, 1.0, 0.0, 1.0)
+        _, u, v, _ = _sample_fields(grid, lambda x, y: y, lambda x, y: 0.0)
+        result = cfd_python.compute_derived_fields(u, v, 5, 5, grid=grid)
+        assert result["strain_rate"][12] == pytest.approx(1.0)
+        assert result["q_criterion"][12] == pytest.approx(0.0, abs=1e-12)
+
+    def test_default_fields(self):
+        """Test pressure gradients are only computed when p is given"""
+        u = [0.0] * 16
+        result = cfd_python.compute_derived_fields(u, u, 4, 4)
+        assert sorted(result) == ["divergence", "q_criterion", "strain_rate", "vorticity"]
+        result = cfd_python.compute_derived_fields(u, u, 4, 4, p=u)
+        assert "dpdx" in result and "dpdy" in result
+
+    def test_outputs_are_memoryviews(self):
+        """Test allocated outputs are flat float64 memoryviews"""
+        result = cfd_python.compute_derived_fields([0.0] * 12, [0.0] * 12, 4, 3)
+        assert isinstance(result["vorticity"], memoryview)
+        assert result["vorticity"].format == "d"
+        assert len(result["vorticity"]) == 12
+
+    def test_caller_buffers_written_in_place(self):
+        """Test out buffers are filled and returned unchanged"""
+        grid = cfd_python.create_grid(5, 4, 0.0, 1.0, 0.0, 1.0)
+        u = [y for y in grid["y_coords"] for _ in range(5)]
+        out = {"vorticity": array.array("d", [0.0] * 20)}
+        result = cfd_python.compute_derived_fields(
+            u, [0.0] * 20, 5, 4, grid=grid, fields=["vorticity"], out=out
+        )
+        assert list(result) == ["vorticity"]
+        assert result["vorticity"] is out["vorticity"]
+        assert out["vorticity"][7] == pytest.approx(-1.0)
+
+    def test_simulation_derived_fields(self):
+        """Test Simulation.derived_fields matches the module function"""
+        sim = cfd_python.Simulation(12, 10)
+        sim.step(3)
+        live = sim.derived_fields(fields=("vorticity", "dpdx"))
+        ref = cfd_python.compute_derived_fields(
+            sim.u, sim.v, 12, 10, grid=sim.grid, p=sim.p, fields=("vorticity", "dpdx")
+        )
+        assert live["vorticity"].tolist() == ref["vorticity"].tolist()
+        assert live["dpdx"].tolist() == ref["dpdx"].tolist()
+
+    def test_unknown_field_raises(self):
+        """Test unknown field names raise ValueError"""
+        with pytest.raises(ValueError):
+            cfd_python.compute_derived_fields([0.0] * 9, [0.0] * 9, 3, 3, fields=["helicity"])
+
+    def test_pressure_gradient_without_p_raises(self):
+        """Test requesting dpdx without p raises ValueError"""
+        with pytest.raises(ValueError):
+            cfd_python.compute_derived_fields([0.0] * 9, [0.0] * 9, 3, 3, fields=["dpdx"])
+
+    def test_invalid_out_buffer_raises(self):
+        """Test read-only or wrongly sized out buffers are rejected"""
+        u = [0.0] * 9
+        with pytest.raises(TypeError):
+            cfd_python.compute_derived_fields(u, u, 3, 3, out={"vorticity": bytes(72)})
+        with pytest.raises(ValueError):
+            cfd_python.compute_derived_fields(u, u, 3, 3, out={"vorticity": bytearray(64)})
+
+    def test_out_aliasing_input_raises(self):
+        """Test out buffers sharing memory with an input or each other are rejected"""
+        sim = cfd_python.Simulation(6, 5)
+        with pytest.raises(ValueError):
+            sim.derived_fields(fields=["vorticity"], out={"vorticity": sim.u})
+        with pytest.raises(ValueError):
+            sim.derived_fields(fields=["dpdx"], out={"dpdx": sim.p})
+        u = array.array("d", [0.0] * 9)
+        v = array.array("d", [0.0] * 9)
+        with pytest.raises(ValueError):
+            cfd_python.compute_derived_fields(u, v, 3, 3, out={"divergence": v})
+        shared = array.array("d", [0.0] * 9)
+        out = {"vorticity": shared, "divergence": shared}
+        with pytest.raises(ValueError):
+            cfd_python.compute_derived_fields(u, v, 3, 3, fields=list(out), out=out)
+
+    def test_size_mismatch_raises(self):
+        """Test field and grid size mismatches raise ValueError"""
+        with pytest.raises(ValueError):
+            cfd_python.compute_derived_fields([0.0] * 8, [0.0] * 9, 3, 3)
+        with pytest.raises(ValueError):
+            cfd_python.compute_derived_fields(
+                [0.0] * 9, [0.0] * 9, 3, 3, grid=cfd_python.Grid(4, 3, 0.0, 1.0, 0.0, 1.0)
+            )
+        with pytest.raises(ValueError):
+            cfd_python.compute_derived_fields([0.0] * 4, [0.0] * 4, 2, 2)
+
+
+def _bilinear_field(xs, ys):
+    """f(x, y) = 1 + 2x - 3y + xy, reproduced exactly by bilinear interpolation"""
+    return [1.0 + 2.0 * x - 3.0 * y + x * y for y in ys for x in xs]
+
+
+class TestSampleLines:
+    """Test sample_lines function"""
+
+    def test_polyline_samples(self):
+        """Test segment samples are evenly spaced and interpolate exactly"""
+        grid = cfd_python.Grid(11, 9, 0.0, 2.0, 0.0, 1.0)
+        data = _bilinear_field(grid.x.tolist(), grid.y.tolist())
+        (line,) = cfd_python.sample_lines(
+            data, 11, 9, [[(0.1, 0.2), (1.9, 0.8)]], grid=grid, num_points=7
+        )
+        xs, ys = line["x"].tolist(), line["y"].tolist()
+        assert len(xs) == 7
+        assert (xs[0], ys[0]) == (0.1, 0.2)
+        assert (xs[-1], ys[-1]) == (1.9, 0.8)
+        length = math.hypot(1.8, 0.6)
+        assert line["distance"].tolist() == pytest.approx([length * k / 6 for k in range(7)])
+        for x, y, value in zip(xs, ys, line["values"].tolist()):
+            assert value == pytest.approx(1.0 + 2.0 * x - 3.0 * y + x * y, abs=1e-12)
+
+    def test_polyline_follows_vertices(self):
+        """Test polylines pass through their corner vertices"""
+        data = [0.0] * 25
+        (line,) = cfd_python.sample_lines(
+            data, 5, 5, [[(0.0, 0.0), (1.0, 0.0), (1.0, 1.0)]], num_points=5
+        )
+        assert line["x"].tolist() == pytest.approx([0.0, 0.5, 1.0, 1.0, 1.0])
+        assert line["y"].tolist() == pytest.approx([0.0, 0.0, 0.0, 0.5, 1.0])
+        assert line["distance"][-1] == pytest.approx(2.0)
+
+    def test_grid_lines(self):
+        """Test constant-x/constant-y lines sample every node of the other axis"""
+        grid = cfd_python.Grid(9, 7, 0.0, 1.0, 0.0, 1.0, beta=1.5)
+        xs, ys = grid.x.tolist(), grid.y.tolist()
+        data = _bilinear_field(xs, ys)
+        vertical, horizontal = cfd_python.sample_lines(
+            data, 9, 7, [{"x": 0.5}, {"y": 0.3}], grid=grid
+        )
+        assert vertical["y"].tolist() == ys
+        assert vertical["x"].tolist() == [0.5] * 7
+        assert horizontal["x"].tolist() == xs
+        for y, value in zip(ys, vertical["values"].tolist()):
+            assert value == pytest.approx(1.0 + 1.0 - 3.0 * y + 0.5 * y, abs=1e-12)
+        for x, value in zip(xs, horizontal["values"].tolist()):
+            assert value == pytest.approx(1.0 + 2.0 * x - 0.9 + 0.3 * x, abs=1e-12)
+
+    def test_grid_line_on_nodes_matches_field(self):
+        """Test a grid line through a node column returns the column itself"""
+        nx, ny = 6, 5
+        data = [float(i * i) for i in range(nx * ny)]
+        (line,) = cfd_python.sample_lines(data, nx, ny, [{"x": 0.4}])
+        assert line["values"].tolist() == pytest.approx([data[j * nx + 2] for j in range(ny)])
+
+    def test_multiple_fields(self):
+        """Test a dict samples every named field"""
+        u = [1.0] * 16
+        v = [2.0] * 16
+        (line,) = cfd_python.sample_lines({"u": u, "v": v}, 4, 4, [{"y": 0.5}])
+        assert line["u"].tolist() == [1.0] * 4
+        assert line["v"].tolist() == [2.0] * 4
+        assert "values" not in line
+
+    def test_outside_points_are_nan(self):
+        """Test polyline samples outside the grid are NaN"""
+        (line,) = cfd_python.sample_lines(
+            [1.0] * 16, 4, 4, [[(0.5, 0.5), (1.5, 0.5)]], num_points=3
+        )
+        values = line["values"].tolist()
+        assert values[0] == 1.0
+        assert math.isnan(values[2])
+
+    def test_batch_of_lines(self):
+        """Test many lines in one call return one result each"""
+        lines = [{"x": i / 10} for i in range(11)] + [[(0.0, 0.0), (1.0, 1.0)]] * 5
+        result = cfd_python.sample_lines([0.0] * 121, 11, 11, lines, num_points=20)
+        assert len(result) == 16
+        assert all(len(r["values"]) == 11 for r in result[:11])
+        assert all(len(r["values"]) == 20 for r in result[11:])
+
+    def test_simulation_sample_lines(self):
+        """Test Simulation.sample_lines samples the live u, v and p"""
+        sim = cfd_python.Simulation(9, 9)
+        sim.step(2)
+        (line,) = sim.sample_lines([{"x": 0.5}])
+        u = sim.u.tolist()
+        assert line["u"].tolist() == pytest.approx([u[j * 9 + 4] for j in range(9)])
+        assert len(line["p"]) == 9
+
+    def test_invalid_lines(self):
+        """Test malformed line specifications raise"""
+        with pytest.raises(ValueError):
+            cfd_python.sample_lines([0.0] * 16, 4, 4, [{"x": 2.0}])
+        with pytest.raises(ValueError):
+            cfd_python.sample_lines([0.0] * 16, 4, 4, [{"z": 0.5}])
+        with pytest.raises(ValueError):
+            cfd_python.sample_lines([0.0] * 16, 4, 4, [[(0.5, 0.5)]])
+        with pytest.raises(ValueError):
+            cfd_python.sample_lines([0.0] * 15, 4, 4, [{"x": 0.5}])
+        with pytest.raises(ValueError):
+            cfd_python.sample_lines([0.0] * 16, 4, 4, [{"x": 0.5}], num_points=1)
+
+
 class TestDerivedFieldsExported:
     """Test that all derived fields functions are properly exported"""
 
@@ -208,6 +544,9 @@ class TestDerivedFieldsExported:
             "calculate_field_stats",
             "compute_velocity_magnitude",
             "compute_flow_statistics",
+            "compute_derived_fields",
+            "field_statistics",
+            "sample_lines",
         ]
         for func_name in functions:
             assert func_name in cfd_python.__all__, f"{func_name} should be in __all__"
@@ -0,0 +1,128 @@
+"""
+Tests for per-step integral diagnostics recorded inside the Simulation step loop
+"""
+
+import pytest
+
+import cfd_python
+
+COLUMNS = [
+    "time",
+    "step",
+    "kinetic_energy",
+    "enstrophy",
+    "flux_left",
+    "flux_right",
+    "flux_bottom",
+    "flux_top",
+    "max_divergence",
+]
+
+
+def _trapezoid_weights(coords):
+    n = len(coords)
+    weights = [0.5 * (coords[1] - coords[0])]
+    weights += [0.5 * (coords[i + 1] - coords[i - 1]) for i in range(1, n - 1)]
+    weights.append(0.5 * (coords[-1] - coords[-2]))
+    return weights
+
+
+def _reference(sim):
+    """Diagnostics of the current state computed in Python"""
+    nx, ny = sim.nx, sim.ny
+    xs, ys = sim.grid.x.tolist(), sim.grid.y.tolist()
+    qx, qy = _trapezoid_weights(xs), _trapezoid_weights(ys)
+    u, v = sim.u.tolist(), sim.v.tolist()
+    derived = sim.derived_fields(fields=["vorticity", "divergence"])
+    w = derived["vorticity"].tolist()
+    div = derived["divergence"].tolist()
+
+    def integrate(values):
+        return sum(qx[i] * qy[j] * values[j * nx + i] for j in range(ny) for i in range(nx))
+
+    return {
+        "kinetic_energy": 0.5 * integrate([a * a + b * b for a, b in zip(u, v)]),
+        "enstrophy": 0.5 * integrate([a * a for a in w]),
+        "flux_left": -sum(qy[j] * u[j * nx] for j in range(ny)),
+        "flux_right": sum(qy[j] * u[j * nx + nx - 1] for j in range(ny)),
+        "flux_bottom": -sum(qx[i] * v[i] for i in range(nx)),
+        "flux_top": sum(qx[i] * v[(ny - 1) * nx + i] for i in range(nx)),
+        "max_divergence": max(abs(d) for d in div),
+    }
+
+
+class TestDiagnostics:
+    """Test Simulation.set_diagnostics and Simulation.diagnostic_data"""
+
+    def test_disabled_by_default(self):
+        """Test diagnostic_data returns None until enabled"""
+        assert cfd_python.Simulation(8, 8).diagnostic_data() is None
+
+    def test_columns(self):
+        """Test one row per step with every column as a float64 view"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.set_diagnostics()
+        sim.step(4)
+        data = sim.diagnostic_data()
+        assert data["samples"] == 4
+        assert data["dropped"] == 0
+        for name in COLUMNS:
+            assert data[name].format == "d"
+            assert len(data[name]) == 4
+        assert data["step"].tolist() == [1.0, 2.0, 3.0, 4.0]
+
+    def test_matches_reference(self):
+        """Test the fused reduction matches a Python reference"""
+        sim = cfd_python.Simulation(12, 9, -1.0, 2.0, 0.0, 0.5, dt=0.0005)
+        sim.set_diagnostics()
+        for _ in range(3):
+            sim.step()
+            expected = _reference(sim)
+            data = sim.diagnostic_data()
+            for name, value in expected.items():
+                assert data[name][-1] == pytest.approx(value, rel=1e-10, abs=1e-13), name
+
+    def test_lid_flux_and_energy(self):
+        """Test a lid-driven cavity has kinetic energy and no net wall flux"""
+        sim = cfd_python.Simulation(16, 16)
+        sim.set_diagnostics()
+        sim.step(5)
+        data = sim.diagnostic_data()
+        assert data["kinetic_energy"][-1] > 0.0
+        assert data["enstrophy"][-1] > 0.0
+        assert data["flux_top"][-1] == pytest.approx(0.0, abs=1e-12)
+
+    def test_interval_and_ring(self):
+        """Test every=k and max_samples keep the newest sampled rows"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.set_diagnostics(every=2, max_samples=3)
+        sim.step(12)
+        data = sim.diagnostic_data(clear=True)
+        assert data["step"].tolist() == [8.0, 10.0, 12.0]
+        assert data["dropped"] == 3
+        assert sim.diagnostic_data()["samples"] == 0
+
+    def test_disable(self):
+        """Test every=0 disables the diagnostics"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.set_diagnostics()
+        sim.set_diagnostics(every=0)
+        sim.step()
+        assert sim.diagnostic_data() is None
+
+    def test_rollback_discards_rows(self):
+        """Test rows after a rolled-back state are dropped"""
+        sim = cfd_python.Simulation(16, 16, dt=1.0)
+        sim.set_divergence_guard(check_every=5, max_velocity=10.0, max_retries=6)
+        sim.set_diagnostics()
+        sim.step(40)
+        steps = sim.diagnostic_data()["step"].tolist()
+        assert steps == [float(k) for k in range(1, 41)]
+
+    def test_invalid_arguments(self):
+        """Test invalid settings raise ValueError"""
+        sim = cfd_python.Simulation(8, 8)
+        with pytest.raises(ValueError):
+            sim.set_diagnostics(every=-1)
+        with pytest.raises(ValueError):
+            sim.set_diagnostics(max_samples=-1)
@@ -0,0 +1,123 @@
+"""
+Tests for divergence detection with rollback and dt retry
+"""
+
+import math
+
+import pytest
+
+import cfd_python
+from cfd_python import CFDDivergedError
+
+# dt far beyond the explicit stability limit of a 16x16 grid
+UNSTABLE_DT = 1.0
+
+
+def _unstable_simulation():
+    return cfd_python.Simulation(16, 16, dt=UNSTABLE_DT)
+
+
+class TestDivergenceGuard:
+    """Test Simulation.set_divergence_guard"""
+
+    def test_disabled_by_default(self):
+        """Test a new simulation has no guard"""
+        info = cfd_python.Simulation(8, 8).divergence_info
+        assert info["enabled"] is False
+        assert info["rollbacks"] == 0
+
+    def test_unguarded_run_raises_typed_error(self):
+        """Test the solver's divergence status surfaces as CFDDivergedError"""
+        sim = _unstable_simulation()
+        with pytest.raises(CFDDivergedError):
+            sim.step(1000)
+
+    def test_rollback_rescues_marginal_run(self):
+        """Test rollbacks reduce dt until the run completes"""
+        sim = _unstable_simulation()
+        sim.set_divergence_guard(check_every=5, max_velocity=10.0, max_retries=6)
+        assert sim.step(100) == 100
+        assert sim.step_count == 100
+        assert sim.dt < UNSTABLE_DT
+        info = sim.divergence_info
+        assert info["rollbacks"] >= 1
+        assert info["retries"] == 0
+        assert all(math.isfinite(x) for x in sim.u)
+
+    def test_dt_reduced_by_factor(self):
+        """Test every rollback multiplies dt by dt_factor"""
+        sim = _unstable_simulation()
+        sim.set_divergence_guard(check_every=5, max_velocity=10.0, max_retries=6, dt_factor=0.5)
+        sim.step(100)
+        rollbacks = sim.divergence_info["rollbacks"]
+        assert sim.dt == pytest.approx(UNSTABLE_DT * 0.5**rollbacks)
+
+    def test_retries_exhausted_raises(self):
+        """Test CFDDivergedError after max_retries and state left at the last good step"""
+        sim = _unstable_simulation()
+        sim.set_divergence_guard(check_every=5, max_velocity=10.0, max_retries=1)
+        with pytest.raises(CFDDivergedError):
+            sim.step(100)
+        assert sim.divergence_info["rollbacks"] == 1
+        assert sim.step_count % 5 == 0
+        assert all(math.isfinite(x) for x in sim.u)
+        assert max(abs(x) for x in sim.u) <= 10.0
+
+    def test_nan_detected(self):
+        """Test NaN values injected into the fields trigger a rollback"""
+        sim = cfd_python.Simulation(8, 8, dt=0.001)
+        sim.set_divergence_guard(check_every=2, max_retries=2)
+        sim.step(4)
+        u = sim.u
+        u[20] = float("nan")
+        sim.step(2)
+        assert sim.divergence_info["rollbacks"] == 1
+        assert all(math.isfinite(x) for x in sim.u)
+        assert sim.step_count == 6
+
+    def test_stable_run_unchanged(self):
+        """Test the guard does not alter a stable run"""
+        plain = cfd_python.Simulation(12, 10, dt=0.001)
+        guarded = cfd_python.Simulation(12, 10, dt=0.001)
+        guarded.set_divergence_guard(check_every=3)
+        plain.step(20)
+        guarded.step(20)
+        assert guarded.u.tolist() == plain.u.tolist()
+        assert guarded.dt == plain.dt
+        assert guarded.divergence_info["rollbacks"] == 0
+
+    def test_clone_keeps_policy(self):
+        """Test clones inherit the guard policy"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.set_divergence_guard(check_every=4, max_velocity=5.0, history=3)
+        info = sim.clone().divergence_info
+        assert info["check_every"] == 4
+        assert info["max_velocity"] == 5.0
+        assert info["history"] == 3
+
+    def test_disable(self):
+        """Test check_every=0 disables the guard"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.set_divergence_guard(check_every=5)
+        sim.set_divergence_guard(check_every=0)
+        assert sim.divergence_info["enabled"] is False
+
+    @pytest.mark.parametrize(
+        "kwargs",
+        [{"check_every": -1}, {"max_retries": -1}, {"dt_factor": 1.5}, {"history": 0}],
+    )
+    def test_invalid_arguments(self, kwargs):
+        """Test invalid policies raise ValueError"""
+        with pytest.raises(ValueError):
+            cfd_python.Simulation(8, 8).set_divergence_guard(**kwargs)
+
+
+class TestRunSimulationDivergence:
+    """Test the one-shot functions stop on divergence"""
+
+    def test_run_simulation_with_params_raises(self):
+        """Test run_simulation_with_params raises instead of stepping on NaN"""
+        with pytest.raises(CFDDivergedError):
+            cfd_python.run_simulation_with_params(
+                16, 16, 0.0, 1.0, 0.0, 1.0, steps=1000, dt=UNSTABLE_DT
+            )
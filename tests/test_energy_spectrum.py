@@ -0,0 +1,128 @@
+"""
+Tests for the native kinetic energy spectrum
+"""
+
+import math
+import random
+
+import pytest
+
+import cfd_python
+
+
+def _mode_fields(nx, ny, kx, ky, amplitude=1.0):
+    """u = A cos(kx x + ky y) sampled on [0, 2 pi) without the endpoint"""
+    u = [
+        amplitude * math.cos(2 * math.pi * (kx * i / nx + ky * j / ny))
+        for j in range(ny)
+        for i in range(nx)
+    ]
+    return u, [0.0] * (nx * ny)
+
+
+def _mean_energy(u, v):
+    return 0.5 * sum(a * a + b * b for a, b in zip(u, v)) / len(u)
+
+
+class TestEnergySpectrum:
+    """Test energy_spectrum()"""
+
+    @pytest.mark.parametrize("nx,ny", [(16, 16), (12, 10), (9, 7)])
+    def test_single_mode(self, nx, ny):
+        """Test a single Fourier mode lands in its kx, ky and shell bins"""
+        u, v = _mode_fields(nx, ny, 2, 1, amplitude=2.0)
+        result = cfd_python.energy_spectrum(u, v, nx, ny)
+        energy = _mean_energy(u, v)
+        assert result["energy"] == pytest.approx(energy)
+        assert result["E_x"][2] == pytest.approx(energy)
+        assert result["E_y"][1] == pytest.approx(energy)
+        shell = round(math.hypot(2 * result["kx"][1], result["ky"][1]) / result["dk"])
+        assert result["E"][shell] == pytest.approx(energy)
+        assert sum(result["E"]) == pytest.approx(energy)
+
+    def test_parseval(self):
+        """Test every spectrum sums to the mean kinetic energy"""
+        rng = random.Random(3)
+        nx, ny = 20, 14
+        u = [rng.uniform(-1, 1) for _ in range(nx * ny)]
+        v = [rng.uniform(-1, 1) for _ in range(nx * ny)]
+        result = cfd_python.energy_spectrum(u, v, nx, ny)
+        energy = _mean_energy(u, v)
+        assert result["energy"] == pytest.approx(energy, rel=1e-12)
+        for name in ("E", "E_x", "E_y"):
+            assert sum(result[name]) == pytest.approx(energy, rel=1e-12)
+
+    def test_output_layout(self):
+        """Test wavenumber arrays and lengths"""
+        nx, ny = 16, 8
+        u, v = _mode_fields(nx, ny, 1, 0)
+        grid = cfd_python.Grid(nx, ny, 0.0, 1.0, 0.0, 2.0)
+        result = cfd_python.energy_spectrum(u, v, nx, ny, grid=grid)
+        assert len(result["kx"]) == len(result["E_x"]) == nx // 2 + 1
+        assert len(result["ky"]) == len(result["E_y"]) == ny // 2 + 1
+        assert len(result["k"]) == len(result["E"])
+        assert isinstance(result["E"], memoryview)
+        # Lx = nx * dx = 16/15, Ly = ny * dy = 16/7
+        assert result["kx"][1] == pytest.approx(2 * math.pi * 15 / 16)
+        assert result["ky"][1] == pytest.approx(2 * math.pi * 7 / 16)
+        assert result["dk"] == pytest.approx(result["ky"][1])
+
+    def test_taylor_green_skip_endpoint(self):
+        """Test a Taylor-Green field on a grid storing both periodic ends"""
+        n = 33
+        grid = cfd_python.Grid(n, n, 0.0, 2 * math.pi, 0.0, 2 * math.pi)
+        x = grid.x.tolist()
+        u = [math.sin(x[i]) * math.cos(x[j]) for j in range(n) for i in range(n)]
+        v = [-math.cos(x[i]) * math.sin(x[j]) for j in range(n) for i in range(n)]
+        result = cfd_python.energy_spectrum(u, v, n, n, grid=grid, skip_endpoint=True)
+        assert result["dk"] == pytest.approx(1.0)
+        assert result["energy"] == pytest.approx(0.25)
+        assert result["E"][1] == pytest.approx(0.25)
+        assert max(result["E"][2:]) < 1e-20
+
+    def test_matches_numpy(self):
+        """Test the 1D spectra against numpy.fft"""
+        np = pytest.importorskip("numpy")
+        rng = np.random.default_rng(1)
+        nx, ny = 24, 18
+        u = rng.standard_normal((ny, nx))
+        v = rng.standard_normal((ny, nx))
+        result = cfd_python.energy_spectrum(u.ravel(), v.ravel(), nx, ny)
+        power = 0.5 * (abs(np.fft.fft2(u)) ** 2 + abs(np.fft.fft2(v)) ** 2) / (nx * ny) ** 2
+        kx = np.abs(np.fft.fftfreq(nx, 1.0 / nx)).astype(int)
+        ky = np.abs(np.fft.fftfreq(ny, 1.0 / ny)).astype(int)
+        ex = np.bincount(kx, weights=power.sum(axis=0))
+        ey = np.bincount(ky, weights=power.sum(axis=1))
+        assert np.allclose(result["E_x"], ex, rtol=1e-12, atol=1e-15)
+        assert np.allclose(result["E_y"], ey, rtol=1e-12, atol=1e-15)
+
+    def test_invalid_arguments(self):
+        """Test size mismatches, tiny grids and stretched grids raise"""
+        with pytest.raises(ValueError):
+            cfd_python.energy_spectrum([0.0] * 15, [0.0] * 16, 4, 4)
+        with pytest.raises(ValueError):
+            cfd_python.energy_spectrum([0.0] * 4, [0.0] * 4, 1, 4)
+        grid = cfd_python.Grid(8, 8, 0.0, 1.0, 0.0, 1.0, beta=2.0)
+        with pytest.raises(ValueError):
+            cfd_python.energy_spectrum([0.0] * 64, [0.0] * 64, 8, 8, grid=grid)
+        with pytest.raises(TypeError):
+            cfd_python.energy_spectrum(object(), [0.0] * 16, 4, 4)
+
+
+class TestSimulationEnergySpectrum:
+    """Test Simulation.energy_spectrum()"""
+
+    def test_matches_module_function(self):
+        """Test the method matches energy_spectrum() on the live fields"""
+        sim = cfd_python.Simulation(16, 12)
+        sim.step(2)
+        result = sim.energy_spectrum()
+        expected = cfd_python.energy_spectrum(sim.u, sim.v, 16, 12, grid=sim.grid)
+        assert result["E"].tolist() == expected["E"].tolist()
+        assert result["E_x"].tolist() == expected["E_x"].tolist()
+        assert result["energy"] == expected["energy"]
+
+    def test_exported(self):
+        """Test energy_spectrum is in __all__"""
+        assert "energy_spectrum" in cfd_python.__all__
+        assert callable(cfd_python.energy_spectrum)
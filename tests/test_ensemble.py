@@ -0,0 +1,109 @@
+"""
+Tests for run_ensemble early-exit policies
+"""
+
+import pytest
+
+import cfd_python
+
+
+def _members(*dts, n=16):
+    return [cfd_python.Simulation(n, n, dt=dt) for dt in dts]
+
+
+class TestRunEnsemble:
+    """Test run_ensemble"""
+
+    def test_all_members_complete(self):
+        """Test members without predicates run every step"""
+        members = _members(0.001, 0.002, 0.003)
+        results = cfd_python.run_ensemble(members, 25, check_every=5)
+        assert len(results) == 3
+        for member, result in zip(members, results):
+            assert result["status"] == "completed"
+            assert result["steps"] == 25
+            assert member.step_count == 25
+
+    def test_matches_sequential_step(self):
+        """Test parallel members match stepping each simulation alone"""
+        members = _members(0.001, 0.005)
+        reference = _members(0.001, 0.005)
+        cfd_python.run_ensemble(members, 30, check_every=7)
+        for member, ref in zip(members, reference):
+            ref.step(30)
+            assert member.u.tolist() == ref.u.tolist()
+            assert member.time == pytest.approx(ref.time)
+
+    def test_max_velocity_stops_unstable_member(self):
+        """Test an unstable member is stopped at the first check"""
+        members = _members(0.001, 1.0)
+        results = cfd_python.run_ensemble(members, 200, check_every=10, max_velocity=5.0)
+        assert results[0]["status"] == "completed"
+        assert results[1]["status"] == "max_velocity"
+        assert results[1]["steps"] == 10
+        assert results[1]["max_velocity"] > 5.0
+        assert members[1].step_count == 10
+
+    def test_max_pressure(self):
+        """Test the pressure threshold"""
+        results = cfd_python.run_ensemble(_members(0.001), 10, max_pressure=0.5)
+        assert results[0]["status"] == "max_pressure"
+
+    def test_divergence_stops_member(self):
+        """Test NaN fields stop a member without any thresholds"""
+        results = cfd_python.run_ensemble(_members(1.0), 1000, check_every=50)
+        assert results[0]["status"] == "diverged"
+        assert results[0]["steps"] < 1000
+
+    def test_converge_tol(self):
+        """Test members stop once the residual falls below the tolerance"""
+        members = _members(0.05)
+        results = cfd_python.run_ensemble(members, 5000, converge_tol=1e-6)
+        assert results[0]["status"] == "converged"
+        assert results[0]["steps"] < 5000
+        assert results[0]["residual"] < 1e-6
+
+    def test_max_residual(self):
+        """Test the residual threshold stops fast-changing members"""
+        results = cfd_python.run_ensemble(_members(0.05), 100, check_every=1, max_residual=1e-9)
+        assert results[0]["status"] == "max_residual"
+        assert results[0]["steps"] == 1
+
+    def test_max_divergence(self):
+        """Test the velocity divergence threshold"""
+        results = cfd_python.run_ensemble(_members(0.001), 50, max_divergence=1e-3)
+        assert results[0]["status"] == "max_divergence"
+        assert results[0]["max_divergence"] > 1e-3
+
+    def test_divergence_guard_applies(self):
+        """Test a member's divergence guard rescues it before the policy stops it"""
+        members = _members(1.0)
+        members[0].set_divergence_guard(check_every=5, max_velocity=10.0, max_retries=6)
+        results = cfd_python.run_ensemble(members, 100, check_every=20)
+        assert results[0]["status"] == "completed"
+        assert members[0].divergence_info["rollbacks"] >= 1
+
+    def test_empty(self):
+        """Test an empty ensemble returns an empty list"""
+        assert cfd_python.run_ensemble([], 10) == []
+
+    def test_invalid_members(self):
+        """Test non-Simulation and duplicate members are rejected"""
+        sim = cfd_python.Simulation(8, 8)
+        with pytest.raises(TypeError):
+            cfd_python.run_ensemble([sim, object()], 1)
+        with pytest.raises(ValueError):
+            cfd_python.run_ensemble([sim, sim], 1)
+        assert sim.step() == 1
+
+    @pytest.mark.parametrize("kwargs", [{"steps": -1}, {"check_every": 0}, {"num_threads": -1}])
+    def test_invalid_arguments(self, kwargs):
+        """Test invalid arguments raise ValueError"""
+        args = {"steps": 1}
+        args.update(kwargs)
+        with pytest.raises(ValueError):
+            cfd_python.run_ensemble(_members(0.001), **args)
+
+    def test_exported(self):
+        """Test run_ensemble is in __all__"""
+        assert "run_ensemble" in cfd_python.__all__
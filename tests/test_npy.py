@@ -0,0 +1,207 @@
+"""
+Tests for the native .npy/.npz writers and the memory-mapped .npy reader
+"""
+
+import array
+import ast
+import ctypes
+import struct
+import sys
+import zipfile
+
+import pytest
+
+import cfd_python
+
+
+def _read_npy(data):
+    """Parse a version 1.0 float64 .npy by hand; returns (header dict, values)"""
+    assert data[:8] == b"\x93NUMPY\x01\x00"
+    header_len = struct.unpack("<H", data[8:10])[0]
+    header = ast.literal_eval(data[10 : 10 + header_len].decode("latin1"))
+    values = array.array("d", data[10 + header_len :])
+    return header, values
+
+
+class TestSaveNpy:
+    """Test save_npy()"""
+
+    def test_header_and_data(self, tmp_path):
+        """Test the header is valid, aligned and the data exact"""
+        path = tmp_path / "field.npy"
+        data = [0.5 * i for i in range(12)]
+        cfd_python.save_npy(str(path), data, shape=(3, 4))
+        raw = path.read_bytes()
+        header, values = _read_npy(raw)
+        assert header["shape"] == (3, 4)
+        assert header["fortran_order"] is False
+        assert header["descr"] == ("<f8" if sys.byteorder == "little" else ">f8")
+        assert (len(raw) - len(values) * 8) % 64 == 0
+        assert values.tolist() == data
+
+    def test_shapes(self, tmp_path):
+        """Test flat, int, scalar and empty shapes"""
+        path = tmp_path / "s.npy"
+        for data, shape, expected in (
+            ([1.0, 2.0], None, (2,)),
+            ([1.0, 2.0], 2, (2,)),
+            ([7.0], (), ()),
+            ([], (0, 5), (0, 5)),
+        ):
+            cfd_python.save_npy(str(path), data, shape=shape)
+            assert _read_npy(path.read_bytes())[0]["shape"] == expected
+
+    def test_simulation_view(self, tmp_path):
+        """Test the live Simulation fields are written without going through a list"""
+        sim = cfd_python.Simulation(16, 8)
+        sim.step()
+        path = tmp_path / "p.npy"
+        cfd_python.save_npy(str(path), sim.p, shape=(8, 16))
+        assert _read_npy(path.read_bytes())[1].tolist() == sim.p.tolist()
+
+    def test_bad_shape(self, tmp_path):
+        """Test a shape that does not match the data raises ValueError"""
+        with pytest.raises(ValueError):
+            cfd_python.save_npy(str(tmp_path / "x.npy"), [1.0, 2.0, 3.0], shape=(2, 2))
+        with pytest.raises(ValueError):
+            cfd_python.save_npy(str(tmp_path / "x.npy"), [1.0], shape=(-1,))
+
+    def test_numpy_reads_it(self, tmp_path):
+        """Test np.load() returns the same array"""
+        np = pytest.importorskip("numpy")
+        data = np.arange(30.0).reshape(5, 6)
+        path = tmp_path / "n.npy"
+        cfd_python.save_npy(str(path), data.ravel(), shape=data.shape)
+        assert np.array_equal(np.load(str(path)), data)
+
+
+class TestSaveNpz:
+    """Test save_npz()"""
+
+    def test_simulation_members(self, tmp_path):
+        """Test a Simulation is stored as u, v and p of shape (ny, nx)"""
+        sim = cfd_python.Simulation(12, 10)
+        sim.step()
+        path = tmp_path / "state.npz"
+        cfd_python.save_npz(str(path), sim)
+        with zipfile.ZipFile(str(path)) as archive:
+            assert archive.testzip() is None
+            assert sorted(archive.namelist()) == ["p.npy", "u.npy", "v.npy"]
+            for name in ("u", "v", "p"):
+                info = archive.getinfo(name + ".npy")
+                assert info.compress_type == zipfile.ZIP_STORED
+                header, values = _read_npy(archive.read(name + ".npy"))
+                assert header["shape"] == (10, 12)
+                assert values.tolist() == getattr(sim, name).tolist()
+
+    def test_dict_members(self, tmp_path):
+        """Test dict entries become members, with an optional common shape"""
+        path = tmp_path / "fields.npz"
+        cfd_python.save_npz(
+            str(path), {"a": [1.0, 2.0, 3.0, 4.0], "b": array.array("d", [5.0] * 4)}, shape=(2, 2)
+        )
+        with zipfile.ZipFile(str(path)) as archive:
+            header, values = _read_npy(archive.read("b.npy"))
+        assert header["shape"] == (2, 2)
+        assert values.tolist() == [5.0] * 4
+
+    def test_numpy_reads_snapshot(self, tmp_path):
+        """Test np.load() reads a FieldSnapshot archive"""
+        np = pytest.importorskip("numpy")
+        snap = cfd_python.Simulation(9, 7).snapshot()
+        path = tmp_path / "snap.npz"
+        cfd_python.save_npz(str(path), snap)
+        with np.load(str(path)) as npz:
+            assert npz["v"].shape == (7, 9)
+            assert np.array_equal(npz["v"].ravel(), np.frombuffer(snap.v))
+
+    def test_invalid_inputs(self, tmp_path):
+        """Test wrong source types, names and shapes are rejected"""
+        path = str(tmp_path / "bad.npz")
+        with pytest.raises(TypeError):
+            cfd_python.save_npz(path, [1.0, 2.0])
+        with pytest.raises(TypeError):
+            cfd_python.save_npz(path, {1: [1.0]})
+        with pytest.raises(ValueError):
+            cfd_python.save_npz(path, {"": [1.0]})
+        with pytest.raises(ValueError):
+            cfd_python.save_npz(path, {"a": [1.0, 2.0]}, shape=(3,))
+
+
+@pytest.mark.skipif(
+    sys.platform == "win32", reason="Memory-mapped .npy files are not available on Windows"
+)
+class TestLoadNpy:
+    """Test load_npy()"""
+
+    def test_round_trip_is_zero_copy(self, tmp_path):
+        """Test the view has the file's shape and points into the mapping"""
+        path = tmp_path / "m.npy"
+        data = [float(i) for i in range(24)]
+        cfd_python.save_npy(str(path), data, shape=(4, 6))
+        view = cfd_python.load_npy(str(path))
+        assert view.shape == (4, 6)
+        assert view.readonly
+        assert [x for row in view.tolist() for x in row] == data
+        # The data starts right after the 64-byte aligned header of a page-aligned mapping
+        assert ctypes.addressof(view.obj) % 64 == 0
+
+    def test_empty_array_is_flat(self, tmp_path):
+        """Test an empty multi-dimensional file loads as a flat view of length 0"""
+        path = tmp_path / "e.npy"
+        cfd_python.save_npy(str(path), [], shape=(0, 3))
+        view = cfd_python.load_npy(str(path))
+        assert view.shape == (0,)
+        assert view.tolist() == []
+
+    def test_writable_is_copy_on_write(self, tmp_path):
+        """Test writable views take BC updates while the file stays unchanged"""
+        path = tmp_path / "w.npy"
+        cfd_python.save_npy(str(path), [0.0] * 16)
+        before = path.read_bytes()
+        view = cfd_python.load_npy(str(path), writable=True)
+        assert not view.readonly
+        cfd_python.bc_apply_dirichlet(view, 4, 4, 1.0, 2.0, 3.0, 4.0)
+        assert view[4] == 1.0
+        assert path.read_bytes() == before
+
+    def test_inputs_to_bindings(self, tmp_path):
+        """Test mapped files feed initial conditions and derived fields"""
+        nx, ny = 8, 6
+        path = tmp_path / "u0.npy"
+        cfd_python.save_npy(str(path), [0.25] * (nx * ny), shape=(ny, nx))
+        sim = cfd_python.Simulation(nx, ny)
+        sim.set_fields(u=cfd_python.load_npy(str(path)))
+        assert sim.u.tolist() == [0.25] * (nx * ny)
+        u = cfd_python.load_npy(str(path))
+        result = cfd_python.compute_derived_fields(u, u, nx, ny)
+        assert isinstance(result, dict)
+
+    def test_numpy_files(self, tmp_path):
+        """Test files written by NumPy load, and other dtypes and orders are refused"""
+        np = pytest.importorskip("numpy")
+        path = str(tmp_path / "np.npy")
+        for data in (np.arange(12.0).reshape(3, 4), np.float64(2.5), np.arange(4.0)[None, :]):
+            np.save(path, data)
+            assert np.array_equal(np.asarray(cfd_python.load_npy(path)), data)
+        for data in (np.arange(4, dtype=np.float32), np.asfortranarray(np.ones((2, 3)))):
+            np.save(path, data)
+            with pytest.raises(ValueError):
+                cfd_python.load_npy(path)
+
+    def test_invalid_files(self, tmp_path):
+        """Test truncated and foreign files raise ValueError, missing ones OSError"""
+        path = tmp_path / "t.npy"
+        cfd_python.save_npy(str(path), [1.0] * 10)
+        raw = path.read_bytes()
+        for bad in (raw[:-8], b"not an npy file", raw[:8] + b"\xff\xff" + raw[10:]):
+            path.write_bytes(bad)
+            with pytest.raises(ValueError):
+                cfd_python.load_npy(str(path))
+        with pytest.raises(OSError):
+            cfd_python.load_npy(str(tmp_path / "missing.npy"))
+
+    def test_exported(self):
+        """Test the .npy functions are in __all__"""
+        for name in ("save_npy", "save_npz", "load_npy"):
+            assert name in cfd_python.__all__
@@ -0,0 +1,170 @@
+"""
+Tests for periodic output written inside the step loop
+"""
+
+import csv
+
+import pytest
+
+import cfd_python
+
+
+def _read_csv(path):
+    with open(path, newline="") as f:
+        return list(csv.DictReader(f))
+
+
+class TestSimulationOutputs:
+    """Test Simulation.add_output()"""
+
+    def test_per_step_files(self, tmp_path):
+        """Test a step pattern writes one file per interval"""
+        sim = cfd_python.Simulation(10, 8)
+        pattern = str(tmp_path / "flow_%04d.vtk")
+        sim.add_output(cfd_python.OUTPUT_FULL_FIELD, pattern, every=2, binary=True)
+        sim.step(7)
+        names = sorted(p.name for p in tmp_path.glob("*.vtk"))
+        assert names == ["flow_0002.vtk", "flow_0004.vtk", "flow_0006.vtk"]
+        assert sim.outputs[0]["writes"] == 3
+
+    def test_matches_write_vtk(self, tmp_path):
+        """Test the scheduled file equals Simulation.write_vtk() at that step"""
+        sim = cfd_python.Simulation(12, 9)
+        sim.add_output(cfd_python.OUTPUT_FULL_FIELD, str(tmp_path / "s%d.vtk"), 3, True)
+        sim.step(3)
+        sim.write_vtk(str(tmp_path / "direct.vtk"), binary=True)
+        assert (tmp_path / "s3.vtk").read_bytes() == (tmp_path / "direct.vtk").read_bytes()
+
+    def test_statistics_rows(self, tmp_path):
+        """Test a fixed name collects one statistics row per write"""
+        sim = cfd_python.Simulation(8, 8)
+        path = tmp_path / "stats.csv"
+        sim.add_output(cfd_python.OUTPUT_CSV_STATISTICS, str(path), every=2)
+        sim.step(6)
+        rows = _read_csv(path)
+        assert [int(r["step"]) for r in rows] == [2, 4, 6]
+        u = sim.u.tolist()
+        assert float(rows[-1]["u_min"]) == min(u)
+        assert float(rows[-1]["u_max"]) == max(u)
+        assert float(rows[-1]["time"]) == pytest.approx(sim.time)
+
+    def test_centerline(self, tmp_path):
+        """Test the centerline CSV holds both lines through the middle"""
+        nx, ny = 7, 5
+        sim = cfd_python.Simulation(nx, ny)
+        sim.add_output(cfd_python.OUTPUT_CSV_CENTERLINE, str(tmp_path / "line_%d.csv"))
+        sim.step()
+        rows = _read_csv(tmp_path / "line_1.csv")
+        horizontal = [r for r in rows if r["axis"] == "x"]
+        vertical = [r for r in rows if r["axis"] == "y"]
+        assert len(horizontal) == nx and len(vertical) == ny
+        p = sim.p.tolist()
+        assert [float(r["p"]) for r in horizontal] == p[(ny // 2) * nx : (ny // 2 + 1) * nx]
+        assert [float(r["p"]) for r in vertical] == p[nx // 2 :: nx]
+
+    def test_outputs_and_clear(self, tmp_path):
+        """Test outputs lists the schedule and clear_outputs() empties it"""
+        sim = cfd_python.Simulation(6, 6)
+        sim.add_output(cfd_python.OUTPUT_VELOCITY, str(tmp_path / "v_%d.vtk"), every=5)
+        sim.add_output(cfd_python.OUTPUT_CSV_TIMESERIES, str(tmp_path / "ts.csv"))
+        outputs = sim.outputs
+        assert [o["type"] for o in outputs] == [
+            cfd_python.OUTPUT_VELOCITY,
+            cfd_python.OUTPUT_CSV_TIMESERIES,
+        ]
+        assert outputs[0]["every"] == 5 and outputs[0]["binary"] is False
+        assert sim.clone().outputs == []
+        sim.clear_outputs()
+        assert sim.outputs == []
+        sim.step(5)
+        assert list(tmp_path.iterdir()) == []
+
+    def test_failed_write_raises(self, tmp_path):
+        """Test an unwritable output stops step() with CFDIOError"""
+        sim = cfd_python.Simulation(6, 6)
+        sim.add_output(cfd_python.OUTPUT_CSV_STATISTICS, str(tmp_path / "missing" / "s.csv"), 2)
+        with pytest.raises(cfd_python.CFDIOError) as info:
+            sim.step(5)
+        assert isinstance(info.value, OSError)
+        assert "missing" in str(info.value)
+        assert sim.step_count == 2
+
+    def test_invalid_arguments(self, tmp_path):
+        """Test bad types, intervals and patterns raise ValueError"""
+        sim = cfd_python.Simulation(6, 6)
+        path = str(tmp_path / "a_%d.vtk")
+        with pytest.raises(ValueError):
+            sim.add_output(99, path)
+        with pytest.raises(ValueError):
+            sim.add_output(cfd_python.OUTPUT_VELOCITY, path, every=0)
+        for name in ["a_%s.vtk", "a_%d_%d.vtk", "a_%x.vtk", "a_%.vtk"]:
+            with pytest.raises(ValueError):
+                sim.add_output(cfd_python.OUTPUT_VELOCITY, str(tmp_path / name))
+        with pytest.raises(ValueError):
+            sim.add_output(cfd_python.OUTPUT_VELOCITY, "")
+        assert sim.outputs == []
+
+    def test_conversion_width_limit(self, tmp_path):
+        """Test widths up to 20 digits expand and wider ones are rejected"""
+        sim = cfd_python.Simulation(6, 6)
+        sim.add_output(cfd_python.OUTPUT_CSV_STATISTICS, str(tmp_path / "s_%020d.csv"))
+        for name in ["s_%021d.csv", "s_%0120d.csv", "s_%99999999999d.csv"]:
+            with pytest.raises(ValueError):
+                sim.add_output(cfd_python.OUTPUT_CSV_STATISTICS, str(tmp_path / name))
+        sim.step()
+        assert (tmp_path / ("s_" + "0" * 19 + "1.csv")).exists()
+
+    def test_escaped_percent(self, tmp_path):
+        """Test %% is a literal percent sign"""
+        sim = cfd_python.Simulation(6, 6)
+        sim.add_output(cfd_python.OUTPUT_CSV_STATISTICS, str(tmp_path / "100%%_%03d.csv"))
+        sim.step()
+        assert (tmp_path / "100%_001.csv").exists()
+
+
+class TestRunOutputs:
+    """Test the outputs= argument of the run functions"""
+
+    def test_run_simulation_with_params(self, tmp_path):
+        """Test scheduled outputs are written during the run"""
+        cfd_python.run_simulation_with_params(
+            8,
+            8,
+            0.0,
+            1.0,
+            0.0,
+            1.0,
+            steps=4,
+            outputs=[
+                (cfd_python.OUTPUT_VELOCITY_MAGNITUDE, str(tmp_path / "m_%d.vtk"), 2, True),
+                (cfd_python.OUTPUT_CSV_STATISTICS, str(tmp_path / "stats.csv")),
+            ],
+        )
+        assert (tmp_path / "m_2.vtk").exists() and (tmp_path / "m_4.vtk").exists()
+        rows = _read_csv(tmp_path / "stats.csv")
+        assert [int(r["step"]) for r in rows] == [1, 2, 3, 4]
+        assert float(rows[-1]["time"]) == pytest.approx(4 * 0.001)
+
+    def test_run_simulation(self, tmp_path):
+        """Test run_simulation accepts the same specs"""
+        cfd_python.run_simulation(
+            6, 6, steps=3, outputs=[(cfd_python.OUTPUT_CSV_CENTERLINE, str(tmp_path / "c%d.csv"))]
+        )
+        assert sorted(p.name for p in tmp_path.iterdir()) == ["c1.csv", "c2.csv", "c3.csv"]
+
+    def test_invalid_specs(self, tmp_path):
+        """Test malformed specs raise before the run starts"""
+        with pytest.raises(TypeError):
+            cfd_python.run_simulation(4, 4, steps=1, outputs=[("a.vtk",)])
+        with pytest.raises(ValueError):
+            cfd_python.run_simulation(4, 4, steps=1, outputs=[(-1, str(tmp_path / "a.vtk"))])
+
+    def test_failed_write_raises(self, tmp_path):
+        """Test an unwritable output raises CFDIOError"""
+        with pytest.raises(cfd_python.CFDIOError):
+            cfd_python.run_simulation(
+                4,
+                4,
+                steps=2,
+                outputs=[(cfd_python.OUTPUT_CSV_STATISTICS, str(tmp_path / "no" / "s.csv"))],
+            )
@@ -0,0 +1,164 @@
+"""
+Tests for native particle tracers
+"""
+
+import array
+import math
+
+import pytest
+
+import cfd_python
+
+
+def _positions(values):
+    return array.array("d", values)
+
+
+def _field(nx, ny, fn, grid=None):
+    """Sample (u, v) = fn(x, y) on the grid nodes"""
+    if grid is None:
+        grid = cfd_python.Grid(nx, ny, 0.0, 1.0, 0.0, 1.0)
+    xs, ys = grid.x.tolist(), grid.y.tolist()
+    pairs = [fn(x, y) for y in ys for x in xs]
+    return [p[0] for p in pairs], [p[1] for p in pairs]
+
+
+class TestAdvectParticles:
+    """Test advect_particles()"""
+
+    @pytest.mark.parametrize("method", ["rk2", "rk4"])
+    def test_uniform_flow(self, method):
+        """Test uniform flow translates particles exactly"""
+        u, v = _field(9, 9, lambda x, y: (1.0, 0.5))
+        x = _positions([0.1, 0.5])
+        y = _positions([0.2, 0.3])
+        active = cfd_python.advect_particles(x, y, u, v, 9, 9, 0.1, steps=3, method=method)
+        assert active == 2
+        assert x.tolist() == pytest.approx([0.4, 0.8])
+        assert y.tolist() == pytest.approx([0.35, 0.45])
+
+    def test_rotation_rk4_more_accurate(self):
+        """Test RK4 keeps a solid-body rotation radius better than RK2"""
+        grid = cfd_python.Grid(17, 17, 0.0, 1.0, 0.0, 1.0, beta=1.5)
+        u, v = _field(17, 17, lambda x, y: (-(y - 0.5), x - 0.5), grid=grid)
+        errors = {}
+        for method in ("rk2", "rk4"):
+            x = _positions([0.8])
+            y = _positions([0.5])
+            steps = 100
+            dt = 2 * math.pi / steps
+            cfd_python.advect_particles(x, y, u, v, 17, 17, dt, steps, grid, method)
+            errors[method] = math.hypot(x[0] - 0.8, y[0] - 0.5)
+        assert errors["rk4"] < 1e-6
+        assert errors["rk4"] < errors["rk2"]
+
+    def test_leaving_particles_become_nan(self):
+        """Test particles that leave the grid are NaN and not counted"""
+        u, v = _field(5, 5, lambda x, y: (1.0, 0.0))
+        x = _positions([0.1, 0.95])
+        y = _positions([0.5, 0.5])
+        active = cfd_python.advect_particles(x, y, u, v, 5, 5, 0.1)
+        assert active == 1
+        assert x[0] == pytest.approx(0.2)
+        assert math.isnan(x[1]) and math.isnan(y[1])
+        assert cfd_python.advect_particles(x, y, u, v, 5, 5, 0.1) == 1
+
+    def test_numpy_positions(self):
+        """Test NumPy position arrays are updated in place"""
+        np = pytest.importorskip("numpy")
+        u, v = _field(5, 5, lambda x, y: (0.0, 1.0))
+        x = np.full(1000, 0.5)
+        y = np.linspace(0.0, 0.5, 1000)
+        cfd_python.advect_particles(x, y, u, v, 5, 5, 0.25)
+        assert np.allclose(y, np.linspace(0.25, 0.75, 1000))
+
+    def test_invalid_arguments(self):
+        """Test non-writable positions, size mismatches and bad options raise"""
+        u, v = _field(4, 4, lambda x, y: (0.0, 0.0))
+        with pytest.raises(TypeError):
+            cfd_python.advect_particles([0.5], [0.5], u, v, 4, 4, 0.1)
+        with pytest.raises(ValueError):
+            cfd_python.advect_particles(_positions([0.5]), _positions([0.5, 0.5]), u, v, 4, 4, 0.1)
+        with pytest.raises(ValueError):
+            cfd_python.advect_particles(_positions([0.5]), _positions([0.5]), u, v[:-1], 4, 4, 0.1)
+        with pytest.raises(ValueError):
+            cfd_python.advect_particles(
+                _positions([0.5]), _positions([0.5]), u, v, 4, 4, 0.1, method="euler"
+            )
+        with pytest.raises(ValueError):
+            cfd_python.advect_particles(_positions([0.5]), _positions([0.5]), u, v, 4, 4, 0.1, 0)
+
+
+class TestSimulationParticles:
+    """Test Simulation.set_particles(), advect_particles() and particles"""
+
+    def test_no_particles(self):
+        """Test the defaults without particles"""
+        sim = cfd_python.Simulation(8, 8)
+        assert sim.particles is None
+        with pytest.raises(RuntimeError):
+            sim.advect_particles()
+
+    def test_step_loop_matches_module_function(self):
+        """Test in-loop advection equals advect_particles() on the new fields"""
+        sim = cfd_python.Simulation(12, 10)
+        u, v = _field(12, 10, lambda x, y: (0.3 + 0.2 * y, 0.1 * x))
+        sim.set_fields(u=u, v=v)
+        seeds_x, seeds_y = [0.2, 0.5, 0.7], [0.3, 0.5, 0.6]
+        sim.set_particles(seeds_x, seeds_y, method="rk2")
+        sim.step()
+
+        x, y = _positions(seeds_x), _positions(seeds_y)
+        cfd_python.advect_particles(x, y, sim.u, sim.v, 12, 10, sim.dt, method="rk2")
+        particles = sim.particles
+        assert particles["steps"] == 1
+        assert particles["method"] == "rk2"
+        assert particles["x"].tolist() == x.tolist()
+        assert particles["y"].tolist() == y.tolist()
+
+    def test_every_zero_only_manual(self):
+        """Test every=0 leaves particles alone until advect_particles()"""
+        sim = cfd_python.Simulation(8, 8)
+        u, v = _field(8, 8, lambda x, y: (1.0, 0.0))
+        sim.set_particles([0.25], [0.5], every=0)
+        sim.step(2)
+        assert sim.particles["x"][0] == 0.25
+        sim.set_fields(u=u, v=v)
+        assert sim.advect_particles(dt=0.1, steps=2) == 1
+        assert sim.particles["x"][0] == pytest.approx(0.45)
+        assert sim.particles["steps"] == 2
+
+    def test_views_are_zero_copy(self):
+        """Test position views alias the native arrays and outlive removal"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.set_particles([0.1, 0.2], [0.3, 0.4], every=0)
+        x = sim.particles["x"]
+        assert not x.readonly
+        x[1] = 0.9
+        assert sim.particles["x"][1] == 0.9
+        sim.set_particles(None)
+        assert sim.particles is None
+        assert x.tolist() == [0.1, 0.9]
+
+    def test_active_count(self):
+        """Test particles seeded outside the grid are dropped on advection"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.set_particles([0.5, 2.0], [0.5, 0.5], every=0)
+        assert sim.advect_particles() == 1
+        assert sim.particles["active"] == 1
+        assert sim.particles["count"] == 2
+
+    def test_invalid_arguments(self):
+        """Test mismatched seeds and bad options raise"""
+        sim = cfd_python.Simulation(8, 8)
+        with pytest.raises(ValueError):
+            sim.set_particles([0.1, 0.2], [0.3])
+        with pytest.raises(ValueError):
+            sim.set_particles([0.1], [0.3], method="euler")
+        with pytest.raises(ValueError):
+            sim.set_particles([0.1], [0.3], every=-1)
+
+    def test_exported(self):
+        """Test advect_particles is in __all__"""
+        assert "advect_particles" in cfd_python.__all__
+        assert callable(cfd_python.advect_particles)
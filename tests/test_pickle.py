@@ -0,0 +1,178 @@
+"""
+Tests for native Grid/FieldSnapshot objects and pickle protocol 5 support
+"""
+
+import array
+import pickle
+
+import pytest
+
+import cfd_python
+
+
+def _make_snapshot(nx=4, ny=3):
+    n = nx * ny
+    u = [float(i) for i in range(n)]
+    v = [float(-i) for i in range(n)]
+    p = [0.5 * i for i in range(n)]
+    return cfd_python.FieldSnapshot(u, v, p, nx, ny, time=0.25, step=7)
+
+
+class TestGridObject:
+    """Test the native Grid type"""
+
+    def test_uniform_grid_matches_create_grid(self):
+        """Test Grid coordinates match create_grid()"""
+        grid = cfd_python.Grid(5, 4, 0.0, 1.0, 0.0, 2.0)
+        reference = cfd_python.create_grid(5, 4, 0.0, 1.0, 0.0, 2.0)
+        assert grid.nx == 5
+        assert grid.ny == 4
+        assert grid.xmax == 1.0
+        assert grid.ymax == 2.0
+        assert grid.x.tolist() == reference["x_coords"]
+        assert grid.y.tolist() == reference["y_coords"]
+
+    def test_coordinates_are_read_only_views(self):
+        """Test coordinates are exposed as read-only double memoryviews"""
+        grid = cfd_python.Grid(5, 4, 0.0, 1.0, 0.0, 1.0)
+        assert isinstance(grid.x, memoryview)
+        assert grid.x.format == "d"
+        assert grid.x.readonly
+        with pytest.raises(TypeError):
+            grid.x[0] = 1.0
+
+    def test_view_keeps_grid_alive(self):
+        """Test a coordinate view stays valid after the grid is released"""
+        x = cfd_python.Grid(5, 4, 0.0, 1.0, 0.0, 1.0).x
+        assert x[-1] == pytest.approx(1.0)
+
+    def test_to_dict(self):
+        """Test to_dict returns the create_grid() format"""
+        d = cfd_python.Grid(5, 4, 0.0, 1.0, 0.0, 1.0).to_dict()
+        assert d == cfd_python.create_grid(5, 4, 0.0, 1.0, 0.0, 1.0)
+
+    def test_stretched_grid(self):
+        """Test beta selects the stretched distribution"""
+        grid = cfd_python.Grid(8, 8, 0.0, 1.0, 0.0, 1.0, beta=2.0)
+        reference = cfd_python.create_grid_stretched(8, 8, 0.0, 1.0, 0.0, 1.0, 2.0)
+        assert grid.x.tolist() == reference["x_coords"]
+
+    def test_invalid_dimensions(self):
+        """Test invalid arguments raise ValueError"""
+        with pytest.raises(ValueError):
+            cfd_python.Grid(1, 4, 0.0, 1.0, 0.0, 1.0)
+        with pytest.raises(ValueError):
+            cfd_python.Grid(4, 4, 1.0, 0.0, 0.0, 1.0)
+        with pytest.raises(ValueError):
+            cfd_python.Grid(4, 4, 0.0, 1.0, 0.0, 1.0, beta=-1.0)
+
+
+class TestFieldSnapshotObject:
+    """Test the native FieldSnapshot type"""
+
+    def test_attributes(self):
+        """Test snapshot metadata and field views"""
+        snap = _make_snapshot()
+        assert snap.nx == 4
+        assert snap.ny == 3
+        assert snap.time == 0.25
+        assert snap.step == 7
+        assert snap.u.tolist() == [float(i) for i in range(12)]
+        assert snap.p.format == "d"
+
+    def test_constructor_copies_input(self):
+        """Test snapshot data is independent of the input buffer"""
+        source = array.array("d", [1.0] * 6)
+        snap = cfd_python.FieldSnapshot(source, source, source, 3, 2)
+        source[0] = 99.0
+        assert snap.u[0] == 1.0
+
+    def test_size_mismatch(self):
+        """Test mismatched field sizes raise ValueError"""
+        with pytest.raises(ValueError):
+            cfd_python.FieldSnapshot([0.0] * 5, [0.0] * 6, [0.0] * 6, 3, 2)
+
+    def test_invalid_buffer_type(self):
+        """Test non-numeric input raises TypeError"""
+        with pytest.raises(TypeError):
+            cfd_python.FieldSnapshot(object(), [0.0], [0.0], 1, 1)
+
+    def test_run_simulation_snapshot(self):
+        """Test run_simulation_with_params(snapshot=True) returns native objects"""
+        result = cfd_python.run_simulation_with_params(
+            6, 5, 0.0, 1.0, 0.0, 1.0, steps=2, dt=0.001, snapshot=True
+        )
+        assert "velocity_magnitude" not in result
+        snap = result["snapshot"]
+        assert isinstance(snap, cfd_python.FieldSnapshot)
+        assert snap.step == 2
+        assert snap.time == pytest.approx(0.002)
+        assert len(snap.u) == 30
+        assert isinstance(result["grid"], cfd_python.Grid)
+        assert result["grid"].nx == 6
+
+
+class TestPickleProtocol5:
+    """Test pickling with in-band and out-of-band buffers"""
+
+    @pytest.mark.parametrize("protocol", range(2, pickle.HIGHEST_PROTOCOL + 1))
+    def test_snapshot_roundtrip(self, protocol):
+        """Test snapshots survive pickling with every protocol"""
+        snap = _make_snapshot()
+        restored = pickle.loads(pickle.dumps(snap, protocol=protocol))
+        assert restored.nx == snap.nx
+        assert restored.step == snap.step
+        assert restored.time == snap.time
+        assert restored.u.tolist() == snap.u.tolist()
+        assert restored.v.tolist() == snap.v.tolist()
+        assert restored.p.tolist() == snap.p.tolist()
+
+    @pytest.mark.parametrize("protocol", range(2, pickle.HIGHEST_PROTOCOL + 1))
+    def test_grid_roundtrip(self, protocol):
+        """Test grids survive pickling with every protocol"""
+        grid = cfd_python.Grid(6, 5, -1.0, 1.0, 0.0, 3.0)
+        restored = pickle.loads(pickle.dumps(grid, protocol=protocol))
+        assert restored.nx == 6
+        assert restored.ymax == 3.0
+        assert restored.x.tolist() == grid.x.tolist()
+        assert restored.y.tolist() == grid.y.tolist()
+
+    def test_out_of_band_buffers(self):
+        """Test protocol 5 emits one out-of-band buffer per field"""
+        snap = _make_snapshot(64, 64)
+        buffers = []
+        data = pickle.dumps(snap, protocol=5, buffer_callback=buffers.append)
+        assert len(buffers) == 3
+        assert len(data) < 1024
+        for buf in buffers:
+            assert buf.raw().nbytes == 64 * 64 * 8
+
+        restored = pickle.loads(data, buffers=buffers)
+        assert restored.u.tolist() == snap.u.tolist()
+
+    def test_out_of_band_restore_is_zero_copy(self):
+        """Test unpickling adopts the received buffers without copying"""
+        snap = _make_snapshot()
+        payloads = []
+        data = pickle.dumps(
+            snap, protocol=5, buffer_callback=lambda b: payloads.append(bytearray(b.raw()))
+        )
+        restored = pickle.loads(data, buffers=payloads)
+        payloads[0][0:8] = array.array("d", [123.0]).tobytes()
+        assert restored.u[0] == 123.0
+
+    def test_out_of_band_read_only_buffers(self):
+        """Test read-only received buffers are accepted"""
+        snap = _make_snapshot()
+        payloads = []
+        data = pickle.dumps(
+            snap, protocol=5, buffer_callback=lambda b: payloads.append(b.raw().tobytes())
+        )
+        restored = pickle.loads(data, buffers=payloads)
+        assert restored.p.tolist() == snap.p.tolist()
+        assert restored.p.readonly
+
+    def test_types_exported(self):
+        """Test Grid and FieldSnapshot are in __all__"""
+        assert "Grid" in cfd_python.__all__
+        assert "FieldSnapshot" in cfd_python.__all__
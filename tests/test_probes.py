@@ -0,0 +1,131 @@
+"""
+Tests for probe points recorded inside the Simulation step loop
+"""
+
+import math
+
+import pytest
+
+import cfd_python
+
+
+def _interpolate(values, xs, ys, x, y):
+    """Reference bilinear interpolation on a (possibly non-uniform) grid"""
+    nx = len(xs)
+    i = max(k for k in range(nx - 1) if xs[k] <= x)
+    j = max(k for k in range(len(ys) - 1) if ys[k] <= y)
+    wx = (x - xs[i]) / (xs[i + 1] - xs[i])
+    wy = (y - ys[j]) / (ys[j + 1] - ys[j])
+    f00, f10 = values[j * nx + i], values[j * nx + i + 1]
+    f01, f11 = values[(j + 1) * nx + i], values[(j + 1) * nx + i + 1]
+    return (1 - wy) * ((1 - wx) * f00 + wx * f10) + wy * ((1 - wx) * f01 + wx * f11)
+
+
+def _unpack(view):
+    values = view.tolist()
+    return [tuple(values[i : i + 3]) for i in range(0, len(values), 3)]
+
+
+class TestSetProbes:
+    """Test Simulation.set_probes and Simulation.probe_data"""
+
+    def test_no_probes_by_default(self):
+        """Test probe_data returns None without probes"""
+        assert cfd_python.Simulation(8, 8).probe_data() is None
+
+    def test_samples_every_step(self):
+        """Test one sample row is recorded per step"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.set_probes([(0.5, 0.5), (0.25, 0.75)])
+        sim.step(5)
+        data = sim.probe_data()
+        assert data["samples"] == 5
+        assert data["dropped"] == 0
+        assert data["points"] == [(0.5, 0.5), (0.25, 0.75)]
+        assert data["step"].tolist() == [1.0, 2.0, 3.0, 4.0, 5.0]
+        assert data["time"].tolist() == pytest.approx([0.001 * k for k in range(1, 6)])
+        assert len(data["probes"]) == 2
+        for view in data["probes"]:
+            assert view.format == "d"
+            assert len(view) == 15
+
+    def test_bilinear_interpolation(self):
+        """Test probes match bilinear interpolation of the live fields"""
+        sim = cfd_python.Simulation(9, 7, 0.0, 2.0, -1.0, 1.0)
+        points = [(0.3, -0.7), (1.9, 0.95), (0.0, -1.0), (2.0, 1.0), (1.0, 0.0)]
+        sim.set_probes(points)
+        sim.step(3)
+        xs, ys = sim.grid.x.tolist(), sim.grid.y.tolist()
+        fields = (sim.u.tolist(), sim.v.tolist(), sim.p.tolist())
+        for (x, y), view in zip(points, sim.probe_data()["probes"]):
+            last = _unpack(view)[-1]
+            for value, field in zip(last, fields):
+                expected = _interpolate(field, xs, ys, x, y)
+                assert math.isclose(value, expected, rel_tol=1e-12, abs_tol=1e-15)
+
+    def test_sampling_interval(self):
+        """Test every=k samples only every k-th step"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.set_probes([(0.5, 0.5)], every=4)
+        sim.step(10)
+        assert sim.probe_data()["step"].tolist() == [4.0, 8.0]
+
+    def test_ring_buffer_keeps_newest(self):
+        """Test max_samples keeps only the newest rows"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.set_probes([(0.5, 0.5)], max_samples=3)
+        sim.step(7)
+        data = sim.probe_data()
+        assert data["samples"] == 3
+        assert data["dropped"] == 4
+        assert data["step"].tolist() == [5.0, 6.0, 7.0]
+
+    def test_growable_store(self):
+        """Test the default store grows past its initial allocation"""
+        sim = cfd_python.Simulation(6, 6)
+        sim.set_probes([(0.5, 0.5)])
+        sim.step(600)
+        assert sim.probe_data()["samples"] == 600
+
+    def test_clear(self):
+        """Test clear=True empties the store after reading"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.set_probes([(0.5, 0.5)])
+        sim.step(3)
+        assert sim.probe_data(clear=True)["samples"] == 3
+        sim.step(2)
+        assert sim.probe_data()["step"].tolist() == [4.0, 5.0]
+
+    def test_rollback_discards_samples(self):
+        """Test samples after a rolled-back state are dropped"""
+        sim = cfd_python.Simulation(16, 16, dt=1.0)
+        sim.set_divergence_guard(check_every=5, max_velocity=10.0, max_retries=6)
+        sim.set_probes([(0.5, 0.5)])
+        sim.step(40)
+        steps = sim.probe_data()["step"].tolist()
+        assert steps == sorted(set(steps))
+        assert steps[-1] == 40.0
+
+    def test_remove_probes(self):
+        """Test points=None removes the probes"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.set_probes([(0.5, 0.5)])
+        sim.set_probes(None)
+        sim.step()
+        assert sim.probe_data() is None
+
+    def test_outside_grid_raises(self):
+        """Test probes outside the domain raise ValueError"""
+        sim = cfd_python.Simulation(8, 8)
+        with pytest.raises(ValueError, match="outside the grid"):
+            sim.set_probes([(0.5, 0.5), (1.5, 0.5)])
+
+    def test_invalid_points(self):
+        """Test malformed points and arguments raise"""
+        sim = cfd_python.Simulation(8, 8)
+        with pytest.raises(ValueError):
+            sim.set_probes([(0.5, 0.5, 0.5)])
+        with pytest.raises(TypeError):
+            sim.set_probes([("a", 0.5)])
+        with pytest.raises(ValueError):
+            sim.set_probes([(0.5, 0.5)], every=0)
@@ -0,0 +1,175 @@
+"""
+Tests for field restriction, region-of-interest extraction and decimated output
+"""
+
+import array
+import math
+
+import pytest
+
+import cfd_python
+
+
+def _ramp(nx, ny):
+    """Field with value i + 100*j at node (i, j)"""
+    return [float(i + 100 * j) for j in range(ny) for i in range(nx)]
+
+
+def _reference(data, nx, ny, fx, fy, roi, mode):
+    i0, i1, j0, j1 = roi
+    out = []
+    for j in range(j0, j1, fy):
+        for i in range(i0, i1, fx):
+            if mode == "inject":
+                out.append(data[j * nx + i])
+                continue
+            block = [
+                data[jj * nx + ii]
+                for jj in range(j, min(j + fy, j1))
+                for ii in range(i, min(i + fx, i1))
+            ]
+            out.append(sum(block) / len(block))
+    return out
+
+
+class TestResampleFields:
+    """Test resample_fields()"""
+
+    @pytest.mark.parametrize("mode", ["average", "inject"])
+    @pytest.mark.parametrize("factor", [1, 2, 3, (2, 3)])
+    def test_matches_reference(self, mode, factor):
+        """Test results match a Python block-mean / injection reference"""
+        nx, ny = 11, 8
+        data = _ramp(nx, ny)
+        fx, fy = factor if isinstance(factor, tuple) else (factor, factor)
+        result = cfd_python.resample_fields(data, nx, ny, factor=factor, mode=mode)
+        expected = _reference(data, nx, ny, fx, fy, (0, nx, 0, ny), mode)
+        assert result["nx"] == math.ceil(nx / fx)
+        assert result["ny"] == math.ceil(ny / fy)
+        assert result["values"].tolist() == pytest.approx(expected)
+
+    def test_roi_copy(self):
+        """Test factor=1 with a window is an exact region copy"""
+        nx, ny = 10, 6
+        data = _ramp(nx, ny)
+        result = cfd_python.resample_fields(data, nx, ny, roi=(2, 7, 1, 4))
+        assert (result["nx"], result["ny"]) == (5, 3)
+        assert result["values"].tolist() == _reference(data, nx, ny, 1, 1, (2, 7, 1, 4), "inject")
+
+    def test_roi_with_factor(self):
+        """Test windowed averaging with partial edge blocks"""
+        nx, ny = 12, 9
+        data = _ramp(nx, ny)
+        roi = (1, 10, 2, 9)
+        result = cfd_python.resample_fields(data, nx, ny, factor=2, roi=roi)
+        expected = _reference(data, nx, ny, 2, 2, roi, "average")
+        assert (result["nx"], result["ny"]) == (5, 4)
+        assert result["values"].tolist() == pytest.approx(expected)
+
+    def test_coordinates(self):
+        """Test output coordinates are node or block-mean positions"""
+        grid = cfd_python.Grid(9, 5, 0.0, 8.0, 0.0, 4.0)
+        data = [0.0] * 45
+        inject = cfd_python.resample_fields(data, 9, 5, factor=2, mode="inject", grid=grid)
+        assert inject["x"].tolist() == pytest.approx([0.0, 2.0, 4.0, 6.0, 8.0])
+        assert inject["y"].tolist() == pytest.approx([0.0, 2.0, 4.0])
+        average = cfd_python.resample_fields(data, 9, 5, factor=2, grid=grid)
+        assert average["x"].tolist() == pytest.approx([0.5, 2.5, 4.5, 6.5, 8.0])
+        assert average["y"].tolist() == pytest.approx([0.5, 2.5, 4.0])
+
+    def test_vector_dict(self):
+        """Test a dict resamples every component with the same plan"""
+        nx, ny = 8, 6
+        u = _ramp(nx, ny)
+        v = array.array("d", [-x for x in u])
+        result = cfd_python.resample_fields({"u": u, "v": v}, nx, ny, factor=2)
+        assert set(result) == {"nx", "ny", "x", "y", "u", "v"}
+        assert result["v"].tolist() == pytest.approx([-x for x in result["u"].tolist()])
+
+    def test_preserves_mean_for_even_blocks(self):
+        """Test averaging by an exact divisor preserves the field mean"""
+        nx, ny = 8, 8
+        data = [math.sin(0.3 * k) for k in range(nx * ny)]
+        values = cfd_python.resample_fields(data, nx, ny, factor=4)["values"].tolist()
+        assert sum(values) / len(values) == pytest.approx(sum(data) / len(data))
+
+    def test_numpy_input(self):
+        """Test NumPy arrays are accepted"""
+        np = pytest.importorskip("numpy")
+        data = np.arange(20.0)
+        result = cfd_python.resample_fields(data, 5, 4, factor=2, mode="inject")
+        assert result["values"].tolist() == [0.0, 2.0, 4.0, 10.0, 12.0, 14.0]
+
+    def test_invalid_arguments(self):
+        """Test bad factors, windows and modes raise"""
+        data = [0.0] * 20
+        with pytest.raises(ValueError):
+            cfd_python.resample_fields(data, 5, 4, factor=0)
+        with pytest.raises(ValueError):
+            cfd_python.resample_fields(data, 5, 4, roi=(0, 6, 0, 4))
+        with pytest.raises(ValueError):
+            cfd_python.resample_fields(data, 5, 4, roi=(3, 3, 0, 4))
+        with pytest.raises(ValueError):
+            cfd_python.resample_fields(data, 5, 4, mode="cubic")
+        with pytest.raises(ValueError):
+            cfd_python.resample_fields(data[:-1], 5, 4)
+        with pytest.raises(TypeError):
+            cfd_python.resample_fields(data, 5, 4, factor="2")
+        with pytest.raises(TypeError):
+            cfd_python.resample_fields(data, 5, 4, roi=(0, 1))
+
+
+class TestSimulationResample:
+    """Test Simulation.resample() and the decimated writers"""
+
+    def test_matches_module_function(self):
+        """Test the method matches resample_fields() on the live fields"""
+        sim = cfd_python.Simulation(12, 10)
+        sim.step(3)
+        result = sim.resample(factor=(3, 2), roi=(0, 12, 2, 10))
+        expected = cfd_python.resample_fields(
+            {"u": sim.u, "p": sim.p}, 12, 10, factor=(3, 2), roi=(0, 12, 2, 10), grid=sim.grid
+        )
+        assert result["u"].tolist() == expected["u"].tolist()
+        assert result["p"].tolist() == expected["p"].tolist()
+        assert result["x"].tolist() == expected["x"].tolist()
+
+    def test_write_vtk_decimated(self, tmp_path):
+        """Test write_vtk writes only the decimated region"""
+        sim = cfd_python.Simulation(17, 9, xmax=2.0)
+        sim.step(2)
+        full = tmp_path / "full.vtk"
+        coarse = tmp_path / "coarse.vtk"
+        sim.write_vtk(str(full))
+        sim.write_vtk(str(coarse), factor=4, roi=(0, 17, 0, 9))
+        assert "DIMENSIONS 17 9 1" in full.read_text()
+        text = coarse.read_text()
+        assert "DIMENSIONS 5 3 1" in text
+        assert coarse.stat().st_size < full.stat().st_size
+
+    def test_write_csv_creates_rows(self, tmp_path):
+        """Test write_csv appends one row per call"""
+        sim = cfd_python.Simulation(10, 10)
+        path = tmp_path / "series.csv"
+        sim.write_csv(str(path), factor=2, create_new=True)
+        sim.step()
+        sim.write_csv(str(path), roi=(2, 8, 2, 8))
+        lines = path.read_text().splitlines()
+        assert len(lines) >= 2
+
+    def test_write_rejects_degenerate_region(self, tmp_path):
+        """Test regions that collapse to a single row or column are rejected"""
+        sim = cfd_python.Simulation(8, 8)
+        with pytest.raises(ValueError):
+            sim.write_vtk(str(tmp_path / "line.vtk"), roi=(3, 4, 0, 8))
+        with pytest.raises(ValueError):
+            sim.write_csv(str(tmp_path / "point.csv"), factor=8)
+
+
+class TestResampleExported:
+    """Test that resample_fields is exported"""
+
+    def test_function_in_all(self):
+        """Test resample_fields is in __all__"""
+        assert "resample_fields" in cfd_python.__all__
+        assert callable(cfd_python.resample_fields)
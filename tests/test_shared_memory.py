@@ -0,0 +1,163 @@
+"""
+Tests for the shared-memory result transport
+"""
+
+import math
+import multiprocessing
+import os
+import pickle
+import sys
+import uuid
+from concurrent.futures import ProcessPoolExecutor
+
+import pytest
+
+import cfd_python
+
+pytestmark = pytest.mark.skipif(
+    sys.platform == "win32", reason="POSIX shared memory is not available on Windows"
+)
+
+FIELDS = ["velocity_magnitude", "u", "v", "p"]
+
+
+def _unique_name():
+    return f"cfdtest_{os.getpid()}_{uuid.uuid4().hex[:8]}"
+
+
+def _worker(name):
+    """Run a small simulation in a child process and return only the descriptor"""
+    result = cfd_python.run_simulation_with_params(8, 6, 0.0, 1.0, 0.0, 1.0, steps=2, shm_name=name)
+    return result["shm"]
+
+
+@pytest.fixture
+def shm_name():
+    name = _unique_name()
+    yield name
+    try:
+        cfd_python.unlink_shared_result(name)
+    except FileNotFoundError:
+        pass
+
+
+class TestSharedMemoryResult:
+    """Test run_simulation_with_params(shm_name=...)"""
+
+    def test_returns_descriptor_instead_of_list(self, shm_name):
+        """Test the result has a small descriptor and no field list"""
+        result = cfd_python.run_simulation_with_params(
+            10, 8, 0.0, 1.0, 0.0, 1.0, steps=2, shm_name=shm_name
+        )
+        assert "velocity_magnitude" not in result
+        desc = result["shm"]
+        assert desc["name"] == shm_name
+        assert desc["nx"] == 10
+        assert desc["ny"] == 8
+        assert desc["fields"] == FIELDS
+        assert desc["size"] >= 4 * 10 * 8 * 8
+        assert len(pickle.dumps(result)) < 1024
+
+    def test_matches_list_result(self, shm_name):
+        """Test shared-memory fields match the regular list result"""
+        args = (12, 9, 0.0, 1.0, 0.0, 1.0)
+        regular = cfd_python.run_simulation_with_params(*args, steps=3)
+        shared = cfd_python.run_simulation_with_params(*args, steps=3, shm_name=shm_name)
+
+        attached = cfd_python.attach_shared_result(shared["shm"])
+        vel_mag = attached["velocity_magnitude"]
+        assert len(vel_mag) == len(regular["velocity_magnitude"])
+        for a, b in zip(vel_mag, regular["velocity_magnitude"]):
+            assert math.isclose(a, b, rel_tol=1e-12, abs_tol=1e-12)
+
+    def test_duplicate_name_raises(self, shm_name):
+        """Test creating a segment with an existing name fails"""
+        cfd_python.run_simulation_with_params(4, 4, 0.0, 1.0, 0.0, 1.0, shm_name=shm_name)
+        with pytest.raises(FileExistsError):
+            cfd_python.run_simulation_with_params(4, 4, 0.0, 1.0, 0.0, 1.0, shm_name=shm_name)
+
+    def test_invalid_name_raises(self):
+        """Test names with embedded slashes are rejected"""
+        with pytest.raises(ValueError):
+            cfd_python.run_simulation_with_params(4, 4, 0.0, 1.0, 0.0, 1.0, shm_name="a/b")
+
+
+class TestAttachSharedResult:
+    """Test attach_shared_result and unlink_shared_result"""
+
+    def test_attach_views(self, shm_name):
+        """Test attached fields are flat double memoryviews"""
+        cfd_python.run_simulation_with_params(6, 5, 0.0, 1.0, 0.0, 1.0, shm_name=shm_name)
+        attached = cfd_python.attach_shared_result(shm_name)
+        assert attached["nx"] == 6
+        assert attached["ny"] == 5
+        for field in FIELDS:
+            view = attached[field]
+            assert isinstance(view, memoryview)
+            assert view.format == "d"
+            assert len(view) == 30
+
+    def test_attach_is_zero_copy(self, shm_name):
+        """Test two attachments see each other's writes"""
+        cfd_python.run_simulation_with_params(4, 4, 0.0, 1.0, 0.0, 1.0, shm_name=shm_name)
+        first = cfd_python.attach_shared_result(shm_name)
+        second = cfd_python.attach_shared_result(shm_name)
+        first["p"][3] = 42.5
+        assert second["p"][3] == 42.5
+
+    def test_view_outlives_unlink(self, shm_name):
+        """Test views stay valid after the name is removed"""
+        cfd_python.run_simulation_with_params(4, 4, 0.0, 1.0, 0.0, 1.0, shm_name=shm_name)
+        u = cfd_python.attach_shared_result(shm_name, unlink=True)["u"]
+        with pytest.raises(FileNotFoundError):
+            cfd_python.attach_shared_result(shm_name)
+        assert len(u.tolist()) == 16
+
+    def test_attach_missing_raises(self):
+        """Test attaching to a missing segment raises FileNotFoundError"""
+        with pytest.raises(FileNotFoundError):
+            cfd_python.attach_shared_result(_unique_name())
+
+    def test_attach_foreign_segment_raises(self):
+        """Test segments not written by cfd_python are rejected"""
+        shared_memory = pytest.importorskip("multiprocessing.shared_memory")
+        shm = shared_memory.SharedMemory(create=True, size=4096)
+        try:
+            with pytest.raises(ValueError):
+                cfd_python.attach_shared_result(shm.name)
+        finally:
+            shm.close()
+            shm.unlink()
+
+    def test_attach_invalid_type(self):
+        """Test non-string names raise TypeError"""
+        with pytest.raises(TypeError):
+            cfd_python.attach_shared_result(123)
+
+
+class TestSharedMemoryMultiprocess:
+    """Test the transport across a process pool"""
+
+    def test_process_pool(self):
+        """Test a worker result is readable from the parent"""
+        if "fork" not in multiprocessing.get_all_start_methods():
+            pytest.skip("fork start method not available")
+        names = [_unique_name() for _ in range(2)]
+        ctx = multiprocessing.get_context("fork")
+        with ProcessPoolExecutor(max_workers=2, mp_context=ctx) as pool:
+            descriptors = list(pool.map(_worker, names))
+
+        for name, desc in zip(names, descriptors):
+            attached = cfd_python.attach_shared_result(desc, unlink=True)
+            assert attached["name"] == name
+            assert len(attached["velocity_magnitude"]) == 48
+
+
+class TestSharedMemoryExported:
+    """Test that shared-memory functions are exported"""
+
+    def test_functions_in_all(self):
+        """Test shared-memory functions are in __all__"""
+        for func_name in ["attach_shared_result", "unlink_shared_result"]:
+            assert func_name in cfd_python.__all__, f"{func_name} should be in __all__"
+            assert callable(getattr(cfd_python, func_name))
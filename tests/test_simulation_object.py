@@ -0,0 +1,185 @@
+"""
+Tests for the persistent Simulation object, clone() and fork support
+"""
+
+import os
+import sys
+
+import pytest
+
+import cfd_python
+
+
+@pytest.fixture
+def sim():
+    return cfd_python.Simulation(12, 10, dt=0.001)
+
+
+class TestSimulationBasics:
+    """Test construction, stepping and field access"""
+
+    def test_construction(self, sim):
+        """Test dimensions and initial progress"""
+        assert sim.nx == 12
+        assert sim.ny == 10
+        assert sim.step_count == 0
+        assert sim.time == 0.0
+        assert sim.dt == pytest.approx(0.001)
+
+    def test_step_advances_time(self, sim):
+        """Test step() updates the step count and time"""
+        assert sim.step() == 1
+        assert sim.step(4) == 4
+        assert sim.step_count == 5
+        assert sim.time == pytest.approx(0.005)
+
+    def test_live_field_views(self, sim):
+        """Test u/v/p are live, writable, zero-copy views"""
+        u = sim.u
+        assert isinstance(u, memoryview)
+        assert len(u) == 120
+        assert not u.readonly
+        u[5] = 0.75
+        assert sim.u[5] == 0.75
+
+    def test_set_fields(self, sim):
+        """Test set_fields copies new values into the solver state"""
+        sim.set_fields(u=[1.0] * 120, p=[2.0] * 120)
+        assert sim.u.tolist() == [1.0] * 120
+        assert sim.p.tolist() == [2.0] * 120
+
+    def test_set_fields_size_mismatch(self, sim):
+        """Test set_fields rejects wrongly sized input"""
+        with pytest.raises(ValueError):
+            sim.set_fields(u=[0.0] * 5)
+
+    def test_snapshot(self, sim):
+        """Test snapshot() copies the current state"""
+        sim.step(2)
+        snap = sim.snapshot()
+        assert isinstance(snap, cfd_python.FieldSnapshot)
+        assert snap.step == 2
+        assert snap.u.tolist() == sim.u.tolist()
+        sim.u[0] = 123.0
+        assert snap.u[0] != 123.0
+
+    def test_grid_and_stats(self, sim):
+        """Test grid and stats accessors"""
+        sim.step()
+        assert sim.grid.nx == 12
+        assert set(sim.stats) >= {"iterations", "max_velocity", "max_pressure"}
+
+    def test_invalid_arguments(self):
+        """Test invalid construction arguments raise ValueError"""
+        with pytest.raises(ValueError):
+            cfd_python.Simulation(1, 10)
+        with pytest.raises(ValueError):
+            cfd_python.Simulation(10, 10, dt=0.0)
+        with pytest.raises(ValueError):
+            cfd_python.Simulation(10, 10).step(-1)
+
+
+class TestSimulationClone:
+    """Test clone() of a spun-up state"""
+
+    def test_clone_copies_state(self, sim):
+        """Test the clone starts from the same fields, step and time"""
+        sim.step(3)
+        branch = sim.clone()
+        assert branch.step_count == 3
+        assert branch.time == sim.time
+        assert branch.dt == sim.dt
+        assert branch.u.tolist() == sim.u.tolist()
+        assert branch.p.tolist() == sim.p.tolist()
+
+    def test_clone_is_independent(self, sim):
+        """Test modifying a clone leaves the original untouched"""
+        sim.step(2)
+        branch = sim.clone()
+        branch.u[0] = 5.0
+        branch.step(2)
+        assert sim.u[0] != 5.0
+        assert sim.step_count == 2
+
+    def test_clones_evolve_identically(self, sim):
+        """Test two clones of one state produce the same trajectory"""
+        sim.step(2)
+        a, b = sim.clone(), sim.clone()
+        a.step(3)
+        b.step(3)
+        assert a.u.tolist() == b.u.tolist()
+
+    def test_many_branches(self, sim):
+        """Test branching an ensemble from one state"""
+        sim.step(2)
+        members = [sim.clone() for _ in range(8)]
+        for i, member in enumerate(members):
+            member.u[0] = float(i)
+        assert [m.u[0] for m in members] == [float(i) for i in range(8)]
+
+
+class TestForkSupport:
+    """Test os.fork-friendly reinitialization"""
+
+    def test_reinit_after_fork_callable(self):
+        """Test reinit_after_fork can be called in-process"""
+        cfd_python.reinit_after_fork()
+        assert len(cfd_python.list_solvers()) > 0
+
+    def test_reinit_after_fork_invalid(self):
+        """Test negative thread counts are rejected"""
+        with pytest.raises(ValueError):
+            cfd_python.reinit_after_fork(num_threads=-1)
+
+    @pytest.mark.skipif(not hasattr(os, "fork"), reason="os.fork not available")
+    @pytest.mark.skipif(sys.platform == "darwin", reason="fork is unsafe on macOS")
+    def test_fork_child_continues_simulation(self, sim):
+        """Test a forked child can continue an inherited simulation"""
+        sim.step(2)
+        read_fd, write_fd = os.pipe()
+        pid = os.fork()
+        if pid == 0:
+            try:
+                os.close(read_fd)
+                sim.u[0] = 9.0
+                sim.step(2)
+                os.write(write_fd, str(sim.step_count).encode())
+            finally:
+                os._exit(0)
+        os.close(write_fd)
+        child_steps = os.read(read_fd, 64).decode()
+        os.close(read_fd)
+        os.waitpid(pid, 0)
+        assert child_steps == "4"
+        assert sim.step_count == 2
+        assert sim.u[0] != 9.0
+
+    @pytest.mark.skipif(not hasattr(os, "fork"), reason="os.fork not available")
+    @pytest.mark.skipif(sys.platform == "darwin", reason="fork is unsafe on macOS")
+    def test_fork_child_reset_library(self):
+        """Test a child can opt into re-initializing the library and build new simulations"""
+        read_fd, write_fd = os.pipe()
+        pid = os.fork()
+        if pid == 0:
+            try:
+                os.close(read_fd)
+                cfd_python.reinit_after_fork(reset_library=True)
+                child = cfd_python.Simulation(8, 8)
+                child.step(3)
+                os.write(write_fd, f"{len(cfd_python.list_solvers())},{child.step_count}".encode())
+            finally:
+                os._exit(0)
+        os.close(write_fd)
+        result = os.read(read_fd, 64).decode()
+        os.close(read_fd)
+        os.waitpid(pid, 0)
+        assert result == f"{len(cfd_python.list_solvers())},3"
+
+
+class TestSimulationExported:
+    """Test that Simulation exports are in __all__"""
+
+    def test_exports(self):
+        """Test Simulation and reinit_after_fork are exported"""
+        assert "Simulation" in cfd_python.__all__
+        assert "reinit_after_fork" in cfd_python.__all__
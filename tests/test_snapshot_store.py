@@ -0,0 +1,195 @@
+"""
+Tests for the memory-mapped snapshot store
+"""
+
+import pickle
+import sys
+import threading
+
+import pytest
+
+import cfd_python
+
+pytestmark = pytest.mark.skipif(
+    sys.platform == "win32", reason="Memory-mapped stores are not available on Windows"
+)
+
+
+def _fields(nx, ny, k):
+    n = nx * ny
+    return {
+        "u": [k + i * 0.5 for i in range(n)],
+        "v": [-k - i * 0.25 for i in range(n)],
+        "p": [k * 1e-3 + i for i in range(n)],
+    }
+
+
+def _write(path, nx, ny, steps, **kwargs):
+    with cfd_python.SnapshotWriter(str(path), nx, ny, **kwargs) as writer:
+        for k in steps:
+            writer.write(_fields(nx, ny, k), step=k, time=k * 0.1)
+        return len(writer)
+
+
+class TestSnapshotStore:
+    """Test SnapshotWriter and SnapshotStore"""
+
+    def test_round_trip(self, tmp_path):
+        """Test every stored step reads back exactly with its index entry"""
+        path = tmp_path / "run.store"
+        steps = [0, 5, 10, 40, 1000]
+        assert _write(path, 7, 5, steps) == 5
+        store = cfd_python.SnapshotStore(str(path))
+        assert len(store) == 5
+        assert (store.nx, store.ny) == (7, 5)
+        assert store.steps == steps
+        assert store.times == [k * 0.1 for k in steps]
+        for k in steps:
+            snap = store[k]
+            assert (snap.step, snap.time, snap.nx, snap.ny) == (k, k * 0.1, 7, 5)
+            expected = _fields(7, 5, k)
+            assert snap.u.tolist() == expected["u"]
+            assert snap.v.tolist() == expected["v"]
+            assert snap.p.tolist() == expected["p"]
+
+    def test_simulation_source(self, tmp_path):
+        """Test a Simulation is written with its live step and time"""
+        sim = cfd_python.Simulation(12, 9)
+        path = tmp_path / "sim.store"
+        with cfd_python.SnapshotWriter(str(path), 12, 9) as writer:
+            for _ in range(3):
+                sim.step()
+                writer.write(sim)
+        store = cfd_python.SnapshotStore(str(path))
+        last = store[sim.step_count]
+        assert last.time == sim.time
+        assert last.p.tolist() == sim.p.tolist()
+        assert store.at(-1).step == sim.step_count
+
+    def test_zero_copy_views(self, tmp_path):
+        """Test fields are read-only, 64-byte aligned and outlive the store"""
+        import ctypes
+
+        path = tmp_path / "run.store"
+        _write(path, 3, 3, [1, 2])
+        store = cfd_python.SnapshotStore(str(path))
+        u = store[2].u
+        assert u.readonly
+        with pytest.raises(TypeError):
+            u[0] = 1.0
+        assert ctypes.addressof(u.obj) % 64 == 0
+        assert ctypes.addressof(store[2].v.obj) % 64 == 0
+        del store
+        assert u.tolist() == _fields(3, 3, 2)["u"]
+
+    def test_lookup(self, tmp_path):
+        """Test missing steps raise KeyError and 'in' checks the index"""
+        path = tmp_path / "run.store"
+        _write(path, 2, 2, [3, 6, 9])
+        store = cfd_python.SnapshotStore(str(path))
+        assert 6 in store and 7 not in store and -1 not in store
+        with pytest.raises(KeyError):
+            store[4]
+        with pytest.raises(KeyError):
+            store[-3]
+        with pytest.raises(TypeError):
+            store["3"]
+        assert store.at(0).step == 3
+        with pytest.raises(IndexError):
+            store.at(3)
+
+    def test_append(self, tmp_path):
+        """Test append=True continues a store and keeps steps increasing"""
+        path = tmp_path / "run.store"
+        _write(path, 4, 3, [1, 2])
+        assert _write(path, 4, 3, [3], append=True) == 3
+        assert cfd_python.SnapshotStore(str(path)).steps == [1, 2, 3]
+        with cfd_python.SnapshotWriter(str(path), 4, 3, append=True) as writer:
+            with pytest.raises(ValueError):
+                writer.write(_fields(4, 3, 0), step=3, time=0.0)
+        with pytest.raises(ValueError):
+            cfd_python.SnapshotWriter(str(path), 3, 4, append=True)
+        assert _write(tmp_path / "new.store", 2, 2, [0], append=True) == 1
+
+    def test_partial_record_ignored(self, tmp_path):
+        """Test a store cut off mid-record opens with the complete records"""
+        path = tmp_path / "run.store"
+        _write(path, 8, 8, [1, 2, 3])
+        data = path.read_bytes()
+        path.write_bytes(data[: len(data) - 100])
+        store = cfd_python.SnapshotStore(str(path))
+        assert store.steps == [1, 2]
+        assert store[2].p.tolist() == _fields(8, 8, 2)["p"]
+
+    def test_flush_makes_records_visible(self, tmp_path):
+        """Test records reach readers after flush() while the writer stays open"""
+        path = tmp_path / "run.store"
+        writer = cfd_python.SnapshotWriter(str(path), 2, 2)
+        writer.write(_fields(2, 2, 1), step=1, time=0.1)
+        writer.flush()
+        assert cfd_python.SnapshotStore(str(path)).steps == [1]
+        writer.close()
+        writer.close()
+        assert writer.closed
+        with pytest.raises(ValueError):
+            writer.write(_fields(2, 2, 2), step=2, time=0.2)
+
+    def test_close_during_write_from_another_thread(self, tmp_path):
+        """Test close() refuses while another thread appends, leaving a valid store"""
+        path = tmp_path / "run.store"
+        fields = _fields(64, 64, 0)
+        writer = cfd_python.SnapshotWriter(str(path), 64, 64)
+        written = []
+
+        def produce():
+            for k in range(200):
+                try:
+                    writer.write(fields, step=k, time=0.0)
+                except (ValueError, RuntimeError):
+                    return
+                written.append(k)
+
+        thread = threading.Thread(target=produce)
+        thread.start()
+        while not writer.closed:
+            try:
+                writer.close()
+            except RuntimeError:
+                pass
+        thread.join()
+        assert cfd_python.SnapshotStore(str(path)).steps == written
+
+    def test_snapshot_pickles(self, tmp_path):
+        """Test a mapped snapshot pickles like any other"""
+        path = tmp_path / "run.store"
+        _write(path, 3, 2, [7])
+        snap = cfd_python.SnapshotStore(str(path))[7]
+        for protocol in (2, 5):
+            copy = pickle.loads(pickle.dumps(snap, protocol=protocol))
+            assert copy.step == 7 and copy.u.tolist() == snap.u.tolist()
+
+    def test_invalid_arguments(self, tmp_path):
+        """Test bad sources, sizes and files raise"""
+        with pytest.raises(ValueError):
+            cfd_python.SnapshotWriter(str(tmp_path / "a.store"), 0, 4)
+        with pytest.raises(OSError):
+            cfd_python.SnapshotWriter(str(tmp_path / "missing" / "a.store"), 2, 2)
+        with cfd_python.SnapshotWriter(str(tmp_path / "b.store"), 2, 2) as writer:
+            with pytest.raises(ValueError):
+                writer.write(_fields(3, 1, 0), step=0, time=0.0)
+            with pytest.raises(ValueError):
+                writer.write(_fields(2, 2, 0))
+            with pytest.raises(TypeError):
+                writer.write([0.0] * 4, step=0, time=0.0)
+            assert len(writer) == 0
+        bogus = tmp_path / "bogus.store"
+        bogus.write_bytes(b"not a store" * 20)
+        with pytest.raises(ValueError):
+            cfd_python.SnapshotStore(str(bogus))
+        with pytest.raises(OSError):
+            cfd_python.SnapshotStore(str(tmp_path / "nothing.store"))
+
+    def test_exported(self):
+        """Test the store types are in __all__"""
+        assert "SnapshotWriter" in cfd_python.__all__
+        assert "SnapshotStore" in cfd_python.__all__
@@ -0,0 +1,135 @@
+"""
+Tests for the text formatting of ASCII VTK and CSV output
+"""
+
+import csv
+import math
+import random
+
+import pytest
+
+import cfd_python
+
+
+def _scalar_tokens(path):
+    """Values of the first SCALARS block of a legacy ASCII VTK file"""
+    lines = path.read_text().splitlines()
+    assert "ASCII" in lines
+    start = lines.index("LOOKUP_TABLE default") + 1
+    return lines[start:]
+
+
+def _write_scalar(path, data, nx, ny, **kwargs):
+    cfd_python.write_vtk_scalar(str(path), "s", data, nx, ny, 0.0, 1.0, 0.0, 1.0, **kwargs)
+
+
+class TestShortestRoundTrip:
+    """Test the default shortest round-trip digits"""
+
+    def test_values_read_back_exactly(self, tmp_path):
+        """Test random doubles across the exponent range parse back unchanged"""
+        rng = random.Random(46)
+        data = [rng.uniform(-1.0, 1.0) * 10.0 ** rng.randint(-300, 300) for _ in range(3000)]
+        data += [5e-324, 2.2250738585072014e-308, 1.7976931348623157e308, 1.0 / 3.0]
+        path = tmp_path / "s.vtk"
+        _write_scalar(path, data, len(data), 1)
+        assert [float(t) for t in _scalar_tokens(path)] == data
+
+    def test_digits_match_repr(self, tmp_path):
+        """Test common values get Python's repr() digits"""
+        data = [0.1, 0.5, 1.0 / 3.0, 1e-05, 0.0001, 1e16, 1e15, 2.5e20, -0.0, 100.0, 123.456]
+        path = tmp_path / "s.vtk"
+        _write_scalar(path, data, len(data), 1)
+        expected = [repr(x)[:-2] if repr(x).endswith(".0") else repr(x) for x in data]
+        assert _scalar_tokens(path) == expected
+
+    def test_non_finite(self, tmp_path):
+        """Test inf and nan are written in a form float() accepts"""
+        data = [math.inf, -math.inf, math.nan, 0.0]
+        path = tmp_path / "s.vtk"
+        _write_scalar(path, data, 4, 1)
+        values = [float(t) for t in _scalar_tokens(path)]
+        assert values[:2] == [math.inf, -math.inf]
+        assert math.isnan(values[2])
+
+    def test_large_field_keeps_order(self, tmp_path):
+        """Test chunks formatted in parallel are written in order"""
+        nx, ny = 100, 130
+        u = [i * 0.1 for i in range(nx * ny)]
+        v = [-i * 0.25 for i in range(nx * ny)]
+        path = tmp_path / "v.vtk"
+        cfd_python.write_vtk_vector(str(path), "velocity", u, v, nx, ny, 0.0, 1.0, 0.0, 1.0)
+        lines = path.read_text().splitlines()
+        start = lines.index("VECTORS velocity double") + 1
+        rows = [tuple(map(float, line.split())) for line in lines[start:]]
+        assert rows == [(a, b, 0.0) for a, b in zip(u, v)]
+
+    def test_simulation_write_vtk(self, tmp_path):
+        """Test ASCII flow output holds the exact live pressure"""
+        sim = cfd_python.Simulation(12, 10)
+        sim.step(2)
+        path = tmp_path / "flow.vtk"
+        sim.write_vtk(str(path))
+        lines = path.read_text().splitlines()
+        start = lines.index("LOOKUP_TABLE default") + 1
+        assert [float(t) for t in lines[start:]] == sim.p.tolist()
+
+
+class TestPrecision:
+    """Test the precision= argument of the text writers"""
+
+    def test_significant_digits(self, tmp_path):
+        """Test precision rounds like the %g format"""
+        rng = random.Random(7)
+        data = [rng.uniform(-1e3, 1e3) for _ in range(500)] + [0.99999999, 12345678.0]
+        path = tmp_path / "s.vtk"
+        _write_scalar(path, data, len(data), 1, precision=7)
+        tokens = _scalar_tokens(path)
+        assert [float(t) for t in tokens] == [float(f"{x:.7g}") for x in data]
+        digits = [t.split("e")[0].lstrip("-").replace(".", "").strip("0") for t in tokens]
+        assert max(len(d) for d in digits) <= 7
+        full = tmp_path / "full.vtk"
+        _write_scalar(full, data, len(data), 1)
+        assert path.stat().st_size < full.stat().st_size
+
+    def test_csv_writer(self, tmp_path):
+        """Test CsvWriter rows honour precision"""
+        path = tmp_path / "log.csv"
+        fields = {"u": [1.0 / 3.0] * 4, "v": [0.0] * 4, "p": [2.0 / 3.0] * 4}
+        with cfd_python.CsvWriter(str(path), precision=4) as writer:
+            writer.write(fields, step=1, time=0.1)
+        with open(path, newline="") as f:
+            row = next(csv.DictReader(f))
+        assert row["max_u"] == "0.3333"
+        assert row["avg_p"] == "0.6667"
+        assert row["time"] == "0.1"
+
+    def test_scheduled_output(self, tmp_path):
+        """Test add_output passes precision to the CSV and ASCII VTK writers"""
+        sim = cfd_python.Simulation(8, 8)
+        sim.add_output(cfd_python.OUTPUT_CSV_STATISTICS, str(tmp_path / "s.csv"), precision=3)
+        sim.add_output(cfd_python.OUTPUT_FULL_FIELD, str(tmp_path / "f.vtk"), precision=3)
+        assert [o["precision"] for o in sim.outputs] == [3, 3]
+        sim.step()
+        with open(tmp_path / "s.csv", newline="") as f:
+            row = next(csv.DictReader(f))
+        assert float(row["p_max"]) == float(f"{max(sim.p.tolist()):.3g}")
+        text = (tmp_path / "f.vtk").read_text()
+        assert "ASCII" in text and "SCALARS pressure double 1" in text
+
+    def test_invalid_precision(self, tmp_path):
+        """Test precision outside 0..17 raises ValueError"""
+        for precision in (-1, 18):
+            with pytest.raises(ValueError):
+                _write_scalar(tmp_path / "s.vtk", [0.0] * 4, 2, 2, precision=precision)
+            with pytest.raises(ValueError):
+                cfd_python.CsvWriter(str(tmp_path / "log.csv"), precision=precision)
+            with pytest.raises(ValueError):
+                cfd_python.Simulation(4, 4).add_output(
+                    cfd_python.OUTPUT_VELOCITY, str(tmp_path / "a.vtk"), precision=precision
+                )
+
+    def test_unwritable_ascii_raises(self, tmp_path):
+        """Test ASCII write failures raise OSError"""
+        with pytest.raises(OSError):
+            _write_scalar(tmp_path / "missing" / "s.vtk", [0.0] * 4, 2, 2)
@@ -5,6 +5,8 @@ These tests verify that the VTK output functions handle memory correctly,
 particularly the fixed use-after-free bug in write_vtk_vector.
 """
 
+import struct
+
 import pytest
 
 import cfd_python
@@ -239,6 +241,82 @@ class TestWriteVtkVector:
         assert filename.stat().st_size > 1000
 
 
+def _read_binary_vtk(path):
+    """Split a legacy BINARY VTK file into header lines and big-endian doubles"""
+    raw = path.read_bytes()
+    header, _, rest = raw.partition(b"LOOKUP_TABLE default\n")
+    if not rest:
+        header, _, rest = raw.partition(b" double\n")
+        header += b" double"
+    lines = header.decode("ascii").splitlines()
+    count = len(rest) // 8
+    return lines, list(struct.unpack(f">{count}d", rest[: count * 8]))
+
+
+class TestBinaryVtk:
+    """Test binary=True on the VTK writers"""
+
+    def test_scalar_roundtrip(self, tmp_path):
+        """Test scalar payloads are exact big-endian doubles"""
+        nx, ny = 6, 4
+        data = [i / 7.0 for i in range(nx * ny)]
+        path = tmp_path / "scalar.vtk"
+        cfd_python.write_vtk_scalar(str(path), "p", data, nx, ny, 0.0, 1.0, 0.0, 2.0, binary=True)
+        lines, values = _read_binary_vtk(path)
+        assert "BINARY" in lines
+        assert "DIMENSIONS 6 4 1" in lines
+        assert "SCALARS p double 1" in lines
+        assert values == data
+
+    def test_vector_roundtrip(self, tmp_path):
+        """Test vectors are interleaved with a zero w component"""
+        nx, ny = 3, 3
+        u = [float(i) for i in range(nx * ny)]
+        v = [-float(i) for i in range(nx * ny)]
+        path = tmp_path / "vector.vtk"
+        cfd_python.write_vtk_vector(
+            str(path), "velocity", u, v, nx, ny, 0.0, 1.0, 0.0, 1.0, binary=True
+        )
+        lines, values = _read_binary_vtk(path)
+        assert "VECTORS velocity double" in lines
+        assert values == [c for pair in zip(u, v) for c in (*pair, 0.0)]
+
+    def test_simulation_write_vtk(self, tmp_path):
+        """Test binary flow output holds the same grid and exact p"""
+        sim = cfd_python.Simulation(16, 12)
+        sim.step(2)
+        ascii_path = tmp_path / "flow.vtk"
+        binary_path = tmp_path / "flow_binary.vtk"
+        sim.write_vtk(str(ascii_path))
+        sim.write_vtk(str(binary_path), binary=True)
+        raw = binary_path.read_bytes()
+        assert b"BINARY" in raw
+        assert b"VECTORS velocity double" in raw
+        start = raw.index(b"LOOKUP_TABLE default\n") + len(b"LOOKUP_TABLE default\n")
+        pressure = struct.unpack(">192d", raw[start : start + 192 * 8])
+        assert list(pressure) == sim.p.tolist()
+        assert "DIMENSIONS 16 12 1" in ascii_path.read_text()
+        assert b"DIMENSIONS 16 12 1" in raw
+
+    def test_run_simulation_output_file(self, tmp_path):
+        """Test run_simulation_with_params writes binary output_file"""
+        path = tmp_path / "run.vtk"
+        cfd_python.run_simulation_with_params(
+            8, 8, 0.0, 1.0, 0.0, 1.0, steps=2, output_file=str(path), binary=True
+        )
+        assert b"BINARY" in path.read_bytes()
+
+    def test_unwritable_path_raises(self, tmp_path):
+        """Test write failures raise OSError"""
+        path = tmp_path / "missing" / "out.vtk"
+        with pytest.raises(OSError):
+            cfd_python.write_vtk_scalar(
+                str(path), "p", [0.0] * 4, 2, 2, 0.0, 1.0, 0.0, 1.0, binary=True
+            )
+        with pytest.raises(OSError):
+            cfd_python.Simulation(4, 4).write_vtk(str(path), binary=True)
+
+
 class TestSetOutputDir:
     """Test the set_output_dir function."""
 
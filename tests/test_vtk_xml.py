@@ -0,0 +1,195 @@
+"""
+Tests for the VTK XML rectilinear writer and .pvd collections
+"""
+
+import struct
+import xml.etree.ElementTree as ET
+import zlib
+
+import pytest
+
+import cfd_python
+
+
+def _read_vtr(path):
+    """Parse a .vtr with appended data into the XML root and {name: values}"""
+    raw = path.read_bytes()
+    marker = raw.index(b"_", raw.index(b"<AppendedData"))
+    root = ET.fromstring(raw[:marker] + b"</AppendedData></VTKFile>")
+    appended = raw[marker + 1 : raw.rindex(b"\n  </AppendedData>")]
+    order = "<" if root.get("byte_order") == "LittleEndian" else ">"
+    compressed = root.get("compressor") == "vtkZLibDataCompressor"
+
+    def decode(offset):
+        if not compressed:
+            (nbytes,) = struct.unpack_from(order + "Q", appended, offset)
+            body = appended[offset + 8 : offset + 8 + nbytes]
+        else:
+            num_blocks, _, _ = struct.unpack_from(order + "3Q", appended, offset)
+            sizes = struct.unpack_from(f"{order}{num_blocks}Q", appended, offset + 24)
+            pos = offset + 24 + 8 * num_blocks
+            body = b""
+            for size in sizes:
+                body += zlib.decompress(appended[pos : pos + size])
+                pos += size
+        return list(struct.unpack(f"{order}{len(body) // 8}d", body))
+
+    arrays = {}
+    for array in root.iter("DataArray"):
+        arrays[array.get("Name")] = decode(int(array.get("offset")))
+    return root, arrays
+
+
+class TestWriteVtr:
+    """Test write_vtr()"""
+
+    def test_scalar_roundtrip(self, tmp_path):
+        """Test scalars and coordinates are stored exactly"""
+        nx, ny = 5, 4
+        data = [i / 3.0 for i in range(nx * ny)]
+        path = tmp_path / "scalar.vtr"
+        cfd_python.write_vtr(str(path), {"p": data}, nx, ny)
+        root, arrays = _read_vtr(path)
+        assert root.get("type") == "RectilinearGrid"
+        assert root.find("RectilinearGrid").get("WholeExtent") == "0 4 0 3 0 0"
+        assert arrays["p"] == data
+        assert arrays["x"] == pytest.approx([0.0, 0.25, 0.5, 0.75, 1.0])
+        assert arrays["z"] == [0.0]
+
+    def test_stretched_grid_coordinates(self, tmp_path):
+        """Test a stretched grid writes its actual coordinates"""
+        grid = cfd_python.Grid(9, 6, 0.0, 2.0, 0.0, 1.0, beta=2.0)
+        path = tmp_path / "stretched.vtr"
+        cfd_python.write_vtr(str(path), [0.0] * 54, 9, 6, grid=grid)
+        _, arrays = _read_vtr(path)
+        assert arrays["x"] == grid.x.tolist()
+        assert arrays["y"] == grid.y.tolist()
+        assert "values" in arrays
+
+    def test_vectors_interleaved(self, tmp_path):
+        """Test 2-component vectors are padded with a zero w"""
+        u = [float(i) for i in range(6)]
+        v = [-float(i) for i in range(6)]
+        path = tmp_path / "vector.vtr"
+        cfd_python.write_vtr(str(path), {}, 3, 2, vectors={"velocity": (u, v)})
+        root, arrays = _read_vtr(path)
+        assert root.find(".//PointData").get("Vectors") == "velocity"
+        assert arrays["velocity"] == [c for pair in zip(u, v) for c in (*pair, 0.0)]
+
+    def test_compressed_roundtrip(self, tmp_path):
+        """Test zlib blocks decode to the raw data and shrink smooth fields"""
+        nx, ny = 100, 90
+        data = [float(j) for j in range(ny) for i in range(nx)]
+        raw_path = tmp_path / "raw.vtr"
+        packed_path = tmp_path / "packed.vtr"
+        cfd_python.write_vtr(str(raw_path), {"p": data}, nx, ny)
+        try:
+            cfd_python.write_vtr(str(packed_path), {"p": data}, nx, ny, compress=True)
+        except NotImplementedError:
+            pytest.skip("built without zlib")
+        root, arrays = _read_vtr(packed_path)
+        assert root.get("compressor") == "vtkZLibDataCompressor"
+        assert arrays["p"] == data
+        assert packed_path.stat().st_size < raw_path.stat().st_size / 4
+
+    def test_names_are_escaped(self, tmp_path):
+        """Test field names with XML metacharacters keep the file well-formed"""
+        path = tmp_path / "names.vtr"
+        cfd_python.write_vtr(str(path), {'a<b & "c"': [1.0] * 4}, 2, 2)
+        _, arrays = _read_vtr(path)
+        assert arrays['a<b & "c"'] == [1.0] * 4
+
+    def test_invalid_arguments(self, tmp_path):
+        """Test bad sizes, vectors, levels and paths raise"""
+        path = str(tmp_path / "bad.vtr")
+        with pytest.raises(ValueError):
+            cfd_python.write_vtr(path, [0.0] * 5, 2, 2)
+        with pytest.raises(ValueError):
+            cfd_python.write_vtr(path, {}, 2, 2, vectors={"w": ([0.0] * 4,)})
+        with pytest.raises(TypeError):
+            cfd_python.write_vtr(path, {}, 2, 2, vectors=[[0.0] * 4])
+        with pytest.raises(ValueError):
+            cfd_python.write_vtr(path, [0.0] * 4, 2, 2, compress=10)
+        with pytest.raises(OSError):
+            cfd_python.write_vtr(str(tmp_path / "missing" / "a.vtr"), [0.0] * 4, 2, 2)
+
+
+class TestAppendPvd:
+    """Test append_pvd()"""
+
+    def test_append_entries(self, tmp_path):
+        """Test each append adds one entry and keeps the file valid"""
+        path = tmp_path / "run.pvd"
+        for step in range(3):
+            cfd_python.append_pvd(str(path), f"flow_{step}.vtr", 0.5 * step)
+            entries = ET.parse(path).getroot().findall("./Collection/DataSet")
+            assert len(entries) == step + 1
+        assert [e.get("file") for e in entries] == ["flow_0.vtr", "flow_1.vtr", "flow_2.vtr"]
+        assert float(entries[2].get("timestep")) == 1.0
+
+    def test_create_new_truncates(self, tmp_path):
+        """Test create_new starts an empty collection"""
+        path = tmp_path / "run.pvd"
+        cfd_python.append_pvd(str(path), "a.vtr", 0.0)
+        cfd_python.append_pvd(str(path), "b.vtr", 1.0, create_new=True)
+        entries = ET.parse(path).getroot().findall("./Collection/DataSet")
+        assert [e.get("file") for e in entries] == ["b.vtr"]
+
+    def test_foreign_file_raises(self, tmp_path):
+        """Test files not ending in a collection footer are rejected"""
+        path = tmp_path / "other.pvd"
+        path.write_text("not a collection\n")
+        with pytest.raises(ValueError):
+            cfd_python.append_pvd(str(path), "a.vtr", 0.0)
+
+
+class TestSimulationWriteVtr:
+    """Test Simulation.write_vtr()"""
+
+    def test_matches_live_state(self, tmp_path):
+        """Test velocity, pressure and coordinates match the simulation"""
+        sim = cfd_python.Simulation(12, 10)
+        sim.step(2)
+        path = tmp_path / "flow.vtr"
+        sim.write_vtr(str(path))
+        _, arrays = _read_vtr(path)
+        assert arrays["pressure"] == sim.p.tolist()
+        assert arrays["velocity"][0::3] == sim.u.tolist()
+        assert arrays["velocity"][1::3] == sim.v.tolist()
+        assert arrays["x"] == sim.grid.x.tolist()
+
+    def test_decimated_coordinates(self, tmp_path):
+        """Test factor and roi select injected node coordinates"""
+        sim = cfd_python.Simulation(13, 9)
+        path = tmp_path / "coarse.vtr"
+        sim.write_vtr(str(path), factor=3, roi=(0, 13, 2, 9))
+        _, arrays = _read_vtr(path)
+        assert arrays["x"] == sim.grid.x.tolist()[0:13:3]
+        assert arrays["y"] == sim.grid.y.tolist()[2:9:3]
+        assert len(arrays["pressure"]) == 5 * 3
+
+    def test_collection(self, tmp_path):
+        """Test collection entries are relative to the .pvd and use sim time"""
+        sim = cfd_python.Simulation(8, 8)
+        pvd = tmp_path / "run.pvd"
+        for k in range(2):
+            sim.step()
+            sim.write_vtr(str(tmp_path / f"flow_{k}.vtr"), collection=str(pvd))
+        entries = ET.parse(pvd).getroot().findall("./Collection/DataSet")
+        assert [e.get("file") for e in entries] == ["flow_0.vtr", "flow_1.vtr"]
+        assert float(entries[1].get("timestep")) == pytest.approx(sim.time)
+
+    def test_unwritable_path_raises(self, tmp_path):
+        """Test write failures raise OSError"""
+        with pytest.raises(OSError):
+            cfd_python.Simulation(4, 4).write_vtr(str(tmp_path / "missing" / "a.vtr"))
+
+
+class TestVtrExported:
+    """Test that the VTK XML functions are exported"""
+
+    def test_functions_in_all(self):
+        """Test write_vtr and append_pvd are in __all__"""
+        for func_name in ["write_vtr", "append_pvd"]:
+            assert func_name in cfd_python.__all__
+            assert callable(getattr(cfd_python, func_name))